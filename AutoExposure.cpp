@@ -0,0 +1,229 @@
+//--------------------------------------------------------------------------------------
+// File: AutoExposure.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "AutoExposure.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+namespace
+{
+    // Rec.709 luminance weights
+    constexpr XMVECTORF32 c_LuminanceR = { { { 0.2126f, 0.2126f, 0.2126f, 0.2126f } } };
+    constexpr XMVECTORF32 c_LuminanceG = { { { 0.7152f, 0.7152f, 0.7152f, 0.7152f } } };
+    constexpr XMVECTORF32 c_LuminanceB = { { { 0.0722f, 0.0722f, 0.0722f, 0.0722f } } };
+
+    // Changes smaller than this (in stops) snap to the target, so adaptation ends.
+    constexpr float c_ConvergedStops = 0.01f;
+
+    constexpr size_t c_BinCount = LuminanceHistogram::BinCount;
+
+    struct BinParameters
+    {
+        XMVECTOR    minLuminance;
+        XMVECTOR    minLogLuminance;
+        XMVECTOR    scale;              // Bins per stop
+        XMVECTOR    maxBin;
+    };
+
+    // Bins four pixels at once: transposed to one register per channel, so the luminance
+    // and log are computed for all four lanes together.
+    inline void XM_CALLCONV BinQuad(FXMVECTOR p0, FXMVECTOR p1, FXMVECTOR p2, GXMVECTOR p3,
+        const BinParameters& params, size_t lanes, uint32_t* bins) noexcept
+    {
+        const XMMATRIX soa = XMMatrixTranspose(XMMATRIX(p0, p1, p2, p3));
+
+        XMVECTOR lum = XMVectorMultiply(soa.r[0], c_LuminanceR);
+        lum = XMVectorMultiplyAdd(soa.r[1], c_LuminanceG, lum);
+        lum = XMVectorMultiplyAdd(soa.r[2], c_LuminanceB, lum);
+
+        XMVECTOR bin = XMVectorLog2(XMVectorMax(lum, params.minLuminance));
+        bin = XMVectorMultiply(XMVectorSubtract(bin, params.minLogLuminance), params.scale);
+        bin = XMVectorAdd(XMVectorClamp(bin, XMVectorZero(), params.maxBin), XMVectorSplatOne());
+        // Below the range, negative, or NaN: bin 0.
+        bin = XMVectorSelect(XMVectorZero(), bin, XMVectorGreaterOrEqual(lum, params.minLuminance));
+
+        uint32_t index[4];
+        XMStoreInt4(index, XMConvertVectorFloatToUInt(bin, 0));
+
+        for (size_t j = 0; j < lanes; ++j)
+        {
+            ++bins[index[j]];
+        }
+    }
+
+    inline XMVECTOR XM_CALLCONV LoadPixel(const XMHALF4* pixel) noexcept { return XMLoadHalf4(pixel); }
+    inline XMVECTOR XM_CALLCONV LoadPixel(const XMFLOAT3PK* pixel) noexcept { return XMLoadFloat3PK(pixel); }
+
+    template<typename T>
+    void BinRow(const T* row, size_t count, const BinParameters& params, uint32_t* bins) noexcept
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            BinQuad(LoadPixel(&row[i]), LoadPixel(&row[i + 1]), LoadPixel(&row[i + 2]), LoadPixel(&row[i + 3]),
+                params, 4, bins);
+        }
+
+        if (i < count)
+        {
+            T tail[4] = {};
+            std::memcpy(tail, row + i, (count - i) * sizeof(T));
+            BinQuad(LoadPixel(&tail[0]), LoadPixel(&tail[1]), LoadPixel(&tail[2]), LoadPixel(&tail[3]),
+                params, count - i, bins);
+        }
+    }
+
+    template<typename T>
+    void BuildHistogramRows(const AutoExposure::Settings& settings, const T* pixels, size_t pitch, size_t width, size_t height,
+        LuminanceHistogram& histogram, TaskPool* pool)
+    {
+        const float minLog = settings.minLogLuminance;
+        const float maxLog = std::max(settings.maxLogLuminance, minLog + 1.f);
+
+        histogram.minLogLuminance = minLog;
+        histogram.maxLogLuminance = maxLog;
+        histogram.pixelCount = uint64_t(width) * uint64_t(height);
+        std::fill(std::begin(histogram.bins), std::end(histogram.bins), 0u);
+
+        if (!pixels || !width || !height)
+            return;
+
+        BinParameters params;
+        params.minLuminance = XMVectorReplicate(std::exp2(minLog));
+        params.minLogLuminance = XMVectorReplicate(minLog);
+        params.scale = XMVectorReplicate(float(c_BinCount - 1) / (maxLog - minLog));
+        params.maxBin = XMVectorReplicate(float(c_BinCount - 2));
+
+        // Each worker accumulates into its own set of bins, summed at the end.
+        const size_t workers = pool ? pool->GetThreadCount() : 1;
+        std::vector<uint32_t> workerBins(workers * c_BinCount, 0);
+
+        auto rows = [&](size_t begin, size_t end, size_t worker)
+        {
+            uint32_t bins[c_BinCount] = {};
+            for (size_t y = begin; y < end; ++y)
+            {
+                BinRow(pixels + y * pitch, width, params, bins);
+            }
+
+            uint32_t* dest = &workerBins[worker * c_BinCount];
+            for (size_t j = 0; j < c_BinCount; ++j)
+            {
+                dest[j] += bins[j];
+            }
+        };
+
+        if (pool)
+        {
+            pool->ParallelFor(height, std::max<size_t>(1, 16384 / width), rows);
+        }
+        else
+        {
+            rows(0, height, 0);
+        }
+
+        for (size_t w = 0; w < workers; ++w)
+        {
+            for (size_t j = 0; j < c_BinCount; ++j)
+            {
+                histogram.bins[j] += workerBins[w * c_BinCount + j];
+            }
+        }
+    }
+}
+
+AutoExposure::AutoExposure() noexcept :
+    m_exposure(0.f),
+    m_converged(true)
+{
+}
+
+void AutoExposure::BuildHistogram(const XMHALF4* pixels, size_t pitch, size_t width, size_t height,
+    LuminanceHistogram& histogram, TaskPool* pool) const
+{
+    BuildHistogramRows(m_settings, pixels, pitch, width, height, histogram, pool);
+}
+
+void AutoExposure::BuildHistogram(const XMFLOAT3PK* pixels, size_t pitch, size_t width, size_t height,
+    LuminanceHistogram& histogram, TaskPool* pool) const
+{
+    BuildHistogramRows(m_settings, pixels, pitch, width, height, histogram, pool);
+}
+
+float AutoExposure::ComputeTargetExposure(const LuminanceHistogram& histogram) const noexcept
+{
+    uint64_t total = 0;
+    for (size_t j = 1; j < c_BinCount; ++j)
+    {
+        total += histogram.bins[j];
+    }
+
+    // Nothing lit; keep the current exposure.
+    if (!total)
+        return m_exposure;
+
+    const double low = double(total) * double(std::min(m_settings.lowPercentile, m_settings.highPercentile));
+    const double high = double(total) * double(std::max(m_settings.lowPercentile, m_settings.highPercentile));
+    const double binWidth = double(histogram.maxLogLuminance - histogram.minLogLuminance) / double(c_BinCount - 1);
+
+    // Average of the log luminance of the pixels between the two percentiles, counting
+    // the part of each bin that falls inside.
+    double below = 0.;
+    double weight = 0.;
+    double sum = 0.;
+    for (size_t j = 1; j < c_BinCount; ++j)
+    {
+        const double start = below;
+        below += double(histogram.bins[j]);
+
+        const double inside = std::min(below, high) - std::max(start, low);
+        if (inside > 0.)
+        {
+            const double center = double(histogram.minLogLuminance) + (double(j) - 0.5) * binWidth;
+            sum += center * inside;
+            weight += inside;
+        }
+    }
+
+    if (weight <= 0.)
+        return m_exposure;
+
+    const float averageLog = float(sum / weight);
+    const float exposure = std::log2(m_settings.keyValue) - averageLog;
+    return std::min(std::max(exposure, m_settings.minExposure), m_settings.maxExposure);
+}
+
+float AutoExposure::Update(const LuminanceHistogram& histogram, float elapsedSeconds) noexcept
+{
+    const float target = ComputeTargetExposure(histogram);
+    const float delta = target - m_exposure;
+
+    if (std::abs(delta) < c_ConvergedStops)
+    {
+        m_exposure = target;
+        m_converged = true;
+        return m_exposure;
+    }
+
+    // Exponential approach, independent of frame rate.
+    const float rate = (delta > 0.f) ? m_settings.speedUp : m_settings.speedDown;
+    m_exposure += delta * (1.f - std::exp(-rate * std::max(elapsedSeconds, 0.f)));
+    m_converged = false;
+
+    return m_exposure;
+}
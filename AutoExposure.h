@@ -0,0 +1,100 @@
+//--------------------------------------------------------------------------------------
+// File: AutoExposure.h
+//
+// Automatic exposure from a log-luminance histogram of the HDR scene. The histogram is
+// built on the CPU from R16G16B16A16_FLOAT pixels; the exposure is the average
+// luminance between two percentiles mapped to a key value, smoothed over time.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace DX
+{
+    class TaskPool;
+
+    struct LuminanceHistogram
+    {
+        // Bin 0 counts pixels darker than the histogram's range (including the clear
+        // color when it is black), which are left out of the exposure.
+        static constexpr size_t BinCount = 128;
+
+        float       minLogLuminance;    // log2 of the luminance at the bottom of bin 1
+        float       maxLogLuminance;
+        uint64_t    pixelCount;
+        uint32_t    bins[BinCount];
+    };
+
+    class AutoExposure
+    {
+    public:
+        struct Settings
+        {
+            float   minLogLuminance;    // Histogram range, as log2 of luminance
+            float   maxLogLuminance;
+            float   lowPercentile;      // Fraction of the darkest pixels ignored
+            float   highPercentile;     // Pixels brighter than this fraction are ignored
+            float   keyValue;           // Average luminance after exposure (middle gray)
+            float   speedUp;            // Adaptation rates per second, when brightening
+            float   speedDown;          // and when darkening the image
+            float   minExposure;        // Limits, in stops
+            float   maxExposure;
+
+            Settings() noexcept :
+                minLogLuminance(-12.f),
+                maxLogLuminance(8.f),
+                lowPercentile(0.5f),
+                highPercentile(0.95f),
+                keyValue(0.18f),
+                speedUp(3.f),
+                speedDown(1.f),
+                minExposure(-10.f),
+                maxExposure(10.f)
+            {
+            }
+        };
+
+        AutoExposure() noexcept;
+
+        void SetSettings(const Settings& settings) noexcept { m_settings = settings; }
+        const Settings& GetSettings() const noexcept { return m_settings; }
+
+        // Bins the luminance of every pixel, with rows split across the task pool when one
+        // is given. 'pitch' is in pixels.
+        void BuildHistogram(_In_reads_(pitch * height) const DirectX::PackedVector::XMHALF4* pixels,
+            size_t pitch, size_t width, size_t height,
+            LuminanceHistogram& histogram, TaskPool* pool = nullptr) const;
+
+        // The same for an R11G11B10_FLOAT image.
+        void BuildHistogram(_In_reads_(pitch * height) const DirectX::PackedVector::XMFLOAT3PK* pixels,
+            size_t pitch, size_t width, size_t height,
+            LuminanceHistogram& histogram, TaskPool* pool = nullptr) const;
+
+        // The exposure, in stops, that brings the histogram's average to the key value.
+        float ComputeTargetExposure(const LuminanceHistogram& histogram) const noexcept;
+
+        // Moves the current exposure toward the histogram's target and returns it.
+        float Update(const LuminanceHistogram& histogram, float elapsedSeconds) noexcept;
+
+        void Reset(float exposure = 0.f) noexcept { m_exposure = exposure; }
+
+        float GetExposure() const noexcept { return m_exposure; }
+
+        // Whether the last Update reached its target.
+        bool IsConverged() const noexcept { return m_converged; }
+
+    private:
+        Settings    m_settings;
+        float       m_exposure;
+        bool        m_converged;
+    };
+}
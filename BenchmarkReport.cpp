@@ -0,0 +1,232 @@
+//--------------------------------------------------------------------------------------
+// File: BenchmarkReport.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "BenchmarkReport.h"
+
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+
+using namespace DX;
+
+namespace
+{
+    const char* GetPlatformName() noexcept
+    {
+    #if defined(_WIN32)
+        return "windows";
+    #elif defined(__linux__)
+        return "linux";
+    #elif defined(__APPLE__)
+        return "macos";
+    #else
+        return "unknown";
+    #endif
+    }
+
+    const char* GetArchitectureName() noexcept
+    {
+    #if defined(_M_X64) || defined(__x86_64__)
+        return "x64";
+    #elif defined(_M_ARM64) || defined(__aarch64__)
+        return "arm64";
+    #elif defined(_M_IX86) || defined(__i386__)
+        return "x86";
+    #else
+        return "unknown";
+    #endif
+    }
+
+    std::string GetTimestamp()
+    {
+        const std::time_t now = std::time(nullptr);
+        std::tm utc = {};
+    #ifdef _WIN32
+        gmtime_s(&utc, &now);
+    #else
+        gmtime_r(&now, &utc);
+    #endif
+
+        char buffer[32] = {};
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        return buffer;
+    }
+
+    void WriteString(std::ostream& out, const std::string& value)
+    {
+        out << '"';
+        for (const char c : value)
+        {
+            switch (c)
+            {
+            case '"':   out << "\\\""; break;
+            case '\\':  out << "\\\\"; break;
+            case '\n':  out << "\\n"; break;
+            case '\r':  out << "\\r"; break;
+            case '\t':  out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+                }
+                else
+                {
+                    out << c;
+                }
+                break;
+            }
+        }
+        out << '"';
+    }
+
+    // JSON has no NaN or infinity.
+    void WriteNumber(std::ostream& out, double value)
+    {
+        if (std::isfinite(value))
+        {
+            out << value;
+        }
+        else
+        {
+            out << "null";
+        }
+    }
+
+    void WriteThreadResults(std::ostream& out, const std::vector<BenchmarkReport::ThreadResult>& results, const char* throughputName,
+        const char* indent)
+    {
+        if (results.empty())
+        {
+            out << "[]";
+            return;
+        }
+
+        out << '[';
+        for (size_t j = 0; j < results.size(); ++j)
+        {
+            auto const& result = results[j];
+            out << (j ? "," : "") << '\n' << indent << "  { \"threads\": " << result.threads << ", \"ms_per_frame\": ";
+            WriteNumber(out, result.msPerFrame);
+            out << ", \"" << throughputName << "\": ";
+            WriteNumber(out, result.throughput);
+            out << ", \"scaling\": ";
+            WriteNumber(out, result.scaling);
+            out << " }";
+        }
+        out << '\n' << indent << ']';
+    }
+}
+
+void BenchmarkReport::WriteJSON(std::ostream& out) const
+{
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::setprecision(6) << std::defaultfloat;
+
+    out << "{\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"timestamp\": ";
+    WriteString(out, GetTimestamp());
+    out << ",\n  \"platform\": \"" << GetPlatformName() << "\",\n";
+    out << "  \"architecture\": \"" << GetArchitectureName() << "\",\n";
+    out << "  \"hardware_threads\": " << hardwareThreads << ",\n";
+    out << "  \"max_threads\": " << maxThreads << ",\n";
+    out << "  \"width\": " << width << ",\n";
+    out << "  \"height\": " << height << ",\n";
+    out << "  \"views\": " << views << ",\n";
+    out << "  \"iterations\": " << iterations << ",\n";
+
+    out << "  \"models\": [";
+    for (size_t j = 0; j < models.size(); ++j)
+    {
+        auto const& model = models[j];
+        out << (j ? "," : "") << "\n    {\n      \"file\": ";
+        WriteString(out, model.file);
+        out << ",\n      \"file_bytes\": " << model.fileBytes;
+
+        if (!model.error.empty())
+        {
+            out << ",\n      \"error\": ";
+            WriteString(out, model.error);
+        }
+        else
+        {
+            out << ",\n      \"meshes\": " << model.statistics.meshes
+                << ",\n      \"subsets\": " << model.statistics.subsets
+                << ",\n      \"vertex_buffers\": " << model.statistics.vertexBuffers
+                << ",\n      \"index_buffers\": " << model.statistics.indexBuffers
+                << ",\n      \"vertices\": " << model.statistics.vertices
+                << ",\n      \"indices\": " << model.statistics.indices
+                << ",\n      \"triangles\": " << model.statistics.triangles
+                << ",\n      \"lines\": " << model.statistics.lines
+                << ",\n      \"points\": " << model.statistics.points
+                << ",\n      \"skinned\": " << (model.statistics.skinned ? "true" : "false")
+                << ",\n      \"frames\": " << model.frames
+                << ",\n      \"vertex_buffer_bytes\": " << model.vertexBytes
+                << ",\n      \"index_buffer_bytes\": " << model.indexBytes;
+        }
+
+        out << ",\n      \"stages\": {";
+        for (size_t s = 0; s < model.stages.size(); ++s)
+        {
+            auto const& stage = model.stages[s];
+            out << (s ? "," : "") << "\n        \"" << stage.name << "\": { \"mean_ms\": ";
+            WriteNumber(out, stage.timing.meanMs);
+            out << ", \"min_ms\": ";
+            WriteNumber(out, stage.timing.minMs);
+            out << " }";
+        }
+        out << (model.stages.empty() ? "}" : "\n      }");
+
+        out << ",\n      \"draw\": ";
+        WriteThreadResults(out, model.draw, "mtri_per_s", "      ");
+        out << "\n    }";
+    }
+    out << (models.empty() ? "]" : "\n  ]") << ",\n";
+
+    out << "  \"tonemap\": [";
+    for (size_t j = 0; j < toneMaps.size(); ++j)
+    {
+        auto const& toneMap = toneMaps[j];
+        out << (j ? "," : "") << "\n    {\n      \"operator\": ";
+        WriteString(out, toneMap.op);
+        out << ",\n      \"transfer_function\": ";
+        WriteString(out, toneMap.transferFunction);
+        out << ",\n      \"threads\": ";
+        WriteThreadResults(out, toneMap.threads, "mpixel_per_s", "      ");
+        out << "\n    }";
+    }
+    out << (toneMaps.empty() ? "]" : "\n  ]") << ",\n";
+
+    out << "  \"profiler\": { \"disabled_scope_ns\": ";
+    WriteNumber(out, profiler.disabledNs);
+    out << ", \"enabled_scope_ns\": ";
+    WriteNumber(out, profiler.enabledNs);
+    out << " },\n";
+
+    out << "  \"frame_history\": { \"push_ns\": ";
+    WriteNumber(out, frameHistory.pushNs);
+    out << ", \"stats_us\": ";
+    WriteNumber(out, frameHistory.statsUs);
+    out << " },\n";
+
+    out << "  \"transparency_sort\": { \"parts\": " << transparencySort.parts << ", \"radix_mean_ms\": ";
+    WriteNumber(out, transparencySort.radix.meanMs);
+    out << ", \"radix_min_ms\": ";
+    WriteNumber(out, transparencySort.radix.minMs);
+    out << ", \"reference_mean_ms\": ";
+    WriteNumber(out, transparencySort.reference.meanMs);
+    out << ", \"reference_min_ms\": ";
+    WriteNumber(out, transparencySort.reference.minMs);
+    out << " }\n}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,120 @@
+//--------------------------------------------------------------------------------------
+// File: BenchmarkReport.h
+//
+// Results of a headless benchmark run: the time of each load and render stage per model,
+// and throughput at each thread count, written as JSON for tracking trends across builds
+// and machines.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ModelData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace DX
+{
+    struct BenchmarkReport
+    {
+        struct Timing
+        {
+            double                          meanMs;
+            double                          minMs;
+        };
+
+        struct Stage
+        {
+            const char*                     name;
+            Timing                          timing;
+        };
+
+        struct ThreadResult
+        {
+            size_t                          threads;
+            double                          msPerFrame;
+            double                          throughput;     // Mtri/s for models, Mpixel/s for tone mapping
+            double                          scaling;        // Throughput relative to the first thread count
+        };
+
+        struct Model
+        {
+            std::string                     file;
+            std::string                     error;          // Empty if the model loaded
+            uint64_t                        fileBytes;
+            ModelData::Statistics           statistics;
+            size_t                          frames;
+            uint64_t                        vertexBytes;    // Vertex and index buffer memory once loaded on the GPU
+            uint64_t                        indexBytes;
+            std::vector<Stage>              stages;
+            std::vector<ThreadResult>       draw;
+
+            Model() noexcept : fileBytes(0), statistics{}, frames(0), vertexBytes(0), indexBytes(0) {}
+        };
+
+        struct ToneMap
+        {
+            std::string                     op;
+            std::string                     transferFunction;
+            std::vector<ThreadResult>       threads;
+        };
+
+        // Cost of one FrameProfiler scope, in nanoseconds.
+        struct Profiler
+        {
+            double                          disabledNs;
+            double                          enabledNs;
+        };
+
+        // Cost of recording one frame time in FrameTimeHistory, in nanoseconds, and of
+        // computing the statistics over its whole window, in microseconds.
+        struct FrameHistory
+        {
+            double                          pushNs;
+            double                          statsUs;
+        };
+
+        // Back-to-front ordering of alpha parts by TransparencySorter and by std::stable_sort.
+        struct TransparencySort
+        {
+            size_t                          parts;
+            Timing                          radix;
+            Timing                          reference;
+        };
+
+        uint32_t                            width;
+        uint32_t                            height;
+        size_t                              views;
+        uint32_t                            iterations;
+        size_t                              maxThreads;
+        size_t                              hardwareThreads;
+        std::vector<Model>                  models;
+        std::vector<ToneMap>                toneMaps;
+        Profiler                            profiler;
+        FrameHistory                        frameHistory;
+        TransparencySort                    transparencySort;
+
+        BenchmarkReport() noexcept :
+            width(0),
+            height(0),
+            views(0),
+            iterations(0),
+            maxThreads(0),
+            hardwareThreads(0),
+            profiler{},
+            frameHistory{},
+            transparencySort{}
+        {
+        }
+
+        // Also records the time of the run and the platform it ran on.
+        void WriteJSON(std::ostream& out) const;
+    };
+}
@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------------------
+// File: ChromeTrace.h
+//
+// Helper for writing the Chrome Trace Event JSON format, which can be viewed with
+// chrome://tracing or https://ui.perfetto.dev
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <ios>
+#include <ostream>
+
+
+namespace DX
+{
+    inline void WriteJSONString(std::ostream& stream, const char* str)
+    {
+        stream << '"';
+        if (str)
+        {
+            for (; *str; ++str)
+            {
+                const char c = *str;
+                switch (c)
+                {
+                case '"':   stream << "\\\""; break;
+                case '\\':  stream << "\\\\"; break;
+                case '\n':  stream << "\\n"; break;
+                case '\r':  stream << "\\r"; break;
+                case '\t':  stream << "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char buff[8] = {};
+                        std::snprintf(buff, sizeof(buff), "\\u%04x", static_cast<unsigned int>(c));
+                        stream << buff;
+                    }
+                    else
+                    {
+                        stream << c;
+                    }
+                    break;
+                }
+            }
+        }
+        stream << '"';
+    }
+
+    // Writes a JSON object of trace events. Timestamps and durations are in microseconds.
+    class ChromeTraceWriter
+    {
+    public:
+        explicit ChromeTraceWriter(std::ostream& stream, uint32_t pid = 1) :
+            m_stream(stream),
+            m_pid(pid),
+            m_first(true),
+            m_closed(false),
+            m_flags(stream.flags()),
+            m_precision(stream.precision())
+        {
+            m_stream.setf(std::ios::fixed, std::ios::floatfield);
+            m_stream.precision(3);
+            m_stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        }
+
+        ~ChromeTraceWriter() { Close(); }
+
+        ChromeTraceWriter(ChromeTraceWriter const&) = delete;
+        ChromeTraceWriter& operator= (ChromeTraceWriter const&) = delete;
+
+        // 'X' event: a scope with a start and a duration.
+        void Complete(const char* name, const char* category, double startUs, double durationUs, uint32_t tid,
+            const char* argName = nullptr, double argValue = 0.0)
+        {
+            BeginEvent(name, category, 'X', tid, startUs);
+            m_stream << ",\"dur\":" << durationUs;
+            if (argName)
+            {
+                m_stream << ",\"args\":{";
+                WriteJSONString(m_stream, argName);
+                m_stream << ':' << argValue << '}';
+            }
+            m_stream << '}';
+        }
+
+        // 'i' event: a single point in time.
+        void Instant(const char* name, const char* category, double timeUs, uint32_t tid)
+        {
+            BeginEvent(name, category, 'i', tid, timeUs);
+            m_stream << ",\"s\":\"t\"}";
+        }
+
+        // 'C' event: a named counter track.
+        void Counter(const char* name, double timeUs, double value)
+        {
+            BeginEvent(name, nullptr, 'C', 0, timeUs);
+            m_stream << ",\"args\":{\"value\":" << value << "}}";
+        }
+
+        // 'M' event: names a thread track.
+        void ThreadName(uint32_t tid, const char* name)
+        {
+            Separator();
+            m_stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << m_pid << ",\"tid\":" << tid << ",\"args\":{\"name\":";
+            WriteJSONString(m_stream, name);
+            m_stream << "}}";
+        }
+
+        void Close()
+        {
+            if (!m_closed)
+            {
+                m_stream << "\n]}\n";
+                m_stream.flush();
+                m_stream.flags(m_flags);
+                m_stream.precision(m_precision);
+                m_closed = true;
+            }
+        }
+
+    private:
+        std::ostream&       m_stream;
+        uint32_t            m_pid;
+        bool                m_first;
+        bool                m_closed;
+        std::ios::fmtflags  m_flags;
+        std::streamsize     m_precision;
+
+        void Separator()
+        {
+            m_stream << (m_first ? "\n" : ",\n");
+            m_first = false;
+        }
+
+        void BeginEvent(const char* name, const char* category, char phase, uint32_t tid, double timeUs)
+        {
+            Separator();
+            m_stream << "{\"name\":";
+            WriteJSONString(m_stream, name);
+            if (category)
+            {
+                m_stream << ",\"cat\":";
+                WriteJSONString(m_stream, category);
+            }
+            m_stream << ",\"ph\":\"" << phase << "\",\"pid\":" << m_pid << ",\"tid\":" << tid << ",\"ts\":" << timeUs;
+        }
+    };
+}
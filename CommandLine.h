@@ -0,0 +1,63 @@
+//--------------------------------------------------------------------------------------
+// File: CommandLine.h
+//
+// Switch matching shared by the viewer's command line in Main.cpp and the headless
+// renderer's in HeadlessArguments.cpp.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cwchar>
+#include <cwctype>
+
+
+namespace DX
+{
+    // Case-insensitive comparison of whole strings.
+    inline bool EqualsNoCase(_In_z_ const wchar_t* a, _In_z_ const wchar_t* b) noexcept
+    {
+        for (; *a && *b; ++a, ++b)
+        {
+            if (std::towlower(static_cast<wint_t>(*a)) != std::towlower(static_cast<wint_t>(*b)))
+                return false;
+        }
+        return *a == *b;
+    }
+
+    // Switches start with '-', or on Windows also '/'; elsewhere that starts an absolute
+    // path instead.
+    inline bool IsSwitch(_In_z_ const wchar_t* arg) noexcept
+    {
+    #ifdef _WIN32
+        return *arg == L'-' || *arg == L'/';
+    #else
+        return *arg == L'-';
+    #endif
+    }
+
+    // Switches are given as -name (or /name on Windows), case-insensitively, with any
+    // value after a ':'. Returns the value, empty if there is none, or nullptr if 'arg'
+    // is not the switch.
+    inline const wchar_t* MatchSwitch(_In_z_ const wchar_t* arg, _In_z_ const wchar_t* name) noexcept
+    {
+        if (!IsSwitch(arg))
+            return nullptr;
+
+        ++arg;
+        const size_t len = wcslen(name);
+        for (size_t j = 0; j < len; ++j, ++arg)
+        {
+            if (!*arg || std::towlower(static_cast<wint_t>(*arg)) != std::towlower(static_cast<wint_t>(name[j])))
+                return nullptr;
+        }
+
+        if (*arg == L':')
+            return arg + 1;
+
+        return (*arg == 0) ? arg : nullptr;
+    }
+}
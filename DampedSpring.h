@@ -0,0 +1,53 @@
+//--------------------------------------------------------------------------------------
+// File: DampedSpring.h
+//
+// Critically damped spring for easing a value toward a target that may change while it
+// moves, as used for camera transitions. Each update is the exact solution of the spring
+// over the elapsed time rather than an integration step, so the motion is the same at
+// any frame rate and never overshoots a target that holds still.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+
+
+namespace DX
+{
+    // T needs +, -, and multiplication by float: float, or the SimpleMath vectors.
+    template<typename T>
+    class DampedSpring
+    {
+    public:
+        // Roughly the time to cover most of the way to the target.
+        explicit DampedSpring(float smoothTime = 0.25f) noexcept :
+            m_omega(2.f / smoothTime),
+            m_velocity{}
+        {
+        }
+
+        void SetSmoothTime(float smoothTime) noexcept { m_omega = 2.f / smoothTime; }
+
+        // Stops the spring, for starting a new transition from rest.
+        void Reset() noexcept { m_velocity = T{}; }
+
+        const T& GetVelocity() const noexcept { return m_velocity; }
+
+        // Moves 'value' toward 'target' over 'elapsedTime' seconds.
+        void Update(T& value, const T& target, float elapsedTime) noexcept
+        {
+            const float decay = std::exp(-m_omega * elapsedTime);
+            const T change = value - target;
+            const T temp = (m_velocity + change * m_omega) * elapsedTime;
+            m_velocity = (m_velocity - temp * m_omega) * decay;
+            value = target + (change + temp) * decay;
+        }
+
+    private:
+        float   m_omega;
+        T       m_velocity;
+    };
+}
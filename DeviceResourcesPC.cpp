@@ -5,6 +5,7 @@
 
 #include "pch.h"
 #include "DeviceResourcesPC.h"
+#include "FrameProfiler.h"
 
 using namespace DirectX;
 using namespace DX;
@@ -76,6 +77,7 @@ DeviceResources::DeviceResources(
         m_d3dFeatureLevel(D3D_FEATURE_LEVEL_9_1),
         m_outputSize{0, 0, 1, 1},
         m_colorSpace(DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709),
+        m_frameLatencyWaitPending(false),
         m_options(flags | c_FlipPresent),
         m_deviceNotify(nullptr)
 {
@@ -147,6 +149,15 @@ void DeviceResources::CreateDeviceResources()
         }
     }
 
+    // Frame latency waitable objects require a flip model swap chain
+    if ((m_options & c_FrameLatencyWaitable) && !(m_options & (c_FlipPresent | c_AllowTearing | c_EnableHDR)))
+    {
+        m_options &= ~c_FrameLatencyWaitable;
+#ifdef _DEBUG
+        OutputDebugStringA("INFO: Frame latency waitable object not supported");
+#endif
+    }
+
     // Determine DirectX hardware feature levels this app will support.
     static const D3D_FEATURE_LEVEL s_featureLevels[] =
     {
@@ -284,7 +295,7 @@ void DeviceResources::CreateWindowSizeDependentResources()
             backBufferWidth,
             backBufferHeight,
             backBufferFormat,
-            (m_options & c_AllowTearing) ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0u
+            GetSwapChainFlags()
             );
 
         if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
@@ -321,7 +332,7 @@ void DeviceResources::CreateWindowSizeDependentResources()
         swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
         swapChainDesc.SwapEffect = (m_options & (c_FlipPresent | c_AllowTearing | c_EnableHDR)) ? DXGI_SWAP_EFFECT_FLIP_DISCARD : DXGI_SWAP_EFFECT_DISCARD;
         swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_IGNORE;
-        swapChainDesc.Flags = (m_options & c_AllowTearing) ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0u;
+        swapChainDesc.Flags = GetSwapChainFlags();
 
         DXGI_SWAP_CHAIN_FULLSCREEN_DESC fsSwapChainDesc = {};
         fsSwapChainDesc.Windowed = TRUE;
@@ -337,6 +348,22 @@ void DeviceResources::CreateWindowSizeDependentResources()
 
         // This class does not support exclusive full-screen mode and prevents DXGI from responding to the ALT+ENTER shortcut
         ThrowIfFailed(m_dxgiFactory->MakeWindowAssociation(m_window, DXGI_MWA_NO_ALT_ENTER));
+
+        if (m_options & c_FrameLatencyWaitable)
+        {
+            // Queue at most one frame so input is sampled as close to display as possible.
+            ComPtr<IDXGISwapChain2> swapChain2;
+            ThrowIfFailed(m_swapChain.As(&swapChain2));
+            ThrowIfFailed(swapChain2->SetMaximumFrameLatency(1));
+
+            m_frameLatencyWaitable.Attach(swapChain2->GetFrameLatencyWaitableObject());
+            if (!m_frameLatencyWaitable.IsValid())
+            {
+                throw std::runtime_error("GetFrameLatencyWaitableObject");
+            }
+
+            m_frameLatencyWaitPending = true;
+        }
     }
 
     // Handle color space settings for HDR
@@ -426,6 +453,8 @@ void DeviceResources::HandleDeviceLost()
     m_d3dRenderTargetView.Reset();
     m_renderTarget.Reset();
     m_depthStencil.Reset();
+    m_frameLatencyWaitable.Close();
+    m_frameLatencyWaitPending = false;
     m_swapChain.Reset();
     m_d3dContext.Reset();
     m_d3dAnnotation.Reset();
@@ -453,22 +482,26 @@ void DeviceResources::HandleDeviceLost()
 }
 
 // Present the contents of the swap chain to the screen.
-void DeviceResources::Present()
+void DeviceResources::Present(UINT syncInterval)
 {
+    ProfileScope scope("Present");
+
     HRESULT hr = E_FAIL;
-    if (m_options & c_AllowTearing)
+    if ((m_options & c_AllowTearing) || !syncInterval)
     {
         // Recommended to always use tearing if supported when using a sync interval of 0.
-        hr = m_swapChain->Present(0, DXGI_PRESENT_ALLOW_TEARING);
+        hr = m_swapChain->Present(0, (m_options & c_AllowTearing) ? DXGI_PRESENT_ALLOW_TEARING : 0u);
     }
     else
     {
         // The first argument instructs DXGI to block until VSync, putting the application
         // to sleep until the next VSync. This ensures we don't waste any cycles rendering
         // frames that will never be displayed to the screen.
-        hr = m_swapChain->Present(1, 0);
+        hr = m_swapChain->Present(syncInterval, 0);
     }
 
+    m_frameLatencyWaitPending = true;
+
     // Discard the contents of the render target.
     // This is a valid operation only when the existing contents will be entirely
     // overwritten. If dirty or scroll rects are used, this call should be removed.
@@ -503,6 +536,27 @@ void DeviceResources::Present()
     }
 }
 
+// Blocks until the swap chain can accept another frame. Call before sampling input for a frame.
+void DeviceResources::WaitForFrameLatency(DWORD timeout) noexcept
+{
+    // The object counts presented frames, so only wait once per Present.
+    if (m_frameLatencyWaitable.IsValid() && m_frameLatencyWaitPending)
+    {
+        std::ignore = WaitForSingleObjectEx(m_frameLatencyWaitable.Get(), timeout, TRUE);
+        m_frameLatencyWaitPending = false;
+    }
+}
+
+UINT DeviceResources::GetSwapChainFlags() const noexcept
+{
+    UINT flags = (m_options & c_AllowTearing) ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0u;
+    if (m_options & c_FrameLatencyWaitable)
+    {
+        flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+    }
+    return flags;
+}
+
 void DeviceResources::CreateFactory()
 {
 #if defined(_DEBUG) && (_WIN32_WINNT >= 0x0603 /*_WIN32_WINNT_WINBLUE*/)
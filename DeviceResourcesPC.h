@@ -23,6 +23,7 @@ namespace DX
         static constexpr unsigned int c_FlipPresent  = 0x1;
         static constexpr unsigned int c_AllowTearing = 0x2;
         static constexpr unsigned int c_EnableHDR    = 0x4;
+        static constexpr unsigned int c_FrameLatencyWaitable = 0x8;
 
         DeviceResources(DXGI_FORMAT backBufferFormat = DXGI_FORMAT_B8G8R8A8_UNORM,
                         DXGI_FORMAT depthBufferFormat = DXGI_FORMAT_D32_FLOAT,
@@ -43,7 +44,8 @@ namespace DX
         bool WindowSizeChanged(int width, int height);
         void HandleDeviceLost();
         void RegisterDeviceNotify(IDeviceNotify* deviceNotify) noexcept { m_deviceNotify = deviceNotify; }
-        void Present();
+        void Present(UINT syncInterval = 1);
+        void WaitForFrameLatency(DWORD timeout = 1000) noexcept;
         void UpdateColorSpace();
 
         // Device Accessors.
@@ -86,6 +88,7 @@ namespace DX
     private:
         void CreateFactory();
         void GetHardwareAdapter(IDXGIAdapter1** ppAdapter);
+        UINT GetSwapChainFlags() const noexcept;
 
         // Direct3D objects.
         Microsoft::WRL::ComPtr<IDXGIFactory2>               m_dxgiFactory;
@@ -115,6 +118,10 @@ namespace DX
         // HDR Support
         DXGI_COLOR_SPACE_TYPE                           m_colorSpace;
 
+        // Signaled when the swap chain can accept another frame (c_FrameLatencyWaitable)
+        Microsoft::WRL::Wrappers::Event                 m_frameLatencyWaitable;
+        bool                                            m_frameLatencyWaitPending;
+
         // DeviceResources options (see flags above)
         unsigned int                                    m_options;
 
@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------------------
+// File: DirtyTracker.h
+//
+// Helper for detecting which pieces of render state changed since the last frame,
+// so unchanged frames can be re-presented cheaply or skipped entirely
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+
+namespace DX
+{
+    // Each slot records a copy of a value. Track() compares the current value with the
+    // recorded copy and sets the slot's bit in the dirty mask when they differ.
+    class DirtyTracker
+    {
+    public:
+        static constexpr size_t MaxSlots = 32;
+        static constexpr uint32_t All = UINT32_MAX;
+
+        DirtyTracker() noexcept :
+            m_dirty(All),
+            m_recorded(0)
+        {
+        }
+
+        DirtyTracker(DirtyTracker&&) = default;
+        DirtyTracker& operator= (DirtyTracker&&) = default;
+
+        DirtyTracker(DirtyTracker const&) = delete;
+        DirtyTracker& operator= (DirtyTracker const&) = delete;
+
+        // Packs one or more trivially copyable values into the slot's recorded copy.
+        template<typename... T>
+        bool Track(size_t slot, const T&... values)
+        {
+            uint8_t buffer[PackedSize<T...>::value];
+            size_t offset = 0;
+            const int expand[] = { 0, (Append(buffer, offset, values), 0)... };
+            std::ignore = expand;
+            return TrackBytes(slot, buffer, sizeof(buffer));
+        }
+
+        // Returns true if the data differs from what was recorded for this slot.
+        bool TrackBytes(size_t slot, const void* data, size_t size)
+        {
+            if (slot >= MaxSlots)
+                return false;
+
+            const uint32_t bit = 1u << slot;
+            auto& recorded = m_values[slot];
+
+            if ((m_recorded & bit)
+                && recorded.size() == size
+                && (!size || memcmp(recorded.data(), data, size) == 0))
+            {
+                return false;
+            }
+
+            recorded.resize(size);
+            if (size)
+            {
+                memcpy(recorded.data(), data, size);
+            }
+
+            m_recorded |= bit;
+            m_dirty |= bit;
+            return true;
+        }
+
+        // Forces slots dirty without changing the recorded values (e.g. after a device reset).
+        void Invalidate(uint32_t mask = All) noexcept { m_dirty |= mask; }
+
+        uint32_t GetDirty() const noexcept { return m_dirty; }
+        bool IsDirty(uint32_t mask = All) const noexcept { return (m_dirty & mask) != 0; }
+
+        // Call once the state has been drawn.
+        void Clear(uint32_t mask = All) noexcept { m_dirty &= ~mask; }
+
+        // Forgets all recorded values; every slot reports dirty on its next Track.
+        void Reset() noexcept
+        {
+            m_recorded = 0;
+            m_dirty = All;
+        }
+
+    private:
+        template<typename... T> struct PackedSize;
+
+        template<typename T, typename... Rest>
+        struct PackedSize<T, Rest...> : std::integral_constant<size_t, sizeof(T) + PackedSize<Rest...>::value> {};
+
+        template<typename T>
+        struct PackedSize<T> : std::integral_constant<size_t, sizeof(T)> {};
+
+        template<typename T>
+        static void Append(uint8_t* buffer, size_t& offset, const T& value) noexcept
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Track requires trivially copyable types");
+            memcpy(buffer + offset, &value, sizeof(T));
+            offset += sizeof(T);
+        }
+
+        std::array<std::vector<uint8_t>, MaxSlots>  m_values;
+        uint32_t                                    m_dirty;
+        uint32_t                                    m_recorded;
+    };
+}
@@ -0,0 +1,250 @@
+//--------------------------------------------------------------------------------------
+// File: FrameHierarchy.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "FrameHierarchy.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    // Narrower levels aren't worth waking the workers for.
+    constexpr size_t c_ParallelLevelWidth = 4096;
+    constexpr size_t c_GrainSize = 1024;
+}
+
+void FrameHierarchy::Build(const Link* links, const XMFLOAT4X4* localTransforms, size_t count)
+{
+    if (count && (!links || !localTransforms))
+        throw std::invalid_argument("FrameHierarchy::Build");
+
+    if (count >= None)
+        throw std::invalid_argument("Too many frames");
+
+    Clear();
+
+    // Breadth-first from the roots, so frames come out ordered by depth.
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> parentFrame(count, uint32_t(None));
+    std::vector<uint32_t> depth(count, 0);
+    std::vector<uint8_t> visited(count, 0);
+    queue.reserve(count);
+
+    for (size_t j = 0; j < count; ++j)
+    {
+        if (links[j].isRoot)
+        {
+            visited[j] = 1;
+            queue.push_back(static_cast<uint32_t>(j));
+        }
+    }
+
+    const size_t rootCount = queue.size();
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        const uint32_t frame = queue[head];
+
+        size_t siblings = 0;
+        for (uint32_t child = links[frame].child; child < count && siblings < count; child = links[child].sibling, ++siblings)
+        {
+            if (!visited[child])
+            {
+                visited[child] = 1;
+                parentFrame[child] = frame;
+                depth[child] = depth[frame] + 1;
+                queue.push_back(child);
+            }
+        }
+    }
+
+    // Frames no root reaches join the first level, after the roots.
+    m_order.reserve(count);
+    m_order.assign(queue.cbegin(), queue.cbegin() + static_cast<ptrdiff_t>(rootCount));
+    for (size_t j = 0; j < count; ++j)
+    {
+        if (!visited[j])
+        {
+            m_order.push_back(static_cast<uint32_t>(j));
+        }
+    }
+    m_order.insert(m_order.end(), queue.cbegin() + static_cast<ptrdiff_t>(rootCount), queue.cend());
+
+    m_position.resize(count);
+    for (size_t p = 0; p < count; ++p)
+    {
+        m_position[m_order[p]] = static_cast<uint32_t>(p);
+    }
+
+    m_parent.resize(count);
+    m_local.resize(count);
+    m_world.resize(count);
+    for (size_t p = 0; p < count; ++p)
+    {
+        const uint32_t frame = m_order[p];
+        m_parent[p] = (parentFrame[frame] != None) ? m_position[parentFrame[frame]] : uint32_t(None);
+        m_local[p] = localTransforms[frame];
+
+        if (!p || depth[frame] != depth[m_order[p - 1]])
+        {
+            m_levels.push_back(p);
+        }
+    }
+    m_levels.push_back(count);
+
+    m_dirty.assign(count, 1);
+    m_anyDirty = (count > 0);
+    m_firstDirtyLevel = 0;
+}
+
+void FrameHierarchy::Build(const ModelData& model)
+{
+    const size_t count = model.frames.size();
+
+    std::vector<Link> links(count);
+    std::vector<XMFLOAT4X4> localTransforms(count);
+    for (size_t j = 0; j < count; ++j)
+    {
+        auto const& frame = model.frames[j];
+        links[j].child = frame.child;
+        links[j].sibling = frame.sibling;
+        links[j].isRoot = (frame.parent == ModelData::None);
+        localTransforms[j] = frame.matrix;
+    }
+
+    Build(links.data(), localTransforms.data(), count);
+}
+
+void FrameHierarchy::Clear() noexcept
+{
+    m_order.clear();
+    m_parent.clear();
+    m_local.clear();
+    m_world.clear();
+    m_dirty.clear();
+    m_position.clear();
+    m_levels.clear();
+    m_anyDirty = false;
+    m_firstDirtyLevel = 0;
+}
+
+size_t FrameHierarchy::GetMaxLevelWidth() const noexcept
+{
+    size_t width = 0;
+    for (size_t level = 0; level + 1 < m_levels.size(); ++level)
+    {
+        width = std::max(width, m_levels[level + 1] - m_levels[level]);
+    }
+    return width;
+}
+
+void XM_CALLCONV FrameHierarchy::SetLocalTransform(uint32_t frame, FXMMATRIX transform)
+{
+    if (frame >= m_position.size())
+        throw std::out_of_range("FrameHierarchy::SetLocalTransform");
+
+    const uint32_t position = m_position[frame];
+    XMStoreFloat4x4(&m_local[position], transform);
+    m_dirty[position] = 1;
+
+    const size_t level = static_cast<size_t>(std::upper_bound(m_levels.cbegin(), m_levels.cend(), size_t(position)) - m_levels.cbegin()) - 1;
+    m_firstDirtyLevel = m_anyDirty ? std::min(m_firstDirtyLevel, level) : level;
+    m_anyDirty = true;
+}
+
+void FrameHierarchy::Invalidate() noexcept
+{
+    std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(1));
+    m_anyDirty = !m_dirty.empty();
+    m_firstDirtyLevel = 0;
+}
+
+size_t FrameHierarchy::UpdateRange(size_t begin, size_t end) noexcept
+{
+    size_t updated = 0;
+    for (size_t p = begin; p < end; ++p)
+    {
+        const uint32_t parent = m_parent[p];
+        if (!m_dirty[p])
+        {
+            if (parent == None || !m_dirty[parent])
+                continue;
+
+            // Passes the change on to this frame's children, on the next level.
+            m_dirty[p] = 1;
+        }
+
+        XMMATRIX world = XMLoadFloat4x4(&m_local[p]);
+        if (parent != None)
+        {
+            world = XMMatrixMultiply(world, XMLoadFloat4x4(&m_world[parent]));
+        }
+        XMStoreFloat4x4(&m_world[p], world);
+        ++updated;
+    }
+    return updated;
+}
+
+size_t FrameHierarchy::Update(TaskPool* pool)
+{
+    if (!m_anyDirty)
+        return 0;
+
+    // Every parent is on an earlier level, so the frames of one level are independent.
+    size_t updated = 0;
+    for (size_t level = m_firstDirtyLevel; level + 1 < m_levels.size(); ++level)
+    {
+        const size_t begin = m_levels[level];
+        const size_t end = m_levels[level + 1];
+
+        if (pool && end - begin >= c_ParallelLevelWidth)
+        {
+            std::atomic<size_t> count(0);
+            pool->ParallelFor(end - begin, c_GrainSize, [&](size_t first, size_t last, size_t)
+                {
+                    count += UpdateRange(begin + first, begin + last);
+                });
+            updated += count;
+        }
+        else
+        {
+            updated += UpdateRange(begin, end);
+        }
+    }
+
+    std::fill(m_dirty.begin() + static_cast<ptrdiff_t>(m_levels[m_firstDirtyLevel]), m_dirty.end(), uint8_t(0));
+    m_anyDirty = false;
+    m_firstDirtyLevel = 0;
+
+    return updated;
+}
+
+void FrameHierarchy::CopyTransforms(XMFLOAT4X4* transforms, size_t count) const
+{
+    if (count < m_order.size() || (!transforms && !m_order.empty()))
+        throw std::invalid_argument("Frame transform array is too small");
+
+    for (size_t p = 0; p < m_order.size(); ++p)
+    {
+        transforms[m_order[p]] = m_world[p];
+    }
+}
@@ -0,0 +1,100 @@
+//--------------------------------------------------------------------------------------
+// File: FrameHierarchy.h
+//
+// Frame (bone) hierarchy flattened for updating absolute transforms. The first-child and
+// next-sibling links of SDKMESH_FRAME and ModelBone are walked once, breadth first, into
+// arrays ordered by depth, with each frame's parent stored as an index into the same
+// arrays, so an update is one pass per level in which every parent is already done.
+// Changing a frame's local matrix marks it dirty; the next update recomputes only the
+// dirty frames and their descendants, and a level wider than a few thousand frames is
+// split across a TaskPool's threads.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ModelData.h"
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace DX
+{
+    class TaskPool;
+
+    class FrameHierarchy
+    {
+    public:
+        static constexpr uint32_t None = UINT32_MAX;
+
+        // Indices of other frames, or None.
+        struct Link
+        {
+            uint32_t    child;      // First child
+            uint32_t    sibling;    // Next sibling
+            bool        isRoot;     // Has no parent
+        };
+
+        FrameHierarchy() noexcept : m_anyDirty(false), m_firstDirtyLevel(0) {}
+
+        FrameHierarchy(FrameHierarchy&&) = default;
+        FrameHierarchy& operator= (FrameHierarchy&&) = default;
+
+        FrameHierarchy(FrameHierarchy const&) = delete;
+        FrameHierarchy& operator= (FrameHierarchy const&) = delete;
+
+        // Gives the same transforms as ModelData::ComputeFrameTransforms: links that loop
+        // or run out of range are ignored, and frames no root reaches keep their own
+        // matrix. A frame linked from more than one parent is placed under the nearest
+        // to a root. Every frame starts dirty.
+        void Build(_In_reads_(count) const Link* links, _In_reads_(count) const DirectX::XMFLOAT4X4* localTransforms, size_t count);
+        void Build(const ModelData& model);
+
+        void Clear() noexcept;
+
+        size_t GetFrameCount() const noexcept { return m_order.size(); }
+        size_t GetLevelCount() const noexcept { return m_levels.empty() ? 0 : m_levels.size() - 1; }
+        size_t GetMaxLevelWidth() const noexcept;
+
+        void XM_CALLCONV SetLocalTransform(uint32_t frame, DirectX::FXMMATRIX transform);
+
+        // Marks every frame dirty.
+        void Invalidate() noexcept;
+
+        // Recomputes the absolute transform of every dirty frame and its descendants, and
+        // returns how many were recomputed; 0 if nothing changed since the last update.
+        // 'pool' may be null to update on the calling thread.
+        size_t Update(_In_opt_ TaskPool* pool = nullptr);
+
+        // Local transform times those of its parents, as of the last Update.
+        DirectX::XMMATRIX XM_CALLCONV GetTransform(uint32_t frame) const noexcept
+        {
+            return DirectX::XMLoadFloat4x4(&m_world[m_position[frame]]);
+        }
+
+        // Copies every absolute transform, indexed by frame. 'count' must be at least
+        // GetFrameCount().
+        void CopyTransforms(_Out_writes_(count) DirectX::XMFLOAT4X4* transforms, size_t count) const;
+
+    private:
+        size_t UpdateRange(size_t begin, size_t end) noexcept;
+
+        // By position in breadth-first order.
+        std::vector<uint32_t>               m_order;        // Frame index
+        std::vector<uint32_t>               m_parent;       // Position of the parent, or None
+        std::vector<DirectX::XMFLOAT4X4>    m_local;
+        std::vector<DirectX::XMFLOAT4X4>    m_world;
+        std::vector<uint8_t>                m_dirty;
+
+        std::vector<uint32_t>               m_position;     // By frame index
+        std::vector<size_t>                 m_levels;       // First position of each level, then the count
+        bool                                m_anyDirty;
+        size_t                              m_firstDirtyLevel;
+    };
+}
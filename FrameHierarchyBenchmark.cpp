@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------------------
+// File: FrameHierarchyBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "FrameHierarchy.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+using namespace DirectX;
+using namespace DX;
+
+void DX::BenchmarkFrameHierarchy(const ModelData& model, uint32_t iterations, TaskPool& pool,
+    BenchmarkReport::Model& result, std::ostream& log)
+{
+    std::vector<XMFLOAT4X4> transforms(model.frames.size());
+    const auto frames = TimeStage(iterations, [&]()
+    {
+        model.ComputeFrameTransforms(transforms.data(), transforms.size());
+    });
+
+    // The same transforms from the flattened hierarchy: building it, updating every frame
+    // on one thread and on the pool, and updating after one frame halfway through the file
+    // changes.
+    FrameHierarchy hierarchy;
+    const auto flatten = TimeStage(iterations, [&]() { hierarchy.Build(model); });
+    const auto flat = TimeStage(iterations, [&]()
+    {
+        hierarchy.Invalidate();
+        std::ignore = hierarchy.Update();
+    });
+    const auto parallel = TimeStage(iterations, [&]()
+    {
+        hierarchy.Invalidate();
+        std::ignore = hierarchy.Update(&pool);
+    });
+
+    size_t dirtyFrames = 0;
+    const auto dirty = TimeStage(iterations, [&]()
+    {
+        if (!model.frames.empty())
+        {
+            const auto frame = static_cast<uint32_t>(model.frames.size() / 2);
+            hierarchy.SetLocalTransform(frame, XMLoadFloat4x4(&model.frames[frame].matrix));
+        }
+        dirtyFrames = hierarchy.Update(&pool);
+    });
+
+    std::vector<XMFLOAT4X4> flatTransforms(model.frames.size());
+    hierarchy.CopyTransforms(flatTransforms.data(), flatTransforms.size());
+    if (!flatTransforms.empty() && memcmp(flatTransforms.data(), transforms.data(), transforms.size() * sizeof(XMFLOAT4X4)) != 0)
+        throw std::runtime_error("Flattened frame transforms differ from the linked-list traversal");
+
+    result.stages.insert(result.stages.end(), { { "frames", frames }, { "frames_flatten", flatten }, { "frames_flat", flat },
+        { "frames_parallel", parallel }, { "frames_dirty", dirty } });
+
+    log << "  frames: " << model.frames.size() << " in " << hierarchy.GetLevelCount() << " levels (widest "
+        << hierarchy.GetMaxLevelWidth() << "), " << dirtyFrames << " recomputed after changing the middle one" << std::endl;
+}
@@ -0,0 +1,255 @@
+//--------------------------------------------------------------------------------------
+// File: FramePacer.h
+//
+// Frame pacing controller: frame rate caps, late input sampling against a predicted
+// deadline, and render-on-demand scheduling
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "StepTimer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+
+
+namespace DX
+{
+    enum class FramePacing : uint32_t
+    {
+        VSync,          // Present every vblank (original behavior)
+        Capped,         // Sleep to hold a target frame rate, present without waiting for vblank
+        LowLatency,     // Sleep so the frame's work finishes just before the next deadline
+        OnDemand,       // Only render when something changed
+        Count
+    };
+
+    // The pacer does not sleep itself: callers query GetWaitTicks and sleep (or advance a
+    // ManualClock in a simulation) before calling BeginFrame.
+    template<typename TClock>
+    class BasicFramePacer
+    {
+    public:
+        BasicFramePacer() noexcept(false) : BasicFramePacer(TClock()) {}
+
+        explicit BasicFramePacer(const TClock& clock) noexcept(false) :
+            m_clock(clock),
+            m_mode(FramePacing::VSync),
+            m_frequency(clock.GetFrequency()),
+            m_period(0),
+            m_nextDeadline(0),
+            m_frameStart(0),
+            m_lastRender(0),
+            m_idleRefresh(0),
+            m_margin(0),
+            m_workMean(0.0),
+            m_workDeviation(0.0),
+            m_rendered(false)
+        {
+            SetTargetFramesPerSecond(60.0);
+            SetLatencyMargin(0.001);
+        }
+
+        void SetMode(FramePacing mode) noexcept
+        {
+            m_mode = mode;
+            m_nextDeadline = 0;
+        }
+
+        FramePacing GetMode() const noexcept { return m_mode; }
+
+        void SetTargetFramesPerSecond(double fps) noexcept
+        {
+            fps = std::max(fps, 1.0);
+            m_period = static_cast<uint64_t>(double(m_frequency) / fps);
+            m_nextDeadline = 0;
+        }
+
+        double GetTargetFramesPerSecond() const noexcept { return double(m_frequency) / double(m_period); }
+
+        // Extra time kept in reserve when predicting the LowLatency start time.
+        void SetLatencyMargin(double seconds) noexcept { m_margin = SecondsToClock(seconds); }
+
+        // In OnDemand mode, render at least this often even when nothing changed (0 disables).
+        void SetIdleRefresh(double seconds) noexcept { m_idleRefresh = SecondsToClock(seconds); }
+
+        // Predicted CPU time from BeginFrame to EndFrame (mean plus two deviations).
+        uint64_t GetPredictedWorkTicks() const noexcept
+        {
+            return static_cast<uint64_t>(m_workMean + 2.0 * m_workDeviation);
+        }
+
+        // How long to wait before starting the next frame, in clock units.
+        uint64_t GetWaitTicks() const noexcept
+        {
+            if (!m_nextDeadline)
+                return 0;
+
+            uint64_t start = 0;
+            switch (m_mode)
+            {
+            case FramePacing::Capped:
+                start = m_nextDeadline;
+                break;
+
+            case FramePacing::LowLatency:
+                {
+                    // Start as late as possible while still finishing before the deadline.
+                    const uint64_t reserve = GetPredictedWorkTicks() + m_margin;
+                    start = (m_nextDeadline > reserve) ? (m_nextDeadline - reserve) : 0;
+                }
+                break;
+
+            default:
+                return 0;
+            }
+
+            const uint64_t now = m_clock.GetTicks();
+            return (start > now) ? (start - now) : 0;
+        }
+
+        double GetWaitSeconds() const noexcept { return double(GetWaitTicks()) / double(m_frequency); }
+
+        // Call once the wait is over; this is when input for the frame is sampled.
+        void BeginFrame() noexcept
+        {
+            const uint64_t now = m_clock.GetTicks();
+            m_frameStart = now;
+
+            if (m_mode == FramePacing::Capped || m_mode == FramePacing::LowLatency)
+            {
+                // Resynchronize if we fell more than a full period behind rather than bursting to catch up.
+                if (!m_nextDeadline || now > m_nextDeadline + m_period)
+                {
+                    m_nextDeadline = now;
+                }
+
+                m_nextDeadline += m_period;
+            }
+        }
+
+        // Returns false if the frame can be skipped. 'dirty' indicates the scene or view changed.
+        bool ShouldRender(bool dirty) const noexcept
+        {
+            if (m_mode != FramePacing::OnDemand || dirty || !m_rendered)
+                return true;
+
+            return m_idleRefresh && (m_clock.GetTicks() - m_lastRender) >= m_idleRefresh;
+        }
+
+        // Call after Present (or after skipping the frame) to update the work prediction.
+        void EndFrame(bool rendered) noexcept
+        {
+            const uint64_t now = m_clock.GetTicks();
+
+            if (rendered)
+            {
+                const double work = double(now - m_frameStart);
+                if (!m_rendered)
+                {
+                    m_workMean = work;
+                    m_workDeviation = 0.0;
+                }
+                else
+                {
+                    m_workDeviation += (std::abs(work - m_workMean) - m_workDeviation) * 0.1;
+                    m_workMean += (work - m_workMean) * 0.1;
+                }
+
+                m_lastRender = now;
+                m_rendered = true;
+            }
+        }
+
+        // Capped mode presents immediately; every other mode syncs to vblank.
+        uint32_t GetSyncInterval() const noexcept { return (m_mode == FramePacing::Capped) ? 0u : 1u; }
+
+        TClock& GetClock() noexcept { return m_clock; }
+
+    private:
+        TClock          m_clock;
+        FramePacing     m_mode;
+        uint64_t        m_frequency;
+        uint64_t        m_period;
+        uint64_t        m_nextDeadline;
+        uint64_t        m_frameStart;
+        uint64_t        m_lastRender;
+        uint64_t        m_idleRefresh;
+        uint64_t        m_margin;
+        double          m_workMean;
+        double          m_workDeviation;
+        bool            m_rendered;
+
+        uint64_t SecondsToClock(double seconds) const noexcept
+        {
+            return static_cast<uint64_t>(std::max(seconds, 0.0) * double(m_frequency));
+        }
+    };
+
+    using FramePacer = BasicFramePacer<DefaultClock>;
+
+    // Sleeps with better than scheduler-tick precision where the OS allows it.
+    class SleepTimer
+    {
+    public:
+        SleepTimer() noexcept
+        {
+        #ifdef _WIN32
+        #ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+        #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+        #endif
+            // High resolution timers require Windows 10 (1803) or later.
+            m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            if (!m_timer)
+            {
+                m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+            }
+        #endif
+        }
+
+        ~SleepTimer()
+        {
+        #ifdef _WIN32
+            if (m_timer)
+            {
+                CloseHandle(m_timer);
+            }
+        #endif
+        }
+
+        SleepTimer(SleepTimer const&) = delete;
+        SleepTimer& operator= (SleepTimer const&) = delete;
+
+        void SleepFor(double seconds) noexcept
+        {
+            if (seconds <= 0.0)
+                return;
+
+        #ifdef _WIN32
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -static_cast<LONGLONG>(seconds * 10000000.0);
+            if (m_timer && SetWaitableTimerEx(m_timer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+            {
+                std::ignore = WaitForSingleObject(m_timer, INFINITE);
+                return;
+            }
+
+            Sleep(static_cast<DWORD>(seconds * 1000.0));
+        #else
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        #endif
+        }
+
+    private:
+    #ifdef _WIN32
+        HANDLE m_timer;
+    #endif
+    };
+}
@@ -0,0 +1,317 @@
+//--------------------------------------------------------------------------------------
+// File: FrameProfiler.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "FrameProfiler.h"
+#include "ChromeTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <vector>
+
+using namespace DX;
+
+std::atomic<bool> FrameProfiler::s_capturing(false);
+
+namespace
+{
+    constexpr size_t c_RingSize = 16384;    // Scopes per thread between drains; a power of two
+    constexpr size_t c_MaxThreads = 64;
+
+    // The frame boundaries get their own track.
+    constexpr uint32_t c_FrameTrack = 0;
+
+    // A scope, or a counter sample if 'end' is zero.
+    struct Event
+    {
+        const char* name;
+        uint64_t    start;
+        uint64_t    end;
+        double      value;
+    };
+
+    // Single producer (the owning thread), single consumer (the thread running the capture).
+    struct ThreadBuffer
+    {
+        Event                       events[c_RingSize];
+        std::atomic<uint64_t>       head;       // Next slot to write, advanced by the owner
+        std::atomic<uint64_t>       tail;       // Next slot to read, advanced by the consumer
+        std::atomic<uint64_t>       dropped;
+        std::atomic<const char*>    name;
+        uint32_t                    track;
+
+        explicit ThreadBuffer(uint32_t index) noexcept :
+            events{},
+            head(0),
+            tail(0),
+            dropped(0),
+            name(nullptr),
+            track(index + 1)
+        {
+        }
+    };
+
+    // Buffers are published once and live until exit, so a thread that ends mid-capture
+    // doesn't leave a dangling pointer behind.
+    struct BufferRegistry
+    {
+        std::atomic<ThreadBuffer*>  buffers[c_MaxThreads];
+        std::atomic<uint32_t>       count;
+
+        BufferRegistry() noexcept : buffers{}, count(0) {}
+
+        ~BufferRegistry()
+        {
+            for (auto& it : buffers)
+            {
+                delete it.load(std::memory_order_acquire);
+            }
+        }
+    };
+
+    BufferRegistry g_registry;
+
+    thread_local ThreadBuffer* t_buffer = nullptr;
+    thread_local bool t_registered = false;
+
+    ThreadBuffer* GetThreadBuffer() noexcept
+    {
+        if (!t_registered)
+        {
+            t_registered = true;
+
+            const uint32_t index = g_registry.count.fetch_add(1, std::memory_order_relaxed);
+            if (index < c_MaxThreads)
+            {
+                t_buffer = new (std::nothrow) ThreadBuffer(index);
+                g_registry.buffers[index].store(t_buffer, std::memory_order_release);
+            }
+        }
+
+        return t_buffer;
+    }
+
+    // Consumer-side state; only touched by the thread running the capture.
+    struct CapturedEvent
+    {
+        const char* name;
+        uint64_t    start;
+        uint64_t    end;
+        double      value;
+        uint32_t    track;
+    };
+
+    std::vector<CapturedEvent>  g_events;
+    std::vector<uint64_t>       g_frameStarts;
+    uint32_t                    g_framesLeft = 0;
+    uint64_t                    g_droppedAtStart = 0;
+    uint64_t                    g_dropped = 0;
+
+    uint64_t CountDropped() noexcept
+    {
+        uint64_t dropped = 0;
+        const uint32_t count = std::min<uint32_t>(g_registry.count.load(std::memory_order_acquire), c_MaxThreads);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            auto buffer = g_registry.buffers[j].load(std::memory_order_acquire);
+            if (buffer)
+            {
+                dropped += buffer->dropped.load(std::memory_order_relaxed);
+            }
+        }
+        return dropped;
+    }
+
+    void Push(const Event& event) noexcept
+    {
+        auto buffer = GetThreadBuffer();
+        if (!buffer)
+            return;
+
+        const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        if (head - buffer->tail.load(std::memory_order_acquire) >= c_RingSize)
+        {
+            // Full until the next drain; losing the newest event keeps the ring single-writer.
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer->events[head & (c_RingSize - 1)] = event;
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    // Moves everything recorded so far out of the ring buffers, keeping it if requested.
+    void Drain(bool keep)
+    {
+        const uint32_t count = std::min<uint32_t>(g_registry.count.load(std::memory_order_acquire), c_MaxThreads);
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            auto buffer = g_registry.buffers[j].load(std::memory_order_acquire);
+            if (!buffer)
+                continue;
+
+            const uint64_t head = buffer->head.load(std::memory_order_acquire);
+            const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+            if (keep)
+            {
+                for (uint64_t i = tail; i < head; ++i)
+                {
+                    auto const& event = buffer->events[i & (c_RingSize - 1)];
+                    g_events.push_back({ event.name, event.start, event.end, event.value, buffer->track });
+                }
+            }
+
+            buffer->tail.store(head, std::memory_order_release);
+        }
+    }
+}
+
+void FrameProfiler::BeginCapture(uint32_t frameCount)
+{
+    s_capturing.store(false, std::memory_order_relaxed);
+
+    Drain(false);
+    g_events.clear();
+    g_frameStarts.clear();
+    g_dropped = 0;
+
+    if (!frameCount)
+        return;
+
+    g_events.reserve(size_t(frameCount) * 64);
+    g_frameStarts.reserve(size_t(frameCount) + 1);
+    g_frameStarts.push_back(Now());
+    g_framesLeft = frameCount;
+    g_droppedAtStart = CountDropped();
+
+    s_capturing.store(true, std::memory_order_relaxed);
+}
+
+bool FrameProfiler::EndFrame()
+{
+    if (!IsCapturing())
+        return false;
+
+    g_frameStarts.push_back(Now());
+    Drain(true);
+
+    if (--g_framesLeft > 0)
+        return false;
+
+    s_capturing.store(false, std::memory_order_relaxed);
+    g_dropped = CountDropped() - g_droppedAtStart;
+    return true;
+}
+
+void FrameProfiler::WriteChromeTrace(std::ostream& stream)
+{
+    const uint64_t origin = g_frameStarts.empty() ? 0 : g_frameStarts.front();
+    auto toUs = [origin](uint64_t ns) { return double(int64_t(ns - origin)) / 1000.0; };
+
+    ChromeTraceWriter trace(stream);
+    trace.ThreadName(c_FrameTrack, "Frames");
+
+    const uint32_t count = std::min<uint32_t>(g_registry.count.load(std::memory_order_acquire), c_MaxThreads);
+    for (uint32_t j = 0; j < count; ++j)
+    {
+        auto buffer = g_registry.buffers[j].load(std::memory_order_acquire);
+        if (!buffer)
+            continue;
+
+        const char* name = buffer->name.load(std::memory_order_relaxed);
+        if (name)
+        {
+            trace.ThreadName(buffer->track, name);
+        }
+        else
+        {
+            char buff[32] = {};
+            std::snprintf(buff, sizeof(buff), "Thread %u", buffer->track);
+            trace.ThreadName(buffer->track, buff);
+        }
+    }
+
+    for (size_t j = 1; j < g_frameStarts.size(); ++j)
+    {
+        char buff[32] = {};
+        std::snprintf(buff, sizeof(buff), "Frame %zu", j - 1);
+        trace.Complete(buff, "frame", toUs(g_frameStarts[j - 1]), double(g_frameStarts[j] - g_frameStarts[j - 1]) / 1000.0, c_FrameTrack);
+    }
+
+    for (auto const& event : g_events)
+    {
+        if (event.end)
+        {
+            trace.Complete(event.name, "cpu", toUs(event.start), double(event.end - event.start) / 1000.0, event.track);
+        }
+        else
+        {
+            trace.Counter(event.name, toUs(event.start), event.value);
+        }
+    }
+
+    if (g_dropped)
+    {
+        trace.Counter("Dropped scopes", 0.0, double(g_dropped));
+    }
+
+    trace.Close();
+}
+
+void FrameProfiler::SetThreadName(const char* name) noexcept
+{
+    auto buffer = GetThreadBuffer();
+    if (buffer)
+    {
+        buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+uint64_t FrameProfiler::GetDroppedEvents() noexcept
+{
+    return g_dropped;
+}
+
+size_t FrameProfiler::GetMemoryUsage() noexcept
+{
+    size_t bytes = g_events.capacity() * sizeof(CapturedEvent) + g_frameStarts.capacity() * sizeof(uint64_t);
+
+    const uint32_t count = std::min<uint32_t>(g_registry.count.load(std::memory_order_acquire), c_MaxThreads);
+    for (uint32_t j = 0; j < count; ++j)
+    {
+        if (g_registry.buffers[j].load(std::memory_order_acquire))
+        {
+            bytes += sizeof(ThreadBuffer);
+        }
+    }
+
+    return bytes;
+}
+
+uint64_t FrameProfiler::Now() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void FrameProfiler::RecordCounter(const char* name, double value) noexcept
+{
+    if (IsCapturing())
+    {
+        Push({ name, Now(), 0, value });
+    }
+}
+
+void FrameProfiler::Record(const char* name, uint64_t start, uint64_t end) noexcept
+{
+    Push({ name, start, end, 0. });
+}
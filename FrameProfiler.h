@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------------------
+// File: FrameProfiler.h
+//
+// Low-overhead CPU scope profiler for the render loop. Each thread records scopes into
+// its own ring buffer without locks, and the main thread drains the buffers once a frame
+// while a capture is running. A completed capture is written as Chrome trace JSON. When
+// no capture is running, a scope costs one relaxed atomic load.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+namespace DX
+{
+    class FrameProfiler
+    {
+    public:
+        FrameProfiler() = delete;
+
+        static bool IsCapturing() noexcept { return s_capturing.load(std::memory_order_relaxed); }
+
+        // Records the next 'frameCount' frames, discarding any earlier capture. BeginCapture,
+        // EndFrame, and WriteChromeTrace must all be called from the same thread.
+        static void BeginCapture(uint32_t frameCount);
+
+        // Marks the end of a frame. Returns true on the frame that completes the capture.
+        static bool EndFrame();
+
+        // Writes the last completed capture, one track per thread plus one for the frames.
+        static void WriteChromeTrace(std::ostream& stream);
+
+        // Names the calling thread's track. The name must be a string literal (or otherwise
+        // outlive the profiler).
+        static void SetThreadName(const char* name) noexcept;
+
+        // Scopes lost because a thread's ring buffer was full in the last capture.
+        static uint64_t GetDroppedEvents() noexcept;
+
+        // Memory held by the ring buffers of every thread that has recorded a scope, and by
+        // the last capture.
+        static size_t GetMemoryUsage() noexcept;
+
+        // Nanoseconds on the steady clock.
+        static uint64_t Now() noexcept;
+
+        // Adds a scope to the calling thread's ring buffer; 'name' must outlive the profiler.
+        static void Record(const char* name, uint64_t start, uint64_t end) noexcept;
+
+        // Adds a sample of a named counter track (e.g. a GPU pass time) if a capture is running.
+        static void RecordCounter(const char* name, double value) noexcept;
+
+    private:
+        static std::atomic<bool> s_capturing;
+    };
+
+    // RAII helper; records nothing unless a capture is running when it is constructed.
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* name) noexcept :
+            m_name(FrameProfiler::IsCapturing() ? name : nullptr),
+            m_start(m_name ? FrameProfiler::Now() : 0)
+        {
+        }
+
+        ~ProfileScope() { End(); }
+
+        // Closes the scope before it goes out of scope.
+        void End() noexcept
+        {
+            if (m_name)
+            {
+                FrameProfiler::Record(m_name, m_start, FrameProfiler::Now());
+                m_name = nullptr;
+            }
+        }
+
+        ProfileScope(ProfileScope const&) = delete;
+        ProfileScope& operator= (ProfileScope const&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t    m_start;
+    };
+}
@@ -0,0 +1,229 @@
+//--------------------------------------------------------------------------------------
+// File: FrameStatistics.h
+//
+// Rolling per-frame timing history with percentile, hitch, and budget statistics
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+namespace DX
+{
+    struct FrameTimeStats
+    {
+        size_t      count;          // Number of frames in the window
+        float       average;        // Milliseconds
+        float       p50;
+        float       p95;
+        float       p99;
+        float       max;
+        uint64_t    hitches;        // Total frames flagged as hitches since the last reset
+        uint64_t    overBudget;     // Total frames over the budget since the last reset
+    };
+
+    // Ring buffer of frame times in milliseconds. A single thread calls Push, while
+    // any number of threads may read concurrently without taking a lock. A read that
+    // overlaps Push leaves out the oldest frames if Push replaced them during the copy,
+    // so what it returns is always a contiguous run of frames as they were pushed.
+    class FrameTimeHistory
+    {
+    public:
+        static constexpr size_t Capacity = 1024;
+
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+        FrameTimeHistory() noexcept :
+            m_frames{},
+            m_writeIndex(0),
+            m_claimIndex(0),
+            m_hitches(0),
+            m_overBudget(0),
+            m_budget(1000.f / 60.f),
+            m_hitchFactor(2.f),
+            m_average(0.f)
+        {
+        }
+
+        FrameTimeHistory(FrameTimeHistory const&) = delete;
+        FrameTimeHistory& operator= (FrameTimeHistory const&) = delete;
+
+        // Frame budget in milliseconds (e.g. 16.67 for 60 Hz, 8.33 for 120 Hz).
+        void SetBudget(float milliseconds) noexcept { m_budget.store(milliseconds, std::memory_order_relaxed); }
+        float GetBudget() const noexcept { return m_budget.load(std::memory_order_relaxed); }
+
+        // A frame is a hitch if it takes longer than this multiple of the recent average.
+        void SetHitchFactor(float factor) noexcept { m_hitchFactor.store(factor, std::memory_order_relaxed); }
+        float GetHitchFactor() const noexcept { return m_hitchFactor.load(std::memory_order_relaxed); }
+
+        void Push(float milliseconds) noexcept
+        {
+            const uint64_t index = m_writeIndex.load(std::memory_order_relaxed);
+
+            // Claims the slot before replacing it; a reader that sees the new time also
+            // sees the claim and drops the frame the slot held (see GetRecent).
+            m_claimIndex.store(index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            m_frames[index & (Capacity - 1)].store(milliseconds, std::memory_order_relaxed);
+            m_writeIndex.store(index + 1, std::memory_order_release);
+
+            if (milliseconds > GetBudget())
+            {
+                m_overBudget.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Exponential moving average of recent frames, used as the hitch baseline.
+            if (index == 0)
+            {
+                m_average = milliseconds;
+            }
+            else
+            {
+                if (milliseconds > m_average * GetHitchFactor())
+                {
+                    m_hitches.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                m_average += (milliseconds - m_average) * 0.1f;
+            }
+        }
+
+        // Total frames pushed since the last reset.
+        uint64_t GetFrameCount() const noexcept { return m_writeIndex.load(std::memory_order_acquire); }
+
+        uint64_t GetHitchCount() const noexcept { return m_hitches.load(std::memory_order_relaxed); }
+        uint64_t GetOverBudgetCount() const noexcept { return m_overBudget.load(std::memory_order_relaxed); }
+
+        // Copies up to 'maxFrames' of the most recent frame times (oldest first), returning the
+        // number copied; 'firstFrame' receives the index of the first one.
+        size_t GetRecent(float* frames, size_t maxFrames, uint64_t* firstFrame = nullptr) const noexcept
+        {
+            const uint64_t end = GetFrameCount();
+            size_t count = static_cast<size_t>(std::min<uint64_t>(std::min<uint64_t>(end, uint64_t(Capacity)), maxFrames));
+            uint64_t start = end - count;
+            for (size_t j = 0; j < count; ++j)
+            {
+                frames[j] = m_frames[(start + j) & (Capacity - 1)].load(std::memory_order_relaxed);
+            }
+
+            // Slots claimed by Push since 'end' may hold newer frames than the ones wanted.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t claimed = m_claimIndex.load(std::memory_order_relaxed);
+            if (claimed > start + Capacity)
+            {
+                const size_t replaced = static_cast<size_t>(std::min<uint64_t>(claimed - start - Capacity, count));
+                std::copy(frames + replaced, frames + count, frames);
+                count -= replaced;
+                start += replaced;
+            }
+
+            if (firstFrame)
+            {
+                *firstFrame = start;
+            }
+            return count;
+        }
+
+        // Computes statistics over the most recent 'window' frames.
+        FrameTimeStats ComputeStats(size_t window = Capacity) const noexcept
+        {
+            FrameTimeStats stats = {};
+            stats.hitches = GetHitchCount();
+            stats.overBudget = GetOverBudgetCount();
+
+            std::array<float, Capacity> sorted;
+            stats.count = GetRecent(sorted.data(), std::min(window, size_t(Capacity)));
+            if (!stats.count)
+                return stats;
+
+            auto const first = sorted.begin();
+            auto const last = first + static_cast<ptrdiff_t>(stats.count);
+
+            double total = 0;
+            float maxValue = 0.f;
+            for (auto it = first; it != last; ++it)
+            {
+                total += *it;
+                maxValue = std::max(maxValue, *it);
+            }
+
+            stats.average = static_cast<float>(total / double(stats.count));
+            stats.max = maxValue;
+
+            // Nearest-rank percentiles: the smallest value with at least p% of the frames at or
+            // below it, at index ceil(p * n / 100) - 1, computed in integers so it is exact. Each
+            // selection only needs to search above the previous one.
+            auto rank = [&](size_t percent) noexcept
+            {
+                const size_t ordinal = (percent * stats.count + 99) / 100;
+                return std::min(stats.count - 1, std::max<size_t>(ordinal, 1) - 1);
+            };
+
+            const auto r50 = static_cast<ptrdiff_t>(rank(50));
+            const auto r95 = static_cast<ptrdiff_t>(rank(95));
+            const auto r99 = static_cast<ptrdiff_t>(rank(99));
+
+            std::nth_element(first, first + r50, last);
+            stats.p50 = first[r50];
+
+            std::nth_element(first + r50, first + r95, last);
+            stats.p95 = first[r95];
+
+            std::nth_element(first + r95, first + r99, last);
+            stats.p99 = first[r99];
+
+            return stats;
+        }
+
+        // Writes the retained frames as CSV.
+        void WriteCSV(std::ostream& stream) const
+        {
+            std::array<float, Capacity> frames;
+            uint64_t firstFrame = 0;
+            const size_t count = GetRecent(frames.data(), Capacity, &firstFrame);
+            const float budget = GetBudget();
+
+            stream << "frame,milliseconds,over_budget\n";
+            for (size_t j = 0; j < count; ++j)
+            {
+                stream << (firstFrame + j) << ',' << frames[j] << ',' << ((frames[j] > budget) ? 1 : 0) << '\n';
+            }
+        }
+
+        void ResetCounters() noexcept
+        {
+            m_hitches.store(0, std::memory_order_relaxed);
+            m_overBudget.store(0, std::memory_order_relaxed);
+        }
+
+        // Not safe to call while another thread is calling Push.
+        void Reset() noexcept
+        {
+            m_writeIndex.store(0, std::memory_order_release);
+            m_claimIndex.store(0, std::memory_order_relaxed);
+            m_hitches.store(0, std::memory_order_relaxed);
+            m_overBudget.store(0, std::memory_order_relaxed);
+            m_average = 0.f;
+        }
+
+    private:
+        std::array<std::atomic<float>, Capacity>    m_frames;
+        std::atomic<uint64_t>                       m_writeIndex;
+        std::atomic<uint64_t>                       m_claimIndex;   // Frames Push has started writing
+        std::atomic<uint64_t>                       m_hitches;
+        std::atomic<uint64_t>                       m_overBudget;
+        std::atomic<float>                          m_budget;
+        std::atomic<float>                          m_hitchFactor;
+        float                                       m_average;
+    };
+}
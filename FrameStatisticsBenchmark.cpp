@@ -0,0 +1,65 @@
+//--------------------------------------------------------------------------------------
+// File: FrameStatisticsBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "FrameStatistics.h"
+
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+
+using namespace DX;
+
+BenchmarkReport::FrameHistory DX::BenchmarkFrameHistory(std::ostream& log)
+{
+    using clock = std::chrono::steady_clock;
+    using ns = std::chrono::duration<double, std::nano>;
+
+    constexpr uint32_t c_Pushes = 10000000;
+    constexpr uint32_t c_Computes = 10000;
+
+    auto history = std::make_unique<FrameTimeHistory>();
+
+    BenchmarkReport::FrameHistory result = {};
+
+    // Frame times around 16 ms with the odd spike, from a fixed sequence.
+    uint32_t seed = 12345u;
+    auto start = clock::now();
+    for (uint32_t j = 0; j < c_Pushes; ++j)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        history->Push(14.f + float(seed >> 28) * ((seed & 0xff) ? 0.25f : 4.f));
+    }
+    result.pushNs = ns(clock::now() - start).count() / double(c_Pushes);
+
+    float checksum = 0.f;
+    start = clock::now();
+    for (uint32_t j = 0; j < c_Computes; ++j)
+    {
+        checksum += history->ComputeStats().p99;
+    }
+    result.statsUs = ns(clock::now() - start).count() / (1000. * double(c_Computes));
+
+    if (!(checksum > 0.f))
+        throw std::runtime_error("Frame history statistics failed");
+
+    log << "Frame history: " << std::fixed << std::setprecision(2) << result.pushNs << " ns per push, "
+        << result.statsUs << " us per " << FrameTimeHistory::Capacity << "-frame statistics" << std::endl;
+
+    return result;
+}
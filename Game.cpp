@@ -27,10 +27,236 @@ namespace
 {
     constexpr XMVECTORF32 c_Gray = { 0.215861f, 0.215861f, 0.215861f, 1.f };
     constexpr XMVECTORF32 c_CornflowerBlue = { 0.127438f, 0.300544f, 0.846873f, 1.f };
+
+    const wchar_t* c_FramePacingNames[] = { L"VSync", L"Capped", L"Low latency", L"On demand" };
+
+    static_assert(_countof(c_FramePacingNames) == static_cast<size_t>(DX::FramePacing::Count), "Frame pacing name table mismatch");
+
+    // Slots in Game::m_renderState
+    enum RenderStateSlot : size_t
+    {
+        RenderState_Camera,
+        RenderState_World,
+        RenderState_Model,
+        RenderState_IBL,
+        RenderState_Wireframe,
+        RenderState_Lighting,
+        RenderState_Bones,
+        RenderState_WindowSize,
+        RenderState_Scene,
+        RenderState_HUD,
+        RenderState_Status,
+        RenderState_ToneMap,
+        RenderState_Section,
+        RenderState_Occlusion,
+        RenderState_Transparency,
+        RenderState_HdrTarget,
+    };
+
+    enum SectionMode : uint32_t
+    {
+        SectionMode_Off,
+        SectionMode_Planes,     // Each plane turned on or off by itself
+        SectionMode_Box,        // All six, facing inward
+        SectionMode_Count
+    };
+
+    const wchar_t* c_SectionModeNames[] = { L"Off", L"Planes", L"Box" };
+
+    static_assert(_countof(c_SectionModeNames) == SectionMode_Count, "Section mode name table mismatch");
+
+    // Even planes keep the side above their position on the axis, odd ones the side below.
+    const wchar_t* c_SectionPlaneNames[] = { L"+X", L"-X", L"+Y", L"-Y", L"+Z", L"-Z" };
+
+    static_assert(_countof(c_SectionPlaneNames) == DX::SectionPlanes::MaxPlanes, "Section plane name table mismatch");
+
+    // State that only affects the tone-mapping pass, which can be re-run from the previous HDR frame.
+    constexpr uint32_t c_ToneMapState = 1u << RenderState_ToneMap;
+
+    // Passes timed by Game::m_gpuTimer
+    enum GpuPass : size_t
+    {
+        GpuPass_Scene,
+        GpuPass_Grid,
+        GpuPass_HUD,
+        GpuPass_ToneMap,
+        GpuPass_Count
+    };
+
+    const wchar_t* c_GpuPassNames[] = { L"Scene", L"Grid", L"HUD", L"Tone map" };
+    const char* c_GpuPassCounters[] = { "GPU scene (ms)", "GPU grid (ms)", "GPU HUD (ms)", "GPU tone map (ms)" };
+
+    static_assert(_countof(c_GpuPassNames) == GpuPass_Count, "GPU pass name table mismatch");
+    static_assert(_countof(c_GpuPassCounters) == GpuPass_Count, "GPU pass counter table mismatch");
+
+    using ModelTextureList = std::vector<std::pair<std::string, ComPtr<ID3D11Resource>>>;
+
+    // A .sdkmesh at least this large is streamed even without a streaming budget, which
+    // then defaults to that of ResidencyManager::Settings.
+    constexpr uint64_t c_StreamingFileSize = 1024u * 1024u * 1024u;
+
+    std::string Narrow(const wchar_t* str)
+    {
+        const int len = WideCharToMultiByte(CP_UTF8, 0, str, -1, nullptr, 0, nullptr, nullptr);
+        if (len <= 1)
+            return std::string();
+
+        std::string result(static_cast<size_t>(len), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, str, -1, &result[0], len, nullptr, nullptr);
+        result.resize(static_cast<size_t>(len) - 1);
+        return result;
+    }
+
+    // Records every texture the factory hands out for the model so it can be included in
+    // the memory totals. The factory's cache returns the same texture for repeated names,
+    // which the ledger counts once.
+    template<class Base>
+    class TextureTrackingFactory : public Base
+    {
+    public:
+        TextureTrackingFactory(_In_ ID3D11Device* device, ModelTextureList& textures) :
+            Base(device),
+            m_textures(textures)
+        {
+        }
+
+        void __cdecl CreateTexture(_In_z_ const wchar_t* name, _In_opt_ ID3D11DeviceContext* deviceContext, _Outptr_ ID3D11ShaderResourceView** textureView) override
+        {
+            Base::CreateTexture(name, deviceContext, textureView);
+
+            if (*textureView)
+            {
+                ComPtr<ID3D11Resource> resource;
+                (*textureView)->GetResource(resource.GetAddressOf());
+                m_textures.emplace_back(Narrow(name), std::move(resource));
+            }
+        }
+
+    private:
+        ModelTextureList& m_textures;
+    };
+
+    void AddResource(DX::MemoryLedger& ledger, DX::MemoryCategory category, const char* name, _In_opt_ ID3D11Resource* resource)
+    {
+        if (!resource)
+            return;
+
+        D3D11_RESOURCE_DIMENSION dimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+        resource->GetType(&dimension);
+
+        switch (dimension)
+        {
+        case D3D11_RESOURCE_DIMENSION_BUFFER:
+        {
+            D3D11_BUFFER_DESC desc = {};
+            static_cast<ID3D11Buffer*>(resource)->GetDesc(&desc);
+            ledger.AddBuffer(category, name, desc.ByteWidth, resource);
+            break;
+        }
+
+        case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+        {
+            D3D11_TEXTURE1D_DESC desc = {};
+            static_cast<ID3D11Texture1D*>(resource)->GetDesc(&desc);
+            ledger.AddTexture(category, name, desc.Format, desc.Width, 1, desc.ArraySize, desc.MipLevels, 1, false, resource);
+            break;
+        }
+
+        case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+        {
+            D3D11_TEXTURE2D_DESC desc = {};
+            static_cast<ID3D11Texture2D*>(resource)->GetDesc(&desc);
+            ledger.AddTexture(category, name, desc.Format, desc.Width, desc.Height, desc.ArraySize, desc.MipLevels,
+                desc.SampleDesc.Count, false, resource);
+            break;
+        }
+
+        case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+        {
+            D3D11_TEXTURE3D_DESC desc = {};
+            static_cast<ID3D11Texture3D*>(resource)->GetDesc(&desc);
+            ledger.AddTexture(category, name, desc.Format, desc.Width, desc.Height, desc.Depth, desc.MipLevels, 1, true, resource);
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    void AddResource(DX::MemoryLedger& ledger, DX::MemoryCategory category, const char* name, _In_opt_ ID3D11ShaderResourceView* view)
+    {
+        if (view)
+        {
+            ComPtr<ID3D11Resource> resource;
+            view->GetResource(resource.GetAddressOf());
+            AddResource(ledger, category, name, resource.Get());
+        }
+    }
+
+    double ToMegabytes(uint64_t bytes) noexcept
+    {
+        return double(bytes) / (1024.0 * 1024.0);
+    }
+
+    // Geometry counts for the status line, plus any primitives other than triangles.
+    int FormatStatistics(_Out_writes_(count) wchar_t* status, size_t count, const DX::ModelData::Statistics& stats)
+    {
+        int len = (stats.meshes > 1)
+            ? swprintf_s(status, count, L"Meshes: %6Iu   Verts: %6Iu   Faces: %6Iu   Subsets: %6Iu",
+                stats.meshes, stats.vertices, stats.triangles, stats.subsets)
+            : swprintf_s(status, count, L"Verts: %6Iu   Faces: %6Iu   Subsets: %6Iu",
+                stats.vertices, stats.triangles, stats.subsets);
+
+        if (stats.lines && len > 0)
+        {
+            len += swprintf_s(status + len, count - size_t(len), L"   Lines: %6Iu", stats.lines);
+        }
+        if (stats.points && len > 0)
+        {
+            len += swprintf_s(status + len, count - size_t(len), L"   Points: %6Iu", stats.points);
+        }
+        if (stats.unsupportedSubsets && len > 0)
+        {
+            len += swprintf_s(status + len, count - size_t(len), L"   Unsupported subsets: %Iu", stats.unsupportedSubsets);
+        }
+
+        return len;
+    }
 }
 
 // Constructor.
 Game::Game() noexcept(false) :
+    m_startupReport(false),
+    m_startupComplete(false),
+    m_fastStart(false),
+    m_deferredResources(false),
+    m_frameTraceLength(120),
+    m_frameTraceRequested(false),
+    m_showGpuTimes(false),
+    m_modelMemory(0),
+    m_memoryBudget(0),
+    m_streamingBudget(0),
+    m_memoryDirty(true),
+    m_showMemory(false),
+    m_idle(false),
+    m_modelStats{},
+    m_pick{},
+    m_pickPosition(0.f, 0.f),
+    m_pickRequested(false),
+    m_hasPick(false),
+    m_sectionOffsets{},
+    m_sectionMode(SectionMode_Off),
+    m_sectionEnabled(1),
+    m_sectionSelected(0),
+    m_sectionRejected(0),
+    m_sectionBoxesDirty(true),
+    m_occludedMeshes(0),
+    m_occlusionEnabled(false),
+    m_transparencyMode(DX::TransparencyMode::MeshOrder),
+    m_distanceTarget(10.f),
+    m_distanceAnimated(10.f),
+    m_cameraMoving(false),
     m_gridScale(10.f),
     m_fov(XM_PI / 4.f),
     m_zoom(1.f),
@@ -42,6 +268,7 @@ Game::Game() noexcept(false) :
     m_showHud(true),
     m_showCross(true),
     m_showGrid(false),
+    m_showFrameGraph(false),
     m_usingGamepad(false),
     m_wireframe(false),
     m_ccw(false),
@@ -51,8 +278,21 @@ Game::Game() noexcept(false) :
     m_fpscamera(false),
     m_boneMode(false),
     m_skinning(false),
+    m_bonesSkinned(false),
     m_toneMapMode(ToneMapPostProcess::Reinhard),
     m_updateEffects(false),
+    m_exposurePending{},
+    m_exposureMip(0),
+    m_exposureWidth(0),
+    m_exposureHeight(0),
+    m_exposureWrite(0),
+    m_exposureRead(0),
+    m_exposure(0.f),
+    m_autoExposureEnabled(false),
+    m_histogramValid(false),
+    m_hdrFormat(DX::HdrFormat::R16G16B16A16Float),
+    m_msaaSamples(1),
+    m_msaaSupported(1),
     m_selectFile(0),
     m_firstFile(0)
 {
@@ -61,12 +301,15 @@ Game::Game() noexcept(false) :
         DX::DeviceResources::c_EnableHDR);
 #else
     m_deviceResources = std::make_unique<DX::DeviceResources>(DXGI_FORMAT_R10G10B10A2_UNORM, DXGI_FORMAT_D32_FLOAT, 2,
-        D3D_FEATURE_LEVEL_10_0, DX::DeviceResources::c_EnableHDR);
+        D3D_FEATURE_LEVEL_10_0, DX::DeviceResources::c_EnableHDR | DX::DeviceResources::c_FrameLatencyWaitable);
     m_deviceResources->RegisterDeviceNotify(this);
 #endif
 
     m_hdrScene = std::make_unique<DX::RenderTexture>(DXGI_FORMAT_R16G16B16A16_FLOAT);
 
+    m_taskPool = std::make_unique<DX::TaskPool>();
+    m_occlusion = std::make_unique<DX::OcclusionCuller>(DX::OcclusionCuller::DefaultWidth, DX::OcclusionCuller::DefaultWidth, m_taskPool.get());
+
     m_clearColor = Colors::Black.v;
     m_uiColor = Colors::Yellow;
 
@@ -82,9 +325,18 @@ void Game::Initialize(IUnknown* window)
 void Game::Initialize(HWND window, int width, int height)
 #endif
 {
-    m_gamepad = std::make_unique<GamePad>();
-    m_keyboard = std::make_unique<Keyboard>();
-    m_mouse = std::make_unique<Mouse>();
+    auto startup = GetStartupTimer();
+    DX::ScopedPhase phase(startup, "Game::Initialize");
+
+    DX::FrameProfiler::SetThreadName("Main thread");
+
+    {
+        DX::ScopedPhase input(startup, "Input devices");
+
+        m_gamepad = std::make_unique<GamePad>();
+        m_keyboard = std::make_unique<Keyboard>();
+        m_mouse = std::make_unique<Mouse>();
+    }
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
     m_deviceResources->SetWindow(window);
@@ -93,10 +345,16 @@ void Game::Initialize(HWND window, int width, int height)
     m_mouse->SetWindow(window);
 #endif
 
-    m_deviceResources->CreateDeviceResources();
+    {
+        DX::ScopedPhase device(startup, "DeviceResources::CreateDeviceResources");
+        m_deviceResources->CreateDeviceResources();
+    }
     CreateDeviceDependentResources();
 
-    m_deviceResources->CreateWindowSizeDependentResources();
+    {
+        DX::ScopedPhase swapChain(startup, "DeviceResources::CreateWindowSizeDependentResources");
+        m_deviceResources->CreateWindowSizeDependentResources();
+    }
     CreateWindowSizeDependentResources();
 }
 
@@ -104,6 +362,23 @@ void Game::Initialize(HWND window, int width, int height)
 // Executes basic game loop.
 void Game::Tick()
 {
+    // Traced frames run from the start of one Tick to the next.
+    if (DX::FrameProfiler::EndFrame())
+    {
+        ExportFrameTrace();
+    }
+
+    if (m_frameTraceRequested)
+    {
+        m_frameTraceRequested = false;
+        DX::FrameProfiler::BeginCapture(m_frameTraceLength);
+    }
+
+    {
+        DX::ProfileScope wait("Wait");
+        WaitForNextFrame();
+    }
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -111,19 +386,118 @@ void Game::Tick()
 
     m_mouse->EndOfInputFrame();
 
-    Render();
+    TrackRenderState();
+
+    m_idle = !m_framePacer.ShouldRender(m_renderState.IsDirty());
+    if (m_idle)
+    {
+        m_framePacer.EndFrame(false);
+        return;
+    }
+
+    if (m_showGpuTimes || DX::FrameProfiler::IsCapturing())
+    {
+        m_gpuTimer.BeginFrame();
+    }
+
+    if (!m_startupComplete && m_timer.GetFrameCount())
+    {
+        // The first presented frame marks the end of startup.
+        {
+            DX::ScopedPhase phase(&m_startupTimer, "First frame");
+            Render();
+        }
+
+        OnStartupComplete();
+    }
+    else if (m_renderState.IsDirty(~c_ToneMapState) || !m_timer.GetFrameCount())
+    {
+        Render();
+    }
+    else
+    {
+        // Nothing in the scene or HUD changed, so re-present the previous HDR frame.
+        ToneMapAndPresent();
+    }
+
+    m_timer.EndFrame();
+    m_framePacer.EndFrame(true);
+}
+
+// Waits on the swap chain and/or the frame pacer before sampling input for the next frame
+void Game::WaitForNextFrame()
+{
+    if (m_idle)
+    {
+        // Don't let the time spent idle show up as one long frame.
+        m_timer.ResetElapsedTime();
+    }
+
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    m_deviceResources->WaitForFrameLatency();
+#endif
+
+    m_sleepTimer.SleepFor(m_framePacer.GetWaitSeconds());
+    m_framePacer.BeginFrame();
+}
+
+// Records everything that affects the rendered image; any change marks the frame dirty
+void Game::TrackRenderState()
+{
+    m_renderState.Track(RenderState_Camera, m_view, m_proj);
+    m_renderState.Track(RenderState_World, m_world);
+    m_renderState.Track(RenderState_Model, m_model.get(), m_scene.get(), m_streaming.get());
+    m_renderState.Track(RenderState_IBL, m_ibl);
+    m_renderState.Track(RenderState_Wireframe, m_wireframe, m_ccw);
+    m_renderState.Track(RenderState_Lighting, m_lighting);
+    m_renderState.Track(RenderState_Bones, m_boneMode, m_skinning);
+    m_renderState.Track(RenderState_WindowSize, m_deviceResources->GetOutputSize());
+    m_renderState.Track(RenderState_Scene, m_clearColor, m_showGrid, m_showCross, m_gridScale, m_gridDivs);
+    m_renderState.Track(RenderState_HUD, m_showHud, m_uiColor, m_sensitivity, m_usingGamepad, m_fpscamera,
+        m_framePacer.GetMode(), m_framePacer.GetTargetFramesPerSecond(), m_selectFile, m_firstFile, m_fileNames.size(), m_fontConsolas.get(),
+        m_autoExposureEnabled, m_showGpuTimes, m_showMemory, m_memory.GetTotalBytes(), m_hasPick, m_pick,
+        m_showFrameGraph, m_timer.GetFrameTimeHistory().GetBudget());
+    m_renderState.Track(RenderState_Status, m_szStatus, m_szError);
+    m_renderState.Track(RenderState_Section, m_sectionMode, m_sectionEnabled, m_sectionSelected, m_sectionOffsets);
+    m_renderState.Track(RenderState_Occlusion, m_occlusionEnabled);
+    m_renderState.Track(RenderState_Transparency, m_transparencyMode);
+    m_renderState.Track(RenderState_HdrTarget, m_hdrFormat, m_msaaSamples);
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    m_renderState.Track(RenderState_ToneMap, m_toneMapMode, m_autoExposureEnabled, m_exposure);
+#else
+    m_renderState.Track(RenderState_ToneMap, m_toneMapMode, m_autoExposureEnabled, m_exposure, m_deviceResources->GetColorSpace());
+#endif
+
+    if (m_showFrameGraph || m_showGpuTimes)
+    {
+        // The graph and GPU times change every frame.
+        m_renderState.Invalidate(1u << RenderState_HUD);
+    }
+
+    if (m_streaming && m_streaming->IsLoading())
+    {
+        // Keep drawing until every visible mesh has its buffers.
+        m_renderState.Invalidate(1u << RenderState_Model);
+    }
 }
 
 // Updates the world
 void Game::Update(DX::StepTimer const& timer)
 {
+    DX::ProfileScope update("Update");
+
     if (m_reloadModel)
         LoadModel();
 
+    UpdateMemoryUsage();
+
     float elapsedTime = float(timer.GetElapsedSeconds());
 
     float handed = (m_lhcoords) ? 1.f : -1.f;
 
+    DX::ProfileScope input("Input");
+
     auto gpad = m_gamepad->GetState(0);
     if (gpad.IsConnected())
     {
@@ -302,7 +676,7 @@ void Game::Update(DX::StepTimer const& timer)
 
             if (m_gamepadButtonTracker.leftStick == GamePad::ButtonStateTracker::PRESSED)
             {
-                CameraHome();
+                CameraHome(true);
                 m_modelRot = Quaternion::Identity;
             }
 
@@ -383,7 +757,7 @@ void Game::Update(DX::StepTimer const& timer)
         // Other keyboard controls
         if (kb.Home)
         {
-            CameraHome();
+            CameraHome(true);
         }
 
         if (kb.End)
@@ -437,6 +811,106 @@ void Game::Update(DX::StepTimer const& timer)
         if (m_keyboardTracker.pressed.N)
             CycleBoneRenderMode();
 
+        if (m_keyboardTracker.pressed.P)
+        {
+            if (kb.LeftShift || kb.RightShift)
+                CycleFrameBudget();
+            else
+                m_showFrameGraph = !m_showFrameGraph;
+        }
+
+        if (m_keyboardTracker.pressed.F2)
+            ExportFrameTimes();
+
+        if (m_keyboardTracker.pressed.F3 && !DX::FrameProfiler::IsCapturing())
+            m_frameTraceRequested = true;
+
+        if (m_keyboardTracker.pressed.F4)
+            ExportMemoryUsage();
+
+        if (m_keyboardTracker.pressed.F5)
+            m_showGpuTimes = !m_showGpuTimes;
+
+        if (m_keyboardTracker.pressed.F6)
+            SetHdrTarget(m_hdrFormat, DX::GetNextSampleCount(m_msaaSamples, m_msaaSupported));
+
+        if (m_keyboardTracker.pressed.F7)
+        {
+            SetHdrTarget(static_cast<DX::HdrFormat>((static_cast<uint32_t>(m_hdrFormat) + 1) % static_cast<uint32_t>(DX::HdrFormat::Count)),
+                m_msaaSamples);
+        }
+
+        if (m_keyboardTracker.pressed.M)
+        {
+            m_showMemory = !m_showMemory;
+            m_memoryDirty = true;
+        }
+
+        if (m_keyboardTracker.pressed.V)
+        {
+            if (kb.LeftShift || kb.RightShift)
+                CycleTargetFrameRate();
+            else
+                CycleFramePacing();
+        }
+
+        if (m_keyboardTracker.pressed.X)
+            ToggleAutoExposure();
+
+        if (m_keyboardTracker.pressed.Space)
+        {
+            // Under the cross, at the center of the view.
+            auto const size = m_deviceResources->GetOutputSize();
+            m_pickPosition = XMFLOAT2(float(size.right - size.left) * 0.5f, float(size.bottom - size.top) * 0.5f);
+            m_pickRequested = true;
+        }
+
+        if (m_keyboardTracker.pressed.K)
+            CycleSectionMode();
+
+        if (m_keyboardTracker.pressed.Y)
+            m_occlusionEnabled = !m_occlusionEnabled;
+
+        if (m_keyboardTracker.pressed.I)
+        {
+            m_transparencyMode = static_cast<DX::TransparencyMode>((static_cast<uint32_t>(m_transparencyMode) + 1)
+                % static_cast<uint32_t>(DX::TransparencyMode::Count));
+        }
+
+        for (uint32_t j = 0; j < DX::SectionPlanes::MaxPlanes; ++j)
+        {
+            if (m_keyboardTracker.IsKeyPressed(static_cast<Keyboard::Keys>(Keyboard::D1 + j)))
+            {
+                // Selects the plane to move, and in planes mode turns it on or off.
+                m_sectionSelected = j;
+                if (m_sectionMode == SectionMode_Planes)
+                {
+                    m_sectionEnabled ^= 1u << j;
+                }
+            }
+        }
+
+        if (m_sectionMode != SectionMode_Off && (kb.OemComma || kb.OemPeriod))
+        {
+            // Along the selected plane's axis; SHIFT for finer steps. A box's faces can't
+            // pass each other.
+            const float step = elapsedTime * ((kb.LeftShift || kb.RightShift) ? 0.05f : 0.25f);
+            float& offset = m_sectionOffsets[m_sectionSelected];
+            offset = std::min(1.f, std::max(0.f, offset + ((kb.OemPeriod) ? step : -step)));
+
+            if (m_sectionMode == SectionMode_Box)
+            {
+                const float opposite = m_sectionOffsets[m_sectionSelected ^ 1];
+                offset = (m_sectionSelected & 1) ? std::max(offset, opposite) : std::min(offset, opposite);
+            }
+        }
+
+        if (m_keyboardTracker.pressed.F)
+            FocusOnPick();
+
+        if (m_keyboardTracker.pressed.Z)
+            FrameSelection(kb.LeftShift || kb.RightShift);
+
         if (m_keyboardTracker.pressed.O)
         {
             PostMessage(m_deviceResources->GetWindow(), WM_USER, 0, 0);
@@ -507,6 +981,12 @@ void Game::Update(DX::StepTimer const& timer)
             else if (m_mouseButtonTracker.rightButton == Mouse::ButtonStateTracker::RELEASED)
                 m_mouse->SetMode(Mouse::MODE_ABSOLUTE);
 
+            if (m_mouseButtonTracker.middleButton == Mouse::ButtonStateTracker::PRESSED && mouse.positionMode == Mouse::MODE_ABSOLUTE)
+            {
+                m_pickPosition = XMFLOAT2(float(mouse.x), float(mouse.y));
+                m_pickRequested = true;
+            }
+
             if (m_mouseButtonTracker.leftButton == Mouse::ButtonStateTracker::PRESSED)
             {
                 if (kb.LeftShift || kb.RightShift)
@@ -527,6 +1007,14 @@ void Game::Update(DX::StepTimer const& timer)
     }
 #endif
 
+    input.End();
+
+    UpdateSectionPlanes();
+
+    DX::ProfileScope camera("Camera update");
+
+    AnimateCamera(elapsedTime);
+
     // Update camera
     Vector3 dir = Vector3::Transform((m_lhcoords) ? Vector3::Forward : Vector3::Backward, m_cameraRot);
     Vector3 up = Vector3::Transform(Vector3::Up, m_cameraRot);
@@ -543,6 +1031,64 @@ void Game::Update(DX::StepTimer const& timer)
     }
 
     m_world = Matrix::CreateFromQuaternion(m_modelRot);
+
+    camera.End();
+
+    if (m_pickRequested)
+    {
+        Pick();
+    }
+
+    UpdateExposure(elapsedTime);
+}
+
+// Reads back the oldest finished exposure capture and adapts toward its histogram
+void Game::UpdateExposure(float elapsedTime)
+{
+    if (!m_autoExposureEnabled)
+        return;
+
+    DX::ProfileScope scope("Exposure update");
+
+    if (m_exposurePending[m_exposureRead])
+    {
+        auto context = m_deviceResources->GetD3DDeviceContext();
+        auto readback = m_exposureReadback[m_exposureRead].Get();
+
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+        HRESULT hr = context->Map(readback, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+        if (SUCCEEDED(hr))
+        {
+            if (m_hdrScene->GetFormat() == DXGI_FORMAT_R11G11B10_FLOAT)
+            {
+                m_autoExposure.BuildHistogram(static_cast<const PackedVector::XMFLOAT3PK*>(mapped.pData),
+                    mapped.RowPitch / sizeof(PackedVector::XMFLOAT3PK), m_exposureWidth, m_exposureHeight,
+                    m_luminanceHistogram);
+            }
+            else
+            {
+                m_autoExposure.BuildHistogram(static_cast<const PackedVector::XMHALF4*>(mapped.pData),
+                    mapped.RowPitch / sizeof(PackedVector::XMHALF4), m_exposureWidth, m_exposureHeight,
+                    m_luminanceHistogram);
+            }
+
+            context->Unmap(readback, 0);
+
+            m_histogramValid = true;
+            m_exposurePending[m_exposureRead] = false;
+            m_exposureRead = (m_exposureRead + 1) % s_nExposureReadback;
+        }
+        else if (hr != DXGI_ERROR_WAS_STILL_DRAWING)
+        {
+            DX::ThrowIfFailed(hr);
+        }
+    }
+
+    // Keep adapting toward the last histogram between readbacks.
+    if (m_histogramValid)
+    {
+        m_exposure = m_autoExposure.Update(m_luminanceHistogram, elapsedTime);
+    }
 }
 #pragma endregion
 
@@ -554,22 +1100,28 @@ void Game::Render()
     if (m_timer.GetFrameCount() == 0)
         return;
 
+    DX::ProfileScope render("Render");
+
     if (m_updateEffects)
     {
+        DX::ProfileScope effects("Effect update");
+
         m_updateEffects = false;
 
+        bool resetlayouts = false;
+        auto setLighting = [&](IEffect* effect)
+            {
+                auto fx = dynamic_cast<BasicEffect*>(effect);
+                if (fx)
+                {
+                    fx->SetLightingEnabled(m_lighting);
+                    resetlayouts = true;
+                }
+            };
+
         if (m_model)
         {
-            bool resetlayouts = false;
-            m_model->UpdateEffects([&](IEffect* effect)
-                {
-                    auto fx = dynamic_cast<BasicEffect*>(effect);
-                    if (fx)
-                    {
-                        fx->SetLightingEnabled(m_lighting);
-                        resetlayouts = true;
-                    }
-                });
+            m_model->UpdateEffects(setLighting);
 
             if (resetlayouts)
             {
@@ -584,6 +1136,26 @@ void Game::Render()
                 }
             }
         }
+
+        if (m_scene)
+        {
+            m_scene->UpdateEffects(setLighting);
+
+            if (resetlayouts)
+            {
+                m_scene->CreateInputLayouts(m_deviceResources->GetD3DDevice());
+            }
+        }
+
+        if (m_streaming)
+        {
+            m_streaming->UpdateEffects(setLighting);
+
+            if (resetlayouts)
+            {
+                m_streaming->CreateInputLayouts(m_deviceResources->GetD3DDevice());
+            }
+        }
     }
 
     Clear();
@@ -592,6 +1164,8 @@ void Game::Render()
 
     if (!m_fileNames.empty())
     {
+        m_gpuTimer.BeginPass(GpuPass_HUD);
+
         m_spriteBatch->Begin();
 
         const RECT rct = Viewport::ComputeTitleSafeArea(size.right, size.bottom);
@@ -615,11 +1189,16 @@ void Game::Render()
         }
 
         m_spriteBatch->End();
+
+        m_gpuTimer.EndPass(GpuPass_HUD);
     }
     else
     {
+        m_gpuTimer.BeginPass(GpuPass_Grid);
+
         if (m_showGrid)
         {
+            DX::ProfileScope grid("Grid");
             DrawGrid();
         }
 
@@ -628,7 +1207,9 @@ void Game::Render()
             DrawCross();
         }
 
-        if (!m_model)
+        m_gpuTimer.EndPass(GpuPass_Grid);
+
+        if (!m_model && !m_scene && !m_streaming)
         {
             m_spriteBatch->Begin();
 
@@ -645,66 +1226,24 @@ void Game::Render()
         }
         else
         {
-            auto context = m_deviceResources->GetD3DDeviceContext();
-
-            if (!m_model->bones.empty())
+            if (m_scene)
             {
-                const size_t nbones = m_model->bones.size();
-                assert(m_bones != 0);
-                m_model->CopyAbsoluteBoneTransformsTo(nbones, m_bones.get());
-                if (m_skinning)
-                {
-                    for (size_t j = 0; j < nbones; ++j)
-                    {
-                        m_bones[j] = XMMatrixMultiply(m_model->invBindPoseMatrices[j], m_bones[j]);
-                    }
-                }
+                DrawScene();
+            }
+            else if (m_streaming)
+            {
+                DrawStreaming();
+            }
+            else
+            {
+                DrawModel();
             }
 
-            D3D11_SHADER_RESOURCE_VIEW_DESC desc;
-            m_radianceIBL[m_ibl]->GetDesc(&desc);
-
-            m_model->UpdateEffects([&](IEffect* effect)
+            if (*m_szStatus && m_showHud && m_fontConsolas)
             {
-                auto pbr = dynamic_cast<PBREffect*>(effect);
-                if (pbr)
-                {
-                    pbr->SetIBLTextures(m_radianceIBL[m_ibl].Get(), desc.TextureCube.MipLevels, m_irradianceIBL[m_ibl].Get());
-                }
-
-                if (m_skinning && !m_boneMode)
-                {
-                    auto skinning = dynamic_cast<IEffectSkinning*>(effect);
-                    if (skinning)
-                    {
-                        skinning->ResetBoneTransforms();
-                    }
-                }
-            });
-
-            for (auto& mit : m_model->meshes)
-            {
-                mit->ccw = m_ccw;
-            }
-
-            if (m_boneMode)
-            {
-                if (m_skinning)
-                {
-                    m_model->DrawSkinned(context, *m_states, m_model->bones.size(), m_bones.get(), m_world, m_view, m_proj, m_wireframe);
-                }
-                else
-                {
-                    m_model->Draw(context, *m_states, m_model->bones.size(), m_bones.get(), m_world, m_view, m_proj, m_wireframe);
-                }
-            }
-            else
-            {
-                m_model->Draw(context, *m_states, m_world, m_view, m_proj, m_wireframe);
-            }
+                DX::ProfileScope hud("HUD");
+                m_gpuTimer.BeginPass(GpuPass_HUD);
 
-            if (*m_szStatus && m_showHud)
-            {
                 m_spriteBatch->Begin();
 
                 Vector3 up = Vector3::TransformNormal(Vector3::Up, m_view);
@@ -759,10 +1298,152 @@ void Game::Render()
                     viewMode = (m_model && !m_model->bones.empty()) ? L"Ignoring model bones" : L"";
                 }
 
-                wchar_t szState[128] = {};
-                swprintf_s(szState, L"%-20ls    Tone-mapping operator: %-12ls    %ls    %ls", mode, toneMap, viewMode,
+                wchar_t szPacing[32] = {};
+                const auto pacing = m_framePacer.GetMode();
+                if (pacing == DX::FramePacing::Capped || pacing == DX::FramePacing::LowLatency)
+                {
+                    swprintf_s(szPacing, L"%ls (%.0f)", c_FramePacingNames[static_cast<size_t>(pacing)], m_framePacer.GetTargetFramesPerSecond());
+                }
+                else
+                {
+                    wcscpy_s(szPacing, c_FramePacingNames[static_cast<size_t>(pacing)]);
+                }
+
+                wchar_t szTarget[48] = {};
+                if (m_msaaSamples > 1)
+                {
+                    swprintf_s(szTarget, L"%ls %ux MSAA", DX::GetHdrFormatName(m_hdrFormat), m_msaaSamples);
+                }
+                else
+                {
+                    wcscpy_s(szTarget, DX::GetHdrFormatName(m_hdrFormat));
+                }
+
+                wchar_t szState[320] = {};
+                swprintf_s(szState, L"%-20ls    Tone-mapping operator: %-12ls    Exposure: %-6ls    Scene: %-28ls    Pacing: %-16ls    %ls    %ls", mode, toneMap,
+                    m_autoExposureEnabled ? L"Auto" : L"Fixed", szTarget, szPacing, viewMode,
                     m_lighting ? L"" : L"Lighting Off");
 
+                wchar_t szGpu[256] = {};
+                if (m_showGpuTimes)
+                {
+                    int len = swprintf_s(szGpu, L"GPU (ms):");
+                    for (size_t pass = 0; pass < GpuPass_Count && len > 0; ++pass)
+                    {
+                        const float ms = m_gpuTimer.GetPassMilliseconds(pass);
+                        len += (ms >= 0.f)
+                            ? swprintf_s(szGpu + len, _countof(szGpu) - size_t(len), L"    %ls %6.3f", c_GpuPassNames[pass], ms)
+                            : swprintf_s(szGpu + len, _countof(szGpu) - size_t(len), L"    %ls   --  ", c_GpuPassNames[pass]);
+                    }
+
+                    if (len > 0)
+                    {
+                        swprintf_s(szGpu + len, _countof(szGpu) - size_t(len), L"    Frame %6.3f    Skipped %llu",
+                            std::max(m_gpuTimer.GetFrameMilliseconds(), 0.f), m_gpuTimer.GetSkippedFrames());
+                    }
+                }
+
+                wchar_t szMemory[256] = {};
+                if (m_showMemory)
+                {
+                    using DX::MemoryCategory;
+                    const bool overBudget = m_memoryBudget && m_modelMemory > m_memoryBudget;
+                    swprintf_s(szMemory, L"Memory (MB):    VB %.2f    IB %.2f    Textures %.2f    Targets %.2f    Depth %.2f    CPU %.2f    Total %.2f    Model %.2f%ls",
+                        ToMegabytes(m_memory.GetTotal(MemoryCategory::VertexBuffers).bytes),
+                        ToMegabytes(m_memory.GetTotal(MemoryCategory::IndexBuffers).bytes),
+                        ToMegabytes(m_memory.GetTotal(MemoryCategory::Textures).bytes),
+                        ToMegabytes(m_memory.GetTotal(MemoryCategory::RenderTargets).bytes),
+                        ToMegabytes(m_memory.GetTotal(MemoryCategory::DepthBuffers).bytes),
+                        ToMegabytes(m_memory.GetTotal(MemoryCategory::CpuData).bytes),
+                        ToMegabytes(m_memory.GetTotalBytes()),
+                        ToMegabytes(m_modelMemory),
+                        overBudget ? L" (OVER BUDGET)" : L"");
+                }
+
+                wchar_t szScene[256] = {};
+                if (m_scene)
+                {
+                    auto const& stats = m_scene->GetStatistics();
+                    swprintf_s(szScene, L"Scene: %Iu instances of %Iu models    Meshes drawn: %Iu of %Iu    Shared (unique/loaded):    VB %Iu/%Iu    IB %Iu/%Iu    Textures %Iu/%Iu    Effects %Iu/%Iu",
+                        stats.instances, stats.models, m_scene->GetVisibleMeshes(), m_scene->GetTotalMeshes(),
+                        stats.vertexBuffers.unique, stats.vertexBuffers.loaded, stats.indexBuffers.unique, stats.indexBuffers.loaded,
+                        stats.textures.unique, stats.textures.loaded, stats.effects.unique, stats.effects.loaded);
+                }
+
+                wchar_t szStreaming[256] = {};
+                if (m_streaming)
+                {
+                    auto const& residency = m_streaming->GetResidency();
+                    auto const& stats = residency.GetStatistics();
+                    swprintf_s(szStreaming, L"Streaming (MB): %.2f of %.2f (peak %.2f)    Meshes drawn: %Iu of %Iu visible    Loads: %llu    Evictions: %llu    Loaded: %.2f%ls",
+                        ToMegabytes(stats.residentBytes), ToMegabytes(residency.GetSettings().budgetBytes), ToMegabytes(stats.peakResidentBytes),
+                        stats.drawableItems, stats.visibleItems, stats.totalLoads, stats.totalEvictions, ToMegabytes(stats.totalLoadedBytes),
+                        stats.failedResources ? L"    (LOAD FAILURES)" : L"");
+                }
+
+                wchar_t szPick[256] = {};
+                if (m_hasPick)
+                {
+                    wchar_t szMaterial[96] = L"none";
+                    if (m_pick.material != DX::ModelPicker::None)
+                    {
+                        swprintf_s(szMaterial, L"%u '%hs'", m_pick.material, m_picker.GetMaterialName(m_pick.material).c_str());
+                    }
+
+                    swprintf_s(szPick, L"Picked: mesh %u '%hs'    Subset: %u    Material: %ls    Triangle: %u    Distance: %.3f",
+                        m_pick.mesh, m_picker.GetMeshName(m_pick.mesh).c_str(), m_pick.part, szMaterial, m_pick.triangle, m_pick.distance);
+                }
+
+                wchar_t szSection[256] = {};
+                if (m_model && m_sectionMode != SectionMode_Off)
+                {
+                    wchar_t szPlanes[64] = {};
+                    for (uint32_t j = 0; j < DX::SectionPlanes::MaxPlanes; ++j)
+                    {
+                        if (m_sectionMode == SectionMode_Box || (m_sectionEnabled & (1u << j)))
+                        {
+                            wcscat_s(szPlanes, c_SectionPlaneNames[j]);
+                            wcscat_s(szPlanes, L" ");
+                        }
+                    }
+
+                    swprintf_s(szSection, L"Section: %ls    Planes: %ls   Selected: %ls at %.0f%%    Meshes drawn: %Iu of %Iu",
+                        c_SectionModeNames[m_sectionMode], (*szPlanes) ? szPlanes : L"none ",
+                        c_SectionPlaneNames[m_sectionSelected], m_sectionOffsets[m_sectionSelected] * 100.f,
+                        m_model->meshes.size() - m_sectionRejected, m_model->meshes.size());
+                }
+
+                wchar_t szOcclusion[256] = {};
+                if (m_occlusionEnabled && (m_model || m_scene))
+                {
+                    auto const& stats = m_occlusion->GetStatistics();
+                    if (m_wireframe || (m_model && m_boneMode && m_skinning))
+                    {
+                        swprintf_s(szOcclusion, L"Occlusion culling: paused for %ls", m_wireframe ? L"wireframe" : L"skinning");
+                    }
+                    else
+                    {
+                        const size_t culled = (m_model) ? m_occludedMeshes : m_scene->GetOccludedMeshes();
+                        const size_t tested = (m_model) ? m_model->meshes.size() : m_scene->GetVisibleMeshes() + culled;
+                        swprintf_s(szOcclusion, L"Occlusion culling: %Iu of %Iu meshes hidden    Occluders: %Iu (%Iu triangles)    Buffer: %Iux%Iu",
+                            culled, tested, stats.occluders, stats.triangles, m_occlusion->GetWidth(), m_occlusion->GetHeight());
+                    }
+                }
+
+                wchar_t szTransparency[128] = {};
+                if (m_model && !m_alphaParts.empty())
+                {
+                    if (m_boneMode && m_skinning && m_transparencyMode != DX::TransparencyMode::MeshOrder)
+                    {
+                        swprintf_s(szTransparency, L"Transparency: mesh order while skinning    Alpha parts: %Iu", m_alphaParts.size());
+                    }
+                    else
+                    {
+                        swprintf_s(szTransparency, L"Transparency: %ls    Alpha parts: %Iu",
+                            DX::GetTransparencyModeName(m_transparencyMode), m_alphaParts.size());
+                    }
+                }
+
                 wchar_t szMode[64] = {};
                 swprintf_s(szMode, L" %ls (Sensitivity: %8.4f)", (m_fpscamera) ? L"  FPS" : L"Orbit", m_sensitivity);
 
@@ -776,6 +1457,46 @@ void Game::Render()
                 m_fontConsolas->DrawString(m_spriteBatch.get(), m_szStatus, XMFLOAT2(float(rct.left), float(rct.top)), m_uiColor);
                 m_fontConsolas->DrawString(m_spriteBatch.get(), szCamera, XMFLOAT2(float(rct.left), float(rct.top + spacing)), m_uiColor);
                 m_fontConsolas->DrawString(m_spriteBatch.get(), szState, XMFLOAT2(float(rct.left), float(rct.top + spacing * 2.f)), m_uiColor);
+                float line = 3.f;
+                if (*szGpu)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szGpu, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szMemory)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szMemory, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szScene)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szScene, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szStreaming)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szStreaming, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szPick)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szPick, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szSection)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szSection, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szOcclusion)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szOcclusion, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szTransparency)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szTransparency, XMFLOAT2(float(rct.left), float(rct.top + spacing * line)), m_uiColor);
+                }
                 if (m_usingGamepad)
                 {
                     m_fontConsolas->DrawString(m_spriteBatch.get(), szMode, XMFLOAT2(float(rct.right) - modeLen.x, float(rct.bottom) - modeLen.y), m_uiColor);
@@ -784,6 +1505,46 @@ void Game::Render()
                 m_fontConsolas->DrawString(m_spriteBatch.get(), m_szStatus, XMFLOAT2(0, 10), m_uiColor);
                 m_fontConsolas->DrawString(m_spriteBatch.get(), szCamera, XMFLOAT2(0, 10 + spacing), m_uiColor);
                 m_fontConsolas->DrawString(m_spriteBatch.get(), szState, XMFLOAT2(0, 10 + spacing * 2.f), m_uiColor);
+                float line = 3.f;
+                if (*szGpu)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szGpu, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szMemory)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szMemory, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szScene)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szScene, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szStreaming)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szStreaming, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szPick)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szPick, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szSection)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szSection, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szOcclusion)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szOcclusion, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                    line += 1.f;
+                }
+                if (*szTransparency)
+                {
+                    m_fontConsolas->DrawString(m_spriteBatch.get(), szTransparency, XMFLOAT2(0, 10 + spacing * line), m_uiColor);
+                }
                 if (m_usingGamepad)
                 {
                     m_fontConsolas->DrawString(m_spriteBatch.get(), szMode, XMFLOAT2(size.right - modeLen.x, size.bottom - modeLen.y), m_uiColor);
@@ -791,16 +1552,288 @@ void Game::Render()
 #endif
 
                 m_spriteBatch->End();
+
+                m_gpuTimer.EndPass(GpuPass_HUD);
             }
         }
-    }
 
-    auto context = m_deviceResources->GetD3DDeviceContext();
+        if (m_showFrameGraph)
+        {
+            DX::ProfileScope graph("Frame graph");
+            DrawFrameGraph();
+        }
+    }
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
-    m_hdrScene->EndScene(context);
+    m_hdrScene->EndScene(m_deviceResources->GetD3DDeviceContext());
 #endif
 
+    m_hdrScene->Resolve(m_deviceResources->GetD3DDeviceContext());
+
+    CaptureExposure();
+
+    render.End();
+
+    ToneMapAndPresent();
+}
+
+// Draws the model with its bones and the current IBL
+void Game::DrawModel()
+{
+    auto context = m_deviceResources->GetD3DDeviceContext();
+
+    if (!m_model->bones.empty())
+    {
+        DX::ProfileScope bones("Bone transforms");
+
+        // Only bones whose local matrix changed, and their descendants, are recomputed;
+        // the viewer doesn't animate, so after loading that's none.
+        const size_t nbones = m_model->bones.size();
+        assert(m_bones != 0);
+        if (m_boneHierarchy.Update() > 0 || m_bonesSkinned != m_skinning)
+        {
+            for (size_t j = 0; j < nbones; ++j)
+            {
+                m_bones[j] = m_boneHierarchy.GetTransform(static_cast<uint32_t>(j));
+            }
+
+            if (m_skinning)
+            {
+                for (size_t j = 0; j < nbones; ++j)
+                {
+                    m_bones[j] = XMMatrixMultiply(m_model->invBindPoseMatrices[j], m_bones[j]);
+                }
+            }
+
+            m_bonesSkinned = m_skinning;
+            m_sectionBoxesDirty = true;
+        }
+    }
+
+    if (m_sections.IsEnabled())
+    {
+        DX::ProfileScope sections("Section planes");
+        ClassifySections();
+    }
+    else
+    {
+        m_sectionRejected = 0;
+    }
+
+    // Wireframe shows what is behind, and skinned vertices move away from the bounds.
+    if (m_occlusionEnabled && !m_wireframe && !(m_boneMode && m_skinning) && m_occluders.size() == m_model->meshes.size())
+    {
+        DX::ProfileScope occlusion("Occlusion culling");
+        CullOccludedMeshes();
+    }
+    else
+    {
+        m_occludedMeshes = 0;
+    }
+
+    DX::ProfileScope effects("Effect update");
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC desc = {};
+    if (m_radianceIBL[m_ibl])
+    {
+        m_radianceIBL[m_ibl]->GetDesc(&desc);
+    }
+
+    m_model->UpdateEffects([&](IEffect* effect)
+    {
+        auto pbr = dynamic_cast<PBREffect*>(effect);
+        if (pbr && m_radianceIBL[m_ibl])
+        {
+            pbr->SetIBLTextures(m_radianceIBL[m_ibl].Get(), desc.TextureCube.MipLevels, m_irradianceIBL[m_ibl].Get());
+        }
+
+        if (m_skinning && !m_boneMode)
+        {
+            auto skinning = dynamic_cast<IEffectSkinning*>(effect);
+            if (skinning)
+            {
+                skinning->ResetBoneTransforms();
+            }
+        }
+    });
+
+    for (auto& mit : m_model->meshes)
+    {
+        mit->ccw = m_ccw;
+    }
+
+    effects.End();
+
+    DX::ProfileScope draw("Draw");
+    m_gpuTimer.BeginPass(GpuPass_Scene);
+
+    // Skinned vertices move away from the centers alpha parts are sorted by.
+    const bool rejecting = m_sections.IsEnabled() || m_occludedMeshes > 0;
+    const bool alphaParts = m_transparencyMode != DX::TransparencyMode::MeshOrder && !m_alphaParts.empty()
+        && !(m_boneMode && m_skinning);
+
+    if (rejecting || alphaParts)
+    {
+        // Mesh by mesh, skipping the rejected ones, with the same transforms and order as
+        // the Model::Draw calls below: every opaque part, then every alpha part.
+        const size_t nbones = m_model->bones.size();
+        for (const bool alpha : { false, true })
+        {
+            if (alpha && alphaParts)
+            {
+                DrawAlphaParts(rejecting);
+                break;
+            }
+
+            for (size_t j = 0; j < m_model->meshes.size(); ++j)
+            {
+                if (rejecting && m_sectionResults[j] == DX::SectionPlanes::Result::Outside)
+                    continue;
+
+                auto mesh = m_model->meshes[j].get();
+                mesh->PrepareForRendering(context, *m_states, alpha, m_wireframe);
+
+                if (m_boneMode && m_skinning)
+                {
+                    mesh->DrawSkinned(context, nbones, m_bones.get(), m_world, m_view, m_proj, alpha);
+                }
+                else if (m_boneMode && mesh->boneIndex < nbones)
+                {
+                    mesh->Draw(context, XMMatrixMultiply(m_bones[mesh->boneIndex], m_world), m_view, m_proj, alpha);
+                }
+                else
+                {
+                    mesh->Draw(context, m_world, m_view, m_proj, alpha);
+                }
+            }
+        }
+    }
+    else if (m_boneMode)
+    {
+        if (m_skinning)
+        {
+            m_model->DrawSkinned(context, *m_states, m_model->bones.size(), m_bones.get(), m_world, m_view, m_proj, m_wireframe);
+        }
+        else
+        {
+            m_model->Draw(context, *m_states, m_model->bones.size(), m_bones.get(), m_world, m_view, m_proj, m_wireframe);
+        }
+    }
+    else
+    {
+        m_model->Draw(context, *m_states, m_world, m_view, m_proj, m_wireframe);
+    }
+
+    m_gpuTimer.EndPass(GpuPass_Scene);
+    draw.End();
+}
+
+// Draws every instance of the scene with the current IBL
+void Game::DrawScene()
+{
+    auto context = m_deviceResources->GetD3DDeviceContext();
+
+    DX::ProfileScope effects("Effect update");
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC desc = {};
+    if (m_radianceIBL[m_ibl])
+    {
+        m_radianceIBL[m_ibl]->GetDesc(&desc);
+    }
+
+    m_scene->UpdateEffects([&](IEffect* effect)
+    {
+        auto pbr = dynamic_cast<PBREffect*>(effect);
+        if (pbr && m_radianceIBL[m_ibl])
+        {
+            pbr->SetIBLTextures(m_radianceIBL[m_ibl].Get(), desc.TextureCube.MipLevels, m_irradianceIBL[m_ibl].Get());
+        }
+    });
+
+    m_scene->SetCounterClockwise(m_ccw);
+
+    effects.End();
+
+    DX::ProfileScope draw("Draw");
+    m_gpuTimer.BeginPass(GpuPass_Scene);
+
+    m_scene->Draw(context, *m_states, m_world, m_view, m_proj, !m_lhcoords, m_wireframe,
+        (m_occlusionEnabled && !m_wireframe) ? m_occlusion.get() : nullptr);
+
+    m_gpuTimer.EndPass(GpuPass_Scene);
+}
+
+// Brings in the buffers this view needs, then draws the meshes that have them
+void Game::DrawStreaming()
+{
+    auto context = m_deviceResources->GetD3DDeviceContext();
+
+    DX::ProfileScope effects("Effect update");
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC desc = {};
+    if (m_radianceIBL[m_ibl])
+    {
+        m_radianceIBL[m_ibl]->GetDesc(&desc);
+    }
+
+    m_streaming->UpdateEffects([&](IEffect* effect)
+    {
+        auto pbr = dynamic_cast<PBREffect*>(effect);
+        if (pbr && m_radianceIBL[m_ibl])
+        {
+            pbr->SetIBLTextures(m_radianceIBL[m_ibl].Get(), desc.TextureCube.MipLevels, m_irradianceIBL[m_ibl].Get());
+        }
+    });
+
+    m_streaming->SetCounterClockwise(m_ccw);
+
+    effects.End();
+
+    DX::ProfileScope residency("Residency");
+
+    const RECT size = m_deviceResources->GetOutputSize();
+    if (m_streaming->Update(m_deviceResources->GetD3DDevice(), m_world, m_view, m_proj, float(size.bottom - size.top), !m_lhcoords))
+    {
+        m_memoryDirty = true;
+    }
+
+    residency.End();
+
+    DX::ProfileScope draw("Draw");
+    m_gpuTimer.BeginPass(GpuPass_Scene);
+
+    m_streaming->Draw(context, *m_states, m_world, m_view, m_proj, m_wireframe);
+
+    m_gpuTimer.EndPass(GpuPass_Scene);
+}
+
+// Downsamples the HDR scene and queues a copy for the auto-exposure histogram
+void Game::CaptureExposure()
+{
+    if (!m_autoExposureEnabled || !m_exposureMips || m_exposurePending[m_exposureWrite])
+        return;
+
+    DX::ProfileScope scope("Exposure capture");
+
+    auto context = m_deviceResources->GetD3DDeviceContext();
+
+    context->CopySubresourceRegion(m_exposureMips.Get(), 0, 0, 0, 0, m_hdrScene->GetRenderTarget(), 0, nullptr);
+    context->GenerateMips(m_exposureMipsSRV.Get());
+    context->CopySubresourceRegion(m_exposureReadback[m_exposureWrite].Get(), 0, 0, 0, 0, m_exposureMips.Get(), m_exposureMip, nullptr);
+
+    m_exposurePending[m_exposureWrite] = true;
+    m_exposureWrite = (m_exposureWrite + 1) % s_nExposureReadback;
+}
+
+// Tone-maps the HDR scene into the swap chain and presents it
+void Game::ToneMapAndPresent()
+{
+    DX::ProfileScope toneMapScope("Tone map");
+
+    auto context = m_deviceResources->GetD3DDeviceContext();
+
+    m_gpuTimer.BeginPass(GpuPass_ToneMap);
+
     m_toneMap->SetHDRSourceTexture(m_hdrScene->GetShaderResourceView());
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
@@ -830,17 +1863,30 @@ void Game::Render()
         break;
     }
 #endif
+    m_toneMap->SetExposure(m_autoExposureEnabled ? m_exposure : 0.f);
     m_toneMap->Process(context);
 
     // Clear binding to avoid SDK debug warning
     ID3D11ShaderResourceView* nullsrv[] = { nullptr, nullptr };
     context->PSSetShaderResources(0, 2, nullsrv);
 
-    m_deviceResources->Present();
+    m_gpuTimer.EndPass(GpuPass_ToneMap);
+    toneMapScope.End();
+
+    m_gpuTimer.EndFrame();
+    TraceGpuTimes();
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    m_deviceResources->Present();
+#else
+    m_deviceResources->Present(m_framePacer.GetSyncInterval());
+#endif
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
     m_graphicsMemory->Commit();
 #endif
+
+    m_renderState.Clear();
 }
 
 // Helper method to clear the backbuffers
@@ -850,7 +1896,12 @@ void Game::Clear()
 
     // Clear the views.
     auto renderTarget = m_hdrScene->GetRenderTargetView();
-    auto depthStencil = m_deviceResources->GetDepthStencilView();
+    auto depthStencil = m_hdrScene->GetDepthStencilView();
+    if (!depthStencil)
+    {
+        // Only a multisampled scene has a depth buffer of its own.
+        depthStencil = m_deviceResources->GetDepthStencilView();
+    }
 
     context->ClearRenderTargetView(renderTarget, m_clearColor);
     context->ClearDepthStencilView(depthStencil, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
@@ -913,6 +1964,7 @@ void Game::OnWindowSizeChanged(int width, int height)
         return;
 
     CreateWindowSizeDependentResources();
+    m_renderState.Invalidate();
 }
 #endif
 
@@ -925,6 +1977,39 @@ void Game::OnFileOpen(const wchar_t* filename)
     m_reloadModel = true;
 }
 
+void Game::SetStartupOptions(bool fastStart, bool report, const wchar_t* traceFile)
+{
+    m_fastStart = fastStart;
+    m_startupReport = report;
+    m_startupTraceFile = (traceFile) ? traceFile : L"";
+}
+
+void Game::SetFramePacing(DX::FramePacing mode, double targetFPS)
+{
+    m_framePacer.SetMode(mode);
+    if (targetFPS > 0.0)
+    {
+        m_framePacer.SetTargetFramesPerSecond(targetFPS);
+    }
+}
+
+void Game::SetFrameTraceLength(uint32_t frameCount) noexcept
+{
+    if (frameCount > 0)
+    {
+        m_frameTraceLength = frameCount;
+    }
+}
+
+DWORD Game::GetIdleTimeout() const noexcept
+{
+    if (!m_idle)
+        return 0;
+
+    // Gamepads are polled rather than message driven, so keep checking them at a steady rate.
+    return (m_usingGamepad) ? 16 : 250;
+}
+
 // Properties
 void Game::GetDefaultSize(int& width, int& height) const noexcept
 {
@@ -937,6 +2022,9 @@ void Game::GetDefaultSize(int& width, int& height) const noexcept
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    auto startup = GetStartupTimer();
+    DX::ScopedPhase phase(startup, "CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
     auto context = m_deviceResources->GetD3DDeviceContext();
 
@@ -944,22 +2032,36 @@ void Game::CreateDeviceDependentResources()
     m_graphicsMemory = std::make_unique<GraphicsMemory>(device, m_deviceResources->GetBackBufferCount());
 #endif
 
+    // Falls back to fewer samples if a new device can't do as many.
+    const DXGI_FORMAT hdrFormat = DX::GetHdrFormat(m_hdrFormat);
+    m_msaaSupported = DX::RenderTexture::GetSupportedSampleCounts(device, hdrFormat, m_deviceResources->GetDepthBufferFormat());
+    m_msaaSamples = DX::ChooseSampleCount(m_msaaSamples, m_msaaSupported);
+    m_hdrScene->SetFormat(hdrFormat, m_msaaSamples);
     m_hdrScene->SetDevice(device);
 
     m_spriteBatch = std::make_unique<SpriteBatch>(context);
 
     m_states = std::make_unique<CommonStates>(device);
 
-    m_lineEffect = std::make_unique<BasicEffect>(device);
-    m_lineEffect->SetVertexColorEnabled(true);
+    m_gpuQueries = std::make_unique<DX::GpuTimerQueriesD3D11>(device, context);
+    m_gpuTimer.SetQueries(m_gpuQueries.get());
+
+    {
+        DX::ScopedPhase toneMap(startup, "ToneMapPostProcess");
 
-    m_toneMap = std::make_unique<ToneMapPostProcess>(device);
+        m_toneMap = std::make_unique<ToneMapPostProcess>(device);
 #if defined(_XBOX_ONE) && defined(_TITLE)
-    m_toneMap->SetMRTOutput(true);
+        m_toneMap->SetMRTOutput(true);
 #endif
-    m_toneMap->SetTransferFunction(ToneMapPostProcess::SRGB);
+        m_toneMap->SetTransferFunction(ToneMapPostProcess::SRGB);
+    }
 
     {
+        DX::ScopedPhase lineEffect(startup, "BasicEffect");
+
+        m_lineEffect = std::make_unique<BasicEffect>(device);
+        m_lineEffect->SetVertexColorEnabled(true);
+
         void const* shaderByteCode;
         size_t byteCodeLength;
 
@@ -971,8 +2073,43 @@ void Game::CreateDeviceDependentResources()
 
     m_lineBatch = std::make_unique<PrimitiveBatch<VertexPositionColor>>(context);
 
+    {
+        // The two passes of DrawAlphaParts' weighted blended transparency.
+        CD3D11_BLEND_DESC desc(D3D11_DEFAULT);
+        auto& target = desc.RenderTarget[0];
+        target.BlendEnable = TRUE;
+        target.SrcBlend = target.SrcBlendAlpha = D3D11_BLEND_ZERO;
+        target.DestBlend = target.DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+        DX::ThrowIfFailed(device->CreateBlendState(&desc, m_revealageBlend.ReleaseAndGetAddressOf()));
+
+        target.SrcBlend = target.SrcBlendAlpha = D3D11_BLEND_ONE;
+        target.DestBlend = target.DestBlendAlpha = D3D11_BLEND_ONE;
+        DX::ThrowIfFailed(device->CreateBlendState(&desc, m_accumulateBlend.ReleaseAndGetAddressOf()));
+    }
+
     m_world = Matrix::Identity;
 
+    {
+        DX::ScopedPhase ibl(startup, "IBL textures");
+
+        for (size_t j = 0; j < s_nIBL; ++j)
+        {
+            // Fast-start only loads the active IBL before the first frame is presented.
+            if (m_fastStart && !m_startupComplete && j != m_ibl)
+            {
+                m_deferredResources = true;
+                continue;
+            }
+
+            CreateIBL(j);
+        }
+    }
+}
+
+void Game::CreateIBL(size_t index)
+{
+    auto device = m_deviceResources->GetD3DDevice();
+
     static const wchar_t* s_radianceIBL[s_nIBL] =
     {
         L"Atrium_diffuseIBL.dds",
@@ -988,56 +2125,214 @@ void Game::CreateDeviceDependentResources()
 
     static_assert(_countof(s_radianceIBL) == _countof(s_irradianceIBL), "IBL array mismatch");
 
-    for (size_t j = 0; j < s_nIBL; ++j)
-    {
-        wchar_t radiance[_MAX_PATH] = {};
-        wchar_t irradiance[_MAX_PATH] = {};
+    if (index >= s_nIBL)
+        return;
+
+    wchar_t radiance[_MAX_PATH] = {};
+    wchar_t irradiance[_MAX_PATH] = {};
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
-        wcscpy_s(radiance, s_radianceIBL[j]);
-        wcscpy_s(irradiance, s_irradianceIBL[j]);
+    wcscpy_s(radiance, s_radianceIBL[index]);
+    wcscpy_s(irradiance, s_irradianceIBL[index]);
 #else
-        DX::FindMediaFile(radiance, _MAX_PATH, s_radianceIBL[j]);
-        DX::FindMediaFile(irradiance, _MAX_PATH, s_irradianceIBL[j]);
+    DX::FindMediaFile(radiance, _MAX_PATH, s_radianceIBL[index]);
+    DX::FindMediaFile(irradiance, _MAX_PATH, s_irradianceIBL[index]);
 #endif
 
-        DX::ThrowIfFailed(
-            CreateDDSTextureFromFile(device, radiance, nullptr, m_radianceIBL[j].ReleaseAndGetAddressOf())
-        );
+    DX::ThrowIfFailed(
+        CreateDDSTextureFromFile(device, radiance, nullptr, m_radianceIBL[index].ReleaseAndGetAddressOf())
+    );
 
-        DX::ThrowIfFailed(
-            CreateDDSTextureFromFile(device, irradiance, nullptr, m_irradianceIBL[j].ReleaseAndGetAddressOf())
-        );
-    }
+    DX::ThrowIfFailed(
+        CreateDDSTextureFromFile(device, irradiance, nullptr, m_irradianceIBL[index].ReleaseAndGetAddressOf())
+    );
+
+    m_memoryDirty = true;
 }
 
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    auto startup = GetStartupTimer();
+    DX::ScopedPhase phase(startup, "CreateWindowSizeDependentResources");
+
     auto size = m_deviceResources->GetOutputSize();
 
     auto device = m_deviceResources->GetD3DDevice();
 
-    wchar_t consolasFont[_MAX_PATH] = {};
-    wchar_t comicFont[_MAX_PATH] = {};
+    {
+        DX::ScopedPhase fonts(startup, "Fonts");
+
+        wchar_t comicFont[_MAX_PATH] = {};
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
-    wcscpy_s(consolasFont, (size.bottom > 1080) ? L"consolas4k.spritefont" : L"consolas.spritefont");
-    wcscpy_s(comicFont, (size.bottom > 1080) ? L"comic4k.spritefont" : L"comic.spritefont");
+        wcscpy_s(comicFont, (size.bottom > 1080) ? L"comic4k.spritefont" : L"comic.spritefont");
 #else
-    DX::FindMediaFile(consolasFont, _MAX_PATH, (size.bottom > 1200) ? L"consolas4k.spritefont" : L"consolas.spritefont");
-    DX::FindMediaFile(comicFont, _MAX_PATH, (size.bottom > 1200) ? L"comic4k.spritefont" : L"comic.spritefont");
+        DX::FindMediaFile(comicFont, _MAX_PATH, (size.bottom > 1200) ? L"comic4k.spritefont" : L"comic.spritefont");
 #endif
 
-    m_fontConsolas = std::make_unique<SpriteFont>(device, consolasFont);
-    m_fontComic = std::make_unique<SpriteFont>(device, comicFont);
+        m_fontComic = std::make_unique<SpriteFont>(device, comicFont);
+
+        // The HUD font is only needed once a model is loaded.
+        if (m_fastStart && !m_startupComplete)
+        {
+            m_fontConsolas.reset();
+            m_deferredResources = true;
+        }
+        else
+        {
+            CreateHUDFont();
+        }
+    }
+
+    {
+        DX::ScopedPhase hdrScene(startup, "HDR render target");
+        m_hdrScene->SetWindow(size);
+    }
 
-    m_hdrScene->SetWindow(size);
+    CreateExposureResources();
 
     m_ballCamera.SetWindow(size.right, size.bottom);
     m_ballModel.SetWindow(size.right, size.bottom);
 
+    m_occlusion->SetSizeForViewport(static_cast<size_t>(std::max<long>(size.right - size.left, 1)),
+        static_cast<size_t>(std::max<long>(size.bottom - size.top, 1)));
+
     CreateProjection();
+
+    m_memoryDirty = true;
+}
+
+// The histogram is built from the first mip no larger than 256 pixels on a side.
+void Game::CreateExposureResources()
+{
+    auto device = m_deviceResources->GetD3DDevice();
+    auto size = m_deviceResources->GetOutputSize();
+
+    const auto width = static_cast<UINT>(std::max<long>(size.right - size.left, 1));
+    const auto height = static_cast<UINT>(std::max<long>(size.bottom - size.top, 1));
+
+    UINT mip = 0;
+    while (std::max(width >> mip, height >> mip) > 256)
+        ++mip;
+
+    m_exposureMip = mip;
+    m_exposureWidth = std::max(width >> mip, 1u);
+    m_exposureHeight = std::max(height >> mip, 1u);
+
+    // Copied from the scene as is, so in the same format.
+    const DXGI_FORMAT format = m_hdrScene->GetFormat();
+
+    CD3D11_TEXTURE2D_DESC desc(format, width, height, 1, mip + 1,
+        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_DEFAULT, 0, 1, 0,
+        D3D11_RESOURCE_MISC_GENERATE_MIPS);
+
+    DX::ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, m_exposureMips.ReleaseAndGetAddressOf()));
+    DX::ThrowIfFailed(device->CreateShaderResourceView(m_exposureMips.Get(), nullptr, m_exposureMipsSRV.ReleaseAndGetAddressOf()));
+
+    CD3D11_TEXTURE2D_DESC readbackDesc(format, m_exposureWidth, m_exposureHeight, 1, 1,
+        0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+
+    for (size_t j = 0; j < s_nExposureReadback; ++j)
+    {
+        DX::ThrowIfFailed(device->CreateTexture2D(&readbackDesc, nullptr, m_exposureReadback[j].ReleaseAndGetAddressOf()));
+        m_exposurePending[j] = false;
+    }
+
+    m_exposureWrite = m_exposureRead = 0;
+}
+
+// Recreates the HDR scene, and the exposure textures copied from it, with another format
+// or sample count. Counts the format doesn't support fall back to the next one down.
+void Game::SetHdrTarget(DX::HdrFormat format, uint32_t sampleCount)
+{
+    auto device = m_deviceResources->GetD3DDevice();
+
+    const DXGI_FORMAT hdrFormat = DX::GetHdrFormat(format);
+    const uint32_t supported = DX::RenderTexture::GetSupportedSampleCounts(device, hdrFormat, m_deviceResources->GetDepthBufferFormat());
+    sampleCount = DX::ChooseSampleCount(sampleCount, supported);
+
+    if (hdrFormat == m_hdrScene->GetFormat() && sampleCount == m_hdrScene->GetSampleCount())
+        return;
+
+    m_hdrScene->SetFormat(hdrFormat, sampleCount);
+
+    m_hdrFormat = format;
+    m_msaaSamples = sampleCount;
+    m_msaaSupported = supported;
+
+    CreateExposureResources();
+
+    m_memoryDirty = true;
+}
+
+void Game::CreateHUDFont()
+{
+    auto size = m_deviceResources->GetOutputSize();
+
+    wchar_t consolasFont[_MAX_PATH] = {};
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    wcscpy_s(consolasFont, (size.bottom > 1080) ? L"consolas4k.spritefont" : L"consolas.spritefont");
+#else
+    DX::FindMediaFile(consolasFont, _MAX_PATH, (size.bottom > 1200) ? L"consolas4k.spritefont" : L"consolas.spritefont");
+#endif
+
+    m_fontConsolas = std::make_unique<SpriteFont>(m_deviceResources->GetD3DDevice(), consolasFont);
+}
+
+// Resources skipped by fast-start mode are created once the first frame has been presented.
+void Game::CreateDeferredResources()
+{
+    m_deferredResources = false;
+
+    for (size_t j = 0; j < s_nIBL; ++j)
+    {
+        if (!m_radianceIBL[j] || !m_irradianceIBL[j])
+        {
+            CreateIBL(j);
+        }
+    }
+
+    if (!m_fontConsolas)
+    {
+        CreateHUDFont();
+    }
+}
+
+void Game::OnStartupComplete()
+{
+    m_startupTimer.Mark("First frame presented");
+    m_startupComplete = true;
+
+    if (m_deferredResources)
+    {
+        DX::ScopedPhase phase(&m_startupTimer, "Deferred resources");
+        CreateDeferredResources();
+    }
+
+    if (m_startupReport)
+    {
+        std::ostringstream report;
+        report << "Startup time breakdown:\n";
+        m_startupTimer.WriteReport(report);
+        OutputDebugStringA(report.str().c_str());
+    }
+
+    if (!m_startupTraceFile.empty())
+    {
+        std::ofstream trace(m_startupTraceFile.c_str(), std::ios::out | std::ios::trunc);
+        if (trace)
+        {
+            m_startupTimer.WriteChromeTrace(trace);
+        }
+#ifdef _DEBUG
+        else
+        {
+            OutputDebugStringA("WARNING: Failed to write startup trace\n");
+        }
+#endif
+    }
 }
 
 #if !defined(_XBOX_ONE) || !defined(_TITLE)
@@ -1048,19 +2343,45 @@ void Game::OnDeviceLost()
     m_fontComic.reset();
 
     m_model.reset();
+    m_scene.reset();
+    m_streaming.reset();
     m_fxFactory.reset();
     m_pbrFXFactory.reset();
+    m_modelTextures.clear();
     m_bones.reset();
+    m_boneHierarchy.Clear();
+    m_picker.Clear();
+    m_hasPick = false;
+    m_sectionBoxes.Clear();
+    m_sectionResults.clear();
+    m_sectionBoxesDirty = true;
+    m_occluders.clear();
+    m_occludedMeshes = 0;
+    m_alphaParts.clear();
+    m_memoryDirty = true;
 
     m_states.reset();
     m_lineEffect.reset();
+
+    m_gpuTimer.SetQueries(nullptr);
+    m_gpuQueries.reset();
     m_lineBatch.reset();
     m_toneMap.reset();
 
     m_lineLayout.Reset();
+    m_revealageBlend.Reset();
+    m_accumulateBlend.Reset();
 
     m_hdrScene->ReleaseDevice();
 
+    m_exposureMips.Reset();
+    m_exposureMipsSRV.Reset();
+    for (size_t j = 0; j < s_nExposureReadback; ++j)
+    {
+        m_exposureReadback[j].Reset();
+        m_exposurePending[j] = false;
+    }
+
     for (size_t j = 0; j < s_nIBL; ++j)
     {
         m_radianceIBL[j].Reset();
@@ -1073,19 +2394,38 @@ void Game::OnDeviceRestored()
     CreateDeviceDependentResources();
 
     CreateWindowSizeDependentResources();
+
+    m_renderState.Invalidate();
 }
 #endif
 
 void Game::LoadModel()
 {
+    DX::ProfileScope scope("LoadModel");
+
     m_bones.reset();
+    m_boneHierarchy.Clear();
+    m_picker.Clear();
+    m_hasPick = false;
+    m_sectionBoxes.Clear();
+    m_sectionResults.clear();
+    m_sectionBoxesDirty = true;
+    m_occluders.clear();
+    m_occludedMeshes = 0;
+    m_alphaParts.clear();
     m_model.reset();
+    m_scene.reset();
+    m_streaming.reset();
     m_fxFactory.reset();
     m_pbrFXFactory.reset();
+    m_modelTextures.clear();
+    m_memoryDirty = true;
+    m_modelStats = {};
 
     *m_szStatus = 0;
     *m_szError = 0;
     m_reloadModel = false;
+    m_renderState.Invalidate();
     m_boneMode = false;
     m_skinning = false;
     m_modelRot = Quaternion::Identity;
@@ -1099,6 +2439,33 @@ void Game::LoadModel()
     wchar_t fname[_MAX_FNAME] = {};
     _wsplitpath_s(m_szModelName, drive, _MAX_DRIVE, path, MAX_PATH, fname, _MAX_FNAME, ext, _MAX_EXT);
 
+    if (DX::IsSceneExtension(ext))
+    {
+        wchar_t name[_MAX_FNAME + _MAX_EXT] = {};
+        swprintf_s(name, L"%ls%ls", fname, ext);
+        LoadScene(name);
+        CameraHome();
+        return;
+    }
+
+    if (_wcsicmp(ext, L".sdkmesh") == 0)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA attributes = {};
+        const uint64_t fileSize = GetFileAttributesExW(m_szModelName, GetFileExInfoStandard, &attributes)
+            ? (uint64_t(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow : 0;
+
+        if (m_streamingBudget || fileSize >= c_StreamingFileSize)
+        {
+            wchar_t name[_MAX_FNAME + _MAX_EXT] = {};
+            swprintf_s(name, L"%ls%ls", fname, ext);
+            wchar_t dir[MAX_PATH] = {};
+            _wmakepath_s(dir, drive, path, nullptr, nullptr);
+            LoadStreamingModel(name, dir);
+            CameraHome();
+            return;
+        }
+    }
+
     auto device = m_deviceResources->GetD3DDevice();
 
     bool issdkmesh2 = false;
@@ -1130,13 +2497,13 @@ void Game::LoadModel()
 
         if (issdkmesh2)
         {
-            m_pbrFXFactory = std::make_unique<PBREffectFactory>(device);
+            m_pbrFXFactory = std::make_unique<TextureTrackingFactory<PBREffectFactory>>(device, m_modelTextures);
 
             fxFactory = m_pbrFXFactory.get();
         }
         else
         {
-            m_fxFactory = std::make_unique<EffectFactory>(device);
+            m_fxFactory = std::make_unique<TextureTrackingFactory<EffectFactory>>(device, m_modelTextures);
 
             m_fxFactory->EnableForceSRGB(true);
 
@@ -1159,22 +2526,9 @@ void Game::LoadModel()
 
         try
         {
-            if (_wcsicmp(ext, L".sdkmesh") == 0)
-            {
-                ModelLoaderFlags flags = m_lhcoords ? ModelLoader_CounterClockwise : ModelLoader_Clockwise;
-                flags |= ModelLoader_IncludeBones;
-                m_model = Model::CreateFromSDKMESH(device, modelBin.data(), modelBin.size(), *fxFactory, flags);
-            }
-            else if (_wcsicmp(ext, L".cmo") == 0)
-            {
-                ModelLoaderFlags flags = m_lhcoords ? ModelLoader_Clockwise : ModelLoader_CounterClockwise;
-                flags |= ModelLoader_IncludeBones;
-                m_model = Model::CreateFromCMO(device, modelBin.data(), modelBin.size(), *fxFactory, flags);
-            }
-            else if (_wcsicmp(ext, L".vbo") == 0)
+            if (DX::ModelData::IsSupportedExtension(ext))
             {
-                ModelLoaderFlags flags = m_lhcoords ? ModelLoader_CounterClockwise : ModelLoader_Clockwise;
-                m_model = Model::CreateFromVBO(device, modelBin.data(), modelBin.size(), nullptr, flags);
+                m_model = DX::CreateModelFromMemory(device, modelBin.data(), modelBin.size(), ext, *fxFactory, m_lhcoords);
             }
             else
             {
@@ -1189,9 +2543,39 @@ void Game::LoadModel()
             m_model.reset();
             m_fxFactory.reset();
             m_pbrFXFactory.reset();
+            m_modelTextures.clear();
             *m_szStatus = 0;
         }
 
+        if (m_model)
+        {
+            try
+            {
+                m_modelStats = DX::ModelData::ReadStatistics(modelBin.data(), modelBin.size(), ext);
+            }
+            catch (...)
+            {
+                // Direct3D loaded the model, so only the HUD counts are lost.
+                m_modelStats = {};
+            }
+
+            try
+            {
+                DX::ProfileScope pick("Picking hierarchy and occluders");
+                auto const data = DX::ModelData::CreateFromMemory(modelBin.data(), modelBin.size(), ext, m_lhcoords);
+                m_picker.Build(*data);
+                DX::OcclusionCuller::BuildOccluders(*data, m_occluders);
+            }
+            catch (...)
+            {
+                // Only picking and occlusion culling are lost.
+                m_picker.Clear();
+                m_occluders.clear();
+            }
+
+            BuildAlphaParts();
+        }
+
         modelBin.clear();
     }
 
@@ -1201,118 +2585,255 @@ void Game::LoadModel()
     {
         if (!m_model->bones.empty())
         {
-            m_bones = ModelBone::MakeArray(m_model->bones.size());
-        }
-
-        size_t nmeshes = 0;
-        size_t nverts = 0;
-        size_t nfaces = 0;
-        size_t nsubsets = 0;
-
-        std::set<ID3D11Buffer*> vbs;
-        for (auto it = m_model->meshes.cbegin(); it != m_model->meshes.cend(); ++it)
-        {
-	        if ( it == m_model->meshes.cbegin() )
-	        {
-                m_ccw = (*it)->ccw;
-	        }
+            const size_t nbones = m_model->bones.size();
+            m_bones = ModelBone::MakeArray(nbones);
 
-            for (auto mit = (*it)->meshParts.cbegin(); mit != (*it)->meshParts.cend(); ++mit)
+            std::vector<DX::FrameHierarchy::Link> links(nbones);
+            std::vector<XMFLOAT4X4> localTransforms(nbones);
+            for (size_t j = 0; j < nbones; ++j)
             {
-                ++nsubsets;
-
-                nfaces += ((*mit)->indexCount / 3);
-
-                ID3D11Buffer* vbptr = (*mit)->vertexBuffer.Get();
-                size_t vertexStride = (*mit)->vertexStride;
-
-                if (vbptr && (vertexStride > 0) && vbs.find(vbptr) == vbs.end())
-                {
-                    D3D11_BUFFER_DESC desc;
-                    vbptr->GetDesc(&desc);
+                auto const& bone = m_model->bones[j];
+                links[j].child = bone.childIndex;
+                links[j].sibling = bone.siblingIndex;
+                links[j].isRoot = (bone.parentIndex == ModelBone::c_Invalid);
+                XMStoreFloat4x4(&localTransforms[j], m_model->boneMatrices[j]);
+            }
 
-                    nverts += (desc.ByteWidth / vertexStride);
+            m_boneHierarchy.Build(links.data(), localTransforms.data(), nbones);
+        }
 
-                    vbs.insert(vbptr);
-                }
+        if (!m_model->meshes.empty())
+        {
+            m_ccw = m_model->meshes.front()->ccw;
 
-                if (dynamic_cast<IEffectSkinning*>((*mit)->effect.get()) != nullptr)
-                {
-                    m_skinning = true;
-                }
+            m_sectionBounds = m_model->meshes.front()->boundingBox;
+            for (auto const& mesh : m_model->meshes)
+            {
+                BoundingBox::CreateMerged(m_sectionBounds, m_sectionBounds, mesh->boundingBox);
             }
-            ++nmeshes;
         }
 
-        if (nmeshes > 1)
-        {
-            swprintf_s(m_szStatus, L"Meshes: %6Iu   Verts: %6Iu   Faces: %6Iu   Subsets: %6Iu", nmeshes, nverts, nfaces, nsubsets);
-        }
-        else
-        {
-            swprintf_s(m_szStatus, L"Verts: %6Iu   Faces: %6Iu   Subsets: %6Iu", nverts, nfaces, nsubsets);
-        }
+        // Both loaders create skinning effects for vertices with bone weights.
+        m_skinning = m_modelStats.skinned;
+
+        FormatStatistics(m_szStatus, _countof(m_szStatus), m_modelStats);
+
+        wchar_t name[_MAX_FNAME + _MAX_EXT] = {};
+        swprintf_s(name, L"%ls%ls", fname, ext);
+        CheckMemoryBudget(name);
     }
 
     CameraHome();
 }
 
-void Game::DrawGrid()
+// Loads every model listed in a .scene file, sharing identical resources between them
+void Game::LoadScene(const wchar_t* name)
 {
-    auto ctx = m_deviceResources->GetD3DDeviceContext();
-    ctx->OMSetBlendState( m_states->Opaque(), nullptr, 0xFFFFFFFF );
-    ctx->OMSetDepthStencilState( m_states->DepthRead(), 0 );
-    ctx->RSSetState( m_states->CullCounterClockwise() );
-
-    m_lineEffect->SetView(m_view);
+    auto scene = std::make_unique<DX::ModelScene>();
 
-    m_lineEffect->Apply(ctx);
-
-    ctx->IASetInputLayout(m_lineLayout.Get());
-
-    m_lineBatch->Begin();
+    try
+    {
+        auto const entries = DX::LoadScene(m_szModelName);
 
-    Vector3 xaxis(m_gridScale, 0.f, 0.f);
-    Vector3 yaxis(0.f, 0.f, m_gridScale);
-    Vector3 origin = Vector3::Zero;
+        scene->Load(m_deviceResources->GetD3DDevice(), m_deviceResources->GetD3DDeviceContext(), entries, m_lhcoords);
+    }
+    catch (const std::exception& e)
+    {
+        swprintf_s(m_szError, L"Error loading scene %ls\n%hs\n", name, e.what());
+        return;
+    }
 
-    XMVECTOR color = m_uiColor;
+    if (scene->IsEmpty())
+    {
+        swprintf_s(m_szError, L"Error loading scene %ls\n%ls\n", name,
+            scene->GetFirstError().empty() ? L"No models are listed" : scene->GetFirstError().c_str());
+        return;
+    }
 
-    for( size_t i = 0; i <= m_gridDivs; ++i )
+#ifdef _DEBUG
+    if (!scene->GetFirstError().empty())
     {
-        float fPercent = float(i) / float(m_gridDivs);
-        fPercent = ( fPercent * 2.0f ) - 1.0f;
+        wchar_t buff[1024] = {};
+        swprintf_s(buff, L"WARNING: %Iu scene entries failed; the first: %ls\n", scene->GetStatistics().failed, scene->GetFirstError().c_str());
+        OutputDebugStringW(buff);
+    }
+#endif
 
-        Vector3 scale = xaxis * fPercent + origin;
+    m_scene = std::move(scene);
+    m_wireframe = false;
+    m_modelStats = m_scene->GetStatistics().geometry;
 
-        VertexPositionColor v1( scale - yaxis, color );
-        VertexPositionColor v2( scale + yaxis, color );
-        m_lineBatch->DrawLine( v1, v2 );
+    if (!m_scene->GetModels().empty() && !m_scene->GetModels().front()->meshes.empty())
+    {
+        m_ccw = m_scene->GetModels().front()->meshes.front()->ccw;
     }
 
-    for( size_t i = 0; i <= m_gridDivs; i++ )
+    auto const& stats = m_scene->GetStatistics();
+    int len = swprintf_s(m_szStatus, L"Models: %Iu   Instances: %Iu   ", stats.models, stats.instances);
+    if (len > 0)
     {
-        float fPercent = float(i) / float(m_gridDivs);
-        fPercent = ( fPercent * 2.0f ) - 1.0f;
-
-        Vector3 scale = yaxis * fPercent + origin;
-
-        VertexPositionColor v1( scale - xaxis, color );
-        VertexPositionColor v2( scale + xaxis, color );
-        m_lineBatch->DrawLine( v1, v2 );
+        len += FormatStatistics(m_szStatus + len, _countof(m_szStatus) - size_t(len), m_modelStats);
+    }
+    if (stats.failed && len > 0)
+    {
+        swprintf_s(m_szStatus + len, _countof(m_szStatus) - size_t(len), L"   Failed: %Iu", stats.failed);
     }
 
-    m_lineBatch->End();
+    CheckMemoryBudget(name);
 }
 
-void Game::DrawCross()
+// Maps a .sdkmesh and reads only its headers; buffers are created by DrawStreaming as
+// the camera needs them
+void Game::LoadStreamingModel(const wchar_t* name, const wchar_t* directory)
 {
-    auto ctx = m_deviceResources->GetD3DDeviceContext();
-    ctx->OMSetBlendState(m_states->Opaque(), nullptr, 0xFFFFFFFF);
-    ctx->OMSetDepthStencilState(m_states->DepthRead(), 0);
-    ctx->RSSetState(m_states->CullCounterClockwise());
+    auto device = m_deviceResources->GetD3DDevice();
 
-    m_lineEffect->SetView(m_view);
+    std::unique_ptr<DX::StreamingModel> streaming;
+    try
+    {
+        DX::ResidencyManager::Settings settings;
+        if (m_streamingBudget)
+        {
+            settings.budgetBytes = m_streamingBudget;
+        }
+
+        streaming = std::make_unique<DX::StreamingModel>(m_szModelName, m_lhcoords, settings);
+
+        IEffectFactory* fxFactory = nullptr;
+        if (streaming->GetVersion() >= DXUT::SDKMESH_FILE_VERSION_V2)
+        {
+            m_pbrFXFactory = std::make_unique<TextureTrackingFactory<PBREffectFactory>>(device, m_modelTextures);
+            if (*directory)
+            {
+                m_pbrFXFactory->SetDirectory(directory);
+            }
+
+            fxFactory = m_pbrFXFactory.get();
+        }
+        else
+        {
+            m_fxFactory = std::make_unique<TextureTrackingFactory<EffectFactory>>(device, m_modelTextures);
+            m_fxFactory->EnableForceSRGB(true);
+            if (*directory)
+            {
+                m_fxFactory->SetDirectory(directory);
+            }
+
+            fxFactory = m_fxFactory.get();
+        }
+
+        streaming->CreateDeviceResources(device, *fxFactory);
+    }
+    catch (const std::exception& e)
+    {
+        swprintf_s(m_szError, L"Error loading model %ls\n%hs\n", name, e.what());
+        m_fxFactory.reset();
+        m_pbrFXFactory.reset();
+        m_modelTextures.clear();
+        return;
+    }
+
+    try
+    {
+        auto const& file = streaming->GetFile();
+        m_modelStats = DX::ModelData::ReadStatistics(file.GetData(), file.GetSize(), L".sdkmesh");
+    }
+    catch (...)
+    {
+        m_modelStats = {};
+    }
+
+    m_streaming = std::move(streaming);
+    m_wireframe = false;
+
+    if (!m_streaming->GetLayout().meshes.empty())
+    {
+        m_ccw = m_streaming->GetLayout().meshes.front().ccw;
+    }
+
+    int len = FormatStatistics(m_szStatus, _countof(m_szStatus), m_modelStats);
+    if (len > 0)
+    {
+        swprintf_s(m_szStatus + len, _countof(m_szStatus) - size_t(len), L"   Streaming: %.2f MB", ToMegabytes(m_streaming->GetFile().GetSize()));
+    }
+}
+
+// Shows the memory line when the loaded model or scene is over the budget
+void Game::CheckMemoryBudget(const wchar_t* name)
+{
+    UpdateMemoryUsage();
+
+    if (m_memoryBudget && m_modelMemory > m_memoryBudget)
+    {
+        m_showMemory = true;
+
+#ifdef _DEBUG
+        wchar_t buff[MAX_PATH + 128] = {};
+        swprintf_s(buff, L"WARNING: %ls uses %.2f MB, over the %.2f MB budget\n", name,
+            ToMegabytes(m_modelMemory), ToMegabytes(m_memoryBudget));
+        OutputDebugStringW(buff);
+#else
+        UNREFERENCED_PARAMETER(name);
+#endif
+    }
+}
+
+void Game::DrawGrid()
+{
+    auto ctx = m_deviceResources->GetD3DDeviceContext();
+    ctx->OMSetBlendState( m_states->Opaque(), nullptr, 0xFFFFFFFF );
+    ctx->OMSetDepthStencilState( m_states->DepthRead(), 0 );
+    ctx->RSSetState( m_states->CullCounterClockwise() );
+
+    m_lineEffect->SetView(m_view);
+
+    m_lineEffect->Apply(ctx);
+
+    ctx->IASetInputLayout(m_lineLayout.Get());
+
+    m_lineBatch->Begin();
+
+    Vector3 xaxis(m_gridScale, 0.f, 0.f);
+    Vector3 yaxis(0.f, 0.f, m_gridScale);
+    Vector3 origin = Vector3::Zero;
+
+    XMVECTOR color = m_uiColor;
+
+    for( size_t i = 0; i <= m_gridDivs; ++i )
+    {
+        float fPercent = float(i) / float(m_gridDivs);
+        fPercent = ( fPercent * 2.0f ) - 1.0f;
+
+        Vector3 scale = xaxis * fPercent + origin;
+
+        VertexPositionColor v1( scale - yaxis, color );
+        VertexPositionColor v2( scale + yaxis, color );
+        m_lineBatch->DrawLine( v1, v2 );
+    }
+
+    for( size_t i = 0; i <= m_gridDivs; i++ )
+    {
+        float fPercent = float(i) / float(m_gridDivs);
+        fPercent = ( fPercent * 2.0f ) - 1.0f;
+
+        Vector3 scale = yaxis * fPercent + origin;
+
+        VertexPositionColor v1( scale - xaxis, color );
+        VertexPositionColor v2( scale + xaxis, color );
+        m_lineBatch->DrawLine( v1, v2 );
+    }
+
+    m_lineBatch->End();
+}
+
+void Game::DrawCross()
+{
+    auto ctx = m_deviceResources->GetD3DDeviceContext();
+    ctx->OMSetBlendState(m_states->Opaque(), nullptr, 0xFFFFFFFF);
+    ctx->OMSetDepthStencilState(m_states->DepthRead(), 0);
+    ctx->RSSetState(m_states->CullCounterClockwise());
+
+    m_lineEffect->SetView(m_view);
 
     m_lineEffect->Apply(ctx);
 
@@ -1346,18 +2867,100 @@ void Game::DrawCross()
     m_lineBatch->End();
 }
 
-void Game::CameraHome()
+void Game::DrawFrameGraph()
+{
+    constexpr size_t c_graphFrames = 240;
+    constexpr float c_barWidth = 2.f;
+    constexpr float c_graphHeight = 150.f;
+    constexpr float c_graphMaxMS = 50.f;
+
+    auto const& history = m_timer.GetFrameTimeHistory();
+    const float budget = history.GetBudget();
+
+    float frames[c_graphFrames] = {};
+    const size_t count = history.GetRecent(frames, c_graphFrames);
+
+    auto const size = m_deviceResources->GetOutputSize();
+
+    const float left = 10.f;
+    const float bottom = float(size.bottom) - 10.f;
+    const float scale = c_graphHeight / c_graphMaxMS;
+
+    auto ctx = m_deviceResources->GetD3DDeviceContext();
+    ctx->OMSetBlendState(m_states->Opaque(), nullptr, 0xFFFFFFFF);
+    ctx->OMSetDepthStencilState(m_states->DepthNone(), 0);
+    ctx->RSSetState(m_states->CullNone());
+
+    m_lineEffect->SetView(Matrix::Identity);
+    m_lineEffect->SetProjection(Matrix::CreateOrthographicOffCenter(0.f, float(size.right), float(size.bottom), 0.f, 0.f, 1.f));
+
+    m_lineEffect->Apply(ctx);
+
+    ctx->IASetInputLayout(m_lineLayout.Get());
+
+    m_lineBatch->Begin();
+
+    for (size_t j = 0; j < count; ++j)
+    {
+        const float x = left + float(j) * c_barWidth;
+        const float h = std::min(frames[j], c_graphMaxMS) * scale;
+
+        XMVECTOR color = (frames[j] > budget) ? Colors::Red : Colors::LimeGreen;
+
+        VertexPositionColor v1(Vector3(x, bottom, 0.f), color);
+        VertexPositionColor v2(Vector3(x, bottom - h, 0.f), color);
+        m_lineBatch->DrawLine(v1, v2);
+    }
+
+    // Reference lines for 60 Hz and 120 Hz.
+    const float right = left + float(c_graphFrames) * c_barWidth;
+    for (const float ms : { 1000.f / 60.f, 1000.f / 120.f })
+    {
+        const float y = bottom - ms * scale;
+
+        XMVECTOR color = m_uiColor;
+
+        VertexPositionColor v1(Vector3(left, y, 0.f), color);
+        VertexPositionColor v2(Vector3(right, y, 0.f), color);
+        m_lineBatch->DrawLine(v1, v2);
+    }
+
+    m_lineBatch->End();
+
+    m_lineEffect->SetProjection(m_proj);
+
+    if (!m_fontConsolas)
+        return;
+
+    const DX::FrameTimeStats stats = history.ComputeStats();
+
+    wchar_t szStats[256] = {};
+    swprintf_s(szStats, L"FPS: %4u  p50: %6.2f ms  p95: %6.2f ms  p99: %6.2f ms  max: %6.2f ms  Hitches: %llu  Over %.2f ms: %llu",
+        m_timer.GetFramesPerSecond(), stats.p50, stats.p95, stats.p99, stats.max,
+        static_cast<unsigned long long>(stats.hitches), budget, static_cast<unsigned long long>(stats.overBudget));
+
+    const float spacing = m_fontConsolas->GetLineSpacing();
+
+    m_spriteBatch->Begin();
+    m_fontConsolas->DrawString(m_spriteBatch.get(), szStats, XMFLOAT2(left, bottom - c_graphHeight - spacing), m_uiColor);
+    m_spriteBatch->End();
+}
+
+// Looks at the bounds of the whole model; with 'animate' the camera eases there rather
+// than jumping.
+void Game::CameraHome(bool animate)
 {
     m_mouse->ResetScrollWheelValue();
     m_zoom = 1.f;
     m_fov = XM_PI / 4.f;
-    m_cameraRot = Quaternion::Identity;
     m_ballCamera.Reset();
 
-    if (!m_model)
+    Vector3 focus;
+    float distance;
+    if (!m_model && !m_scene && !m_streaming)
     {
-        m_cameraFocus = Vector3::Zero;
-        m_distance = 10.f;
+        focus = Vector3::Zero;
+        distance = 10.f;
         m_gridScale = 1.f;
     }
     else
@@ -1365,18 +2968,29 @@ void Game::CameraHome()
         BoundingSphere sphere;
         BoundingBox box;
 
-        for( auto it = m_model->meshes.cbegin(); it != m_model->meshes.cend(); ++it )
+        if (m_scene)
         {
-	        if ( it == m_model->meshes.cbegin() )
-	        {
-		        sphere = (*it)->boundingSphere;
-		        box = (*it)->boundingBox;
-	        }
-	        else
-	        {
-		        BoundingSphere::CreateMerged( sphere, sphere, (*it)->boundingSphere );
-		        BoundingBox::CreateMerged( box, box, (*it)->boundingBox );
-	        }
+            m_scene->GetBounds(sphere, box);
+        }
+        else if (m_streaming)
+        {
+            m_streaming->GetBounds(sphere, box);
+        }
+        else
+        {
+            for( auto it = m_model->meshes.cbegin(); it != m_model->meshes.cend(); ++it )
+            {
+	            if ( it == m_model->meshes.cbegin() )
+	            {
+		            sphere = (*it)->boundingSphere;
+		            box = (*it)->boundingBox;
+	            }
+	            else
+	            {
+		            BoundingSphere::CreateMerged( sphere, sphere, (*it)->boundingSphere );
+		            BoundingBox::CreateMerged( box, box, (*it)->boundingBox );
+	            }
+            }
         }
 
         if ( sphere.Radius < 1.f )
@@ -1393,11 +3007,22 @@ void Game::CameraHome()
 
         m_gridScale = sphere.Radius;
 
-        m_distance = sphere.Radius * 2;
+        distance = sphere.Radius * 2;
 
-        m_cameraFocus = sphere.Center;
+        focus = sphere.Center;
+    }
+
+    if (animate)
+    {
+        MoveCamera(focus, distance, Quaternion::Identity);
+        return;
     }
 
+    m_cameraMoving = false;
+    m_cameraFocus = focus;
+    m_distance = distance;
+    m_cameraRot = Quaternion::Identity;
+
     Vector3 dir = Vector3::Transform((m_lhcoords) ? Vector3::Forward : Vector3::Backward, m_cameraRot);
     Vector3 up = Vector3::Transform(Vector3::Up, m_cameraRot);
 
@@ -1438,8 +3063,20 @@ void Game::CycleToneMapOperator()
     }
 }
 
+void Game::ToggleAutoExposure()
+{
+    m_autoExposureEnabled = !m_autoExposureEnabled;
+
+    // Start again from the default exposure, adapting once the first readback arrives.
+    m_autoExposure.Reset();
+    m_exposure = 0.f;
+    m_histogramValid = false;
+}
+
 void Game::CycleBoneRenderMode()
 {
+    m_sectionBoxesDirty = true;
+
     if (!m_model
         || m_model->bones.empty()
         || m_boneMode)
@@ -1451,6 +3088,292 @@ void Game::CycleBoneRenderMode()
     m_boneMode = true;
 }
 
+void Game::CycleFrameBudget()
+{
+    auto& history = m_timer.GetFrameTimeHistory();
+
+    history.SetBudget((history.GetBudget() > 1000.f / 90.f) ? (1000.f / 120.f) : (1000.f / 60.f));
+    history.ResetCounters();
+}
+
+void Game::CycleFramePacing()
+{
+    auto mode = static_cast<uint32_t>(m_framePacer.GetMode()) + 1;
+    if (mode >= static_cast<uint32_t>(DX::FramePacing::Count))
+    {
+        mode = 0;
+    }
+
+    m_framePacer.SetMode(static_cast<DX::FramePacing>(mode));
+}
+
+void Game::CycleTargetFrameRate()
+{
+    static const double s_rates[] = { 30.0, 60.0, 120.0, 144.0 };
+
+    const double current = m_framePacer.GetTargetFramesPerSecond();
+    double next = s_rates[0];
+    for (auto rate : s_rates)
+    {
+        if (rate > current + 0.5)
+        {
+            next = rate;
+            break;
+        }
+    }
+
+    m_framePacer.SetTargetFramesPerSecond(next);
+}
+
+void Game::ExportFrameTimes()
+{
+    SYSTEMTIME now = {};
+    GetLocalTime(&now);
+
+    wchar_t filename[MAX_PATH] = {};
+    swprintf_s(filename, L"FrameTimes_%04u%02u%02u_%02u%02u%02u.csv",
+        now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond);
+
+    std::ofstream csv(filename, std::ios::out | std::ios::trunc);
+    if (!csv)
+    {
+        swprintf_s(m_szError, L"Failed to write %ls\n", filename);
+        return;
+    }
+
+    m_timer.GetFrameTimeHistory().WriteCSV(csv);
+
+#ifdef _DEBUG
+    wchar_t buff[MAX_PATH + 32] = {};
+    swprintf_s(buff, L"INFO: Frame times written to %ls\n", filename);
+    OutputDebugStringW(buff);
+#endif
+}
+
+void Game::ExportFrameTrace()
+{
+    SYSTEMTIME now = {};
+    GetLocalTime(&now);
+
+    wchar_t filename[MAX_PATH] = {};
+    swprintf_s(filename, L"FrameTrace_%04u%02u%02u_%02u%02u%02u.json",
+        now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond);
+
+    std::ofstream trace(filename, std::ios::out | std::ios::trunc);
+    if (!trace)
+    {
+        swprintf_s(m_szError, L"Failed to write %ls\n", filename);
+        return;
+    }
+
+    DX::FrameProfiler::WriteChromeTrace(trace);
+
+#ifdef _DEBUG
+    wchar_t buff[MAX_PATH + 64] = {};
+    swprintf_s(buff, L"INFO: %u frames traced to %ls (%llu scopes dropped)\n",
+        m_frameTraceLength, filename, DX::FrameProfiler::GetDroppedEvents());
+    OutputDebugStringW(buff);
+#endif
+}
+
+// Adds the GPU pass times read back this frame to a running frame trace. They arrive a
+// few frames after the frame they measure.
+void Game::TraceGpuTimes()
+{
+    if (!m_gpuTimer.HasNewResults() || !DX::FrameProfiler::IsCapturing())
+        return;
+
+    for (size_t pass = 0; pass < GpuPass_Count; ++pass)
+    {
+        const float ms = m_gpuTimer.GetLastPassMilliseconds(pass);
+        if (ms >= 0.f)
+        {
+            DX::FrameProfiler::RecordCounter(c_GpuPassCounters[pass], double(ms));
+        }
+    }
+
+    DX::FrameProfiler::RecordCounter("GPU frame (ms)", double(m_gpuTimer.GetLastFrameMilliseconds()));
+}
+
+// Rebuilds the memory ledger from the resources alive now. Model buffers and textures are
+// also totalled separately for the asset budget.
+void Game::UpdateMemoryUsage()
+{
+    if (!m_memoryDirty)
+        return;
+
+    m_memoryDirty = false;
+
+    using DX::MemoryCategory;
+    m_memory.Clear();
+
+    if (m_model)
+    {
+        for (auto const& mesh : m_model->meshes)
+        {
+            for (auto const& part : mesh->meshParts)
+            {
+                AddResource(m_memory, MemoryCategory::VertexBuffers, "Vertex buffer", part->vertexBuffer.Get());
+                AddResource(m_memory, MemoryCategory::IndexBuffers, "Index buffer", part->indexBuffer.Get());
+            }
+        }
+    }
+
+    if (m_streaming && m_streaming->GetModel())
+    {
+        // Only the resident buffers; released ones are null.
+        for (auto const& mesh : m_streaming->GetModel()->meshes)
+        {
+            for (auto const& part : mesh->meshParts)
+            {
+                AddResource(m_memory, MemoryCategory::VertexBuffers, "Streamed vertex buffer", part->vertexBuffer.Get());
+                AddResource(m_memory, MemoryCategory::IndexBuffers, "Streamed index buffer", part->indexBuffer.Get());
+            }
+        }
+    }
+
+    for (auto const& texture : m_modelTextures)
+    {
+        AddResource(m_memory, MemoryCategory::Textures, texture.first.c_str(), texture.second.Get());
+    }
+
+    if (m_scene)
+    {
+        for (auto const& model : m_scene->GetModels())
+        {
+            for (auto const& mesh : model->meshes)
+            {
+                for (auto const& part : mesh->meshParts)
+                {
+                    AddResource(m_memory, MemoryCategory::VertexBuffers, "Vertex buffer", part->vertexBuffer.Get());
+                    AddResource(m_memory, MemoryCategory::IndexBuffers, "Index buffer", part->indexBuffer.Get());
+                }
+            }
+        }
+
+        for (auto const& texture : m_scene->GetTextures())
+        {
+            AddResource(m_memory, MemoryCategory::Textures, texture.first.c_str(), texture.second.Get());
+        }
+    }
+
+    m_modelMemory = m_memory.GetTotalBytes();
+
+    for (size_t j = 0; j < s_nIBL; ++j)
+    {
+        AddResource(m_memory, MemoryCategory::Textures, "Radiance IBL", m_radianceIBL[j].Get());
+        AddResource(m_memory, MemoryCategory::Textures, "Irradiance IBL", m_irradianceIBL[j].Get());
+    }
+
+    // The swap chain's buffers aren't individually accessible; all are the size of the current one.
+    auto backBuffer = m_deviceResources->GetRenderTarget();
+    if (backBuffer)
+    {
+        D3D11_TEXTURE2D_DESC desc = {};
+        backBuffer->GetDesc(&desc);
+        m_memory.AddTexture(MemoryCategory::RenderTargets, "Swap chain", desc.Format, desc.Width, desc.Height,
+            m_deviceResources->GetBackBufferCount(), 1, desc.SampleDesc.Count);
+    }
+
+    AddResource(m_memory, MemoryCategory::RenderTargets, "HDR scene", m_hdrScene->GetRenderTarget());
+    AddResource(m_memory, MemoryCategory::RenderTargets, "HDR scene (MSAA)", m_hdrScene->GetMultisampledTarget());
+    AddResource(m_memory, MemoryCategory::RenderTargets, "Exposure mips", m_exposureMips.Get());
+    for (size_t j = 0; j < s_nExposureReadback; ++j)
+    {
+        AddResource(m_memory, MemoryCategory::RenderTargets, "Exposure readback", m_exposureReadback[j].Get());
+    }
+
+    AddResource(m_memory, MemoryCategory::DepthBuffers, "Depth stencil", m_deviceResources->GetDepthStencil());
+    AddResource(m_memory, MemoryCategory::DepthBuffers, "Scene depth (MSAA)", m_hdrScene->GetDepthStencil());
+
+    if (m_model)
+    {
+        const size_t nbones = m_model->bones.size();
+        m_memory.AddBuffer(MemoryCategory::CpuData, "Model bones", m_model->bones.capacity() * sizeof(ModelBone));
+        if (m_model->boneMatrices)
+        {
+            m_memory.AddBuffer(MemoryCategory::CpuData, "Bone matrices", nbones * sizeof(XMMATRIX));
+        }
+        if (m_model->invBindPoseMatrices)
+        {
+            m_memory.AddBuffer(MemoryCategory::CpuData, "Inverse bind pose", nbones * sizeof(XMMATRIX));
+        }
+        if (m_bones)
+        {
+            m_memory.AddBuffer(MemoryCategory::CpuData, "Bone transforms", nbones * sizeof(XMMATRIX));
+        }
+        if (m_picker.GetTriangleCount())
+        {
+            m_memory.AddBuffer(MemoryCategory::CpuData, "Picking hierarchy", m_picker.GetMemoryUsage());
+        }
+
+        if (m_sectionBoxes.GetCount())
+        {
+            m_memory.AddBuffer(MemoryCategory::CpuData, "Section plane bounds", m_sectionBoxes.GetMemoryUsage());
+        }
+
+        if (!m_occluders.empty())
+        {
+            size_t bytes = m_occluders.capacity() * sizeof(DX::OcclusionCuller::OccluderMesh)
+                + m_visibleOccluders.capacity() * sizeof(DX::OcclusionCuller::Occluder);
+            for (auto const& occluder : m_occluders)
+            {
+                bytes += occluder.GetMemoryUsage();
+            }
+            m_memory.AddBuffer(MemoryCategory::CpuData, "Occluder geometry", bytes);
+        }
+    }
+
+    if (m_scene)
+    {
+        m_memory.AddBuffer(MemoryCategory::CpuData, "Occluder geometry", m_scene->GetOccluderMemoryUsage());
+    }
+
+    m_memory.AddBuffer(MemoryCategory::CpuData, "Occlusion buffer", m_occlusion->GetMemoryUsage());
+
+    if (!m_alphaParts.empty())
+    {
+        m_memory.AddBuffer(MemoryCategory::CpuData, "Alpha part sorting", m_alphaParts.capacity() * sizeof(AlphaPart)
+            + m_alphaDepths.capacity() * sizeof(float) + m_transparencySorter.GetMemoryUsage());
+    }
+
+    m_memory.AddBuffer(MemoryCategory::CpuData, "Frame-time history", sizeof(m_timer.GetFrameTimeHistory()));
+    m_memory.AddBuffer(MemoryCategory::CpuData, "Frame profiler", DX::FrameProfiler::GetMemoryUsage());
+}
+
+void Game::ExportMemoryUsage()
+{
+    m_memoryDirty = true;
+    UpdateMemoryUsage();
+
+    SYSTEMTIME now = {};
+    GetLocalTime(&now);
+
+    wchar_t filename[MAX_PATH] = {};
+    swprintf_s(filename, L"MemoryUsage_%04u%02u%02u_%02u%02u%02u.csv",
+        now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond);
+
+    std::ofstream csv(filename, std::ios::out | std::ios::trunc);
+    if (!csv)
+    {
+        swprintf_s(m_szError, L"Failed to write %ls\n", filename);
+        return;
+    }
+
+    m_memory.WriteCSV(csv);
+    csv << "Total,Model,,,,,,," << m_modelMemory << '\n';
+    if (m_memoryBudget)
+    {
+        csv << "Budget,Model,,,,,,," << m_memoryBudget << '\n';
+    }
+
+#ifdef _DEBUG
+    wchar_t buff[MAX_PATH + 32] = {};
+    swprintf_s(buff, L"INFO: Memory usage written to %ls\n", filename);
+    OutputDebugStringW(buff);
+#endif
+}
+
 void Game::CreateProjection()
 {
     auto size = m_deviceResources->GetOutputSize();
@@ -1467,10 +3390,397 @@ void Game::CreateProjection()
     m_lineEffect->SetProjection(m_proj);
 }
 
+// Casts a ray through the requested pixel and records the nearest triangle it hits. The
+// model is picked as drawn without bones.
+void Game::Pick()
+{
+    DX::ProfileScope scope("Pick");
+
+    m_pickRequested = false;
+    m_hasPick = false;
+
+    if (!m_picker.GetTriangleCount())
+        return;
+
+    auto const size = m_deviceResources->GetOutputSize();
+
+    XMVECTOR origin, direction;
+    DX::ModelPicker::ComputeRay(m_pickPosition.x, m_pickPosition.y, float(size.right - size.left), float(size.bottom - size.top),
+        m_world, m_view, m_proj, origin, direction);
+
+    m_hasPick = m_picker.Intersect(origin, direction, m_pick);
+    if (m_hasPick)
+    {
+        m_pickPoint = XMVectorMultiplyAdd(direction, XMVectorReplicate(m_pick.distance), origin);
+    }
+}
+
+// Orbits about the picked point from where the camera is now, so the view pans to center
+// it without moving nearer or further
+void Game::FocusOnPick()
+{
+    if (!m_hasPick)
+        return;
+
+    const Vector3 point = Vector3::Transform(m_pickPoint, m_world);
+    MoveCamera(point, Vector3::Distance(m_lastCameraPos, point) / m_zoom, m_cameraRot);
+}
+
+// Moves the camera in or out until the picked subset, or its whole mesh, fits the view.
+// The bounds were recorded when the picker was built, so this doesn't visit any vertices.
+void Game::FrameSelection(bool wholeMesh)
+{
+    if (!m_hasPick)
+        return;
+
+    BoundingBox box;
+    if (!m_picker.GetBounds(m_pick.mesh, (wholeMesh) ? DX::ModelPicker::None : m_pick.part, box))
+        return;
+
+    box.Transform(box, m_world);
+
+    BoundingSphere sphere;
+    BoundingSphere::CreateFromBoundingBox(sphere, box);
+
+    // Whichever of the vertical and horizontal fields of view is narrower, and no nearer
+    // than the near plane allows.
+    auto const size = m_deviceResources->GetOutputSize();
+    const float aspect = float(std::max(size.right - size.left, 1L)) / float(std::max(size.bottom - size.top, 1L));
+    const float halfFov = std::min(m_fov * 0.5f, std::atan(std::tan(m_fov * 0.5f) * aspect));
+    const float radius = std::max(sphere.Radius, 0.1f);
+
+    MoveCamera(sphere.Center, radius / std::sin(halfFov) / m_zoom, m_cameraRot);
+}
+
+void Game::CycleSectionMode()
+{
+    m_sectionMode = (m_sectionMode + 1) % SectionMode_Count;
+
+    // Planes start across the middle; a box starts at the middle half on each axis.
+    for (uint32_t j = 0; j < DX::SectionPlanes::MaxPlanes; ++j)
+    {
+        m_sectionOffsets[j] = (m_sectionMode == SectionMode_Box) ? ((j & 1) ? 0.75f : 0.25f) : 0.5f;
+    }
+
+    if (m_sectionMode == SectionMode_Planes && !m_sectionEnabled)
+    {
+        m_sectionEnabled = 1;
+    }
+}
+
+// Places the planes across the model's bounds, in model space. Plane j is on axis j / 2,
+// keeping the side above its position for even j and below it for odd j.
+void Game::UpdateSectionPlanes()
+{
+    if (!m_model || m_sectionMode == SectionMode_Off)
+    {
+        m_sections.Clear();
+        return;
+    }
+
+    const float center[3] = { m_sectionBounds.Center.x, m_sectionBounds.Center.y, m_sectionBounds.Center.z };
+    const float extents[3] = { m_sectionBounds.Extents.x, m_sectionBounds.Extents.y, m_sectionBounds.Extents.z };
+
+    auto position = [&](uint32_t j)
+    {
+        return center[j / 2] + extents[j / 2] * (2.f * m_sectionOffsets[j] - 1.f);
+    };
+
+    if (m_sectionMode == SectionMode_Box)
+    {
+        XMFLOAT3 minimum, maximum;
+        minimum.x = position(0); maximum.x = position(1);
+        minimum.y = position(2); maximum.y = position(3);
+        minimum.z = position(4); maximum.z = position(5);
+
+        BoundingBox box;
+        BoundingBox::CreateFromPoints(box, XMLoadFloat3(&minimum), XMLoadFloat3(&maximum));
+        m_sections.SetBox(box);
+        return;
+    }
+
+    XMFLOAT4 planes[DX::SectionPlanes::MaxPlanes];
+    size_t count = 0;
+    for (uint32_t j = 0; j < DX::SectionPlanes::MaxPlanes; ++j)
+    {
+        if (!(m_sectionEnabled & (1u << j)))
+            continue;
+
+        const float sign = (j & 1) ? -1.f : 1.f;
+        float normal[3] = {};
+        normal[j / 2] = sign;
+        planes[count++] = XMFLOAT4(normal[0], normal[1], normal[2], -sign * position(j));
+    }
+
+    m_sections.SetPlanes(planes, count);
+}
+
+// Sorts the meshes into those to draw and those entirely clipped away. The mesh bounds are
+// gathered once into model space, and again only when the bones move.
+void Game::ClassifySections()
+{
+    const size_t nmeshes = m_model->meshes.size();
+    m_sectionResults.resize(nmeshes);
+
+    if (m_boneMode && m_skinning)
+    {
+        // Skinned vertices move away from the bounds the meshes were authored with.
+        std::fill(m_sectionResults.begin(), m_sectionResults.end(), DX::SectionPlanes::Result::Inside);
+        m_sectionRejected = 0;
+        return;
+    }
+
+    if (m_sectionBoxesDirty || m_sectionBoxes.GetCount() != nmeshes)
+    {
+        m_sectionBoxes.Clear();
+        m_sectionBoxes.Reserve(nmeshes);
+
+        const size_t nbones = m_model->bones.size();
+        for (auto const& mesh : m_model->meshes)
+        {
+            BoundingBox box = mesh->boundingBox;
+            if (m_boneMode && mesh->boneIndex < nbones)
+            {
+                box.Transform(box, m_bones[mesh->boneIndex]);
+            }
+            m_sectionBoxes.Add(box);
+        }
+
+        m_sectionBoxesDirty = false;
+        m_memoryDirty = true;
+    }
+
+    m_sectionRejected = m_sections.Classify(m_sectionBoxes, XMMatrixIdentity(), m_sectionResults.data(), nmeshes);
+}
+
+// Draws the meshes left after the section planes as occluders, then marks those hidden
+// behind the others as Outside. Meshes crossing a section plane are only tested, since
+// their clipped-away parts would otherwise hide what the cut reveals.
+void Game::CullOccludedMeshes()
+{
+    const size_t nmeshes = m_model->meshes.size();
+    if (!m_sections.IsEnabled())
+    {
+        m_sectionResults.assign(nmeshes, DX::SectionPlanes::Result::Inside);
+    }
+
+    const size_t nbones = m_model->bones.size();
+    auto meshWorld = [&](const ModelMesh& mesh) -> XMMATRIX
+    {
+        return (m_boneMode && mesh.boneIndex < nbones) ? XMMatrixMultiply(m_bones[mesh.boneIndex], m_world) : XMMATRIX(m_world);
+    };
+
+    m_visibleOccluders.clear();
+    for (size_t j = 0; j < nmeshes; ++j)
+    {
+        if (m_sectionResults[j] != DX::SectionPlanes::Result::Inside)
+            continue;
+
+        DX::OcclusionCuller::Occluder occluder = { &m_occluders[j], {},
+            m_ccw ? DX::OcclusionCuller::CullMode::CounterClockwise : DX::OcclusionCuller::CullMode::Clockwise };
+        XMStoreFloat4x4(&occluder.world, meshWorld(*m_model->meshes[j]));
+        m_visibleOccluders.push_back(occluder);
+    }
+
+    m_occlusion->RenderOccluders(m_visibleOccluders.data(), m_visibleOccluders.size(), XMMatrixMultiply(m_view, m_proj));
+
+    m_occludedMeshes = 0;
+    for (size_t j = 0; j < nmeshes; ++j)
+    {
+        auto const& mesh = *m_model->meshes[j];
+        if (m_sectionResults[j] != DX::SectionPlanes::Result::Outside
+            && m_occlusion->IsOccluded(mesh.boundingBox, meshWorld(mesh)))
+        {
+            m_sectionResults[j] = DX::SectionPlanes::Result::Outside;
+            ++m_occludedMeshes;
+        }
+    }
+}
+
+// Records the alpha parts of the model with the centers of their triangles, or of their
+// mesh's bounds if the picker has none.
+void Game::BuildAlphaParts()
+{
+    m_alphaParts.clear();
+
+    for (size_t j = 0; j < m_model->meshes.size(); ++j)
+    {
+        auto const& mesh = *m_model->meshes[j];
+        for (size_t k = 0; k < mesh.meshParts.size(); ++k)
+        {
+            auto part = mesh.meshParts[k].get();
+            if (!part->isAlpha)
+                continue;
+
+            // The picker was built from the same file, with its parts in the same order.
+            AlphaPart alphaPart = { j, part, mesh.boundingSphere.Center };
+            BoundingBox box;
+            if (m_picker.GetBounds(static_cast<uint32_t>(j), static_cast<uint32_t>(k), box))
+            {
+                alphaPart.center = box.Center;
+            }
+            m_alphaParts.push_back(alphaPart);
+        }
+    }
+}
+
+// Draws the alpha parts, skipping the meshes marked Outside if 'rejecting'. Sorted, they
+// are drawn back to front by the view depth of their centers.
+//
+// McGuire and Bavoil's weighted blended transparency accumulates weighted colors and the
+// product of one minus each alpha into two extra render targets, then resolves them in a
+// full-screen pass; the stock effects have no way to write those. The viewer approximates
+// it with two passes that, like the original, give the same result in any order: the
+// first darkens what is behind by the product of one minus each layer's alpha, and the
+// second adds every layer's premultiplied color. Without the resolve dividing by the
+// combined alpha, overlapping layers come out brighter than when sorted. The headless
+// renderer's -transparency:oit is exact.
+void Game::DrawAlphaParts(bool rejecting)
+{
+    auto context = m_deviceResources->GetD3DDeviceContext();
+
+    const size_t nbones = m_model->bones.size();
+    auto meshWorld = [&](const ModelMesh& mesh) -> XMMATRIX
+    {
+        return (m_boneMode && mesh.boneIndex < nbones) ? XMMatrixMultiply(m_bones[mesh.boneIndex], m_world) : XMMATRIX(m_world);
+    };
+
+    auto drawPart = [&](const AlphaPart& alphaPart, std::function<void __cdecl()> setCustomState)
+    {
+        auto const& mesh = *m_model->meshes[alphaPart.mesh];
+        mesh.PrepareForRendering(context, *m_states, true, m_wireframe);
+
+        auto part = alphaPart.part;
+        auto imatrices = dynamic_cast<IEffectMatrices*>(part->effect.get());
+        if (imatrices)
+        {
+            imatrices->SetMatrices(meshWorld(mesh), m_view, m_proj);
+        }
+
+        part->Draw(context, part->effect.get(), part->inputLayout.Get(), setCustomState);
+    };
+
+    auto isDrawn = [&](const AlphaPart& alphaPart)
+    {
+        return !rejecting || m_sectionResults[alphaPart.mesh] != DX::SectionPlanes::Result::Outside;
+    };
+
+    if (m_transparencyMode == DX::TransparencyMode::WeightedBlended)
+    {
+        for (auto const& alphaPart : m_alphaParts)
+        {
+            if (isDrawn(alphaPart))
+            {
+                drawPart(alphaPart, [&]() { context->OMSetBlendState(m_revealageBlend.Get(), nullptr, 0xFFFFFFFF); });
+            }
+        }
+
+        for (auto const& alphaPart : m_alphaParts)
+        {
+            if (isDrawn(alphaPart))
+            {
+                // Effects premultiply their colors, but textures without it need scaling.
+                ID3D11BlendState* blend = m_model->meshes[alphaPart.mesh]->pmalpha ? m_accumulateBlend.Get() : m_states->Additive();
+                drawPart(alphaPart, [=]() { context->OMSetBlendState(blend, nullptr, 0xFFFFFFFF); });
+            }
+        }
+        return;
+    }
+
+    // Clip-space w is the view depth.
+    const XMMATRIX viewProj = XMMatrixMultiply(m_view, m_proj);
+    m_alphaDepths.resize(m_alphaParts.size());
+    for (size_t j = 0; j < m_alphaParts.size(); ++j)
+    {
+        auto const& alphaPart = m_alphaParts[j];
+        const XMVECTOR center = XMVector3Transform(XMLoadFloat3(&alphaPart.center), meshWorld(*m_model->meshes[alphaPart.mesh]));
+        m_alphaDepths[j] = XMVectorGetW(XMVector3Transform(center, viewProj));
+    }
+
+    for (const uint32_t j : m_transparencySorter.Sort(m_alphaDepths.data(), m_alphaDepths.size()))
+    {
+        if (isDrawn(m_alphaParts[j]))
+        {
+            drawPart(m_alphaParts[j], nullptr);
+        }
+    }
+}
+
+// Starts a transition, or retargets the one under way without losing its speed
+void Game::MoveCamera(const Vector3& focus, float distance, const Quaternion& rotation)
+{
+    if (!m_cameraMoving)
+    {
+        m_focusSpring.Reset();
+        m_distanceSpring.Reset();
+        m_rotationSpring.Reset();
+
+        m_focusAnimated = m_cameraFocus;
+        m_distanceAnimated = m_distance;
+        m_rotationAnimated = m_cameraRot;
+        m_cameraMoving = true;
+    }
+
+    m_focusTarget = focus;
+    m_distanceTarget = distance;
+    m_rotationTarget = rotation;
+}
+
+void Game::AnimateCamera(float elapsedTime)
+{
+    if (!m_cameraMoving)
+        return;
+
+    if (m_cameraFocus != m_focusAnimated || m_distance != m_distanceAnimated || m_cameraRot != m_rotationAnimated)
+    {
+        // Input took over.
+        m_cameraMoving = false;
+        return;
+    }
+
+    m_focusSpring.Update(m_cameraFocus, m_focusTarget, elapsedTime);
+    m_distanceSpring.Update(m_distance, m_distanceTarget, elapsedTime);
+
+    // Eased component-wise toward whichever of q and -q is nearer, then renormalized.
+    Vector4 rotation(m_cameraRot.x, m_cameraRot.y, m_cameraRot.z, m_cameraRot.w);
+    Vector4 target(m_rotationTarget.x, m_rotationTarget.y, m_rotationTarget.z, m_rotationTarget.w);
+    if (rotation.Dot(target) < 0.f)
+    {
+        target = -target;
+    }
+
+    m_rotationSpring.Update(rotation, target, elapsedTime);
+    m_cameraRot = Quaternion(rotation);
+    m_cameraRot.Normalize();
+
+    const float tolerance = 1e-4f * std::max(m_distanceTarget, 1.f);
+    if (Vector3::Distance(m_cameraFocus, m_focusTarget) < tolerance
+        && std::abs(m_distance - m_distanceTarget) < tolerance
+        && std::abs(m_cameraRot.Dot(m_rotationTarget)) > 1.f - 1e-6f)
+    {
+        m_cameraFocus = m_focusTarget;
+        m_distance = m_distanceTarget;
+        m_cameraRot = m_rotationTarget;
+        m_cameraMoving = false;
+    }
+
+    m_focusAnimated = m_cameraFocus;
+    m_distanceAnimated = m_distance;
+    m_rotationAnimated = m_cameraRot;
+}
+
+// Turns the camera in place, first-person style: the eye stays where it is and the focus
+// swings around it.
 void Game::RotateView( Quaternion& q )
 {
-    UNREFERENCED_PARAMETER(q);
-    // TODO -
+    const Vector3 back = (m_lhcoords) ? Vector3::Forward : Vector3::Backward;
+    const float distance = m_distance * m_zoom;
+    const Vector3 eye = m_cameraFocus + distance * Vector3::Transform(back, m_cameraRot);
+
+    m_cameraRot = q * m_cameraRot;
+    m_cameraRot.Normalize();
+
+    m_cameraFocus = eye - distance * Vector3::Transform(back, m_cameraRot);
 }
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
@@ -1481,7 +3791,7 @@ void Game::EnumerateModelFiles()
 
     WIN32_FIND_DATA ffdata = {};
 
-    static const wchar_t* exts[] = { L"D:\\*.sdkmesh", L"D:\\*.cmo", L"D:\\*.vbo" };
+    static const wchar_t* exts[] = { L"D:\\*.sdkmesh", L"D:\\*.cmo", L"D:\\*.vbo", L"D:\\*.scene" };
     
     for (size_t j = 0; j < _countof(exts); ++j)
     {
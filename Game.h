@@ -9,7 +9,24 @@
 
 #include "StepTimer.h"
 #include "ArcBall.h"
+#include "AutoExposure.h"
+#include "DampedSpring.h"
+#include "DirtyTracker.h"
+#include "FrameHierarchy.h"
+#include "FramePacer.h"
+#include "FrameProfiler.h"
+#include "GpuTimerD3D11.h"
+#include "MemoryAccounting.h"
+#include "ModelData.h"
+#include "ModelPicker.h"
+#include "ModelScene.h"
+#include "OcclusionCuller.h"
+#include "PhaseTimer.h"
 #include "RenderTexture.h"
+#include "SectionPlanes.h"
+#include "StreamingModel.h"
+#include "TaskPool.h"
+#include "TransparencySorter.h"
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
 #include "DeviceResourcesXDK.h"
@@ -62,29 +79,85 @@ public:
     void OnWindowSizeChanged(int width, int height);
     void OnFileOpen(const wchar_t* filename);
 
+    // Startup instrumentation (call before Initialize)
+    void SetStartupOptions(bool fastStart, bool report, _In_opt_z_ const wchar_t* traceFile);
+    DX::PhaseTimer* GetStartupTimer() noexcept { return m_startupComplete ? nullptr : &m_startupTimer; }
+
+    // Frame pacing
+    void SetFramePacing(DX::FramePacing mode, double targetFPS);
+
+    // Number of frames captured by the frame profiler (F3)
+    void SetFrameTraceLength(uint32_t frameCount) noexcept;
+
+    // Memory allowed for the model's buffers and textures; 0 for no limit
+    void SetMemoryBudget(uint64_t bytes) noexcept { m_memoryBudget = bytes; }
+
+    // Streams every .sdkmesh under this many bytes of resident buffers; 0 streams only
+    // files too large to load whole
+    void SetStreamingBudget(uint64_t bytes) noexcept { m_streamingBudget = bytes; }
+    DWORD GetIdleTimeout() const noexcept;
+
     // Properties
     void GetDefaultSize( int& width, int& height ) const noexcept;
     bool RequestHDRMode() const noexcept { return m_deviceResources ? (m_deviceResources->GetDeviceOptions() & DX::DeviceResources::c_EnableHDR) != 0 : false; }
 
 private:
 
+    void WaitForNextFrame();
+    void TrackRenderState();
     void Update(DX::StepTimer const& timer);
     void Render();
+    void ToneMapAndPresent();
+    void CaptureExposure();
+    void UpdateExposure(float elapsedTime);
 
     void Clear();
 
     void CreateDeviceDependentResources();
     void CreateWindowSizeDependentResources();
-    
+    void CreateDeferredResources();
+    void CreateIBL(size_t index);
+    void CreateHUDFont();
+    void CreateExposureResources();
+    void SetHdrTarget(DX::HdrFormat format, uint32_t sampleCount);
+    void OnStartupComplete();
+
     void LoadModel();
+    void LoadScene(_In_z_ const wchar_t* name);
+    void LoadStreamingModel(_In_z_ const wchar_t* name, _In_z_ const wchar_t* directory);
+    void CheckMemoryBudget(_In_z_ const wchar_t* name);
+    void DrawModel();
+    void DrawScene();
+    void DrawStreaming();
     void DrawGrid();
     void DrawCross();
-
-    void CameraHome();
+    void DrawFrameGraph();
+
+    void CameraHome(bool animate = false);
+    void MoveCamera(const DirectX::SimpleMath::Vector3& focus, float distance, const DirectX::SimpleMath::Quaternion& rotation);
+    void AnimateCamera(float elapsedTime);
+    void FocusOnPick();
+    void FrameSelection(bool wholeMesh);
+    void Pick();
+    void CycleSectionMode();
+    void UpdateSectionPlanes();
+    void ClassifySections();
+    void CullOccludedMeshes();
+    void BuildAlphaParts();
+    void DrawAlphaParts(bool rejecting);
 
     void CycleBackgroundColor();
     void CycleToneMapOperator();
     void CycleBoneRenderMode();
+    void CycleFrameBudget();
+    void CycleFramePacing();
+    void CycleTargetFrameRate();
+    void ExportFrameTimes();
+    void ExportFrameTrace();
+    void TraceGpuTimes();
+    void UpdateMemoryUsage();
+    void ExportMemoryUsage();
+    void ToggleAutoExposure();
 
     void CreateProjection();
 
@@ -101,6 +174,37 @@ private:
     // Rendering loop timer.
     DX::StepTimer                                   m_timer;
 
+    // Startup instrumentation.
+    DX::PhaseTimer                                  m_startupTimer;
+    std::wstring                                    m_startupTraceFile;
+    bool                                            m_startupReport;
+    bool                                            m_startupComplete;
+    bool                                            m_fastStart;
+    bool                                            m_deferredResources;
+
+    // Frame pacing.
+    DX::FramePacer                                  m_framePacer;
+    DX::SleepTimer                                  m_sleepTimer;
+    uint32_t                                        m_frameTraceLength;
+    bool                                            m_frameTraceRequested;
+
+    // GPU pass timing.
+    DX::GpuTimer                                    m_gpuTimer;
+    std::unique_ptr<DX::GpuTimerQueriesD3D11>       m_gpuQueries;
+    bool                                            m_showGpuTimes;
+
+    // Memory accounting; rebuilt from the live resources whenever they change.
+    DX::MemoryLedger                                m_memory;
+    std::vector<std::pair<std::string, Microsoft::WRL::ComPtr<ID3D11Resource>>> m_modelTextures;
+    uint64_t                                        m_modelMemory;
+    uint64_t                                        m_memoryBudget;
+    uint64_t                                        m_streamingBudget;
+    bool                                            m_memoryDirty;
+    bool                                            m_showMemory;
+
+    DX::DirtyTracker                                m_renderState;
+    bool                                            m_idle;
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
     std::unique_ptr<DirectX::GraphicsMemory>        m_graphicsMemory;
 #endif
@@ -109,16 +213,94 @@ private:
     std::unique_ptr<DirectX::SpriteFont>            m_fontConsolas;
     std::unique_ptr<DirectX::SpriteFont>            m_fontComic;
     std::unique_ptr<DirectX::Model>                 m_model;
+    std::unique_ptr<DX::ModelScene>                 m_scene;
+    std::unique_ptr<DX::StreamingModel>             m_streaming;
     std::unique_ptr<DirectX::EffectFactory>         m_fxFactory;
     std::unique_ptr<DirectX::PBREffectFactory>      m_pbrFXFactory;
     std::unique_ptr<DirectX::CommonStates>          m_states;
     std::unique_ptr<DirectX::BasicEffect>           m_lineEffect;
     std::unique_ptr<DirectX::ToneMapPostProcess>    m_toneMap;
     DirectX::ModelBone::TransformArray              m_bones;
+    DX::FrameHierarchy                              m_boneHierarchy;
+    DX::ModelData::Statistics                       m_modelStats;
+
+    // Picking: input records where to pick, and the ray is cast once the frame's matrices
+    // are known.
+    DX::ModelPicker                                 m_picker;
+    DX::ModelPicker::Hit                            m_pick;
+    DirectX::XMFLOAT2                               m_pickPosition;     // In pixels
+    DirectX::SimpleMath::Vector3                    m_pickPoint;        // In object space
+    bool                                            m_pickRequested;
+    bool                                            m_hasPick;
+
+    // Section planes: six axis-aligned planes across the model's bounds, each turned on by
+    // itself or all six as a clip box. Meshes entirely on the clipped side aren't drawn.
+    DX::SectionPlanes                               m_sections;
+    DX::SectionPlanes::BoxBatch                     m_sectionBoxes;     // Mesh bounds as drawn, in model space
+    std::vector<DX::SectionPlanes::Result>          m_sectionResults;
+    DirectX::BoundingBox                            m_sectionBounds;
+    float                                           m_sectionOffsets[DX::SectionPlanes::MaxPlanes];    // 0 to 1 across the bounds
+    uint32_t                                        m_sectionMode;
+    uint32_t                                        m_sectionEnabled;   // Bit per plane
+    uint32_t                                        m_sectionSelected;
+    size_t                                          m_sectionRejected;
+    bool                                            m_sectionBoxesDirty;
+
+    // Occlusion culling: the meshes in view are drawn as occluders into a small depth
+    // buffer on the CPU, and those hidden behind others aren't drawn. Meshes culled here
+    // are marked Outside in m_sectionResults.
+    std::unique_ptr<DX::TaskPool>                   m_taskPool;
+    std::unique_ptr<DX::OcclusionCuller>            m_occlusion;
+    std::vector<DX::OcclusionCuller::OccluderMesh>  m_occluders;        // Per mesh of m_model
+    std::vector<DX::OcclusionCuller::Occluder>      m_visibleOccluders;
+    size_t                                          m_occludedMeshes;
+    bool                                            m_occlusionEnabled;
+
+    // Transparency: the alpha parts of m_model, drawn in mesh order as Model::Draw does,
+    // back to front by the view depth of their centers, or in any order (see
+    // DrawAlphaParts).
+    struct AlphaPart
+    {
+        size_t                                      mesh;
+        DirectX::ModelMeshPart*                     part;
+        DirectX::XMFLOAT3                           center;         // In object space
+    };
+
+    std::vector<AlphaPart>                          m_alphaParts;
+    std::vector<float>                              m_alphaDepths;
+    DX::TransparencySorter                          m_transparencySorter;
+    DX::TransparencyMode                            m_transparencyMode;
+    Microsoft::WRL::ComPtr<ID3D11BlendState>        m_revealageBlend;
+    Microsoft::WRL::ComPtr<ID3D11BlendState>        m_accumulateBlend;
 
     Microsoft::WRL::ComPtr<ID3D11InputLayout>       m_lineLayout;
     std::unique_ptr<DirectX::PrimitiveBatch<DirectX::VertexPositionColor>>  m_lineBatch;
 
+    // Auto-exposure: the HDR scene is downsampled on the GPU, then read back a few frames
+    // later for the CPU histogram.
+    static constexpr size_t s_nExposureReadback = 3;
+
+    DX::AutoExposure                                m_autoExposure;
+    DX::LuminanceHistogram                          m_luminanceHistogram;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D>         m_exposureMips;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>    m_exposureMipsSRV;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D>         m_exposureReadback[s_nExposureReadback];
+    bool                                            m_exposurePending[s_nExposureReadback];
+    UINT                                            m_exposureMip;
+    UINT                                            m_exposureWidth;
+    UINT                                            m_exposureHeight;
+    size_t                                          m_exposureWrite;
+    size_t                                          m_exposureRead;
+    float                                           m_exposure;
+    bool                                            m_autoExposureEnabled;
+    bool                                            m_histogramValid;
+
+    // HDR scene target: format and sample count (F7, F6), and the counts the device
+    // supports for that format as a mask.
+    DX::HdrFormat                                   m_hdrFormat;
+    uint32_t                                        m_msaaSamples;
+    uint32_t                                        m_msaaSupported;
+
     static constexpr size_t s_nIBL = 3;
 
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>    m_radianceIBL[s_nIBL];
@@ -145,6 +327,19 @@ private:
 
     DirectX::SimpleMath::Quaternion                 m_modelRot;
 
+    // Camera transitions: the focus, distance, and rotation ease toward their targets,
+    // and any other change to them cancels the transition.
+    DX::DampedSpring<DirectX::SimpleMath::Vector3>  m_focusSpring;
+    DX::DampedSpring<float>                         m_distanceSpring;
+    DX::DampedSpring<DirectX::SimpleMath::Vector4>  m_rotationSpring;
+    DirectX::SimpleMath::Vector3                    m_focusTarget;
+    DirectX::SimpleMath::Vector3                    m_focusAnimated;    // As last set by AnimateCamera
+    DirectX::SimpleMath::Quaternion                 m_rotationTarget;
+    DirectX::SimpleMath::Quaternion                 m_rotationAnimated;
+    float                                           m_distanceTarget;
+    float                                           m_distanceAnimated;
+    bool                                            m_cameraMoving;
+
     float                                           m_gridScale;
     float                                           m_fov;
     float                                           m_zoom;
@@ -157,6 +352,7 @@ private:
     bool                                            m_showHud;
     bool                                            m_showCross;
     bool                                            m_showGrid;
+    bool                                            m_showFrameGraph;
     bool                                            m_usingGamepad;
     bool                                            m_wireframe;
     bool                                            m_ccw;
@@ -166,6 +362,7 @@ private:
     bool                                            m_fpscamera;
     bool                                            m_boneMode;
     bool                                            m_skinning;
+    bool                                            m_bonesSkinned;     // m_bones includes the inverse bind pose
 
     int                                             m_toneMapMode;
     bool                                            m_updateEffects;
@@ -0,0 +1,209 @@
+//--------------------------------------------------------------------------------------
+// File: GpuTimer.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#include <sal.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "GpuTimer.h"
+
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_FrameBegin = 0;
+    constexpr size_t c_FrameEnd = 1;
+
+    constexpr size_t PassBegin(size_t pass) noexcept { return 2 + 2 * pass; }
+    constexpr size_t PassEnd(size_t pass) noexcept { return 3 + 2 * pass; }
+
+    // Weight of the newest frame in the smoothed times.
+    constexpr float c_Smoothing = 0.1f;
+
+    // Passes not drawn for this many resolved frames report no time.
+    constexpr uint64_t c_PassTimeout = 60;
+
+    static_assert(DX::GpuTimer::QueriesPerSlot <= 32, "Query mask is 32 bits");
+
+    float ToMilliseconds(uint64_t begin, uint64_t end, uint64_t frequency) noexcept
+    {
+        return (end > begin) ? float(double(end - begin) * 1000.0 / double(frequency)) : 0.f;
+    }
+}
+
+GpuTimer::GpuTimer() noexcept :
+    m_queries(nullptr),
+    m_slots{},
+    m_write(0),
+    m_read(0),
+    m_recording(false),
+    m_readBack(false),
+    m_newResults(false),
+    m_resolvedFrames(0),
+    m_passFrame{},
+    m_lastPass{},
+    m_averagePass{},
+    m_lastFrame(-1.f),
+    m_averageFrame(-1.f),
+    m_skippedFrames(0),
+    m_disjointFrames(0)
+{
+    for (size_t pass = 0; pass < MaxPasses; ++pass)
+    {
+        m_lastPass[pass] = m_averagePass[pass] = -1.f;
+    }
+}
+
+void GpuTimer::SetQueries(IGpuTimerQueries* queries) noexcept
+{
+    m_queries = queries;
+
+    for (auto& slot : m_slots)
+    {
+        slot = {};
+    }
+
+    m_write = m_read = 0;
+    m_recording = false;
+    m_readBack = m_newResults = false;
+}
+
+void GpuTimer::BeginFrame()
+{
+    if (!m_queries || m_recording)
+        return;
+
+    ResolvePending();
+
+    // The ring is full of frames the GPU hasn't finished; skip rather than wait.
+    auto& slot = m_slots[m_write];
+    if (slot.state != SlotState::Free)
+    {
+        ++m_skippedFrames;
+        return;
+    }
+
+    slot.state = SlotState::Recording;
+    slot.queryMask = 0;
+    slot.passMask = 0;
+    m_recording = true;
+
+    m_queries->Begin(m_write);
+    Timestamp(c_FrameBegin);
+}
+
+void GpuTimer::EndFrame()
+{
+    if (!m_queries)
+        return;
+
+    if (m_recording)
+    {
+        Timestamp(c_FrameEnd);
+        m_queries->End(m_write);
+
+        m_slots[m_write].state = SlotState::Pending;
+        m_write = (m_write + 1) % FrameLatency;
+        m_recording = false;
+    }
+
+    ResolvePending();
+
+    m_newResults = m_readBack;
+    m_readBack = false;
+}
+
+void GpuTimer::BeginPass(size_t pass)
+{
+    if (!m_recording || pass >= MaxPasses)
+        return;
+
+    Timestamp(PassBegin(pass));
+}
+
+void GpuTimer::EndPass(size_t pass)
+{
+    if (!m_recording || pass >= MaxPasses)
+        return;
+
+    auto& slot = m_slots[m_write];
+    if (!(slot.queryMask & (1u << PassBegin(pass))))
+        return;
+
+    Timestamp(PassEnd(pass));
+    slot.passMask |= 1u << pass;
+}
+
+float GpuTimer::GetLastPassMilliseconds(size_t pass) const noexcept
+{
+    return (pass < MaxPasses) ? m_lastPass[pass] : -1.f;
+}
+
+float GpuTimer::GetPassMilliseconds(size_t pass) const noexcept
+{
+    if (pass >= MaxPasses || m_averagePass[pass] < 0.f || m_resolvedFrames - m_passFrame[pass] >= c_PassTimeout)
+        return -1.f;
+
+    return m_averagePass[pass];
+}
+
+void GpuTimer::Timestamp(size_t index)
+{
+    m_queries->Timestamp(m_write, index);
+    m_slots[m_write].queryMask |= 1u << index;
+}
+
+// Reads back finished frames oldest first, stopping at the first that isn't ready.
+void GpuTimer::ResolvePending()
+{
+    while (m_slots[m_read].state == SlotState::Pending)
+    {
+        auto& slot = m_slots[m_read];
+
+        uint64_t timestamps[32] = {};
+        uint64_t frequency = 0;
+        if (!m_queries->Resolve(m_read, slot.queryMask, timestamps, frequency))
+            break;
+
+        slot.state = SlotState::Free;
+        m_read = (m_read + 1) % FrameLatency;
+
+        if (!frequency)
+        {
+            ++m_disjointFrames;
+            continue;
+        }
+
+        ++m_resolvedFrames;
+        m_readBack = true;
+
+        m_lastFrame = ToMilliseconds(timestamps[c_FrameBegin], timestamps[c_FrameEnd], frequency);
+        m_averageFrame = (m_averageFrame < 0.f) ? m_lastFrame : m_averageFrame + (m_lastFrame - m_averageFrame) * c_Smoothing;
+
+        for (size_t pass = 0; pass < MaxPasses; ++pass)
+        {
+            if (!(slot.passMask & (1u << pass)))
+            {
+                m_lastPass[pass] = -1.f;
+                continue;
+            }
+
+            const float ms = ToMilliseconds(timestamps[PassBegin(pass)], timestamps[PassEnd(pass)], frequency);
+            m_lastPass[pass] = ms;
+
+            // Restart the average after a gap so a pass toggled back on isn't blended with old times.
+            const bool stale = m_averagePass[pass] < 0.f || m_resolvedFrames - m_passFrame[pass] >= c_PassTimeout;
+            m_averagePass[pass] = stale ? ms : m_averagePass[pass] + (ms - m_averagePass[pass]) * c_Smoothing;
+            m_passFrame[pass] = m_resolvedFrames;
+        }
+    }
+}
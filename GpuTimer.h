@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------
+// File: GpuTimer.h
+//
+// Per-pass GPU timing with timestamp queries. Each frame's queries go into one slot of a
+// ring a few frames deep and are read back once the GPU has finished with them, so the
+// CPU never waits. If every slot is still in flight, the frame is not timed.
+//
+// The ring bookkeeping is independent of the graphics API; IGpuTimerQueries issues and
+// reads back the actual queries.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace DX
+{
+    class IGpuTimerQueries
+    {
+    public:
+        virtual ~IGpuTimerQueries() = default;
+
+        // Brackets the timestamps of one frame in 'slot' (a disjoint query on Direct3D 11).
+        virtual void Begin(size_t slot) = 0;
+        virtual void End(size_t slot) = 0;
+
+        virtual void Timestamp(size_t slot, size_t index) = 0;
+
+        // Reads back the timestamps of 'slot' whose bits are set in 'mask' without waiting.
+        // Returns false if they are not available yet. 'frequency' is in ticks per second,
+        // or 0 if the timestamps are unreliable (e.g. the GPU clock changed mid-frame).
+        virtual bool Resolve(size_t slot, uint32_t mask, _Out_writes_(32) uint64_t* timestamps, uint64_t& frequency) = 0;
+
+    protected:
+        IGpuTimerQueries() = default;
+    };
+
+    class GpuTimer
+    {
+    public:
+        static constexpr size_t MaxPasses = 8;
+        static constexpr size_t FrameLatency = 4;       // Slots in the ring
+        static constexpr size_t QueriesPerSlot = 2 + 2 * MaxPasses;
+
+        GpuTimer() noexcept;
+
+        GpuTimer(GpuTimer&&) = default;
+        GpuTimer& operator= (GpuTimer&&) = default;
+
+        GpuTimer(GpuTimer const&) = delete;
+        GpuTimer& operator= (GpuTimer const&) = delete;
+
+        // Null stops timing, e.g. when the device is lost; results in flight are discarded.
+        void SetQueries(IGpuTimerQueries* queries) noexcept;
+
+        void BeginFrame();
+        void EndFrame();
+
+        // A pass may be timed at most once per frame, and passes must not overlap.
+        void BeginPass(size_t pass);
+        void EndPass(size_t pass);
+
+        // True if the last EndFrame (or the BeginFrame before it) read back a timed frame.
+        bool HasNewResults() const noexcept { return m_newResults; }
+
+        // Milliseconds of the most recently read-back frame, or a negative value if the pass
+        // wasn't drawn in that frame.
+        float GetLastPassMilliseconds(size_t pass) const noexcept;
+        float GetLastFrameMilliseconds() const noexcept { return m_lastFrame; }
+
+        // Smoothed over recent frames, or a negative value if the pass hasn't been drawn in
+        // the last 60 frames read back.
+        float GetPassMilliseconds(size_t pass) const noexcept;
+        float GetFrameMilliseconds() const noexcept { return m_averageFrame; }
+
+        // Frames not timed because every slot was still in flight, and frames whose
+        // timestamps were unreliable.
+        uint64_t GetSkippedFrames() const noexcept { return m_skippedFrames; }
+        uint64_t GetDisjointFrames() const noexcept { return m_disjointFrames; }
+
+    private:
+        enum class SlotState : uint32_t
+        {
+            Free,
+            Recording,
+            Pending,
+        };
+
+        struct Slot
+        {
+            SlotState   state;
+            uint32_t    queryMask;      // Timestamps issued this frame
+            uint32_t    passMask;       // Passes both begun and ended this frame
+        };
+
+        IGpuTimerQueries*   m_queries;
+        Slot                m_slots[FrameLatency];
+        size_t              m_write;
+        size_t              m_read;
+        bool                m_recording;
+        bool                m_readBack;
+        bool                m_newResults;
+
+        uint64_t            m_resolvedFrames;
+        uint64_t            m_passFrame[MaxPasses];     // Last resolved frame that drew each pass
+        float               m_lastPass[MaxPasses];
+        float               m_averagePass[MaxPasses];
+        float               m_lastFrame;
+        float               m_averageFrame;
+
+        uint64_t            m_skippedFrames;
+        uint64_t            m_disjointFrames;
+
+        void Timestamp(size_t index);
+        void ResolvePending();
+    };
+}
@@ -0,0 +1,79 @@
+//--------------------------------------------------------------------------------------
+// File: GpuTimerD3D11.cpp
+//
+// Direct3D 11 timestamp and disjoint queries for GpuTimer
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "GpuTimerD3D11.h"
+
+using namespace DX;
+
+GpuTimerQueriesD3D11::GpuTimerQueriesD3D11(ID3D11Device* device, ID3D11DeviceContext* context) :
+    m_context(context)
+{
+    if (!device || !context)
+        throw std::invalid_argument("GpuTimerQueriesD3D11");
+
+    D3D11_QUERY_DESC desc = {};
+    for (size_t slot = 0; slot < GpuTimer::FrameLatency; ++slot)
+    {
+        desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+        ThrowIfFailed(device->CreateQuery(&desc, m_disjoint[slot].ReleaseAndGetAddressOf()));
+
+        desc.Query = D3D11_QUERY_TIMESTAMP;
+        for (auto& query : m_timestamps[slot])
+        {
+            ThrowIfFailed(device->CreateQuery(&desc, query.ReleaseAndGetAddressOf()));
+        }
+    }
+}
+
+void GpuTimerQueriesD3D11::Begin(size_t slot)
+{
+    m_context->Begin(m_disjoint[slot].Get());
+}
+
+void GpuTimerQueriesD3D11::End(size_t slot)
+{
+    m_context->End(m_disjoint[slot].Get());
+}
+
+void GpuTimerQueriesD3D11::Timestamp(size_t slot, size_t index)
+{
+    m_context->End(m_timestamps[slot][index].Get());
+}
+
+bool GpuTimerQueriesD3D11::Resolve(size_t slot, uint32_t mask, uint64_t* timestamps, uint64_t& frequency)
+{
+    frequency = 0;
+
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+    HRESULT hr = m_context->GetData(m_disjoint[slot].Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+    if (hr == S_FALSE)
+        return false;
+
+    ThrowIfFailed(hr);
+
+    for (size_t index = 0; index < GpuTimer::QueriesPerSlot; ++index)
+    {
+        if (!(mask & (1u << index)))
+            continue;
+
+        hr = m_context->GetData(m_timestamps[slot][index].Get(), &timestamps[index], sizeof(uint64_t), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+        if (hr == S_FALSE)
+            return false;
+
+        ThrowIfFailed(hr);
+    }
+
+    if (!disjoint.Disjoint)
+    {
+        frequency = disjoint.Frequency;
+    }
+
+    return true;
+}
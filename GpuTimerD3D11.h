@@ -0,0 +1,40 @@
+//--------------------------------------------------------------------------------------
+// File: GpuTimerD3D11.h
+//
+// Direct3D 11 timestamp and disjoint queries for GpuTimer
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "GpuTimer.h"
+
+#include <wrl/client.h>
+
+
+namespace DX
+{
+    class GpuTimerQueriesD3D11 final : public IGpuTimerQueries
+    {
+    public:
+        GpuTimerQueriesD3D11(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context);
+
+        GpuTimerQueriesD3D11(GpuTimerQueriesD3D11&&) = default;
+        GpuTimerQueriesD3D11& operator= (GpuTimerQueriesD3D11&&) = default;
+
+        GpuTimerQueriesD3D11(GpuTimerQueriesD3D11 const&) = delete;
+        GpuTimerQueriesD3D11& operator= (GpuTimerQueriesD3D11 const&) = delete;
+
+        void Begin(size_t slot) override;
+        void End(size_t slot) override;
+        void Timestamp(size_t slot, size_t index) override;
+        bool Resolve(size_t slot, uint32_t mask, _Out_writes_(32) uint64_t* timestamps, uint64_t& frequency) override;
+
+    private:
+        Microsoft::WRL::ComPtr<ID3D11DeviceContext>     m_context;
+        Microsoft::WRL::ComPtr<ID3D11Query>             m_disjoint[GpuTimer::FrameLatency];
+        Microsoft::WRL::ComPtr<ID3D11Query>             m_timestamps[GpuTimer::FrameLatency][GpuTimer::QueriesPerSlot];
+    };
+}
@@ -0,0 +1,348 @@
+//--------------------------------------------------------------------------------------
+// File: HeadlessArguments.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessRenderer.h"
+#include "CommandLine.h"
+#include "ReadData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    const wchar_t* c_HeadlessViewNames[] = { L"front", L"side", L"top", L"iso" };
+
+    static_assert(std::extent<decltype(c_HeadlessViewNames)>::value == static_cast<size_t>(HeadlessView::Count), "Headless view name table mismatch");
+
+    // Values of -tonemap:, in SoftwareToneMap::Operator order.
+    const wchar_t* c_ToneMapOperatorNames[] = { L"none", L"saturate", L"reinhard", L"aces" };
+
+    static_assert(std::extent<decltype(c_ToneMapOperatorNames)>::value == SoftwareToneMap::Operator_Max, "Tone map operator name table mismatch");
+
+    // Values of -transparency:, in TransparencyMode order.
+    const wchar_t* c_TransparencySwitchNames[] = { L"order", L"sorted", L"oit" };
+
+    static_assert(std::extent<decltype(c_TransparencySwitchNames)>::value == static_cast<size_t>(TransparencyMode::Count), "Transparency switch name table mismatch");
+
+    // Values of -hdrformat:, in HdrFormat order.
+    const wchar_t* c_HdrFormatSwitchNames[] = { L"rgba16f", L"r11g11b10f" };
+
+    static_assert(std::extent<decltype(c_HdrFormatSwitchNames)>::value == static_cast<size_t>(HdrFormat::Count), "HDR format switch name table mismatch");
+
+    constexpr uint32_t c_MaxTargetSize = 8192;
+
+    bool ReadListFile(const wchar_t* name, HeadlessOptions& options)
+    {
+        std::ifstream inFile(FileName(name));
+        if (!inFile)
+            return false;
+
+        std::string line;
+        while (std::getline(inFile, line))
+        {
+            // Trim whitespace (including any '\r') and skip blank lines and # comments.
+            const size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+                continue;
+
+            const size_t last = line.find_last_not_of(" \t\r");
+            line = line.substr(first, last - first + 1);
+
+        #ifdef _WIN32
+            const int len = MultiByteToWideChar(CP_UTF8, 0, line.c_str(), static_cast<int>(line.size()), nullptr, 0);
+            std::wstring wide(static_cast<size_t>(std::max(len, 0)), L'\0');
+            if (len > 0)
+            {
+                MultiByteToWideChar(CP_UTF8, 0, line.c_str(), static_cast<int>(line.size()), &wide[0], len);
+            }
+        #else
+            std::wstring wide(line.size(), L'\0');
+            const size_t len = mbstowcs(&wide[0], line.c_str(), wide.size());
+            if (len == static_cast<size_t>(-1))
+                continue;
+            wide.resize(len);
+        #endif
+
+            options.models.emplace_back(std::move(wide));
+        }
+
+        return true;
+    }
+}
+
+bool DX::ParseHeadlessArgument(const wchar_t* arg, HeadlessOptions& options)
+{
+    if (!arg || !*arg)
+        return false;
+
+    const wchar_t* value = nullptr;
+    if (*arg == L'@')
+    {
+        return ReadListFile(arg + 1, options);
+    }
+    else if ((value = MatchSwitch(arg, L"out")) != nullptr && *value)
+    {
+        options.outputDirectory = value;
+    }
+    else if ((value = MatchSwitch(arg, L"size")) != nullptr && *value)
+    {
+        wchar_t* end = nullptr;
+        const unsigned long width = wcstoul(value, &end, 10);
+        unsigned long height = width;
+        if (end && (*end == L'x' || *end == L'X'))
+        {
+            height = wcstoul(end + 1, nullptr, 10);
+        }
+
+        if (!width || !height || width > c_MaxTargetSize || height > c_MaxTargetSize)
+            return false;
+
+        options.width = static_cast<uint32_t>(width);
+        options.height = static_cast<uint32_t>(height);
+    }
+    else if ((value = MatchSwitch(arg, L"views")) != nullptr && *value)
+    {
+        options.views.clear();
+
+        std::wstring list(value);
+        size_t start = 0;
+        while (start <= list.size())
+        {
+            size_t end = list.find(L',', start);
+            if (end == std::wstring::npos)
+                end = list.size();
+
+            const std::wstring name = list.substr(start, end - start);
+            bool found = false;
+            for (size_t j = 0; j < static_cast<size_t>(HeadlessView::Count); ++j)
+            {
+                if (EqualsNoCase(name.c_str(), c_HeadlessViewNames[j]))
+                {
+                    options.views.push_back(static_cast<HeadlessView>(j));
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found)
+                return false;
+
+            start = end + 1;
+        }
+    }
+    else if (MatchSwitch(arg, L"grid"))
+    {
+        options.grid = true;
+    }
+    else if (MatchSwitch(arg, L"rhcoords"))
+    {
+        options.lhcoords = false;
+    }
+    else if ((value = MatchSwitch(arg, L"tonemap")) != nullptr && *value)
+    {
+        bool found = false;
+        for (uint32_t j = 0; j < SoftwareToneMap::Operator_Max; ++j)
+        {
+            if (EqualsNoCase(value, c_ToneMapOperatorNames[j]))
+            {
+                options.toneMapOperator = static_cast<SoftwareToneMap::Operator>(j);
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            return false;
+    }
+    else if ((value = MatchSwitch(arg, L"hdrformat")) != nullptr && *value)
+    {
+        bool found = false;
+        for (uint32_t j = 0; j < static_cast<uint32_t>(HdrFormat::Count); ++j)
+        {
+            if (EqualsNoCase(value, c_HdrFormatSwitchNames[j]))
+            {
+                options.hdrFormat = static_cast<HdrFormat>(j);
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            return false;
+    }
+    else if ((value = MatchSwitch(arg, L"exposure")) != nullptr && EqualsNoCase(value, L"auto"))
+    {
+        options.autoExposure = true;
+    }
+    else if ((value = MatchSwitch(arg, L"exposure")) != nullptr && *value)
+    {
+        wchar_t* end = nullptr;
+        const float exposure = wcstof(value, &end);
+        if ((end && *end) || !std::isfinite(exposure) || std::abs(exposure) > 32.f)
+            return false;
+
+        options.exposure = exposure;
+        options.autoExposure = false;
+    }
+    else if ((value = MatchSwitch(arg, L"threads")) != nullptr && *value)
+    {
+        wchar_t* end = nullptr;
+        const unsigned long threads = wcstoul(value, &end, 10);
+        if (!threads || threads > 256 || (end && *end))
+            return false;
+
+        options.threads = static_cast<uint32_t>(threads);
+    }
+    else if ((value = MatchSwitch(arg, L"jobs")) != nullptr && *value)
+    {
+        wchar_t* end = nullptr;
+        const unsigned long jobs = wcstoul(value, &end, 10);
+        if (!jobs || jobs > 256 || (end && *end))
+            return false;
+
+        options.jobs = static_cast<uint32_t>(jobs);
+    }
+    else if ((value = MatchSwitch(arg, L"golden")) != nullptr && *value)
+    {
+        options.goldenDirectory = value;
+    }
+    else if ((value = MatchSwitch(arg, L"ssim")) != nullptr && *value)
+    {
+        wchar_t* end = nullptr;
+        const float ssim = wcstof(value, &end);
+        if ((end && *end) || !(ssim >= 0.f && ssim <= 1.f))
+            return false;
+
+        options.tolerance.minSSIM = ssim;
+    }
+    else if ((value = MatchSwitch(arg, L"maxdiff")) != nullptr && *value)
+    {
+        wchar_t* end = nullptr;
+        const float percent = wcstof(value, &end);
+        if ((end && *end) || !(percent >= 0.f && percent <= 100.f))
+            return false;
+
+        options.tolerance.maxDifferingPixels = percent / 100.f;
+    }
+    else if ((value = MatchSwitch(arg, L"generate")) != nullptr && *value)
+    {
+        options.generateDirectory = value;
+    }
+    else if ((value = MatchSwitch(arg, L"json")) != nullptr && *value)
+    {
+        options.jsonFile = value;
+    }
+    else if ((value = MatchSwitch(arg, L"benchmark")) != nullptr)
+    {
+        unsigned long iterations = 10;
+        if (*value)
+        {
+            wchar_t* end = nullptr;
+            iterations = wcstoul(value, &end, 10);
+            if (!iterations || iterations > 100000 || (end && *end))
+                return false;
+        }
+
+        options.benchmark = static_cast<uint32_t>(iterations);
+    }
+    else if (MatchSwitch(arg, L"inspect"))
+    {
+        options.inspect = true;
+    }
+    else if (MatchSwitch(arg, L"occlusion"))
+    {
+        options.occlusion = true;
+    }
+    else if ((value = MatchSwitch(arg, L"transparency")) != nullptr && *value)
+    {
+        bool found = false;
+        for (uint32_t j = 0; j < static_cast<uint32_t>(TransparencyMode::Count); ++j)
+        {
+            if (EqualsNoCase(value, c_TransparencySwitchNames[j]))
+            {
+                options.transparency = static_cast<TransparencyMode>(j);
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+            return false;
+    }
+    else if ((value = MatchSwitch(arg, L"residency")) != nullptr && *value)
+    {
+        // Megabytes
+        wchar_t* end = nullptr;
+        const double megabytes = wcstod(value, &end);
+        if ((end && *end) || !(megabytes > 0.0 && megabytes <= 1024.0 * 1024.0))
+            return false;
+
+        options.residencyBudget = std::max<uint64_t>(1, static_cast<uint64_t>(megabytes * 1024.0 * 1024.0));
+    }
+    else if ((value = MatchSwitch(arg, L"section")) != nullptr && *value)
+    {
+        // Plane as a,b,c,d keeping ax + by + cz + d > 0; repeat for up to six.
+        float plane[4] = {};
+        const wchar_t* next = value;
+        for (size_t j = 0; j < 4; ++j)
+        {
+            wchar_t* end = nullptr;
+            plane[j] = wcstof(next, &end);
+            if (end == next || !std::isfinite(plane[j]) || *end != ((j < 3) ? L',' : L'\0'))
+                return false;
+            next = end + 1;
+        }
+
+        if ((plane[0] == 0.f && plane[1] == 0.f && plane[2] == 0.f)
+            || options.sections.GetPlaneCount() >= SectionPlanes::MaxPlanes)
+            return false;
+
+        XMFLOAT4 planes[SectionPlanes::MaxPlanes];
+        const size_t count = options.sections.GetPlaneCount();
+        for (size_t j = 0; j < count; ++j)
+        {
+            planes[j] = options.sections.GetPlane(j);
+        }
+        planes[count] = XMFLOAT4(plane);
+        options.sections.SetPlanes(planes, count + 1);
+    }
+    else if (IsSwitch(arg))
+    {
+        return false;
+    }
+    else
+    {
+        options.models.emplace_back(arg);
+    }
+
+    return true;
+}
+
+const wchar_t* DX::GetHeadlessViewName(HeadlessView view) noexcept
+{
+    const auto index = static_cast<size_t>(view);
+    return (index < static_cast<size_t>(HeadlessView::Count)) ? c_HeadlessViewNames[index] : L"unknown";
+}
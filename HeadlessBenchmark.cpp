@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------------------------
+// File: HeadlessBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "ReadData.h"
+
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    std::string Narrow(const std::wstring& str)
+    {
+    #ifdef _WIN32
+        if (str.empty())
+            return std::string();
+
+        const int len = WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0, nullptr, nullptr);
+        std::string result(static_cast<size_t>(std::max(len, 0)), '\0');
+        if (len > 0)
+        {
+            WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &result[0], len, nullptr, nullptr);
+        }
+        return result;
+    #else
+        return FileName(str.c_str());
+    #endif
+    }
+
+    std::wstring GetExtension(const std::wstring& path)
+    {
+        const size_t dot = path.find_last_of(L'.');
+        const size_t slash = path.find_last_of(L"\\/");
+        if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash))
+            return std::wstring();
+
+        return path.substr(dot);
+    }
+
+    // Renders every view 'options.benchmark' times at 1, 2, 4, ... threads up to
+    // 'maxThreads' and reports the throughput of the whole pipeline at each count.
+    std::vector<BenchmarkReport::ThreadResult> BenchmarkModel(const ModelData& model, const HeadlessOptions& options,
+        const std::vector<HeadlessView>& views, size_t maxThreads, std::ostream& log)
+    {
+        using clock = std::chrono::steady_clock;
+
+        std::vector<BenchmarkReport::ThreadResult> results;
+
+        std::vector<OcclusionCuller::OccluderMesh> occluders;
+        if (options.occlusion)
+        {
+            OcclusionCuller::BuildOccluders(model, occluders);
+        }
+
+        double baseline = 0.;
+        for (auto threads : GetBenchmarkThreadCounts(maxThreads))
+        {
+            TaskPool pool(threads);
+            SoftwareRasterizer rasterizer(options.width, options.height, &pool);
+            rasterizer.SetColorFormat(GetHdrFormat(options.hdrFormat));
+
+            OcclusionCuller occlusion(OcclusionCuller::DefaultWidth, OcclusionCuller::DefaultWidth, &pool);
+            occlusion.SetSizeForViewport(options.width, options.height);
+            OcclusionCuller* culler = options.occlusion ? &occlusion : nullptr;
+
+            // One untimed pass to warm up caches and allocations.
+            for (auto view : views)
+            {
+                RenderHeadlessView(rasterizer, model, view, options.grid, options.lhcoords, &options.sections, culler, &occluders, options.transparency);
+            }
+            rasterizer.ResetStatistics();
+
+            auto const start = clock::now();
+
+            for (uint32_t i = 0; i < options.benchmark; ++i)
+            {
+                for (auto view : views)
+                {
+                    RenderHeadlessView(rasterizer, model, view, options.grid, options.lhcoords, &options.sections, culler, &occluders, options.transparency);
+                }
+            }
+
+            const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+            const double frames = double(options.benchmark) * double(views.size());
+            const auto stats = rasterizer.GetStatistics();
+
+            const double mtris = (seconds > 0.) ? double(stats.triangles) / seconds / 1000000.0 : 0.;
+            if (baseline <= 0.)
+            {
+                baseline = mtris;
+            }
+
+            const BenchmarkReport::ThreadResult result = { threads, seconds * 1000.0 / frames, mtris, (baseline > 0.) ? mtris / baseline : 0. };
+            results.push_back(result);
+
+            log << "  " << std::setw(3) << threads << " threads: "
+                << std::fixed << std::setprecision(2) << result.msPerFrame << " ms/frame, "
+                << mtris << " Mtri/s, "
+                << result.scaling << "x scaling, "
+                << std::setprecision(0) << (double(stats.blocksCulled) / frames) << " blocks culled/frame" << std::endl;
+        }
+
+        return results;
+    }
+}
+
+int DX::RunBenchmark(const HeadlessOptions& options, const std::vector<HeadlessView>& views, std::ostream& log)
+{
+    TaskPool pool(options.threads);
+
+    BenchmarkReport report;
+    report.width = options.width;
+    report.height = options.height;
+    report.views = views.size();
+    report.iterations = options.benchmark;
+    report.maxThreads = pool.GetThreadCount();
+    report.hardwareThreads = std::thread::hardware_concurrency();
+
+    if (!options.models.empty())
+    {
+        log << "Benchmark: " << options.width << "x" << options.height << ", " << views.size() << " views, "
+            << options.benchmark << " iterations, up to " << pool.GetThreadCount() << " threads" << std::endl;
+    }
+
+    size_t failed = 0;
+    for (auto const& fileName : options.models)
+    {
+        BenchmarkReport::Model result;
+        result.file = Narrow(fileName);
+
+        try
+        {
+            const std::wstring ext = GetExtension(fileName);
+            if (!ModelData::IsSupportedExtension(ext.c_str()))
+                throw std::runtime_error("Unknown file type");
+
+            std::vector<uint8_t> blob;
+            std::unique_ptr<ModelData> model;
+            BoundingSphere sphere;
+            BoundingBox box;
+
+            const auto read = TimeStage(options.benchmark, [&]() { blob = ReadData(fileName.c_str()); });
+            const auto parse = TimeStage(options.benchmark, [&]()
+            {
+                model = ModelData::CreateFromMemory(blob.data(), blob.size(), ext.c_str(), options.lhcoords);
+            });
+            const auto stats = TimeStage(options.benchmark, [&]()
+            {
+                result.statistics = ModelData::ReadStatistics(blob.data(), blob.size(), ext.c_str());
+            });
+            const auto bounds = TimeStage(options.benchmark, [&]() { model->GetBounds(sphere, box); });
+
+            result.stages = { { "read", read }, { "parse", parse }, { "stats", stats }, { "bounds", bounds } };
+
+            // Each stage describes itself after the summary of every stage's time.
+            std::ostringstream details;
+            BenchmarkFrameHierarchy(*model, options.benchmark, pool, result, details);
+            BenchmarkPicking(*model, options.benchmark, options.lhcoords, result, details);
+            BenchmarkSectionPlanes(*model, options.benchmark, result, details);
+            BenchmarkOcclusion(*model, options, pool, result, details);
+
+            result.fileBytes = blob.size();
+            result.frames = model->frames.size();
+            for (auto const& vb : model->vertexBuffers)
+            {
+                result.vertexBytes += uint64_t(vb.vertexCount) * vb.stride;
+            }
+            for (auto const& ib : model->indexBuffers)
+            {
+                result.indexBytes += uint64_t(ib.indices.size()) * ib.indexSize;
+            }
+
+            log << result.file << ": " << result.statistics.triangles << " triangles" << std::endl
+                << "  load stages (ms):";
+            for (auto const& stage : result.stages)
+            {
+                log << " " << stage.name << " " << std::fixed << std::setprecision(3) << stage.timing.meanMs;
+            }
+            log << std::endl << details.str();
+
+            result.draw = BenchmarkModel(*model, options, views, pool.GetThreadCount(), log);
+        }
+        catch (const std::exception& e)
+        {
+            ++failed;
+            result.error = e.what();
+            log << "ERROR: " << result.file << ": " << e.what() << std::endl;
+        }
+
+        report.models.push_back(std::move(result));
+    }
+
+    if (!options.models.empty())
+    {
+        log << (options.models.size() - failed) << " of " << options.models.size() << " models benchmarked" << std::endl;
+    }
+
+    report.toneMaps = BenchmarkToneMap(options.benchmark, pool.GetThreadCount(), log);
+    report.profiler = BenchmarkProfiler(log);
+    report.frameHistory = BenchmarkFrameHistory(log);
+    report.transparencySort = BenchmarkTransparencySort(options.benchmark, log);
+
+    if (!options.jsonFile.empty())
+    {
+        std::ostringstream json;
+        report.WriteJSON(json);
+
+        const std::string text = json.str();
+        WriteData(options.jsonFile.c_str(), text.data(), text.size());
+
+        log << "Results written to " << Narrow(options.jsonFile) << std::endl;
+    }
+
+    return failed ? 1 : 0;
+}
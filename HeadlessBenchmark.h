@@ -0,0 +1,113 @@
+//--------------------------------------------------------------------------------------
+// File: HeadlessBenchmark.h
+//
+// Benchmark mode of the headless renderer. RunBenchmark times loading and drawing each
+// model, then runs the stages that need no model; each stage lives next to the module it
+// measures, in <Module>Benchmark.cpp.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "BenchmarkReport.h"
+#include "HeadlessRenderer.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+
+namespace DX
+{
+    // Each model in options.models is loaded and its load stages timed, then every view
+    // is rendered options.benchmark times at 1, 2, 4, ... threads up to options.threads,
+    // followed by the model-independent stages below. Results are written as JSON to
+    // options.jsonFile if given. Returns 0 if every model loaded, 1 otherwise.
+    int RunBenchmark(const HeadlessOptions& options, const std::vector<HeadlessView>& views, std::ostream& log);
+
+    // Per-model stages. Each appends its timings to result.stages, describes what it
+    // measured in 'log', and throws if its fast path disagrees with the reference one.
+
+    // FrameHierarchyBenchmark.cpp: the linked-list traversal of ModelData, then building
+    // the flattened hierarchy and updating it on one thread, on the pool, and after one
+    // frame halfway through the file changes.
+    void BenchmarkFrameHierarchy(const ModelData& model, uint32_t iterations, TaskPool& pool,
+        BenchmarkReport::Model& result, std::ostream& log);
+
+    // ModelPickerBenchmark.cpp: building the picking hierarchy, then casting a grid of
+    // rays through the front view, checked against testing every triangle.
+    void BenchmarkPicking(const ModelData& model, uint32_t iterations, bool lhcoords,
+        BenchmarkReport::Model& result, std::ostream& log);
+
+    // SectionPlanesBenchmark.cpp: classifying every mesh against a box around the middle
+    // of the model, checked against testing one box at a time.
+    void BenchmarkSectionPlanes(const ModelData& model, uint32_t iterations,
+        BenchmarkReport::Model& result, std::ostream& log);
+
+    // OcclusionCullerBenchmark.cpp: the meshes hidden behind others in the side view,
+    // checked by drawing the view with and without them and comparing the images.
+    void BenchmarkOcclusion(const ModelData& model, const HeadlessOptions& options, TaskPool& pool,
+        BenchmarkReport::Model& result, std::ostream& log);
+
+    // Stages that need no model.
+
+    // SoftwareToneMapBenchmark.cpp: a synthetic 4K HDR image with every operator and
+    // transfer function, each into the swap chain format the viewer uses with it, at 1,
+    // 2, 4, ... threads up to 'maxThreads'.
+    std::vector<BenchmarkReport::ToneMap> BenchmarkToneMap(uint32_t iterations, size_t maxThreads, std::ostream& log);
+
+    // TransparencySorterBenchmark.cpp: ordering the view depths of many alpha parts, spread
+    // over a scene as a model's might be, with TransparencySorter and with std::stable_sort,
+    // checked to agree to within the sorter's depth quantum.
+    BenchmarkReport::TransparencySort BenchmarkTransparencySort(uint32_t iterations, std::ostream& log);
+
+    // FrameProfilerBenchmark.cpp: the cost of a FrameProfiler scope with no capture
+    // running, as in every frame the viewer draws, and while capturing.
+    BenchmarkReport::Profiler BenchmarkProfiler(std::ostream& log);
+
+    // FrameStatisticsBenchmark.cpp: recording a frame time, as StepTimer does every
+    // frame, and computing the HUD's statistics over a full history.
+    BenchmarkReport::FrameHistory BenchmarkFrameHistory(std::ostream& log);
+
+    // 1, 2, 4, ... up to and including 'maxThreads'.
+    inline std::vector<size_t> GetBenchmarkThreadCounts(size_t maxThreads)
+    {
+        std::vector<size_t> threadCounts;
+        for (size_t threads = 1; threads < maxThreads; threads *= 2)
+        {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(maxThreads);
+        return threadCounts;
+    }
+
+    // Runs 'fn' the given number of times after one untimed call.
+    template<typename F>
+    BenchmarkReport::Timing TimeStage(uint32_t iterations, F&& fn)
+    {
+        using clock = std::chrono::steady_clock;
+        using ms = std::chrono::duration<double, std::milli>;
+
+        fn();
+
+        BenchmarkReport::Timing timing = { 0., 0. };
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            auto const start = clock::now();
+            fn();
+            const double elapsed = ms(clock::now() - start).count();
+
+            timing.meanMs += elapsed;
+            timing.minMs = (i > 0) ? std::min(timing.minMs, elapsed) : elapsed;
+        }
+
+        timing.meanMs /= double(std::max(iterations, 1u));
+        return timing;
+    }
+}
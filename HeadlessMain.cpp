@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------------------
+// File: HeadlessMain.cpp
+//
+// Entry point for the command-line headless renderer on non-Windows platforms. On
+// Windows the same mode is reached with the viewer's -headless switch (see Main.cpp).
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#ifndef _WIN32
+
+#include "HeadlessRenderer.h"
+
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    std::setlocale(LC_ALL, "");
+
+    DX::HeadlessOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::wstring arg(strlen(argv[i]), L'\0');
+        const size_t len = mbstowcs(&arg[0], argv[i], arg.size());
+        if (len == static_cast<size_t>(-1))
+        {
+            std::cerr << "ERROR: Invalid argument encoding: " << argv[i] << std::endl;
+            return 1;
+        }
+        arg.resize(len);
+
+        // Accepted for command lines shared with the Windows build.
+        if (arg == L"-headless")
+            continue;
+
+        if (!DX::ParseHeadlessArgument(arg.c_str(), options))
+        {
+            std::cerr << "ERROR: Invalid argument: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    return DX::RunHeadless(options, std::cout);
+}
+
+#endif
@@ -0,0 +1,863 @@
+//--------------------------------------------------------------------------------------
+// File: HeadlessRenderer.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "HeadlessRenderer.h"
+#include "HeadlessBenchmark.h"
+#include "ImageCompare.h"
+#include "ModelGenerator.h"
+#include "ModelInspector.h"
+#include "ResidencySimulator.h"
+#include "ReadData.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+namespace
+{
+    // Defaults from BasicEffect::EnableDefaultLighting.
+    constexpr XMVECTORF32 c_LightDirections[3] =
+    {
+        { { { -0.5265408f, -0.5735765f, -0.6275069f, 0.f } } },
+        { { {  0.7198464f,  0.3420201f,  0.6040227f, 0.f } } },
+        { { {  0.4545195f, -0.7660444f,  0.4545195f, 0.f } } },
+    };
+
+    constexpr XMVECTORF32 c_LightDiffuse[3] =
+    {
+        { { { 1.0000000f, 0.9607844f, 0.8078432f, 0.f } } },
+        { { { 0.9647059f, 0.7607844f, 0.4078432f, 0.f } } },
+        { { { 0.3231373f, 0.3607844f, 0.3937255f, 0.f } } },
+    };
+
+    constexpr XMVECTORF32 c_AmbientLight = { { { 0.05333332f, 0.09882354f, 0.1819608f, 0.f } } };
+
+    // Game::m_uiColor, used for the grid.
+    constexpr XMFLOAT4 c_GridColor(1.f, 1.f, 0.f, 1.f);
+
+    constexpr size_t c_GridDivs = 20;
+
+    constexpr size_t c_VertexGrain = 1024;
+
+    std::string Narrow(const std::wstring& str)
+    {
+    #ifdef _WIN32
+        if (str.empty())
+            return std::string();
+
+        const int len = WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0, nullptr, nullptr);
+        std::string result(static_cast<size_t>(std::max(len, 0)), '\0');
+        if (len > 0)
+        {
+            WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &result[0], len, nullptr, nullptr);
+        }
+        return result;
+    #else
+        return FileName(str.c_str());
+    #endif
+    }
+
+    std::wstring GetExtension(const std::wstring& path)
+    {
+        const size_t dot = path.find_last_of(L'.');
+        const size_t slash = path.find_last_of(L"\\/");
+        if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash))
+            return std::wstring();
+
+        return path.substr(dot);
+    }
+
+    std::wstring GetBaseName(const std::wstring& path)
+    {
+        const size_t slash = path.find_last_of(L"\\/");
+        std::wstring name = (slash == std::wstring::npos) ? path : path.substr(slash + 1);
+
+        const size_t dot = name.find_last_of(L'.');
+        if (dot != std::wstring::npos)
+        {
+            name.resize(dot);
+        }
+        return name;
+    }
+
+    void CreateOutputDirectory(const std::wstring& path)
+    {
+        if (path.empty())
+            return;
+
+    #ifdef _WIN32
+        std::ignore = CreateDirectoryW(path.c_str(), nullptr);
+    #else
+        std::ignore = mkdir(FileName(path.c_str()).c_str(), 0755);
+    #endif
+    }
+
+    XMVECTOR GetViewRotation(HeadlessView view) noexcept
+    {
+        switch (view)
+        {
+        case HeadlessView::Side:    return XMQuaternionRotationRollPitchYaw(0.f, XM_PIDIV2, 0.f);
+        case HeadlessView::Top:     return XMQuaternionRotationRollPitchYaw(XM_PIDIV2, 0.f, 0.f);
+        case HeadlessView::Iso:     return XMQuaternionRotationRollPitchYaw(0.6154797f, -XM_PIDIV4, 0.f);
+        default:                    return XMQuaternionIdentity();
+        }
+    }
+
+    // Per-vertex lighting equivalent to BasicEffect with default lighting and vertex color.
+    // The result is premultiplied by alpha.
+    XMFLOAT4 ShadeVertex(const ModelData::Material* material, const XMFLOAT3* normal, uint32_t vertexColor) noexcept
+    {
+        XMVECTOR diffuse = material ? XMLoadFloat4(&material->diffuse) : XMVectorSplatOne();
+        const XMVECTOR emissive = material ? XMLoadFloat3(&material->emissive) : XMVectorZero();
+        const float alpha = XMVectorGetW(diffuse);
+
+        XMVECTOR color;
+        if (normal)
+        {
+            const XMVECTOR n = XMVector3Normalize(XMLoadFloat3(normal));
+
+            XMVECTOR light = c_AmbientLight;
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const XMVECTOR dot = XMVectorMax(XMVector3Dot(n, XMVectorNegate(c_LightDirections[j])), XMVectorZero());
+                light = XMVectorMultiplyAdd(dot, c_LightDiffuse[j], light);
+            }
+
+            color = XMVectorMultiplyAdd(diffuse, light, emissive);
+        }
+        else
+        {
+            color = XMVectorAdd(diffuse, emissive);
+        }
+
+        color = XMVectorSetW(XMVectorScale(color, alpha), alpha);
+
+        if (vertexColor != UINT32_MAX)
+        {
+            const XMVECTOR vc = XMVectorSet(
+                float(vertexColor & 0xFF) / 255.f,
+                float((vertexColor >> 8) & 0xFF) / 255.f,
+                float((vertexColor >> 16) & 0xFF) / 255.f,
+                float(vertexColor >> 24) / 255.f);
+            color = XMVectorMultiply(color, vc);
+        }
+
+        XMFLOAT4 result;
+        XMStoreFloat4(&result, color);
+        return result;
+    }
+
+    void DrawGrid(SoftwareRasterizer& rasterizer, FXMMATRIX viewProj, float scale)
+    {
+        std::vector<SoftwareRasterizer::Vertex> vertices;
+        vertices.reserve((c_GridDivs + 1) * 4);
+
+        auto add = [&](float x, float z)
+        {
+            SoftwareRasterizer::Vertex v;
+            XMStoreFloat4(&v.position, XMVector3Transform(XMVectorSet(x, 0.f, z, 1.f), viewProj));
+            v.color = c_GridColor;
+            vertices.push_back(v);
+        };
+
+        for (size_t i = 0; i <= c_GridDivs; ++i)
+        {
+            const float percent = (float(i) / float(c_GridDivs)) * 2.f - 1.f;
+            add(scale * percent, -scale);
+            add(scale * percent, scale);
+            add(-scale, scale * percent);
+            add(scale, scale * percent);
+        }
+
+        // Same state as Game::DrawGrid: opaque, depth read only.
+        rasterizer.SetBlendMode(SoftwareRasterizer::BlendMode::Opaque);
+        rasterizer.SetDepthWrite(false);
+        rasterizer.SetCullMode(SoftwareRasterizer::CullMode::CounterClockwise);
+        rasterizer.Draw(vertices.data(), vertices.size(), SoftwareRasterizer::Topology::LineList);
+    }
+
+    const ModelData::Material* GetMaterial(const ModelData& model, const ModelData::Part& part) noexcept
+    {
+        return (part.material < model.materials.size()) ? &model.materials[part.material] : nullptr;
+    }
+
+    bool IsAlphaPart(const ModelData& model, const ModelData::Part& part) noexcept
+    {
+        auto material = GetMaterial(model, part);
+        return material && material->isAlpha;
+    }
+
+    // Sets the clipping and culling of one mesh; 'clipPlanes' apply if 'sections' marks it
+    // Clipped. Returns false if it is marked Outside.
+    bool SetMeshState(SoftwareRasterizer& rasterizer, const ModelData& model, size_t m,
+        const SectionPlanes::Result* sections, const XMFLOAT4* clipPlanes, size_t clipPlaneCount)
+    {
+        if (sections)
+        {
+            if (sections[m] == SectionPlanes::Result::Outside)
+                return false;
+
+            rasterizer.SetClipPlanes(clipPlanes, (sections[m] == SectionPlanes::Result::Clipped) ? clipPlaneCount : 0);
+        }
+
+        rasterizer.SetCullMode(model.meshes[m].ccw ? SoftwareRasterizer::CullMode::CounterClockwise : SoftwareRasterizer::CullMode::Clockwise);
+        return true;
+    }
+
+    // Transforms and shades the vertices the part references, then draws it.
+    void DrawPart(SoftwareRasterizer& rasterizer, const ModelData& model, const ModelData::Part& part, FXMMATRIX viewProj,
+        std::vector<SoftwareRasterizer::Vertex>& vertices)
+    {
+        const ModelData::Material* material = GetMaterial(model, part);
+
+        SoftwareRasterizer::Topology topology;
+        switch (part.primitive)
+        {
+        case ModelData::Primitive::TriangleList:    topology = SoftwareRasterizer::Topology::TriangleList; break;
+        case ModelData::Primitive::TriangleStrip:   topology = SoftwareRasterizer::Topology::TriangleStrip; break;
+        case ModelData::Primitive::LineList:        topology = SoftwareRasterizer::Topology::LineList; break;
+        case ModelData::Primitive::LineStrip:       topology = SoftwareRasterizer::Topology::LineStrip; break;
+        default:                                    return;
+        }
+
+        if (!part.indexCount
+            || part.vertexBuffer >= model.vertexBuffers.size()
+            || part.indexBuffer >= model.indexBuffers.size())
+            return;
+
+        auto const& vb = model.vertexBuffers[part.vertexBuffer];
+        auto const& ib = model.indexBuffers[part.indexBuffer];
+        if (vb.positions.empty())
+            return;
+
+        // Only the vertices this part references are transformed.
+        vertices.resize(part.vertexCount);
+
+        auto shade = [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t j = begin; j < end; ++j)
+            {
+                const size_t index = size_t(part.vertexStart) + j;
+
+                auto& v = vertices[j];
+                XMStoreFloat4(&v.position, XMVector3Transform(XMLoadFloat3(&vb.positions[index]), viewProj));
+                v.color = ShadeVertex(material,
+                    vb.normals.empty() ? nullptr : &vb.normals[index],
+                    vb.colors.empty() ? UINT32_MAX : vb.colors[index]);
+            }
+        };
+
+        if (auto pool = rasterizer.GetTaskPool())
+        {
+            pool->ParallelFor(part.vertexCount, c_VertexGrain, shade);
+        }
+        else
+        {
+            shade(0, part.vertexCount, 0);
+        }
+
+        rasterizer.DrawIndexed(vertices.data(), vertices.size(),
+            ib.indices.data() + part.startIndex, part.indexCount,
+            part.vertexOffset - static_cast<int32_t>(part.vertexStart), topology);
+    }
+
+    // 'clipPlanes' apply to the meshes 'sections' marks as Clipped; either may be null to
+    // draw every mesh unclipped.
+    void DrawModel(SoftwareRasterizer& rasterizer, const ModelData& model, FXMMATRIX viewProj, bool alpha,
+        const SectionPlanes::Result* sections = nullptr, const XMFLOAT4* clipPlanes = nullptr, size_t clipPlaneCount = 0,
+        SoftwareRasterizer::BlendMode alphaBlend = SoftwareRasterizer::BlendMode::AlphaBlend)
+    {
+        // As Model::Draw, alpha parts are drawn after the opaque ones without depth writes.
+        rasterizer.SetBlendMode(alpha ? alphaBlend : SoftwareRasterizer::BlendMode::Opaque);
+        rasterizer.SetDepthWrite(!alpha);
+
+        std::vector<SoftwareRasterizer::Vertex> vertices;
+
+        for (size_t m = 0; m < model.meshes.size(); ++m)
+        {
+            if (!SetMeshState(rasterizer, model, m, sections, clipPlanes, clipPlaneCount))
+                continue;
+
+            for (auto const& part : model.meshes[m].parts)
+            {
+                if (IsAlphaPart(model, part) == alpha)
+                {
+                    DrawPart(rasterizer, model, part, viewProj, vertices);
+                }
+            }
+        }
+
+        rasterizer.SetClipPlanes(nullptr, 0);
+    }
+
+    // The alpha parts of DrawModel in back-to-front order of the centers of the vertices
+    // each references.
+    void DrawSortedAlphaParts(SoftwareRasterizer& rasterizer, const ModelData& model, FXMMATRIX viewProj,
+        const SectionPlanes::Result* sections, const XMFLOAT4* clipPlanes, size_t clipPlaneCount)
+    {
+        struct AlphaPart
+        {
+            size_t                      mesh;
+            const ModelData::Part*      part;
+        };
+
+        std::vector<AlphaPart> parts;
+        std::vector<float> depths;
+        for (size_t m = 0; m < model.meshes.size(); ++m)
+        {
+            if (sections && sections[m] == SectionPlanes::Result::Outside)
+                continue;
+
+            for (auto const& part : model.meshes[m].parts)
+            {
+                if (!IsAlphaPart(model, part))
+                    continue;
+
+                // Clip-space w is the view depth.
+                float depth = NAN;
+                if (part.vertexBuffer < model.vertexBuffers.size() && part.vertexCount > 0)
+                {
+                    auto const& positions = model.vertexBuffers[part.vertexBuffer].positions;
+                    if (size_t(part.vertexStart) + part.vertexCount <= positions.size())
+                    {
+                        BoundingBox box;
+                        BoundingBox::CreateFromPoints(box, part.vertexCount, &positions[part.vertexStart], sizeof(XMFLOAT3));
+                        depth = XMVectorGetW(XMVector3Transform(XMLoadFloat3(&box.Center), viewProj));
+                    }
+                }
+
+                parts.push_back({ m, &part });
+                depths.push_back(depth);
+            }
+        }
+
+        TransparencySorter sorter;
+        auto const& order = sorter.Sort(depths.data(), depths.size());
+
+        rasterizer.SetBlendMode(SoftwareRasterizer::BlendMode::AlphaBlend);
+        rasterizer.SetDepthWrite(false);
+
+        std::vector<SoftwareRasterizer::Vertex> vertices;
+        for (const uint32_t j : order)
+        {
+            SetMeshState(rasterizer, model, parts[j].mesh, sections, clipPlanes, clipPlaneCount);
+            DrawPart(rasterizer, model, *parts[j].part, viewProj, vertices);
+        }
+
+        rasterizer.SetClipPlanes(nullptr, 0);
+    }
+
+    // Tone-maps into the viewer's B8G8R8A8_UNORM swap chain format.
+    BitmapImage ToneMapImage(const SoftwareRasterizer& rasterizer, const SoftwareToneMap& toneMap)
+    {
+        BitmapImage image(rasterizer.GetWidth(), rasterizer.GetHeight());
+        toneMap.Process(rasterizer.GetColorBuffer(), rasterizer.GetRowPitch(), image.pixels.data(), image.width,
+            image.width, image.height, rasterizer.GetTaskPool());
+        return image;
+    }
+
+    std::wstring WithTrailingSlash(const std::wstring& path)
+    {
+        std::wstring result = path;
+        if (!result.empty() && result.back() != L'\\' && result.back() != L'/')
+        {
+            result += L'/';
+        }
+        return result;
+    }
+
+    // Milliseconds spent on each stage of one or more models.
+    struct HeadlessTimings
+    {
+        double  load;
+        double  render;
+        double  compare;
+    };
+
+    enum class HeadlessResult
+    {
+        Passed,
+        Mismatch,   // Rendered, but some view differs from its golden image
+        Failed,
+    };
+
+    // Rendering state for one model at a time; RunHeadless runs one per job.
+    class HeadlessJob
+    {
+    public:
+        HeadlessJob(const HeadlessOptions& options, size_t threads) :
+            m_options(options),
+            m_pool(threads),
+            m_rasterizer(options.width, options.height, &m_pool),
+            m_occlusion(OcclusionCuller::DefaultWidth, OcclusionCuller::DefaultWidth, &m_pool),
+            m_histogram{}
+        {
+            m_occlusion.SetSizeForViewport(options.width, options.height);
+            m_rasterizer.SetColorFormat(GetHdrFormat(options.hdrFormat));
+
+            // Matches Game::ToneMapAndPresent for an SDR display.
+            m_toneMap.SetOperator(options.toneMapOperator);
+            m_toneMap.SetTransferFunction(SoftwareToneMap::SRGB);
+            m_toneMap.SetExposure(options.exposure);
+        }
+
+        HeadlessResult Render(const std::wstring& fileName, const std::vector<HeadlessView>& views,
+            const std::wstring& outDir, const std::wstring& goldenDir, HeadlessTimings& timings, std::ostream& log)
+        {
+            using clock = std::chrono::steady_clock;
+            using ms = std::chrono::duration<double, std::milli>;
+
+            try
+            {
+                auto const start = clock::now();
+
+                const std::wstring ext = GetExtension(fileName);
+                if (!ModelData::IsSupportedExtension(ext.c_str()))
+                    throw std::runtime_error("Unknown file type");
+
+                auto const blob = ReadData(fileName.c_str());
+                auto const model = ModelData::CreateFromMemory(blob.data(), blob.size(), ext.c_str(), m_options.lhcoords);
+
+                std::vector<OcclusionCuller::OccluderMesh> occluders;
+                if (m_options.occlusion)
+                {
+                    OcclusionCuller::BuildOccluders(*model, occluders);
+                }
+                OcclusionCuller* occlusion = m_options.occlusion ? &m_occlusion : nullptr;
+
+                timings.load = ms(clock::now() - start).count();
+
+                std::ostringstream mismatches;
+                size_t matched = 0;
+                size_t occluded = 0;
+
+                const std::wstring baseName = GetBaseName(fileName);
+                for (auto view : views)
+                {
+                    auto const renderStart = clock::now();
+
+                    RenderHeadlessView(m_rasterizer, *model, view, m_options.grid, m_options.lhcoords, &m_options.sections, occlusion, &occluders, m_options.transparency);
+                    occluded += m_occlusion.GetStatistics().occluded;
+
+                    if (m_options.autoExposure)
+                    {
+                        // A single image has nothing to adapt from, so use the target directly.
+                        m_autoExposure.BuildHistogram(m_rasterizer.GetColorBuffer(), m_rasterizer.GetRowPitch(),
+                            m_rasterizer.GetWidth(), m_rasterizer.GetHeight(), m_histogram, &m_pool);
+                        m_toneMap.SetExposure(m_autoExposure.ComputeTargetExposure(m_histogram));
+                    }
+
+                    const std::wstring viewName = baseName + L"_" + GetHeadlessViewName(view);
+                    const BitmapImage image = ToneMapImage(m_rasterizer, m_toneMap);
+                    WriteBMP((outDir + viewName + L".bmp").c_str(), image);
+
+                    auto const renderEnd = clock::now();
+                    timings.render += ms(renderEnd - renderStart).count();
+
+                    if (goldenDir.empty())
+                        continue;
+
+                    if (Compare(image, goldenDir + viewName + L".bmp", outDir + viewName + L"_diff.bmp", mismatches))
+                    {
+                        ++matched;
+                    }
+
+                    timings.compare += ms(clock::now() - renderEnd).count();
+                }
+
+                log << Narrow(fileName)
+                    << ": " << model->GetTriangleCount() << " triangles, load "
+                    << std::fixed << std::setprecision(2) << timings.load << " ms, render "
+                    << timings.render << " ms";
+
+                if (occlusion)
+                {
+                    log << ", " << occluded << " of " << model->meshes.size() * views.size() << " meshes occluded";
+                }
+
+                if (!goldenDir.empty())
+                {
+                    log << ", compare " << timings.compare << " ms, "
+                        << matched << " of " << views.size() << " views match";
+                }
+
+                log << std::endl << mismatches.str();
+
+                return (matched < views.size() && !goldenDir.empty()) ? HeadlessResult::Mismatch : HeadlessResult::Passed;
+            }
+            catch (const std::exception& e)
+            {
+                log << "ERROR: " << Narrow(fileName) << ": " << e.what() << std::endl;
+                return HeadlessResult::Failed;
+            }
+        }
+
+    private:
+        // Returns true if the image matches its golden image; otherwise reports why and
+        // writes a diff image when the sizes agree.
+        bool Compare(const BitmapImage& image, const std::wstring& goldenName, const std::wstring& diffName, std::ostream& log)
+        {
+            BitmapImage golden;
+            try
+            {
+                golden = ReadBMP(goldenName.c_str());
+            }
+            catch (const std::exception& e)
+            {
+                log << "  MISSING: " << Narrow(goldenName) << ": " << e.what() << std::endl;
+                return false;
+            }
+
+            if (golden.width != image.width || golden.height != image.height)
+            {
+                log << "  MISMATCH: " << Narrow(goldenName) << " is " << golden.width << "x" << golden.height
+                    << ", rendered " << image.width << "x" << image.height << std::endl;
+                return false;
+            }
+
+            BitmapImage diff;
+            const ImageComparison result = CompareImages(golden, image, m_options.tolerance, &diff, &m_pool);
+            if (result.Passes(m_options.tolerance))
+                return true;
+
+            WriteBMP(diffName.c_str(), diff);
+
+            log << "  MISMATCH: " << Narrow(goldenName) << ": SSIM " << std::fixed << std::setprecision(4) << result.ssim
+                << ", " << std::setprecision(2) << (result.differingPixels * 100.) << "% of pixels differ (max "
+                << result.maxDifference << "), see " << Narrow(diffName) << std::endl;
+            return false;
+        }
+
+        const HeadlessOptions&  m_options;
+        TaskPool                m_pool;
+        SoftwareRasterizer      m_rasterizer;
+        OcclusionCuller         m_occlusion;
+        SoftwareToneMap         m_toneMap;
+        AutoExposure            m_autoExposure;
+        LuminanceHistogram      m_histogram;
+    };
+
+    // Writes the synthetic corpus to 'directory' and appends the files to 'models'.
+    void GenerateCorpus(const std::wstring& directory, std::vector<std::wstring>& models, std::ostream& log)
+    {
+        CreateOutputDirectory(directory);
+        const std::wstring prefix = WithTrailingSlash(directory);
+
+        for (auto const& item : GetSyntheticCorpus())
+        {
+            const std::wstring fileName = prefix + item.name;
+            auto const file = GenerateModel(item.desc);
+            WriteData(fileName.c_str(), file.data(), file.size());
+
+            models.push_back(fileName);
+        }
+
+        log << "Generated " << GetSyntheticCorpus().size() << " models in " << Narrow(directory) << std::endl;
+    }
+
+    // Writes every view of every model as a bitmap, comparing each with its golden image
+    // if given.
+    int RenderModels(const HeadlessOptions& options, const std::vector<HeadlessView>& views, std::ostream& log)
+    {
+        const std::wstring outDir = WithTrailingSlash(options.outputDirectory);
+        const std::wstring goldenDir = options.goldenDirectory.empty() ? std::wstring() : WithTrailingSlash(options.goldenDirectory);
+        CreateOutputDirectory(options.outputDirectory);
+
+        // Each job renders one model at a time with its own share of the threads.
+        const size_t jobs = std::max<size_t>(1, std::min<size_t>(options.jobs, options.models.size()));
+        size_t threads = options.threads;
+        if (!threads)
+        {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        const size_t threadsPerJob = std::max<size_t>(1, threads / jobs);
+
+        using clock = std::chrono::steady_clock;
+        auto const start = clock::now();
+
+        std::mutex mutex;
+        std::atomic<size_t> next(0);
+        HeadlessTimings totals = {};
+        size_t failed = 0;
+        size_t mismatched = 0;
+
+        auto runJob = [&]()
+        {
+            HeadlessJob job(options, threadsPerJob);
+
+            for (size_t index = next++; index < options.models.size(); index = next++)
+            {
+                std::ostringstream report;
+                HeadlessTimings timings = {};
+                const HeadlessResult result = job.Render(options.models[index], views, outDir, goldenDir, timings, report);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                log << report.str() << std::flush;
+
+                totals.load += timings.load;
+                totals.render += timings.render;
+                totals.compare += timings.compare;
+
+                if (result == HeadlessResult::Failed)
+                    ++failed;
+                else if (result == HeadlessResult::Mismatch)
+                    ++mismatched;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(jobs - 1);
+        for (size_t j = 1; j < jobs; ++j)
+        {
+            workers.emplace_back(runJob);
+        }
+
+        runJob();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        using ms = std::chrono::duration<double, std::milli>;
+
+        log << (options.models.size() - failed) << " of " << options.models.size() << " models rendered" << std::endl;
+
+        if (!goldenDir.empty())
+        {
+            log << (options.models.size() - failed - mismatched) << " of " << options.models.size() << " models match the golden images" << std::endl;
+        }
+
+        log << "Total: load " << std::fixed << std::setprecision(2) << totals.load << " ms, render " << totals.render << " ms";
+        if (!goldenDir.empty())
+        {
+            log << ", compare " << totals.compare << " ms";
+        }
+        log << ", elapsed " << ms(clock::now() - start).count() << " ms (" << jobs << " jobs x " << threadsPerJob << " threads)" << std::endl;
+
+        return (failed || mismatched) ? 1 : 0;
+    }
+}
+
+float XM_CALLCONV DX::GetHeadlessViewMatrices(const ModelData& model, HeadlessView view, float aspect, bool lhcoords,
+    XMMATRIX& viewMatrix, XMMATRIX& projMatrix) noexcept
+{
+    XMFLOAT3 focus(0.f, 0.f, 0.f);
+    float distance = 10.f;
+    float gridScale = 1.f;
+
+    if (!model.meshes.empty())
+    {
+        BoundingSphere sphere;
+        BoundingBox box;
+        model.GetBounds(sphere, box);
+
+        if (sphere.Radius < 1.f)
+        {
+            sphere.Center = box.Center;
+            sphere.Radius = std::max(box.Extents.x, std::max(box.Extents.y, box.Extents.z));
+        }
+
+        if (sphere.Radius < 1.f)
+        {
+            sphere.Center = XMFLOAT3(0.f, 0.f, 0.f);
+            sphere.Radius = 10.f;
+        }
+
+        gridScale = sphere.Radius;
+        distance = sphere.Radius * 2.f;
+        focus = sphere.Center;
+    }
+
+    const XMVECTOR rotation = GetViewRotation(view);
+    const XMVECTOR dir = XMVector3Rotate(XMVectorSet(0.f, 0.f, lhcoords ? -1.f : 1.f, 0.f), rotation);
+    const XMVECTOR up = XMVector3Rotate(XMVectorSet(0.f, 1.f, 0.f, 0.f), rotation);
+
+    const XMVECTOR target = XMLoadFloat3(&focus);
+    const XMVECTOR eye = XMVectorMultiplyAdd(XMVectorReplicate(distance), dir, target);
+
+    constexpr float c_FarPlane = 10000.f;
+
+    viewMatrix = lhcoords ? XMMatrixLookAtLH(eye, target, up) : XMMatrixLookAtRH(eye, target, up);
+    projMatrix = lhcoords ? XMMatrixPerspectiveFovLH(XM_PIDIV4, aspect, 0.1f, c_FarPlane)
+        : XMMatrixPerspectiveFovRH(XM_PIDIV4, aspect, 0.1f, c_FarPlane);
+
+    return gridScale;
+}
+
+size_t XM_CALLCONV DX::CullOccludedMeshes(OcclusionCuller& occlusion, const ModelData& model,
+    const std::vector<OcclusionCuller::OccluderMesh>& occluders, FXMMATRIX viewProj, SectionPlanes::Result* results)
+{
+    if (occluders.size() != model.meshes.size())
+        throw std::invalid_argument("Occluders don't match the model");
+
+    std::vector<OcclusionCuller::Occluder> drawn;
+    drawn.reserve(occluders.size());
+    for (size_t m = 0; m < occluders.size(); ++m)
+    {
+        if (results[m] != SectionPlanes::Result::Inside)
+            continue;
+
+        OcclusionCuller::Occluder occluder = { &occluders[m], {},
+            model.meshes[m].ccw ? OcclusionCuller::CullMode::CounterClockwise : OcclusionCuller::CullMode::Clockwise };
+        XMStoreFloat4x4(&occluder.world, XMMatrixIdentity());
+        drawn.push_back(occluder);
+    }
+
+    occlusion.RenderOccluders(drawn.data(), drawn.size(), viewProj);
+
+    size_t occluded = 0;
+    for (size_t m = 0; m < model.meshes.size(); ++m)
+    {
+        if (results[m] != SectionPlanes::Result::Outside
+            && occlusion.IsOccluded(model.meshes[m].boundingBox, XMMatrixIdentity()))
+        {
+            results[m] = SectionPlanes::Result::Outside;
+            ++occluded;
+        }
+    }
+
+    return occluded;
+}
+
+void DX::RenderHeadlessView(SoftwareRasterizer& rasterizer, const ModelData& model, HeadlessView view,
+    bool grid, bool lhcoords, const SectionPlanes* sections, OcclusionCuller* occlusion,
+    const std::vector<OcclusionCuller::OccluderMesh>* occluders, TransparencyMode transparency)
+{
+    XMMATRIX viewMatrix, projMatrix;
+    const float gridScale = GetHeadlessViewMatrices(model, view, float(rasterizer.GetWidth()) / float(rasterizer.GetHeight()),
+        lhcoords, viewMatrix, projMatrix);
+    const XMMATRIX viewProj = XMMatrixMultiply(viewMatrix, projMatrix);
+
+    rasterizer.Clear(XMFLOAT4(0.f, 0.f, 0.f, 1.f));
+
+    if (grid)
+    {
+        DrawGrid(rasterizer, viewProj, gridScale);
+    }
+
+    // Which meshes to draw, and which of those to clip, when sectioning or culling.
+    std::vector<SectionPlanes::Result> results;
+    XMFLOAT4 clipPlanes[SectionPlanes::MaxPlanes];
+    size_t clipPlaneCount = 0;
+
+    if (sections && sections->IsEnabled())
+    {
+        SectionPlanes::BoxBatch boxes;
+        boxes.Reserve(model.meshes.size());
+        for (auto const& mesh : model.meshes)
+        {
+            boxes.Add(mesh.boundingBox);
+        }
+
+        results.resize(model.meshes.size());
+        std::ignore = sections->Classify(boxes, XMMatrixIdentity(), results.data(), results.size());
+
+        clipPlaneCount = sections->GetClipPlanes(viewProj, clipPlanes);
+    }
+
+    if (occlusion && occluders)
+    {
+        results.resize(model.meshes.size(), SectionPlanes::Result::Inside);
+        std::ignore = CullOccludedMeshes(*occlusion, model, *occluders, viewProj, results.data());
+    }
+
+    const SectionPlanes::Result* drawn = results.empty() ? nullptr : results.data();
+    DrawModel(rasterizer, model, viewProj, false, drawn, clipPlanes, clipPlaneCount);
+
+    switch (transparency)
+    {
+    case TransparencyMode::Sorted:
+        DrawSortedAlphaParts(rasterizer, model, viewProj, drawn, clipPlanes, clipPlaneCount);
+        break;
+
+    case TransparencyMode::WeightedBlended:
+        DrawModel(rasterizer, model, viewProj, true, drawn, clipPlanes, clipPlaneCount, SoftwareRasterizer::BlendMode::WeightedBlended);
+        rasterizer.ResolveWeightedBlended();
+        break;
+
+    default:
+        DrawModel(rasterizer, model, viewProj, true, drawn, clipPlanes, clipPlaneCount);
+        break;
+    }
+
+    rasterizer.Flush();
+}
+
+int DX::RunHeadless(const HeadlessOptions& runOptions, std::ostream& log)
+{
+    HeadlessOptions options = runOptions;
+    if (!options.generateDirectory.empty())
+    {
+        try
+        {
+            GenerateCorpus(options.generateDirectory, options.models, log);
+        }
+        catch (const std::exception& e)
+        {
+            log << "ERROR: Generating models in " << Narrow(options.generateDirectory) << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.inspect)
+    {
+        return RunInspector(options, log);
+    }
+
+    if (options.residencyBudget)
+    {
+        return RunResidencySimulation(options, log);
+    }
+
+    if (options.models.empty() && !options.benchmark)
+    {
+        log << "ERROR: No models given for headless rendering" << std::endl;
+        return 1;
+    }
+
+    std::vector<HeadlessView> views = options.views;
+    if (views.empty())
+    {
+        views = { HeadlessView::Front, HeadlessView::Iso };
+    }
+
+    if (options.benchmark)
+    {
+        return RunBenchmark(options, views, log);
+    }
+
+    return RenderModels(options, views, log);
+}
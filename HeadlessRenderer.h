@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------------------
+// File: HeadlessRenderer.h
+//
+// Batch mode that loads a list of models, renders fixed camera views with the software
+// rasterizer, and writes the images to disk. It needs no window or Direct3D device.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "AutoExposure.h"
+#include "ImageCompare.h"
+#include "ModelData.h"
+#include "OcclusionCuller.h"
+#include "RenderTextureDesc.h"
+#include "SectionPlanes.h"
+#include "SoftwareRasterizer.h"
+#include "SoftwareToneMap.h"
+#include "TransparencySorter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace DX
+{
+    enum class HeadlessView : uint32_t
+    {
+        Front,      // Default camera from CameraHome
+        Side,
+        Top,
+        Iso,
+        Count
+    };
+
+    struct HeadlessOptions
+    {
+        std::vector<std::wstring>   models;
+        std::wstring                outputDirectory;
+        std::wstring                goldenDirectory;    // Images to compare against; empty to skip
+        std::wstring                generateDirectory;  // Writes the synthetic corpus here and adds it to models
+        std::wstring                jsonFile;           // Benchmark results or inspection reports; empty to skip
+        ImageTolerance              tolerance;
+        uint32_t                    width;
+        uint32_t                    height;
+        std::vector<HeadlessView>   views;
+        bool                        grid;
+        bool                        lhcoords;
+        uint32_t                    threads;        // 0 for one per hardware thread
+        uint32_t                    jobs;           // Models rendered at once, sharing the threads
+        uint32_t                    benchmark;      // Iterations per view; 0 writes images instead
+        SoftwareToneMap::Operator   toneMapOperator;
+        float                       exposure;
+        bool                        autoExposure;   // Exposure from each view's luminance histogram
+        bool                        inspect;        // Writes a JSON report per model instead of rendering (see ModelInspector.h)
+        uint64_t                    residencyBudget;    // Simulates streaming under this many bytes instead of rendering; 0 to skip
+        SectionPlanes               sections;           // Clip every view, in model space
+        bool                        occlusion;          // Skips meshes hidden behind others (see OcclusionCuller.h)
+        TransparencyMode            transparency;       // How alpha parts are blended
+        HdrFormat                   hdrFormat;          // Precision the scene is kept at
+
+        HeadlessOptions() :
+            width(512),
+            height(512),
+            grid(false),
+            lhcoords(true),
+            threads(0),
+            jobs(1),
+            benchmark(0),
+            toneMapOperator(SoftwareToneMap::Reinhard),
+            exposure(0.f),
+            autoExposure(false),
+            inspect(false),
+            residencyBudget(0),
+            occlusion(false),
+            transparency(TransparencyMode::MeshOrder),
+            hdrFormat(HdrFormat::R16G16B16A16Float)
+        {
+        }
+    };
+
+    // Handles one command-line argument for headless mode: a model file name, an
+    // @listfile with one model per line, or one of the -out:, -size:, -views:, -grid,
+    // -rhcoords, -tonemap:, -exposure:, -threads:, -jobs:, -golden:, -ssim:, -maxdiff:,
+    // -generate:, -json:, -benchmark, -inspect, -residency:, -section:, -occlusion,
+    // -transparency:, or -hdrformat: switches. Returns false if the argument is not recognized.
+    bool ParseHeadlessArgument(_In_z_ const wchar_t* arg, HeadlessOptions& options);
+
+    const wchar_t* GetHeadlessViewName(HeadlessView view) noexcept;
+
+    // The view and projection matrices RenderHeadlessView uses; the camera placement
+    // follows Game::CameraHome. Returns the scale of the grid.
+    float XM_CALLCONV GetHeadlessViewMatrices(const ModelData& model, HeadlessView view, float aspect, bool lhcoords,
+        DirectX::XMMATRIX& viewMatrix, DirectX::XMMATRIX& projMatrix) noexcept;
+
+    // Draws the meshes 'results' marks Inside as occluders, then marks those hidden
+    // behind them Outside. Meshes cut by section planes aren't whole, so they don't
+    // occlude. Returns how many were hidden.
+    size_t XM_CALLCONV CullOccludedMeshes(OcclusionCuller& occlusion, const ModelData& model,
+        const std::vector<OcclusionCuller::OccluderMesh>& occluders, DirectX::FXMMATRIX viewProj, SectionPlanes::Result* results);
+
+    // Renders one view of the model into the rasterizer using the viewer's default camera,
+    // lighting, and culling. With section planes, meshes entirely behind one are skipped
+    // and those crossing one are clipped per triangle. With an occlusion culler and the
+    // model's occluders from OcclusionCuller::BuildOccluders, meshes hidden behind others
+    // are skipped. Alpha parts are blended as 'transparency' selects. The rasterizer is
+    // flushed on return.
+    void RenderHeadlessView(SoftwareRasterizer& rasterizer, const ModelData& model, HeadlessView view,
+        bool grid, bool lhcoords, _In_opt_ const SectionPlanes* sections = nullptr,
+        _In_opt_ OcclusionCuller* occlusion = nullptr, _In_opt_ const std::vector<OcclusionCuller::OccluderMesh>* occluders = nullptr,
+        TransparencyMode transparency = TransparencyMode::MeshOrder);
+
+    // Returns 0 if every model rendered (and matched its golden images, when given), 1
+    // otherwise. Progress, per-model timings, and errors go to 'log'. With -inspect the
+    // models are passed to RunInspector instead of being rendered, with -residency: to
+    // RunResidencySimulation, and with -benchmark to RunBenchmark (see HeadlessBenchmark.h),
+    // which writes no images; instead each model is rendered at 1, 2, 4, ... threads up to
+    // the limit, reporting throughput and scaling, followed by the same for each tone-map
+    // operator and transfer function on a 4K image. Models are optional when benchmarking.
+    int RunHeadless(const HeadlessOptions& options, std::ostream& log);
+}
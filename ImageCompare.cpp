@@ -0,0 +1,312 @@
+//--------------------------------------------------------------------------------------
+// File: ImageCompare.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "ImageCompare.h"
+#include "ReadData.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_FileHeaderSize = 14;
+    constexpr size_t c_InfoHeaderSize = 40;
+
+    // SSIM windows, overlapping by half.
+    constexpr size_t c_WindowSize = 8;
+    constexpr size_t c_WindowStep = 4;
+
+    // Constants from Wang et al. for 8-bit values.
+    constexpr double c_SSIM_C1 = (0.01 * 255.) * (0.01 * 255.);
+    constexpr double c_SSIM_C2 = (0.03 * 255.) * (0.03 * 255.);
+
+    constexpr size_t c_RowGrain = 16;
+
+    inline XMCOLOR MakeColor(uint8_t r, uint8_t g, uint8_t b) noexcept
+    {
+        return XMCOLOR(0xFF000000u | (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b));
+    }
+
+    inline float Luminance(XMCOLOR c) noexcept
+    {
+        return 0.2126f * float(c.r) + 0.7152f * float(c.g) + 0.0722f * float(c.b);
+    }
+
+    inline uint32_t MaxChannelDifference(XMCOLOR a, XMCOLOR b) noexcept
+    {
+        const int dr = std::abs(int(a.r) - int(b.r));
+        const int dg = std::abs(int(a.g) - int(b.g));
+        const int db = std::abs(int(a.b) - int(b.b));
+        return static_cast<uint32_t>(std::max(dr, std::max(dg, db)));
+    }
+
+    template<typename F>
+    void ForEachRow(TaskPool* pool, size_t count, F&& fn)
+    {
+        if (pool)
+        {
+            pool->ParallelFor(count, c_RowGrain, fn);
+        }
+        else
+        {
+            fn(size_t(0), count, size_t(0));
+        }
+    }
+
+    // Mean SSIM of one window of the two luminance images.
+    double WindowSSIM(const float* a, const float* b, size_t pitch, size_t width, size_t height) noexcept
+    {
+        double sumA = 0., sumB = 0., sumAA = 0., sumBB = 0., sumAB = 0.;
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                const double va = a[y * pitch + x];
+                const double vb = b[y * pitch + x];
+                sumA += va;
+                sumB += vb;
+                sumAA += va * va;
+                sumBB += vb * vb;
+                sumAB += va * vb;
+            }
+        }
+
+        const double n = double(width * height);
+        const double meanA = sumA / n;
+        const double meanB = sumB / n;
+        const double varA = std::max(sumAA / n - meanA * meanA, 0.);
+        const double varB = std::max(sumBB / n - meanB * meanB, 0.);
+        const double covariance = sumAB / n - meanA * meanB;
+
+        return ((2. * meanA * meanB + c_SSIM_C1) * (2. * covariance + c_SSIM_C2))
+            / ((meanA * meanA + meanB * meanB + c_SSIM_C1) * (varA + varB + c_SSIM_C2));
+    }
+
+    // Window origins along one axis, with the last window flush against the edge.
+    std::vector<size_t> GetWindowOrigins(size_t size)
+    {
+        std::vector<size_t> origins;
+        if (size <= c_WindowSize)
+        {
+            origins.push_back(0);
+            return origins;
+        }
+
+        for (size_t pos = 0; pos + c_WindowSize <= size; pos += c_WindowStep)
+        {
+            origins.push_back(pos);
+        }
+
+        if (origins.back() + c_WindowSize < size)
+        {
+            origins.push_back(size - c_WindowSize);
+        }
+
+        return origins;
+    }
+}
+
+BitmapImage DX::ReadBMP(const wchar_t* fileName)
+{
+    auto const file = ReadData(fileName);
+
+    auto get16 = [&](size_t offset) -> uint32_t { return uint32_t(file[offset]) | (uint32_t(file[offset + 1]) << 8); };
+    auto get32 = [&](size_t offset) -> uint32_t { return get16(offset) | (get16(offset + 2) << 16); };
+
+    if (file.size() < c_FileHeaderSize + c_InfoHeaderSize || file[0] != 'B' || file[1] != 'M')
+        throw std::runtime_error("Not a BMP file");
+
+    const size_t dataOffset = get32(10);
+    const auto width = static_cast<int32_t>(get32(18));
+    const auto height = static_cast<int32_t>(get32(22));
+    const uint32_t bitCount = get16(28);
+    const uint32_t compression = get32(30);
+
+    if (get32(14) < c_InfoHeaderSize || width <= 0 || height == 0 || height == INT32_MIN
+        || (bitCount != 24 && bitCount != 32) || compression != 0)
+        throw std::runtime_error("Unsupported BMP format");
+
+    const bool topDown = height < 0;
+    BitmapImage image(size_t(width), size_t(std::abs(height)));
+
+    const size_t bytesPerPixel = bitCount / 8;
+    const size_t rowPitch = (image.width * bytesPerPixel + 3) & ~size_t(3);
+    if (dataOffset > file.size() || (file.size() - dataOffset) / rowPitch < image.height)
+        throw std::runtime_error("BMP file is truncated");
+
+    for (size_t y = 0; y < image.height; ++y)
+    {
+        const uint8_t* row = file.data() + dataOffset + (topDown ? y : image.height - 1 - y) * rowPitch;
+        XMCOLOR* dest = image.pixels.data() + y * image.width;
+        for (size_t x = 0; x < image.width; ++x, row += bytesPerPixel)
+        {
+            dest[x] = MakeColor(row[2], row[1], row[0]);
+        }
+    }
+
+    return image;
+}
+
+void DX::WriteBMP(const wchar_t* fileName, const BitmapImage& image)
+{
+    const size_t rowPitch = (image.width * 3 + 3) & ~size_t(3);
+    const size_t imageSize = rowPitch * image.height;
+
+    std::vector<uint8_t> file(c_FileHeaderSize + c_InfoHeaderSize + imageSize, 0);
+
+    auto put16 = [&](size_t offset, uint32_t value) { file[offset] = uint8_t(value); file[offset + 1] = uint8_t(value >> 8); };
+    auto put32 = [&](size_t offset, uint32_t value) { put16(offset, value & 0xFFFF); put16(offset + 2, value >> 16); };
+
+    // BITMAPFILEHEADER
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(2, static_cast<uint32_t>(file.size()));
+    put32(10, static_cast<uint32_t>(c_FileHeaderSize + c_InfoHeaderSize));
+
+    // BITMAPINFOHEADER
+    put32(14, static_cast<uint32_t>(c_InfoHeaderSize));
+    put32(18, static_cast<uint32_t>(image.width));
+    put32(22, static_cast<uint32_t>(image.height));
+    put16(26, 1);
+    put16(28, 24);
+    put32(34, static_cast<uint32_t>(imageSize));
+    put32(38, 2835);
+    put32(42, 2835);
+
+    // Rows are stored bottom-up in BGR order.
+    for (size_t y = 0; y < image.height; ++y)
+    {
+        uint8_t* row = file.data() + c_FileHeaderSize + c_InfoHeaderSize + (image.height - 1 - y) * rowPitch;
+        const XMCOLOR* src = image.pixels.data() + y * image.width;
+        for (size_t x = 0; x < image.width; ++x)
+        {
+            row[x * 3] = src[x].b;
+            row[x * 3 + 1] = src[x].g;
+            row[x * 3 + 2] = src[x].r;
+        }
+    }
+
+    WriteData(fileName, file.data(), file.size());
+}
+
+ImageComparison DX::CompareImages(const BitmapImage& reference, const BitmapImage& image,
+    const ImageTolerance& tolerance, BitmapImage* diff, TaskPool* pool)
+{
+    if (reference.width != image.width || reference.height != image.height)
+        throw std::invalid_argument("Images differ in size");
+
+    const size_t width = image.width;
+    const size_t height = image.height;
+
+    ImageComparison result = {};
+    if (!width || !height)
+    {
+        result.ssim = 1.;
+        return result;
+    }
+
+    if (diff)
+    {
+        *diff = BitmapImage(width, height);
+    }
+
+    // Per-pixel differences, and the luminance of both images for SSIM. Counts are kept
+    // per row so the totals don't depend on how rows are split across threads.
+    std::vector<float> lumRef(width * height);
+    std::vector<float> lumImage(width * height);
+    std::vector<uint32_t> rowDiffering(height);
+    std::vector<uint32_t> rowMax(height);
+
+    ForEachRow(pool, height, [&](size_t begin, size_t end, size_t)
+    {
+        for (size_t y = begin; y < end; ++y)
+        {
+            const XMCOLOR* a = reference.pixels.data() + y * width;
+            const XMCOLOR* b = image.pixels.data() + y * width;
+            XMCOLOR* d = diff ? diff->pixels.data() + y * width : nullptr;
+
+            uint32_t differing = 0;
+            uint32_t maxDiff = 0;
+            for (size_t x = 0; x < width; ++x)
+            {
+                lumRef[y * width + x] = Luminance(a[x]);
+                lumImage[y * width + x] = Luminance(b[x]);
+
+                const uint32_t delta = MaxChannelDifference(a[x], b[x]);
+                maxDiff = std::max(maxDiff, delta);
+
+                const bool over = delta > tolerance.pixelThreshold;
+                if (over)
+                {
+                    ++differing;
+                }
+
+                if (d)
+                {
+                    if (over)
+                    {
+                        d[x] = MakeColor(uint8_t(std::min<uint32_t>(128 + delta, 255)), 0, 0);
+                    }
+                    else
+                    {
+                        const auto gray = static_cast<uint8_t>(lumRef[y * width + x] * 0.25f);
+                        d[x] = MakeColor(gray, gray, gray);
+                    }
+                }
+            }
+
+            rowDiffering[y] = differing;
+            rowMax[y] = maxDiff;
+        }
+    });
+
+    uint64_t differing = 0;
+    for (size_t y = 0; y < height; ++y)
+    {
+        differing += rowDiffering[y];
+        result.maxDifference = std::max(result.maxDifference, rowMax[y]);
+    }
+    result.differingPixels = double(differing) / double(width * height);
+
+    // SSIM over overlapping windows.
+    const std::vector<size_t> originsX = GetWindowOrigins(width);
+    const std::vector<size_t> originsY = GetWindowOrigins(height);
+    const size_t windowWidth = std::min(width, c_WindowSize);
+    const size_t windowHeight = std::min(height, c_WindowSize);
+
+    std::vector<double> rowSSIM(originsY.size());
+    ForEachRow(pool, originsY.size(), [&](size_t begin, size_t end, size_t)
+    {
+        for (size_t j = begin; j < end; ++j)
+        {
+            double sum = 0.;
+            for (auto x : originsX)
+            {
+                const size_t offset = originsY[j] * width + x;
+                sum += WindowSSIM(lumRef.data() + offset, lumImage.data() + offset, width, windowWidth, windowHeight);
+            }
+            rowSSIM[j] = sum;
+        }
+    });
+
+    double ssim = 0.;
+    for (auto s : rowSSIM)
+    {
+        ssim += s;
+    }
+    result.ssim = ssim / double(originsX.size() * originsY.size());
+
+    return result;
+}
@@ -0,0 +1,71 @@
+//--------------------------------------------------------------------------------------
+// File: ImageCompare.h
+//
+// 8-bit image files and perceptual comparison for golden-image regression of headless
+// renders. Images are compared by the structural similarity (SSIM) of their luminance
+// and by the share of pixels whose color differs by more than a threshold.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace DX
+{
+    class TaskPool;
+
+    struct BitmapImage
+    {
+        size_t                                          width;
+        size_t                                          height;
+        std::vector<DirectX::PackedVector::XMCOLOR>     pixels;     // Top-down rows without padding
+
+        BitmapImage() noexcept : width(0), height(0) {}
+        BitmapImage(size_t w, size_t h) : width(w), height(h), pixels(w * h) {}
+    };
+
+    // Uncompressed 24-bit files, as written by the headless renderer. Reading also accepts
+    // 32-bit and top-down files, and throws std::runtime_error for anything else.
+    BitmapImage ReadBMP(_In_z_ const wchar_t* fileName);
+    void WriteBMP(_In_z_ const wchar_t* fileName, const BitmapImage& image);
+
+    struct ImageTolerance
+    {
+        float       minSSIM;            // Lowest mean SSIM accepted
+        uint32_t    pixelThreshold;     // Largest per-channel difference not counted
+        float       maxDifferingPixels; // Largest fraction of pixels over the threshold
+
+        ImageTolerance() noexcept :
+            minSSIM(0.98f),
+            pixelThreshold(16),
+            maxDifferingPixels(0.005f)
+        {
+        }
+    };
+
+    struct ImageComparison
+    {
+        double      ssim;               // Mean over 8x8 windows; 1 for identical images
+        double      differingPixels;    // Fraction of pixels over the threshold
+        uint32_t    maxDifference;      // Largest per-channel difference
+
+        bool Passes(const ImageTolerance& tolerance) const noexcept
+        {
+            return ssim >= double(tolerance.minSSIM) && differingPixels <= double(tolerance.maxDifferingPixels);
+        }
+    };
+
+    // The images must be the same size. When 'diff' is given it receives a visualization:
+    // the reference image darkened, with pixels over the threshold in red.
+    ImageComparison CompareImages(const BitmapImage& reference, const BitmapImage& image,
+        const ImageTolerance& tolerance, _Out_opt_ BitmapImage* diff = nullptr, TaskPool* pool = nullptr);
+}
@@ -8,6 +8,13 @@
 #include "pch.h"
 #include "Game.h"
 
+#if !(defined(_XBOX_ONE) && defined(_TITLE))
+#include "CommandLine.h"
+#include "HeadlessRenderer.h"
+
+#include <iostream>
+#endif
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
 #include <ppltasks.h>
 
@@ -21,6 +28,7 @@ using namespace Windows::Foundation;
 bool g_HDRMode = false;
 #else
 #include <commdlg.h>
+#include <shellapi.h>
 #endif
 
 using namespace DirectX;
@@ -164,6 +172,92 @@ LPCWSTR g_szAppName = L"DirectXTKModelViewer (DirectX 11)";
 LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
 void ExitGame() noexcept;
 
+namespace
+{
+    struct CommandLineOptions
+    {
+        bool                fastStart;
+        bool                startupReport;
+        std::wstring        startupTrace;
+        DX::FramePacing     pacing;
+        double              targetFPS;
+        uint32_t            frameTraceLength;
+        uint64_t            memoryBudget;
+        uint64_t            streamingBudget;
+        bool                headless;
+        bool                invalidArgument;
+        DX::HeadlessOptions headlessOptions;
+    };
+
+    CommandLineOptions ParseCommandLine()
+    {
+        CommandLineOptions options = {};
+
+        int argc = 0;
+        LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+        if (!argv)
+            return options;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const wchar_t* value = nullptr;
+            if (DX::MatchSwitch(argv[i], L"faststart"))
+            {
+                options.fastStart = true;
+            }
+            else if (DX::MatchSwitch(argv[i], L"startupreport"))
+            {
+                options.startupReport = true;
+            }
+            else if ((value = DX::MatchSwitch(argv[i], L"startuptrace")) != nullptr && *value)
+            {
+                options.startupTrace = value;
+            }
+            else if ((value = DX::MatchSwitch(argv[i], L"pacing")) != nullptr && *value)
+            {
+                if (!_wcsicmp(value, L"vsync"))
+                    options.pacing = DX::FramePacing::VSync;
+                else if (!_wcsicmp(value, L"capped"))
+                    options.pacing = DX::FramePacing::Capped;
+                else if (!_wcsicmp(value, L"lowlatency"))
+                    options.pacing = DX::FramePacing::LowLatency;
+                else if (!_wcsicmp(value, L"ondemand"))
+                    options.pacing = DX::FramePacing::OnDemand;
+            }
+            else if ((value = DX::MatchSwitch(argv[i], L"fps")) != nullptr && *value)
+            {
+                options.targetFPS = _wtof(value);
+            }
+            else if ((value = DX::MatchSwitch(argv[i], L"traceframes")) != nullptr && *value)
+            {
+                options.frameTraceLength = static_cast<uint32_t>(wcstoul(value, nullptr, 10));
+            }
+            else if ((value = DX::MatchSwitch(argv[i], L"memorybudget")) != nullptr && *value)
+            {
+                options.memoryBudget = static_cast<uint64_t>(_wtof(value) * 1024.0 * 1024.0);
+            }
+            else if ((value = DX::MatchSwitch(argv[i], L"stream")) != nullptr)
+            {
+                options.streamingBudget = (*value)
+                    ? static_cast<uint64_t>(_wtof(value) * 1024.0 * 1024.0)
+                    : DX::ResidencyManager::Settings().budgetBytes;
+            }
+            else if (DX::MatchSwitch(argv[i], L"headless"))
+            {
+                options.headless = true;
+            }
+            else if (!DX::ParseHeadlessArgument(argv[i], options.headlessOptions))
+            {
+                options.invalidArgument = true;
+            }
+        }
+
+        LocalFree(argv);
+
+        return options;
+    }
+}
+
 // Indicates to hybrid graphics systems to prefer the discrete part by default
 extern "C"
 {
@@ -184,10 +278,45 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     if (FAILED(hr))
         return 1;
 
+    const CommandLineOptions options = ParseCommandLine();
+
+    if (options.headless)
+    {
+        // Report to the console we were launched from, if any.
+        if (AttachConsole(ATTACH_PARENT_PROCESS))
+        {
+            FILE* stream = nullptr;
+            std::ignore = freopen_s(&stream, "CONOUT$", "w", stdout);
+            std::ignore = freopen_s(&stream, "CONOUT$", "w", stderr);
+        }
+
+        int result = 1;
+        if (options.invalidArgument)
+        {
+            std::cerr << "ERROR: Invalid headless argument" << std::endl;
+        }
+        else
+        {
+            result = DX::RunHeadless(options.headlessOptions, std::cout);
+        }
+
+        CoUninitialize();
+        return result;
+    }
+
     g_game = std::make_unique<Game>();
 
+    g_game->SetStartupOptions(options.fastStart, options.startupReport, options.startupTrace.c_str());
+    g_game->SetFramePacing(options.pacing, options.targetFPS);
+    g_game->SetFrameTraceLength(options.frameTraceLength);
+    g_game->SetMemoryBudget(options.memoryBudget);
+    g_game->SetStreamingBudget(options.streamingBudget);
+
     // Register class and create window
     {
+        auto startup = g_game->GetStartupTimer();
+        const size_t windowPhase = startup->Begin("Create window");
+
         // Register class
         WNDCLASSEXW wcex = {};
         wcex.cbSize = sizeof(WNDCLASSEXW);
@@ -221,6 +350,8 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 
         GetClientRect(hwnd, &rc);
 
+        startup->End(windowPhase);
+
         g_game->Initialize(hwnd, rc.right - rc.left, rc.bottom - rc.top);
     }
 
@@ -236,6 +367,13 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         else
         {
             g_game->Tick();
+
+            // Nothing was drawn, so sleep until there is input rather than spinning.
+            const DWORD idleTimeout = g_game->GetIdleTimeout();
+            if (idleTimeout)
+            {
+                std::ignore = MsgWaitForMultipleObjectsEx(0, nullptr, idleTimeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+            }
         }
     }
 
@@ -452,7 +590,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             ofn.lpstrFile = szFile;
             ofn.lpstrFile[0] = 0;
             ofn.nMaxFile = MAX_PATH;
-            ofn.lpstrFilter = L"DirectX SDK Mesh (SDKMESH)\0*.sdkmesh\0Visual Studio Mesh (CMO)\0*.cmo\0Vertex Buffer Object (VBO)\0*.vbo\0All Files\0*.*\0";
+            ofn.lpstrFilter = L"DirectX SDK Mesh (SDKMESH)\0*.sdkmesh\0Visual Studio Mesh (CMO)\0*.cmo\0Vertex Buffer Object (VBO)\0*.vbo\0Model scene\0*.scene\0All Files\0*.*\0";
             ofn.nFilterIndex = s_filterIndex;
             ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
             if (GetOpenFileName(&ofn))
@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------------------
+// File: MappedFile.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+#include "ReadData.h"
+
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+using namespace DX;
+
+MappedFile::MappedFile() noexcept :
+    m_data(nullptr),
+    m_size(0)
+{
+}
+
+MappedFile::MappedFile(const wchar_t* fileName) :
+    m_data(nullptr),
+    m_size(0)
+{
+    if (!fileName)
+        throw std::invalid_argument("MappedFile");
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "CreateFileW");
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        const DWORD error = GetLastError();
+        CloseHandle(file);
+        throw std::system_error(std::error_code(static_cast<int>(error), std::system_category()), "GetFileSizeEx");
+    }
+
+    if (static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+    {
+        CloseHandle(file);
+        throw std::runtime_error("File too large to map");
+    }
+
+    if (!fileSize.QuadPart)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    // The view keeps the mapping open, and the mapping keeps the file open.
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const DWORD mappingError = GetLastError();
+    CloseHandle(file);
+    if (!mapping)
+        throw std::system_error(std::error_code(static_cast<int>(mappingError), std::system_category()), "CreateFileMappingW");
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    const DWORD viewError = GetLastError();
+    CloseHandle(mapping);
+    if (!view)
+        throw std::system_error(std::error_code(static_cast<int>(viewError), std::system_category()), "MapViewOfFile");
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int file = open(FileName(fileName).c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::system_error(std::error_code(errno, std::generic_category()), "open");
+
+    struct stat info = {};
+    if (fstat(file, &info) != 0)
+    {
+        const int error = errno;
+        close(file);
+        throw std::system_error(std::error_code(error, std::generic_category()), "fstat");
+    }
+
+    if (!info.st_size)
+    {
+        close(file);
+        return;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    const int error = errno;
+    close(file);
+    if (view == MAP_FAILED)
+        throw std::system_error(std::error_code(error, std::generic_category()), "mmap");
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    m_data(other.m_data),
+    m_size(other.m_size)
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+MappedFile& MappedFile::operator= (MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+    }
+    return *this;
+}
+
+void MappedFile::Close() noexcept
+{
+    if (m_data)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
@@ -0,0 +1,44 @@
+//--------------------------------------------------------------------------------------
+// File: MappedFile.h
+//
+// Read-only memory mapping of a whole file, so large models can be parsed and streamed
+// without reading them into memory first. Pages are read by the OS as they are touched.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace DX
+{
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept;
+        ~MappedFile();
+
+        // Throws std::system_error if the file can't be opened or mapped. An empty file
+        // maps to a null pointer with a size of 0.
+        explicit MappedFile(_In_z_ const wchar_t* fileName);
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator= (MappedFile&& other) noexcept;
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator= (MappedFile const&) = delete;
+
+        void Close() noexcept;
+
+        const uint8_t* GetData() const noexcept { return m_data; }
+        size_t GetSize() const noexcept { return m_size; }
+
+    private:
+        const uint8_t*  m_data;
+        size_t          m_size;
+    };
+}
@@ -0,0 +1,390 @@
+//--------------------------------------------------------------------------------------
+// File: MemoryAccounting.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "MemoryAccounting.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace DX;
+
+namespace
+{
+    // Not in older Windows SDK headers.
+    constexpr DXGI_FORMAT c_FormatA4B4G4R4 = static_cast<DXGI_FORMAT>(191);
+
+    const char* c_CategoryNames[MemoryLedger::CategoryCount] =
+    {
+        "VertexBuffers",
+        "IndexBuffers",
+        "Textures",
+        "RenderTargets",
+        "DepthBuffers",
+        "CpuData",
+    };
+
+    uint32_t CountMips(uint32_t width, uint32_t height, uint32_t depth) noexcept
+    {
+        uint32_t size = std::max(std::max(width, height), depth);
+        uint32_t count = 1;
+        while (size > 1)
+        {
+            size >>= 1;
+            ++count;
+        }
+        return count;
+    }
+
+    void WriteCSVField(std::ostream& stream, const std::string& value)
+    {
+        if (value.find_first_of(",\"\n") == std::string::npos)
+        {
+            stream << value;
+            return;
+        }
+
+        stream << '"';
+        for (auto c : value)
+        {
+            if (c == '"')
+                stream << '"';
+            stream << c;
+        }
+        stream << '"';
+    }
+}
+
+size_t DX::BitsPerPixel(DXGI_FORMAT format) noexcept
+{
+    switch (static_cast<int>(format))
+    {
+    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return 128;
+
+    case DXGI_FORMAT_R32G32B32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+    case DXGI_FORMAT_R32G32B32_UINT:
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return 96;
+
+    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R32G32_TYPELESS:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32_SINT:
+    case DXGI_FORMAT_R32G8X24_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+    case DXGI_FORMAT_Y416:
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        return 64;
+
+    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R10G10B10A2_UINT:
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+    case DXGI_FORMAT_R16G16_TYPELESS:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R16G16_UNORM:
+    case DXGI_FORMAT_R16G16_UINT:
+    case DXGI_FORMAT_R16G16_SNORM:
+    case DXGI_FORMAT_R16G16_SINT:
+    case DXGI_FORMAT_R32_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT:
+    case DXGI_FORMAT_R32_FLOAT:
+    case DXGI_FORMAT_R32_UINT:
+    case DXGI_FORMAT_R32_SINT:
+    case DXGI_FORMAT_R24G8_TYPELESS:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_AYUV:
+    case DXGI_FORMAT_Y410:
+    case DXGI_FORMAT_YUY2:
+        return 32;
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+    case DXGI_FORMAT_V408:
+        return 24;
+
+    case DXGI_FORMAT_R8G8_TYPELESS:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SNORM:
+    case DXGI_FORMAT_R8G8_SINT:
+    case DXGI_FORMAT_R16_TYPELESS:
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_D16_UNORM:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R16_SNORM:
+    case DXGI_FORMAT_R16_SINT:
+    case DXGI_FORMAT_B5G6R5_UNORM:
+    case DXGI_FORMAT_B5G5R5A1_UNORM:
+    case DXGI_FORMAT_A8P8:
+    case DXGI_FORMAT_B4G4R4A4_UNORM:
+    case DXGI_FORMAT_P208:
+    case DXGI_FORMAT_V208:
+    case c_FormatA4B4G4R4:
+        return 16;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+    case DXGI_FORMAT_NV11:
+        return 12;
+
+    case DXGI_FORMAT_R8_TYPELESS:
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_R8_SNORM:
+    case DXGI_FORMAT_R8_SINT:
+    case DXGI_FORMAT_A8_UNORM:
+    case DXGI_FORMAT_AI44:
+    case DXGI_FORMAT_IA44:
+    case DXGI_FORMAT_P8:
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return 8;
+
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        return 4;
+
+    case DXGI_FORMAT_R1_UNORM:
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+bool DX::IsCompressed(DXGI_FORMAT format) noexcept
+{
+    return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM)
+        || (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+}
+
+uint64_t DX::ComputeSurfaceBytes(DXGI_FORMAT format, uint32_t width, uint32_t height) noexcept
+{
+    const uint64_t w = width;
+    const uint64_t h = height;
+
+    if (IsCompressed(format))
+    {
+        const uint64_t blockBytes = (BitsPerPixel(format) == 4) ? 8 : 16;
+        return std::max<uint64_t>(1, (w + 3) / 4) * std::max<uint64_t>(1, (h + 3) / 4) * blockBytes;
+    }
+
+    // Packed and planar formats don't store one whole number of bytes per pixel.
+    switch (format)
+    {
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_YUY2:
+        return ((w + 1) >> 1) * 4 * h;
+
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        return ((w + 1) >> 1) * 8 * h;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+        return ((w + 1) >> 1) * 2 * (h + ((h + 1) >> 1));
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+        return ((w + 1) >> 1) * 4 * (h + ((h + 1) >> 1));
+
+    case DXGI_FORMAT_NV11:
+        return ((w + 3) >> 2) * 4 * h * 2;
+
+    case DXGI_FORMAT_P208:
+        return ((w + 1) >> 1) * 2 * h * 2;
+
+    case DXGI_FORMAT_V208:
+        return w * (h + ((h + 1) >> 1) * 2);
+
+    case DXGI_FORMAT_V408:
+        return w * (h + (h >> 1) * 4);
+
+    default:
+        break;
+    }
+
+    const uint64_t bpp = BitsPerPixel(format);
+    return ((w * bpp + 7) / 8) * h;
+}
+
+uint64_t DX::ComputeTextureBytes(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t depth,
+    uint32_t arraySize, uint32_t mipLevels, uint32_t sampleCount) noexcept
+{
+    width = std::max(width, 1u);
+    height = std::max(height, 1u);
+    depth = std::max(depth, 1u);
+
+    if (!mipLevels)
+    {
+        mipLevels = CountMips(width, height, depth);
+    }
+
+    uint64_t bytes = 0;
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        const uint32_t w = std::max(width >> std::min(level, 31u), 1u);
+        const uint32_t h = std::max(height >> std::min(level, 31u), 1u);
+        const uint32_t d = std::max(depth >> std::min(level, 31u), 1u);
+        bytes += ComputeSurfaceBytes(format, w, h) * d;
+    }
+
+    return bytes * std::max(arraySize, 1u) * std::max(sampleCount, 1u);
+}
+
+void MemoryLedger::Clear() noexcept
+{
+    m_entries.clear();
+    m_keys.clear();
+
+    for (auto& total : m_totals)
+    {
+        total = {};
+    }
+}
+
+bool MemoryLedger::AddBuffer(MemoryCategory category, const char* name, uint64_t bytes, const void* key)
+{
+    return Add({ name ? name : "", category, DXGI_FORMAT_UNKNOWN, 0, 0, 0, 0, 0, bytes }, key);
+}
+
+bool MemoryLedger::AddTexture(MemoryCategory category, const char* name, DXGI_FORMAT format, uint32_t width, uint32_t height,
+    uint32_t depthOrArraySize, uint32_t mipLevels, uint32_t sampleCount, bool volume, const void* key)
+{
+    const uint64_t bytes = volume
+        ? ComputeTextureBytes(format, width, height, depthOrArraySize, 1, mipLevels, sampleCount)
+        : ComputeTextureBytes(format, width, height, 1, depthOrArraySize, mipLevels, sampleCount);
+
+    if (!mipLevels)
+    {
+        mipLevels = CountMips(width, height, volume ? depthOrArraySize : 1);
+    }
+
+    return Add({ name ? name : "", category, format, width, height, depthOrArraySize, mipLevels, sampleCount, bytes }, key);
+}
+
+bool MemoryLedger::Add(Entry&& entry, const void* key)
+{
+    const auto index = static_cast<size_t>(entry.category);
+    if (index >= CategoryCount)
+        return false;
+
+    if (key && !m_keys.insert(key).second)
+        return false;
+
+    m_totals[index].bytes += entry.bytes;
+    ++m_totals[index].count;
+    m_entries.emplace_back(std::move(entry));
+    return true;
+}
+
+MemoryLedger::Total MemoryLedger::GetTotal(MemoryCategory category) const noexcept
+{
+    const auto index = static_cast<size_t>(category);
+    return (index < CategoryCount) ? m_totals[index] : Total{};
+}
+
+uint64_t MemoryLedger::GetTotalBytes() const noexcept
+{
+    uint64_t bytes = 0;
+    for (auto const& total : m_totals)
+    {
+        bytes += total.bytes;
+    }
+    return bytes;
+}
+
+const char* MemoryLedger::GetCategoryName(MemoryCategory category) noexcept
+{
+    const auto index = static_cast<size_t>(category);
+    return (index < CategoryCount) ? c_CategoryNames[index] : "";
+}
+
+void MemoryLedger::WriteCSV(std::ostream& stream) const
+{
+    stream << "name,category,format,width,height,depth_or_array_size,mip_levels,sample_count,bytes\n";
+    for (auto const& entry : m_entries)
+    {
+        WriteCSVField(stream, entry.name);
+        stream << ',' << GetCategoryName(entry.category) << ',';
+        if (entry.width)
+        {
+            stream << static_cast<uint32_t>(entry.format) << ',' << entry.width << ',' << entry.height << ','
+                << entry.depthOrArraySize << ',' << entry.mipLevels << ',' << entry.sampleCount;
+        }
+        else
+        {
+            stream << ",,,,,";
+        }
+        stream << ',' << entry.bytes << '\n';
+    }
+
+    for (size_t j = 0; j < CategoryCount; ++j)
+    {
+        stream << "Total," << c_CategoryNames[j] << ",,,,,,," << m_totals[j].bytes << '\n';
+    }
+
+    stream << "Total,All,,,,,,," << GetTotalBytes() << '\n';
+}
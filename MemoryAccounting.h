@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------------------
+// File: MemoryAccounting.h
+//
+// Sizes of DXGI format surfaces and mip chains, and a ledger of the memory held by the
+// viewer's resources grouped into categories. The ledger is rebuilt from the live
+// resources whenever they change, so comparing totals across repeated loads of the same
+// model shows whether anything is being held on to.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#ifdef _WIN32
+#include <dxgiformat.h>
+#else
+#include <directx/dxgiformat.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+
+namespace DX
+{
+    // Bits per pixel, or 0 for DXGI_FORMAT_UNKNOWN and formats without a fixed size. Block
+    // compressed formats report their average (4 or 8), planar video formats the average
+    // over both planes.
+    size_t BitsPerPixel(DXGI_FORMAT format) noexcept;
+
+    bool IsCompressed(DXGI_FORMAT format) noexcept;
+
+    // Bytes of one tightly packed 2D surface, or 0 if the format has no fixed size.
+    uint64_t ComputeSurfaceBytes(DXGI_FORMAT format, uint32_t width, uint32_t height) noexcept;
+
+    // Bytes of a whole texture: every array slice (6 per cube) and every mip, each level
+    // half the size of the one before and at least 1 pixel. 'depth' is greater than 1 only
+    // for volume textures, which shrink in depth as well. A 'mipLevels' of 0 means the full
+    // chain down to 1x1.
+    uint64_t ComputeTextureBytes(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t depth,
+        uint32_t arraySize, uint32_t mipLevels, uint32_t sampleCount = 1) noexcept;
+
+    enum class MemoryCategory : uint32_t
+    {
+        VertexBuffers,
+        IndexBuffers,
+        Textures,
+        RenderTargets,
+        DepthBuffers,
+        CpuData,
+        Count
+    };
+
+    class MemoryLedger
+    {
+    public:
+        static constexpr size_t CategoryCount = static_cast<size_t>(MemoryCategory::Count);
+
+        struct Entry
+        {
+            std::string         name;
+            MemoryCategory      category;
+            DXGI_FORMAT         format;         // DXGI_FORMAT_UNKNOWN for buffers and CPU data
+            uint32_t            width;          // Zero for buffers and CPU data
+            uint32_t            height;
+            uint32_t            depthOrArraySize;
+            uint32_t            mipLevels;
+            uint32_t            sampleCount;
+            uint64_t            bytes;
+        };
+
+        struct Total
+        {
+            uint64_t            bytes;
+            size_t              count;
+        };
+
+        MemoryLedger() noexcept : m_totals{} {}
+
+        MemoryLedger(MemoryLedger&&) = default;
+        MemoryLedger& operator= (MemoryLedger&&) = default;
+
+        MemoryLedger(MemoryLedger const&) = delete;
+        MemoryLedger& operator= (MemoryLedger const&) = delete;
+
+        void Clear() noexcept;
+
+        // 'key' identifies the underlying object (e.g. the ID3D11Buffer), so a resource
+        // shared by several meshes or added twice is only counted once. It may be null.
+        // Returns false if the key was already counted.
+        bool AddBuffer(MemoryCategory category, const char* name, uint64_t bytes, const void* key = nullptr);
+        bool AddTexture(MemoryCategory category, const char* name, DXGI_FORMAT format, uint32_t width, uint32_t height,
+            uint32_t depthOrArraySize, uint32_t mipLevels, uint32_t sampleCount = 1, bool volume = false, const void* key = nullptr);
+
+        const std::vector<Entry>& GetEntries() const noexcept { return m_entries; }
+        Total GetTotal(MemoryCategory category) const noexcept;
+        uint64_t GetTotalBytes() const noexcept;
+
+        static const char* GetCategoryName(MemoryCategory category) noexcept;
+
+        // One row per resource followed by one per category.
+        void WriteCSV(std::ostream& stream) const;
+
+    private:
+        std::vector<Entry>              m_entries;
+        std::unordered_set<const void*> m_keys;
+        Total                           m_totals[CategoryCount];
+
+        bool Add(Entry&& entry, const void* key);
+    };
+}
@@ -0,0 +1,1392 @@
+//--------------------------------------------------------------------------------------
+// File: ModelData.cpp
+//
+// CPU-side loaders for .sdkmesh, .cmo, and .vbo files. This file does not use the
+// precompiled header so it can also be built for non-Windows targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <dxgiformat.h>
+#else
+#include <wsl/winadapter.h>
+#include <directx/dxgiformat.h>
+#ifndef MAX_PATH
+#define MAX_PATH 260
+#endif
+#endif
+
+#include "ModelData.h"
+#include "SDKMesh.h"
+
+#include <DirectXPackedVector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cwctype>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    // Bounds-checked sequential reads from an in-memory file.
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const uint8_t* data, size_t size) noexcept :
+            m_data(data),
+            m_size(size),
+            m_offset(0)
+        {
+        }
+
+        const uint8_t* Read(size_t count, size_t elementSize)
+        {
+            if (elementSize && count > (m_size - m_offset) / elementSize)
+                throw std::runtime_error("Unexpected end of file");
+
+            const uint8_t* ptr = m_data + m_offset;
+            m_offset += count * elementSize;
+            return ptr;
+        }
+
+        template<typename T>
+        T Read()
+        {
+            T value;
+            memcpy(&value, Read(1, sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        // Length-prefixed UTF-16 string as written by the CMO exporter.
+        std::string ReadString()
+        {
+            const auto length = Read<uint32_t>();
+            auto chars = Read(length, sizeof(uint16_t));
+
+            std::string result;
+            result.reserve(length);
+            for (uint32_t j = 0; j < length; ++j)
+            {
+                uint16_t c;
+                memcpy(&c, chars + j * sizeof(uint16_t), sizeof(c));
+                if (!c)
+                    break;
+
+                // Names are expected to be ASCII; anything else is replaced.
+                result.push_back((c < 0x80) ? static_cast<char>(c) : '?');
+            }
+            return result;
+        }
+
+        void SkipString()
+        {
+            const auto length = Read<uint32_t>();
+            std::ignore = Read(length, sizeof(uint16_t));
+        }
+
+        size_t GetOffset() const noexcept { return m_offset; }
+
+    private:
+        const uint8_t*  m_data;
+        size_t          m_size;
+        size_t          m_offset;
+    };
+
+    // Validates that 'count' elements starting at 'offset' lie within 'limit' bytes.
+    void CheckRange(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t limit)
+    {
+        if (offset > limit || (elementSize && count > (limit - offset) / elementSize))
+            throw std::runtime_error("Offset or size out of range");
+    }
+
+    std::string FixedString(const char* str, size_t maxLength)
+    {
+        return std::string(str, strnlen(str, maxLength));
+    }
+
+    void AddTexture(ModelData::Material& mat, const char* usage, std::string&& file)
+    {
+        if (!file.empty())
+        {
+            mat.textures.push_back({ usage, std::move(file) });
+        }
+    }
+
+    float UNorm(uint32_t value, uint32_t bits) noexcept
+    {
+        return float(value) / float((1u << bits) - 1u);
+    }
+
+    float SNorm(int32_t value, uint32_t bits) noexcept
+    {
+        return std::max(-1.f, float(value) / float((1 << (bits - 1)) - 1));
+    }
+
+    int32_t SignExtend(uint32_t value, uint32_t bits) noexcept
+    {
+        const uint32_t shift = 32 - bits;
+        return static_cast<int32_t>(value << shift) >> shift;
+    }
+
+    float Float11(uint32_t bits) noexcept
+    {
+        const uint32_t exponent = (bits >> 6) & 0x1F;
+        const uint32_t mantissa = bits & 0x3F;
+        if (!exponent)
+            return std::ldexp(float(mantissa) / 64.f, -14);
+        return std::ldexp(1.f + float(mantissa) / 64.f, int(exponent) - 15);
+    }
+
+    float Float10(uint32_t bits) noexcept
+    {
+        const uint32_t exponent = (bits >> 5) & 0x1F;
+        const uint32_t mantissa = bits & 0x1F;
+        if (!exponent)
+            return std::ldexp(float(mantissa) / 32.f, -14);
+        return std::ldexp(1.f + float(mantissa) / 32.f, int(exponent) - 15);
+    }
+
+    const char* GetSemanticName(uint32_t usage) noexcept
+    {
+        switch (usage)
+        {
+        case DXUT::D3DDECLUSAGE_POSITION:       return "SV_Position";
+        case DXUT::D3DDECLUSAGE_BLENDWEIGHT:    return "BLENDWEIGHT";
+        case DXUT::D3DDECLUSAGE_BLENDINDICES:   return "BLENDINDICES";
+        case DXUT::D3DDECLUSAGE_NORMAL:         return "NORMAL";
+        case DXUT::D3DDECLUSAGE_TEXCOORD:       return "TEXCOORD";
+        case DXUT::D3DDECLUSAGE_TANGENT:        return "TANGENT";
+        case DXUT::D3DDECLUSAGE_BINORMAL:       return "BINORMAL";
+        case DXUT::D3DDECLUSAGE_COLOR:          return "COLOR";
+        default:                                return "UNKNOWN";
+        }
+    }
+
+    const char* GetFormatName(uint32_t type) noexcept
+    {
+        switch (type)
+        {
+        case DXUT::D3DDECLTYPE_FLOAT1:                      return "R32_FLOAT";
+        case DXUT::D3DDECLTYPE_FLOAT2:                      return "R32G32_FLOAT";
+        case DXUT::D3DDECLTYPE_FLOAT3:                      return "R32G32B32_FLOAT";
+        case DXUT::D3DDECLTYPE_FLOAT4:                      return "R32G32B32A32_FLOAT";
+        case DXUT::D3DDECLTYPE_D3DCOLOR:                    return "B8G8R8A8_UNORM";
+        case DXUT::D3DDECLTYPE_UBYTE4:                      return "R8G8B8A8_UINT";
+        case DXUT::D3DDECLTYPE_UBYTE4N:                     return "R8G8B8A8_UNORM";
+        case DXUT::D3DDECLTYPE_SHORT4N:                     return "R16G16B16A16_SNORM";
+        case DXUT::D3DDECLTYPE_DEC3N:                       return "DEC3N";
+        case DXUT::D3DDECLTYPE_FLOAT16_2:                   return "R16G16_FLOAT";
+        case DXUT::D3DDECLTYPE_FLOAT16_4:                   return "R16G16B16A16_FLOAT";
+        case DXUT::D3DDECLTYPE_DXGI_R10G10B10A2_UNORM:      return "R10G10B10A2_UNORM";
+        case DXUT::D3DDECLTYPE_DXGI_R11G11B10_FLOAT:        return "R11G11B10_FLOAT";
+        case DXUT::D3DDECLTYPE_DXGI_R8G8B8A8_SNORM:         return "R8G8B8A8_SNORM";
+        default:                                            return "UNKNOWN";
+        }
+    }
+
+    uint32_t GetFormatSize(uint32_t type) noexcept
+    {
+        switch (type)
+        {
+        case DXUT::D3DDECLTYPE_FLOAT1:      return 4;
+        case DXUT::D3DDECLTYPE_FLOAT2:      return 8;
+        case DXUT::D3DDECLTYPE_FLOAT3:      return 12;
+        case DXUT::D3DDECLTYPE_FLOAT4:      return 16;
+        case DXUT::D3DDECLTYPE_SHORT4N:
+        case DXUT::D3DDECLTYPE_FLOAT16_4:   return 8;
+        default:                            return 4;
+        }
+    }
+
+    // Decodes a 3-component direction. Unsigned normalized formats use the biased
+    // (x * 2 - 1) encoding, matching the viewer's BiasedVertexNormals handling.
+    bool DecodeDirection(uint32_t type, const uint8_t* ptr, XMFLOAT3& result) noexcept
+    {
+        switch (type)
+        {
+        case DXUT::D3DDECLTYPE_FLOAT3:
+        case DXUT::D3DDECLTYPE_FLOAT4:
+            memcpy(&result, ptr, sizeof(XMFLOAT3));
+            return true;
+
+        case DXUT::D3DDECLTYPE_FLOAT16_4:
+            {
+                uint16_t h[3];
+                memcpy(h, ptr, sizeof(h));
+                result = XMFLOAT3(PackedVector::XMConvertHalfToFloat(h[0]),
+                    PackedVector::XMConvertHalfToFloat(h[1]),
+                    PackedVector::XMConvertHalfToFloat(h[2]));
+            }
+            return true;
+
+        case DXUT::D3DDECLTYPE_SHORT4N:
+            {
+                int16_t s[3];
+                memcpy(s, ptr, sizeof(s));
+                result = XMFLOAT3(SNorm(s[0], 16), SNorm(s[1], 16), SNorm(s[2], 16));
+            }
+            return true;
+
+        case DXUT::D3DDECLTYPE_UBYTE4N:
+            result = XMFLOAT3(UNorm(ptr[0], 8) * 2.f - 1.f, UNorm(ptr[1], 8) * 2.f - 1.f, UNorm(ptr[2], 8) * 2.f - 1.f);
+            return true;
+
+        case DXUT::D3DDECLTYPE_DXGI_R8G8B8A8_SNORM:
+            result = XMFLOAT3(SNorm(static_cast<int8_t>(ptr[0]), 8), SNorm(static_cast<int8_t>(ptr[1]), 8), SNorm(static_cast<int8_t>(ptr[2]), 8));
+            return true;
+
+        case DXUT::D3DDECLTYPE_DEC3N:
+            {
+                uint32_t v;
+                memcpy(&v, ptr, sizeof(v));
+                result = XMFLOAT3(SNorm(SignExtend(v & 0x3FF, 10), 10),
+                    SNorm(SignExtend((v >> 10) & 0x3FF, 10), 10),
+                    SNorm(SignExtend((v >> 20) & 0x3FF, 10), 10));
+            }
+            return true;
+
+        case DXUT::D3DDECLTYPE_DXGI_R10G10B10A2_UNORM:
+            {
+                uint32_t v;
+                memcpy(&v, ptr, sizeof(v));
+                result = XMFLOAT3(UNorm(v & 0x3FF, 10) * 2.f - 1.f,
+                    UNorm((v >> 10) & 0x3FF, 10) * 2.f - 1.f,
+                    UNorm((v >> 20) & 0x3FF, 10) * 2.f - 1.f);
+            }
+            return true;
+
+        case DXUT::D3DDECLTYPE_DXGI_R11G11B10_FLOAT:
+            {
+                uint32_t v;
+                memcpy(&v, ptr, sizeof(v));
+                result = XMFLOAT3(Float11(v & 0x7FF) * 2.f - 1.f,
+                    Float11((v >> 11) & 0x7FF) * 2.f - 1.f,
+                    Float10((v >> 22) & 0x3FF) * 2.f - 1.f);
+            }
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    bool DecodeColor(uint32_t type, const uint8_t* ptr, uint32_t& result) noexcept
+    {
+        switch (type)
+        {
+        case DXUT::D3DDECLTYPE_D3DCOLOR:
+            // BGRA in memory
+            result = uint32_t(ptr[2]) | (uint32_t(ptr[1]) << 8) | (uint32_t(ptr[0]) << 16) | (uint32_t(ptr[3]) << 24);
+            return true;
+
+        case DXUT::D3DDECLTYPE_UBYTE4N:
+            memcpy(&result, ptr, sizeof(result));
+            return true;
+
+        case DXUT::D3DDECLTYPE_FLOAT4:
+            {
+                float c[4];
+                memcpy(c, ptr, sizeof(c));
+                result = 0;
+                for (uint32_t j = 0; j < 4; ++j)
+                {
+                    const float v = std::min(std::max(c[j], 0.f), 1.f);
+                    result |= uint32_t(v * 255.f + 0.5f) << (j * 8);
+                }
+            }
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    // Adds one part to the statistics.
+    void CountPart(ModelData::Statistics& stats, ModelData::Primitive primitive, size_t indexCount) noexcept
+    {
+        ++stats.subsets;
+        stats.indices += indexCount;
+
+        const size_t count = ModelData::GetPrimitiveCount(primitive, indexCount);
+        switch (primitive)
+        {
+        case ModelData::Primitive::TriangleList:
+        case ModelData::Primitive::TriangleStrip:   stats.triangles += count; break;
+        case ModelData::Primitive::LineList:
+        case ModelData::Primitive::LineStrip:       stats.lines += count; break;
+        case ModelData::Primitive::PointList:       stats.points += count; break;
+        default:                                    ++stats.unsupportedSubsets; break;
+        }
+    }
+
+    ModelData::Primitive GetPrimitive(uint32_t primitiveType) noexcept
+    {
+        switch (primitiveType)
+        {
+        case DXUT::PT_TRIANGLE_LIST:    return ModelData::Primitive::TriangleList;
+        case DXUT::PT_TRIANGLE_STRIP:   return ModelData::Primitive::TriangleStrip;
+        case DXUT::PT_LINE_LIST:        return ModelData::Primitive::LineList;
+        case DXUT::PT_LINE_STRIP:       return ModelData::Primitive::LineStrip;
+        case DXUT::PT_POINT_LIST:       return ModelData::Primitive::PointList;
+        default:                        return ModelData::Primitive::Unsupported;
+        }
+    }
+
+    // Skinning needs both bone indices and weights, as with Model::CreateFromSDKMESH.
+    bool IsSkinned(const DXUT::SDKMESH_VERTEX_BUFFER_HEADER& vh) noexcept
+    {
+        bool weights = false;
+        bool indices = false;
+        for (uint32_t e = 0; e < DXUT::MAX_VERTEX_ELEMENTS; ++e)
+        {
+            auto const& decl = vh.Decl[e];
+            if (decl.Stream == 0xFF || decl.Type == DXUT::D3DDECLTYPE_UNUSED)
+                break;
+
+            if (decl.Usage == DXUT::D3DDECLUSAGE_BLENDWEIGHT)
+                weights = true;
+            else if (decl.Usage == DXUT::D3DDECLUSAGE_BLENDINDICES)
+                indices = true;
+        }
+        return weights && indices;
+    }
+
+    // Validates the header and the ranges of the tables it points to.
+    DXUT::SDKMESH_HEADER ReadSDKMESHHeader(const uint8_t* data, size_t dataSize, uint64_t& headerSize)
+    {
+        using namespace DXUT;
+
+        if (!data || dataSize < sizeof(SDKMESH_HEADER))
+            throw std::runtime_error("SDKMESH: file too small");
+
+        SDKMESH_HEADER header;
+        memcpy(&header, data, sizeof(header));
+
+        if (header.IsBigEndian)
+            throw std::runtime_error("SDKMESH: big-endian files are not supported");
+
+        if (header.Version != SDKMESH_FILE_VERSION && header.Version != SDKMESH_FILE_VERSION_V2)
+            throw std::runtime_error("SDKMESH: unsupported version");
+
+        headerSize = header.HeaderSize + header.NonBufferDataSize;
+        CheckRange(0, headerSize + header.BufferDataSize, 1, dataSize);
+
+        CheckRange(header.VertexStreamHeadersOffset, header.NumVertexBuffers, sizeof(SDKMESH_VERTEX_BUFFER_HEADER), headerSize);
+        CheckRange(header.IndexStreamHeadersOffset, header.NumIndexBuffers, sizeof(SDKMESH_INDEX_BUFFER_HEADER), headerSize);
+        CheckRange(header.MeshDataOffset, header.NumMeshes, sizeof(SDKMESH_MESH), headerSize);
+        CheckRange(header.SubsetDataOffset, header.NumTotalSubsets, sizeof(SDKMESH_SUBSET), headerSize);
+        CheckRange(header.FrameDataOffset, header.NumFrames, sizeof(SDKMESH_FRAME), headerSize);
+        CheckRange(header.MaterialDataOffset, header.NumMaterials, sizeof(SDKMESH_MATERIAL), headerSize);
+
+        return header;
+    }
+
+    DXUT::SDKMESH_MESH ReadSDKMESHMesh(const uint8_t* data, const DXUT::SDKMESH_HEADER& header, uint32_t index, uint64_t headerSize)
+    {
+        DXUT::SDKMESH_MESH mh;
+        memcpy(&mh, data + header.MeshDataOffset + index * sizeof(mh), sizeof(mh));
+
+        if (!mh.NumVertexBuffers || mh.NumVertexBuffers > DXUT::MAX_VERTEX_STREAMS
+            || mh.VertexBuffers[0] >= header.NumVertexBuffers
+            || mh.IndexBuffer >= header.NumIndexBuffers)
+            throw std::runtime_error("SDKMESH: invalid mesh");
+
+        CheckRange(mh.SubsetOffset, mh.NumSubsets, sizeof(uint32_t), headerSize);
+
+        return mh;
+    }
+
+    DXUT::SDKMESH_SUBSET ReadSDKMESHSubset(const uint8_t* data, const DXUT::SDKMESH_HEADER& header, const DXUT::SDKMESH_MESH& mh, uint32_t index)
+    {
+        uint32_t subsetIndex;
+        memcpy(&subsetIndex, data + mh.SubsetOffset + index * sizeof(uint32_t), sizeof(subsetIndex));
+        if (subsetIndex >= header.NumTotalSubsets)
+            throw std::runtime_error("SDKMESH: invalid subset");
+
+        DXUT::SDKMESH_SUBSET subset;
+        memcpy(&subset, data + header.SubsetDataOffset + subsetIndex * sizeof(subset), sizeof(subset));
+        return subset;
+    }
+
+    // Computes the vertex range each part references.
+    void ComputeVertexRanges(ModelData& model)
+    {
+        for (auto& mesh : model.meshes)
+        {
+            for (auto& part : mesh.parts)
+            {
+                part.vertexStart = 0;
+                part.vertexCount = 0;
+
+                if (part.indexBuffer >= model.indexBuffers.size() || part.vertexBuffer >= model.vertexBuffers.size())
+                    continue;
+
+                auto const& indices = model.indexBuffers[part.indexBuffer].indices;
+                CheckRange(part.startIndex, part.indexCount, 1, indices.size());
+
+                if (!part.indexCount)
+                    continue;
+
+                auto const first = indices.cbegin() + static_cast<ptrdiff_t>(part.startIndex);
+                auto const range = std::minmax_element(first, first + static_cast<ptrdiff_t>(part.indexCount));
+
+                const int64_t lo = int64_t(*range.first) + part.vertexOffset;
+                const int64_t hi = int64_t(*range.second) + part.vertexOffset;
+                const int64_t vertexCount = int64_t(model.vertexBuffers[part.vertexBuffer].vertexCount);
+                if (lo < 0 || hi >= vertexCount)
+                    throw std::runtime_error("Index out of range of vertex buffer");
+
+                part.vertexStart = static_cast<uint32_t>(lo);
+                part.vertexCount = static_cast<uint32_t>(hi - lo + 1);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// SDKMESH
+//--------------------------------------------------------------------------------------
+std::unique_ptr<ModelData> ModelData::CreateFromSDKMESH(const uint8_t* data, size_t dataSize, bool lhcoords)
+{
+    return LoadSDKMESH(data, dataSize, lhcoords, true);
+}
+
+std::unique_ptr<ModelData> ModelData::CreateLayoutFromSDKMESH(const uint8_t* data, size_t dataSize, bool lhcoords)
+{
+    return LoadSDKMESH(data, dataSize, lhcoords, false);
+}
+
+std::unique_ptr<ModelData> ModelData::LoadSDKMESH(const uint8_t* data, size_t dataSize, bool lhcoords, bool geometry)
+{
+    using namespace DXUT;
+
+    uint64_t headerSize = 0;
+    const auto header = ReadSDKMESHHeader(data, dataSize, headerSize);
+
+    auto model = std::make_unique<ModelData>();
+    model->format = Format::SDKMESH;
+    model->version = header.Version;
+
+    // Vertex buffers
+    model->vertexBuffers.resize(header.NumVertexBuffers);
+    for (uint32_t j = 0; j < header.NumVertexBuffers; ++j)
+    {
+        SDKMESH_VERTEX_BUFFER_HEADER vh;
+        memcpy(&vh, data + header.VertexStreamHeadersOffset + j * sizeof(vh), sizeof(vh));
+
+        CheckRange(vh.DataOffset, 1, vh.SizeBytes, dataSize);
+        if (!vh.StrideBytes || vh.NumVertices > vh.SizeBytes / vh.StrideBytes)
+            throw std::runtime_error("SDKMESH: invalid vertex buffer");
+
+        auto& vb = model->vertexBuffers[j];
+        vb.vertexCount = static_cast<size_t>(vh.NumVertices);
+        vb.stride = static_cast<uint32_t>(vh.StrideBytes);
+        vb.skinned = IsSkinned(vh);
+        vb.fileRange = { vh.DataOffset, vh.SizeBytes };
+
+        const D3DVERTEXELEMENT9* position = nullptr;
+        const D3DVERTEXELEMENT9* normal = nullptr;
+        const D3DVERTEXELEMENT9* color = nullptr;
+
+        for (uint32_t e = 0; e < MAX_VERTEX_ELEMENTS; ++e)
+        {
+            auto const& decl = vh.Decl[e];
+            if (decl.Stream == 0xFF || decl.Type == D3DDECLTYPE_UNUSED)
+                break;
+
+            if (decl.Offset + GetFormatSize(decl.Type) > vb.stride)
+                throw std::runtime_error("SDKMESH: vertex element outside of stride");
+
+            vb.elements.push_back({ GetSemanticName(decl.Usage), decl.UsageIndex, decl.Offset, GetFormatName(decl.Type) });
+
+            if (decl.UsageIndex)
+                continue;
+
+            switch (decl.Usage)
+            {
+            case D3DDECLUSAGE_POSITION: position = &decl; break;
+            case D3DDECLUSAGE_NORMAL:   normal = &decl; break;
+            case D3DDECLUSAGE_COLOR:    color = &decl; break;
+            default: break;
+            }
+        }
+
+        if (!geometry)
+            continue;
+
+        const uint8_t* verts = data + vh.DataOffset;
+
+        if (position && position->Type == D3DDECLTYPE_FLOAT3)
+        {
+            vb.positions.resize(vb.vertexCount);
+            for (size_t v = 0; v < vb.vertexCount; ++v)
+            {
+                memcpy(&vb.positions[v], verts + v * vb.stride + position->Offset, sizeof(XMFLOAT3));
+            }
+        }
+
+        if (normal)
+        {
+            vb.normals.resize(vb.vertexCount);
+            for (size_t v = 0; v < vb.vertexCount; ++v)
+            {
+                if (!DecodeDirection(normal->Type, verts + v * vb.stride + normal->Offset, vb.normals[v]))
+                {
+                    vb.normals.clear();
+                    break;
+                }
+            }
+        }
+
+        if (color)
+        {
+            vb.colors.resize(vb.vertexCount);
+            for (size_t v = 0; v < vb.vertexCount; ++v)
+            {
+                if (!DecodeColor(color->Type, verts + v * vb.stride + color->Offset, vb.colors[v]))
+                {
+                    vb.colors.clear();
+                    break;
+                }
+            }
+        }
+    }
+
+    // Index buffers
+    model->indexBuffers.resize(header.NumIndexBuffers);
+    for (uint32_t j = 0; j < header.NumIndexBuffers; ++j)
+    {
+        SDKMESH_INDEX_BUFFER_HEADER ih;
+        memcpy(&ih, data + header.IndexStreamHeadersOffset + j * sizeof(ih), sizeof(ih));
+
+        const uint32_t indexSize = (ih.IndexType == IT_32BIT) ? 4u : 2u;
+        if (ih.IndexType != IT_16BIT && ih.IndexType != IT_32BIT)
+            throw std::runtime_error("SDKMESH: invalid index type");
+
+        CheckRange(ih.DataOffset, 1, ih.SizeBytes, dataSize);
+        if (ih.NumIndices > ih.SizeBytes / indexSize)
+            throw std::runtime_error("SDKMESH: invalid index buffer");
+
+        auto& ib = model->indexBuffers[j];
+        ib.indexSize = indexSize;
+        ib.fileRange = { ih.DataOffset, ih.SizeBytes };
+
+        if (!geometry)
+            continue;
+
+        ib.indices.resize(static_cast<size_t>(ih.NumIndices));
+
+        const uint8_t* indices = data + ih.DataOffset;
+        if (indexSize == 4)
+        {
+            memcpy(ib.indices.data(), indices, ib.indices.size() * sizeof(uint32_t));
+        }
+        else
+        {
+            for (size_t i = 0; i < ib.indices.size(); ++i)
+            {
+                uint16_t index;
+                memcpy(&index, indices + i * sizeof(uint16_t), sizeof(index));
+                ib.indices[i] = index;
+            }
+        }
+    }
+
+    // Materials
+    model->materials.resize(header.NumMaterials);
+    for (uint32_t j = 0; j < header.NumMaterials; ++j)
+    {
+        auto& mat = model->materials[j];
+        if (header.Version >= SDKMESH_FILE_VERSION_V2)
+        {
+            SDKMESH_MATERIAL_V2 mh;
+            memcpy(&mh, data + header.MaterialDataOffset + j * sizeof(mh), sizeof(mh));
+
+            mat.name = FixedString(mh.Name, MAX_MATERIAL_NAME);
+            mat.diffuseTexture = FixedString(mh.AlbedoTexture, MAX_TEXTURE_NAME);
+            mat.diffuse = XMFLOAT4(1.f, 1.f, 1.f, mh.Alpha);
+
+            AddTexture(mat, "albedo", FixedString(mh.AlbedoTexture, MAX_TEXTURE_NAME));
+            AddTexture(mat, "normal", FixedString(mh.NormalTexture, MAX_TEXTURE_NAME));
+            AddTexture(mat, "rma", FixedString(mh.RMATexture, MAX_TEXTURE_NAME));
+            AddTexture(mat, "emissive", FixedString(mh.EmissiveTexture, MAX_TEXTURE_NAME));
+            mat.emissive = XMFLOAT3(0.f, 0.f, 0.f);
+            mat.isAlpha = (mh.Alpha < 1.f);
+        }
+        else
+        {
+            SDKMESH_MATERIAL mh;
+            memcpy(&mh, data + header.MaterialDataOffset + j * sizeof(mh), sizeof(mh));
+
+            mat.name = FixedString(mh.Name, MAX_MATERIAL_NAME);
+            mat.diffuseTexture = FixedString(mh.DiffuseTexture, MAX_TEXTURE_NAME);
+            mat.diffuse = mh.Diffuse;
+
+            AddTexture(mat, "diffuse", FixedString(mh.DiffuseTexture, MAX_TEXTURE_NAME));
+            AddTexture(mat, "normal", FixedString(mh.NormalTexture, MAX_TEXTURE_NAME));
+            AddTexture(mat, "specular", FixedString(mh.SpecularTexture, MAX_TEXTURE_NAME));
+            mat.emissive = XMFLOAT3(mh.Emissive.x, mh.Emissive.y, mh.Emissive.z);
+            mat.isAlpha = (mh.Diffuse.w < 1.f);
+        }
+    }
+
+    // Meshes
+    model->meshes.resize(header.NumMeshes);
+    for (uint32_t j = 0; j < header.NumMeshes; ++j)
+    {
+        const auto mh = ReadSDKMESHMesh(data, header, j, headerSize);
+
+        auto& mesh = model->meshes[j];
+        mesh.name = FixedString(mh.Name, MAX_MESH_NAME);
+        mesh.ccw = lhcoords;
+        mesh.boundingBox.Center = mh.BoundingBoxCenter;
+        mesh.boundingBox.Extents = mh.BoundingBoxExtents;
+        BoundingSphere::CreateFromBoundingBox(mesh.boundingSphere, mesh.boundingBox);
+
+        mesh.parts.reserve(mh.NumSubsets);
+        for (uint32_t s = 0; s < mh.NumSubsets; ++s)
+        {
+            const auto subset = ReadSDKMESHSubset(data, header, mh, s);
+
+            Part part = {};
+            part.vertexBuffer = mh.VertexBuffers[0];
+            part.indexBuffer = mh.IndexBuffer;
+            part.material = (subset.MaterialID < header.NumMaterials) ? subset.MaterialID : None;
+            part.startIndex = static_cast<uint32_t>(subset.IndexStart);
+            part.indexCount = static_cast<uint32_t>(subset.IndexCount);
+            part.vertexOffset = static_cast<int32_t>(subset.VertexStart);
+            part.primitive = GetPrimitive(subset.PrimitiveType);
+
+            mesh.parts.push_back(part);
+        }
+    }
+
+    // Frames
+    model->frames.resize(header.NumFrames);
+    for (uint32_t j = 0; j < header.NumFrames; ++j)
+    {
+        SDKMESH_FRAME fh;
+        memcpy(&fh, data + header.FrameDataOffset + j * sizeof(fh), sizeof(fh));
+
+        auto& frame = model->frames[j];
+        frame.name = FixedString(fh.Name, MAX_FRAME_NAME);
+        frame.mesh = (fh.Mesh < header.NumMeshes) ? fh.Mesh : None;
+        frame.parent = (fh.ParentFrame < header.NumFrames) ? fh.ParentFrame : None;
+        frame.child = (fh.ChildFrame < header.NumFrames) ? fh.ChildFrame : None;
+        frame.sibling = (fh.SiblingFrame < header.NumFrames) ? fh.SiblingFrame : None;
+        frame.matrix = fh.Matrix;
+    }
+
+    if (geometry)
+    {
+        ComputeVertexRanges(*model);
+    }
+
+    return model;
+}
+
+//--------------------------------------------------------------------------------------
+// CMO (Visual Studio Starter Kit)
+//--------------------------------------------------------------------------------------
+namespace
+{
+#pragma pack(push,1)
+    struct CMOMaterial
+    {
+        XMFLOAT4    Ambient;
+        XMFLOAT4    Diffuse;
+        XMFLOAT4    Specular;
+        float       SpecularPower;
+        XMFLOAT4    Emissive;
+        XMFLOAT4X4  UVTransform;
+    };
+
+    struct CMOSubMesh
+    {
+        uint32_t MaterialIndex;
+        uint32_t IndexBufferIndex;
+        uint32_t VertexBufferIndex;
+        uint32_t StartIndex;
+        uint32_t PrimCount;
+    };
+
+    struct CMOVertex
+    {
+        XMFLOAT3    Position;
+        XMFLOAT3    Normal;
+        XMFLOAT4    Tangent;
+        uint32_t    Color;
+        XMFLOAT2    TextureCoordinates;
+    };
+
+    struct CMOMeshExtents
+    {
+        float CenterX, CenterY, CenterZ;
+        float Radius;
+
+        float MinX, MinY, MinZ;
+        float MaxX, MaxY, MaxZ;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(CMOMaterial) == 132, "CMO structure size incorrect");
+    static_assert(sizeof(CMOSubMesh) == 20, "CMO structure size incorrect");
+    static_assert(sizeof(CMOVertex) == 52, "CMO structure size incorrect");
+    static_assert(sizeof(CMOMeshExtents) == 40, "CMO structure size incorrect");
+
+    constexpr size_t c_CMOTextures = 8;
+
+    // Slot usage as assigned by Model::CreateFromCMO; the rest are only passed to the shader.
+    const char* c_CMOTextureUsage[c_CMOTextures] =
+    {
+        "diffuse", "specular", "normal", "texture3", "texture4", "texture5", "texture6", "texture7"
+    };
+    constexpr size_t c_CMOSkinningVertexSize = 32;
+    constexpr size_t c_CMOBoneSize = sizeof(int32_t) + 3 * sizeof(XMFLOAT4X4);
+    constexpr size_t c_CMOKeyframeSize = 2 * sizeof(uint32_t) + sizeof(XMFLOAT4X4);
+}
+
+std::unique_ptr<ModelData> ModelData::CreateFromCMO(const uint8_t* data, size_t dataSize, bool lhcoords)
+{
+    if (!data)
+        throw std::runtime_error("CMO: no data");
+
+    BinaryReader reader(data, dataSize);
+
+    auto model = std::make_unique<ModelData>();
+    model->format = Format::CMO;
+
+    const auto nMesh = reader.Read<uint32_t>();
+    if (!nMesh)
+        throw std::runtime_error("CMO: no meshes");
+
+    model->meshes.resize(nMesh);
+    for (uint32_t meshIndex = 0; meshIndex < nMesh; ++meshIndex)
+    {
+        auto& mesh = model->meshes[meshIndex];
+        mesh.name = reader.ReadString();
+        mesh.ccw = !lhcoords;
+
+        // Materials
+        const auto materialBase = static_cast<uint32_t>(model->materials.size());
+        const auto nMats = reader.Read<uint32_t>();
+        for (uint32_t j = 0; j < nMats; ++j)
+        {
+            Material mat = {};
+            mat.name = reader.ReadString();
+
+            const auto cm = reader.Read<CMOMaterial>();
+            mat.diffuse = cm.Diffuse;
+            mat.emissive = XMFLOAT3(cm.Emissive.x, cm.Emissive.y, cm.Emissive.z);
+            mat.isAlpha = (cm.Diffuse.w < 1.f);
+
+            std::ignore = reader.ReadString(); // pixel shader
+            for (size_t t = 0; t < c_CMOTextures; ++t)
+            {
+                auto texture = reader.ReadString();
+                if (!t)
+                    mat.diffuseTexture = texture;
+
+                AddTexture(mat, c_CMOTextureUsage[t], std::move(texture));
+            }
+
+            model->materials.emplace_back(std::move(mat));
+        }
+
+        const bool skeleton = reader.Read<uint8_t>() != 0;
+
+        // Submeshes
+        const auto nSubmesh = reader.Read<uint32_t>();
+        auto subMeshes = reader.Read(nSubmesh, sizeof(CMOSubMesh));
+
+        // Index buffers
+        const auto ibBase = static_cast<uint32_t>(model->indexBuffers.size());
+        const auto nIBs = reader.Read<uint32_t>();
+        for (uint32_t j = 0; j < nIBs; ++j)
+        {
+            const auto nIndexes = reader.Read<uint32_t>();
+            auto indices = reader.Read(nIndexes, sizeof(uint16_t));
+
+            IndexBuffer ib = {};
+            ib.indexSize = 2;
+            ib.indices.resize(nIndexes);
+            for (uint32_t i = 0; i < nIndexes; ++i)
+            {
+                uint16_t index;
+                memcpy(&index, indices + i * sizeof(uint16_t), sizeof(index));
+                ib.indices[i] = index;
+            }
+            model->indexBuffers.emplace_back(std::move(ib));
+        }
+
+        // Vertex buffers
+        const auto vbBase = static_cast<uint32_t>(model->vertexBuffers.size());
+        const auto nVBs = reader.Read<uint32_t>();
+        for (uint32_t j = 0; j < nVBs; ++j)
+        {
+            const auto nVerts = reader.Read<uint32_t>();
+            auto verts = reader.Read(nVerts, sizeof(CMOVertex));
+
+            VertexBuffer vb = {};
+            vb.vertexCount = nVerts;
+            vb.stride = sizeof(CMOVertex);
+            vb.elements =
+            {
+                { "SV_Position", 0, 0, "R32G32B32_FLOAT" },
+                { "NORMAL", 0, 12, "R32G32B32_FLOAT" },
+                { "TANGENT", 0, 24, "R32G32B32A32_FLOAT" },
+                { "COLOR", 0, 40, "R8G8B8A8_UNORM" },
+                { "TEXCOORD", 0, 44, "R32G32_FLOAT" },
+            };
+            vb.positions.resize(nVerts);
+            vb.normals.resize(nVerts);
+            vb.colors.resize(nVerts);
+            for (uint32_t v = 0; v < nVerts; ++v)
+            {
+                CMOVertex vertex;
+                memcpy(&vertex, verts + v * sizeof(CMOVertex), sizeof(vertex));
+                vb.positions[v] = vertex.Position;
+                vb.normals[v] = vertex.Normal;
+                vb.colors[v] = vertex.Color;
+            }
+            model->vertexBuffers.emplace_back(std::move(vb));
+        }
+
+        // Skinning vertex buffers
+        if (skeleton)
+        {
+            const auto nSkinVBs = reader.Read<uint32_t>();
+            for (uint32_t j = 0; j < nSkinVBs; ++j)
+            {
+                const auto nVerts = reader.Read<uint32_t>();
+                std::ignore = reader.Read(nVerts, c_CMOSkinningVertexSize);
+            }
+
+            for (size_t j = vbBase; j < model->vertexBuffers.size() && nSkinVBs > 0; ++j)
+            {
+                model->vertexBuffers[j].skinned = true;
+            }
+        }
+
+        // Extents
+        const auto extents = reader.Read<CMOMeshExtents>();
+        mesh.boundingSphere.Center = XMFLOAT3(extents.CenterX, extents.CenterY, extents.CenterZ);
+        mesh.boundingSphere.Radius = extents.Radius;
+
+        const XMVECTOR minv = XMVectorSet(extents.MinX, extents.MinY, extents.MinZ, 0.f);
+        const XMVECTOR maxv = XMVectorSet(extents.MaxX, extents.MaxY, extents.MaxZ, 0.f);
+        BoundingBox::CreateFromPoints(mesh.boundingBox, minv, maxv);
+
+        // Bones and animation clips
+        if (skeleton)
+        {
+            const auto nBones = reader.Read<uint32_t>();
+            for (uint32_t j = 0; j < nBones; ++j)
+            {
+                std::ignore = reader.ReadString();
+                std::ignore = reader.Read(1, c_CMOBoneSize);
+            }
+
+            const auto nClips = reader.Read<uint32_t>();
+            for (uint32_t j = 0; j < nClips; ++j)
+            {
+                std::ignore = reader.ReadString();
+                std::ignore = reader.Read(2, sizeof(float));
+                const auto nKeys = reader.Read<uint32_t>();
+                std::ignore = reader.Read(nKeys, c_CMOKeyframeSize);
+            }
+        }
+
+        // Parts
+        mesh.parts.reserve(nSubmesh);
+        for (uint32_t j = 0; j < nSubmesh; ++j)
+        {
+            CMOSubMesh sm;
+            memcpy(&sm, subMeshes + j * sizeof(CMOSubMesh), sizeof(sm));
+
+            if (sm.IndexBufferIndex >= nIBs || sm.VertexBufferIndex >= nVBs)
+                throw std::runtime_error("CMO: invalid submesh");
+
+            Part part = {};
+            part.vertexBuffer = vbBase + sm.VertexBufferIndex;
+            part.indexBuffer = ibBase + sm.IndexBufferIndex;
+            part.material = (sm.MaterialIndex < nMats) ? materialBase + sm.MaterialIndex : None;
+            part.primitive = Primitive::TriangleList;
+            part.startIndex = sm.StartIndex;
+            part.indexCount = sm.PrimCount * 3;
+            mesh.parts.push_back(part);
+        }
+    }
+
+    ComputeVertexRanges(*model);
+
+    return model;
+}
+
+//--------------------------------------------------------------------------------------
+// VBO
+//--------------------------------------------------------------------------------------
+namespace
+{
+#pragma pack(push,1)
+    struct VBOHeader
+    {
+        uint32_t numVertices;
+        uint32_t numIndices;
+    };
+
+    struct VBOVertex
+    {
+        XMFLOAT3 position;
+        XMFLOAT3 normal;
+        XMFLOAT2 textureCoordinate;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(VBOHeader) == 8, "VBO header size mismatch");
+    static_assert(sizeof(VBOVertex) == 32, "VBO vertex size mismatch");
+}
+
+std::unique_ptr<ModelData> ModelData::CreateFromVBO(const uint8_t* data, size_t dataSize, bool lhcoords)
+{
+    if (!data)
+        throw std::runtime_error("VBO: no data");
+
+    BinaryReader reader(data, dataSize);
+
+    const auto header = reader.Read<VBOHeader>();
+    if (!header.numVertices || !header.numIndices)
+        throw std::runtime_error("VBO: empty mesh");
+
+    auto verts = reader.Read(header.numVertices, sizeof(VBOVertex));
+    auto indices = reader.Read(header.numIndices, sizeof(uint16_t));
+
+    auto model = std::make_unique<ModelData>();
+    model->format = Format::VBO;
+
+    VertexBuffer vb = {};
+    vb.vertexCount = header.numVertices;
+    vb.stride = sizeof(VBOVertex);
+    vb.elements =
+    {
+        { "SV_Position", 0, 0, "R32G32B32_FLOAT" },
+        { "NORMAL", 0, 12, "R32G32B32_FLOAT" },
+        { "TEXCOORD", 0, 24, "R32G32_FLOAT" },
+    };
+    vb.positions.resize(header.numVertices);
+    vb.normals.resize(header.numVertices);
+    for (uint32_t v = 0; v < header.numVertices; ++v)
+    {
+        VBOVertex vertex;
+        memcpy(&vertex, verts + v * sizeof(VBOVertex), sizeof(vertex));
+        vb.positions[v] = vertex.position;
+        vb.normals[v] = vertex.normal;
+    }
+
+    IndexBuffer ib = {};
+    ib.indexSize = 2;
+    ib.indices.resize(header.numIndices);
+    for (uint32_t i = 0; i < header.numIndices; ++i)
+    {
+        uint16_t index;
+        memcpy(&index, indices + i * sizeof(uint16_t), sizeof(index));
+        ib.indices[i] = index;
+    }
+
+    Mesh mesh;
+    mesh.ccw = lhcoords;
+    BoundingSphere::CreateFromPoints(mesh.boundingSphere, vb.positions.size(), vb.positions.data(), sizeof(XMFLOAT3));
+    BoundingBox::CreateFromPoints(mesh.boundingBox, vb.positions.size(), vb.positions.data(), sizeof(XMFLOAT3));
+
+    Part part = {};
+    part.material = None;
+    part.primitive = Primitive::TriangleList;
+    part.indexCount = header.numIndices;
+    mesh.parts.push_back(part);
+
+    model->vertexBuffers.emplace_back(std::move(vb));
+    model->indexBuffers.emplace_back(std::move(ib));
+    model->meshes.emplace_back(std::move(mesh));
+
+    ComputeVertexRanges(*model);
+
+    return model;
+}
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+    bool ExtensionEquals(const wchar_t* a, const wchar_t* b) noexcept
+    {
+        for (; *a && *b; ++a, ++b)
+        {
+            if (std::towlower(static_cast<wint_t>(*a)) != std::towlower(static_cast<wint_t>(*b)))
+                return false;
+        }
+        return *a == *b;
+    }
+}
+
+std::unique_ptr<ModelData> ModelData::CreateFromMemory(const uint8_t* data, size_t dataSize, const wchar_t* extension, bool lhcoords)
+{
+    if (!extension)
+        throw std::invalid_argument("CreateFromMemory");
+
+    if (ExtensionEquals(extension, L".sdkmesh"))
+        return CreateFromSDKMESH(data, dataSize, lhcoords);
+
+    if (ExtensionEquals(extension, L".cmo"))
+        return CreateFromCMO(data, dataSize, lhcoords);
+
+    if (ExtensionEquals(extension, L".vbo"))
+        return CreateFromVBO(data, dataSize, lhcoords);
+
+    throw std::runtime_error("Unknown file type");
+}
+
+bool ModelData::IsSupportedExtension(const wchar_t* extension) noexcept
+{
+    return extension
+        && (ExtensionEquals(extension, L".sdkmesh") || ExtensionEquals(extension, L".cmo") || ExtensionEquals(extension, L".vbo"));
+}
+
+void ModelData::GetBounds(BoundingSphere& sphere, BoundingBox& box) const noexcept
+{
+    sphere = BoundingSphere();
+    box = BoundingBox();
+
+    for (auto it = meshes.cbegin(); it != meshes.cend(); ++it)
+    {
+        if (it == meshes.cbegin())
+        {
+            sphere = it->boundingSphere;
+            box = it->boundingBox;
+        }
+        else
+        {
+            BoundingSphere::CreateMerged(sphere, sphere, it->boundingSphere);
+            BoundingBox::CreateMerged(box, box, it->boundingBox);
+        }
+    }
+}
+
+ModelData::Statistics ModelData::GetStatistics() const
+{
+    Statistics stats = {};
+    stats.meshes = meshes.size();
+    stats.vertexBuffers = vertexBuffers.size();
+    stats.indexBuffers = indexBuffers.size();
+
+    std::vector<uint8_t> counted(vertexBuffers.size(), 0);
+    for (auto const& mesh : meshes)
+    {
+        for (auto const& part : mesh.parts)
+        {
+            CountPart(stats, part.primitive, part.indexCount);
+
+            if (part.vertexBuffer < vertexBuffers.size() && !counted[part.vertexBuffer])
+            {
+                counted[part.vertexBuffer] = 1;
+                stats.vertices += vertexBuffers[part.vertexBuffer].vertexCount;
+                stats.skinned |= vertexBuffers[part.vertexBuffer].skinned;
+            }
+        }
+    }
+
+    return stats;
+}
+
+//--------------------------------------------------------------------------------------
+// Statistics straight from the file. Each pass is linear in the number of buffers, meshes,
+// and parts, and touches none of the vertex or index data.
+//--------------------------------------------------------------------------------------
+namespace
+{
+    ModelData::Statistics ReadSDKMESHStatistics(const uint8_t* data, size_t dataSize)
+    {
+        using namespace DXUT;
+
+        uint64_t headerSize = 0;
+        const auto header = ReadSDKMESHHeader(data, dataSize, headerSize);
+
+        ModelData::Statistics stats = {};
+        stats.meshes = header.NumMeshes;
+        stats.vertexBuffers = header.NumVertexBuffers;
+        stats.indexBuffers = header.NumIndexBuffers;
+
+        std::vector<uint8_t> used(header.NumVertexBuffers, 0);
+        for (uint32_t j = 0; j < header.NumMeshes; ++j)
+        {
+            const auto mh = ReadSDKMESHMesh(data, header, j, headerSize);
+
+            for (uint32_t s = 0; s < mh.NumSubsets; ++s)
+            {
+                const auto subset = ReadSDKMESHSubset(data, header, mh, s);
+                CountPart(stats, GetPrimitive(subset.PrimitiveType), static_cast<size_t>(subset.IndexCount));
+                used[mh.VertexBuffers[0]] = 1;
+            }
+        }
+
+        for (uint32_t j = 0; j < header.NumVertexBuffers; ++j)
+        {
+            if (!used[j])
+                continue;
+
+            SDKMESH_VERTEX_BUFFER_HEADER vh;
+            memcpy(&vh, data + header.VertexStreamHeadersOffset + j * sizeof(vh), sizeof(vh));
+
+            if (!vh.StrideBytes || vh.NumVertices > vh.SizeBytes / vh.StrideBytes)
+                throw std::runtime_error("SDKMESH: invalid vertex buffer");
+
+            stats.vertices += static_cast<size_t>(vh.NumVertices);
+            stats.skinned |= IsSkinned(vh);
+        }
+
+        return stats;
+    }
+
+    ModelData::Statistics ReadCMOStatistics(const uint8_t* data, size_t dataSize)
+    {
+        if (!data)
+            throw std::runtime_error("CMO: no data");
+
+        BinaryReader reader(data, dataSize);
+
+        const auto nMesh = reader.Read<uint32_t>();
+        if (!nMesh)
+            throw std::runtime_error("CMO: no meshes");
+
+        ModelData::Statistics stats = {};
+        stats.meshes = nMesh;
+
+        std::vector<uint32_t> vertexCounts;
+        std::vector<uint8_t> used;
+        for (uint32_t meshIndex = 0; meshIndex < nMesh; ++meshIndex)
+        {
+            reader.SkipString();
+
+            const auto nMats = reader.Read<uint32_t>();
+            for (uint32_t j = 0; j < nMats; ++j)
+            {
+                reader.SkipString();
+                std::ignore = reader.Read(1, sizeof(CMOMaterial));
+                reader.SkipString();
+                for (size_t t = 0; t < c_CMOTextures; ++t)
+                {
+                    reader.SkipString();
+                }
+            }
+
+            const bool skeleton = reader.Read<uint8_t>() != 0;
+
+            const auto nSubmesh = reader.Read<uint32_t>();
+            auto subMeshes = reader.Read(nSubmesh, sizeof(CMOSubMesh));
+
+            const auto nIBs = reader.Read<uint32_t>();
+            for (uint32_t j = 0; j < nIBs; ++j)
+            {
+                const auto nIndexes = reader.Read<uint32_t>();
+                std::ignore = reader.Read(nIndexes, sizeof(uint16_t));
+            }
+            stats.indexBuffers += nIBs;
+
+            const auto nVBs = reader.Read<uint32_t>();
+            vertexCounts.resize(nVBs);
+            for (uint32_t j = 0; j < nVBs; ++j)
+            {
+                vertexCounts[j] = reader.Read<uint32_t>();
+                std::ignore = reader.Read(vertexCounts[j], sizeof(CMOVertex));
+            }
+            stats.vertexBuffers += nVBs;
+
+            bool skinned = false;
+            if (skeleton)
+            {
+                const auto nSkinVBs = reader.Read<uint32_t>();
+                for (uint32_t j = 0; j < nSkinVBs; ++j)
+                {
+                    const auto nVerts = reader.Read<uint32_t>();
+                    std::ignore = reader.Read(nVerts, c_CMOSkinningVertexSize);
+                }
+                skinned = (nSkinVBs > 0);
+            }
+
+            std::ignore = reader.Read<CMOMeshExtents>();
+
+            if (skeleton)
+            {
+                const auto nBones = reader.Read<uint32_t>();
+                for (uint32_t j = 0; j < nBones; ++j)
+                {
+                    reader.SkipString();
+                    std::ignore = reader.Read(1, c_CMOBoneSize);
+                }
+
+                const auto nClips = reader.Read<uint32_t>();
+                for (uint32_t j = 0; j < nClips; ++j)
+                {
+                    reader.SkipString();
+                    std::ignore = reader.Read(2, sizeof(float));
+                    const auto nKeys = reader.Read<uint32_t>();
+                    std::ignore = reader.Read(nKeys, c_CMOKeyframeSize);
+                }
+            }
+
+            used.assign(nVBs, 0);
+            for (uint32_t j = 0; j < nSubmesh; ++j)
+            {
+                CMOSubMesh sm;
+                memcpy(&sm, subMeshes + j * sizeof(CMOSubMesh), sizeof(sm));
+
+                if (sm.IndexBufferIndex >= nIBs || sm.VertexBufferIndex >= nVBs)
+                    throw std::runtime_error("CMO: invalid submesh");
+
+                CountPart(stats, ModelData::Primitive::TriangleList, size_t(sm.PrimCount) * 3);
+
+                if (!used[sm.VertexBufferIndex])
+                {
+                    used[sm.VertexBufferIndex] = 1;
+                    stats.vertices += vertexCounts[sm.VertexBufferIndex];
+                    stats.skinned |= skinned;
+                }
+            }
+        }
+
+        return stats;
+    }
+
+    ModelData::Statistics ReadVBOStatistics(const uint8_t* data, size_t dataSize)
+    {
+        if (!data)
+            throw std::runtime_error("VBO: no data");
+
+        BinaryReader reader(data, dataSize);
+
+        const auto header = reader.Read<VBOHeader>();
+        if (!header.numVertices || !header.numIndices)
+            throw std::runtime_error("VBO: empty mesh");
+
+        std::ignore = reader.Read(header.numVertices, sizeof(VBOVertex));
+        std::ignore = reader.Read(header.numIndices, sizeof(uint16_t));
+
+        ModelData::Statistics stats = {};
+        stats.meshes = 1;
+        stats.vertexBuffers = 1;
+        stats.indexBuffers = 1;
+        stats.vertices = header.numVertices;
+        CountPart(stats, ModelData::Primitive::TriangleList, header.numIndices);
+        return stats;
+    }
+}
+
+ModelData::Statistics ModelData::ReadStatistics(const uint8_t* data, size_t dataSize, const wchar_t* extension)
+{
+    if (!extension)
+        throw std::invalid_argument("ReadStatistics");
+
+    if (ExtensionEquals(extension, L".sdkmesh"))
+        return ReadSDKMESHStatistics(data, dataSize);
+
+    if (ExtensionEquals(extension, L".cmo"))
+        return ReadCMOStatistics(data, dataSize);
+
+    if (ExtensionEquals(extension, L".vbo"))
+        return ReadVBOStatistics(data, dataSize);
+
+    throw std::runtime_error("Unknown file type");
+}
+
+void ModelData::ComputeFrameTransforms(XMFLOAT4X4* transforms, size_t count) const
+{
+    if (count < frames.size() || (!transforms && !frames.empty()))
+        throw std::invalid_argument("Frame transform array is too small");
+
+    const size_t frameCount = frames.size();
+
+    // Walks down from each root with an explicit stack, so deep hierarchies can't overflow
+    // and malformed links can't loop.
+    std::vector<uint8_t> visited(frameCount, 0);
+    std::vector<std::pair<uint32_t, uint32_t>> stack;  // Frame and its parent, or None
+
+    for (size_t root = 0; root < frameCount; ++root)
+    {
+        if (frames[root].parent != None || visited[root])
+            continue;
+
+        stack.emplace_back(static_cast<uint32_t>(root), uint32_t(None));
+        while (!stack.empty())
+        {
+            const uint32_t index = stack.back().first;
+            const uint32_t parent = stack.back().second;
+            stack.pop_back();
+
+            if (visited[index])
+                continue;
+            visited[index] = 1;
+
+            auto const& frame = frames[index];
+            XMMATRIX local = XMLoadFloat4x4(&frame.matrix);
+            if (parent != None)
+            {
+                local = XMMatrixMultiply(local, XMLoadFloat4x4(&transforms[parent]));
+            }
+            XMStoreFloat4x4(&transforms[index], local);
+
+            size_t siblings = 0;
+            for (uint32_t child = frame.child; child < frameCount && siblings < frameCount; child = frames[child].sibling, ++siblings)
+            {
+                if (!visited[child])
+                {
+                    stack.emplace_back(child, index);
+                }
+            }
+        }
+    }
+
+    // Frames that no root reaches keep their own matrix.
+    for (size_t j = 0; j < frameCount; ++j)
+    {
+        if (!visited[j])
+        {
+            transforms[j] = frames[j].matrix;
+        }
+    }
+}
+
+size_t ModelData::GetPrimitiveCount(Primitive primitive, size_t indexCount) noexcept
+{
+    switch (primitive)
+    {
+    case Primitive::TriangleList:   return indexCount / 3;
+    case Primitive::TriangleStrip:  return (indexCount >= 3) ? (indexCount - 2) : 0;
+    case Primitive::LineList:       return indexCount / 2;
+    case Primitive::LineStrip:      return (indexCount >= 2) ? (indexCount - 1) : 0;
+    case Primitive::PointList:      return indexCount;
+    default:                        return 0;
+    }
+}
+
+size_t ModelData::GetTriangleCount() const noexcept
+{
+    size_t count = 0;
+    for (auto const& mesh : meshes)
+    {
+        for (auto const& part : mesh.parts)
+        {
+            if (part.primitive == Primitive::TriangleList || part.primitive == Primitive::TriangleStrip)
+                count += GetPrimitiveCount(part);
+        }
+    }
+    return count;
+}
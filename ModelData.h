@@ -0,0 +1,205 @@
+//--------------------------------------------------------------------------------------
+// File: ModelData.h
+//
+// CPU-side copy of the geometry in a .sdkmesh, .cmo, or .vbo file. Unlike DirectX::Model
+// this needs no Direct3D device, so it can be used by the headless renderer and tools.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace DX
+{
+    class ModelData
+    {
+    public:
+        static constexpr uint32_t None = UINT32_MAX;
+
+        enum class Format : uint32_t
+        {
+            SDKMESH,
+            CMO,
+            VBO,
+        };
+
+        enum class Primitive : uint32_t
+        {
+            TriangleList,
+            TriangleStrip,
+            LineList,
+            LineStrip,
+            PointList,
+            Unsupported,
+        };
+
+        struct VertexElement
+        {
+            const char*         semantic;
+            uint32_t            semanticIndex;
+            uint32_t            offset;
+            const char*         format;
+        };
+
+        // Where a buffer's data lies in the file; SDKMESH only, zero for other formats.
+        struct FileRange
+        {
+            uint64_t                        offset;
+            uint64_t                        size;
+        };
+
+        struct VertexBuffer
+        {
+            size_t                          vertexCount;
+            uint32_t                        stride;
+            std::vector<VertexElement>      elements;
+            std::vector<DirectX::XMFLOAT3>  positions;
+            std::vector<DirectX::XMFLOAT3>  normals;        // Empty if the vertex format has no normals
+            std::vector<uint32_t>           colors;         // RGBA8 with R in the low byte; empty if none
+            bool                            skinned;        // Has bone indices and weights
+            FileRange                       fileRange;
+        };
+
+        struct IndexBuffer
+        {
+            std::vector<uint32_t>           indices;
+            uint32_t                        indexSize;      // Bytes per index in the file (2 or 4)
+            FileRange                       fileRange;
+        };
+
+        struct MaterialTexture
+        {
+            const char*                     usage;          // "diffuse", "normal", etc.
+            std::string                     file;
+        };
+
+        struct Material
+        {
+            std::string                     name;
+            std::string                     diffuseTexture;
+            std::vector<MaterialTexture>    textures;       // Every non-empty texture slot, in file order
+            DirectX::XMFLOAT4               diffuse;        // Alpha is opacity
+            DirectX::XMFLOAT3               emissive;
+            bool                            isAlpha;
+        };
+
+        struct Part
+        {
+            uint32_t                        vertexBuffer;
+            uint32_t                        indexBuffer;
+            uint32_t                        material;       // None if the part has no material
+            Primitive                       primitive;
+            uint32_t                        startIndex;
+            uint32_t                        indexCount;
+            int32_t                         vertexOffset;   // Added to each index, as with DrawIndexed
+            uint32_t                        vertexStart;    // Range of vertices referenced (after vertexOffset)
+            uint32_t                        vertexCount;
+        };
+
+        struct Mesh
+        {
+            std::string                     name;
+            std::vector<Part>               parts;
+            DirectX::BoundingSphere         boundingSphere;
+            DirectX::BoundingBox            boundingBox;
+            bool                            ccw;
+        };
+
+        struct Frame
+        {
+            std::string                     name;
+            uint32_t                        mesh;           // Indices are None when not present
+            uint32_t                        parent;
+            uint32_t                        child;
+            uint32_t                        sibling;
+            DirectX::XMFLOAT4X4             matrix;
+        };
+
+        // The counts shown in the viewer's HUD. Primitives are counted by each part's
+        // topology, so a strip of n indices is n - 2 triangles.
+        struct Statistics
+        {
+            size_t                          meshes;
+            size_t                          subsets;
+            size_t                          vertexBuffers;
+            size_t                          indexBuffers;
+            size_t                          vertices;       // Summed over vertex buffers used by any part
+            size_t                          indices;        // Summed over every part
+            size_t                          triangles;      // From triangle lists and strips
+            size_t                          lines;          // From line lists and strips
+            size_t                          points;
+            size_t                          unsupportedSubsets;
+            bool                            skinned;        // A part uses a vertex buffer with bone weights
+        };
+
+        Format                              format;
+        uint32_t                            version;
+        std::vector<VertexBuffer>           vertexBuffers;
+        std::vector<IndexBuffer>            indexBuffers;
+        std::vector<Material>               materials;
+        std::vector<Mesh>                   meshes;
+        std::vector<Frame>                  frames;
+
+        ModelData() noexcept :
+            format(Format::SDKMESH),
+            version(0)
+        {
+        }
+
+        ModelData(ModelData&&) = default;
+        ModelData& operator= (ModelData&&) = default;
+
+        ModelData(ModelData const&) = delete;
+        ModelData& operator= (ModelData const&) = delete;
+
+        // The loaders throw std::runtime_error for malformed files. 'lhcoords' matches the
+        // viewer's handedness setting, which determines each mesh's winding order.
+        static std::unique_ptr<ModelData> CreateFromSDKMESH(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, bool lhcoords = true);
+        static std::unique_ptr<ModelData> CreateFromCMO(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, bool lhcoords = true);
+        static std::unique_ptr<ModelData> CreateFromVBO(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, bool lhcoords = true);
+
+        // Everything but the vertex and index data, for streaming it later: vertex buffers
+        // have their counts, stride, elements, and file ranges but no positions, normals, or
+        // colors, index buffers have no indices, and parts have no vertex ranges. Only the
+        // headers are read, so 'data' can be a mapping of a file larger than memory.
+        static std::unique_ptr<ModelData> CreateLayoutFromSDKMESH(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, bool lhcoords = true);
+
+        // Chooses the loader from a file extension such as L".sdkmesh" (case-insensitive).
+        static std::unique_ptr<ModelData> CreateFromMemory(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize,
+            _In_z_ const wchar_t* extension, bool lhcoords = true);
+
+        static bool IsSupportedExtension(_In_z_ const wchar_t* extension) noexcept;
+
+        // Merged bounds of all meshes.
+        void GetBounds(DirectX::BoundingSphere& sphere, DirectX::BoundingBox& box) const noexcept;
+
+        Statistics GetStatistics() const;
+
+        // Same as GetStatistics() on the loaded file, but reads only the headers and part
+        // tables rather than decoding the geometry. Throws std::runtime_error for malformed
+        // files or an unknown extension.
+        static Statistics ReadStatistics(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, _In_z_ const wchar_t* extension);
+
+        // Absolute transform of each frame, its matrix times those of its parents, as with
+        // Model::CopyAbsoluteBoneTransforms. 'count' must be at least frames.size().
+        void ComputeFrameTransforms(_Out_writes_(count) DirectX::XMFLOAT4X4* transforms, size_t count) const;
+
+        static size_t GetPrimitiveCount(Primitive primitive, size_t indexCount) noexcept;
+        static size_t GetPrimitiveCount(const Part& part) noexcept { return GetPrimitiveCount(part.primitive, part.indexCount); }
+        size_t GetTriangleCount() const noexcept;
+
+    private:
+        static std::unique_ptr<ModelData> LoadSDKMESH(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, bool lhcoords, bool geometry);
+    };
+}
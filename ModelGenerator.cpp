@@ -0,0 +1,527 @@
+//--------------------------------------------------------------------------------------
+// File: ModelGenerator.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <dxgiformat.h>
+#else
+#include <wsl/winadapter.h>
+#include <directx/dxgiformat.h>
+#ifndef MAX_PATH
+#define MAX_PATH 260
+#endif
+#endif
+
+#include "ModelGenerator.h"
+#include "SDKMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    using VertexFormat = SyntheticModelDesc::VertexFormat;
+
+    // Spacing of the meshes along the x axis.
+    constexpr float c_MeshSpacing = 2.5f;
+
+    constexpr size_t c_MaxVBOVertices = 65536;
+
+    struct VertexLayout
+    {
+        uint32_t                                stride;
+        std::vector<DXUT::D3DVERTEXELEMENT9>    elements;
+    };
+
+    VertexLayout GetVertexLayout(VertexFormat format)
+    {
+        using namespace DXUT;
+
+        VertexLayout layout = {};
+        auto add = [&](uint8_t type, uint8_t usage, uint32_t size)
+        {
+            D3DVERTEXELEMENT9 element = {};
+            element.Stream = 0;
+            element.Offset = static_cast<uint16_t>(layout.stride);
+            element.Type = type;
+            element.Usage = usage;
+            layout.elements.push_back(element);
+            layout.stride += size;
+        };
+
+        add(D3DDECLTYPE_FLOAT3, D3DDECLUSAGE_POSITION, 12);
+        add(D3DDECLTYPE_FLOAT3, D3DDECLUSAGE_NORMAL, 12);
+
+        switch (format)
+        {
+        case VertexFormat::PositionNormalColorTexture:
+            add(D3DDECLTYPE_D3DCOLOR, D3DDECLUSAGE_COLOR, 4);
+            break;
+
+        case VertexFormat::PositionNormalTangentTexture:
+            add(D3DDECLTYPE_FLOAT4, D3DDECLUSAGE_TANGENT, 16);
+            break;
+
+        case VertexFormat::Skinned:
+            add(D3DDECLTYPE_UBYTE4, D3DDECLUSAGE_BLENDINDICES, 4);
+            add(D3DDECLTYPE_UBYTE4N, D3DDECLUSAGE_BLENDWEIGHT, 4);
+            break;
+
+        default:
+            break;
+        }
+
+        if (format != VertexFormat::PositionNormal)
+        {
+            add(D3DDECLTYPE_FLOAT2, D3DDECLUSAGE_TEXCOORD, 8);
+        }
+
+        return layout;
+    }
+
+    // Tessellation of one mesh: 'columns' quads around, 'rowsPerSubset' quads per band.
+    struct SphereGrid
+    {
+        uint32_t    columns;
+        uint32_t    rowsPerSubset;
+        uint32_t    rows;
+
+        size_t GetVertexCount() const noexcept { return size_t(rows + 1) * size_t(columns + 1); }
+        size_t GetIndexCount() const noexcept { return size_t(rows) * size_t(columns) * 6; }
+    };
+
+    SphereGrid GetSphereGrid(uint32_t subsets, uint32_t trianglesPerSubset) noexcept
+    {
+        const double quads = std::max(double(trianglesPerSubset) / 2., 1.);
+
+        SphereGrid grid;
+        grid.columns = std::max(3u, static_cast<uint32_t>(std::lround(std::sqrt(quads))));
+        grid.rowsPerSubset = std::max(1u, static_cast<uint32_t>(std::ceil(quads / double(grid.columns))));
+        grid.rows = grid.rowsPerSubset * std::max(subsets, 1u);
+        return grid;
+    }
+
+    // Writes the vertices of a unit sphere centered at 'center' in the given layout. Bones
+    // are assigned by band, blending each vertex with the next bone.
+    void WriteSphereVertices(const SphereGrid& grid, XMFLOAT3 center, const VertexLayout& layout,
+        uint32_t bones, uint8_t* dest)
+    {
+        using namespace DXUT;
+
+        for (uint32_t row = 0; row <= grid.rows; ++row)
+        {
+            const float v = float(row) / float(grid.rows);
+            const float theta = v * XM_PI;
+
+            for (uint32_t column = 0; column <= grid.columns; ++column, dest += layout.stride)
+            {
+                const float u = float(column) / float(grid.columns);
+                const float phi = u * XM_2PI;
+
+                const XMFLOAT3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+                const XMFLOAT3 position(center.x + normal.x, center.y + normal.y, center.z + normal.z);
+
+                for (auto const& element : layout.elements)
+                {
+                    uint8_t* ptr = dest + element.Offset;
+                    switch (element.Usage)
+                    {
+                    case D3DDECLUSAGE_POSITION:
+                        memcpy(ptr, &position, sizeof(position));
+                        break;
+
+                    case D3DDECLUSAGE_NORMAL:
+                        memcpy(ptr, &normal, sizeof(normal));
+                        break;
+
+                    case D3DDECLUSAGE_COLOR:
+                        {
+                            // D3DCOLOR is BGRA in memory.
+                            const uint8_t color[4] = { uint8_t(255.f * v), uint8_t(128.f + 127.f * normal.y), uint8_t(255.f * u), 255 };
+                            memcpy(ptr, color, sizeof(color));
+                        }
+                        break;
+
+                    case D3DDECLUSAGE_TANGENT:
+                        {
+                            const XMFLOAT4 tangent(-std::sin(phi), 0.f, std::cos(phi), 1.f);
+                            memcpy(ptr, &tangent, sizeof(tangent));
+                        }
+                        break;
+
+                    case D3DDECLUSAGE_BLENDINDICES:
+                        {
+                            const uint32_t bone = bones ? (row / grid.rowsPerSubset) % bones : 0;
+                            const uint8_t indices[4] = { uint8_t(bone), uint8_t(bones ? (bone + 1) % bones : 0), 0, 0 };
+                            memcpy(ptr, indices, sizeof(indices));
+                        }
+                        break;
+
+                    case D3DDECLUSAGE_BLENDWEIGHT:
+                        {
+                            const uint8_t weights[4] = { 192, 63, 0, 0 };
+                            memcpy(ptr, weights, sizeof(weights));
+                        }
+                        break;
+
+                    case D3DDECLUSAGE_TEXCOORD:
+                        {
+                            const XMFLOAT2 texcoord(u, v);
+                            memcpy(ptr, &texcoord, sizeof(texcoord));
+                        }
+                        break;
+
+                    default:
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Indices for rows [firstRow, firstRow + rows), clockwise when viewed from outside.
+    template<typename T>
+    void WriteSphereIndices(const SphereGrid& grid, uint32_t firstRow, uint32_t rows, uint32_t baseVertex, T* dest) noexcept
+    {
+        const uint32_t pitch = grid.columns + 1;
+        for (uint32_t row = firstRow; row < firstRow + rows; ++row)
+        {
+            for (uint32_t column = 0; column < grid.columns; ++column)
+            {
+                const uint32_t a = baseVertex + row * pitch + column;
+                const uint32_t b = a + pitch;
+
+                *dest++ = T(a);
+                *dest++ = T(a + 1);
+                *dest++ = T(b);
+
+                *dest++ = T(a + 1);
+                *dest++ = T(b + 1);
+                *dest++ = T(b);
+            }
+        }
+    }
+
+    void CopyName(char* dest, size_t size, const char* format, uint32_t index) noexcept
+    {
+        memset(dest, 0, size);
+        std::snprintf(dest, size, format, index);
+    }
+
+    std::vector<uint8_t> GenerateVBO(const SyntheticModelDesc& desc)
+    {
+        // Every subset of every mesh becomes one band of a single sphere.
+        const uint32_t bands = std::max(desc.meshes, 1u) * std::max(desc.subsetsPerMesh, 1u);
+        const SphereGrid grid = GetSphereGrid(bands, desc.trianglesPerSubset);
+        if (grid.GetVertexCount() > c_MaxVBOVertices)
+            throw std::invalid_argument("VBO models are limited to 65536 vertices");
+
+        const VertexLayout layout = GetVertexLayout(VertexFormat::PositionNormalTexture);
+
+        const auto vertexCount = static_cast<uint32_t>(grid.GetVertexCount());
+        const auto indexCount = static_cast<uint32_t>(grid.GetIndexCount());
+
+        std::vector<uint8_t> file(2 * sizeof(uint32_t) + size_t(vertexCount) * layout.stride + size_t(indexCount) * sizeof(uint16_t));
+
+        memcpy(file.data(), &vertexCount, sizeof(uint32_t));
+        memcpy(file.data() + sizeof(uint32_t), &indexCount, sizeof(uint32_t));
+
+        uint8_t* vertices = file.data() + 2 * sizeof(uint32_t);
+        WriteSphereVertices(grid, XMFLOAT3(0.f, 0.f, 0.f), layout, 0, vertices);
+
+        std::vector<uint16_t> indices(indexCount);
+        WriteSphereIndices(grid, 0, grid.rows, 0, indices.data());
+        memcpy(vertices + size_t(vertexCount) * layout.stride, indices.data(), indices.size() * sizeof(uint16_t));
+
+        return file;
+    }
+
+    std::vector<uint8_t> GenerateSDKMESH(const SyntheticModelDesc& desc)
+    {
+        using namespace DXUT;
+
+        if (desc.version != SDKMESH_FILE_VERSION && desc.version != SDKMESH_FILE_VERSION_V2)
+            throw std::invalid_argument("Unsupported SDKMESH version");
+
+        const uint32_t meshCount = std::max(desc.meshes, 1u);
+        const uint32_t subsetsPerMesh = std::max(desc.subsetsPerMesh, 1u);
+        const uint32_t subsetCount = meshCount * subsetsPerMesh;
+        const uint32_t materialCount = std::max(desc.materials, 1u);
+        const uint32_t frameCount = std::max(std::max(desc.frames, meshCount), std::max(desc.hierarchyDepth, 1u));
+        const uint32_t depth = std::min(std::max(desc.hierarchyDepth, 1u), frameCount);
+        const uint32_t bones = (desc.vertexFormat == VertexFormat::Skinned) ? std::min(desc.bones, frameCount) : 0u;
+
+        if (bones > 256)
+            throw std::invalid_argument("Skinned models are limited to 256 bones");
+
+        const SphereGrid grid = GetSphereGrid(subsetsPerMesh, desc.trianglesPerSubset);
+        const VertexLayout layout = GetVertexLayout(desc.vertexFormat);
+        const size_t vertexCount = grid.GetVertexCount();
+        const size_t indexCount = grid.GetIndexCount();
+        const bool index32 = desc.index32 || vertexCount > 65536;
+        const size_t indexSize = index32 ? sizeof(uint32_t) : sizeof(uint16_t);
+
+        static_assert(sizeof(SDKMESH_MATERIAL) == sizeof(SDKMESH_MATERIAL_V2), "SDKMESH material size mismatch");
+
+        // Headers and other non-buffer data, then one vertex and one index buffer per mesh.
+        SDKMESH_HEADER header = {};
+        header.Version = desc.version;
+        header.HeaderSize = sizeof(SDKMESH_HEADER);
+        header.NumVertexBuffers = meshCount;
+        header.NumIndexBuffers = meshCount;
+        header.NumMeshes = meshCount;
+        header.NumTotalSubsets = subsetCount;
+        header.NumFrames = frameCount;
+        header.NumMaterials = materialCount;
+
+        uint64_t offset = sizeof(SDKMESH_HEADER);
+        auto reserve = [&](uint64_t size) { const uint64_t start = offset; offset += (size + 15) & ~uint64_t(15); return start; };
+
+        header.VertexStreamHeadersOffset = reserve(uint64_t(meshCount) * sizeof(SDKMESH_VERTEX_BUFFER_HEADER));
+        header.IndexStreamHeadersOffset = reserve(uint64_t(meshCount) * sizeof(SDKMESH_INDEX_BUFFER_HEADER));
+        header.MeshDataOffset = reserve(uint64_t(meshCount) * sizeof(SDKMESH_MESH));
+        header.SubsetDataOffset = reserve(uint64_t(subsetCount) * sizeof(SDKMESH_SUBSET));
+        header.FrameDataOffset = reserve(uint64_t(frameCount) * sizeof(SDKMESH_FRAME));
+        header.MaterialDataOffset = reserve(uint64_t(materialCount) * sizeof(SDKMESH_MATERIAL));
+        const uint64_t subsetListOffset = reserve(uint64_t(subsetCount) * sizeof(uint32_t));
+        const uint64_t influenceOffset = reserve(uint64_t(meshCount) * bones * sizeof(uint32_t));
+
+        header.NonBufferDataSize = offset - header.HeaderSize;
+
+        const uint64_t vertexBufferSize = uint64_t(vertexCount) * layout.stride;
+        const uint64_t indexBufferSize = uint64_t(indexCount) * indexSize;
+        std::vector<uint64_t> vertexData(meshCount);
+        std::vector<uint64_t> indexData(meshCount);
+        for (uint32_t m = 0; m < meshCount; ++m)
+        {
+            vertexData[m] = reserve(vertexBufferSize);
+            indexData[m] = reserve(indexBufferSize);
+        }
+
+        header.BufferDataSize = offset - header.HeaderSize - header.NonBufferDataSize;
+
+        std::vector<uint8_t> file(static_cast<size_t>(offset), 0);
+        memcpy(file.data(), &header, sizeof(header));
+
+        // Meshes, with their buffers and subsets.
+        std::vector<uint32_t> indices32(index32 ? indexCount : 0);
+        std::vector<uint16_t> indices16(index32 ? 0 : indexCount);
+        if (index32)
+        {
+            WriteSphereIndices(grid, 0, grid.rows, 0, indices32.data());
+        }
+        else
+        {
+            WriteSphereIndices(grid, 0, grid.rows, 0, indices16.data());
+        }
+
+        for (uint32_t m = 0; m < meshCount; ++m)
+        {
+            const XMFLOAT3 center(float(m) * c_MeshSpacing, 0.f, 0.f);
+
+            SDKMESH_VERTEX_BUFFER_HEADER vh = {};
+            vh.NumVertices = vertexCount;
+            vh.SizeBytes = vertexBufferSize;
+            vh.StrideBytes = layout.stride;
+            for (auto& decl : vh.Decl)
+            {
+                decl.Stream = 0xFF;
+                decl.Type = D3DDECLTYPE_UNUSED;
+            }
+            std::copy(layout.elements.cbegin(), layout.elements.cend(), vh.Decl);
+            vh.DataOffset = vertexData[m];
+            memcpy(file.data() + header.VertexStreamHeadersOffset + m * sizeof(vh), &vh, sizeof(vh));
+
+            WriteSphereVertices(grid, center, layout, bones, file.data() + vertexData[m]);
+
+            SDKMESH_INDEX_BUFFER_HEADER ih = {};
+            ih.NumIndices = indexCount;
+            ih.SizeBytes = indexBufferSize;
+            ih.IndexType = index32 ? IT_32BIT : IT_16BIT;
+            ih.DataOffset = indexData[m];
+            memcpy(file.data() + header.IndexStreamHeadersOffset + m * sizeof(ih), &ih, sizeof(ih));
+
+            memcpy(file.data() + indexData[m], index32 ? static_cast<const void*>(indices32.data()) : indices16.data(), indexBufferSize);
+
+            SDKMESH_MESH mh = {};
+            CopyName(mh.Name, MAX_MESH_NAME, "mesh%u", m);
+            mh.NumVertexBuffers = 1;
+            mh.VertexBuffers[0] = m;
+            mh.IndexBuffer = m;
+            mh.NumSubsets = subsetsPerMesh;
+            mh.NumFrameInfluences = bones;
+            mh.BoundingBoxCenter = center;
+            mh.BoundingBoxExtents = XMFLOAT3(1.f, 1.f, 1.f);
+            mh.SubsetOffset = subsetListOffset + uint64_t(m) * subsetsPerMesh * sizeof(uint32_t);
+            mh.FrameInfluenceOffset = influenceOffset + uint64_t(m) * bones * sizeof(uint32_t);
+            memcpy(file.data() + header.MeshDataOffset + m * sizeof(mh), &mh, sizeof(mh));
+
+            for (uint32_t s = 0; s < subsetsPerMesh; ++s)
+            {
+                const uint32_t subsetIndex = m * subsetsPerMesh + s;
+
+                SDKMESH_SUBSET subset = {};
+                CopyName(subset.Name, MAX_SUBSET_NAME, "subset%u", subsetIndex);
+                subset.MaterialID = subsetIndex % materialCount;
+                subset.PrimitiveType = PT_TRIANGLE_LIST;
+                subset.IndexStart = uint64_t(s) * grid.rowsPerSubset * grid.columns * 6;
+                subset.IndexCount = uint64_t(grid.rowsPerSubset) * grid.columns * 6;
+                subset.VertexStart = 0;
+                subset.VertexCount = vertexCount;
+                memcpy(file.data() + header.SubsetDataOffset + subsetIndex * sizeof(subset), &subset, sizeof(subset));
+                memcpy(file.data() + mh.SubsetOffset + s * sizeof(uint32_t), &subsetIndex, sizeof(uint32_t));
+            }
+
+            for (uint32_t b = 0; b < bones; ++b)
+            {
+                memcpy(file.data() + mh.FrameInfluenceOffset + b * sizeof(uint32_t), &b, sizeof(uint32_t));
+            }
+        }
+
+        // Frames: a chain 'depth' long from frame 0, with the rest spread over the chain
+        // (but not its last link). Extra roots are siblings of frame 0.
+        std::vector<uint32_t> parents(frameCount, INVALID_FRAME);
+        for (uint32_t f = 1; f < frameCount && depth > 1; ++f)
+        {
+            parents[f] = (f < depth) ? f - 1 : (f - depth) % (depth - 1);
+        }
+
+        std::vector<uint32_t> children(frameCount, INVALID_FRAME);
+        std::vector<uint32_t> siblings(frameCount, INVALID_FRAME);
+        uint32_t firstRoot = INVALID_FRAME;
+        for (uint32_t f = frameCount; f-- > 0; )
+        {
+            uint32_t& first = (parents[f] == INVALID_FRAME) ? firstRoot : children[parents[f]];
+            siblings[f] = first;
+            first = f;
+        }
+
+        for (uint32_t f = 0; f < frameCount; ++f)
+        {
+            SDKMESH_FRAME fh = {};
+            CopyName(fh.Name, MAX_FRAME_NAME, "frame%u", f);
+            fh.Mesh = (f < meshCount) ? f : INVALID_MESH;
+            fh.ParentFrame = parents[f];
+            fh.ChildFrame = children[f];
+            fh.SiblingFrame = siblings[f];
+            fh.AnimationDataIndex = INVALID_ANIMATION_DATA;
+
+            const XMMATRIX matrix = (f > 0)
+                ? XMMatrixMultiply(XMMatrixRotationY(0.01f * float(f)), XMMatrixTranslation(0.f, 0.01f, 0.f))
+                : XMMatrixIdentity();
+            XMStoreFloat4x4(&fh.Matrix, matrix);
+
+            memcpy(file.data() + header.FrameDataOffset + f * sizeof(fh), &fh, sizeof(fh));
+        }
+
+        // Materials, with hues spread around the color wheel.
+        for (uint32_t j = 0; j < materialCount; ++j)
+        {
+            const float hue = XM_2PI * float(j) / float(materialCount);
+            const XMFLOAT4 diffuse(0.5f + 0.4f * std::cos(hue), 0.5f + 0.4f * std::cos(hue - XM_2PI / 3.f),
+                0.5f + 0.4f * std::cos(hue + XM_2PI / 3.f), desc.alpha);
+
+            if (desc.version >= SDKMESH_FILE_VERSION_V2)
+            {
+                SDKMESH_MATERIAL_V2 mat = {};
+                CopyName(mat.Name, MAX_MATERIAL_NAME, "material%u", j);
+                mat.Alpha = desc.alpha;
+                memcpy(file.data() + header.MaterialDataOffset + j * sizeof(mat), &mat, sizeof(mat));
+            }
+            else
+            {
+                SDKMESH_MATERIAL mat = {};
+                CopyName(mat.Name, MAX_MATERIAL_NAME, "material%u", j);
+                mat.Diffuse = diffuse;
+                mat.Ambient = XMFLOAT4(0.2f, 0.2f, 0.2f, 1.f);
+                mat.Specular = XMFLOAT4(0.5f, 0.5f, 0.5f, 1.f);
+                mat.Power = 16.f;
+                memcpy(file.data() + header.MaterialDataOffset + j * sizeof(mat), &mat, sizeof(mat));
+            }
+        }
+
+        return file;
+    }
+
+    SyntheticModelDesc MakeDesc(ModelData::Format format, uint32_t version, uint32_t meshes, uint32_t subsets,
+        uint32_t triangles, VertexFormat vertexFormat, uint32_t materials) noexcept
+    {
+        SyntheticModelDesc desc;
+        desc.format = format;
+        desc.version = version;
+        desc.meshes = meshes;
+        desc.subsetsPerMesh = subsets;
+        desc.trianglesPerSubset = triangles;
+        desc.vertexFormat = vertexFormat;
+        desc.materials = materials;
+        return desc;
+    }
+}
+
+std::vector<uint8_t> DX::GenerateModel(const SyntheticModelDesc& desc)
+{
+    switch (desc.format)
+    {
+    case ModelData::Format::SDKMESH:    return GenerateSDKMESH(desc);
+    case ModelData::Format::VBO:        return GenerateVBO(desc);
+    default:                            throw std::invalid_argument("Only SDKMESH and VBO models can be generated");
+    }
+}
+
+std::vector<SyntheticModel> DX::GetSyntheticCorpus()
+{
+    using Format = ModelData::Format;
+
+    std::vector<SyntheticModel> corpus;
+
+    corpus.push_back({ L"vbo_small.vbo", MakeDesc(Format::VBO, 0, 1, 1, 2048, VertexFormat::PositionNormalTexture, 1) });
+    corpus.push_back({ L"vbo_max.vbo", MakeDesc(Format::VBO, 0, 1, 1, 120000, VertexFormat::PositionNormalTexture, 1) });
+
+    corpus.push_back({ L"sdkmesh1_basic.sdkmesh", MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION, 1, 1, 20000, VertexFormat::PositionNormal, 1) });
+    corpus.push_back({ L"sdkmesh1_subsets.sdkmesh", MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION, 4, 64, 1024, VertexFormat::PositionNormalTexture, 16) });
+    corpus.push_back({ L"sdkmesh1_colors.sdkmesh", MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION, 2, 8, 8192, VertexFormat::PositionNormalColorTexture, 4) });
+    corpus.push_back({ L"sdkmesh2_tangents.sdkmesh", MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION_V2, 4, 4, 8192, VertexFormat::PositionNormalTangentTexture, 4) });
+
+    auto skinned = MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION, 1, 16, 4096, VertexFormat::Skinned, 2);
+    skinned.bones = 64;
+    skinned.frames = 64;
+    skinned.hierarchyDepth = 16;
+    corpus.push_back({ L"sdkmesh1_skinned.sdkmesh", skinned });
+
+    auto hierarchy = MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION_V2, 16, 2, 1024, VertexFormat::PositionNormalTexture, 8);
+    hierarchy.frames = 4096;
+    hierarchy.hierarchyDepth = 256;
+    corpus.push_back({ L"sdkmesh2_hierarchy.sdkmesh", hierarchy });
+
+    // Assemblies exported from CAD: many parts, each its own frame, a few levels deep.
+    auto assembly = MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION_V2, 64, 1, 256, VertexFormat::PositionNormal, 8);
+    assembly.frames = 16384;
+    assembly.hierarchyDepth = 4;
+    corpus.push_back({ L"sdkmesh2_assembly.sdkmesh", assembly });
+
+    // Translucent spheres, overlapping along the row in the side view.
+    auto translucent = MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION, 8, 8, 1024, VertexFormat::PositionNormal, 8);
+    translucent.alpha = 0.5f;
+    corpus.push_back({ L"sdkmesh1_translucent.sdkmesh", translucent });
+
+    auto large = MakeDesc(Format::SDKMESH, DXUT::SDKMESH_FILE_VERSION, 8, 8, 16384, VertexFormat::PositionNormalTexture, 8);
+    large.index32 = true;
+    corpus.push_back({ L"sdkmesh1_large.sdkmesh", large });
+
+    return corpus;
+}
@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------------------
+// File: ModelGenerator.h
+//
+// Writes synthetic .sdkmesh and .vbo files for benchmarking the loaders and the headless
+// renderer. Each mesh is a sphere tessellated into bands of rows, one band per subset.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ModelData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace DX
+{
+    struct SyntheticModelDesc
+    {
+        enum class VertexFormat : uint32_t
+        {
+            PositionNormal,
+            PositionNormalTexture,
+            PositionNormalColorTexture,
+            PositionNormalTangentTexture,
+            Skinned,                        // PositionNormalTexture with four bone indices and weights
+        };
+
+        ModelData::Format   format;             // SDKMESH or VBO
+        uint32_t            version;            // SDKMESH file version, 101 or 200
+        uint32_t            meshes;
+        uint32_t            subsetsPerMesh;
+        uint32_t            trianglesPerSubset; // Rounded up to whole rows
+        VertexFormat        vertexFormat;
+        uint32_t            bones;              // Frame influences of each mesh when skinned
+        uint32_t            frames;             // Raised to at least one per mesh
+        uint32_t            hierarchyDepth;     // Longest chain of parent frames
+        uint32_t            materials;
+        float               alpha;              // Opacity of every material; below 1 they are blended
+        bool                index32;            // 32-bit indices even when 16 bits would do
+
+        SyntheticModelDesc() noexcept :
+            format(ModelData::Format::SDKMESH),
+            version(101),
+            meshes(1),
+            subsetsPerMesh(1),
+            trianglesPerSubset(2048),
+            vertexFormat(VertexFormat::PositionNormalTexture),
+            bones(0),
+            frames(1),
+            hierarchyDepth(1),
+            materials(1),
+            alpha(1.f),
+            index32(false)
+        {
+        }
+    };
+
+    // Returns the file contents. A VBO holds one mesh with one subset, so the triangles of
+    // every subset are combined, the vertex format is always PositionNormalTexture, and
+    // std::invalid_argument is thrown if it needs more than 65536 vertices.
+    std::vector<uint8_t> GenerateModel(const SyntheticModelDesc& desc);
+
+    struct SyntheticModel
+    {
+        const wchar_t*      name;               // File name, with extension
+        SyntheticModelDesc  desc;
+    };
+
+    // A standard corpus spanning both formats, SDKMESH v1 and v2, each vertex format, and
+    // small to large mesh, subset, bone, and frame counts.
+    std::vector<SyntheticModel> GetSyntheticCorpus();
+}
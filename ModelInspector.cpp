@@ -0,0 +1,863 @@
+//--------------------------------------------------------------------------------------
+// File: ModelInspector.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "ModelInspector.h"
+#include "ChromeTrace.h"
+#include "HeadlessRenderer.h"
+#include "MemoryAccounting.h"
+#include "ModelData.h"
+#include "ReadData.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    // Files found but not yet picked up by a worker; the search waits when this many are queued.
+    constexpr size_t c_MaxQueuedFiles = 4096;
+
+    const char* c_FormatNames[] = { "sdkmesh", "cmo", "vbo" };
+    const char* c_PrimitiveNames[] = { "triangle_list", "triangle_strip", "line_list", "line_strip", "point_list", "unsupported" };
+
+    std::string Narrow(const std::wstring& str)
+    {
+    #ifdef _WIN32
+        if (str.empty())
+            return std::string();
+
+        const int len = WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0, nullptr, nullptr);
+        std::string result(static_cast<size_t>(std::max(len, 0)), '\0');
+        if (len > 0)
+        {
+            WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &result[0], len, nullptr, nullptr);
+        }
+        return result;
+    #else
+        return FileName(str.c_str());
+    #endif
+    }
+
+    std::wstring Widen(const std::string& str)
+    {
+    #ifdef _WIN32
+        const int len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0);
+        std::wstring result(static_cast<size_t>(std::max(len, 0)), L'\0');
+        if (len > 0)
+        {
+            MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &result[0], len);
+        }
+        return result;
+    #else
+        std::wstring result(str.size(), L'\0');
+        const size_t len = mbstowcs(&result[0], str.c_str(), result.size());
+        result.resize((len == static_cast<size_t>(-1)) ? 0 : len);
+        return result;
+    #endif
+    }
+
+    std::wstring GetExtension(const std::wstring& path)
+    {
+        const size_t dot = path.find_last_of(L'.');
+        const size_t slash = path.find_last_of(L"\\/");
+        if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash))
+            return std::wstring();
+
+        return path.substr(dot);
+    }
+
+    // The directory part of 'path' including the trailing separator, or empty.
+    std::wstring GetDirectory(const std::wstring& path)
+    {
+        const size_t slash = path.find_last_of(L"\\/");
+        return (slash == std::wstring::npos) ? std::wstring() : path.substr(0, slash + 1);
+    }
+
+    bool IsDirectory(const std::wstring& path)
+    {
+    #ifdef _WIN32
+        const DWORD attributes = GetFileAttributesW(path.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+    #else
+        struct stat st = {};
+        return stat(FileName(path.c_str()).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    #endif
+    }
+
+    // Lists the models and subdirectories of 'directory', each sorted by name so repeated
+    // runs queue the files in the same order. Symbolic links to directories are not
+    // followed, which keeps a link cycle from searching forever.
+    bool ListDirectory(const std::wstring& directory, std::vector<std::wstring>& files, std::vector<std::wstring>& subdirectories)
+    {
+        std::wstring prefix = directory;
+        if (!prefix.empty() && prefix.back() != L'\\' && prefix.back() != L'/')
+        {
+            prefix += L'/';
+        }
+
+    #ifdef _WIN32
+        WIN32_FIND_DATAW data = {};
+        HANDLE hFind = FindFirstFileExW((prefix + L"*").c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+        if (hFind == INVALID_HANDLE_VALUE)
+            return false;
+
+        do
+        {
+            const std::wstring name = data.cFileName;
+            if (name == L"." || name == L"..")
+                continue;
+
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            {
+                if (!(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+                {
+                    subdirectories.emplace_back(prefix + name);
+                }
+            }
+            else if (ModelData::IsSupportedExtension(GetExtension(name).c_str()))
+            {
+                files.emplace_back(prefix + name);
+            }
+        }
+        while (FindNextFileW(hFind, &data));
+
+        FindClose(hFind);
+    #else
+        const std::string narrowPrefix = FileName(prefix.c_str());
+        DIR* dir = opendir(narrowPrefix.c_str());
+        if (!dir)
+            return false;
+
+        while (const dirent* entry = readdir(dir))
+        {
+            const std::string name = entry->d_name;
+            if (name == "." || name == "..")
+                continue;
+
+            bool directory = (entry->d_type == DT_DIR);
+            bool regular = (entry->d_type == DT_REG);
+            if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+            {
+                struct stat st = {};
+                if (stat((narrowPrefix + name).c_str(), &st) != 0)
+                    continue;
+
+                directory = S_ISDIR(st.st_mode) && entry->d_type != DT_LNK;
+                regular = S_ISREG(st.st_mode);
+            }
+
+            const std::wstring wide = Widen(name);
+            if (wide.empty())
+                continue;
+
+            if (directory)
+            {
+                subdirectories.emplace_back(prefix + wide);
+            }
+            else if (regular && ModelData::IsSupportedExtension(GetExtension(wide).c_str()))
+            {
+                files.emplace_back(prefix + wide);
+            }
+        }
+
+        closedir(dir);
+    #endif
+
+        std::sort(files.begin(), files.end());
+        std::sort(subdirectories.begin(), subdirectories.end());
+        return true;
+    }
+
+    class FileQueue
+    {
+    public:
+        FileQueue() noexcept : m_closed(false) {}
+
+        // Waits while the queue is full.
+        void Push(std::wstring&& path)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notFull.wait(lock, [this]() { return m_files.size() < c_MaxQueuedFiles; });
+            m_files.emplace_back(std::move(path));
+            m_notEmpty.notify_one();
+        }
+
+        // Returns false once the queue is closed and empty.
+        bool Pop(std::wstring& path)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this]() { return m_closed || !m_files.empty(); });
+            if (m_files.empty())
+                return false;
+
+            path = std::move(m_files.front());
+            m_files.pop_front();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        void Close()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_notEmpty.notify_all();
+        }
+
+    private:
+        std::mutex                  m_mutex;
+        std::condition_variable     m_notEmpty;
+        std::condition_variable     m_notFull;
+        std::deque<std::wstring>    m_files;
+        bool                        m_closed;
+    };
+
+    // Size and layout of a referenced texture, read from its DDS header.
+    struct TextureInfo
+    {
+        bool        found;
+        bool        estimated;      // False if the file isn't a DDS or its format isn't recognized
+        DXGI_FORMAT format;
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    depth;          // Greater than 1 only for volume textures
+        uint32_t    arraySize;      // Including the 6 faces of a cubemap
+        uint32_t    mipLevels;
+        uint64_t    bytes;
+    };
+
+    struct DDSPixelFormat
+    {
+        uint32_t    size;
+        uint32_t    flags;
+        uint32_t    fourCC;
+        uint32_t    RGBBitCount;
+        uint32_t    RBitMask;
+        uint32_t    GBitMask;
+        uint32_t    BBitMask;
+        uint32_t    ABitMask;
+    };
+
+    struct DDSHeader
+    {
+        uint32_t        size;
+        uint32_t        flags;
+        uint32_t        height;
+        uint32_t        width;
+        uint32_t        pitchOrLinearSize;
+        uint32_t        depth;
+        uint32_t        mipMapCount;
+        uint32_t        reserved1[11];
+        DDSPixelFormat  ddspf;
+        uint32_t        caps;
+        uint32_t        caps2;
+        uint32_t        caps3;
+        uint32_t        caps4;
+        uint32_t        reserved2;
+    };
+
+    struct DDSHeaderDXT10
+    {
+        uint32_t    dxgiFormat;
+        uint32_t    resourceDimension;
+        uint32_t    miscFlag;
+        uint32_t    arraySize;
+        uint32_t    miscFlags2;
+    };
+
+    static_assert(sizeof(DDSHeader) == 124, "DDS header size mismatch");
+    static_assert(sizeof(DDSHeaderDXT10) == 20, "DDS DX10 header size mismatch");
+
+    constexpr uint32_t c_DDSMagic = 0x20534444; // "DDS "
+
+    constexpr uint32_t DDPF_ALPHA = 0x2;
+    constexpr uint32_t DDPF_FOURCC = 0x4;
+    constexpr uint32_t DDPF_RGB = 0x40;
+    constexpr uint32_t DDPF_LUMINANCE = 0x20000;
+    constexpr uint32_t DDPF_BUMPDUDV = 0x80000;
+
+    constexpr uint32_t DDS_HEADER_FLAGS_VOLUME = 0x800000;
+    constexpr uint32_t DDS_CUBEMAP = 0x200;
+    constexpr uint32_t DDS_RESOURCE_DIMENSION_TEXTURE3D = 4;
+    constexpr uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+    constexpr uint32_t MakeFourCC(char a, char b, char c, char d) noexcept
+    {
+        return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+    }
+
+    bool HasMasks(const DDSPixelFormat& pf, uint32_t r, uint32_t g, uint32_t b, uint32_t a) noexcept
+    {
+        return pf.RBitMask == r && pf.GBitMask == g && pf.BBitMask == b && pf.ABitMask == a;
+    }
+
+    // The same mapping from legacy pixel formats as DDSTextureLoader.
+    DXGI_FORMAT GetDXGIFormat(const DDSPixelFormat& pf) noexcept
+    {
+        if (pf.flags & DDPF_RGB)
+        {
+            switch (pf.RGBBitCount)
+            {
+            case 32:
+                if (HasMasks(pf, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) return DXGI_FORMAT_R8G8B8A8_UNORM;
+                if (HasMasks(pf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000)) return DXGI_FORMAT_B8G8R8A8_UNORM;
+                if (HasMasks(pf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0)) return DXGI_FORMAT_B8G8R8X8_UNORM;
+                if (HasMasks(pf, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000)) return DXGI_FORMAT_R10G10B10A2_UNORM;
+                if (HasMasks(pf, 0x000003ff, 0x000ffc00, 0x3ff00000, 0xc0000000)) return DXGI_FORMAT_R10G10B10A2_UNORM;
+                if (HasMasks(pf, 0x0000ffff, 0xffff0000, 0, 0)) return DXGI_FORMAT_R16G16_UNORM;
+                if (HasMasks(pf, 0xffffffff, 0, 0, 0)) return DXGI_FORMAT_R32_FLOAT;
+                break;
+
+            case 16:
+                if (HasMasks(pf, 0x7c00, 0x03e0, 0x001f, 0x8000)) return DXGI_FORMAT_B5G5R5A1_UNORM;
+                if (HasMasks(pf, 0xf800, 0x07e0, 0x001f, 0)) return DXGI_FORMAT_B5G6R5_UNORM;
+                if (HasMasks(pf, 0x0f00, 0x00f0, 0x000f, 0xf000)) return DXGI_FORMAT_B4G4R4A4_UNORM;
+                if (HasMasks(pf, 0x00ff, 0, 0, 0xff00)) return DXGI_FORMAT_R8G8_UNORM;
+                if (HasMasks(pf, 0xffff, 0, 0, 0)) return DXGI_FORMAT_R16_UNORM;
+                break;
+
+            case 8:
+                if (HasMasks(pf, 0xff, 0, 0, 0)) return DXGI_FORMAT_R8_UNORM;
+                break;
+
+            default:
+                break;
+            }
+        }
+        else if (pf.flags & DDPF_LUMINANCE)
+        {
+            if (pf.RGBBitCount == 8 && HasMasks(pf, 0xff, 0, 0, 0)) return DXGI_FORMAT_R8_UNORM;
+            if (pf.RGBBitCount == 16 && HasMasks(pf, 0xffff, 0, 0, 0)) return DXGI_FORMAT_R16_UNORM;
+            if (pf.RGBBitCount == 16 && HasMasks(pf, 0x00ff, 0, 0, 0xff00)) return DXGI_FORMAT_R8G8_UNORM;
+            if (pf.RGBBitCount == 8 && HasMasks(pf, 0x00ff, 0, 0, 0xff00)) return DXGI_FORMAT_R8G8_UNORM;
+        }
+        else if (pf.flags & DDPF_ALPHA)
+        {
+            if (pf.RGBBitCount == 8) return DXGI_FORMAT_A8_UNORM;
+        }
+        else if (pf.flags & DDPF_BUMPDUDV)
+        {
+            if (pf.RGBBitCount == 16 && HasMasks(pf, 0x00ff, 0xff00, 0, 0)) return DXGI_FORMAT_R8G8_SNORM;
+            if (pf.RGBBitCount == 32 && HasMasks(pf, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) return DXGI_FORMAT_R8G8B8A8_SNORM;
+            if (pf.RGBBitCount == 32 && HasMasks(pf, 0x0000ffff, 0xffff0000, 0, 0)) return DXGI_FORMAT_R16G16_SNORM;
+        }
+        else if (pf.flags & DDPF_FOURCC)
+        {
+            switch (pf.fourCC)
+            {
+            case MakeFourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+            case MakeFourCC('D', 'X', 'T', '2'):
+            case MakeFourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+            case MakeFourCC('D', 'X', 'T', '4'):
+            case MakeFourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+            case MakeFourCC('A', 'T', 'I', '1'):
+            case MakeFourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+            case MakeFourCC('B', 'C', '4', 'S'): return DXGI_FORMAT_BC4_SNORM;
+            case MakeFourCC('A', 'T', 'I', '2'):
+            case MakeFourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+            case MakeFourCC('B', 'C', '5', 'S'): return DXGI_FORMAT_BC5_SNORM;
+            case MakeFourCC('R', 'G', 'B', 'G'): return DXGI_FORMAT_R8G8_B8G8_UNORM;
+            case MakeFourCC('G', 'R', 'G', 'B'): return DXGI_FORMAT_G8R8_G8B8_UNORM;
+            case MakeFourCC('Y', 'U', 'Y', '2'): return DXGI_FORMAT_YUY2;
+
+            // D3DFORMAT values stored directly in the fourCC field
+            case 36:  return DXGI_FORMAT_R16G16B16A16_UNORM;
+            case 110: return DXGI_FORMAT_R16G16B16A16_SNORM;
+            case 111: return DXGI_FORMAT_R16_FLOAT;
+            case 112: return DXGI_FORMAT_R16G16_FLOAT;
+            case 113: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+            case 114: return DXGI_FORMAT_R32_FLOAT;
+            case 115: return DXGI_FORMAT_R32G32_FLOAT;
+            case 116: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+            default:
+                break;
+            }
+        }
+
+        return DXGI_FORMAT_UNKNOWN;
+    }
+
+    // Reads only the headers, so the estimate costs one small read per texture.
+    TextureInfo ReadTextureInfo(const std::wstring& path)
+    {
+        TextureInfo info = {};
+
+        std::ifstream inFile(FileName(path.c_str()), std::ios::in | std::ios::binary);
+        if (!inFile)
+            return info;
+
+        info.found = true;
+
+        uint8_t buffer[sizeof(uint32_t) + sizeof(DDSHeader) + sizeof(DDSHeaderDXT10)] = {};
+        inFile.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+        const auto bytesRead = static_cast<size_t>(inFile.gcount());
+
+        uint32_t magic = 0;
+        DDSHeader header = {};
+        if (bytesRead < sizeof(magic) + sizeof(header))
+            return info;
+
+        memcpy(&magic, buffer, sizeof(magic));
+        memcpy(&header, buffer + sizeof(magic), sizeof(header));
+        if (magic != c_DDSMagic || header.size != sizeof(DDSHeader) || header.ddspf.size != sizeof(DDSPixelFormat))
+            return info;
+
+        info.width = std::max(header.width, 1u);
+        info.height = std::max(header.height, 1u);
+        info.depth = 1;
+        info.arraySize = 1;
+        info.mipLevels = std::max(header.mipMapCount, 1u);
+
+        bool volume = false;
+        bool cubemap = false;
+        if ((header.ddspf.flags & DDPF_FOURCC) && header.ddspf.fourCC == MakeFourCC('D', 'X', '1', '0'))
+        {
+            if (bytesRead < sizeof(buffer))
+                return info;
+
+            DDSHeaderDXT10 ext = {};
+            memcpy(&ext, buffer + sizeof(magic) + sizeof(header), sizeof(ext));
+
+            info.format = static_cast<DXGI_FORMAT>(ext.dxgiFormat);
+            info.arraySize = std::max(ext.arraySize, 1u);
+            volume = (ext.resourceDimension == DDS_RESOURCE_DIMENSION_TEXTURE3D);
+            cubemap = (ext.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+        }
+        else
+        {
+            info.format = GetDXGIFormat(header.ddspf);
+            volume = (header.flags & DDS_HEADER_FLAGS_VOLUME) != 0;
+            cubemap = (header.caps2 & DDS_CUBEMAP) != 0;
+        }
+
+        if (volume)
+        {
+            info.depth = std::max(header.depth, 1u);
+        }
+        else if (cubemap)
+        {
+            info.arraySize *= 6;
+        }
+
+        if (!BitsPerPixel(info.format))
+            return info;
+
+        info.bytes = ComputeTextureBytes(info.format, info.width, info.height, info.depth, info.arraySize, info.mipLevels);
+        info.estimated = true;
+        return info;
+    }
+
+    // JSON has no NaN or infinity.
+    void WriteNumber(std::ostream& out, float value)
+    {
+        if (std::isfinite(value))
+        {
+            out << value;
+        }
+        else
+        {
+            out << "null";
+        }
+    }
+
+    void WriteVector(std::ostream& out, const XMFLOAT3& value)
+    {
+        out << '[';
+        WriteNumber(out, value.x);
+        out << ',';
+        WriteNumber(out, value.y);
+        out << ',';
+        WriteNumber(out, value.z);
+        out << ']';
+    }
+
+    void WriteIndex(std::ostream& out, uint32_t index)
+    {
+        if (index == ModelData::None)
+        {
+            out << "null";
+        }
+        else
+        {
+            out << index;
+        }
+    }
+
+    // Number of frames on the longest path from a root, following parent links. A frame
+    // whose parents loop back on themselves counts as a root.
+    uint32_t GetFrameDepth(const ModelData& model) noexcept
+    {
+        constexpr uint32_t c_Visiting = UINT32_MAX;
+
+        const size_t count = model.frames.size();
+        std::vector<uint32_t> depth(count, 0);
+        std::vector<uint32_t> chain;
+
+        uint32_t maxDepth = 0;
+        for (size_t j = 0; j < count; ++j)
+        {
+            chain.clear();
+            uint32_t index = static_cast<uint32_t>(j);
+            while (index < count && !depth[index])
+            {
+                depth[index] = c_Visiting;
+                chain.push_back(index);
+                index = model.frames[index].parent;
+            }
+
+            uint32_t d = (index < count && depth[index] != c_Visiting) ? depth[index] : 0;
+            for (auto it = chain.crbegin(); it != chain.crend(); ++it)
+            {
+                depth[*it] = ++d;
+            }
+
+            maxDepth = std::max(maxDepth, depth[j]);
+        }
+
+        return maxDepth;
+    }
+
+    void WriteReport(std::ostream& out, const std::wstring& path, const ModelData& model, size_t fileBytes)
+    {
+        out << "{\"file\":";
+        WriteJSONString(out, Narrow(path).c_str());
+        out << ",\"format\":\"" << c_FormatNames[static_cast<uint32_t>(model.format)] << "\""
+            << ",\"version\":" << model.version
+            << ",\"file_bytes\":" << fileBytes;
+
+        uint64_t vertexBytes = 0;
+        out << ",\"vertex_buffers\":[";
+        for (size_t j = 0; j < model.vertexBuffers.size(); ++j)
+        {
+            auto const& vb = model.vertexBuffers[j];
+            vertexBytes += uint64_t(vb.vertexCount) * vb.stride;
+
+            out << (j ? "," : "") << "{\"vertices\":" << vb.vertexCount << ",\"stride\":" << vb.stride
+                << ",\"skinned\":" << (vb.skinned ? "true" : "false") << ",\"elements\":[";
+            for (size_t k = 0; k < vb.elements.size(); ++k)
+            {
+                auto const& element = vb.elements[k];
+                out << (k ? "," : "") << "{\"semantic\":";
+                WriteJSONString(out, element.semantic);
+                out << ",\"index\":" << element.semanticIndex << ",\"offset\":" << element.offset << ",\"format\":";
+                WriteJSONString(out, element.format);
+                out << '}';
+            }
+            out << "]}";
+        }
+        out << ']';
+
+        uint64_t indexBytes = 0;
+        out << ",\"index_buffers\":[";
+        for (size_t j = 0; j < model.indexBuffers.size(); ++j)
+        {
+            auto const& ib = model.indexBuffers[j];
+            indexBytes += uint64_t(ib.indices.size()) * ib.indexSize;
+
+            out << (j ? "," : "") << "{\"indices\":" << ib.indices.size() << ",\"index_size\":" << ib.indexSize << '}';
+        }
+        out << ']';
+
+        out << ",\"meshes\":[";
+        for (size_t j = 0; j < model.meshes.size(); ++j)
+        {
+            auto const& mesh = model.meshes[j];
+            out << (j ? "," : "") << "{\"name\":";
+            WriteJSONString(out, mesh.name.c_str());
+            out << ",\"ccw\":" << (mesh.ccw ? "true" : "false") << ",\"parts\":[";
+            for (size_t k = 0; k < mesh.parts.size(); ++k)
+            {
+                auto const& part = mesh.parts[k];
+                out << (k ? "," : "") << "{\"primitive\":\"" << c_PrimitiveNames[static_cast<uint32_t>(part.primitive)] << "\""
+                    << ",\"vertex_buffer\":" << part.vertexBuffer
+                    << ",\"index_buffer\":" << part.indexBuffer
+                    << ",\"material\":";
+                WriteIndex(out, part.material);
+                out << ",\"start_index\":" << part.startIndex << ",\"index_count\":" << part.indexCount
+                    << ",\"primitives\":" << ModelData::GetPrimitiveCount(part) << '}';
+            }
+            out << "]}";
+        }
+        out << ']';
+
+        const size_t roots = static_cast<size_t>(std::count_if(model.frames.cbegin(), model.frames.cend(),
+            [](const ModelData::Frame& frame) { return frame.parent == ModelData::None; }));
+        out << ",\"frames\":{\"count\":" << model.frames.size() << ",\"roots\":" << roots
+            << ",\"depth\":" << GetFrameDepth(model) << '}';
+
+        // Textures are looked up next to the model, as the viewer's effect factory does, and
+        // each file is counted once however many materials use it.
+        const std::wstring directory = GetDirectory(path);
+        std::map<std::wstring, TextureInfo> textures;
+
+        out << ",\"materials\":[";
+        for (size_t j = 0; j < model.materials.size(); ++j)
+        {
+            auto const& mat = model.materials[j];
+            out << (j ? "," : "") << "{\"name\":";
+            WriteJSONString(out, mat.name.c_str());
+            out << ",\"alpha\":" << (mat.isAlpha ? "true" : "false") << ",\"textures\":[";
+            for (size_t k = 0; k < mat.textures.size(); ++k)
+            {
+                auto const& texture = mat.textures[k];
+                const std::wstring texturePath = directory + Widen(texture.file);
+
+                auto it = textures.find(texturePath);
+                if (it == textures.end())
+                {
+                    it = textures.emplace(texturePath, ReadTextureInfo(texturePath)).first;
+                }
+                auto const& info = it->second;
+
+                out << (k ? "," : "") << "{\"usage\":";
+                WriteJSONString(out, texture.usage);
+                out << ",\"file\":";
+                WriteJSONString(out, texture.file.c_str());
+                out << ",\"found\":" << (info.found ? "true" : "false");
+                if (info.estimated)
+                {
+                    out << ",\"dxgi_format\":" << static_cast<uint32_t>(info.format)
+                        << ",\"width\":" << info.width << ",\"height\":" << info.height
+                        << ",\"depth\":" << info.depth << ",\"array_size\":" << info.arraySize
+                        << ",\"mip_levels\":" << info.mipLevels << ",\"bytes\":" << info.bytes;
+                }
+                out << '}';
+            }
+            out << "]}";
+        }
+        out << ']';
+
+        if (model.meshes.empty())
+        {
+            out << ",\"bounds\":null";
+        }
+        else
+        {
+            BoundingSphere sphere;
+            BoundingBox box;
+            model.GetBounds(sphere, box);
+
+            out << ",\"bounds\":{\"center\":";
+            WriteVector(out, sphere.Center);
+            out << ",\"radius\":";
+            WriteNumber(out, sphere.Radius);
+            out << ",\"box_center\":";
+            WriteVector(out, box.Center);
+            out << ",\"box_extents\":";
+            WriteVector(out, box.Extents);
+            out << '}';
+        }
+
+        const auto stats = model.GetStatistics();
+        out << ",\"statistics\":{\"meshes\":" << stats.meshes
+            << ",\"subsets\":" << stats.subsets
+            << ",\"vertices\":" << stats.vertices
+            << ",\"indices\":" << stats.indices
+            << ",\"triangles\":" << stats.triangles
+            << ",\"lines\":" << stats.lines
+            << ",\"points\":" << stats.points
+            << ",\"unsupported_subsets\":" << stats.unsupportedSubsets
+            << ",\"skinned\":" << (stats.skinned ? "true" : "false") << '}';
+
+        uint64_t textureBytes = 0;
+        size_t missing = 0;
+        size_t notEstimated = 0;
+        for (auto const& it : textures)
+        {
+            textureBytes += it.second.bytes;
+            if (!it.second.found)
+                ++missing;
+            else if (!it.second.estimated)
+                ++notEstimated;
+        }
+
+        out << ",\"memory\":{\"vertex_buffer_bytes\":" << vertexBytes
+            << ",\"index_buffer_bytes\":" << indexBytes
+            << ",\"texture_bytes\":" << textureBytes
+            << ",\"textures\":" << textures.size()
+            << ",\"textures_missing\":" << missing
+            << ",\"textures_not_estimated\":" << notEstimated
+            << ",\"total_bytes\":" << (vertexBytes + indexBytes + textureBytes) << "}}";
+    }
+
+    void WriteError(std::ostream& out, const std::wstring& path, const char* error)
+    {
+        out << "{\"file\":";
+        WriteJSONString(out, Narrow(path).c_str());
+        out << ",\"error\":";
+        WriteJSONString(out, error);
+        out << '}';
+    }
+}
+
+int DX::RunInspector(const HeadlessOptions& options, std::ostream& log)
+{
+    if (options.models.empty())
+    {
+        log << "ERROR: No models or directories given to inspect" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<std::ofstream> jsonFile;
+    if (!options.jsonFile.empty())
+    {
+        jsonFile.reset(new std::ofstream(FileName(options.jsonFile.c_str()), std::ios::out | std::ios::trunc));
+        if (!*jsonFile)
+        {
+            log << "ERROR: Failed creating " << Narrow(options.jsonFile) << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = jsonFile ? *jsonFile : log;
+
+    size_t threads = options.threads;
+    if (!threads)
+    {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto const start = clock::now();
+
+    FileQueue queue;
+    std::mutex outMutex;
+    size_t inspected = 0;
+    size_t failed = 0;
+
+    auto writeLine = [&](const std::string& line, bool success)
+    {
+        std::lock_guard<std::mutex> lock(outMutex);
+        out << line << '\n' << std::flush;
+
+        if (success)
+            ++inspected;
+        else
+            ++failed;
+    };
+
+    auto worker = [&]()
+    {
+        std::ostringstream line;
+        line << std::setprecision(7);
+
+        std::wstring path;
+        while (queue.Pop(path))
+        {
+            line.str(std::string());
+
+            bool success = false;
+            try
+            {
+                auto const data = ReadData(path.c_str());
+                auto model = ModelData::CreateFromMemory(data.data(), data.size(), GetExtension(path).c_str(), options.lhcoords);
+                WriteReport(line, path, *model, data.size());
+                success = true;
+            }
+            catch (const std::exception& e)
+            {
+                line.str(std::string());
+                WriteError(line, path, e.what());
+            }
+
+            writeLine(line.str(), success);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t j = 0; j < threads; ++j)
+    {
+        workers.emplace_back(worker);
+    }
+
+    // Searches the directories on this thread while the workers start on the first files.
+    std::vector<std::wstring> pending;
+    for (auto it = options.models.crbegin(); it != options.models.crend(); ++it)
+    {
+        pending.push_back(*it);
+    }
+
+    std::vector<std::wstring> files;
+    std::vector<std::wstring> subdirectories;
+    while (!pending.empty())
+    {
+        std::wstring path = std::move(pending.back());
+        pending.pop_back();
+
+        if (!IsDirectory(path))
+        {
+            queue.Push(std::move(path));
+            continue;
+        }
+
+        files.clear();
+        subdirectories.clear();
+        if (!ListDirectory(path, files, subdirectories))
+        {
+            std::ostringstream line;
+            WriteError(line, path, "Failed to read directory");
+            writeLine(line.str(), false);
+            continue;
+        }
+
+        for (auto& file : files)
+        {
+            queue.Push(std::move(file));
+        }
+
+        for (auto dir = subdirectories.rbegin(); dir != subdirectories.rend(); ++dir)
+        {
+            pending.emplace_back(std::move(*dir));
+        }
+    }
+
+    queue.Close();
+
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+
+    if (jsonFile)
+    {
+        using ms = std::chrono::duration<double, std::milli>;
+        log << inspected << " of " << (inspected + failed) << " models inspected in " << std::fixed << std::setprecision(2)
+            << ms(clock::now() - start).count() << " ms (" << threads << " threads)" << std::endl;
+    }
+
+    return (failed || !inspected) ? 1 : 0;
+}
@@ -0,0 +1,32 @@
+//--------------------------------------------------------------------------------------
+// File: ModelInspector.h
+//
+// Audits model files without rendering them: each is loaded with ModelData and described
+// by one line of JSON giving its header version, vertex layouts, index sizes, part
+// topologies, frame hierarchy, material textures, bounds, and estimated memory. Like the
+// headless renderer it needs no window or Direct3D device.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <ostream>
+
+
+namespace DX
+{
+    struct HeadlessOptions;
+
+    // Inspects every model in options.models; a directory is searched recursively for
+    // .sdkmesh, .cmo, and .vbo files. Files are read and parsed on options.threads threads
+    // (0 for one per hardware thread) while the directories are still being searched, and
+    // each report is written as soon as it is complete, so the output is in completion
+    // order rather than file order. A file that fails to load gets a line with its "file"
+    // and an "error" instead.
+    //
+    // Reports go to options.jsonFile if given, with a summary to 'log'; otherwise to 'log'
+    // alone. Returns 0 if every file loaded, 1 otherwise.
+    int RunInspector(const HeadlessOptions& options, std::ostream& log);
+}
@@ -0,0 +1,682 @@
+//--------------------------------------------------------------------------------------
+// File: ModelPicker.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "ModelPicker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_PacketWidth = 4;
+    constexpr size_t c_MaxLeafTriangles = 16;   // Before a split that doesn't pay off is forced anyway
+    constexpr size_t c_BinCount = 16;
+    constexpr uint32_t c_MaxDepth = 64;
+
+    struct BuildTriangle
+    {
+        XMFLOAT3    v[3];
+        XMFLOAT3    minimum;
+        XMFLOAT3    maximum;
+        XMFLOAT3    centroid;
+        uint32_t    part;
+        uint32_t    triangle;
+    };
+
+    struct Bounds
+    {
+        XMVECTOR    minimum;
+        XMVECTOR    maximum;
+
+        Bounds() noexcept :
+            minimum(XMVectorReplicate(FLT_MAX)),
+            maximum(XMVectorReplicate(-FLT_MAX))
+        {
+        }
+
+        void XM_CALLCONV Grow(FXMVECTOR point) noexcept
+        {
+            minimum = XMVectorMin(minimum, point);
+            maximum = XMVectorMax(maximum, point);
+        }
+
+        void Grow(const BuildTriangle& tri) noexcept
+        {
+            minimum = XMVectorMin(minimum, XMLoadFloat3(&tri.minimum));
+            maximum = XMVectorMax(maximum, XMLoadFloat3(&tri.maximum));
+        }
+
+        void Grow(const Bounds& other) noexcept
+        {
+            minimum = XMVectorMin(minimum, other.minimum);
+            maximum = XMVectorMax(maximum, other.maximum);
+        }
+
+        // Half the surface area; zero when empty.
+        float GetArea() const noexcept
+        {
+            XMFLOAT3 size;
+            XMStoreFloat3(&size, XMVectorMax(XMVectorSubtract(maximum, minimum), XMVectorZero()));
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+    };
+
+    inline float GetAxis(const XMFLOAT3& value, size_t axis) noexcept
+    {
+        return (axis == 0) ? value.x : ((axis == 1) ? value.y : value.z);
+    }
+
+    struct PacketRay
+    {
+        XMVECTOR    ox, oy, oz;
+        XMVECTOR    dx, dy, dz;
+    };
+
+    // Moller-Trumbore for one ray against four triangles at once. Returns the mask of
+    // lanes hit in (0, best), with their distances and barycentrics. A zero determinant
+    // (parallel or degenerate) gives infinities or NaNs, which fail the comparisons.
+    XMVECTOR XM_CALLCONV IntersectTriangles(const PacketRay& ray, const float (*v0)[4], const float (*e1)[4], const float (*e2)[4],
+        FXMVECTOR best, XMVECTOR& t, XMVECTOR& u, XMVECTOR& v) noexcept
+    {
+        const XMVECTOR e1x = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(e1[0]));
+        const XMVECTOR e1y = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(e1[1]));
+        const XMVECTOR e1z = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(e1[2]));
+        const XMVECTOR e2x = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(e2[0]));
+        const XMVECTOR e2y = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(e2[1]));
+        const XMVECTOR e2z = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(e2[2]));
+
+        // p = d x e2
+        const XMVECTOR px = XMVectorNegativeMultiplySubtract(ray.dz, e2y, XMVectorMultiply(ray.dy, e2z));
+        const XMVECTOR py = XMVectorNegativeMultiplySubtract(ray.dx, e2z, XMVectorMultiply(ray.dz, e2x));
+        const XMVECTOR pz = XMVectorNegativeMultiplySubtract(ray.dy, e2x, XMVectorMultiply(ray.dx, e2y));
+
+        const XMVECTOR det = XMVectorMultiplyAdd(e1z, pz, XMVectorMultiplyAdd(e1y, py, XMVectorMultiply(e1x, px)));
+        const XMVECTOR invDet = XMVectorReciprocal(det);
+
+        const XMVECTOR sx = XMVectorSubtract(ray.ox, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(v0[0])));
+        const XMVECTOR sy = XMVectorSubtract(ray.oy, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(v0[1])));
+        const XMVECTOR sz = XMVectorSubtract(ray.oz, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(v0[2])));
+
+        u = XMVectorMultiply(XMVectorMultiplyAdd(sz, pz, XMVectorMultiplyAdd(sy, py, XMVectorMultiply(sx, px))), invDet);
+
+        // q = s x e1
+        const XMVECTOR qx = XMVectorNegativeMultiplySubtract(sz, e1y, XMVectorMultiply(sy, e1z));
+        const XMVECTOR qy = XMVectorNegativeMultiplySubtract(sx, e1z, XMVectorMultiply(sz, e1x));
+        const XMVECTOR qz = XMVectorNegativeMultiplySubtract(sy, e1x, XMVectorMultiply(sx, e1y));
+
+        v = XMVectorMultiply(XMVectorMultiplyAdd(ray.dz, qz, XMVectorMultiplyAdd(ray.dy, qy, XMVectorMultiply(ray.dx, qx))), invDet);
+        t = XMVectorMultiply(XMVectorMultiplyAdd(e2z, qz, XMVectorMultiplyAdd(e2y, qy, XMVectorMultiply(e2x, qx))), invDet);
+
+        const XMVECTOR zero = XMVectorZero();
+        XMVECTOR mask = XMVectorAndInt(XMVectorGreaterOrEqual(u, zero), XMVectorGreaterOrEqual(v, zero));
+        mask = XMVectorAndInt(mask, XMVectorLessOrEqual(XMVectorAdd(u, v), g_XMOne));
+        mask = XMVectorAndInt(mask, XMVectorGreater(t, zero));
+        return XMVectorAndInt(mask, XMVectorLess(t, best));
+    }
+
+    // Distance at which the ray enters the box, if it does before 'best'.
+    bool XM_CALLCONV IntersectBox(const XMFLOAT3& minimum, const XMFLOAT3& maximum, FXMVECTOR origin, FXMVECTOR invDirection,
+        float best, float& entry) noexcept
+    {
+        const XMVECTOR t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&minimum), origin), invDirection);
+        const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&maximum), origin), invDirection);
+
+        XMFLOAT3 tNear, tFar;
+        XMStoreFloat3(&tNear, XMVectorMin(t0, t1));
+        XMStoreFloat3(&tFar, XMVectorMax(t0, t1));
+
+        const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+        const float leave = std::min(std::min(tFar.x, tFar.y), tFar.z);
+
+        entry = enter;
+        return enter <= leave && enter < best;
+    }
+
+    // Reads the triangles of one part; returns false if its buffers are out of range.
+    bool GatherTriangles(const ModelData& model, const ModelData::Part& part, uint32_t partIndex, std::vector<BuildTriangle>& triangles)
+    {
+        if (part.primitive != ModelData::Primitive::TriangleList && part.primitive != ModelData::Primitive::TriangleStrip)
+            return false;
+
+        if (part.vertexBuffer >= model.vertexBuffers.size() || part.indexBuffer >= model.indexBuffers.size())
+            return false;
+
+        auto const& positions = model.vertexBuffers[part.vertexBuffer].positions;
+        auto const& indices = model.indexBuffers[part.indexBuffer].indices;
+        if (uint64_t(part.startIndex) + part.indexCount > indices.size())
+            return false;
+
+        const uint32_t* source = indices.data() + part.startIndex;
+        const bool strip = (part.primitive == ModelData::Primitive::TriangleStrip);
+        const size_t count = ModelData::GetPrimitiveCount(part);
+
+        for (size_t k = 0; k < count; ++k)
+        {
+            const uint32_t* tri = strip ? source + k : source + k * 3;
+            if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+            {
+                // Degenerate, such as the joins of strips; never hit.
+                continue;
+            }
+
+            BuildTriangle item;
+            bool valid = true;
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const int64_t vertex = int64_t(tri[j]) + part.vertexOffset;
+                if (vertex < 0 || uint64_t(vertex) >= positions.size())
+                {
+                    valid = false;
+                    break;
+                }
+                item.v[j] = positions[static_cast<size_t>(vertex)];
+            }
+
+            if (!valid)
+                continue;
+
+            const XMVECTOR a = XMLoadFloat3(&item.v[0]);
+            const XMVECTOR b = XMLoadFloat3(&item.v[1]);
+            const XMVECTOR c = XMLoadFloat3(&item.v[2]);
+            XMStoreFloat3(&item.minimum, XMVectorMin(a, XMVectorMin(b, c)));
+            XMStoreFloat3(&item.maximum, XMVectorMax(a, XMVectorMax(b, c)));
+            XMStoreFloat3(&item.centroid, XMVectorScale(XMVectorAdd(a, XMVectorAdd(b, c)), 1.f / 3.f));
+            item.part = partIndex;
+            item.triangle = static_cast<uint32_t>(k);
+
+            triangles.push_back(item);
+        }
+
+        return true;
+    }
+
+    const std::string c_EmptyName;
+}
+
+void ModelPicker::Build(const ModelData& model)
+{
+    Clear();
+
+    m_meshNames.reserve(model.meshes.size());
+    for (auto const& mesh : model.meshes)
+    {
+        m_meshNames.push_back(mesh.name);
+    }
+
+    m_materialNames.reserve(model.materials.size());
+    for (auto const& material : model.materials)
+    {
+        m_materialNames.push_back(material.name);
+    }
+
+    std::vector<BuildTriangle> triangles;
+    triangles.reserve(model.GetTriangleCount());
+    m_meshBounds.reserve(model.meshes.size());
+    m_meshParts.reserve(model.meshes.size() + 1);
+    for (size_t m = 0; m < model.meshes.size(); ++m)
+    {
+        m_meshParts.push_back(static_cast<uint32_t>(m_parts.size()));
+
+        Bounds meshBounds;
+        auto const& parts = model.meshes[m].parts;
+        for (size_t p = 0; p < parts.size(); ++p)
+        {
+            const auto partIndex = static_cast<uint32_t>(m_parts.size());
+            const size_t first = triangles.size();
+            if (GatherTriangles(model, parts[p], partIndex, triangles))
+            {
+                Bounds partBounds;
+                for (size_t j = first; j < triangles.size(); ++j)
+                {
+                    partBounds.Grow(triangles[j]);
+                }
+                meshBounds.Grow(partBounds);
+
+                PartInfo info = { static_cast<uint32_t>(m), static_cast<uint32_t>(p), parts[p].material, {} };
+                XMStoreFloat3(&info.bounds.minimum, partBounds.minimum);
+                XMStoreFloat3(&info.bounds.maximum, partBounds.maximum);
+                m_parts.push_back(info);
+            }
+        }
+
+        Box box;
+        XMStoreFloat3(&box.minimum, meshBounds.minimum);
+        XMStoreFloat3(&box.maximum, meshBounds.maximum);
+        m_meshBounds.push_back(box);
+    }
+    m_meshParts.push_back(static_cast<uint32_t>(m_parts.size()));
+
+    if (triangles.empty())
+        return;
+
+    if (triangles.size() >= UINT32_MAX / 2)
+        throw std::runtime_error("Too many triangles to pick");
+
+    m_triangleCount = triangles.size();
+
+    // Top-down, splitting each node on the longest axis of its centroids at the bin
+    // boundary with the lowest surface area cost. Leaves hold triangle ranges until the
+    // packets are written below.
+    struct Range
+    {
+        uint32_t    node;
+        size_t      begin;
+        size_t      end;
+        uint32_t    depth;
+    };
+
+    std::vector<Range> stack;
+    stack.push_back({ 0, 0, triangles.size(), 0 });
+    m_nodes.resize(1);
+
+    while (!stack.empty())
+    {
+        const Range range = stack.back();
+        stack.pop_back();
+
+        Bounds bounds;
+        Bounds centroids;
+        for (size_t j = range.begin; j < range.end; ++j)
+        {
+            bounds.Grow(triangles[j]);
+            centroids.Grow(XMLoadFloat3(&triangles[j].centroid));
+        }
+
+        Node& node = m_nodes[range.node];
+        XMStoreFloat3(&node.minimum, bounds.minimum);
+        XMStoreFloat3(&node.maximum, bounds.maximum);
+        node.first = static_cast<uint32_t>(range.begin);
+        node.count = static_cast<uint32_t>(range.end - range.begin);
+
+        const size_t count = range.end - range.begin;
+        if (count <= c_PacketWidth || range.depth + 1 >= c_MaxDepth)
+            continue;
+
+        XMFLOAT3 cmin, cmax;
+        XMStoreFloat3(&cmin, centroids.minimum);
+        XMStoreFloat3(&cmax, centroids.maximum);
+        const XMFLOAT3 extents(cmax.x - cmin.x, cmax.y - cmin.y, cmax.z - cmin.z);
+
+        size_t axis = 0;
+        if (extents.y > GetAxis(extents, axis)) axis = 1;
+        if (extents.z > GetAxis(extents, axis)) axis = 2;
+
+        if (GetAxis(extents, axis) <= 0.f)
+        {
+            // Every centroid coincides; no split can separate them.
+            continue;
+        }
+
+        const float low = GetAxis(cmin, axis);
+        const float scale = float(c_BinCount) / GetAxis(extents, axis);
+        auto getBin = [&](const BuildTriangle& tri) noexcept
+        {
+            return std::min(static_cast<size_t>(std::max((GetAxis(tri.centroid, axis) - low) * scale, 0.f)), c_BinCount - 1);
+        };
+
+        Bounds binBounds[c_BinCount];
+        size_t binCounts[c_BinCount] = {};
+        for (size_t j = range.begin; j < range.end; ++j)
+        {
+            const size_t bin = getBin(triangles[j]);
+            binBounds[bin].Grow(triangles[j]);
+            ++binCounts[bin];
+        }
+
+        // Cost of splitting after each bin: area times triangle count on either side.
+        float rightCosts[c_BinCount] = {};
+        Bounds right;
+        size_t rightCount = 0;
+        for (size_t bin = c_BinCount - 1; bin > 0; --bin)
+        {
+            right.Grow(binBounds[bin]);
+            rightCount += binCounts[bin];
+            rightCosts[bin - 1] = right.GetArea() * float(rightCount);
+        }
+
+        size_t bestSplit = c_BinCount;
+        float bestCost = FLT_MAX;
+        Bounds left;
+        size_t leftCount = 0;
+        for (size_t bin = 0; bin + 1 < c_BinCount; ++bin)
+        {
+            left.Grow(binBounds[bin]);
+            leftCount += binCounts[bin];
+            if (!leftCount || leftCount == count)
+                continue;
+
+            const float cost = left.GetArea() * float(leftCount) + rightCosts[bin];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = bin;
+            }
+        }
+
+        const float leafCost = bounds.GetArea() * float(count);
+        if (count <= c_MaxLeafTriangles && bestCost >= leafCost)
+            continue;
+
+        size_t middle;
+        if (bestSplit < c_BinCount)
+        {
+            middle = static_cast<size_t>(std::partition(triangles.begin() + static_cast<ptrdiff_t>(range.begin),
+                triangles.begin() + static_cast<ptrdiff_t>(range.end),
+                [&](const BuildTriangle& tri) { return getBin(tri) <= bestSplit; }) - triangles.begin());
+        }
+        else
+        {
+            // The centroids all fall in one bin, so split at the median instead.
+            middle = range.begin + count / 2;
+            std::nth_element(triangles.begin() + static_cast<ptrdiff_t>(range.begin),
+                triangles.begin() + static_cast<ptrdiff_t>(middle),
+                triangles.begin() + static_cast<ptrdiff_t>(range.end),
+                [axis](const BuildTriangle& a, const BuildTriangle& b)
+                {
+                    return GetAxis(a.centroid, axis) < GetAxis(b.centroid, axis);
+                });
+        }
+
+        const auto child = static_cast<uint32_t>(m_nodes.size());
+        m_nodes[range.node].first = child;
+        m_nodes[range.node].count = 0;
+        m_nodes.resize(m_nodes.size() + 2);
+
+        stack.push_back({ child + 1, middle, range.end, range.depth + 1 });
+        stack.push_back({ child, range.begin, middle, range.depth + 1 });
+    }
+
+    // Each leaf's triangles become consecutive packets, padded with zero-area lanes.
+    m_packets.reserve(m_triangleCount / c_PacketWidth + m_nodes.size() / 2 + 1);
+    for (auto& node : m_nodes)
+    {
+        if (!node.count)
+            continue;
+
+        const size_t begin = node.first;
+        const size_t end = begin + node.count;
+        node.first = static_cast<uint32_t>(m_packets.size());
+        node.count = static_cast<uint32_t>((end - begin + c_PacketWidth - 1) / c_PacketWidth);
+
+        for (size_t j = begin; j < end; j += c_PacketWidth)
+        {
+            Packet packet = {};
+            for (size_t lane = 0; lane < c_PacketWidth; ++lane)
+            {
+                const size_t index = j + lane;
+                const BuildTriangle& tri = triangles[std::min(index, end - 1)];
+                const XMFLOAT3 e1(tri.v[1].x - tri.v[0].x, tri.v[1].y - tri.v[0].y, tri.v[1].z - tri.v[0].z);
+                const XMFLOAT3 e2(tri.v[2].x - tri.v[0].x, tri.v[2].y - tri.v[0].y, tri.v[2].z - tri.v[0].z);
+                const bool used = index < end;
+
+                packet.v0[0][lane] = tri.v[0].x;
+                packet.v0[1][lane] = tri.v[0].y;
+                packet.v0[2][lane] = tri.v[0].z;
+                packet.e1[0][lane] = used ? e1.x : 0.f;
+                packet.e1[1][lane] = used ? e1.y : 0.f;
+                packet.e1[2][lane] = used ? e1.z : 0.f;
+                packet.e2[0][lane] = used ? e2.x : 0.f;
+                packet.e2[1][lane] = used ? e2.y : 0.f;
+                packet.e2[2][lane] = used ? e2.z : 0.f;
+                packet.part[lane] = used ? tri.part : None;
+                packet.triangle[lane] = used ? tri.triangle : None;
+            }
+            m_packets.push_back(packet);
+        }
+    }
+}
+
+void ModelPicker::Clear() noexcept
+{
+    m_nodes.clear();
+    m_packets.clear();
+    m_parts.clear();
+    m_meshNames.clear();
+    m_meshBounds.clear();
+    m_meshParts.clear();
+    m_materialNames.clear();
+    m_triangleCount = 0;
+}
+
+size_t ModelPicker::GetMemoryUsage() const noexcept
+{
+    size_t bytes = m_nodes.capacity() * sizeof(Node)
+        + m_packets.capacity() * sizeof(Packet)
+        + m_parts.capacity() * sizeof(PartInfo)
+        + m_meshBounds.capacity() * sizeof(Box)
+        + m_meshParts.capacity() * sizeof(uint32_t)
+        + (m_meshNames.capacity() + m_materialNames.capacity()) * sizeof(std::string);
+
+    for (auto const& name : m_meshNames)
+    {
+        bytes += name.capacity();
+    }
+    for (auto const& name : m_materialNames)
+    {
+        bytes += name.capacity();
+    }
+    return bytes;
+}
+
+const std::string& ModelPicker::GetMeshName(uint32_t mesh) const noexcept
+{
+    return (mesh < m_meshNames.size()) ? m_meshNames[mesh] : c_EmptyName;
+}
+
+const std::string& ModelPicker::GetMaterialName(uint32_t material) const noexcept
+{
+    return (material < m_materialNames.size()) ? m_materialNames[material] : c_EmptyName;
+}
+
+bool ModelPicker::GetBounds(uint32_t mesh, uint32_t part, BoundingBox& box) const noexcept
+{
+    if (mesh >= m_meshBounds.size())
+        return false;
+
+    const Box* bounds = &m_meshBounds[mesh];
+    if (part != None)
+    {
+        bounds = nullptr;
+        for (uint32_t j = m_meshParts[mesh]; j < m_meshParts[size_t(mesh) + 1]; ++j)
+        {
+            if (m_parts[j].part == part)
+            {
+                bounds = &m_parts[j].bounds;
+                break;
+            }
+        }
+
+        if (!bounds)
+            return false;
+    }
+
+    const XMVECTOR minimum = XMLoadFloat3(&bounds->minimum);
+    const XMVECTOR maximum = XMLoadFloat3(&bounds->maximum);
+    if (!XMVector3LessOrEqual(minimum, maximum))
+        return false;
+
+    BoundingBox::CreateFromPoints(box, minimum, maximum);
+    return true;
+}
+
+void ModelPicker::FillHit(const Packet& packet, size_t lane, float t, float u, float v, Hit& hit) const noexcept
+{
+    auto const& part = m_parts[packet.part[lane]];
+    hit.distance = t;
+    hit.mesh = part.mesh;
+    hit.part = part.part;
+    hit.material = part.material;
+    hit.triangle = packet.triangle[lane];
+    hit.u = u;
+    hit.v = v;
+}
+
+bool XM_CALLCONV ModelPicker::Intersect(FXMVECTOR origin, FXMVECTOR direction, Hit& hit, float maxDistance) const noexcept
+{
+    if (m_nodes.empty())
+        return false;
+
+    const XMVECTOR invDirection = XMVectorReciprocal(direction);
+    const PacketRay ray = {
+        XMVectorSplatX(origin), XMVectorSplatY(origin), XMVectorSplatZ(origin),
+        XMVectorSplatX(direction), XMVectorSplatY(direction), XMVectorSplatZ(direction) };
+
+    float best = maxDistance;
+    bool found = false;
+
+    struct Entry
+    {
+        uint32_t    node;
+        float       entry;
+    };
+
+    // Each level pushes at most two children and pops one.
+    Entry stack[c_MaxDepth + 1];
+    size_t top = 0;
+
+    float entry;
+    if (IntersectBox(m_nodes[0].minimum, m_nodes[0].maximum, origin, invDirection, best, entry))
+    {
+        stack[top++] = { 0, entry };
+    }
+
+    while (top > 0)
+    {
+        const Entry current = stack[--top];
+        if (current.entry >= best)
+            continue;
+
+        const Node& node = m_nodes[current.node];
+        if (node.count)
+        {
+            for (uint32_t j = 0; j < node.count; ++j)
+            {
+                const Packet& packet = m_packets[node.first + j];
+
+                XMVECTOR t, u, v;
+                const XMVECTOR mask = IntersectTriangles(ray, packet.v0, packet.e1, packet.e2, XMVectorReplicate(best), t, u, v);
+                if (XMVector4EqualInt(mask, XMVectorFalseInt()))
+                    continue;
+
+                float tf[c_PacketWidth], uf[c_PacketWidth], vf[c_PacketWidth];
+                uint32_t hits[c_PacketWidth];
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(tf), t);
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(uf), u);
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(vf), v);
+                XMStoreUInt4(reinterpret_cast<XMUINT4*>(hits), mask);
+
+                for (size_t lane = 0; lane < c_PacketWidth; ++lane)
+                {
+                    const float laneT = tf[lane];
+                    if (hits[lane] && laneT < best)
+                    {
+                        best = laneT;
+                        found = true;
+                        FillHit(packet, lane, laneT, uf[lane], vf[lane], hit);
+                    }
+                }
+            }
+        }
+        else
+        {
+            float entries[2];
+            bool hits[2];
+            for (uint32_t j = 0; j < 2; ++j)
+            {
+                const Node& child = m_nodes[node.first + j];
+                hits[j] = IntersectBox(child.minimum, child.maximum, origin, invDirection, best, entries[j]);
+            }
+
+            // Visit the nearer child first, so the farther is more likely to be culled.
+            const uint32_t nearer = (hits[1] && (!hits[0] || entries[1] < entries[0])) ? 1u : 0u;
+            const uint32_t farther = 1u - nearer;
+            if (hits[farther])
+            {
+                stack[top++] = { node.first + farther, entries[farther] };
+            }
+            if (hits[nearer])
+            {
+                stack[top++] = { node.first + nearer, entries[nearer] };
+            }
+        }
+    }
+
+    return found;
+}
+
+bool XM_CALLCONV ModelPicker::IntersectLinear(FXMVECTOR origin, FXMVECTOR direction, Hit& hit, float maxDistance) const noexcept
+{
+    XMFLOAT3 o, d;
+    XMStoreFloat3(&o, origin);
+    XMStoreFloat3(&d, direction);
+
+    float best = maxDistance;
+    bool found = false;
+
+    for (auto const& packet : m_packets)
+    {
+        for (size_t lane = 0; lane < c_PacketWidth; ++lane)
+        {
+            if (packet.part[lane] == None)
+                continue;
+
+            const float e1[3] = { packet.e1[0][lane], packet.e1[1][lane], packet.e1[2][lane] };
+            const float e2[3] = { packet.e2[0][lane], packet.e2[1][lane], packet.e2[2][lane] };
+            const float s[3] = { o.x - packet.v0[0][lane], o.y - packet.v0[1][lane], o.z - packet.v0[2][lane] };
+
+            const float p[3] = { d.y * e2[2] - d.z * e2[1], d.z * e2[0] - d.x * e2[2], d.x * e2[1] - d.y * e2[0] };
+            const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+            if (det == 0.f)
+                continue;
+
+            const float invDet = 1.f / det;
+            const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+            if (!(u >= 0.f && u <= 1.f))
+                continue;
+
+            const float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+            const float v = (d.x * q[0] + d.y * q[1] + d.z * q[2]) * invDet;
+            if (!(v >= 0.f && u + v <= 1.f))
+                continue;
+
+            const float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+            if (t > 0.f && t < best)
+            {
+                best = t;
+                found = true;
+                FillHit(packet, lane, t, u, v, hit);
+            }
+        }
+    }
+
+    return found;
+}
+
+void XM_CALLCONV ModelPicker::ComputeRay(float x, float y, float width, float height,
+    FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection, XMVECTOR& origin, XMVECTOR& direction) noexcept
+{
+    const XMVECTOR nearPoint = XMVector3Unproject(XMVectorSet(x, y, 0.f, 0.f), 0.f, 0.f, width, height, 0.f, 1.f, projection, view, world);
+    const XMVECTOR farPoint = XMVector3Unproject(XMVectorSet(x, y, 1.f, 0.f), 0.f, 0.f, width, height, 0.f, 1.f, projection, view, world);
+
+    origin = nearPoint;
+    direction = XMVector3Normalize(XMVectorSubtract(farPoint, nearPoint));
+}
@@ -0,0 +1,135 @@
+//--------------------------------------------------------------------------------------
+// File: ModelPicker.h
+//
+// Ray casting against the triangles of a ModelData, for picking meshes with the mouse.
+// The triangles of every mesh are gathered into a bounding volume hierarchy built with
+// the surface area heuristic, whose leaves store their triangles four at a time as
+// structure-of-arrays packets, so one ray is tested against four triangles at once with
+// DirectXMath. Only the hierarchy and packets are kept, not the ModelData.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ModelData.h"
+
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace DX
+{
+    class ModelPicker
+    {
+    public:
+        static constexpr uint32_t None = UINT32_MAX;
+
+        struct Hit
+        {
+            float       distance;       // In multiples of the ray's direction
+            uint32_t    mesh;
+            uint32_t    part;           // Within the mesh
+            uint32_t    material;       // None if the part has no material
+            uint32_t    triangle;       // Within the part, in drawing order
+            float       u;              // Barycentric weights of the triangle's second and third vertices
+            float       v;
+        };
+
+        ModelPicker() noexcept : m_triangleCount(0) {}
+
+        ModelPicker(ModelPicker&&) = default;
+        ModelPicker& operator= (ModelPicker&&) = default;
+
+        ModelPicker(ModelPicker const&) = delete;
+        ModelPicker& operator= (ModelPicker const&) = delete;
+
+        // Gathers the triangle lists and strips of every part; lines, points, and indices
+        // outside of the vertex buffer are skipped.
+        void Build(const ModelData& model);
+
+        void Clear() noexcept;
+
+        size_t GetTriangleCount() const noexcept { return m_triangleCount; }
+        size_t GetNodeCount() const noexcept { return m_nodes.size(); }
+        size_t GetPacketCount() const noexcept { return m_packets.size(); }
+        size_t GetMemoryUsage() const noexcept;
+
+        // Empty if out of range.
+        const std::string& GetMeshName(uint32_t mesh) const noexcept;
+        const std::string& GetMaterialName(uint32_t material) const noexcept;
+
+        // Tight object-space bounds of the triangles of one part of a mesh, or of the
+        // whole mesh for part == None, as recorded by Build. Returns false if there are
+        // none.
+        bool GetBounds(uint32_t mesh, uint32_t part, DirectX::BoundingBox& box) const noexcept;
+
+        // Finds the nearest triangle, from either side, along origin + t * direction for
+        // t in (0, maxDistance). Returns false if none is hit.
+        bool XM_CALLCONV Intersect(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, Hit& hit, float maxDistance = FLT_MAX) const noexcept;
+
+        // Same result from testing every triangle in turn, one at a time, for checking
+        // Intersect.
+        bool XM_CALLCONV IntersectLinear(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, Hit& hit, float maxDistance = FLT_MAX) const noexcept;
+
+        // The ray in object space through a point in the viewport, in pixels from its
+        // top-left corner, with the same matrices as used for drawing. The direction is
+        // normalized, so hit distances are in object units.
+        static void XM_CALLCONV ComputeRay(float x, float y, float width, float height,
+            DirectX::FXMMATRIX world, DirectX::CXMMATRIX view, DirectX::CXMMATRIX projection,
+            DirectX::XMVECTOR& origin, DirectX::XMVECTOR& direction) noexcept;
+
+    private:
+        // Children are allocated in pairs, so the second child follows the first.
+        struct Node
+        {
+            DirectX::XMFLOAT3   minimum;
+            uint32_t            first;      // First packet of a leaf, otherwise the first child
+            DirectX::XMFLOAT3   maximum;
+            uint32_t            count;      // Packets in a leaf; 0 otherwise
+        };
+
+        // Four triangles as a first vertex and two edges; unused lanes have zero edges.
+        struct Packet
+        {
+            float               v0[3][4];   // x, y, and z of each lane
+            float               e1[3][4];
+            float               e2[3][4];
+            uint32_t            part[4];    // Index into m_parts
+            uint32_t            triangle[4];
+        };
+
+        // Empty when the minimum is above the maximum.
+        struct Box
+        {
+            DirectX::XMFLOAT3   minimum;
+            DirectX::XMFLOAT3   maximum;
+        };
+
+        struct PartInfo
+        {
+            uint32_t            mesh;
+            uint32_t            part;
+            uint32_t            material;
+            Box                 bounds;
+        };
+
+        void FillHit(const Packet& packet, size_t lane, float t, float u, float v, Hit& hit) const noexcept;
+
+        std::vector<Node>           m_nodes;
+        std::vector<Packet>         m_packets;
+        std::vector<PartInfo>       m_parts;
+        std::vector<std::string>    m_meshNames;
+        std::vector<Box>            m_meshBounds;
+        std::vector<uint32_t>       m_meshParts;        // First entry in m_parts of each mesh, then the count
+        std::vector<std::string>    m_materialNames;
+        size_t                      m_triangleCount;
+    };
+}
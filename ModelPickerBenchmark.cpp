@@ -0,0 +1,100 @@
+//--------------------------------------------------------------------------------------
+// File: ModelPickerBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "ModelPicker.h"
+
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    // Picking rays per side of the grid cast through the front view, and how many of them
+    // are checked against testing every triangle.
+    constexpr size_t c_PickGridSize = 128;
+    constexpr size_t c_PickCheckStride = 256;
+}
+
+void DX::BenchmarkPicking(const ModelData& model, uint32_t iterations, bool lhcoords,
+    BenchmarkReport::Model& result, std::ostream& log)
+{
+    ModelPicker picker;
+    const auto pickBuild = TimeStage(iterations, [&]() { picker.Build(model); });
+
+    std::vector<std::pair<XMFLOAT3, XMFLOAT3>> rays;
+    {
+        XMMATRIX viewMatrix, projMatrix;
+        std::ignore = GetHeadlessViewMatrices(model, HeadlessView::Front, 1.f, lhcoords, viewMatrix, projMatrix);
+
+        rays.resize(c_PickGridSize * c_PickGridSize);
+        for (size_t j = 0; j < rays.size(); ++j)
+        {
+            XMVECTOR origin, direction;
+            ModelPicker::ComputeRay(float(j % c_PickGridSize) + 0.5f, float(j / c_PickGridSize) + 0.5f,
+                float(c_PickGridSize), float(c_PickGridSize), XMMatrixIdentity(), viewMatrix, projMatrix, origin, direction);
+            XMStoreFloat3(&rays[j].first, origin);
+            XMStoreFloat3(&rays[j].second, direction);
+        }
+    }
+
+    size_t rayHits = 0;
+    const auto pickRays = TimeStage(iterations, [&]()
+    {
+        rayHits = 0;
+        ModelPicker::Hit hit;
+        for (auto const& ray : rays)
+        {
+            if (picker.Intersect(XMLoadFloat3(&ray.first), XMLoadFloat3(&ray.second), hit))
+                ++rayHits;
+        }
+    });
+
+    double linearMs = 0.;
+    for (size_t j = 0; j < rays.size(); j += c_PickCheckStride)
+    {
+        ModelPicker::Hit hit, expected;
+        const XMVECTOR origin = XMLoadFloat3(&rays[j].first);
+        const XMVECTOR direction = XMLoadFloat3(&rays[j].second);
+        const bool found = picker.Intersect(origin, direction, hit);
+
+        auto const start = std::chrono::steady_clock::now();
+        const bool expectedFound = picker.IntersectLinear(origin, direction, expected);
+        linearMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (found != expectedFound
+            || (found && std::abs(hit.distance - expected.distance) > 1e-4f * std::max(expected.distance, 1.f)))
+        {
+            throw std::runtime_error("Picking hierarchy misses the nearest triangle");
+        }
+    }
+
+    result.stages.insert(result.stages.end(), { { "pick_build", pickBuild }, { "pick_rays", pickRays } });
+
+    const double checkedRays = double((rays.size() + c_PickCheckStride - 1) / c_PickCheckStride);
+    log << "  picking: " << picker.GetNodeCount() << " nodes, " << picker.GetPacketCount() << " packets, "
+        << std::fixed << std::setprecision(1) << (100. * double(rayHits) / double(rays.size())) << "% of " << rays.size() << " rays hit, "
+        << std::setprecision(2) << (pickRays.meanMs > 0. ? double(rays.size()) / pickRays.meanMs / 1000. : 0.) << " Mrays/s, "
+        << std::setprecision(0) << (pickRays.meanMs > 0. ? (linearMs / checkedRays) / (pickRays.meanMs / double(rays.size())) : 0.)
+        << "x faster than testing every triangle" << std::endl;
+}
@@ -0,0 +1,682 @@
+//--------------------------------------------------------------------------------------
+// File: ModelScene.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "ModelScene.h"
+
+#include "ReadData.h"
+#include "SDKMesh.h"
+
+#include <map>
+#include <set>
+#include <tuple>
+
+using namespace DirectX;
+using namespace DX;
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    // Contents are compared by size and a 64-bit hash; a collision between two files of
+    // the same size would share the wrong resource, which is accepted for a viewer.
+    using ContentKey = std::pair<uint64_t, uint64_t>;
+
+    // Staging readback of vertex and index buffers is done in batches of this many bytes.
+    constexpr size_t c_ShareBatchBytes = 64u * 1024u * 1024u;
+
+    uint64_t Mix(uint64_t hash, uint64_t value) noexcept
+    {
+        hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+        return hash ^ (hash >> 32);
+    }
+
+    ContentKey HashContents(_In_reads_bytes_(size) const void* data, size_t size) noexcept
+    {
+        auto bytes = static_cast<const uint8_t*>(data);
+
+        uint64_t hash = 0xCBF29CE484222325ull;
+        size_t j = 0;
+        for (; j + sizeof(uint64_t) <= size; j += sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, bytes + j, sizeof(word));
+            hash = Mix(hash, word);
+        }
+        for (; j < size; ++j)
+        {
+            hash = Mix(hash, bytes[j]);
+        }
+
+        return ContentKey(Mix(hash, size), size);
+    }
+
+    std::string Narrow(const wchar_t* str)
+    {
+        const int len = WideCharToMultiByte(CP_UTF8, 0, str, -1, nullptr, 0, nullptr, nullptr);
+        if (len <= 1)
+            return std::string();
+
+        std::string result(static_cast<size_t>(len), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, str, -1, &result[0], len, nullptr, nullptr);
+        result.resize(static_cast<size_t>(len) - 1);
+        return result;
+    }
+
+    // Shares textures and effects by contents rather than by name, since models from
+    // different directories can use one name for different files, or different names for
+    // the same file. The base factory's own name cache is turned off.
+    template<class Base>
+    class SharingFactory : public Base
+    {
+    public:
+        SharingFactory(_In_ ID3D11Device* device, ModelScene::TextureList& textures,
+            ModelScene::SharedCount& textureCount, ModelScene::SharedCount& effectCount) :
+            Base(device),
+            m_textureList(textures),
+            m_textureCount(textureCount),
+            m_effectCount(effectCount)
+        {
+            Base::SetSharing(false);
+        }
+
+        void SetModelDirectory(const std::wstring& directory)
+        {
+            m_directory = directory;
+            Base::SetDirectory(directory.empty() ? nullptr : directory.c_str());
+        }
+
+        std::shared_ptr<IEffect> __cdecl CreateEffect(_In_ const IEffectFactory::EffectInfo& info, _In_opt_ ID3D11DeviceContext* deviceContext) override
+        {
+            ++m_effectCount.loaded;
+
+            uint64_t hash = 0;
+            hash = Mix(hash, (info.perVertexColor ? 1u : 0u) | (info.enableSkinning ? 2u : 0u)
+                | (info.enableDualTexture ? 4u : 0u) | (info.enableNormalMaps ? 8u : 0u) | (info.biasedVertexNormals ? 16u : 0u));
+
+            const float values[] =
+            {
+                info.specularPower, info.alpha,
+                info.ambientColor.x, info.ambientColor.y, info.ambientColor.z,
+                info.diffuseColor.x, info.diffuseColor.y, info.diffuseColor.z,
+                info.specularColor.x, info.specularColor.y, info.specularColor.z,
+                info.emissiveColor.x, info.emissiveColor.y, info.emissiveColor.z,
+            };
+            const ContentKey material = HashContents(values, sizeof(values));
+            hash = Mix(hash, material.first);
+
+            for (const wchar_t* name : { info.diffuseTexture, info.specularTexture, info.normalTexture, info.emissiveTexture })
+            {
+                const ContentKey texture = (name && *name) ? GetTextureKey(name) : ContentKey();
+                hash = Mix(Mix(hash, texture.first), texture.second);
+            }
+
+            const auto it = m_effects.find(hash);
+            if (it != m_effects.end())
+                return it->second;
+
+            auto effect = Base::CreateEffect(info, deviceContext);
+            m_effects.emplace(hash, effect);
+            ++m_effectCount.unique;
+            return effect;
+        }
+
+        void __cdecl CreateTexture(_In_z_ const wchar_t* name, _In_opt_ ID3D11DeviceContext* deviceContext, _Outptr_ ID3D11ShaderResourceView** textureView) override
+        {
+            ++m_textureCount.loaded;
+
+            const ContentKey key = GetTextureKey(name);
+
+            const auto it = m_textures.find(key);
+            if (it != m_textures.end())
+            {
+                it->second.CopyTo(textureView);
+                return;
+            }
+
+            Base::CreateTexture(name, deviceContext, textureView);
+
+            if (*textureView)
+            {
+                m_textures.emplace(key, *textureView);
+                ++m_textureCount.unique;
+
+                ComPtr<ID3D11Resource> resource;
+                (*textureView)->GetResource(resource.GetAddressOf());
+                m_textureList.emplace_back(Narrow(name), std::move(resource));
+            }
+        }
+
+    private:
+        // Files that can't be read are keyed by path, so they still fail in the base factory.
+        ContentKey GetTextureKey(_In_z_ const wchar_t* name)
+        {
+            const std::wstring path = m_directory + name;
+
+            const auto it = m_textureKeys.find(path);
+            if (it != m_textureKeys.end())
+                return it->second;
+
+            ContentKey key;
+            try
+            {
+                std::vector<uint8_t> data;
+                try
+                {
+                    data = ReadData(path.c_str());
+                }
+                catch (const std::exception&)
+                {
+                    data = ReadData(name);
+                }
+                key = HashContents(data.data(), data.size());
+            }
+            catch (const std::exception&)
+            {
+                key = HashContents(path.c_str(), path.size() * sizeof(wchar_t));
+                key.second = 0;
+            }
+
+            m_textureKeys.emplace(path, key);
+            return key;
+        }
+
+        ModelScene::TextureList&                                m_textureList;
+        ModelScene::SharedCount&                                m_textureCount;
+        ModelScene::SharedCount&                                m_effectCount;
+        std::wstring                                            m_directory;
+        std::map<std::wstring, ContentKey>                      m_textureKeys;
+        std::map<ContentKey, ComPtr<ID3D11ShaderResourceView>> m_textures;
+        std::map<uint64_t, std::shared_ptr<IEffect>>            m_effects;
+    };
+
+    bool IsSDKMESH2(const std::vector<uint8_t>& data) noexcept
+    {
+        if (data.size() < sizeof(DXUT::SDKMESH_HEADER))
+            return false;
+
+        auto hdr = reinterpret_cast<const DXUT::SDKMESH_HEADER*>(data.data());
+        return hdr->Version >= 200;
+    }
+
+    void Accumulate(ModelData::Statistics& total, const ModelData::Statistics& stats) noexcept
+    {
+        total.meshes += stats.meshes;
+        total.subsets += stats.subsets;
+        total.vertexBuffers += stats.vertexBuffers;
+        total.indexBuffers += stats.indexBuffers;
+        total.vertices += stats.vertices;
+        total.indices += stats.indices;
+        total.triangles += stats.triangles;
+        total.lines += stats.lines;
+        total.points += stats.points;
+        total.unsupportedSubsets += stats.unsupportedSubsets;
+        total.skinned = total.skinned || stats.skinned;
+    }
+}
+
+std::unique_ptr<Model> DX::CreateModelFromMemory(ID3D11Device* device, const uint8_t* data, size_t dataSize,
+    const wchar_t* extension, IEffectFactory& fxFactory, bool lhcoords, std::shared_ptr<IEffect> vboEffect)
+{
+    if (_wcsicmp(extension, L".sdkmesh") == 0)
+    {
+        ModelLoaderFlags flags = lhcoords ? ModelLoader_CounterClockwise : ModelLoader_Clockwise;
+        flags |= ModelLoader_IncludeBones;
+        return Model::CreateFromSDKMESH(device, data, dataSize, fxFactory, flags);
+    }
+    else if (_wcsicmp(extension, L".cmo") == 0)
+    {
+        ModelLoaderFlags flags = lhcoords ? ModelLoader_Clockwise : ModelLoader_CounterClockwise;
+        flags |= ModelLoader_IncludeBones;
+        return Model::CreateFromCMO(device, data, dataSize, fxFactory, flags);
+    }
+    else if (_wcsicmp(extension, L".vbo") == 0)
+    {
+        const ModelLoaderFlags flags = lhcoords ? ModelLoader_CounterClockwise : ModelLoader_Clockwise;
+        return Model::CreateFromVBO(device, data, dataSize, std::move(vboEffect), flags);
+    }
+
+    throw std::invalid_argument("Unknown model file type");
+}
+
+ModelScene::ModelScene() noexcept :
+    m_stats{},
+    m_totalMeshes(0),
+    m_occluded(0),
+    m_ccw(false)
+{
+}
+
+void ModelScene::Clear() noexcept
+{
+    m_models.clear();
+    m_occluders.clear();
+    m_instances.clear();
+    m_effects.clear();
+    m_visible.clear();
+    m_visibleOccluders.clear();
+    m_textures.clear();
+    m_stats = {};
+    m_firstError.clear();
+    m_boundingSphere = {};
+    m_boundingBox = {};
+    m_totalMeshes = 0;
+    m_occluded = 0;
+    m_ccw = false;
+}
+
+void ModelScene::Load(ID3D11Device* device, ID3D11DeviceContext* context, const std::vector<SceneEntry>& entries, bool lhcoords)
+{
+    Clear();
+
+    SharingFactory<EffectFactory> fxFactory(device, m_textures, m_stats.textures, m_stats.effects);
+    fxFactory.EnableForceSRGB(true);
+
+    SharingFactory<PBREffectFactory> pbrFXFactory(device, m_textures, m_stats.textures, m_stats.effects);
+
+    // VBO files have no materials, so they all get the same effect.
+    std::shared_ptr<BasicEffect> vboEffect;
+
+    std::map<ContentKey, size_t> modelsByContents;
+    std::vector<ModelData::Statistics> modelStats;
+
+    for (auto const& entry : entries)
+    {
+        try
+        {
+            auto const data = ReadData(entry.fileName.c_str());
+
+            const ContentKey key = HashContents(data.data(), data.size());
+
+            auto it = modelsByContents.find(key);
+            if (it == modelsByContents.end())
+            {
+                const size_t slash = entry.fileName.find_last_of(L"\\/");
+                const size_t dot = entry.fileName.find_last_of(L'.');
+                const std::wstring ext = (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash))
+                    ? std::wstring() : entry.fileName.substr(dot);
+                const std::wstring directory = (slash == std::wstring::npos) ? std::wstring() : entry.fileName.substr(0, slash + 1);
+
+                std::unique_ptr<Model> model;
+                if (_wcsicmp(ext.c_str(), L".vbo") == 0)
+                {
+                    if (!vboEffect)
+                    {
+                        vboEffect = std::make_shared<BasicEffect>(device);
+                        vboEffect->EnableDefaultLighting();
+                        vboEffect->SetLightingEnabled(true);
+                        ++m_stats.effects.unique;
+                    }
+                    ++m_stats.effects.loaded;
+
+                    model = CreateModelFromMemory(device, data.data(), data.size(), ext.c_str(), fxFactory, lhcoords, vboEffect);
+                }
+                else if (_wcsicmp(ext.c_str(), L".sdkmesh") == 0 && IsSDKMESH2(data))
+                {
+                    pbrFXFactory.SetModelDirectory(directory);
+                    model = CreateModelFromMemory(device, data.data(), data.size(), ext.c_str(), pbrFXFactory, lhcoords);
+                }
+                else
+                {
+                    fxFactory.SetModelDirectory(directory);
+                    model = CreateModelFromMemory(device, data.data(), data.size(), ext.c_str(), fxFactory, lhcoords);
+                }
+
+                ModelData::Statistics stats = {};
+                try
+                {
+                    stats = ModelData::ReadStatistics(data.data(), data.size(), ext.c_str());
+                }
+                catch (const std::exception&)
+                {
+                    // Direct3D loaded the model, so only the HUD counts are lost.
+                }
+
+                std::vector<OcclusionCuller::OccluderMesh> occluders;
+                try
+                {
+                    auto const geometry = ModelData::CreateFromMemory(data.data(), data.size(), ext.c_str(), lhcoords);
+                    OcclusionCuller::BuildOccluders(*geometry, occluders);
+                    if (occluders.size() != model->meshes.size())
+                    {
+                        occluders.clear();
+                    }
+                }
+                catch (const std::exception&)
+                {
+                    // Only occlusion culling is lost for this model.
+                    occluders.clear();
+                }
+
+                it = modelsByContents.emplace(key, m_models.size()).first;
+                m_models.emplace_back(std::move(model));
+                m_occluders.emplace_back(std::move(occluders));
+                modelStats.push_back(stats);
+            }
+
+            m_instances.push_back({ it->second, entry.transform });
+            Accumulate(m_stats.geometry, modelStats[it->second]);
+        }
+        catch (const std::exception& e)
+        {
+            if (!m_stats.failed)
+            {
+                wchar_t error[512] = {};
+                swprintf_s(error, L"Scene line %u: %ls: %hs", entry.line, entry.fileName.c_str(), e.what());
+                m_firstError = error;
+            }
+            ++m_stats.failed;
+        }
+    }
+
+    m_stats.instances = m_instances.size();
+    m_stats.models = m_models.size();
+
+    ShareBuffers(device, context);
+
+    // Distinct effects; the scene has no animation, so skinned parts are drawn in bind pose.
+    std::set<IEffect*> effects;
+    for (auto const& model : m_models)
+    {
+        for (auto const& mesh : model->meshes)
+        {
+            for (auto const& part : mesh->meshParts)
+            {
+                effects.insert(part->effect.get());
+            }
+        }
+    }
+    effects.erase(nullptr);
+    m_effects.assign(effects.begin(), effects.end());
+
+    for (auto effect : m_effects)
+    {
+        auto skinning = dynamic_cast<IEffectSkinning*>(effect);
+        if (skinning)
+        {
+            skinning->ResetBoneTransforms();
+        }
+    }
+
+    // Bounds of every instance, for the camera.
+    bool first = true;
+    for (auto const& instance : m_instances)
+    {
+        const XMMATRIX transform = XMLoadFloat4x4(&instance.transform);
+        for (auto const& mesh : m_models[instance.model]->meshes)
+        {
+            BoundingSphere sphere;
+            mesh->boundingSphere.Transform(sphere, transform);
+            BoundingBox box;
+            mesh->boundingBox.Transform(box, transform);
+
+            if (first)
+            {
+                m_boundingSphere = sphere;
+                m_boundingBox = box;
+                first = false;
+            }
+            else
+            {
+                BoundingSphere::CreateMerged(m_boundingSphere, m_boundingSphere, sphere);
+                BoundingBox::CreateMerged(m_boundingBox, m_boundingBox, box);
+            }
+        }
+
+        m_totalMeshes += m_models[instance.model]->meshes.size();
+    }
+
+    if (!m_models.empty() && !m_models.front()->meshes.empty())
+    {
+        m_ccw = m_models.front()->meshes.front()->ccw;
+    }
+}
+
+// Reads back every distinct vertex and index buffer and points all parts that use
+// identical contents at one of them; the others are released with their last reference.
+void ModelScene::ShareBuffers(ID3D11Device* device, ID3D11DeviceContext* context)
+{
+    std::vector<ID3D11Buffer*> buffers;
+    {
+        std::set<ID3D11Buffer*> seen;
+        auto add = [&](ID3D11Buffer* buffer)
+            {
+                if (buffer && seen.insert(buffer).second)
+                {
+                    buffers.push_back(buffer);
+                }
+            };
+
+        for (auto const& model : m_models)
+        {
+            for (auto const& mesh : model->meshes)
+            {
+                for (auto const& part : mesh->meshParts)
+                {
+                    add(part->vertexBuffer.Get());
+                    add(part->indexBuffer.Get());
+                }
+            }
+        }
+    }
+
+    std::map<std::tuple<UINT, uint64_t, uint64_t>, ID3D11Buffer*> canonical;
+    std::map<ID3D11Buffer*, ID3D11Buffer*> replacement;
+
+    for (size_t start = 0; start < buffers.size(); )
+    {
+        // Queue the copies for a batch before the first Map waits on them.
+        std::vector<std::pair<ID3D11Buffer*, ComPtr<ID3D11Buffer>>> batch;
+        size_t batchBytes = 0;
+        for (; start < buffers.size() && batchBytes < c_ShareBatchBytes; ++start)
+        {
+            D3D11_BUFFER_DESC desc = {};
+            buffers[start]->GetDesc(&desc);
+
+            if (desc.BindFlags & D3D11_BIND_VERTEX_BUFFER)
+                ++m_stats.vertexBuffers.loaded;
+            else
+                ++m_stats.indexBuffers.loaded;
+
+            D3D11_BUFFER_DESC stagingDesc = {};
+            stagingDesc.ByteWidth = desc.ByteWidth;
+            stagingDesc.Usage = D3D11_USAGE_STAGING;
+            stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+            ComPtr<ID3D11Buffer> staging;
+            if (desc.MiscFlags != 0 || FAILED(device->CreateBuffer(&stagingDesc, nullptr, staging.GetAddressOf())))
+            {
+                // Left as loaded.
+                replacement.emplace(buffers[start], buffers[start]);
+                continue;
+            }
+
+            context->CopyResource(staging.Get(), buffers[start]);
+            batch.emplace_back(buffers[start], std::move(staging));
+            batchBytes += desc.ByteWidth;
+        }
+
+        for (auto const& it : batch)
+        {
+            D3D11_BUFFER_DESC desc = {};
+            it.first->GetDesc(&desc);
+
+            D3D11_MAPPED_SUBRESOURCE mapped = {};
+            if (FAILED(context->Map(it.second.Get(), 0, D3D11_MAP_READ, 0, &mapped)))
+            {
+                replacement.emplace(it.first, it.first);
+                continue;
+            }
+
+            const ContentKey key = HashContents(mapped.pData, desc.ByteWidth);
+            context->Unmap(it.second.Get(), 0);
+
+            auto match = canonical.emplace(std::make_tuple(desc.BindFlags, key.first, key.second), it.first).first;
+            replacement.emplace(it.first, match->second);
+        }
+    }
+
+    for (auto const& it : replacement)
+    {
+        if (it.first != it.second)
+            continue;
+
+        D3D11_BUFFER_DESC desc = {};
+        it.first->GetDesc(&desc);
+
+        if (desc.BindFlags & D3D11_BIND_VERTEX_BUFFER)
+            ++m_stats.vertexBuffers.unique;
+        else
+            ++m_stats.indexBuffers.unique;
+    }
+
+    auto share = [&](ComPtr<ID3D11Buffer>& buffer)
+        {
+            if (buffer)
+            {
+                auto const it = replacement.find(buffer.Get());
+                if (it != replacement.end() && it->second != buffer.Get())
+                {
+                    buffer = it->second;
+                }
+            }
+        };
+
+    for (auto const& model : m_models)
+    {
+        for (auto const& mesh : model->meshes)
+        {
+            for (auto const& part : mesh->meshParts)
+            {
+                share(part->vertexBuffer);
+                share(part->indexBuffer);
+            }
+        }
+    }
+}
+
+void XM_CALLCONV ModelScene::Draw(ID3D11DeviceContext* context, const CommonStates& states,
+    FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection, bool rhcoords, bool wireframe, OcclusionCuller* occlusion)
+{
+    BoundingFrustum frustum;
+    BoundingFrustum::CreateFromMatrix(frustum, projection, rhcoords);
+    frustum.Transform(frustum, XMMatrixInverse(nullptr, view));
+
+    m_visible.clear();
+    for (auto const& instance : m_instances)
+    {
+        const XMMATRIX instanceWorld = XMMatrixMultiply(XMLoadFloat4x4(&instance.transform), world);
+        auto const& meshes = m_models[instance.model]->meshes;
+        for (size_t j = 0; j < meshes.size(); ++j)
+        {
+            BoundingSphere sphere;
+            meshes[j]->boundingSphere.Transform(sphere, instanceWorld);
+            if (frustum.Intersects(sphere))
+            {
+                m_visible.push_back({ meshes[j].get(), &instance, j });
+            }
+        }
+    }
+
+    m_occluded = 0;
+    if (occlusion)
+    {
+        // A mesh never hides itself: its box is nearer than any of its own triangles.
+        m_visibleOccluders.clear();
+        for (auto const& it : m_visible)
+        {
+            auto const& occluders = m_occluders[it.instance->model];
+            if (occluders.empty())
+                continue;
+
+            OcclusionCuller::Occluder occluder = { &occluders[it.index], {},
+                it.mesh->ccw ? OcclusionCuller::CullMode::CounterClockwise : OcclusionCuller::CullMode::Clockwise };
+            XMStoreFloat4x4(&occluder.world, XMMatrixMultiply(XMLoadFloat4x4(&it.instance->transform), world));
+            m_visibleOccluders.push_back(occluder);
+        }
+
+        occlusion->RenderOccluders(m_visibleOccluders.data(), m_visibleOccluders.size(), XMMatrixMultiply(view, projection));
+
+        auto const end = std::remove_if(m_visible.begin(), m_visible.end(), [&](const VisibleMesh& it)
+            {
+                const XMMATRIX instanceWorld = XMMatrixMultiply(XMLoadFloat4x4(&it.instance->transform), world);
+                return occlusion->IsOccluded(it.mesh->boundingBox, instanceWorld);
+            });
+        m_occluded = static_cast<size_t>(m_visible.end() - end);
+        m_visible.erase(end, m_visible.end());
+    }
+
+    // Every opaque part in the scene before any alpha part, as Model::Draw does for one model.
+    for (const bool alpha : { false, true })
+    {
+        for (auto const& it : m_visible)
+        {
+            const XMMATRIX instanceWorld = XMMatrixMultiply(XMLoadFloat4x4(&it.instance->transform), world);
+            it.mesh->PrepareForRendering(context, states, alpha, wireframe);
+            it.mesh->Draw(context, instanceWorld, view, projection, alpha);
+        }
+    }
+}
+
+size_t ModelScene::GetOccluderMemoryUsage() const noexcept
+{
+    size_t bytes = m_occluders.capacity() * sizeof(std::vector<OcclusionCuller::OccluderMesh>)
+        + m_visibleOccluders.capacity() * sizeof(OcclusionCuller::Occluder);
+    for (auto const& occluders : m_occluders)
+    {
+        bytes += occluders.capacity() * sizeof(OcclusionCuller::OccluderMesh);
+        for (auto const& mesh : occluders)
+        {
+            bytes += mesh.GetMemoryUsage();
+        }
+    }
+    return bytes;
+}
+
+void ModelScene::UpdateEffects(const std::function<void(IEffect*)>& setEffect)
+{
+    for (auto effect : m_effects)
+    {
+        setEffect(effect);
+    }
+}
+
+void ModelScene::CreateInputLayouts(ID3D11Device* device)
+{
+    for (auto const& model : m_models)
+    {
+        for (auto const& mesh : model->meshes)
+        {
+            for (auto const& part : mesh->meshParts)
+            {
+                part->CreateInputLayout(device, part->effect.get(), part->inputLayout.ReleaseAndGetAddressOf());
+            }
+        }
+    }
+}
+
+void ModelScene::SetCounterClockwise(bool ccw) noexcept
+{
+    if (ccw == m_ccw)
+        return;
+
+    for (auto const& model : m_models)
+    {
+        for (auto const& mesh : model->meshes)
+        {
+            mesh->ccw = ccw;
+        }
+    }
+
+    m_ccw = ccw;
+}
+
+void ModelScene::GetBounds(BoundingSphere& sphere, BoundingBox& box) const noexcept
+{
+    sphere = m_boundingSphere;
+    box = m_boundingBox;
+}
@@ -0,0 +1,147 @@
+//--------------------------------------------------------------------------------------
+// File: ModelScene.h
+//
+// Many models loaded at once, each drawn with its own transform. A file listed more than
+// once, or two files with the same contents, is loaded once and drawn as instances.
+// Vertex and index buffers, textures, and effects that are identical across different
+// files are found by hashing their contents and shared. Every instance goes through one
+// culling pass and one submission: all visible opaque meshes, then all alpha meshes. The
+// culling pass can also test the meshes in view against each other for occlusion.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ModelData.h"
+#include "OcclusionCuller.h"
+#include "SceneFile.h"
+
+#include <wrl/client.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace DX
+{
+    // Loads a .sdkmesh, .cmo, or .vbo as the viewer does, including bones, with the
+    // winding order that matches 'lhcoords'. VBO files have no materials, so they use
+    // 'vboEffect' if given, or a default lit BasicEffect. Throws std::invalid_argument for
+    // other extensions.
+    std::unique_ptr<DirectX::Model> CreateModelFromMemory(_In_ ID3D11Device* device,
+        _In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, _In_z_ const wchar_t* extension,
+        DirectX::IEffectFactory& fxFactory, bool lhcoords, std::shared_ptr<DirectX::IEffect> vboEffect = nullptr);
+
+    class ModelScene
+    {
+    public:
+        using TextureList = std::vector<std::pair<std::string, Microsoft::WRL::ComPtr<ID3D11Resource>>>;
+
+        struct SharedCount
+        {
+            size_t      loaded;         // As requested by the model loaders
+            size_t      unique;         // Left after sharing identical contents
+        };
+
+        struct Statistics
+        {
+            size_t                  instances;
+            size_t                  models;         // Distinct files, compared by contents
+            size_t                  failed;         // Entries whose model could not be loaded
+            ModelData::Statistics   geometry;       // Summed over instances
+            SharedCount             vertexBuffers;
+            SharedCount             indexBuffers;
+            SharedCount             textures;
+            SharedCount             effects;
+        };
+
+        ModelScene() noexcept;
+
+        ModelScene(ModelScene&&) = default;
+        ModelScene& operator= (ModelScene&&) = default;
+
+        ModelScene(ModelScene const&) = delete;
+        ModelScene& operator= (ModelScene const&) = delete;
+
+        // Entries whose model can't be loaded are skipped and counted as failed; the first
+        // error is kept for display. Skinned models are drawn without their bones.
+        void Load(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context, const std::vector<SceneEntry>& entries, bool lhcoords);
+
+        void Clear() noexcept;
+
+        bool IsEmpty() const noexcept { return m_instances.empty(); }
+
+        // Culls each instance's meshes against the view frustum, then draws the opaque parts
+        // of every visible mesh followed by the alpha parts. 'world' applies to the whole
+        // scene, after each instance's own transform. With 'occlusion', the meshes in view
+        // are drawn into its depth buffer as occluders, and those hidden behind the others
+        // are culled as well.
+        void XM_CALLCONV Draw(_In_ ID3D11DeviceContext* context, const DirectX::CommonStates& states,
+            DirectX::FXMMATRIX world, DirectX::CXMMATRIX view, DirectX::CXMMATRIX projection, bool rhcoords, bool wireframe,
+            _In_opt_ OcclusionCuller* occlusion = nullptr);
+
+        // Visits each distinct effect once.
+        void UpdateEffects(const std::function<void(DirectX::IEffect*)>& setEffect);
+
+        // Needed after changing an effect in a way that changes its shader.
+        void CreateInputLayouts(_In_ ID3D11Device* device);
+
+        void SetCounterClockwise(bool ccw) noexcept;
+
+        // Merged bounds of every instance.
+        void GetBounds(DirectX::BoundingSphere& sphere, DirectX::BoundingBox& box) const noexcept;
+
+        const Statistics& GetStatistics() const noexcept { return m_stats; }
+        const std::wstring& GetFirstError() const noexcept { return m_firstError; }
+
+        // Meshes drawn by the last Draw, and meshes over all instances.
+        size_t GetVisibleMeshes() const noexcept { return m_visible.size(); }
+        size_t GetTotalMeshes() const noexcept { return m_totalMeshes; }
+
+        // Meshes in view that the last Draw culled for occlusion.
+        size_t GetOccludedMeshes() const noexcept { return m_occluded; }
+
+        size_t GetOccluderMemoryUsage() const noexcept;
+
+        const std::vector<std::unique_ptr<DirectX::Model>>& GetModels() const noexcept { return m_models; }
+        const TextureList& GetTextures() const noexcept { return m_textures; }
+
+    private:
+        struct Instance
+        {
+            size_t                  model;
+            DirectX::XMFLOAT4X4     transform;
+        };
+
+        struct VisibleMesh
+        {
+            const DirectX::ModelMesh*   mesh;
+            const Instance*             instance;
+            size_t                      index;      // Of the mesh in its model
+        };
+
+        void ShareBuffers(_In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context);
+
+        std::vector<std::unique_ptr<DirectX::Model>>    m_models;
+        std::vector<std::vector<OcclusionCuller::OccluderMesh>> m_occluders;    // Per model; empty if its geometry couldn't be read
+        std::vector<Instance>                           m_instances;
+        std::vector<DirectX::IEffect*>                  m_effects;
+        std::vector<VisibleMesh>                        m_visible;
+        std::vector<OcclusionCuller::Occluder>          m_visibleOccluders;
+        TextureList                                     m_textures;
+        Statistics                                      m_stats;
+        std::wstring                                    m_firstError;
+        DirectX::BoundingSphere                         m_boundingSphere;
+        DirectX::BoundingBox                            m_boundingBox;
+        size_t                                          m_totalMeshes;
+        size_t                                          m_occluded;
+        bool                                            m_ccw;
+    };
+}
@@ -0,0 +1,679 @@
+//--------------------------------------------------------------------------------------
+// File: OcclusionCuller.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "OcclusionCuller.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_MaxSize = 4096;
+
+    // Occluders covering fewer pixels than this hide too little to be worth drawing.
+    constexpr float c_MinOccluderPixels = 16.f;
+
+    // Near, left, right, bottom, and top; the far plane needs no clipping since depths
+    // past it never pass the min against the cleared buffer.
+    constexpr size_t c_ClipPlanes = 5;
+    constexpr size_t c_MaxClipVertices = 3 + c_ClipPlanes;
+
+    constexpr XMVECTORF32 c_LaneOffsets = { { { 0.f, 1.f, 2.f, 3.f } } };
+
+    // Bit per clip plane the position is outside of.
+    uint32_t XM_CALLCONV OutCode(FXMVECTOR position) noexcept
+    {
+        XMFLOAT4 p;
+        XMStoreFloat4(&p, position);
+        return ((p.z < 0.f) ? 1u : 0u)
+            | ((p.x < -p.w) ? 2u : 0u)
+            | ((p.x > p.w) ? 4u : 0u)
+            | ((p.y < -p.w) ? 8u : 0u)
+            | ((p.y > p.w) ? 16u : 0u);
+    }
+
+    float XM_CALLCONV PlaneDistance(FXMVECTOR position, size_t plane) noexcept
+    {
+        XMFLOAT4 p;
+        XMStoreFloat4(&p, position);
+        switch (plane)
+        {
+        case 0:     return p.z;
+        case 1:     return p.w + p.x;
+        case 2:     return p.w - p.x;
+        case 3:     return p.w + p.y;
+        default:    return p.w - p.y;
+        }
+    }
+
+    // Screen-space bounds of a box, in pixels from the top-left corner.
+    struct ScreenRect
+    {
+        float   minX;
+        float   minY;
+        float   maxX;
+        float   maxY;
+        float   nearZ;
+        bool    crossesNear;
+    };
+
+    ScreenRect XM_CALLCONV ProjectBox(const BoundingBox& box, FXMMATRIX worldViewProj, float width, float height) noexcept
+    {
+        XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+        box.GetCorners(corners);
+
+        XMVECTOR minimum = XMVectorReplicate(FLT_MAX);
+        XMVECTOR maximum = XMVectorReplicate(-FLT_MAX);
+        for (auto const& corner : corners)
+        {
+            const XMVECTOR clip = XMVector3Transform(XMLoadFloat3(&corner), worldViewProj);
+            if (XMVectorGetZ(clip) <= 0.f)
+            {
+                // Reaches the eye side of the near plane, where the projection flips.
+                ScreenRect rect = {};
+                rect.crossesNear = true;
+                return rect;
+            }
+
+            const XMVECTOR ndc = XMVectorDivide(clip, XMVectorSplatW(clip));
+            minimum = XMVectorMin(minimum, ndc);
+            maximum = XMVectorMax(maximum, ndc);
+        }
+
+        // y points down on screen.
+        ScreenRect rect;
+        rect.minX = (XMVectorGetX(minimum) * 0.5f + 0.5f) * width;
+        rect.maxX = (XMVectorGetX(maximum) * 0.5f + 0.5f) * width;
+        rect.minY = (0.5f - XMVectorGetY(maximum) * 0.5f) * height;
+        rect.maxY = (0.5f - XMVectorGetY(minimum) * 0.5f) * height;
+        rect.nearZ = XMVectorGetZ(minimum);
+        rect.crossesNear = false;
+        return rect;
+    }
+
+    float HorizontalMax(FXMVECTOR v) noexcept
+    {
+        XMFLOAT4 lanes;
+        XMStoreFloat4(&lanes, v);
+        return std::max(std::max(lanes.x, lanes.y), std::max(lanes.z, lanes.w));
+    }
+}
+
+//--------------------------------------------------------------------------------------
+struct OcclusionCuller::Triangle
+{
+    // Edge functions a * x + b * y + c of pixel (x, y), non-negative where the pixel's
+    // center is inside the edge.
+    float       a[3];
+    float       b[3];
+    float       c[3];
+
+    // The farthest depth of the triangle within pixel (x, y) is at most
+    // z + dzdx * x + dzdy * y, and never more than maxZ.
+    float       z;
+    float       dzdx;
+    float       dzdy;
+    float       maxZ;
+
+    int32_t     minX;               // Pixels with centers inside the bounds, inclusive
+    int32_t     minY;
+    int32_t     maxX;
+    int32_t     maxY;
+};
+
+// Triangles set up by one thread, binned by tile.
+struct OcclusionCuller::Worker
+{
+    std::vector<Triangle>               triangles;
+    std::vector<std::vector<uint32_t>>  bins;
+    std::vector<XMFLOAT4>               clip;       // Positions of the current occluder
+
+    void Reset(size_t tileCount)
+    {
+        triangles.clear();
+        bins.resize(tileCount);
+        for (auto& bin : bins)
+        {
+            bin.clear();
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------
+size_t OcclusionCuller::OccluderMesh::GetMemoryUsage() const noexcept
+{
+    return positions.capacity() * sizeof(XMFLOAT3) + indices.capacity() * sizeof(uint32_t);
+}
+
+OcclusionCuller::OcclusionCuller(size_t width, size_t height, TaskPool* pool) :
+    m_width(0),
+    m_height(0),
+    m_pitch(0),
+    m_rows(0),
+    m_tilesX(0),
+    m_tilesY(0),
+    m_blocksX(0),
+    m_viewProjection{},
+    m_pool(pool),
+    m_workerCount(pool ? pool->GetThreadCount() : 1),
+    m_triangleBudget(DefaultTriangleBudget),
+    m_stats{}
+{
+    XMStoreFloat4x4(&m_viewProjection, XMMatrixIdentity());
+    m_workers.reset(new Worker[m_workerCount]);
+    SetSize(width, height);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::SetSize(size_t width, size_t height)
+{
+    if (!width || !height || width > c_MaxSize || height > c_MaxSize)
+        throw std::invalid_argument("OcclusionCuller::SetSize");
+
+    if (width == m_width && height == m_height)
+        return;
+
+    m_width = width;
+    m_height = height;
+    m_tilesX = (width + TileSize - 1) / TileSize;
+    m_tilesY = (height + TileSize - 1) / TileSize;
+    m_pitch = m_tilesX * TileSize;
+    m_rows = m_tilesY * TileSize;
+    m_blocksX = m_pitch / BlockSize;
+
+    // The padding past the viewport stays at the far plane, so blocks straddling its
+    // edge keep a conservative maximum.
+    m_depth.assign(m_pitch * m_rows, 1.f);
+    m_blockMaxDepth.assign(m_blocksX * (m_rows / BlockSize), 1.f);
+}
+
+void OcclusionCuller::SetSizeForViewport(size_t width, size_t height)
+{
+    if (!width || !height)
+        throw std::invalid_argument("OcclusionCuller::SetSizeForViewport");
+
+    constexpr size_t defaultWidth = DefaultWidth;
+    const size_t bufferWidth = std::min(width, defaultWidth);
+    const size_t bufferHeight = std::min(std::max<size_t>((height * bufferWidth + width / 2) / width, 1), c_MaxSize);
+    SetSize(bufferWidth, bufferHeight);
+}
+
+void OcclusionCuller::BuildOccluders(const ModelData& model, std::vector<OccluderMesh>& meshes)
+{
+    meshes.clear();
+    meshes.resize(model.meshes.size());
+
+    std::unordered_map<uint64_t, uint32_t> remap;
+    for (size_t m = 0; m < model.meshes.size(); ++m)
+    {
+        auto& occluder = meshes[m];
+        remap.clear();
+
+        for (auto const& part : model.meshes[m].parts)
+        {
+            if (part.primitive != ModelData::Primitive::TriangleList && part.primitive != ModelData::Primitive::TriangleStrip)
+                continue;
+
+            if (part.material < model.materials.size() && model.materials[part.material].isAlpha)
+                continue;
+
+            if (part.vertexBuffer >= model.vertexBuffers.size() || part.indexBuffer >= model.indexBuffers.size())
+                continue;
+
+            auto const& positions = model.vertexBuffers[part.vertexBuffer].positions;
+            auto const& indices = model.indexBuffers[part.indexBuffer].indices;
+            if (uint64_t(part.startIndex) + part.indexCount > indices.size())
+                continue;
+
+            const uint32_t* source = indices.data() + part.startIndex;
+            const bool strip = (part.primitive == ModelData::Primitive::TriangleStrip);
+            const size_t count = ModelData::GetPrimitiveCount(part);
+
+            for (size_t k = 0; k < count; ++k)
+            {
+                const uint32_t* tri = strip ? source + k : source + k * 3;
+                if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+                    continue;
+
+                // Every other triangle of a strip is wound the other way.
+                uint32_t order[3] = { tri[0], tri[1], tri[2] };
+                if (strip && (k & 1))
+                {
+                    std::swap(order[0], order[1]);
+                }
+
+                int64_t vertices[3];
+                bool valid = true;
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    vertices[j] = int64_t(order[j]) + part.vertexOffset;
+                    if (vertices[j] < 0 || uint64_t(vertices[j]) >= positions.size())
+                    {
+                        valid = false;
+                        break;
+                    }
+                }
+
+                if (!valid)
+                    continue;
+
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    const uint64_t key = (uint64_t(part.vertexBuffer) << 32) | uint64_t(vertices[j]);
+                    auto it = remap.find(key);
+                    if (it == remap.end())
+                    {
+                        it = remap.emplace(key, static_cast<uint32_t>(occluder.positions.size())).first;
+                        occluder.positions.push_back(positions[static_cast<size_t>(vertices[j])]);
+                    }
+                    occluder.indices.push_back(it->second);
+                }
+            }
+        }
+
+        if (occluder.positions.empty())
+        {
+            occluder.bounds = model.meshes[m].boundingBox;
+        }
+        else
+        {
+            BoundingBox::CreateFromPoints(occluder.bounds, occluder.positions.size(), occluder.positions.data(), sizeof(XMFLOAT3));
+        }
+    }
+}
+
+size_t OcclusionCuller::GetMemoryUsage() const noexcept
+{
+    size_t bytes = m_depth.capacity() * sizeof(float) + m_blockMaxDepth.capacity() * sizeof(float)
+        + m_ranked.capacity() * sizeof(std::pair<float, size_t>) + m_selected.capacity() * sizeof(size_t);
+
+    for (size_t j = 0; j < m_workerCount; ++j)
+    {
+        auto const& worker = m_workers[j];
+        bytes += worker.triangles.capacity() * sizeof(Triangle) + worker.clip.capacity() * sizeof(XMFLOAT4);
+        for (auto const& bin : worker.bins)
+        {
+            bytes += bin.capacity() * sizeof(uint32_t);
+        }
+    }
+
+    return bytes;
+}
+
+//--------------------------------------------------------------------------------------
+void XM_CALLCONV OcclusionCuller::RenderOccluders(const Occluder* occluders, size_t count, FXMMATRIX viewProjection)
+{
+    m_stats = {};
+    XMStoreFloat4x4(&m_viewProjection, viewProjection);
+
+    std::fill(m_depth.begin(), m_depth.end(), 1.f);
+    std::fill(m_blockMaxDepth.begin(), m_blockMaxDepth.end(), 1.f);
+
+    // Largest on screen first; any that cross the near plane are close enough to come
+    // before all others.
+    const float width = float(m_width);
+    const float height = float(m_height);
+
+    m_ranked.clear();
+    for (size_t j = 0; j < count; ++j)
+    {
+        auto const& occluder = occluders[j];
+        if (!occluder.mesh || occluder.mesh->indices.empty())
+            continue;
+
+        const XMMATRIX worldViewProj = XMMatrixMultiply(XMLoadFloat4x4(&occluder.world), viewProjection);
+        const ScreenRect rect = ProjectBox(occluder.mesh->bounds, worldViewProj, width, height);
+
+        float area = FLT_MAX;
+        if (!rect.crossesNear)
+        {
+            const float w = std::min(rect.maxX, width) - std::max(rect.minX, 0.f);
+            const float h = std::min(rect.maxY, height) - std::max(rect.minY, 0.f);
+            if (w <= 0.f || h <= 0.f || rect.nearZ > 1.f)
+                continue;
+
+            area = w * h;
+            if (area < c_MinOccluderPixels)
+                continue;
+        }
+
+        m_ranked.emplace_back(area, j);
+    }
+
+    std::sort(m_ranked.begin(), m_ranked.end(), [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b)
+        {
+            return a.first > b.first;
+        });
+
+    m_selected.clear();
+    size_t remaining = m_triangleBudget;
+    for (auto const& it : m_ranked)
+    {
+        const size_t triangles = occluders[it.second].mesh->GetTriangleCount();
+        if (triangles <= remaining)
+        {
+            m_selected.push_back(it.second);
+            remaining -= triangles;
+        }
+    }
+
+    const size_t tileCount = m_tilesX * m_tilesY;
+    for (size_t j = 0; j < m_workerCount; ++j)
+    {
+        m_workers[j].Reset(tileCount);
+    }
+
+    auto setup = [&](size_t begin, size_t end, size_t worker)
+    {
+        for (size_t j = begin; j < end; ++j)
+        {
+            SetupOccluder(occluders[m_selected[j]], viewProjection, m_workers[worker]);
+        }
+    };
+
+    auto rasterize = [&](size_t begin, size_t end, size_t)
+    {
+        for (size_t tile = begin; tile < end; ++tile)
+        {
+            RasterizeTile(tile);
+        }
+    };
+
+    if (m_pool)
+    {
+        m_pool->ParallelFor(m_selected.size(), 1, setup);
+        m_pool->ParallelFor(tileCount, 1, rasterize);
+    }
+    else
+    {
+        setup(0, m_selected.size(), 0);
+        rasterize(0, tileCount, 0);
+    }
+
+    m_stats.occluders = m_selected.size();
+    for (size_t j = 0; j < m_workerCount; ++j)
+    {
+        m_stats.triangles += m_workers[j].triangles.size();
+    }
+}
+
+bool XM_CALLCONV OcclusionCuller::IsOccluded(const BoundingBox& box, FXMMATRIX world) noexcept
+{
+    ++m_stats.tested;
+
+    const ScreenRect rect = ProjectBox(box, XMMatrixMultiply(world, XMLoadFloat4x4(&m_viewProjection)), float(m_width), float(m_height));
+    if (rect.crossesNear)
+        return false;
+
+    const float maxX = float(m_width - 1);
+    const float maxY = float(m_height - 1);
+    if (rect.maxX < 0.f || rect.maxY < 0.f || rect.minX > maxX + 1.f || rect.minY > maxY + 1.f)
+        return false;
+
+    // Every pixel the rectangle touches and a border of one more, for the partly covered
+    // pixels along occluder silhouettes.
+    const auto x0 = static_cast<size_t>(std::max(std::floor(rect.minX) - 1.f, 0.f));
+    const auto y0 = static_cast<size_t>(std::max(std::floor(rect.minY) - 1.f, 0.f));
+    const auto x1 = static_cast<size_t>(std::max(std::min(std::ceil(rect.maxX), maxX), float(x0)));
+    const auto y1 = static_cast<size_t>(std::max(std::min(std::ceil(rect.maxY), maxY), float(y0)));
+
+    for (size_t by = y0 / BlockSize; by <= y1 / BlockSize; ++by)
+    {
+        for (size_t bx = x0 / BlockSize; bx <= x1 / BlockSize; ++bx)
+        {
+            if (m_blockMaxDepth[by * m_blocksX + bx] < rect.nearZ)
+                continue;
+
+            const size_t px0 = std::max(x0, bx * BlockSize);
+            const size_t px1 = std::min(x1, bx * BlockSize + BlockSize - 1);
+            const size_t py0 = std::max(y0, by * BlockSize);
+            const size_t py1 = std::min(y1, by * BlockSize + BlockSize - 1);
+            for (size_t y = py0; y <= py1; ++y)
+            {
+                const float* row = m_depth.data() + y * m_pitch;
+                for (size_t x = px0; x <= px1; ++x)
+                {
+                    if (row[x] >= rect.nearZ)
+                        return false;
+                }
+            }
+        }
+    }
+
+    ++m_stats.occluded;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------
+void XM_CALLCONV OcclusionCuller::SetupOccluder(const Occluder& occluder, FXMMATRIX viewProjection, Worker& worker) const
+{
+    auto const& mesh = *occluder.mesh;
+    const XMMATRIX worldViewProj = XMMatrixMultiply(XMLoadFloat4x4(&occluder.world), viewProjection);
+
+    worker.clip.resize(mesh.positions.size());
+    XMVector3TransformStream(worker.clip.data(), sizeof(XMFLOAT4), mesh.positions.data(), sizeof(XMFLOAT3),
+        mesh.positions.size(), worldViewProj);
+
+    const size_t triangleCount = mesh.GetTriangleCount();
+    for (size_t k = 0; k < triangleCount; ++k)
+    {
+        const uint32_t* tri = mesh.indices.data() + k * 3;
+
+        XMVECTOR clip[c_MaxClipVertices];
+        uint32_t codes[3];
+        for (size_t j = 0; j < 3; ++j)
+        {
+            clip[j] = XMLoadFloat4(&worker.clip[tri[j]]);
+            codes[j] = OutCode(clip[j]);
+        }
+
+        if (codes[0] & codes[1] & codes[2])
+            continue;
+
+        const uint32_t crossed = codes[0] | codes[1] | codes[2];
+        if (!crossed)
+        {
+            SetupTriangle(clip, occluder.cullMode, worker);
+            continue;
+        }
+
+        // Sutherland-Hodgman against each plane crossed, then a fan of what's left.
+        size_t vertexCount = 3;
+        for (size_t plane = 0; plane < c_ClipPlanes && vertexCount >= 3; ++plane)
+        {
+            if (!(crossed & (1u << plane)))
+                continue;
+
+            XMVECTOR input[c_MaxClipVertices];
+            std::copy(clip, clip + vertexCount, input);
+
+            size_t outputCount = 0;
+            for (size_t j = 0; j < vertexCount; ++j)
+            {
+                const XMVECTOR a = input[j];
+                const XMVECTOR b = input[(j + 1) % vertexCount];
+                const float da = PlaneDistance(a, plane);
+                const float db = PlaneDistance(b, plane);
+
+                if (da >= 0.f)
+                {
+                    clip[outputCount++] = a;
+                }
+                if ((da >= 0.f) != (db >= 0.f))
+                {
+                    clip[outputCount++] = XMVectorLerp(a, b, da / (da - db));
+                }
+            }
+            vertexCount = outputCount;
+        }
+
+        for (size_t j = 2; j < vertexCount; ++j)
+        {
+            const XMVECTOR fan[3] = { clip[0], clip[j - 1], clip[j] };
+            SetupTriangle(fan, occluder.cullMode, worker);
+        }
+    }
+}
+
+void OcclusionCuller::SetupTriangle(const XMVECTOR* clip, CullMode cullMode, Worker& worker) const
+{
+    const float width = float(m_width);
+    const float height = float(m_height);
+
+    float x[3], y[3], z[3];
+    for (size_t j = 0; j < 3; ++j)
+    {
+        XMFLOAT4 p;
+        XMStoreFloat4(&p, clip[j]);
+        const float invW = 1.f / p.w;
+        x[j] = (p.x * invW * 0.5f + 0.5f) * width;
+        y[j] = (0.5f - p.y * invW * 0.5f) * height;
+        z[j] = p.z * invW;
+    }
+
+    // With y pointing down, a positive area means the triangle is clockwise on screen.
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0.f)
+        return;
+
+    if ((area > 0.f && cullMode == CullMode::Clockwise)
+        || (area < 0.f && cullMode == CullMode::CounterClockwise))
+        return;
+
+    // Pixels whose centers are inside the bounds.
+    Triangle tri;
+    const float minX = std::max(std::ceil(std::min(x[0], std::min(x[1], x[2])) - 0.5f), 0.f);
+    const float minY = std::max(std::ceil(std::min(y[0], std::min(y[1], y[2])) - 0.5f), 0.f);
+    const float maxX = std::min(std::floor(std::max(x[0], std::max(x[1], x[2])) - 0.5f), width - 1.f);
+    const float maxY = std::min(std::floor(std::max(y[0], std::max(y[1], y[2])) - 0.5f), height - 1.f);
+    if (minX > maxX || minY > maxY)
+        return;
+
+    tri.minX = static_cast<int32_t>(minX);
+    tri.minY = static_cast<int32_t>(minY);
+    tri.maxX = static_cast<int32_t>(maxX);
+    tri.maxY = static_cast<int32_t>(maxY);
+
+    // Edge j runs from vertex j to the next, positive inside, evaluated at pixel centers.
+    const float sign = (area > 0.f) ? 1.f : -1.f;
+    for (size_t j = 0; j < 3; ++j)
+    {
+        const size_t k = (j + 1) % 3;
+        const float a = (y[j] - y[k]) * sign;
+        const float b = (x[k] - x[j]) * sign;
+        const float c = (x[j] * y[k] - x[k] * y[j]) * sign;
+
+        tri.a[j] = a;
+        tri.b[j] = b;
+        tri.c[j] = c + 0.5f * (a + b);
+    }
+
+    // The depth plane at the pixel's farthest corner, so the depth written is never
+    // nearer than the surface anywhere in the pixel.
+    const float dzdx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    const float dzdy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+    tri.dzdx = dzdx;
+    tri.dzdy = dzdy;
+    tri.z = z[0] - dzdx * x[0] - dzdy * y[0] + 0.5f * (dzdx + dzdy) + 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+    tri.maxZ = std::max(z[0], std::max(z[1], z[2]));
+
+    const auto index = static_cast<uint32_t>(worker.triangles.size());
+    worker.triangles.push_back(tri);
+
+    for (size_t ty = size_t(tri.minY) / TileSize; ty <= size_t(tri.maxY) / TileSize; ++ty)
+    {
+        for (size_t tx = size_t(tri.minX) / TileSize; tx <= size_t(tri.maxX) / TileSize; ++tx)
+        {
+            worker.bins[ty * m_tilesX + tx].push_back(index);
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTile(size_t tile) noexcept
+{
+    const size_t tileX = (tile % m_tilesX) * TileSize;
+    const size_t tileY = (tile / m_tilesX) * TileSize;
+
+    for (size_t w = 0; w < m_workerCount; ++w)
+    {
+        auto const& worker = m_workers[w];
+        for (const uint32_t index : worker.bins[tile])
+        {
+            auto const& tri = worker.triangles[index];
+
+            const size_t x0 = std::max(size_t(tri.minX), tileX);
+            const size_t x1 = std::min(size_t(tri.maxX), tileX + TileSize - 1);
+            const size_t y0 = std::max(size_t(tri.minY), tileY);
+            const size_t y1 = std::min(size_t(tri.maxY), tileY + TileSize - 1);
+
+            const XMVECTOR a0 = XMVectorReplicate(tri.a[0]);
+            const XMVECTOR a1 = XMVectorReplicate(tri.a[1]);
+            const XMVECTOR a2 = XMVectorReplicate(tri.a[2]);
+            const XMVECTOR dzdx = XMVectorReplicate(tri.dzdx);
+            const XMVECTOR maxZ = XMVectorReplicate(tri.maxZ);
+            const XMVECTOR first = XMVectorReplicate(float(x0));
+            const XMVECTOR last = XMVectorReplicate(float(x1));
+
+            for (size_t y = y0; y <= y1; ++y)
+            {
+                const float fy = float(y);
+                const XMVECTOR c0 = XMVectorReplicate(tri.b[0] * fy + tri.c[0]);
+                const XMVECTOR c1 = XMVectorReplicate(tri.b[1] * fy + tri.c[1]);
+                const XMVECTOR c2 = XMVectorReplicate(tri.b[2] * fy + tri.c[2]);
+                const XMVECTOR rowZ = XMVectorReplicate(tri.dzdy * fy + tri.z);
+
+                float* row = m_depth.data() + y * m_pitch;
+                for (size_t x = x0 & ~size_t(3); x <= x1; x += 4)
+                {
+                    const XMVECTOR px = XMVectorAdd(XMVectorReplicate(float(x)), c_LaneOffsets);
+
+                    XMVECTOR mask = XMVectorAndInt(XMVectorGreaterOrEqual(px, first), XMVectorLessOrEqual(px, last));
+                    mask = XMVectorAndInt(mask, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a0, px, c0), g_XMZero));
+                    mask = XMVectorAndInt(mask, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a1, px, c1), g_XMZero));
+                    mask = XMVectorAndInt(mask, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a2, px, c2), g_XMZero));
+                    if (XMVector4EqualInt(mask, XMVectorFalseInt()))
+                        continue;
+
+                    const XMVECTOR z = XMVectorMin(XMVectorMultiplyAdd(dzdx, px, rowZ), maxZ);
+                    const XMVECTOR depth = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + x));
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + x), XMVectorSelect(depth, XMVectorMin(depth, z), mask));
+                }
+            }
+        }
+    }
+
+    // The hierarchy of the tile's blocks.
+    for (size_t by = tileY; by < tileY + TileSize; by += BlockSize)
+    {
+        for (size_t bx = tileX; bx < tileX + TileSize; bx += BlockSize)
+        {
+            XMVECTOR maximum = g_XMZero;
+            for (size_t y = by; y < by + BlockSize; ++y)
+            {
+                const float* row = m_depth.data() + y * m_pitch + bx;
+                for (size_t x = 0; x < BlockSize; x += 4)
+                {
+                    maximum = XMVectorMax(maximum, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + x)));
+                }
+            }
+            m_blockMaxDepth[(by / BlockSize) * m_blocksX + bx / BlockSize] = HorizontalMax(maximum);
+        }
+    }
+}
@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------------------
+// File: OcclusionCuller.h
+//
+// Masked software occlusion culling. Each frame the meshes covering the most of the
+// screen are drawn as occluders into a low-resolution depth buffer on the CPU, then
+// the bounds of every mesh are tested against it, so meshes hidden behind walls and
+// floors are never submitted to the GPU.
+//
+// Occluders are the meshes' own opaque triangles with the same face culling as when
+// drawn, written at the farthest depth they reach within each pixel whose center they
+// cover. A pixel on an occluder's silhouette may be only partly covered, so each box is
+// tested against the pixels it touches and one more on every side; across a straight
+// edge, that always takes in a pixel beyond the occluder. Gaps narrower than one of the
+// buffer's pixels between separate occluders are treated as closed.
+//
+// Triangles are set up on the task pool's workers, binned into tiles, and each tile
+// rasterized four pixels at a time with DirectXMath. An 8x8 block hierarchy of maximum
+// depths lets most box tests finish without visiting pixels.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ModelData.h"
+
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace DX
+{
+    class TaskPool;
+
+    class OcclusionCuller
+    {
+    public:
+        static constexpr size_t TileSize = 32;
+        static constexpr size_t BlockSize = 8;
+        static constexpr size_t DefaultTriangleBudget = 65536;
+        static constexpr size_t DefaultWidth = 256;
+
+        // Matches SoftwareRasterizer::CullMode: the faces to discard.
+        enum class CullMode : uint32_t
+        {
+            None,
+            Clockwise,
+            CounterClockwise,
+        };
+
+        // The opaque triangles of one mesh, as an indexed triangle list in object space.
+        struct OccluderMesh
+        {
+            std::vector<DirectX::XMFLOAT3>  positions;
+            std::vector<uint32_t>           indices;
+            DirectX::BoundingBox            bounds;
+
+            size_t GetTriangleCount() const noexcept { return indices.size() / 3; }
+            size_t GetMemoryUsage() const noexcept;
+        };
+
+        // One placement of an occluder mesh for RenderOccluders.
+        struct Occluder
+        {
+            const OccluderMesh*     mesh;
+            DirectX::XMFLOAT4X4     world;
+            CullMode                cullMode;
+        };
+
+        struct Statistics
+        {
+            size_t      occluders;          // Drawn by the last RenderOccluders
+            size_t      triangles;          // Of those, set up after clipping and culling
+            size_t      tested;             // Boxes tested since the last RenderOccluders
+            size_t      occluded;
+        };
+
+        // Without a task pool all work runs on the calling thread.
+        OcclusionCuller(size_t width, size_t height, TaskPool* pool = nullptr);
+        ~OcclusionCuller();
+
+        OcclusionCuller(OcclusionCuller&&) = delete;
+        OcclusionCuller& operator= (OcclusionCuller&&) = delete;
+
+        OcclusionCuller(OcclusionCuller const&) = delete;
+        OcclusionCuller& operator= (OcclusionCuller const&) = delete;
+
+        // The depth buffer covers the whole viewport at this resolution.
+        void SetSize(size_t width, size_t height);
+
+        // DefaultWidth pixels across, or the viewport's width if smaller, with the
+        // viewport's aspect ratio.
+        void SetSizeForViewport(size_t width, size_t height);
+
+        // Most triangles drawn as occluders each frame; the largest occluders on screen
+        // are drawn first, and any that don't fit in what's left are skipped.
+        void SetTriangleBudget(size_t triangles) noexcept { m_triangleBudget = triangles; }
+
+        // One entry per mesh of the model, in order. Alpha parts, lines, and indices
+        // outside of their vertex buffer are left out.
+        static void BuildOccluders(const ModelData& model, std::vector<OccluderMesh>& meshes);
+
+        // Clears the depth buffer and draws the occluders with 'viewProjection' applied
+        // after each one's world matrix. Occluders smaller than a few pixels on screen
+        // are skipped.
+        void XM_CALLCONV RenderOccluders(_In_reads_(count) const Occluder* occluders, size_t count, DirectX::FXMMATRIX viewProjection);
+
+        // Returns true if every pixel the box touches on screen, and its neighbors, has an
+        // occluder nearer than the box's nearest point. Boxes crossing the near plane or
+        // entirely off screen are never occluded; leave those to frustum culling.
+        bool XM_CALLCONV IsOccluded(const DirectX::BoundingBox& box, DirectX::FXMMATRIX world) noexcept;
+
+        size_t GetWidth() const noexcept { return m_width; }
+        size_t GetHeight() const noexcept { return m_height; }
+
+        // Row-major, GetRowPitch() floats apart; 1 where nothing was drawn.
+        const float* GetDepthBuffer() const noexcept { return m_depth.data(); }
+        size_t GetRowPitch() const noexcept { return m_pitch; }
+
+        const Statistics& GetStatistics() const noexcept { return m_stats; }
+        size_t GetMemoryUsage() const noexcept;
+
+    private:
+        struct Triangle;
+        struct Worker;
+
+        void XM_CALLCONV SetupOccluder(const Occluder& occluder, DirectX::FXMMATRIX viewProjection, Worker& worker) const;
+        void SetupTriangle(const DirectX::XMVECTOR* clip, CullMode cullMode, Worker& worker) const;
+        void RasterizeTile(size_t tile) noexcept;
+
+        size_t                          m_width;
+        size_t                          m_height;
+        size_t                          m_pitch;        // Width rounded up to whole tiles
+        size_t                          m_rows;         // Height rounded up to whole tiles
+        size_t                          m_tilesX;
+        size_t                          m_tilesY;
+        size_t                          m_blocksX;
+        std::vector<float>              m_depth;
+        std::vector<float>              m_blockMaxDepth;
+        DirectX::XMFLOAT4X4             m_viewProjection;   // Of the last RenderOccluders
+
+        TaskPool*                       m_pool;
+        std::unique_ptr<Worker[]>       m_workers;
+        size_t                          m_workerCount;
+        size_t                          m_triangleBudget;
+
+        // Scratch for choosing occluders.
+        std::vector<std::pair<float, size_t>>   m_ranked;
+        std::vector<size_t>                     m_selected;
+
+        Statistics                      m_stats;
+    };
+}
@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------------------
+// File: OcclusionCullerBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+void DX::BenchmarkOcclusion(const ModelData& model, const HeadlessOptions& options, TaskPool& pool,
+    BenchmarkReport::Model& result, std::ostream& log)
+{
+    // The side view looks along the row of the generated models' meshes.
+    std::vector<OcclusionCuller::OccluderMesh> occluders;
+    const auto build = TimeStage(options.benchmark, [&]() { OcclusionCuller::BuildOccluders(model, occluders); });
+
+    OcclusionCuller occlusion(OcclusionCuller::DefaultWidth, OcclusionCuller::DefaultWidth, &pool);
+    occlusion.SetSizeForViewport(options.width, options.height);
+
+    XMMATRIX sideView, sideProj;
+    std::ignore = GetHeadlessViewMatrices(model, HeadlessView::Side, float(options.width) / float(options.height),
+        options.lhcoords, sideView, sideProj);
+    const XMMATRIX sideViewProj = XMMatrixMultiply(sideView, sideProj);
+
+    const size_t meshCount = model.meshes.size();
+    std::vector<SectionPlanes::Result> results(meshCount);
+    size_t occluded = 0;
+    const auto cull = TimeStage(options.benchmark, [&]()
+    {
+        std::fill(results.begin(), results.end(), SectionPlanes::Result::Inside);
+        occluded = CullOccludedMeshes(occlusion, model, occluders, sideViewProj, results.data());
+    });
+    const auto stats = occlusion.GetStatistics();
+
+    // Pixels that change when the hidden meshes are left out; only gaps between occluders
+    // narrower than the occlusion buffer's pixels can show through.
+    size_t changed = 0;
+    if (occluded)
+    {
+        SoftwareRasterizer rasterizer(options.width, options.height, &pool);
+        RenderHeadlessView(rasterizer, model, HeadlessView::Side, false, options.lhcoords);
+
+        const size_t pitch = rasterizer.GetRowPitch();
+        const std::vector<XMHALF4> expected(rasterizer.GetColorBuffer(), rasterizer.GetColorBuffer() + pitch * rasterizer.GetHeight());
+
+        RenderHeadlessView(rasterizer, model, HeadlessView::Side, false, options.lhcoords, nullptr, &occlusion, &occluders);
+        for (size_t y = 0; y < rasterizer.GetHeight(); ++y)
+        {
+            for (size_t x = 0; x < rasterizer.GetWidth(); ++x)
+            {
+                if (memcmp(&expected[y * pitch + x], &rasterizer.GetColorBuffer()[y * pitch + x], sizeof(XMHALF4)) != 0)
+                    ++changed;
+            }
+        }
+    }
+
+    result.stages.insert(result.stages.end(), { { "occlusion_build", build }, { "occlusion", cull } });
+
+    log << "  occlusion (side view, " << occlusion.GetWidth() << "x" << occlusion.GetHeight() << "): "
+        << occluded << " of " << meshCount << " meshes hidden behind " << stats.occluders << " occluders ("
+        << stats.triangles << " triangles)";
+    if (occluded)
+    {
+        if (changed)
+            log << ", " << changed << " pixels changed";
+        else
+            log << ", image unchanged";
+    }
+    log << std::endl;
+}
@@ -0,0 +1,195 @@
+//--------------------------------------------------------------------------------------
+// File: PhaseTimer.h
+//
+// Helper for measuring named (and nested) phases such as application startup,
+// recording both wall-clock and process CPU time for each
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ChromeTrace.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+
+namespace DX
+{
+    class PhaseTimer
+    {
+    public:
+        struct Phase
+        {
+            const char* name;           // Must be a string literal (or otherwise outlive the timer)
+            uint32_t    depth;
+            bool        open;
+            bool        instant;        // Recorded by Mark, so a point in time rather than a phase
+            uint64_t    wallStart;      // nanoseconds since the timer was created
+            uint64_t    wallDuration;   // nanoseconds
+            uint64_t    cpuDuration;    // nanoseconds of process CPU time
+            uint64_t    cpuStart;
+        };
+
+        PhaseTimer() noexcept(false) :
+            m_origin(std::chrono::steady_clock::now()),
+            m_depth(0)
+        {
+            m_phases.reserve(64);
+        }
+
+        PhaseTimer(PhaseTimer&&) = default;
+        PhaseTimer& operator= (PhaseTimer&&) = default;
+
+        PhaseTimer(PhaseTimer const&) = delete;
+        PhaseTimer& operator= (PhaseTimer const&) = delete;
+
+        // Starts a phase nested inside any currently open phase, returning its index for End.
+        size_t Begin(const char* name)
+        {
+            Phase phase = {};
+            phase.name = name;
+            phase.depth = m_depth++;
+            phase.open = true;
+            phase.wallStart = WallNow();
+            phase.cpuStart = CPUNow();
+            m_phases.push_back(phase);
+            return m_phases.size() - 1;
+        }
+
+        void End(size_t index) noexcept
+        {
+            if (index >= m_phases.size() || !m_phases[index].open)
+                return;
+
+            auto& phase = m_phases[index];
+            phase.wallDuration = WallNow() - phase.wallStart;
+            phase.cpuDuration = CPUNow() - phase.cpuStart;
+            phase.open = false;
+
+            if (m_depth > 0)
+                --m_depth;
+        }
+
+        // Records a zero-length event (e.g. 'first frame presented').
+        void Mark(const char* name)
+        {
+            Phase phase = {};
+            phase.name = name;
+            phase.depth = m_depth;
+            phase.instant = true;
+            phase.wallStart = WallNow();
+            phase.cpuStart = CPUNow();
+            m_phases.push_back(phase);
+        }
+
+        const std::vector<Phase>& GetPhases() const noexcept { return m_phases; }
+
+        double GetElapsedMilliseconds() const noexcept { return double(WallNow()) / 1000000.0; }
+
+        // Human-readable indented table of phases.
+        void WriteReport(std::ostream& stream) const
+        {
+            stream << "     Start(ms)       Wall(ms)        CPU(ms)  Phase\n";
+            for (auto const& phase : m_phases)
+            {
+                char buff[64] = {};
+                std::snprintf(buff, sizeof(buff), "%14.3f %14.3f %14.3f  ",
+                    double(phase.wallStart) / 1000000.0,
+                    double(phase.wallDuration) / 1000000.0,
+                    double(phase.cpuDuration) / 1000000.0);
+                stream << buff;
+                for (uint32_t j = 0; j < phase.depth; ++j)
+                    stream << "  ";
+                stream << (phase.name ? phase.name : "?");
+                if (phase.open)
+                    stream << " (not ended)";
+                stream << '\n';
+            }
+        }
+
+        void WriteChromeTrace(std::ostream& stream) const
+        {
+            ChromeTraceWriter trace(stream);
+            trace.ThreadName(1, "Startup");
+            for (auto const& phase : m_phases)
+            {
+                const double start = double(phase.wallStart) / 1000.0;
+                if (phase.instant)
+                {
+                    trace.Instant(phase.name, "startup", start, 1);
+                }
+                else
+                {
+                    trace.Complete(phase.name, "startup", start, double(phase.wallDuration) / 1000.0, 1,
+                        "cpu_ms", double(phase.cpuDuration) / 1000000.0);
+                }
+            }
+            trace.Close();
+        }
+
+        // Process CPU time (user + kernel) in nanoseconds.
+        static uint64_t CPUNow() noexcept
+        {
+        #ifdef _WIN32
+            FILETIME creationTime, exitTime, kernelTime, userTime;
+            if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+                return 0;
+
+            const uint64_t kernel = (uint64_t(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+            const uint64_t user = (uint64_t(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+            return (kernel + user) * 100;
+        #else
+            timespec ts = {};
+            if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+                return 0;
+
+            return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+        #endif
+        }
+
+    private:
+        std::chrono::steady_clock::time_point   m_origin;
+        std::vector<Phase>                      m_phases;
+        uint32_t                                m_depth;
+
+        uint64_t WallNow() const noexcept
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_origin).count());
+        }
+    };
+
+    // RAII helper; a null timer makes this a no-op.
+    class ScopedPhase
+    {
+    public:
+        ScopedPhase(PhaseTimer* timer, const char* name) :
+            m_timer(timer),
+            m_index(timer ? timer->Begin(name) : 0)
+        {
+        }
+
+        ~ScopedPhase()
+        {
+            if (m_timer)
+                m_timer->End(m_index);
+        }
+
+        ScopedPhase(ScopedPhase const&) = delete;
+        ScopedPhase& operator= (ScopedPhase const&) = delete;
+
+    private:
+        PhaseTimer* m_timer;
+        size_t      m_index;
+    };
+}
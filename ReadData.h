@@ -1,7 +1,7 @@
 //--------------------------------------------------------------------------------------
 // File: ReadData.h
 //
-// Helper for loading binary data files from disk
+// Helpers for loading and saving binary data files
 //
 // For Windows desktop apps, it looks for files in the same folder as the running EXE if
 // it can't find them in the CWD
@@ -17,17 +17,55 @@
 #include <exception>
 #include <fstream>
 #include <stdexcept>
+#include <string>
 #include <system_error>
 #include <vector>
 
 
 namespace DX
 {
+#ifdef _WIN32
+    inline const wchar_t* FileName(_In_z_ const wchar_t* name) noexcept { return name; }
+#else
+    // The C++ library only accepts narrow file names here, which are UTF-8.
+    inline std::string FileName(_In_z_ const wchar_t* name)
+    {
+        std::string result;
+        for (; *name; ++name)
+        {
+            const auto c = static_cast<uint32_t>(*name);
+            if (c < 0x80)
+            {
+                result.push_back(static_cast<char>(c));
+            }
+            else if (c < 0x800)
+            {
+                result.push_back(static_cast<char>(0xC0 | (c >> 6)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else if (c < 0x10000)
+            {
+                result.push_back(static_cast<char>(0xE0 | (c >> 12)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else
+            {
+                result.push_back(static_cast<char>(0xF0 | (c >> 18)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+        }
+        return result;
+    }
+#endif
+
     inline std::vector<uint8_t> ReadData(_In_z_ const wchar_t* name)
     {
-        std::ifstream inFile(name, std::ios::in | std::ios::binary | std::ios::ate);
+        std::ifstream inFile(FileName(name), std::ios::in | std::ios::binary | std::ios::ate);
 
-#if !defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP)
+#if defined(_WIN32) && (!defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP))
         if (!inFile)
         {
             wchar_t moduleName[_MAX_PATH] = {};
@@ -70,4 +108,17 @@ namespace DX
 
         return blob;
     }
+
+    inline void WriteData(_In_z_ const wchar_t* name, _In_reads_bytes_(size) const void* data, size_t size)
+    {
+        std::ofstream outFile(FileName(name), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outFile)
+            throw std::runtime_error("WriteData");
+
+        outFile.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!outFile)
+            throw std::runtime_error("WriteData");
+
+        outFile.close();
+    }
 }
@@ -21,10 +21,8 @@ using namespace DX;
 
 using Microsoft::WRL::ComPtr;
 
-RenderTexture::RenderTexture(DXGI_FORMAT format) noexcept :
-    m_format(format),
-    m_width(0),
-    m_height(0)
+RenderTexture::RenderTexture(DXGI_FORMAT format, uint32_t sampleCount, DXGI_FORMAT depthFormat) noexcept :
+    m_desc(format, sampleCount, depthFormat)
 {
 }
 
@@ -38,35 +36,50 @@ void RenderTexture::SetDevice(_In_ ID3D11Device* device)
         ReleaseDevice();
     }
 
+    CheckFormatSupport(device);
+
+    m_device = device;
+}
+
+void RenderTexture::CheckFormatSupport(_In_ ID3D11Device* device) const
+{
+    if (!IsValidSampleCount(m_desc.sampleCount))
     {
-        UINT formatSupport = 0;
-        if (FAILED(device->CheckFormatSupport(m_format, &formatSupport)))
-        {
-            throw std::runtime_error("CheckFormatSupport");
-        }
+        throw std::invalid_argument("Invalid sample count");
+    }
 
-        constexpr UINT32 required = D3D11_FORMAT_SUPPORT_TEXTURE2D | D3D11_FORMAT_SUPPORT_RENDER_TARGET;
-        if ((formatSupport & required) != required)
-        {
+    UINT formatSupport = 0;
+    if (FAILED(device->CheckFormatSupport(m_desc.format, &formatSupport)))
+    {
+        throw std::runtime_error("CheckFormatSupport");
+    }
+
+    UINT32 required = D3D11_FORMAT_SUPPORT_TEXTURE2D | D3D11_FORMAT_SUPPORT_RENDER_TARGET;
+    if (m_desc.IsMultisampled())
+    {
+        required |= D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET | D3D11_FORMAT_SUPPORT_MULTISAMPLE_RESOLVE;
+    }
+
+    UINT levels = 0;
+    if ((formatSupport & required) != required
+        || (m_desc.IsMultisampled() && (FAILED(device->CheckMultisampleQualityLevels(m_desc.format, m_desc.sampleCount, &levels)) || !levels)))
+    {
 #ifdef _DEBUG
-            char buff[128] = {};
-            sprintf_s(buff, "RenderTexture: Device does not support the requested format (%u)!\n", m_format);
-            OutputDebugStringA(buff);
+        char buff[128] = {};
+        sprintf_s(buff, "RenderTexture: Device does not support the requested format (%u) with %u samples!\n", m_desc.format, m_desc.sampleCount);
+        OutputDebugStringA(buff);
 #endif
-            throw std::runtime_error("RenderTexture");
-        }
+        throw std::runtime_error("RenderTexture");
     }
-
-    m_device = device;
 }
 
 
 void RenderTexture::SizeResources(size_t width, size_t height)
 {
-    if (width == m_width && height == m_height)
+    if (width == m_desc.width && height == m_desc.height)
         return;
 
-    if (m_width > UINT32_MAX || m_height > UINT32_MAX)
+    if (width > UINT32_MAX || height > UINT32_MAX)
     {
         throw std::out_of_range("Invalid width/height");
     }
@@ -74,11 +87,15 @@ void RenderTexture::SizeResources(size_t width, size_t height)
     if (!m_device)
         return;
 
-    m_width = m_height = 0;
+    m_desc.width = m_desc.height = 0;
+
+    m_msaaTarget.Reset();
+    m_depthStencil.Reset();
+    m_depthStencilView.Reset();
 
     // Create a render target
     CD3D11_TEXTURE2D_DESC renderTargetDesc(
-        m_format,
+        m_desc.format,
         static_cast<UINT>(width),
         static_cast<UINT>(height),
         1, // The render target view has only one texture.
@@ -97,19 +114,84 @@ void RenderTexture::SizeResources(size_t width, size_t height)
 
     SetDebugObjectName(m_renderTarget.Get(), "RenderTexture RT");
 
-    // Create RTV.
-    CD3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc(D3D11_RTV_DIMENSION_TEXTURE2D, m_format);
-
-    ThrowIfFailed(m_device->CreateRenderTargetView(
-        m_renderTarget.Get(),
-        &renderTargetViewDesc,
-        m_renderTargetView.ReleaseAndGetAddressOf()
-    ));
+    if (m_desc.IsMultisampled())
+    {
+        // Create the multisampled target, drawn into in place of the one above.
+        CD3D11_TEXTURE2D_DESC msaaTargetDesc(
+            m_desc.format,
+            static_cast<UINT>(width),
+            static_cast<UINT>(height),
+            1,
+            1,
+            D3D11_BIND_RENDER_TARGET,
+            D3D11_USAGE_DEFAULT,
+            0,
+            m_desc.sampleCount
+        );
+
+        ThrowIfFailed(m_device->CreateTexture2D(
+            &msaaTargetDesc,
+            nullptr,
+            m_msaaTarget.ReleaseAndGetAddressOf()
+        ));
+
+        SetDebugObjectName(m_msaaTarget.Get(), "RenderTexture MSAA RT");
+
+        CD3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc(D3D11_RTV_DIMENSION_TEXTURE2DMS, m_desc.format);
+
+        ThrowIfFailed(m_device->CreateRenderTargetView(
+            m_msaaTarget.Get(),
+            &renderTargetViewDesc,
+            m_renderTargetView.ReleaseAndGetAddressOf()
+        ));
+
+        // Create a depth buffer with the same sample count.
+        CD3D11_TEXTURE2D_DESC depthStencilDesc(
+            m_desc.depthFormat,
+            static_cast<UINT>(width),
+            static_cast<UINT>(height),
+            1,
+            1,
+            D3D11_BIND_DEPTH_STENCIL,
+            D3D11_USAGE_DEFAULT,
+            0,
+            m_desc.sampleCount
+        );
+
+        ThrowIfFailed(m_device->CreateTexture2D(
+            &depthStencilDesc,
+            nullptr,
+            m_depthStencil.ReleaseAndGetAddressOf()
+        ));
+
+        SetDebugObjectName(m_depthStencil.Get(), "RenderTexture MSAA DS");
+
+        CD3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc(D3D11_DSV_DIMENSION_TEXTURE2DMS, m_desc.depthFormat);
+
+        ThrowIfFailed(m_device->CreateDepthStencilView(
+            m_depthStencil.Get(),
+            &depthStencilViewDesc,
+            m_depthStencilView.ReleaseAndGetAddressOf()
+        ));
+
+        SetDebugObjectName(m_depthStencilView.Get(), "RenderTexture MSAA DSV");
+    }
+    else
+    {
+        // Create RTV.
+        CD3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc(D3D11_RTV_DIMENSION_TEXTURE2D, m_desc.format);
+
+        ThrowIfFailed(m_device->CreateRenderTargetView(
+            m_renderTarget.Get(),
+            &renderTargetViewDesc,
+            m_renderTargetView.ReleaseAndGetAddressOf()
+        ));
+    }
 
     SetDebugObjectName(m_renderTargetView.Get(), "RenderTexture RTV");
 
     // Create SRV.
-    CD3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc(D3D11_SRV_DIMENSION_TEXTURE2D, m_format);
+    CD3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc(D3D11_SRV_DIMENSION_TEXTURE2D, m_desc.format);
 
     ThrowIfFailed(m_device->CreateShaderResourceView(
         m_renderTarget.Get(),
@@ -119,8 +201,8 @@ void RenderTexture::SizeResources(size_t width, size_t height)
 
     SetDebugObjectName(m_shaderResourceView.Get(), "RenderTexture SRV");
 
-    m_width = width;
-    m_height = height;
+    m_desc.width = static_cast<uint32_t>(width);
+    m_desc.height = static_cast<uint32_t>(height);
 }
 
 
@@ -129,10 +211,13 @@ void RenderTexture::ReleaseDevice() noexcept
     m_renderTargetView.Reset();
     m_shaderResourceView.Reset();
     m_renderTarget.Reset();
+    m_msaaTarget.Reset();
+    m_depthStencilView.Reset();
+    m_depthStencil.Reset();
 
     m_device.Reset();
 
-    m_width = m_height = 0;
+    m_desc.width = m_desc.height = 0;
 }
 
 void RenderTexture::SetWindow(const RECT& output)
@@ -143,3 +228,74 @@ void RenderTexture::SetWindow(const RECT& output)
 
     SizeResources(width, height);
 }
+
+void RenderTexture::SetFormat(DXGI_FORMAT format, uint32_t sampleCount)
+{
+    RenderTextureDesc desc = m_desc;
+    desc.format = format;
+    desc.sampleCount = sampleCount;
+
+    if (!desc.NeedsRecreate(m_desc))
+        return;
+
+    const RenderTextureDesc previous = m_desc;
+    m_desc.format = format;
+    m_desc.sampleCount = sampleCount;
+
+    if (!m_device)
+        return;
+
+    try
+    {
+        CheckFormatSupport(m_device.Get());
+    }
+    catch (...)
+    {
+        m_desc = previous;
+        throw;
+    }
+
+    // Force SizeResources to recreate the textures at the same size.
+    const size_t width = m_desc.width;
+    const size_t height = m_desc.height;
+    m_desc.width = m_desc.height = 0;
+
+    if (width && height)
+    {
+        SizeResources(width, height);
+    }
+}
+
+void RenderTexture::Resolve(_In_ ID3D11DeviceContext* context)
+{
+    if (!m_msaaTarget)
+        return;
+
+    context->ResolveSubresource(m_renderTarget.Get(), 0, m_msaaTarget.Get(), 0, m_desc.format);
+}
+
+uint32_t RenderTexture::GetSupportedSampleCounts(_In_ ID3D11Device* device, DXGI_FORMAT format, DXGI_FORMAT depthFormat)
+{
+    uint32_t supported = 1;
+
+    UINT formatSupport = 0;
+    if (FAILED(device->CheckFormatSupport(format, &formatSupport)))
+        return supported;
+
+    constexpr UINT32 required = D3D11_FORMAT_SUPPORT_MULTISAMPLE_RENDERTARGET | D3D11_FORMAT_SUPPORT_MULTISAMPLE_RESOLVE;
+    if ((formatSupport & required) != required)
+        return supported;
+
+    for (uint32_t count = 2; count <= RenderTextureDesc::MaxSampleCount; count <<= 1)
+    {
+        UINT levels = 0;
+        UINT depthLevels = 0;
+        if (SUCCEEDED(device->CheckMultisampleQualityLevels(format, count, &levels)) && levels
+            && SUCCEEDED(device->CheckMultisampleQualityLevels(depthFormat, count, &depthLevels)) && depthLevels)
+        {
+            supported |= count;
+        }
+    }
+
+    return supported;
+}
@@ -3,12 +3,18 @@
 //
 // Helper for managing offscreen render targets
 //
+// A multisampled target is drawn with its own depth buffer of the same sample count in
+// place of the swap chain's, and Resolve copies it into a single-sample texture, which is
+// what GetRenderTarget and GetShaderResourceView return.
+//
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 //-------------------------------------------------------------------------------------
 
 #pragma once
 
+#include "RenderTextureDesc.h"
+
 #include <cstddef>
 
 #include <wrl/client.h>
@@ -20,7 +26,7 @@ namespace DX
     class RenderTexture
     {
     public:
-        explicit RenderTexture(DXGI_FORMAT format) noexcept;
+        explicit RenderTexture(DXGI_FORMAT format, uint32_t sampleCount = 1, DXGI_FORMAT depthFormat = DXGI_FORMAT_D32_FLOAT) noexcept;
 
         RenderTexture(RenderTexture&&) = default;
         RenderTexture& operator= (RenderTexture&&) = default;
@@ -36,21 +42,41 @@ namespace DX
 
         void SetWindow(const RECT& rect);
 
+        // Recreates the textures at the current size if the format or sample count changed.
+        void SetFormat(DXGI_FORMAT format, uint32_t sampleCount);
+
+        // Copies the multisampled target into the single-sample one; does nothing if the
+        // target isn't multisampled.
+        void Resolve(_In_ ID3D11DeviceContext* context);
+
         ID3D11Texture2D* GetRenderTarget() const noexcept { return m_renderTarget.Get(); }
         ID3D11RenderTargetView* GetRenderTargetView() const noexcept { return m_renderTargetView.Get(); }
         ID3D11ShaderResourceView* GetShaderResourceView() const noexcept { return m_shaderResourceView.Get(); }
 
-        DXGI_FORMAT GetFormat() const noexcept { return m_format; }
+        // Null unless multisampled.
+        ID3D11Texture2D* GetMultisampledTarget() const noexcept { return m_msaaTarget.Get(); }
+        ID3D11Texture2D* GetDepthStencil() const noexcept { return m_depthStencil.Get(); }
+        ID3D11DepthStencilView* GetDepthStencilView() const noexcept { return m_depthStencilView.Get(); }
+
+        DXGI_FORMAT GetFormat() const noexcept { return m_desc.format; }
+        uint32_t GetSampleCount() const noexcept { return m_desc.sampleCount; }
+        const RenderTextureDesc& GetDesc() const noexcept { return m_desc; }
+
+        // Mask of the sample counts the device can draw and resolve with these formats,
+        // as taken by ChooseSampleCount.
+        static uint32_t GetSupportedSampleCounts(_In_ ID3D11Device* device, DXGI_FORMAT format, DXGI_FORMAT depthFormat);
 
     private:
+        void CheckFormatSupport(_In_ ID3D11Device* device) const;
+
         Microsoft::WRL::ComPtr<ID3D11Device>                m_device;
         Microsoft::WRL::ComPtr<ID3D11Texture2D>             m_renderTarget;
         Microsoft::WRL::ComPtr<ID3D11RenderTargetView>      m_renderTargetView;
         Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>    m_shaderResourceView;
+        Microsoft::WRL::ComPtr<ID3D11Texture2D>             m_msaaTarget;
+        Microsoft::WRL::ComPtr<ID3D11Texture2D>             m_depthStencil;
+        Microsoft::WRL::ComPtr<ID3D11DepthStencilView>      m_depthStencilView;
 
-        DXGI_FORMAT                                         m_format;
-
-        size_t                                              m_width;
-        size_t                                              m_height;
+        RenderTextureDesc                                   m_desc;
     };
 }
@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------------------
+// File: RenderTextureDesc.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "RenderTextureDesc.h"
+#include "MemoryAccounting.h"
+
+#include <type_traits>
+
+using namespace DX;
+
+namespace
+{
+    const DXGI_FORMAT c_HdrFormats[] =
+    {
+        DXGI_FORMAT_R16G16B16A16_FLOAT,
+        DXGI_FORMAT_R11G11B10_FLOAT,
+    };
+
+    const wchar_t* c_HdrFormatNames[] =
+    {
+        L"R16G16B16A16_FLOAT",
+        L"R11G11B10_FLOAT",
+    };
+
+    static_assert(std::extent<decltype(c_HdrFormats)>::value == static_cast<size_t>(HdrFormat::Count), "HDR format table mismatch");
+    static_assert(std::extent<decltype(c_HdrFormatNames)>::value == static_cast<size_t>(HdrFormat::Count), "HDR format name table mismatch");
+}
+
+DXGI_FORMAT DX::GetHdrFormat(HdrFormat format) noexcept
+{
+    const auto index = static_cast<size_t>(format);
+    return (index < static_cast<size_t>(HdrFormat::Count)) ? c_HdrFormats[index] : DXGI_FORMAT_UNKNOWN;
+}
+
+const wchar_t* DX::GetHdrFormatName(HdrFormat format) noexcept
+{
+    const auto index = static_cast<size_t>(format);
+    return (index < static_cast<size_t>(HdrFormat::Count)) ? c_HdrFormatNames[index] : L"unknown";
+}
+
+//--------------------------------------------------------------------------------------
+bool RenderTextureDesc::NeedsRecreate(const RenderTextureDesc& other) const noexcept
+{
+    // The depth format only matters when there is a depth buffer.
+    return format != other.format
+        || width != other.width
+        || height != other.height
+        || sampleCount != other.sampleCount
+        || (IsMultisampled() && depthFormat != other.depthFormat);
+}
+
+uint64_t RenderTextureDesc::GetTargetBytes() const noexcept
+{
+    return IsSized() ? ComputeTextureBytes(format, width, height, 1, 1, 1, sampleCount) : 0;
+}
+
+uint64_t RenderTextureDesc::GetDepthBytes() const noexcept
+{
+    return (IsSized() && IsMultisampled()) ? ComputeTextureBytes(depthFormat, width, height, 1, 1, 1, sampleCount) : 0;
+}
+
+uint64_t RenderTextureDesc::GetResolveBytes() const noexcept
+{
+    return (IsSized() && IsMultisampled()) ? ComputeTextureBytes(format, width, height, 1, 1, 1) : 0;
+}
+
+//--------------------------------------------------------------------------------------
+bool DX::IsValidSampleCount(uint32_t count) noexcept
+{
+    return count > 0 && count <= RenderTextureDesc::MaxSampleCount && !(count & (count - 1));
+}
+
+uint32_t DX::ChooseSampleCount(uint32_t requested, uint32_t supported) noexcept
+{
+    for (uint32_t count = RenderTextureDesc::MaxSampleCount; count > 1; count >>= 1)
+    {
+        if (count <= requested && (supported & count))
+            return count;
+    }
+
+    return 1;
+}
+
+uint32_t DX::GetNextSampleCount(uint32_t current, uint32_t supported) noexcept
+{
+    for (uint32_t count = 2; count <= RenderTextureDesc::MaxSampleCount; count <<= 1)
+    {
+        if (count > current && (supported & count))
+            return count;
+    }
+
+    return 1;
+}
@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------------------
+// File: RenderTextureDesc.h
+//
+// Format, size, and sample count of a RenderTexture, and the textures and bytes they
+// call for, kept apart from Direct3D so the bookkeeping also builds for non-Windows
+// targets. A multisampled target is drawn with its own depth buffer of the same sample
+// count, then resolved into a single-sample texture for shaders to read.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#ifdef _WIN32
+#include <dxgiformat.h>
+#else
+#include <directx/dxgiformat.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace DX
+{
+    // Formats for the HDR scene. R11G11B10 takes half the bytes of R16G16B16A16, with no
+    // alpha and 6 or 5 bits of mantissa in place of 10.
+    enum class HdrFormat : uint32_t
+    {
+        R16G16B16A16Float,
+        R11G11B10Float,
+        Count
+    };
+
+    DXGI_FORMAT GetHdrFormat(HdrFormat format) noexcept;
+    const wchar_t* GetHdrFormatName(HdrFormat format) noexcept;
+
+    struct RenderTextureDesc
+    {
+        static constexpr uint32_t MaxSampleCount = 8;
+
+        DXGI_FORMAT         format;
+        DXGI_FORMAT         depthFormat;        // Of the depth buffer of a multisampled target
+        uint32_t            width;              // Zero until sized
+        uint32_t            height;
+        uint32_t            sampleCount;        // 1, 2, 4, or 8
+
+        RenderTextureDesc() noexcept :
+            format(DXGI_FORMAT_UNKNOWN),
+            depthFormat(DXGI_FORMAT_UNKNOWN),
+            width(0),
+            height(0),
+            sampleCount(1)
+        {
+        }
+
+        RenderTextureDesc(DXGI_FORMAT targetFormat, uint32_t samples, DXGI_FORMAT depth) noexcept :
+            format(targetFormat),
+            depthFormat(depth),
+            width(0),
+            height(0),
+            sampleCount(samples)
+        {
+        }
+
+        bool IsMultisampled() const noexcept { return sampleCount > 1; }
+        bool IsSized() const noexcept { return width > 0 && height > 0; }
+
+        // True if the textures of 'other' can't be reused for these.
+        bool NeedsRecreate(const RenderTextureDesc& other) const noexcept;
+
+        // The texture drawn into; when multisampled, that and its own depth buffer, and
+        // the single-sample texture it resolves into.
+        uint64_t GetTargetBytes() const noexcept;
+        uint64_t GetDepthBytes() const noexcept;
+        uint64_t GetResolveBytes() const noexcept;
+        uint64_t GetMemoryUsage() const noexcept { return GetTargetBytes() + GetDepthBytes() + GetResolveBytes(); }
+    };
+
+    // Sets of sample counts are masks of the counts themselves, which are powers of two:
+    // 1 | 4 is single sampling and 4x. Single sampling is always taken to be supported.
+    bool IsValidSampleCount(uint32_t count) noexcept;
+
+    // The largest count in 'supported' no greater than 'requested', or 1.
+    uint32_t ChooseSampleCount(uint32_t requested, uint32_t supported) noexcept;
+
+    // The next larger count in 'supported' after 'current', wrapping around to 1.
+    uint32_t GetNextSampleCount(uint32_t current, uint32_t supported) noexcept;
+}
@@ -0,0 +1,266 @@
+//--------------------------------------------------------------------------------------
+// File: ResidencyManager.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "ResidencyManager.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DX;
+
+ResidencyManager::ResidencyManager(const Settings& settings) noexcept :
+    m_settings(settings),
+    m_stats{}
+{
+}
+
+uint32_t ResidencyManager::AddResource(uint64_t bytes)
+{
+    Resource resource = {};
+    resource.bytes = bytes;
+    resource.lruPosition = m_lru.end();
+    m_resources.emplace_back(std::move(resource));
+    return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+uint32_t ResidencyManager::AddItem(const BoundingSphere& bounds, const std::vector<uint32_t>& resources)
+{
+    const auto index = static_cast<uint32_t>(m_items.size());
+
+    Item item = {};
+    item.bounds = bounds;
+    item.resources = resources;
+    std::sort(item.resources.begin(), item.resources.end());
+    item.resources.erase(std::unique(item.resources.begin(), item.resources.end()), item.resources.end());
+
+    for (auto resource : item.resources)
+    {
+        if (resource >= m_resources.size())
+            throw std::out_of_range("ResidencyManager::AddItem");
+    }
+
+    for (auto resource : item.resources)
+    {
+        m_resources[resource].items.push_back(index);
+    }
+
+    m_items.emplace_back(std::move(item));
+    return index;
+}
+
+void ResidencyManager::Clear() noexcept
+{
+    m_resources.clear();
+    m_items.clear();
+    m_lru.clear();
+    m_candidates.clear();
+    m_changes.evict.clear();
+    m_changes.load.clear();
+    m_stats = {};
+}
+
+bool ResidencyManager::IsComplete(const Item& item) const noexcept
+{
+    for (auto resource : item.resources)
+    {
+        if (!m_resources[resource].resident)
+            return false;
+    }
+    return true;
+}
+
+void ResidencyManager::Release(uint32_t resource)
+{
+    auto& res = m_resources[resource];
+    if (!res.resident)
+        return;
+
+    m_lru.erase(res.lruPosition);
+    res.lruPosition = m_lru.end();
+    res.resident = false;
+
+    m_stats.residentBytes -= res.bytes;
+    --m_stats.residentResources;
+
+    for (auto item : res.items)
+    {
+        m_items[item].drawable = false;
+    }
+}
+
+const ResidencyManager::Changes& XM_CALLCONV ResidencyManager::Update(FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
+    float viewportHeight, bool rhcoords)
+{
+    m_changes.evict.clear();
+    m_changes.load.clear();
+
+    const uint64_t frame = ++m_stats.frames;
+    m_stats.visibleItems = 0;
+    m_stats.drawableItems = 0;
+    m_stats.loads = 0;
+    m_stats.evictions = 0;
+    m_stats.loadedBytes = 0;
+
+    BoundingFrustum frustum;
+    BoundingFrustum::CreateFromMatrix(frustum, projection, rhcoords);
+    frustum.Transform(frustum, XMMatrixInverse(nullptr, view));
+
+    // A sphere of radius r at depth d covers about r * cot(fov / 2) / d of half the viewport.
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&proj, projection);
+    const float pixelScale = std::abs(proj.m[1][1]) * viewportHeight * 0.5f;
+
+    // Rank the visible items, and mark their resources as recently used.
+    m_candidates.clear();
+    for (size_t j = 0; j < m_items.size(); ++j)
+    {
+        auto& item = m_items[j];
+
+        BoundingSphere sphere;
+        item.bounds.Transform(sphere, world);
+
+        item.visible = frustum.Intersects(sphere);
+        item.drawable = false;
+        item.screenRadius = 0.f;
+        if (!item.visible)
+            continue;
+
+        ++m_stats.visibleItems;
+
+        const XMVECTOR center = XMVector3Transform(XMLoadFloat3(&sphere.Center), view);
+        const float depth = rhcoords ? -XMVectorGetZ(center) : XMVectorGetZ(center);
+        item.screenRadius = (depth > sphere.Radius) ? sphere.Radius * pixelScale / depth : FLT_MAX;
+
+        for (auto resource : item.resources)
+        {
+            auto& res = m_resources[resource];
+            res.lastVisible = frame;
+            if (res.resident)
+            {
+                m_lru.splice(m_lru.end(), m_lru, res.lruPosition);
+            }
+        }
+
+        if (!IsComplete(item) && item.screenRadius >= m_settings.minScreenRadius)
+        {
+            m_candidates.push_back(static_cast<uint32_t>(j));
+        }
+    }
+
+    std::stable_sort(m_candidates.begin(), m_candidates.end(), [this](uint32_t a, uint32_t b)
+        {
+            return m_items[a].screenRadius > m_items[b].screenRadius;
+        });
+
+    // Load the largest on screen first, until the upload or residency budget runs out.
+    const uint64_t uploadLimit = m_settings.uploadBytesPerFrame ? m_settings.uploadBytesPerFrame : UINT64_MAX;
+    for (auto index : m_candidates)
+    {
+        auto const& item = m_items[index];
+
+        bool failed = false;
+        uint64_t missing = 0;
+        for (auto resource : item.resources)
+        {
+            auto const& res = m_resources[resource];
+            failed = failed || res.failed;
+            if (!res.resident)
+                missing += res.bytes;
+        }
+
+        // Never fits, or can never be drawn.
+        if (failed || missing > m_settings.budgetBytes)
+            continue;
+
+        // Something large is always allowed to start a frame's uploads, so it can't starve.
+        if (m_stats.loadedBytes && m_stats.loadedBytes + missing > uploadLimit)
+            break;
+
+        while (m_stats.residentBytes + missing > m_settings.budgetBytes && !m_lru.empty())
+        {
+            const uint32_t victim = m_lru.front();
+            if (m_resources[victim].lastVisible == frame)
+                break;
+
+            Release(victim);
+            m_changes.evict.push_back(victim);
+            ++m_stats.evictions;
+            ++m_stats.totalEvictions;
+        }
+
+        // Everything left is in view; what's resident now is the best that fits.
+        if (m_stats.residentBytes + missing > m_settings.budgetBytes)
+            break;
+
+        for (auto resource : item.resources)
+        {
+            auto& res = m_resources[resource];
+            if (res.resident)
+                continue;
+
+            res.resident = true;
+            res.lruPosition = m_lru.insert(m_lru.end(), resource);
+
+            m_changes.load.push_back(resource);
+            m_stats.residentBytes += res.bytes;
+            ++m_stats.residentResources;
+            ++m_stats.loads;
+            ++m_stats.totalLoads;
+            m_stats.loadedBytes += res.bytes;
+            m_stats.totalLoadedBytes += res.bytes;
+        }
+    }
+
+    m_stats.peakResidentBytes = std::max(m_stats.peakResidentBytes, m_stats.residentBytes);
+
+    for (auto& item : m_items)
+    {
+        if (item.visible && IsComplete(item))
+        {
+            item.drawable = true;
+            ++m_stats.drawableItems;
+        }
+    }
+
+    m_stats.totalVisible += m_stats.visibleItems;
+    m_stats.totalMisses += m_stats.visibleItems - m_stats.drawableItems;
+
+    return m_changes;
+}
+
+void ResidencyManager::SetLoadFailed(uint32_t resource)
+{
+    if (resource >= m_resources.size())
+        throw std::out_of_range("ResidencyManager::SetLoadFailed");
+
+    auto& res = m_resources[resource];
+    if (res.failed)
+        return;
+
+    if (res.resident)
+    {
+        m_stats.drawableItems -= static_cast<size_t>(std::count_if(res.items.cbegin(), res.items.cend(),
+            [this](uint32_t item) { return m_items[item].drawable; }));
+        Release(resource);
+    }
+
+    res.failed = true;
+    ++m_stats.failedResources;
+}
@@ -0,0 +1,147 @@
+//--------------------------------------------------------------------------------------
+// File: ResidencyManager.h
+//
+// Decides which parts of a model too large for memory are resident. Resources are the
+// units that are loaded and released, such as vertex and index buffers; items are the
+// units that are drawn, such as meshes, each needing a set of resources. Every frame the
+// visible items are ranked by their projected size on screen, and the largest that are
+// missing resources get them loaded, under a fixed budget of resident bytes. To make room,
+// the least recently visible resources are evicted first; a resource used by any visible
+// item is never evicted. It has no Direct3D dependency, so the policy can be tested with
+// a simulated camera path (see ResidencySimulator.h).
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <vector>
+
+
+namespace DX
+{
+    class ResidencyManager
+    {
+    public:
+        static constexpr uint64_t c_DefaultUploadBytesPerFrame = 32u * 1024u * 1024u;
+
+        struct Settings
+        {
+            uint64_t    budgetBytes;            // Most bytes resident at once
+            uint64_t    uploadBytesPerFrame;    // Most bytes loaded by one Update; 0 for no limit
+            float       minScreenRadius;        // Items smaller than this on screen, in pixels, aren't loaded
+
+            Settings() noexcept :
+                budgetBytes(512u * 1024u * 1024u),
+                uploadBytesPerFrame(c_DefaultUploadBytesPerFrame),
+                minScreenRadius(1.f)
+            {
+            }
+        };
+
+        // Resources to release, which the caller applies before the loads, and resources
+        // to create. The caller reports any load it couldn't complete with SetLoadFailed.
+        struct Changes
+        {
+            std::vector<uint32_t>   evict;
+            std::vector<uint32_t>   load;
+        };
+
+        struct Statistics
+        {
+            uint64_t    frames;
+            size_t      visibleItems;           // Last frame
+            size_t      drawableItems;          // Last frame: visible with every resource resident
+            size_t      residentResources;
+            uint64_t    residentBytes;
+            uint64_t    peakResidentBytes;
+            size_t      loads;                  // Last frame
+            size_t      evictions;              // Last frame
+            uint64_t    loadedBytes;            // Last frame
+            uint64_t    totalLoads;
+            uint64_t    totalEvictions;
+            uint64_t    totalLoadedBytes;
+            uint64_t    totalVisible;           // Visible items summed over frames
+            uint64_t    totalMisses;            // Visible items that couldn't be drawn, summed over frames
+            size_t      failedResources;
+        };
+
+        explicit ResidencyManager(const Settings& settings = Settings()) noexcept;
+
+        ResidencyManager(ResidencyManager&&) = default;
+        ResidencyManager& operator= (ResidencyManager&&) = default;
+
+        ResidencyManager(ResidencyManager const&) = delete;
+        ResidencyManager& operator= (ResidencyManager const&) = delete;
+
+        uint32_t AddResource(uint64_t bytes);
+
+        // 'bounds' are in model space; duplicate resource indices are ignored. Throws
+        // std::out_of_range for an unknown resource.
+        uint32_t AddItem(const DirectX::BoundingSphere& bounds, const std::vector<uint32_t>& resources);
+
+        void Clear() noexcept;
+
+        // Ranks the items for this camera and returns the evictions and loads to apply.
+        const Changes& XM_CALLCONV Update(DirectX::FXMMATRIX world, DirectX::CXMMATRIX view, DirectX::CXMMATRIX projection,
+            float viewportHeight, bool rhcoords);
+
+        // The resource is treated as released and is not requested again.
+        void SetLoadFailed(uint32_t resource);
+
+        bool IsResident(uint32_t resource) const noexcept { return resource < m_resources.size() && m_resources[resource].resident; }
+
+        // Visible in the last Update with every resource resident.
+        bool IsDrawable(uint32_t item) const noexcept { return item < m_items.size() && m_items[item].drawable; }
+
+        // Visible items in the last Update that are still missing resources.
+        bool IsLoading() const noexcept { return m_stats.drawableItems < m_stats.visibleItems; }
+
+        size_t GetResourceCount() const noexcept { return m_resources.size(); }
+        size_t GetItemCount() const noexcept { return m_items.size(); }
+        uint64_t GetResourceBytes(uint32_t resource) const noexcept { return (resource < m_resources.size()) ? m_resources[resource].bytes : 0; }
+
+        const Settings& GetSettings() const noexcept { return m_settings; }
+        void SetSettings(const Settings& settings) noexcept { m_settings = settings; }
+
+        const Statistics& GetStatistics() const noexcept { return m_stats; }
+
+    private:
+        struct Resource
+        {
+            uint64_t                        bytes;
+            uint64_t                        lastVisible;    // Frame number
+            std::list<uint32_t>::iterator   lruPosition;    // Valid while resident
+            std::vector<uint32_t>           items;
+            bool                            resident;
+            bool                            failed;
+        };
+
+        struct Item
+        {
+            DirectX::BoundingSphere         bounds;
+            std::vector<uint32_t>           resources;
+            float                           screenRadius;   // Pixels; last Update
+            bool                            visible;
+            bool                            drawable;
+        };
+
+        bool IsComplete(const Item& item) const noexcept;
+        void Release(uint32_t resource);
+
+        Settings                    m_settings;
+        std::vector<Resource>       m_resources;
+        std::vector<Item>           m_items;
+        std::list<uint32_t>         m_lru;          // Resident resources, least recently visible first
+        std::vector<uint32_t>       m_candidates;
+        Changes                     m_changes;
+        Statistics                  m_stats;
+    };
+}
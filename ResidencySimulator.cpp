@@ -0,0 +1,236 @@
+//--------------------------------------------------------------------------------------
+// File: ResidencySimulator.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "ResidencySimulator.h"
+#include "ChromeTrace.h"
+#include "HeadlessRenderer.h"
+#include "MappedFile.h"
+#include "ReadData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    constexpr uint32_t c_SimulatedFrames = 600;
+
+    std::string Narrow(const std::wstring& str)
+    {
+    #ifdef _WIN32
+        if (str.empty())
+            return std::string();
+
+        const int len = WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0, nullptr, nullptr);
+        std::string result(static_cast<size_t>(std::max(len, 0)), '\0');
+        if (len > 0)
+        {
+            WideCharToMultiByte(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &result[0], len, nullptr, nullptr);
+        }
+        return result;
+    #else
+        return FileName(str.c_str());
+    #endif
+    }
+
+    double ToMegabytes(uint64_t bytes) noexcept
+    {
+        return double(bytes) / (1024.0 * 1024.0);
+    }
+
+    // Camera placement follows Game::CameraHome, then orbits and dollies.
+    void XM_CALLCONV GetCameraPath(const ModelData& layout, uint32_t frame, bool lhcoords, XMMATRIX& view)
+    {
+        BoundingSphere sphere;
+        BoundingBox box;
+        layout.GetBounds(sphere, box);
+
+        if (sphere.Radius < 1.f)
+        {
+            sphere.Center = box.Center;
+            sphere.Radius = std::max(box.Extents.x, std::max(box.Extents.y, box.Extents.z));
+        }
+
+        if (sphere.Radius < 1.f)
+        {
+            sphere.Center = XMFLOAT3(0.f, 0.f, 0.f);
+            sphere.Radius = 10.f;
+        }
+
+        const float t = float(frame) / float(c_SimulatedFrames);
+        const float yaw = XM_2PI * t;
+        const float pitch = 0.35f * std::sin(XM_2PI * t);
+        const float distance = sphere.Radius * (0.5f + 1.25f * (1.f + std::cos(XM_2PI * t)));
+
+        const XMVECTOR dir = XMVectorSet(std::sin(yaw) * std::cos(pitch), std::sin(pitch),
+            (lhcoords ? -1.f : 1.f) * std::cos(yaw) * std::cos(pitch), 0.f);
+        const XMVECTOR target = XMLoadFloat3(&sphere.Center);
+        const XMVECTOR eye = XMVectorMultiplyAdd(XMVectorReplicate(distance), dir, target);
+        const XMVECTOR up = XMVectorSet(0.f, 1.f, 0.f, 0.f);
+
+        view = lhcoords ? XMMatrixLookAtLH(eye, target, up) : XMMatrixLookAtRH(eye, target, up);
+    }
+
+    void WriteError(std::ostream& out, const std::wstring& path, const char* error)
+    {
+        out << "{\"file\":";
+        WriteJSONString(out, Narrow(path).c_str());
+        out << ",\"error\":";
+        WriteJSONString(out, error);
+        out << "}\n";
+    }
+}
+
+void DX::AddModelResidency(ResidencyManager& residency, const ModelData& layout)
+{
+    const auto vbBase = static_cast<uint32_t>(residency.GetResourceCount());
+    for (auto const& vb : layout.vertexBuffers)
+    {
+        residency.AddResource(vb.fileRange.size);
+    }
+
+    const auto ibBase = static_cast<uint32_t>(residency.GetResourceCount());
+    for (auto const& ib : layout.indexBuffers)
+    {
+        residency.AddResource(ib.fileRange.size);
+    }
+
+    std::vector<uint32_t> resources;
+    for (auto const& mesh : layout.meshes)
+    {
+        resources.clear();
+        for (auto const& part : mesh.parts)
+        {
+            resources.push_back(vbBase + part.vertexBuffer);
+            resources.push_back(ibBase + part.indexBuffer);
+        }
+
+        residency.AddItem(mesh.boundingSphere, resources);
+    }
+}
+
+int DX::RunResidencySimulation(const HeadlessOptions& options, std::ostream& log)
+{
+    if (options.models.empty())
+    {
+        log << "ERROR: No models given for the residency simulation" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<std::ofstream> jsonFile;
+    if (!options.jsonFile.empty())
+    {
+        jsonFile.reset(new std::ofstream(FileName(options.jsonFile.c_str()), std::ios::out | std::ios::trunc));
+        if (!*jsonFile)
+        {
+            log << "ERROR: Failed creating " << Narrow(options.jsonFile) << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = jsonFile ? *jsonFile : log;
+    out << std::setprecision(7);
+
+    ResidencyManager::Settings settings;
+    settings.budgetBytes = options.residencyBudget;
+
+    const float aspect = float(options.width) / float(options.height);
+    const XMMATRIX projection = options.lhcoords ? XMMatrixPerspectiveFovLH(XM_PIDIV4, aspect, 0.1f, 10000.f)
+        : XMMatrixPerspectiveFovRH(XM_PIDIV4, aspect, 0.1f, 10000.f);
+
+    int result = 0;
+    for (auto const& path : options.models)
+    {
+        try
+        {
+            const MappedFile file(path.c_str());
+            auto const layout = ModelData::CreateLayoutFromSDKMESH(file.GetData(), file.GetSize(), options.lhcoords);
+
+            ResidencyManager residency(settings);
+            AddModelResidency(residency, *layout);
+
+            uint64_t modelBytes = 0;
+            for (uint32_t j = 0; j < residency.GetResourceCount(); ++j)
+            {
+                modelBytes += residency.GetResourceBytes(j);
+            }
+
+            for (uint32_t frame = 0; frame < c_SimulatedFrames; ++frame)
+            {
+                XMMATRIX view;
+                GetCameraPath(*layout, frame, options.lhcoords, view);
+                std::ignore = residency.Update(XMMatrixIdentity(), view, projection, float(options.height), !options.lhcoords);
+            }
+
+            auto const& stats = residency.GetStatistics();
+            const bool overBudget = stats.peakResidentBytes > settings.budgetBytes;
+            const double hitRate = stats.totalVisible ? 1.0 - double(stats.totalMisses) / double(stats.totalVisible) : 1.0;
+
+            out << "{\"file\":";
+            WriteJSONString(out, Narrow(path).c_str());
+            out << ",\"budget_bytes\":" << settings.budgetBytes
+                << ",\"upload_bytes_per_frame\":" << settings.uploadBytesPerFrame
+                << ",\"frames\":" << stats.frames
+                << ",\"model_bytes\":" << modelBytes
+                << ",\"resources\":" << residency.GetResourceCount()
+                << ",\"items\":" << residency.GetItemCount()
+                << ",\"visible\":" << stats.totalVisible
+                << ",\"misses\":" << stats.totalMisses
+                << ",\"hit_rate\":" << hitRate
+                << ",\"loads\":" << stats.totalLoads
+                << ",\"evictions\":" << stats.totalEvictions
+                << ",\"loaded_bytes\":" << stats.totalLoadedBytes
+                << ",\"peak_resident_bytes\":" << stats.peakResidentBytes
+                << ",\"over_budget\":" << (overBudget ? "true" : "false")
+                << "}\n";
+
+            if (jsonFile)
+            {
+                log << Narrow(path) << ": " << std::fixed << std::setprecision(1) << (hitRate * 100.0) << "% of visible meshes resident, "
+                    << stats.totalLoads << " loads (" << std::setprecision(2) << ToMegabytes(stats.totalLoadedBytes) << " MB), "
+                    << stats.totalEvictions << " evictions, peak " << ToMegabytes(stats.peakResidentBytes) << " of "
+                    << ToMegabytes(settings.budgetBytes) << " MB" << std::defaultfloat << std::endl;
+            }
+
+            if (overBudget)
+            {
+                log << "ERROR: " << Narrow(path) << " exceeded the residency budget" << std::endl;
+                result = 1;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            WriteError(out, path, e.what());
+            if (jsonFile)
+            {
+                log << "ERROR: " << Narrow(path) << ": " << e.what() << std::endl;
+            }
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,35 @@
+//--------------------------------------------------------------------------------------
+// File: ResidencySimulator.h
+//
+// Runs the streaming residency policy over a scripted camera path without a Direct3D
+// device, to measure how well a budget serves a model: how often visible meshes were
+// missing, how much was loaded and evicted, and whether the budget was ever exceeded.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ModelData.h"
+#include "ResidencyManager.h"
+
+#include <ostream>
+
+
+namespace DX
+{
+    struct HeadlessOptions;
+
+    // Adds a model's layout as the viewer streams it: resources are the vertex buffers,
+    // sized by their file ranges, followed by the index buffers; items are the meshes.
+    void AddModelResidency(ResidencyManager& residency, const ModelData& layout);
+
+    // Each SDKMESH in options.models is memory-mapped, its layout read with
+    // ModelData::CreateLayoutFromSDKMESH, and the camera moved through one orbit while
+    // dollying in from three times the bounding radius to half of it and back out, over
+    // 600 frames at options.width x options.height. One JSON line per model goes to
+    // options.jsonFile if given, or to 'log'. Returns 0 if every model was simulated and
+    // stayed within options.residencyBudget bytes, 1 otherwise.
+    int RunResidencySimulation(const HeadlessOptions& options, std::ostream& log);
+}
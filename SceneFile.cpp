@@ -0,0 +1,210 @@
+//--------------------------------------------------------------------------------------
+// File: SceneFile.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "SceneFile.h"
+#include "ReadData.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cwctype>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    std::wstring Widen(const std::string& str)
+    {
+    #ifdef _WIN32
+        const int len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), nullptr, 0);
+        std::wstring result(static_cast<size_t>(std::max(len, 0)), L'\0');
+        if (len > 0)
+        {
+            MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()), &result[0], len);
+        }
+        return result;
+    #else
+        std::wstring result(str.size(), L'\0');
+        const size_t len = mbstowcs(&result[0], str.c_str(), result.size());
+        result.resize((len == static_cast<size_t>(-1)) ? 0 : len);
+        return result;
+    #endif
+    }
+
+    bool IsAbsolutePath(const std::wstring& path) noexcept
+    {
+        return !path.empty() && (path[0] == L'\\' || path[0] == L'/' || (path.size() > 1 && path[1] == L':'));
+    }
+
+    [[noreturn]] void ThrowLineError(uint32_t line, const char* message)
+    {
+        std::ostringstream error;
+        error << "Scene line " << line << ": " << message;
+        throw std::runtime_error(error.str());
+    }
+
+    // Row vectors as elsewhere in DirectXMath: scale, then rotate, then translate.
+    XMFLOAT4X4 MakeTransform(const std::vector<float>& values, uint32_t line)
+    {
+        XMFLOAT4X4 result;
+        switch (values.size())
+        {
+        case 0:
+            XMStoreFloat4x4(&result, XMMatrixIdentity());
+            break;
+
+        case 3:
+        case 6:
+        case 7:
+        {
+            const float scale = (values.size() == 7) ? values[6] : 1.f;
+            XMMATRIX m = XMMatrixScaling(scale, scale, scale);
+            if (values.size() >= 6)
+            {
+                m = XMMatrixMultiply(m, XMMatrixRotationRollPitchYaw(XMConvertToRadians(values[3]),
+                    XMConvertToRadians(values[4]), XMConvertToRadians(values[5])));
+            }
+            m = XMMatrixMultiply(m, XMMatrixTranslation(values[0], values[1], values[2]));
+            XMStoreFloat4x4(&result, m);
+            break;
+        }
+
+        case 16:
+            result = XMFLOAT4X4(values.data());
+            break;
+
+        default:
+            ThrowLineError(line, "expected 0, 3, 6, 7, or 16 numbers after the model name");
+        }
+
+        return result;
+    }
+}
+
+std::vector<SceneEntry> DX::ParseScene(const char* text, size_t length, const std::wstring& directory)
+{
+    if (!text && length)
+        throw std::invalid_argument("ParseScene");
+
+    std::wstring prefix = directory;
+    if (!prefix.empty() && prefix.back() != L'\\' && prefix.back() != L'/')
+    {
+        prefix += L'/';
+    }
+
+    std::vector<SceneEntry> entries;
+
+    std::istringstream lines(std::string(text ? text : "", length));
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(lines, line))
+    {
+        ++lineNumber;
+
+        // Skip a UTF-8 byte order mark.
+        if (lineNumber == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        {
+            line.erase(0, 3);
+        }
+
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        std::istringstream tokens(line);
+        tokens.imbue(std::locale::classic());
+
+        std::string name;
+        tokens >> std::ws;
+        if (tokens.peek() == '"')
+        {
+            tokens.get();
+            std::getline(tokens, name, '"');
+            if (tokens.eof())
+                ThrowLineError(lineNumber, "missing closing quote");
+        }
+        else
+        {
+            tokens >> name;
+        }
+
+        if (name.empty())
+            ThrowLineError(lineNumber, "missing model name");
+
+        std::vector<float> values;
+        for (;;)
+        {
+            tokens >> std::ws;
+            if (tokens.eof())
+                break;
+
+            float value = 0.f;
+            if (!(tokens >> value))
+                ThrowLineError(lineNumber, "expected a number");
+
+            values.push_back(value);
+        }
+
+        SceneEntry entry;
+        entry.fileName = Widen(name);
+        if (entry.fileName.empty())
+            ThrowLineError(lineNumber, "invalid model name");
+
+        if (!IsAbsolutePath(entry.fileName))
+        {
+            entry.fileName.insert(0, prefix);
+        }
+
+        entry.transform = MakeTransform(values, lineNumber);
+        entry.line = lineNumber;
+        entries.emplace_back(std::move(entry));
+    }
+
+    return entries;
+}
+
+std::vector<SceneEntry> DX::LoadScene(const wchar_t* fileName)
+{
+    if (!fileName)
+        throw std::invalid_argument("LoadScene");
+
+    auto const text = ReadData(fileName);
+
+    const std::wstring path = fileName;
+    const size_t slash = path.find_last_of(L"\\/");
+    const std::wstring directory = (slash == std::wstring::npos) ? std::wstring() : path.substr(0, slash + 1);
+
+    return ParseScene(reinterpret_cast<const char*>(text.data()), text.size(), directory);
+}
+
+bool DX::IsSceneExtension(const wchar_t* extension) noexcept
+{
+    if (!extension)
+        return false;
+
+    const wchar_t* name = L".scene";
+    for (; *extension && *name; ++extension, ++name)
+    {
+        if (std::towlower(static_cast<wint_t>(*extension)) != static_cast<wint_t>(*name))
+            return false;
+    }
+    return *extension == *name;
+}
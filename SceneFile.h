@@ -0,0 +1,46 @@
+//--------------------------------------------------------------------------------------
+// File: SceneFile.h
+//
+// Reads a .scene file: a text list of models to load together, one per line, each with
+// its own placement.
+//
+//      # model                 x y z   [rx ry rz [scale]]
+//      engine.sdkmesh          0 0 0
+//      bolt.sdkmesh            1.5 0 0   0 90 0
+//      "cover plate.cmo"       0 2 0   0 0 0   0.5
+//      frame.vbo               <16 numbers: a row-major world matrix>
+//
+// Rotations are in degrees about the X, Y, and Z axes. Model paths may be quoted and are
+// relative to the scene file; blank lines and lines starting with '#' are ignored.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace DX
+{
+    struct SceneEntry
+    {
+        std::wstring            fileName;
+        DirectX::XMFLOAT4X4     transform;
+        uint32_t                line;           // In the scene file, for error messages
+    };
+
+    // 'directory' is prepended to relative model paths; it may be empty or end in a
+    // separator. Throws std::runtime_error naming the line of the first malformed entry.
+    std::vector<SceneEntry> ParseScene(_In_reads_(length) const char* text, size_t length, const std::wstring& directory);
+
+    std::vector<SceneEntry> LoadScene(_In_z_ const wchar_t* fileName);
+
+    bool IsSceneExtension(_In_opt_z_ const wchar_t* extension) noexcept;
+}
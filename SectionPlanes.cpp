@@ -0,0 +1,215 @@
+//--------------------------------------------------------------------------------------
+// File: SectionPlanes.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "SectionPlanes.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_PacketWidth = 4;
+
+    // A plane maps from world to object space by the transpose of the object's world
+    // matrix, since dot(plane, p * world) == dot(plane * transpose(world), p).
+    inline XMVECTOR XM_CALLCONV ToObjectSpace(FXMVECTOR plane, FXMMATRIX world) noexcept
+    {
+        return XMVector4Transform(plane, XMMatrixTranspose(world));
+    }
+}
+
+//--------------------------------------------------------------------------------------
+void SectionPlanes::BoxBatch::Clear() noexcept
+{
+    m_packets.clear();
+    m_count = 0;
+}
+
+void SectionPlanes::BoxBatch::Reserve(size_t count)
+{
+    m_packets.reserve((count + c_PacketWidth - 1) / c_PacketWidth);
+}
+
+void SectionPlanes::BoxBatch::Add(const BoundingBox& box)
+{
+    const size_t lane = m_count % c_PacketWidth;
+    if (!lane)
+    {
+        m_packets.emplace_back();
+    }
+
+    auto& packet = m_packets.back();
+    const float center[3] = { box.Center.x, box.Center.y, box.Center.z };
+    const float extents[3] = { box.Extents.x, box.Extents.y, box.Extents.z };
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        for (size_t j = lane; j < c_PacketWidth; ++j)
+        {
+            packet.center[axis][j] = center[axis];
+            packet.extents[axis][j] = extents[axis];
+        }
+    }
+
+    ++m_count;
+}
+
+//--------------------------------------------------------------------------------------
+void SectionPlanes::SetPlanes(const XMFLOAT4* planes, size_t count)
+{
+    if (count > MaxPlanes || (count && !planes))
+        throw std::invalid_argument("SectionPlanes::SetPlanes");
+
+    std::copy(planes, planes + count, m_planes);
+    m_count = count;
+}
+
+void SectionPlanes::SetBox(const BoundingBox& box) noexcept
+{
+    const float center[3] = { box.Center.x, box.Center.y, box.Center.z };
+    const float extents[3] = { box.Extents.x, box.Extents.y, box.Extents.z };
+
+    // Facing inward: x > min and -x > -max on each axis.
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        float normal[3] = {};
+        normal[axis] = 1.f;
+        m_planes[axis * 2] = XMFLOAT4(normal[0], normal[1], normal[2], extents[axis] - center[axis]);
+        m_planes[axis * 2 + 1] = XMFLOAT4(-normal[0], -normal[1], -normal[2], extents[axis] + center[axis]);
+    }
+    m_count = MaxPlanes;
+}
+
+size_t XM_CALLCONV SectionPlanes::Classify(const BoxBatch& boxes, FXMMATRIX world, Result* results, size_t count) const noexcept
+{
+    count = std::min(count, boxes.m_count);
+    if (!m_count)
+    {
+        std::fill(results, results + count, Result::Inside);
+        return 0;
+    }
+
+    // Each plane's components and absolute normal splatted across the lanes.
+    XMVECTOR planes[MaxPlanes][7];
+    for (size_t p = 0; p < m_count; ++p)
+    {
+        const XMVECTOR plane = ToObjectSpace(XMLoadFloat4(&m_planes[p]), world);
+        const XMVECTOR absolute = XMVectorAbs(plane);
+        planes[p][0] = XMVectorSplatX(plane);
+        planes[p][1] = XMVectorSplatY(plane);
+        planes[p][2] = XMVectorSplatZ(plane);
+        planes[p][3] = XMVectorSplatW(plane);
+        planes[p][4] = XMVectorSplatX(absolute);
+        planes[p][5] = XMVectorSplatY(absolute);
+        planes[p][6] = XMVectorSplatZ(absolute);
+    }
+
+    size_t outside = 0;
+    for (size_t first = 0; first < count; first += c_PacketWidth)
+    {
+        auto const& packet = boxes.m_packets[first / c_PacketWidth];
+        const XMVECTOR cx = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packet.center[0]));
+        const XMVECTOR cy = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packet.center[1]));
+        const XMVECTOR cz = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packet.center[2]));
+        const XMVECTOR ex = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packet.extents[0]));
+        const XMVECTOR ey = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packet.extents[1]));
+        const XMVECTOR ez = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(packet.extents[2]));
+
+        // As BoundingBox::Intersects: the box is behind a plane when the signed distance
+        // of its center is below minus its projected radius, and in front when above it.
+        XMVECTOR anyBehind = XMVectorFalseInt();
+        XMVECTOR allInFront = XMVectorTrueInt();
+        for (size_t p = 0; p < m_count; ++p)
+        {
+            const XMVECTOR* plane = planes[p];
+            const XMVECTOR distance = XMVectorMultiplyAdd(cz, plane[2], XMVectorMultiplyAdd(cy, plane[1], XMVectorMultiplyAdd(cx, plane[0], plane[3])));
+            const XMVECTOR radius = XMVectorMultiplyAdd(ez, plane[6], XMVectorMultiplyAdd(ey, plane[5], XMVectorMultiply(ex, plane[4])));
+
+            anyBehind = XMVectorOrInt(anyBehind, XMVectorLess(distance, XMVectorNegate(radius)));
+            allInFront = XMVectorAndInt(allInFront, XMVectorGreater(distance, radius));
+        }
+
+        XMUINT4 behind, inFront;
+        XMStoreUInt4(&behind, anyBehind);
+        XMStoreUInt4(&inFront, allInFront);
+        const uint32_t behindLanes[c_PacketWidth] = { behind.x, behind.y, behind.z, behind.w };
+        const uint32_t inFrontLanes[c_PacketWidth] = { inFront.x, inFront.y, inFront.z, inFront.w };
+
+        const size_t lanes = std::min(c_PacketWidth, count - first);
+        for (size_t j = 0; j < lanes; ++j)
+        {
+            if (behindLanes[j])
+            {
+                results[first + j] = Result::Outside;
+                ++outside;
+            }
+            else
+            {
+                results[first + j] = inFrontLanes[j] ? Result::Inside : Result::Clipped;
+            }
+        }
+    }
+
+    return outside;
+}
+
+size_t XM_CALLCONV SectionPlanes::ClassifyScalar(const BoundingBox* boxes, FXMMATRIX world, Result* results, size_t count) const noexcept
+{
+    // Intersects expects unit normals.
+    XMVECTOR planes[MaxPlanes];
+    for (size_t p = 0; p < m_count; ++p)
+    {
+        planes[p] = XMPlaneNormalize(ToObjectSpace(XMLoadFloat4(&m_planes[p]), world));
+    }
+
+    size_t outside = 0;
+    for (size_t j = 0; j < count; ++j)
+    {
+        Result result = Result::Inside;
+        for (size_t p = 0; p < m_count; ++p)
+        {
+            const PlaneIntersectionType type = boxes[j].Intersects(planes[p]);
+            if (type == BACK)
+            {
+                result = Result::Outside;
+                ++outside;
+                break;
+            }
+            else if (type == INTERSECTING)
+            {
+                result = Result::Clipped;
+            }
+        }
+        results[j] = result;
+    }
+
+    return outside;
+}
+
+size_t XM_CALLCONV SectionPlanes::GetClipPlanes(FXMMATRIX viewProjection, XMFLOAT4* planes) const noexcept
+{
+    // Clip-space positions map back by the inverse, so planes go forward by its transpose.
+    const XMMATRIX toClip = XMMatrixTranspose(XMMatrixInverse(nullptr, viewProjection));
+    for (size_t p = 0; p < m_count; ++p)
+    {
+        XMStoreFloat4(&planes[p], XMVector4Transform(XMLoadFloat4(&m_planes[p]), toClip));
+    }
+    return m_count;
+}
@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------------------
+// File: SectionPlanes.h
+//
+// Section planes for looking inside dense assemblies: up to six planes, each keeping the
+// half-space in front of it, or a clip box made of the six planes of its faces. Meshes
+// are classified against the planes before drawing so those entirely on the clipped side
+// are never submitted, and only the ones crossing a plane need per-triangle clipping.
+// Mesh bounds are stored four at a time as structure-of-arrays packets, so the test of a
+// plane against four boxes is a handful of DirectXMath operations.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace DX
+{
+    class SectionPlanes
+    {
+    public:
+        static constexpr size_t MaxPlanes = 6;
+
+        enum class Result : uint8_t
+        {
+            Inside,     // In front of every plane; draw as is
+            Clipped,    // Crosses at least one plane
+            Outside,    // Entirely behind a plane; skip
+        };
+
+        // Object-space boxes classified together, such as the meshes of a model.
+        class BoxBatch
+        {
+        public:
+            BoxBatch() noexcept : m_count(0) {}
+
+            void Clear() noexcept;
+            void Reserve(size_t count);
+            void Add(const DirectX::BoundingBox& box);
+
+            size_t GetCount() const noexcept { return m_count; }
+            size_t GetMemoryUsage() const noexcept { return m_packets.capacity() * sizeof(Packet); }
+
+        private:
+            friend class SectionPlanes;
+
+            // Unused lanes repeat the last box.
+            struct Packet
+            {
+                float   center[3][4];       // x, y, and z of each lane
+                float   extents[3][4];
+            };
+
+            std::vector<Packet> m_packets;
+            size_t              m_count;
+        };
+
+        SectionPlanes() noexcept : m_planes{}, m_count(0) {}
+
+        // Each plane is (normal, distance): points where dot(normal, p) + distance > 0
+        // are kept. The normals need not be unit length.
+        void SetPlanes(_In_reads_(count) const DirectX::XMFLOAT4* planes, size_t count);
+
+        // Keeps what is inside the box.
+        void SetBox(const DirectX::BoundingBox& box) noexcept;
+
+        void Clear() noexcept { m_count = 0; }
+
+        bool IsEnabled() const noexcept { return m_count > 0; }
+        size_t GetPlaneCount() const noexcept { return m_count; }
+        const DirectX::XMFLOAT4& GetPlane(size_t index) const noexcept { return m_planes[index]; }
+
+        // Classifies every box of the batch, placed by 'world' into the space of the
+        // planes, writing one result per box. The planes are taken into object space
+        // instead of the boxes into world space, so rotated boxes are tested exactly.
+        // Returns how many are Outside.
+        size_t XM_CALLCONV Classify(const BoxBatch& boxes, DirectX::FXMMATRIX world, _Out_writes_(count) Result* results, size_t count) const noexcept;
+
+        // Same result one box at a time with BoundingBox::Intersects, for checking
+        // Classify.
+        size_t XM_CALLCONV ClassifyScalar(_In_reads_(count) const DirectX::BoundingBox* boxes, DirectX::FXMMATRIX world, _Out_writes_(count) Result* results, size_t count) const noexcept;
+
+        // The planes in clip space, for SoftwareRasterizer::SetClipPlanes, given the
+        // matrix from the planes' space to clip space. Returns how many were written.
+        size_t XM_CALLCONV GetClipPlanes(DirectX::FXMMATRIX viewProjection, _Out_writes_(MaxPlanes) DirectX::XMFLOAT4* planes) const noexcept;
+
+    private:
+        DirectX::XMFLOAT4   m_planes[MaxPlanes];
+        size_t              m_count;
+    };
+}
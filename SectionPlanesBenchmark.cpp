@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------------------
+// File: SectionPlanesBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "SectionPlanes.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <tuple>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    // Size of the clip box around the middle of each model, as a fraction of its bounds;
+    // not a round number, so mesh bounds don't land on a face.
+    constexpr float c_SectionBoxScale = 0.37f;
+}
+
+void DX::BenchmarkSectionPlanes(const ModelData& model, uint32_t iterations,
+    BenchmarkReport::Model& result, std::ostream& log)
+{
+    SectionPlanes section;
+    {
+        BoundingSphere sphere;
+        BoundingBox box;
+        model.GetBounds(sphere, box);
+
+        XMStoreFloat3(&box.Extents, XMVectorScale(XMLoadFloat3(&box.Extents), c_SectionBoxScale));
+        section.SetBox(box);
+    }
+
+    const size_t meshCount = model.meshes.size();
+    SectionPlanes::BoxBatch meshBoxes;
+    std::vector<BoundingBox> meshBounds;
+    meshBoxes.Reserve(meshCount);
+    meshBounds.reserve(meshCount);
+    for (auto const& mesh : model.meshes)
+    {
+        meshBoxes.Add(mesh.boundingBox);
+        meshBounds.push_back(mesh.boundingBox);
+    }
+
+    std::vector<SectionPlanes::Result> results(meshCount);
+    size_t rejected = 0;
+    const auto classify = TimeStage(iterations, [&]()
+    {
+        rejected = section.Classify(meshBoxes, XMMatrixIdentity(), results.data(), meshCount);
+    });
+
+    std::vector<SectionPlanes::Result> expected(meshCount);
+    auto const scalarStart = std::chrono::steady_clock::now();
+    std::ignore = section.ClassifyScalar(meshBounds.data(), XMMatrixIdentity(), expected.data(), meshCount);
+    const double scalarMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scalarStart).count();
+
+    if (results != expected)
+        throw std::runtime_error("Section plane classification differs from testing one box at a time");
+
+    result.stages.push_back({ "section", classify });
+
+    log << "  section box: " << rejected << " of " << meshCount << " meshes rejected, "
+        << std::count(results.cbegin(), results.cend(), SectionPlanes::Result::Clipped) << " clipped, "
+        << std::fixed << std::setprecision(2) << (classify.meanMs > 0. ? double(meshCount) / classify.meanMs / 1000. : 0.) << " Mboxes/s, "
+        << (classify.meanMs > 0. ? scalarMs / classify.meanMs : 0.) << "x faster than one box at a time" << std::endl;
+}
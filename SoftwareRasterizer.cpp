@@ -0,0 +1,1164 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareRasterizer.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "SoftwareRasterizer.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+namespace
+{
+    // Vertex positions are snapped to 1/16th of a pixel. Together with the guard band
+    // this keeps edge functions within 32 bits inside a partially covered 8x8 block.
+    constexpr int32_t c_SubPixelBits = 4;
+    constexpr int32_t c_SubPixelScale = int32_t(1) << c_SubPixelBits;
+    constexpr int32_t c_HalfPixel = c_SubPixelScale / 2;
+
+    // Largest screen coordinate, in pixels, after guard-band clipping.
+    constexpr float c_MaxCoordinate = 16384.f;
+    constexpr float c_MaxGuardBand = 16.f;
+    constexpr size_t c_MaxTargetSize = 8192;
+
+    constexpr size_t c_ClipPlanes = 6;
+    constexpr size_t c_MaxClipVertices = 3 + c_ClipPlanes + SoftwareRasterizer::MaxClipDistances;
+
+    // Primitives are set up in chunks of this size, each chunk in parallel.
+    constexpr size_t c_SetupGrain = 2048;
+
+    // Rows per task when resolving weighted blended transparency.
+    constexpr size_t c_ResolveGrain = 16;
+
+    // Set in a bin entry to indicate a line rather than a triangle.
+    constexpr uint32_t c_LineFlag = 0x80000000;
+
+    constexpr size_t c_BlockPixels = SoftwareRasterizer::BlockSize * SoftwareRasterizer::BlockSize;
+
+    // Blocks where a triangle writes at least this many pixels get their maximum depth
+    // recomputed; otherwise the old value remains a conservative bound.
+    constexpr uint32_t c_HiZRefreshPixels = 16;
+
+    constexpr XMVECTORF32 c_LaneOffsets = { { { 0.f, 1.f, 2.f, 3.f } } };
+
+    constexpr XMVECTORU32 c_LaneMasks[16] =
+    {
+        { { { 0, 0, 0, 0 } } },
+        { { { 0xFFFFFFFF, 0, 0, 0 } } },
+        { { { 0, 0xFFFFFFFF, 0, 0 } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0, 0 } } },
+        { { { 0, 0, 0xFFFFFFFF, 0 } } },
+        { { { 0xFFFFFFFF, 0, 0xFFFFFFFF, 0 } } },
+        { { { 0, 0xFFFFFFFF, 0xFFFFFFFF, 0 } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0 } } },
+        { { { 0, 0, 0, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0, 0, 0xFFFFFFFF } } },
+        { { { 0, 0xFFFFFFFF, 0, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0, 0xFFFFFFFF } } },
+        { { { 0, 0, 0xFFFFFFFF, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0, 0xFFFFFFFF, 0xFFFFFFFF } } },
+        { { { 0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF } } },
+    };
+
+    int64_t FloorDiv(int64_t a, int64_t b) noexcept
+    {
+        return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+    }
+
+    uint32_t CountBits(uint32_t mask) noexcept
+    {
+        uint32_t count = 0;
+        for (; mask; mask &= mask - 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    uint32_t GetLaneMask(FXMVECTOR v) noexcept
+    {
+        uint32_t lanes[4];
+        XMStoreInt4(lanes, v);
+        return (lanes[0] & 1) | ((lanes[1] & 1) << 1) | ((lanes[2] & 1) << 2) | ((lanes[3] & 1) << 3);
+    }
+
+    //----------------------------------------------------------------------------------
+    // Four edge function values for adjacent pixels in a row.
+#if defined(_XM_SSE_INTRINSICS_)
+    using EdgeVector = __m128i;
+
+    inline EdgeVector EdgeSetup(int32_t value, int32_t step) noexcept
+    {
+        return _mm_setr_epi32(value, value + step, value + 2 * step, value + 3 * step);
+    }
+
+    inline EdgeVector EdgeAdd(EdgeVector v, int32_t step) noexcept
+    {
+        return _mm_add_epi32(v, _mm_set1_epi32(step));
+    }
+
+    // Lanes where all three edge functions are non-negative.
+    inline uint32_t EdgeCoverage(EdgeVector e0, EdgeVector e1, EdgeVector e2) noexcept
+    {
+        const __m128i sign = _mm_or_si128(_mm_or_si128(e0, e1), e2);
+        return ~static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(sign))) & 0xF;
+    }
+#elif defined(_XM_ARM_NEON_INTRINSICS_)
+    using EdgeVector = int32x4_t;
+
+    inline EdgeVector EdgeSetup(int32_t value, int32_t step) noexcept
+    {
+        const int32_t lanes[4] = { value, value + step, value + 2 * step, value + 3 * step };
+        return vld1q_s32(lanes);
+    }
+
+    inline EdgeVector EdgeAdd(EdgeVector v, int32_t step) noexcept
+    {
+        return vaddq_s32(v, vdupq_n_s32(step));
+    }
+
+    inline uint32_t EdgeCoverage(EdgeVector e0, EdgeVector e1, EdgeVector e2) noexcept
+    {
+        const uint32x4_t sign = vshrq_n_u32(vreinterpretq_u32_s32(vorrq_s32(vorrq_s32(e0, e1), e2)), 31);
+        const uint32_t negative = vgetq_lane_u32(sign, 0)
+            | (vgetq_lane_u32(sign, 1) << 1)
+            | (vgetq_lane_u32(sign, 2) << 2)
+            | (vgetq_lane_u32(sign, 3) << 3);
+        return ~negative & 0xF;
+    }
+#else
+    struct EdgeVector
+    {
+        int32_t v[4];
+    };
+
+    inline EdgeVector EdgeSetup(int32_t value, int32_t step) noexcept
+    {
+        return { { value, value + step, value + 2 * step, value + 3 * step } };
+    }
+
+    inline EdgeVector EdgeAdd(EdgeVector v, int32_t step) noexcept
+    {
+        for (auto& lane : v.v)
+        {
+            lane += step;
+        }
+        return v;
+    }
+
+    inline uint32_t EdgeCoverage(const EdgeVector& e0, const EdgeVector& e1, const EdgeVector& e2) noexcept
+    {
+        uint32_t mask = 0;
+        for (uint32_t j = 0; j < 4; ++j)
+        {
+            if ((e0.v[j] | e1.v[j] | e2.v[j]) >= 0)
+                mask |= 1u << j;
+        }
+        return mask;
+    }
+#endif
+
+    //----------------------------------------------------------------------------------
+    struct ClipVertex
+    {
+        XMVECTOR    position;
+        XMVECTOR    color;
+
+        // Signed distance to each clip plane; the vertex is inside when all are >= 0.
+        float PlaneDistance(size_t plane, float guardBandX, float guardBandY) const noexcept
+        {
+            const float x = XMVectorGetX(position);
+            const float y = XMVectorGetY(position);
+            const float z = XMVectorGetZ(position);
+            const float w = XMVectorGetW(position);
+
+            switch (plane)
+            {
+            case 0:     return z;                           // Near
+            case 1:     return w - z;                       // Far
+            case 2:     return guardBandX * w + x;
+            case 3:     return guardBandX * w - x;
+            case 4:     return guardBandY * w + y;
+            default:    return guardBandY * w - y;
+            }
+        }
+
+        static ClipVertex Interpolate(const ClipVertex& a, const ClipVertex& b, float t) noexcept
+        {
+            return { XMVectorLerp(a.position, b.position, t), XMVectorLerp(a.color, b.color, t) };
+        }
+    };
+
+    // Rounds to what a render target of 'format' would hold; without alpha, it reads as 1.
+    inline void XM_CALLCONV StoreColor(DXGI_FORMAT format, XMHALF4& dest, FXMVECTOR color) noexcept
+    {
+        if (format == DXGI_FORMAT_R11G11B10_FLOAT)
+        {
+            XMFLOAT3PK packed;
+            XMStoreFloat3PK(&packed, color);
+            XMStoreHalf4(&dest, XMVectorSetW(XMLoadFloat3PK(&packed), 1.f));
+        }
+        else
+        {
+            XMStoreHalf4(&dest, color);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------
+struct SoftwareRasterizer::Triangle
+{
+    // Edge e runs from (edgeX, edgeY) by (edgeDX, edgeDY), in subpixels. Its edge
+    // function is positive on the inside and gives the weight of the opposite vertex.
+    int32_t     edgeX[3];
+    int32_t     edgeY[3];
+    int32_t     edgeDX[3];
+    int32_t     edgeDY[3];
+    int32_t     edgeBias[3];        // -1 for edges that do not own pixels on them (top-left rule)
+
+    int32_t     minX;               // Pixel bounds, inclusive
+    int32_t     minY;
+    int32_t     maxX;
+    int32_t     maxY;
+
+    // Attribute planes, evaluated at pixel centers relative to the origin (in pixels).
+    float       originX;
+    float       originY;
+    float       z;
+    float       dzdx;
+    float       dzdy;
+    float       minZ;
+    float       invW;
+    float       dwdx;
+    float       dwdy;
+    XMFLOAT4    color;              // Color divided by w, for perspective-correct interpolation
+    XMFLOAT4    dcdx;
+    XMFLOAT4    dcdy;
+
+    BlendMode   blend;
+    bool        depthWrite;
+};
+
+struct SoftwareRasterizer::Line
+{
+    float       x[2];
+    float       y[2];
+    float       z[2];
+    float       invW[2];
+    XMFLOAT4    color[2];
+
+    int32_t     minX;
+    int32_t     minY;
+    int32_t     maxX;
+    int32_t     maxY;
+
+    BlendMode   blend;
+    bool        depthWrite;
+};
+
+// The primitives from one chunk of a draw, binned by tile in submission order.
+struct SoftwareRasterizer::Batch
+{
+    std::vector<Triangle>               triangles;
+    std::vector<Line>                   lines;
+    std::vector<std::vector<uint32_t>>  bins;
+    uint64_t                            submitted;
+    uint64_t                            drawn;
+    uint64_t                            lineCount;
+
+    void Reset(size_t tileCount)
+    {
+        triangles.clear();
+        lines.clear();
+        bins.resize(tileCount);
+        for (auto& bin : bins)
+        {
+            bin.clear();
+        }
+        submitted = drawn = lineCount = 0;
+    }
+};
+
+struct SoftwareRasterizer::WorkerStatistics
+{
+    uint64_t    pixels;
+    uint64_t    blocksCulled;
+    uint8_t     padding[64 - 2 * sizeof(uint64_t)];     // Avoid false sharing
+};
+
+//--------------------------------------------------------------------------------------
+SoftwareRasterizer::SoftwareRasterizer(size_t width, size_t height, TaskPool* pool) :
+    m_width(0),
+    m_height(0),
+    m_pitch(0),
+    m_tilesX(0),
+    m_tilesY(0),
+    m_blocksX(0),
+    m_guardBandX(1.f),
+    m_guardBandY(1.f),
+    m_colorFormat(DXGI_FORMAT_R16G16B16A16_FLOAT),
+    m_cullMode(CullMode::CounterClockwise),
+    m_blendMode(BlendMode::Opaque),
+    m_depthWrite(true),
+    m_clipPlanes{},
+    m_clipPlaneCount(0),
+    m_pool(pool),
+    m_batchCount(0),
+    m_setupStats{},
+    m_workerCount(pool ? pool->GetThreadCount() : 1)
+{
+    m_workerStats.reset(new WorkerStatistics[m_workerCount]);
+    ResetStatistics();
+
+    SetSize(width, height);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+}
+
+void SoftwareRasterizer::SetSize(size_t width, size_t height)
+{
+    if (!width || !height || width > c_MaxTargetSize || height > c_MaxTargetSize)
+        throw std::invalid_argument("Invalid render target size");
+
+    m_batchCount = 0;
+
+    m_width = width;
+    m_height = height;
+    m_pitch = width;
+    m_tilesX = (width + TileSize - 1) / TileSize;
+    m_tilesY = (height + TileSize - 1) / TileSize;
+    m_blocksX = (width + BlockSize - 1) / BlockSize;
+
+    const size_t blocksY = (height + BlockSize - 1) / BlockSize;
+
+    m_color.resize(m_pitch * height);
+    if (!m_revealage.empty())
+    {
+        m_accumulation.assign(m_pitch * height, XMFLOAT4(0.f, 0.f, 0.f, 0.f));
+        m_revealage.assign(m_pitch * height, 1.f);
+    }
+    m_depth.resize(m_blocksX * blocksY * c_BlockPixels);
+    m_blockMaxDepth.resize(m_blocksX * blocksY);
+
+    // Screen coordinates of ndc * guardBand must stay within c_MaxCoordinate.
+    m_guardBandX = std::min(c_MaxGuardBand, 2.f * c_MaxCoordinate / float(width) - 1.f);
+    m_guardBandY = std::min(c_MaxGuardBand, 2.f * c_MaxCoordinate / float(height) - 1.f);
+}
+
+void SoftwareRasterizer::Clear(const XMFLOAT4& color, float depth)
+{
+    for (size_t j = 0; j < m_batchCount; ++j)
+    {
+        auto const& batch = *m_batches[j];
+        m_setupStats.triangles += batch.submitted;
+        m_setupStats.trianglesDrawn += batch.drawn;
+        m_setupStats.lines += batch.lineCount;
+    }
+    m_batchCount = 0;
+
+    XMHALF4 clearColor;
+    StoreColor(m_colorFormat, clearColor, XMLoadFloat4(&color));
+
+    std::fill(m_color.begin(), m_color.end(), clearColor);
+    std::fill(m_depth.begin(), m_depth.end(), depth);
+    std::fill(m_blockMaxDepth.begin(), m_blockMaxDepth.end(), depth);
+    std::fill(m_accumulation.begin(), m_accumulation.end(), XMFLOAT4(0.f, 0.f, 0.f, 0.f));
+    std::fill(m_revealage.begin(), m_revealage.end(), 1.f);
+}
+
+void SoftwareRasterizer::SetColorFormat(DXGI_FORMAT format)
+{
+    if (format != DXGI_FORMAT_R16G16B16A16_FLOAT && format != DXGI_FORMAT_R11G11B10_FLOAT)
+        throw std::invalid_argument("SoftwareRasterizer::SetColorFormat");
+
+    m_colorFormat = format;
+}
+
+void SoftwareRasterizer::SetBlendMode(BlendMode mode)
+{
+    if (mode == BlendMode::WeightedBlended && m_revealage.empty())
+    {
+        m_accumulation.assign(m_pitch * m_height, XMFLOAT4(0.f, 0.f, 0.f, 0.f));
+        m_revealage.assign(m_pitch * m_height, 1.f);
+    }
+
+    m_blendMode = mode;
+}
+
+void SoftwareRasterizer::SetClipPlanes(const XMFLOAT4* planes, size_t count)
+{
+    if (count > MaxClipDistances || (count && !planes))
+        throw std::invalid_argument("SoftwareRasterizer::SetClipPlanes");
+
+    std::copy(planes, planes + count, m_clipPlanes);
+    m_clipPlaneCount = count;
+}
+
+SoftwareRasterizer::Statistics SoftwareRasterizer::GetStatistics() const noexcept
+{
+    Statistics stats = m_setupStats;
+    for (size_t j = 0; j < m_batchCount; ++j)
+    {
+        auto const& batch = *m_batches[j];
+        stats.triangles += batch.submitted;
+        stats.trianglesDrawn += batch.drawn;
+        stats.lines += batch.lineCount;
+    }
+
+    for (size_t j = 0; j < m_workerCount; ++j)
+    {
+        stats.pixels += m_workerStats[j].pixels;
+        stats.blocksCulled += m_workerStats[j].blocksCulled;
+    }
+
+    return stats;
+}
+
+void SoftwareRasterizer::ResetStatistics() noexcept
+{
+    m_setupStats = {};
+    for (size_t j = 0; j < m_batchCount; ++j)
+    {
+        auto& batch = *m_batches[j];
+        batch.submitted = batch.drawn = batch.lineCount = 0;
+    }
+
+    for (size_t j = 0; j < m_workerCount; ++j)
+    {
+        m_workerStats[j].pixels = 0;
+        m_workerStats[j].blocksCulled = 0;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Setup and binning
+//--------------------------------------------------------------------------------------
+void SoftwareRasterizer::DrawIndexed(const Vertex* vertices, size_t vertexCount,
+    const uint32_t* indices, size_t indexCount,
+    int32_t baseVertex, Topology topology)
+{
+    if (!vertices || !indices)
+        return;
+
+    size_t count = 0;
+    switch (topology)
+    {
+    case Topology::TriangleList:    count = indexCount / 3; break;
+    case Topology::TriangleStrip:   count = (indexCount >= 3) ? (indexCount - 2) : 0; break;
+    case Topology::LineList:        count = indexCount / 2; break;
+    case Topology::LineStrip:       count = (indexCount >= 2) ? (indexCount - 1) : 0; break;
+    }
+
+    if (!count)
+        return;
+
+    const size_t chunks = (count + c_SetupGrain - 1) / c_SetupGrain;
+    const size_t firstBatch = m_batchCount;
+    const size_t tileCount = m_tilesX * m_tilesY;
+
+    while (m_batches.size() < firstBatch + chunks)
+    {
+        m_batches.emplace_back(std::make_unique<Batch>());
+    }
+
+    for (size_t j = 0; j < chunks; ++j)
+    {
+        m_batches[firstBatch + j]->Reset(tileCount);
+    }
+    m_batchCount += chunks;
+
+    auto setup = [&](size_t begin, size_t end, size_t)
+    {
+        for (size_t j = begin; j < end; ++j)
+        {
+            const size_t first = j * c_SetupGrain;
+            SetupPrimitives(*m_batches[firstBatch + j], vertices, vertexCount, indices, baseVertex, topology,
+                first, std::min(first + c_SetupGrain, count));
+        }
+    };
+
+    if (m_pool)
+    {
+        m_pool->ParallelFor(chunks, 1, setup);
+    }
+    else
+    {
+        setup(0, chunks, 0);
+    }
+}
+
+void SoftwareRasterizer::Draw(const Vertex* vertices, size_t vertexCount, Topology topology)
+{
+    std::vector<uint32_t> indices(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        indices[i] = static_cast<uint32_t>(i);
+    }
+
+    DrawIndexed(vertices, vertexCount, indices.data(), indices.size(), 0, topology);
+}
+
+void SoftwareRasterizer::SetupPrimitives(Batch& batch, const Vertex* vertices, size_t vertexCount,
+    const uint32_t* indices, int32_t baseVertex, Topology topology,
+    size_t first, size_t last) const
+{
+    const BlendMode blend = m_blendMode;
+    const float width = float(m_width);
+    const float height = float(m_height);
+
+    auto fetch = [&](size_t i) -> const Vertex*
+    {
+        const int64_t index = int64_t(indices[i]) + baseVertex;
+        return (index >= 0 && index < int64_t(vertexCount)) ? &vertices[index] : nullptr;
+    };
+
+    auto toClip = [](const Vertex& v) -> ClipVertex
+    {
+        return { XMLoadFloat4(&v.position), XMLoadFloat4(&v.color) };
+    };
+
+    // The frustum planes, then any set with SetClipPlanes.
+    const size_t planeCount = c_ClipPlanes + m_clipPlaneCount;
+    auto planeDistance = [&](const ClipVertex& v, size_t plane) -> float
+    {
+        return (plane < c_ClipPlanes) ? v.PlaneDistance(plane, m_guardBandX, m_guardBandY)
+            : XMVectorGetX(XMVector4Dot(v.position, XMLoadFloat4(&m_clipPlanes[plane - c_ClipPlanes])));
+    };
+
+    auto bin = [&](int32_t minX, int32_t minY, int32_t maxX, int32_t maxY, uint32_t entry)
+    {
+        const size_t tx0 = size_t(minX) / TileSize;
+        const size_t tx1 = size_t(maxX) / TileSize;
+        const size_t ty0 = size_t(minY) / TileSize;
+        const size_t ty1 = size_t(maxY) / TileSize;
+        for (size_t ty = ty0; ty <= ty1; ++ty)
+        {
+            for (size_t tx = tx0; tx <= tx1; ++tx)
+            {
+                batch.bins[ty * m_tilesX + tx].push_back(entry);
+            }
+        }
+    };
+
+    auto setupTriangle = [&](const ClipVertex& c0, const ClipVertex& c1, const ClipVertex& c2)
+    {
+        const ClipVertex* clip[3] = { &c0, &c1, &c2 };
+
+        int32_t sx[3];
+        int32_t sy[3];
+        float z[3];
+        float invW[3];
+        XMVECTOR color[3];
+        for (size_t j = 0; j < 3; ++j)
+        {
+            const float w = 1.f / XMVectorGetW(clip[j]->position);
+            const float x = (XMVectorGetX(clip[j]->position) * w * 0.5f + 0.5f) * width;
+            const float y = (0.5f - XMVectorGetY(clip[j]->position) * w * 0.5f) * height;
+
+            sx[j] = static_cast<int32_t>(std::lround(x * float(c_SubPixelScale)));
+            sy[j] = static_cast<int32_t>(std::lround(y * float(c_SubPixelScale)));
+            z[j] = XMVectorGetZ(clip[j]->position) * w;
+            invW[j] = w;
+            color[j] = XMVectorScale(clip[j]->color, w);
+        }
+
+        // With y pointing down, a positive area means the triangle is clockwise on screen.
+        int64_t area = int64_t(sx[1] - sx[0]) * int64_t(sy[2] - sy[0]) - int64_t(sx[2] - sx[0]) * int64_t(sy[1] - sy[0]);
+        if (!area)
+            return;
+
+        if ((area > 0 && m_cullMode == CullMode::Clockwise)
+            || (area < 0 && m_cullMode == CullMode::CounterClockwise))
+            return;
+
+        if (area < 0)
+        {
+            std::swap(sx[1], sx[2]);
+            std::swap(sy[1], sy[2]);
+            std::swap(z[1], z[2]);
+            std::swap(invW[1], invW[2]);
+            std::swap(color[1], color[2]);
+            area = -area;
+        }
+
+        // Pixel centers are at +0.5.
+        const int64_t minX = std::max<int64_t>(0, FloorDiv(std::min({ sx[0], sx[1], sx[2] }) - c_HalfPixel + c_SubPixelScale - 1, c_SubPixelScale));
+        const int64_t maxX = std::min<int64_t>(int64_t(m_width) - 1, FloorDiv(std::max({ sx[0], sx[1], sx[2] }) - c_HalfPixel, c_SubPixelScale));
+        const int64_t minY = std::max<int64_t>(0, FloorDiv(std::min({ sy[0], sy[1], sy[2] }) - c_HalfPixel + c_SubPixelScale - 1, c_SubPixelScale));
+        const int64_t maxY = std::min<int64_t>(int64_t(m_height) - 1, FloorDiv(std::max({ sy[0], sy[1], sy[2] }) - c_HalfPixel, c_SubPixelScale));
+        if (minX > maxX || minY > maxY)
+            return;
+
+        Triangle tri;
+        for (size_t e = 0; e < 3; ++e)
+        {
+            const size_t a = (e + 1) % 3;
+            const size_t b = (e + 2) % 3;
+            tri.edgeX[e] = sx[a];
+            tri.edgeY[e] = sy[a];
+            tri.edgeDX[e] = sx[b] - sx[a];
+            tri.edgeDY[e] = sy[b] - sy[a];
+
+            // Top-left fill rule, for edges with the interior on the positive side.
+            const bool topLeft = (tri.edgeDY[e] == 0 && tri.edgeDX[e] > 0) || tri.edgeDY[e] < 0;
+            tri.edgeBias[e] = topLeft ? 0 : -1;
+        }
+
+        tri.minX = static_cast<int32_t>(minX);
+        tri.minY = static_cast<int32_t>(minY);
+        tri.maxX = static_cast<int32_t>(maxX);
+        tri.maxY = static_cast<int32_t>(maxY);
+
+        // Attribute plane equations from the snapped positions.
+        const float x0 = float(sx[0]) / float(c_SubPixelScale);
+        const float y0 = float(sy[0]) / float(c_SubPixelScale);
+        const float x10 = float(sx[1] - sx[0]) / float(c_SubPixelScale);
+        const float y10 = float(sy[1] - sy[0]) / float(c_SubPixelScale);
+        const float x20 = float(sx[2] - sx[0]) / float(c_SubPixelScale);
+        const float y20 = float(sy[2] - sy[0]) / float(c_SubPixelScale);
+        const float invDet = 1.f / (x10 * y20 - x20 * y10);
+
+        auto plane = [&](float a0, float a1, float a2, float& value, float& ddx, float& ddy)
+        {
+            value = a0;
+            ddx = ((a1 - a0) * y20 - (a2 - a0) * y10) * invDet;
+            ddy = ((a2 - a0) * x10 - (a1 - a0) * x20) * invDet;
+        };
+
+        tri.originX = x0;
+        tri.originY = y0;
+        plane(z[0], z[1], z[2], tri.z, tri.dzdx, tri.dzdy);
+        plane(invW[0], invW[1], invW[2], tri.invW, tri.dwdx, tri.dwdy);
+        tri.minZ = std::min({ z[0], z[1], z[2] });
+
+        const XMVECTOR d1 = XMVectorSubtract(color[1], color[0]);
+        const XMVECTOR d2 = XMVectorSubtract(color[2], color[0]);
+        XMStoreFloat4(&tri.color, color[0]);
+        XMStoreFloat4(&tri.dcdx, XMVectorScale(XMVectorSubtract(XMVectorScale(d1, y20), XMVectorScale(d2, y10)), invDet));
+        XMStoreFloat4(&tri.dcdy, XMVectorScale(XMVectorSubtract(XMVectorScale(d2, x10), XMVectorScale(d1, x20)), invDet));
+
+        tri.blend = blend;
+        tri.depthWrite = m_depthWrite;
+
+        ++batch.drawn;
+        bin(tri.minX, tri.minY, tri.maxX, tri.maxY, static_cast<uint32_t>(batch.triangles.size()));
+        batch.triangles.push_back(tri);
+    };
+
+    auto drawTriangle = [&](const Vertex& v0, const Vertex& v1, const Vertex& v2)
+    {
+        ++batch.submitted;
+
+        ClipVertex polygon[2][c_MaxClipVertices] = { { toClip(v0), toClip(v1), toClip(v2) }, {} };
+        size_t count = 3;
+        size_t current = 0;
+
+        // Sutherland-Hodgman against each plane in turn.
+        for (size_t plane = 0; plane < planeCount; ++plane)
+        {
+            const ClipVertex* in = polygon[current];
+            ClipVertex* out = polygon[current ^ 1];
+            size_t outCount = 0;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const ClipVertex& a = in[i];
+                const ClipVertex& b = in[(i + 1) % count];
+                const float da = planeDistance(a, plane);
+                const float db = planeDistance(b, plane);
+
+                if (da >= 0.f)
+                    out[outCount++] = a;
+
+                if ((da >= 0.f) != (db >= 0.f))
+                    out[outCount++] = ClipVertex::Interpolate(a, b, da / (da - db));
+            }
+
+            if (outCount < 3)
+                return;
+
+            count = outCount;
+            current ^= 1;
+        }
+
+        const ClipVertex* clipped = polygon[current];
+        for (size_t i = 1; i + 1 < count; ++i)
+        {
+            setupTriangle(clipped[0], clipped[i], clipped[i + 1]);
+        }
+    };
+
+    auto drawLine = [&](const Vertex& v0, const Vertex& v1)
+    {
+        ++batch.lineCount;
+
+        const ClipVertex a = toClip(v0);
+        const ClipVertex b = toClip(v1);
+
+        // Parametric clip of the segment against each plane.
+        float t0 = 0.f;
+        float t1 = 1.f;
+        for (size_t plane = 0; plane < planeCount; ++plane)
+        {
+            const float da = planeDistance(a, plane);
+            const float db = planeDistance(b, plane);
+            if (da < 0.f && db < 0.f)
+                return;
+
+            if (da < 0.f)
+                t0 = std::max(t0, da / (da - db));
+            else if (db < 0.f)
+                t1 = std::min(t1, da / (da - db));
+        }
+
+        if (t0 > t1)
+            return;
+
+        Line line;
+        const ClipVertex ends[2] = { ClipVertex::Interpolate(a, b, t0), ClipVertex::Interpolate(a, b, t1) };
+        for (size_t j = 0; j < 2; ++j)
+        {
+            const float w = 1.f / XMVectorGetW(ends[j].position);
+            line.x[j] = (XMVectorGetX(ends[j].position) * w * 0.5f + 0.5f) * width;
+            line.y[j] = (0.5f - XMVectorGetY(ends[j].position) * w * 0.5f) * height;
+            line.z[j] = XMVectorGetZ(ends[j].position) * w;
+            line.invW[j] = w;
+            XMStoreFloat4(&line.color[j], ends[j].color);
+        }
+
+        const float minX = std::floor(std::min(line.x[0], line.x[1]));
+        const float maxX = std::floor(std::max(line.x[0], line.x[1]));
+        const float minY = std::floor(std::min(line.y[0], line.y[1]));
+        const float maxY = std::floor(std::max(line.y[0], line.y[1]));
+        if (maxX < 0.f || maxY < 0.f || minX >= width || minY >= height)
+            return;
+
+        line.minX = static_cast<int32_t>(std::max(minX, 0.f));
+        line.minY = static_cast<int32_t>(std::max(minY, 0.f));
+        line.maxX = static_cast<int32_t>(std::min(maxX, width - 1.f));
+        line.maxY = static_cast<int32_t>(std::min(maxY, height - 1.f));
+        line.blend = blend;
+        line.depthWrite = m_depthWrite;
+
+        bin(line.minX, line.minY, line.maxX, line.maxY, static_cast<uint32_t>(batch.lines.size()) | c_LineFlag);
+        batch.lines.push_back(line);
+    };
+
+    for (size_t p = first; p < last; ++p)
+    {
+        switch (topology)
+        {
+        case Topology::TriangleList:
+            {
+                auto v0 = fetch(p * 3);
+                auto v1 = fetch(p * 3 + 1);
+                auto v2 = fetch(p * 3 + 2);
+                if (v0 && v1 && v2)
+                    drawTriangle(*v0, *v1, *v2);
+            }
+            break;
+
+        case Topology::TriangleStrip:
+            {
+                // Every other triangle in a strip has its winding reversed.
+                auto v0 = fetch((p & 1) ? p + 1 : p);
+                auto v1 = fetch((p & 1) ? p : p + 1);
+                auto v2 = fetch(p + 2);
+                if (v0 && v1 && v2)
+                    drawTriangle(*v0, *v1, *v2);
+            }
+            break;
+
+        case Topology::LineList:
+            {
+                auto v0 = fetch(p * 2);
+                auto v1 = fetch(p * 2 + 1);
+                if (v0 && v1)
+                    drawLine(*v0, *v1);
+            }
+            break;
+
+        case Topology::LineStrip:
+            {
+                auto v0 = fetch(p);
+                auto v1 = fetch(p + 1);
+                if (v0 && v1)
+                    drawLine(*v0, *v1);
+            }
+            break;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Rasterization
+//--------------------------------------------------------------------------------------
+void SoftwareRasterizer::Flush()
+{
+    if (!m_batchCount)
+        return;
+
+    auto rasterize = [&](size_t begin, size_t end, size_t worker)
+    {
+        for (size_t tile = begin; tile < end; ++tile)
+        {
+            RasterizeTile(tile, m_workerStats[worker]);
+        }
+    };
+
+    const size_t tileCount = m_tilesX * m_tilesY;
+    if (m_pool)
+    {
+        m_pool->ParallelFor(tileCount, 1, rasterize);
+    }
+    else
+    {
+        rasterize(0, tileCount, 0);
+    }
+
+    for (size_t j = 0; j < m_batchCount; ++j)
+    {
+        auto const& batch = *m_batches[j];
+        m_setupStats.triangles += batch.submitted;
+        m_setupStats.trianglesDrawn += batch.drawn;
+        m_setupStats.lines += batch.lineCount;
+    }
+    m_batchCount = 0;
+}
+
+void SoftwareRasterizer::ResolveWeightedBlended()
+{
+    Flush();
+
+    if (m_revealage.empty())
+        return;
+
+    auto resolve = [&](size_t begin, size_t end, size_t)
+    {
+        for (size_t y = begin; y < end; ++y)
+        {
+            for (size_t x = 0; x < m_width; ++x)
+            {
+                const size_t index = y * m_pitch + x;
+                const float revealage = m_revealage[index];
+                if (revealage >= 1.f)
+                    continue;
+
+                // Blended over the scene as SRC_ALPHA, INV_SRC_ALPHA with an alpha of one
+                // minus the revealage.
+                const XMVECTOR accumulation = XMLoadFloat4(&m_accumulation[index]);
+                const XMVECTOR average = XMVectorScale(accumulation, 1.f / std::max(XMVectorGetW(accumulation), 1e-5f));
+                StoreColor(m_colorFormat, m_color[index], XMVectorLerp(XMLoadHalf4(&m_color[index]), average, 1.f - revealage));
+
+                m_accumulation[index] = XMFLOAT4(0.f, 0.f, 0.f, 0.f);
+                m_revealage[index] = 1.f;
+            }
+        }
+    };
+
+    if (m_pool)
+    {
+        m_pool->ParallelFor(m_height, c_ResolveGrain, resolve);
+    }
+    else
+    {
+        resolve(0, m_height, 0);
+    }
+}
+
+void SoftwareRasterizer::RasterizeTile(size_t tile, WorkerStatistics& stats) noexcept
+{
+    const size_t tileX = tile % m_tilesX;
+    const size_t tileY = tile / m_tilesX;
+
+    for (size_t j = 0; j < m_batchCount; ++j)
+    {
+        auto const& batch = *m_batches[j];
+        for (const uint32_t entry : batch.bins[tile])
+        {
+            if (entry & c_LineFlag)
+            {
+                RasterizeLine(batch.lines[entry & ~c_LineFlag], tileX, tileY, stats);
+            }
+            else
+            {
+                RasterizeTriangle(batch.triangles[entry], tileX, tileY, stats);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const Triangle& tri, size_t tileX, size_t tileY, WorkerStatistics& stats) noexcept
+{
+    const int32_t x0 = std::max(tri.minX, static_cast<int32_t>(tileX * TileSize));
+    const int32_t y0 = std::max(tri.minY, static_cast<int32_t>(tileY * TileSize));
+    const int32_t x1 = std::min(tri.maxX, static_cast<int32_t>((tileX + 1) * TileSize) - 1);
+    const int32_t y1 = std::min(tri.maxY, static_cast<int32_t>((tileY + 1) * TileSize) - 1);
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    constexpr int32_t c_Block = static_cast<int32_t>(BlockSize);
+    constexpr int32_t c_BlockSpan = c_Block - 1;
+
+    const XMVECTOR dzdx = XMVectorReplicate(tri.dzdx);
+    const XMVECTOR planeColor = XMLoadFloat4(&tri.color);
+    const XMVECTOR planeColorDX = XMLoadFloat4(&tri.dcdx);
+    const XMVECTOR planeColorDY = XMLoadFloat4(&tri.dcdy);
+
+    for (int32_t by = y0 / c_Block; by <= y1 / c_Block; ++by)
+    {
+        for (int32_t bx = x0 / c_Block; bx <= x1 / c_Block; ++bx)
+        {
+            const size_t blockIndex = size_t(by) * m_blocksX + size_t(bx);
+
+            // Hierarchical depth test: nothing in this block can pass LESS_EQUAL.
+            if (tri.minZ > m_blockMaxDepth[blockIndex])
+            {
+                ++stats.blocksCulled;
+                continue;
+            }
+
+            const int32_t px = bx * c_Block;
+            const int32_t py = by * c_Block;
+
+            // Edge functions at the block's first pixel center, then trivial accept/reject
+            // from the extremes at its corners.
+            const int64_t sampleX = int64_t(px) * c_SubPixelScale + c_HalfPixel;
+            const int64_t sampleY = int64_t(py) * c_SubPixelScale + c_HalfPixel;
+
+            int32_t edge[3];
+            int32_t stepX[3];
+            int32_t stepY[3];
+            bool partial = false;
+            bool rejected = false;
+            for (size_t e = 0; e < 3; ++e)
+            {
+                const int64_t dx = int64_t(tri.edgeDX[e]) * c_SubPixelScale;
+                const int64_t dy = -int64_t(tri.edgeDY[e]) * c_SubPixelScale;
+                const int64_t value = int64_t(tri.edgeDX[e]) * (sampleY - tri.edgeY[e])
+                    - int64_t(tri.edgeDY[e]) * (sampleX - tri.edgeX[e]) + tri.edgeBias[e];
+
+                const int64_t minValue = value + std::min<int64_t>(0, dy * c_BlockSpan) + std::min<int64_t>(0, dx * c_BlockSpan);
+                const int64_t maxValue = value + std::max<int64_t>(0, dy * c_BlockSpan) + std::max<int64_t>(0, dx * c_BlockSpan);
+
+                if (maxValue < 0)
+                {
+                    rejected = true;
+                    break;
+                }
+
+                if (minValue >= 0)
+                {
+                    // Covers the whole block; leave it out of the per-pixel test.
+                    edge[e] = stepX[e] = stepY[e] = 0;
+                }
+                else
+                {
+                    edge[e] = static_cast<int32_t>(value);
+                    stepX[e] = static_cast<int32_t>(dy);
+                    stepY[e] = static_cast<int32_t>(dx);
+                    partial = true;
+                }
+            }
+
+            if (rejected)
+                continue;
+
+            // Coverage for each row of the block, clipped to the render target.
+            const int32_t rows = std::min(c_Block, static_cast<int32_t>(m_height) - py);
+            const uint32_t columns = (static_cast<int32_t>(m_width) - px >= c_Block) ? 0xFFu : ((1u << (static_cast<int32_t>(m_width) - px)) - 1u);
+
+            uint32_t rowMask[BlockSize] = {};
+            if (partial)
+            {
+                EdgeVector left[3];
+                EdgeVector right[3];
+                for (size_t e = 0; e < 3; ++e)
+                {
+                    left[e] = EdgeSetup(edge[e], stepX[e]);
+                    right[e] = EdgeSetup(edge[e] + 4 * stepX[e], stepX[e]);
+                }
+
+                for (int32_t r = 0; r < rows; ++r)
+                {
+                    rowMask[r] = (EdgeCoverage(left[0], left[1], left[2])
+                        | (EdgeCoverage(right[0], right[1], right[2]) << 4)) & columns;
+
+                    for (size_t e = 0; e < 3; ++e)
+                    {
+                        left[e] = EdgeAdd(left[e], stepY[e]);
+                        right[e] = EdgeAdd(right[e], stepY[e]);
+                    }
+                }
+            }
+            else
+            {
+                for (int32_t r = 0; r < rows; ++r)
+                {
+                    rowMask[r] = columns;
+                }
+            }
+
+            // Depth test four pixels at a time, then shade the survivors.
+            float* depth = &m_depth[blockIndex * c_BlockPixels];
+            const float cx = float(px) + 0.5f - tri.originX;
+            const float cy = float(py) + 0.5f - tri.originY;
+
+            uint32_t written = 0;
+            for (int32_t r = 0; r < rows; ++r)
+            {
+                if (!rowMask[r])
+                    continue;
+
+                const float dy = cy + float(r);
+                const float rowZ = tri.z + tri.dzdx * cx + tri.dzdy * dy;
+
+                for (uint32_t half = 0; half < BlockSize; half += 4)
+                {
+                    uint32_t mask = (rowMask[r] >> half) & 0xF;
+                    if (!mask)
+                        continue;
+
+                    float* depthRow = depth + size_t(r) * BlockSize + half;
+                    const XMVECTOR z = XMVectorMultiplyAdd(XMVectorAdd(c_LaneOffsets, XMVectorReplicate(float(half))), dzdx, XMVectorReplicate(rowZ));
+                    const XMVECTOR stored = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(depthRow));
+
+                    // Direct3D's default depth function is LESS_EQUAL.
+                    mask &= GetLaneMask(XMVectorLessOrEqual(z, stored));
+                    if (!mask)
+                        continue;
+
+                    if (tri.depthWrite)
+                    {
+                        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(depthRow), XMVectorSelect(stored, z, c_LaneMasks[mask]));
+                    }
+
+                    written += CountBits(mask);
+
+                    float laneZ[4];
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(laneZ), z);
+
+                    for (uint32_t lane = 0; lane < 4; ++lane)
+                    {
+                        if (!(mask & (1u << lane)))
+                            continue;
+
+                        const float dx = cx + float(half + lane);
+                        const float invW = tri.invW + tri.dwdx * dx + tri.dwdy * dy;
+                        const XMVECTOR color = XMVectorMultiplyAdd(planeColorDY, XMVectorReplicate(dy),
+                            XMVectorMultiplyAdd(planeColorDX, XMVectorReplicate(dx), planeColor));
+
+                        WritePixel(size_t(px) + half + lane, size_t(py + r), XMVectorScale(color, 1.f / invW),
+                            laneZ[lane], tri.blend);
+                    }
+                }
+            }
+
+            stats.pixels += written;
+
+            if (tri.depthWrite && written >= c_HiZRefreshPixels)
+            {
+                XMVECTOR maxDepth = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(depth));
+                for (size_t j = 4; j < c_BlockPixels; j += 4)
+                {
+                    maxDepth = XMVectorMax(maxDepth, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(depth + j)));
+                }
+
+                m_blockMaxDepth[blockIndex] = std::max(
+                    std::max(XMVectorGetX(maxDepth), XMVectorGetY(maxDepth)),
+                    std::max(XMVectorGetZ(maxDepth), XMVectorGetW(maxDepth)));
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::RasterizeLine(const Line& line, size_t tileX, size_t tileY, WorkerStatistics& stats) noexcept
+{
+    const int64_t tileX0 = std::max<int64_t>(line.minX, int64_t(tileX * TileSize));
+    const int64_t tileY0 = std::max<int64_t>(line.minY, int64_t(tileY * TileSize));
+    const int64_t tileX1 = std::min<int64_t>(line.maxX, int64_t((tileX + 1) * TileSize) - 1);
+    const int64_t tileY1 = std::min<int64_t>(line.maxY, int64_t((tileY + 1) * TileSize) - 1);
+    if (tileX0 > tileX1 || tileY0 > tileY1)
+        return;
+
+    const XMVECTOR colorA = XMLoadFloat4(&line.color[0]);
+    const XMVECTOR colorB = XMLoadFloat4(&line.color[1]);
+
+    const float steps = std::max(std::ceil(std::max(std::abs(line.x[1] - line.x[0]), std::abs(line.y[1] - line.y[0]))), 1.f);
+    const int count = static_cast<int>(steps);
+
+    for (int i = 0; i <= count; ++i)
+    {
+        const float t = float(i) / steps;
+        const int64_t x = static_cast<int64_t>(std::floor(line.x[0] + (line.x[1] - line.x[0]) * t));
+        const int64_t y = static_cast<int64_t>(std::floor(line.y[0] + (line.y[1] - line.y[0]) * t));
+        if (x < tileX0 || x > tileX1 || y < tileY0 || y > tileY1)
+            continue;
+
+        const size_t blockIndex = size_t(y / int64_t(BlockSize)) * m_blocksX + size_t(x / int64_t(BlockSize));
+        float& stored = m_depth[blockIndex * c_BlockPixels + size_t(y % int64_t(BlockSize)) * BlockSize + size_t(x % int64_t(BlockSize))];
+
+        // Depth is linear in screen space; color is perspective-correct.
+        const float z = line.z[0] + (line.z[1] - line.z[0]) * t;
+        if (z > stored)
+            continue;
+
+        if (line.depthWrite)
+        {
+            // The block's maximum depth stays a conservative bound.
+            stored = z;
+        }
+
+        const float invW = line.invW[0] + (line.invW[1] - line.invW[0]) * t;
+        const float s = (line.invW[1] * t) / invW;
+
+        WritePixel(size_t(x), size_t(y), XMVectorLerp(colorA, colorB, s), z, line.blend);
+        ++stats.pixels;
+    }
+}
+
+void SoftwareRasterizer::WritePixel(size_t x, size_t y, FXMVECTOR color, float z, BlendMode blend) noexcept
+{
+    const size_t index = y * m_pitch + x;
+    XMHALF4& dest = m_color[index];
+    switch (blend)
+    {
+    case BlendMode::AlphaBlend:
+        {
+            const XMVECTOR inv = XMVectorSubtract(XMVectorSplatOne(), XMVectorSplatW(color));
+            StoreColor(m_colorFormat, dest, XMVectorMultiplyAdd(XMLoadHalf4(&dest), inv, color));
+        }
+        break;
+
+    case BlendMode::WeightedBlended:
+        {
+            // The weight of equation 10 in the paper, from the depth buffer value.
+            const float alpha = XMVectorGetW(color);
+            const float nearness = 1.f - std::min(std::max(z, 0.f), 1.f);
+            const float weight = alpha * std::max(1e-2f, 3e3f * nearness * nearness * nearness);
+
+            XMFLOAT4& accumulation = m_accumulation[index];
+            XMStoreFloat4(&accumulation, XMVectorMultiplyAdd(color, XMVectorReplicate(weight), XMLoadFloat4(&accumulation)));
+            m_revealage[index] *= 1.f - alpha;
+        }
+        break;
+
+    default:
+        StoreColor(m_colorFormat, dest, color);
+        break;
+    }
+}
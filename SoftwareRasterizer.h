@@ -0,0 +1,193 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareRasterizer.h
+//
+// CPU rasterizer covering the subset of Direct3D 11 state the viewer uses: depth-tested
+// triangles with back-face culling, vertex color lines, and opaque or premultiplied
+// alpha blending, plus weighted blended order-independent transparency. Used for
+// headless rendering on machines without a GPU.
+//
+// Draws are clipped, set up, and binned into screen tiles as they are submitted; Flush
+// then rasterizes the tiles in parallel. The color target is R16G16B16A16_FLOAT, the
+// same format as the viewer's HDR scene render target, and can round what it stores to
+// R11G11B10_FLOAT as the viewer's other HDR format does.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#ifdef _WIN32
+#include <dxgiformat.h>
+#else
+#include <directx/dxgiformat.h>
+#endif
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+namespace DX
+{
+    class TaskPool;
+
+    class SoftwareRasterizer
+    {
+    public:
+        static constexpr size_t TileSize = 64;
+        static constexpr size_t BlockSize = 8;      // Granularity of the hierarchical depth test
+        static constexpr size_t MaxClipDistances = 8;   // As D3D11_CLIP_OR_CULL_DISTANCE_COUNT
+
+        // Matches the D3D11 rasterizer state of the same name: the faces to discard.
+        enum class CullMode : uint32_t
+        {
+            None,
+            Clockwise,
+            CounterClockwise,
+        };
+
+        enum class BlendMode : uint32_t
+        {
+            Opaque,
+            AlphaBlend,     // Premultiplied alpha, as CommonStates::AlphaBlend
+            WeightedBlended,    // Accumulated in any order until ResolveWeightedBlended
+        };
+
+        enum class Topology : uint32_t
+        {
+            TriangleList,
+            TriangleStrip,
+            LineList,
+            LineStrip,
+        };
+
+        // Output of the vertex stage: clip-space position and linear color.
+        struct Vertex
+        {
+            DirectX::XMFLOAT4   position;
+            DirectX::XMFLOAT4   color;
+        };
+
+        struct Statistics
+        {
+            uint64_t    triangles;          // Submitted
+            uint64_t    trianglesDrawn;     // Survived culling and clipping
+            uint64_t    lines;
+            uint64_t    pixels;             // Passed the depth test
+            uint64_t    blocksCulled;       // 8x8 blocks rejected by the hierarchical depth test
+        };
+
+        // Without a task pool all work runs on the calling thread.
+        SoftwareRasterizer(size_t width, size_t height, TaskPool* pool = nullptr);
+        ~SoftwareRasterizer();
+
+        SoftwareRasterizer(SoftwareRasterizer&&) = delete;
+        SoftwareRasterizer& operator= (SoftwareRasterizer&&) = delete;
+
+        SoftwareRasterizer(SoftwareRasterizer const&) = delete;
+        SoftwareRasterizer& operator= (SoftwareRasterizer const&) = delete;
+
+        void SetSize(size_t width, size_t height);
+
+        // R16G16B16A16_FLOAT or R11G11B10_FLOAT. The buffer stays half floats, but every
+        // color written is rounded to the format, blends included, and R11G11B10 colors
+        // have an alpha of 1. Pixels already written keep their values until Clear.
+        void SetColorFormat(DXGI_FORMAT format);
+        DXGI_FORMAT GetColorFormat() const noexcept { return m_colorFormat; }
+
+        // Discards any unflushed draws.
+        void Clear(const DirectX::XMFLOAT4& color, float depth = 1.f);
+
+        void SetCullMode(CullMode mode) noexcept { m_cullMode = mode; }
+        void SetBlendMode(BlendMode mode);
+        void SetDepthWrite(bool enable) noexcept { m_depthWrite = enable; }
+
+        // Clip planes in clip space, clipping as SV_ClipDistance does: only the part of a
+        // primitive where the dot product of the position with every plane is at least
+        // zero is drawn. A count of zero turns them off.
+        void SetClipPlanes(_In_reads_(count) const DirectX::XMFLOAT4* planes, size_t count);
+
+        // Each index has 'baseVertex' added before lookup, as with DrawIndexed. Indices
+        // outside of the vertex array are skipped. The vertices are consumed before this
+        // returns.
+        void DrawIndexed(_In_reads_(vertexCount) const Vertex* vertices, size_t vertexCount,
+            _In_reads_(indexCount) const uint32_t* indices, size_t indexCount,
+            int32_t baseVertex, Topology topology);
+
+        void Draw(_In_reads_(vertexCount) const Vertex* vertices, size_t vertexCount, Topology topology);
+
+        // Rasterizes all pending draws. Call before reading the color buffer.
+        void Flush();
+
+        // Flushes, then composites the WeightedBlended draws since the last Clear or
+        // resolve over the color buffer, as McGuire and Bavoil's weighted blended
+        // order-independent transparency: each pixel gets the average of its layers'
+        // colors, weighted toward the camera, covering as much as their combined alpha.
+        void ResolveWeightedBlended();
+
+        size_t GetWidth() const noexcept { return m_width; }
+        size_t GetHeight() const noexcept { return m_height; }
+
+        // Linear RGBA, row-major; rows are GetRowPitch() pixels apart.
+        const DirectX::PackedVector::XMHALF4* GetColorBuffer() const noexcept { return m_color.data(); }
+        size_t GetRowPitch() const noexcept { return m_pitch; }
+
+        TaskPool* GetTaskPool() const noexcept { return m_pool; }
+
+        Statistics GetStatistics() const noexcept;
+        void ResetStatistics() noexcept;
+
+    private:
+        struct Triangle;
+        struct Line;
+        struct Batch;
+        struct WorkerStatistics;
+
+        void SetupPrimitives(Batch& batch, const Vertex* vertices, size_t vertexCount,
+            const uint32_t* indices, int32_t baseVertex, Topology topology,
+            size_t first, size_t last) const;
+
+        void RasterizeTile(size_t tile, WorkerStatistics& stats) noexcept;
+        void RasterizeTriangle(const Triangle& tri, size_t tileX, size_t tileY, WorkerStatistics& stats) noexcept;
+        void RasterizeLine(const Line& line, size_t tileX, size_t tileY, WorkerStatistics& stats) noexcept;
+        void WritePixel(size_t x, size_t y, DirectX::FXMVECTOR color, float z, BlendMode blend) noexcept;
+
+        size_t                                          m_width;
+        size_t                                          m_height;
+        size_t                                          m_pitch;
+        size_t                                          m_tilesX;
+        size_t                                          m_tilesY;
+        size_t                                          m_blocksX;
+        float                                           m_guardBandX;
+        float                                           m_guardBandY;
+        DXGI_FORMAT                                     m_colorFormat;
+        std::vector<DirectX::PackedVector::XMHALF4>     m_color;
+        std::vector<float>                              m_depth;        // 8x8 blocks, each stored contiguously
+        std::vector<float>                              m_blockMaxDepth;
+
+        // Weighted blended transparency, allocated on first use: premultiplied colors
+        // times their weights with the weighted alphas in w, and the product of one minus
+        // each alpha.
+        std::vector<DirectX::XMFLOAT4>                  m_accumulation;
+        std::vector<float>                              m_revealage;
+
+        CullMode                                        m_cullMode;
+        BlendMode                                       m_blendMode;
+        bool                                            m_depthWrite;
+        DirectX::XMFLOAT4                               m_clipPlanes[MaxClipDistances];
+        size_t                                          m_clipPlaneCount;
+
+        TaskPool*                                       m_pool;
+        std::vector<std::unique_ptr<Batch>>             m_batches;
+        size_t                                          m_batchCount;
+        Statistics                                      m_setupStats;
+
+        std::unique_ptr<WorkerStatistics[]>             m_workerStats;
+        size_t                                          m_workerCount;
+    };
+}
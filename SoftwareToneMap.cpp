@@ -0,0 +1,278 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareToneMap.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "SoftwareToneMap.h"
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+namespace
+{
+    // Color rotation matrices from ToneMapPostProcess, in the shader's row order.
+    const XMFLOAT3X3 c_from709to2020(
+        0.6274040f, 0.3292820f, 0.0433136f,
+        0.0690970f, 0.9195400f, 0.0113612f,
+        0.0163916f, 0.0880132f, 0.8955950f);
+
+    const XMFLOAT3X3 c_fromP3D65to2020(
+        0.753845f, 0.198593f, 0.047562f,
+        0.0457456f, 0.941777f, 0.0124772f,
+        -0.00121055f, 0.0176041f, 0.983607f);
+
+    const XMFLOAT3X3 c_from709toP3D65(
+        0.822461969f, 0.1774380f, 0.0f,
+        0.033194199f, 0.9668058f, 0.0f,
+        0.017082631f, 0.0723974f, 0.9105199f);
+
+    // Constants from the shaders' LinearToSRGBEst, ToneMapACESFilmic, and LinearToST2084.
+    constexpr XMVECTORF32 c_SRGBExponent = { { { 1.f / 2.2f, 1.f / 2.2f, 1.f / 2.2f, 1.f / 2.2f } } };
+
+    constexpr XMVECTORF32 c_ACES_A = { { { 2.51f, 2.51f, 2.51f, 2.51f } } };
+    constexpr XMVECTORF32 c_ACES_B = { { { 0.03f, 0.03f, 0.03f, 0.03f } } };
+    constexpr XMVECTORF32 c_ACES_C = { { { 2.43f, 2.43f, 2.43f, 2.43f } } };
+    constexpr XMVECTORF32 c_ACES_D = { { { 0.59f, 0.59f, 0.59f, 0.59f } } };
+    constexpr XMVECTORF32 c_ACES_E = { { { 0.14f, 0.14f, 0.14f, 0.14f } } };
+
+    constexpr XMVECTORF32 c_ST2084_M1 = { { { 0.1593017578f, 0.1593017578f, 0.1593017578f, 0.1593017578f } } };
+    constexpr XMVECTORF32 c_ST2084_M2 = { { { 78.84375f, 78.84375f, 78.84375f, 78.84375f } } };
+    constexpr XMVECTORF32 c_ST2084_C1 = { { { 0.8359375f, 0.8359375f, 0.8359375f, 0.8359375f } } };
+    constexpr XMVECTORF32 c_ST2084_C2 = { { { 18.8515625f, 18.8515625f, 18.8515625f, 18.8515625f } } };
+    constexpr XMVECTORF32 c_ST2084_C3 = { { { 18.6875f, 18.6875f, 18.6875f, 18.6875f } } };
+
+    constexpr float c_ST2084MaxNits = 10000.f;
+
+    struct ToneMapConstants
+    {
+        XMMATRIX    colorRotation;      // Transposed, for XMVector3TransformNormal
+        XMVECTOR    linearExposure;
+        XMVECTOR    paperWhiteNits;
+    };
+
+    // HLSL compiles pow(x, y) as exp2(log2(x) * y); pow(0, y) is 0.
+    inline XMVECTOR XM_CALLCONV PowEst(FXMVECTOR x, FXMVECTOR y) noexcept
+    {
+        const XMVECTOR a = XMVectorAbs(x);
+        const XMVECTOR result = XMVectorExp2(XMVectorMultiply(XMVectorLog2(a), y));
+        return XMVectorSelect(result, XMVectorZero(), XMVectorEqual(a, XMVectorZero()));
+    }
+
+    inline XMVECTOR XM_CALLCONV ToneMapACESFilmic(FXMVECTOR x) noexcept
+    {
+        // Narkowicz 2015, "ACES Filmic Tone Mapping Curve"
+        const XMVECTOR num = XMVectorMultiply(x, XMVectorMultiplyAdd(c_ACES_A, x, c_ACES_B));
+        const XMVECTOR den = XMVectorMultiplyAdd(x, XMVectorMultiplyAdd(c_ACES_C, x, c_ACES_D), c_ACES_E);
+        return XMVectorSaturate(XMVectorDivide(num, den));
+    }
+
+    inline XMVECTOR XM_CALLCONV LinearToST2084(FXMVECTOR normalizedLinearValue) noexcept
+    {
+        const XMVECTOR p = PowEst(normalizedLinearValue, c_ST2084_M1);
+        return PowEst(XMVectorDivide(XMVectorMultiplyAdd(c_ST2084_C2, p, c_ST2084_C1),
+            XMVectorMultiplyAdd(c_ST2084_C3, p, XMVectorSplatOne())), c_ST2084_M2);
+    }
+
+    template<SoftwareToneMap::Operator op, SoftwareToneMap::TransferFunction func>
+    XMVECTOR XM_CALLCONV ToneMapPixel(FXMVECTOR hdr, const ToneMapConstants& constants) noexcept
+    {
+        XMVECTOR rgb = hdr;
+
+        switch (func)
+        {
+        case SoftwareToneMap::ST2084:
+            // PSHDR10: rotate to the output primaries and scale so 10,000 nits is 1.0.
+            rgb = XMVector3TransformNormal(hdr, constants.colorRotation);
+            rgb = XMVectorScale(XMVectorMultiply(rgb, constants.paperWhiteNits), 1.f / c_ST2084MaxNits);
+            rgb = LinearToST2084(rgb);
+            break;
+
+        default:
+            switch (op)
+            {
+            case SoftwareToneMap::Saturate:
+                rgb = XMVectorSaturate(XMVectorMultiply(hdr, constants.linearExposure));
+                break;
+
+            case SoftwareToneMap::Reinhard:
+                rgb = XMVectorMultiply(hdr, constants.linearExposure);
+                rgb = XMVectorDivide(rgb, XMVectorAdd(XMVectorSplatOne(), rgb));
+                break;
+
+            case SoftwareToneMap::ACESFilmic:
+                rgb = ToneMapACESFilmic(XMVectorMultiply(hdr, constants.linearExposure));
+                break;
+
+            default:
+                break;
+            }
+
+            switch (func)
+            {
+            case SoftwareToneMap::SRGB:
+                rgb = PowEst(rgb, c_SRGBExponent);
+                break;
+
+            default:
+                break;
+            }
+            break;
+        }
+
+        // Alpha passes through.
+        return XMVectorSelect(hdr, rgb, g_XMSelect1110);
+    }
+
+    inline void XM_CALLCONV StorePixel(XMFLOAT4* dest, FXMVECTOR v) noexcept { XMStoreFloat4(dest, v); }
+    inline void XM_CALLCONV StorePixel(XMHALF4* dest, FXMVECTOR v) noexcept { XMStoreHalf4(dest, v); }
+    inline void XM_CALLCONV StorePixel(XMCOLOR* dest, FXMVECTOR v) noexcept { XMStoreColor(dest, v); }
+    inline void XM_CALLCONV StorePixel(XMUDECN4* dest, FXMVECTOR v) noexcept { XMStoreUDecN4(dest, v); }
+
+    template<SoftwareToneMap::Operator op, SoftwareToneMap::TransferFunction func, typename T>
+    void ToneMapRow(const XMHALF4* src, T* dest, size_t count, const ToneMapConstants& constants) noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            StorePixel(&dest[i], ToneMapPixel<op, func>(XMLoadHalf4(&src[i]), constants));
+        }
+    }
+
+    template<typename T>
+    using RowFunction = void(*)(const XMHALF4*, T*, size_t, const ToneMapConstants&);
+
+    // The operator and transfer function are selected once per row, as the GPU version
+    // selects a pixel shader.
+    template<typename T>
+    RowFunction<T> GetRowFunction(SoftwareToneMap::Operator op, SoftwareToneMap::TransferFunction func) noexcept
+    {
+        using TM = SoftwareToneMap;
+
+        static const RowFunction<T> s_functions[TM::TransferFunction_Max][TM::Operator_Max] =
+        {
+            {
+                ToneMapRow<TM::None, TM::Linear, T>,
+                ToneMapRow<TM::Saturate, TM::Linear, T>,
+                ToneMapRow<TM::Reinhard, TM::Linear, T>,
+                ToneMapRow<TM::ACESFilmic, TM::Linear, T>,
+            },
+            {
+                ToneMapRow<TM::None, TM::SRGB, T>,
+                ToneMapRow<TM::Saturate, TM::SRGB, T>,
+                ToneMapRow<TM::Reinhard, TM::SRGB, T>,
+                ToneMapRow<TM::ACESFilmic, TM::SRGB, T>,
+            },
+            {
+                ToneMapRow<TM::None, TM::ST2084, T>,
+                ToneMapRow<TM::None, TM::ST2084, T>,
+                ToneMapRow<TM::None, TM::ST2084, T>,
+                ToneMapRow<TM::None, TM::ST2084, T>,
+            },
+        };
+
+        return s_functions[func][op];
+    }
+
+    ToneMapConstants MakeConstants(const XMFLOAT3X3& colorRotation, float linearExposure, float paperWhiteNits) noexcept
+    {
+        ToneMapConstants constants;
+        constants.colorRotation = XMMatrixTranspose(XMLoadFloat3x3(&colorRotation));
+        constants.linearExposure = XMVectorReplicate(linearExposure);
+        constants.paperWhiteNits = XMVectorReplicate(paperWhiteNits);
+        return constants;
+    }
+}
+
+SoftwareToneMap::SoftwareToneMap() noexcept :
+    m_operator(None),
+    m_transferFunction(Linear),
+    m_linearExposure(1.f),
+    m_paperWhiteNits(200.f),
+    m_colorRotation(c_from709to2020)
+{
+}
+
+void SoftwareToneMap::SetOperator(Operator op)
+{
+    if (op >= Operator_Max)
+        throw std::invalid_argument("Tonemap operator not defined");
+
+    m_operator = op;
+}
+
+void SoftwareToneMap::SetTransferFunction(TransferFunction func)
+{
+    if (func >= TransferFunction_Max)
+        throw std::invalid_argument("Electro-optical transfer function not defined");
+
+    m_transferFunction = func;
+}
+
+void SoftwareToneMap::SetExposure(float exposureValue) noexcept
+{
+    m_linearExposure = std::pow(2.f, exposureValue);
+}
+
+void SoftwareToneMap::SetST2084Parameter(float paperWhiteNits) noexcept
+{
+    m_paperWhiteNits = paperWhiteNits;
+}
+
+void SoftwareToneMap::SetColorRotation(ColorPrimaryRotation value)
+{
+    switch (value)
+    {
+    case HDTV_to_UHDTV:         m_colorRotation = c_from709to2020; break;
+    case DCI_P3_D65_to_UHDTV:   m_colorRotation = c_fromP3D65to2020; break;
+    case HDTV_to_DCI_P3_D65:    m_colorRotation = c_from709toP3D65; break;
+    default:
+        throw std::invalid_argument("Unknown ColorPrimaryRotation value");
+    }
+}
+
+void XM_CALLCONV SoftwareToneMap::SetColorRotation(CXMMATRIX value) noexcept
+{
+    XMStoreFloat3x3(&m_colorRotation, value);
+}
+
+XMVECTOR XM_CALLCONV SoftwareToneMap::Apply(FXMVECTOR hdr) const noexcept
+{
+    XMHALF4 src;
+    XMStoreHalf4(&src, hdr);
+
+    XMFLOAT4 dest;
+    ProcessRow(&src, &dest, 1);
+    return XMLoadFloat4(&dest);
+}
+
+void SoftwareToneMap::ProcessRow(const XMHALF4* src, XMFLOAT4* dest, size_t count) const noexcept
+{
+    const auto constants = MakeConstants(m_colorRotation, m_linearExposure, m_paperWhiteNits);
+    GetRowFunction<XMFLOAT4>(m_operator, m_transferFunction)(src, dest, count, constants);
+}
+
+void SoftwareToneMap::ProcessRow(const XMHALF4* src, XMHALF4* dest, size_t count) const noexcept
+{
+    const auto constants = MakeConstants(m_colorRotation, m_linearExposure, m_paperWhiteNits);
+    GetRowFunction<XMHALF4>(m_operator, m_transferFunction)(src, dest, count, constants);
+}
+
+void SoftwareToneMap::ProcessRow(const XMHALF4* src, XMCOLOR* dest, size_t count) const noexcept
+{
+    const auto constants = MakeConstants(m_colorRotation, m_linearExposure, m_paperWhiteNits);
+    GetRowFunction<XMCOLOR>(m_operator, m_transferFunction)(src, dest, count, constants);
+}
+
+void SoftwareToneMap::ProcessRow(const XMHALF4* src, XMUDECN4* dest, size_t count) const noexcept
+{
+    const auto constants = MakeConstants(m_colorRotation, m_linearExposure, m_paperWhiteNits);
+    GetRowFunction<XMUDECN4>(m_operator, m_transferFunction)(src, dest, count, constants);
+}
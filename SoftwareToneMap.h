@@ -0,0 +1,117 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareToneMap.h
+//
+// CPU implementation of DirectX Tool Kit's ToneMapPostProcess. It mirrors the shader
+// math for every operator, transfer function, and color rotation, and reads the same
+// R16G16B16A16_FLOAT source as the viewer's HDR scene. Used as the tone-map stage of
+// headless rendering and as a reference for the GPU output.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "TaskPool.h"
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace DX
+{
+    class SoftwareToneMap
+    {
+    public:
+        // Same values as ToneMapPostProcess, so the viewer's settings cast directly.
+        enum Operator : uint32_t
+        {
+            None,               // Pass-through
+            Saturate,           // Clamp [0,1]
+            Reinhard,           // x/(1+x)
+            ACESFilmic,
+            Operator_Max
+        };
+
+        enum TransferFunction : uint32_t
+        {
+            Linear,             // Pass-through
+            SRGB,               // sRGB (Rec.709 and approximate sRGB display curve)
+            ST2084,             // HDR10 (Rec.2020 color primaries and ST.2084 display curve)
+            TransferFunction_Max
+        };
+
+        enum ColorPrimaryRotation : uint32_t
+        {
+            HDTV_to_UHDTV,          // Rec.709 to Rec.2020
+            DCI_P3_D65_to_UHDTV,    // DCI-P3-D65 (a.k.a Display P3 or P3D65) to Rec.2020
+            HDTV_to_DCI_P3_D65,     // Rec.709 to DCI-P3-D65 (a.k.a Display P3 or P3D65)
+        };
+
+        SoftwareToneMap() noexcept;
+
+        // As with ToneMapPostProcess, the operator is ignored for ST2084, and exposure
+        // only applies to the Saturate, Reinhard, and ACESFilmic operators.
+        void SetOperator(Operator op);
+        void SetTransferFunction(TransferFunction func);
+
+        // Exposure value in stops; 0 is the default.
+        void SetExposure(float exposureValue = 0.0f) noexcept;
+
+        // Brightness of 1.0 in the source, in nits, for ST2084 (defaults to 200).
+        void SetST2084Parameter(float paperWhiteNits) noexcept;
+
+        void SetColorRotation(ColorPrimaryRotation value);
+        void XM_CALLCONV SetColorRotation(DirectX::CXMMATRIX value) noexcept;  // Rows as in the shader's float3x3
+
+        Operator GetOperator() const noexcept { return m_operator; }
+        TransferFunction GetTransferFunction() const noexcept { return m_transferFunction; }
+
+        // Tone-maps a single linear RGBA color, first rounded to half precision as if read
+        // from the HDR scene.
+        DirectX::XMVECTOR XM_CALLCONV Apply(DirectX::FXMVECTOR hdr) const noexcept;
+
+        // Tone-maps one scanline. The packed destinations round and saturate as the GPU
+        // does when writing to a B8G8R8A8_UNORM or R10G10B10A2_UNORM swap chain.
+        void ProcessRow(_In_reads_(count) const DirectX::PackedVector::XMHALF4* src, _Out_writes_(count) DirectX::XMFLOAT4* dest, size_t count) const noexcept;
+        void ProcessRow(_In_reads_(count) const DirectX::PackedVector::XMHALF4* src, _Out_writes_(count) DirectX::PackedVector::XMHALF4* dest, size_t count) const noexcept;
+        void ProcessRow(_In_reads_(count) const DirectX::PackedVector::XMHALF4* src, _Out_writes_(count) DirectX::PackedVector::XMCOLOR* dest, size_t count) const noexcept;
+        void ProcessRow(_In_reads_(count) const DirectX::PackedVector::XMHALF4* src, _Out_writes_(count) DirectX::PackedVector::XMUDECN4* dest, size_t count) const noexcept;
+
+        // Tone-maps an image, with rows split across the task pool when one is given.
+        // Pitches are in pixels.
+        template<typename T>
+        void Process(const DirectX::PackedVector::XMHALF4* src, size_t srcPitch,
+            T* dest, size_t destPitch, size_t width, size_t height, TaskPool* pool = nullptr) const
+        {
+            auto rows = [&](size_t begin, size_t end, size_t)
+            {
+                for (size_t y = begin; y < end; ++y)
+                {
+                    ProcessRow(src + y * srcPitch, dest + y * destPitch, width);
+                }
+            };
+
+            if (pool)
+            {
+                // Keep a work unit to about 16K pixels.
+                pool->ParallelFor(height, std::max<size_t>(1, 16384 / std::max<size_t>(width, 1)), rows);
+            }
+            else
+            {
+                rows(0, height, 0);
+            }
+        }
+
+    private:
+        Operator                m_operator;
+        TransferFunction        m_transferFunction;
+        float                   m_linearExposure;
+        float                   m_paperWhiteNits;
+        DirectX::XMFLOAT3X3     m_colorRotation;
+    };
+}
@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareToneMapBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "SoftwareToneMap.h"
+
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_ToneMapBenchmarkWidth = 3840;
+    constexpr size_t c_ToneMapBenchmarkHeight = 2160;
+
+    // As given to -tonemap:, in SoftwareToneMap::Operator order.
+    const char* c_ToneMapOperatorNames[] = { "none", "saturate", "reinhard", "aces" };
+    const char* c_TransferFunctionNames[] = { "Linear", "SRGB", "ST2084" };
+
+    static_assert(std::extent<decltype(c_ToneMapOperatorNames)>::value == SoftwareToneMap::Operator_Max, "Tone map operator name table mismatch");
+    static_assert(std::extent<decltype(c_TransferFunctionNames)>::value == SoftwareToneMap::TransferFunction_Max, "Transfer function name table mismatch");
+
+    template<typename T>
+    double TimeToneMap(const SoftwareToneMap& toneMap, const std::vector<XMHALF4>& source, std::vector<T>& dest,
+        TaskPool& pool, uint32_t iterations)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // One untimed pass to warm up caches.
+        toneMap.Process(source.data(), c_ToneMapBenchmarkWidth, dest.data(), c_ToneMapBenchmarkWidth,
+            c_ToneMapBenchmarkWidth, c_ToneMapBenchmarkHeight, &pool);
+
+        auto const start = clock::now();
+
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            toneMap.Process(source.data(), c_ToneMapBenchmarkWidth, dest.data(), c_ToneMapBenchmarkWidth,
+                c_ToneMapBenchmarkWidth, c_ToneMapBenchmarkHeight, &pool);
+        }
+
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+}
+
+std::vector<BenchmarkReport::ToneMap> DX::BenchmarkToneMap(uint32_t iterations, size_t maxThreads, std::ostream& log)
+{
+    // Hue varies across, brightness (0 to 16) down the image.
+    std::vector<XMHALF4> source(c_ToneMapBenchmarkWidth * c_ToneMapBenchmarkHeight);
+    for (size_t y = 0; y < c_ToneMapBenchmarkHeight; ++y)
+    {
+        const float intensity = 16.f * float(y) / float(c_ToneMapBenchmarkHeight - 1);
+        for (size_t x = 0; x < c_ToneMapBenchmarkWidth; ++x)
+        {
+            const float hue = XM_2PI * float(x) / float(c_ToneMapBenchmarkWidth);
+            const XMVECTOR color = XMVectorSet(
+                0.5f + 0.5f * std::cos(hue),
+                0.5f + 0.5f * std::cos(hue - XM_2PI / 3.f),
+                0.5f + 0.5f * std::cos(hue + XM_2PI / 3.f),
+                1.f);
+            XMStoreHalf4(&source[y * c_ToneMapBenchmarkWidth + x], XMVectorSetW(XMVectorScale(color, intensity), 1.f));
+        }
+    }
+
+    std::vector<XMHALF4> linearOutput(source.size());
+    std::vector<XMCOLOR> srgbOutput(source.size());
+    std::vector<XMUDECN4> hdr10Output(source.size());
+
+    const auto threadCounts = GetBenchmarkThreadCounts(maxThreads);
+
+    std::vector<std::unique_ptr<TaskPool>> pools;
+    for (auto threads : threadCounts)
+    {
+        pools.emplace_back(std::make_unique<TaskPool>(threads));
+    }
+
+    log << "Tone map: " << c_ToneMapBenchmarkWidth << "x" << c_ToneMapBenchmarkHeight << ", "
+        << iterations << " iterations" << std::endl;
+
+    const double pixels = double(c_ToneMapBenchmarkWidth) * double(c_ToneMapBenchmarkHeight) * double(iterations);
+
+    std::vector<BenchmarkReport::ToneMap> results;
+
+    SoftwareToneMap toneMap;
+    for (uint32_t func = 0; func < SoftwareToneMap::TransferFunction_Max; ++func)
+    {
+        toneMap.SetTransferFunction(static_cast<SoftwareToneMap::TransferFunction>(func));
+
+        // The operator is ignored for ST2084.
+        const uint32_t operatorCount = (func == SoftwareToneMap::ST2084) ? 1u : uint32_t(SoftwareToneMap::Operator_Max);
+        for (uint32_t op = 0; op < operatorCount; ++op)
+        {
+            toneMap.SetOperator(static_cast<SoftwareToneMap::Operator>(op));
+
+            log << c_ToneMapOperatorNames[op] << " + " << c_TransferFunctionNames[func] << std::endl;
+
+            BenchmarkReport::ToneMap result;
+            result.op = c_ToneMapOperatorNames[op];
+            result.transferFunction = c_TransferFunctionNames[func];
+
+            double baseline = 0.;
+            for (size_t j = 0; j < threadCounts.size(); ++j)
+            {
+                double seconds = 0.;
+                switch (func)
+                {
+                case SoftwareToneMap::Linear:   seconds = TimeToneMap(toneMap, source, linearOutput, *pools[j], iterations); break;
+                case SoftwareToneMap::SRGB:     seconds = TimeToneMap(toneMap, source, srgbOutput, *pools[j], iterations); break;
+                default:                        seconds = TimeToneMap(toneMap, source, hdr10Output, *pools[j], iterations); break;
+                }
+
+                const double mpixels = (seconds > 0.) ? pixels / seconds / 1000000.0 : 0.;
+                if (baseline <= 0.)
+                {
+                    baseline = mpixels;
+                }
+
+                const BenchmarkReport::ThreadResult threadResult = { threadCounts[j], seconds * 1000.0 / double(iterations), mpixels,
+                    (baseline > 0.) ? mpixels / baseline : 0. };
+                result.threads.push_back(threadResult);
+
+                log << "  " << std::setw(3) << threadCounts[j] << " threads: "
+                    << std::fixed << std::setprecision(2) << threadResult.msPerFrame << " ms/frame, "
+                    << std::setprecision(1) << mpixels << " Mpixel/s, "
+                    << std::setprecision(2) << threadResult.scaling << "x scaling" << std::endl;
+            }
+
+            results.push_back(std::move(result));
+        }
+    }
+
+    return results;
+}
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include "FrameStatistics.h"
+
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <exception>
@@ -11,11 +14,84 @@
 
 namespace DX
 {
+    // Clocks report a monotonic counter in their own units along with the counter frequency.
+
+#ifdef _WIN32
+    // Clock using QueryPerformanceCounter.
+    class QPCClock
+    {
+    public:
+        QPCClock() noexcept(false)
+        {
+            LARGE_INTEGER frequency;
+            if (!QueryPerformanceFrequency(&frequency))
+            {
+                throw std::exception();
+            }
+
+            m_frequency = static_cast<uint64_t>(frequency.QuadPart);
+        }
+
+        uint64_t GetFrequency() const noexcept { return m_frequency; }
+
+        uint64_t GetTicks() const
+        {
+            LARGE_INTEGER currentTime;
+            if (!QueryPerformanceCounter(&currentTime))
+            {
+                throw std::exception();
+            }
+
+            return static_cast<uint64_t>(currentTime.QuadPart);
+        }
+
+    private:
+        uint64_t m_frequency;
+    };
+#endif
+
+    // Clock using std::chrono::steady_clock (clock_gettime(CLOCK_MONOTONIC) on Linux).
+    class SteadyClock
+    {
+    public:
+        static constexpr uint64_t GetFrequency() noexcept
+        {
+            return static_cast<uint64_t>(std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num);
+        }
+
+        uint64_t GetTicks() const noexcept
+        {
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+    };
+
+    // Deterministic clock for tests and simulations: time only moves when advanced.
+    class ManualClock
+    {
+    public:
+        explicit ManualClock(uint64_t frequency = 10000000) noexcept : m_frequency(frequency), m_ticks(0) {}
+
+        uint64_t GetFrequency() const noexcept { return m_frequency; }
+        uint64_t GetTicks() const noexcept { return m_ticks; }
+
+        void SetTicks(uint64_t ticks) noexcept { m_ticks = ticks; }
+        void Advance(uint64_t ticks) noexcept { m_ticks += ticks; }
+        void AdvanceSeconds(double seconds) noexcept { m_ticks += static_cast<uint64_t>(seconds * double(m_frequency)); }
+
+    private:
+        uint64_t m_frequency;
+        uint64_t m_ticks;
+    };
+
     // Helper class for animation and simulation timing.
-    class StepTimer
+    template<typename TClock>
+    class BasicStepTimer
     {
     public:
-        StepTimer() noexcept(false) :
+        BasicStepTimer() noexcept(false) : BasicStepTimer(TClock()) {}
+
+        explicit BasicStepTimer(const TClock& clock) noexcept(false) :
+            m_clock(clock),
             m_elapsedTicks(0),
             m_totalTicks(0),
             m_leftOverTicks(0),
@@ -24,22 +100,26 @@ namespace DX
             m_framesThisSecond(0),
             m_qpcSecondCounter(0),
             m_isFixedTimeStep(false),
-            m_targetElapsedTicks(TicksPerSecond / 60)
+            m_targetElapsedTicks(TicksPerSecond / 60),
+            m_qpcFrameStart(0),
+            m_frameOpen(false)
         {
-            if (!QueryPerformanceFrequency(&m_qpcFrequency))
+            m_qpcFrequency = m_clock.GetFrequency();
+            if (!m_qpcFrequency)
             {
                 throw std::exception();
             }
 
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception();
-            }
+            m_qpcLastTime = m_clock.GetTicks();
 
             // Initialize max delta to 1/10 of a second.
-            m_qpcMaxDelta = static_cast<uint64_t>(m_qpcFrequency.QuadPart / 10);
+            m_qpcMaxDelta = m_qpcFrequency / 10;
         }
 
+        // Access to the underlying clock (e.g. to advance a ManualClock).
+        TClock& GetClock() noexcept { return m_clock; }
+        const TClock& GetClock() const noexcept { return m_clock; }
+
         // Get elapsed time since the previous Update call.
         uint64_t GetElapsedTicks() const noexcept { return m_elapsedTicks; }
         double GetElapsedSeconds() const noexcept { return TicksToSeconds(m_elapsedTicks); }
@@ -54,6 +134,12 @@ namespace DX
         // Get the current framerate.
         uint32_t GetFramesPerSecond() const noexcept { return m_framesPerSecond; }
 
+        // Get the rolling history of frame times: the unclamped wall time from the start of
+        // each Tick to the EndFrame after it, so waits before Tick (frame pacing, swap chain
+        // latency) aren't counted.
+        FrameTimeHistory& GetFrameTimeHistory() noexcept { return m_frameTimes; }
+        const FrameTimeHistory& GetFrameTimeHistory() const noexcept { return m_frameTimes; }
+
         // Set whether to use fixed or variable timestep mode.
         void SetFixedTimeStep(bool isFixedTimestep) noexcept { m_isFixedTimeStep = isFixedTimestep; }
 
@@ -73,11 +159,9 @@ namespace DX
 
         void ResetElapsedTime()
         {
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception();
-            }
+            m_qpcLastTime = m_clock.GetTicks();
 
+            m_frameOpen = false;
             m_leftOverTicks = 0;
             m_framesPerSecond = 0;
             m_framesThisSecond = 0;
@@ -89,27 +173,25 @@ namespace DX
         void Tick(const TUpdate& update)
         {
             // Query the current time.
-            LARGE_INTEGER currentTime;
-
-            if (!QueryPerformanceCounter(&currentTime))
-            {
-                throw std::exception();
-            }
+            const uint64_t currentTime = m_clock.GetTicks();
 
-            uint64_t timeDelta = static_cast<uint64_t>(currentTime.QuadPart - m_qpcLastTime.QuadPart);
+            uint64_t timeDelta = currentTime - m_qpcLastTime;
 
             m_qpcLastTime = currentTime;
             m_qpcSecondCounter += timeDelta;
 
+            m_qpcFrameStart = currentTime;
+            m_frameOpen = true;
+
             // Clamp excessively large time deltas (e.g. after paused in the debugger).
             if (timeDelta > m_qpcMaxDelta)
             {
                 timeDelta = m_qpcMaxDelta;
             }
 
-            // Convert QPC units into a canonical tick format. This cannot overflow due to the previous clamp.
+            // Convert clock units into a canonical tick format. This cannot overflow due to the previous clamp.
             timeDelta *= TicksPerSecond;
-            timeDelta /= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+            timeDelta /= m_qpcFrequency;
 
             const uint32_t lastFrameCount = m_frameCount;
 
@@ -158,18 +240,32 @@ namespace DX
                 m_framesThisSecond++;
             }
 
-            if (m_qpcSecondCounter >= static_cast<uint64_t>(m_qpcFrequency.QuadPart))
+            if (m_qpcSecondCounter >= m_qpcFrequency)
             {
                 m_framesPerSecond = m_framesThisSecond;
                 m_framesThisSecond = 0;
-                m_qpcSecondCounter %= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+                m_qpcSecondCounter %= m_qpcFrequency;
             }
         }
 
+        // Records the time since the start of the last Tick in the frame time history; call
+        // once the frame has been presented. Frames that aren't drawn needn't call it.
+        void EndFrame()
+        {
+            if (!m_frameOpen)
+                return;
+
+            const uint64_t frameTime = m_clock.GetTicks() - m_qpcFrameStart;
+            m_frameTimes.Push(static_cast<float>(double(frameTime) * 1000.0 / double(m_qpcFrequency)));
+            m_frameOpen = false;
+        }
+
     private:
-        // Source timing data uses QPC units.
-        LARGE_INTEGER m_qpcFrequency;
-        LARGE_INTEGER m_qpcLastTime;
+        TClock m_clock;
+
+        // Source timing data uses clock units (QPC units on Windows).
+        uint64_t m_qpcFrequency;
+        uint64_t m_qpcLastTime;
         uint64_t m_qpcMaxDelta;
 
         // Derived timing data uses a canonical tick format.
@@ -186,5 +282,18 @@ namespace DX
         // Members for configuring fixed timestep mode.
         bool m_isFixedTimeStep;
         uint64_t m_targetElapsedTicks;
+
+        // Members for frame time statistics.
+        FrameTimeHistory m_frameTimes;
+        uint64_t m_qpcFrameStart;
+        bool m_frameOpen;
     };
+
+#ifdef _WIN32
+    using DefaultClock = QPCClock;
+#else
+    using DefaultClock = SteadyClock;
+#endif
+
+    using StepTimer = BasicStepTimer<DefaultClock>;
 }
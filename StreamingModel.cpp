@@ -0,0 +1,429 @@
+//--------------------------------------------------------------------------------------
+// File: StreamingModel.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "StreamingModel.h"
+
+#include "ResidencySimulator.h"
+#include "SDKMesh.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace DirectX;
+using namespace DX;
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    std::wstring Widen(const char* str, size_t maxLength)
+    {
+        const size_t length = strnlen(str, maxLength);
+        if (!length)
+            return std::wstring();
+
+        const int len = MultiByteToWideChar(CP_UTF8, 0, str, static_cast<int>(length), nullptr, 0);
+        std::wstring result(static_cast<size_t>(std::max(len, 0)), L'\0');
+        if (len > 0)
+        {
+            MultiByteToWideChar(CP_UTF8, 0, str, static_cast<int>(length), &result[0], len);
+        }
+        return result;
+    }
+
+    // ModelData reports vertex formats by their DXGI names, less the prefix.
+    DXGI_FORMAT GetFormat(const char* name)
+    {
+        static const std::pair<const char*, DXGI_FORMAT> s_formats[] =
+        {
+            { "R32_FLOAT",          DXGI_FORMAT_R32_FLOAT },
+            { "R32G32_FLOAT",       DXGI_FORMAT_R32G32_FLOAT },
+            { "R32G32B32_FLOAT",    DXGI_FORMAT_R32G32B32_FLOAT },
+            { "R32G32B32A32_FLOAT", DXGI_FORMAT_R32G32B32A32_FLOAT },
+            { "B8G8R8A8_UNORM",     DXGI_FORMAT_B8G8R8A8_UNORM },
+            { "R8G8B8A8_UINT",      DXGI_FORMAT_R8G8B8A8_UINT },
+            { "R8G8B8A8_UNORM",     DXGI_FORMAT_R8G8B8A8_UNORM },
+            { "R8G8B8A8_SNORM",     DXGI_FORMAT_R8G8B8A8_SNORM },
+            { "R16G16B16A16_SNORM", DXGI_FORMAT_R16G16B16A16_SNORM },
+            { "R16G16_FLOAT",       DXGI_FORMAT_R16G16_FLOAT },
+            { "R16G16B16A16_FLOAT", DXGI_FORMAT_R16G16B16A16_FLOAT },
+            { "R10G10B10A2_UNORM",  DXGI_FORMAT_R10G10B10A2_UNORM },
+            { "R11G11B10_FLOAT",    DXGI_FORMAT_R11G11B10_FLOAT },
+        };
+
+        for (auto const& it : s_formats)
+        {
+            if (strcmp(it.first, name) == 0)
+                return it.second;
+        }
+
+        // DEC3N has no DXGI equivalent, as with Model::CreateFromSDKMESH.
+        throw std::runtime_error("SDKMESH: unsupported vertex format");
+    }
+
+    D3D11_PRIMITIVE_TOPOLOGY GetTopology(ModelData::Primitive primitive) noexcept
+    {
+        switch (primitive)
+        {
+        case ModelData::Primitive::TriangleList:    return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        case ModelData::Primitive::TriangleStrip:   return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+        case ModelData::Primitive::LineList:        return D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+        case ModelData::Primitive::LineStrip:       return D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP;
+        case ModelData::Primitive::PointList:       return D3D11_PRIMITIVE_TOPOLOGY_POINTLIST;
+        default:                                    return D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        }
+    }
+
+    // The effect flags Model::CreateFromSDKMESH derives from a vertex declaration.
+    struct VertexFlags
+    {
+        bool    perVertexColor;
+        bool    skinning;
+        bool    dualTexture;
+        bool    normalMaps;
+        bool    biasedNormals;
+        bool    texcoords;
+    };
+
+    VertexFlags GetVertexFlags(const ModelData::VertexBuffer& vb) noexcept
+    {
+        VertexFlags flags = {};
+        flags.skinning = vb.skinned;
+
+        for (auto const& element : vb.elements)
+        {
+            if (strcmp(element.semantic, "COLOR") == 0)
+            {
+                flags.perVertexColor = true;
+            }
+            else if (strcmp(element.semantic, "TANGENT") == 0)
+            {
+                flags.normalMaps = true;
+            }
+            else if (strcmp(element.semantic, "TEXCOORD") == 0)
+            {
+                flags.texcoords = flags.texcoords || element.semanticIndex == 0;
+                flags.dualTexture = flags.dualTexture || element.semanticIndex == 1;
+            }
+            else if (strcmp(element.semantic, "NORMAL") == 0)
+            {
+                flags.biasedNormals = strcmp(element.format, "R8G8B8A8_UNORM") == 0
+                    || strcmp(element.format, "R10G10B10A2_UNORM") == 0
+                    || strcmp(element.format, "R11G11B10_FLOAT") == 0;
+            }
+        }
+
+        return flags;
+    }
+}
+
+StreamingModel::StreamingModel(const wchar_t* fileName, bool lhcoords, const ResidencyManager::Settings& settings) :
+    m_file(fileName),
+    m_residency(settings)
+{
+    m_layout = ModelData::CreateLayoutFromSDKMESH(m_file.GetData(), m_file.GetSize(), lhcoords);
+
+    AddModelResidency(m_residency, *m_layout);
+}
+
+void StreamingModel::CreateDeviceResources(ID3D11Device* device, IEffectFactory& fxFactory)
+{
+    using namespace DXUT;
+
+    SDKMESH_HEADER header;
+    memcpy(&header, m_file.GetData(), sizeof(header));
+
+    m_model = std::make_unique<Model>();
+    m_effects.clear();
+    m_resourceParts.clear();
+    m_resourceParts.resize(m_residency.GetResourceCount());
+
+    const size_t ibBase = m_layout->vertexBuffers.size();
+
+    // Vertex declarations are shared by every part using the buffer, as the loaders do.
+    std::vector<std::shared_ptr<std::vector<D3D11_INPUT_ELEMENT_DESC>>> decls;
+    decls.reserve(m_layout->vertexBuffers.size());
+    for (auto const& vb : m_layout->vertexBuffers)
+    {
+        auto decl = std::make_shared<std::vector<D3D11_INPUT_ELEMENT_DESC>>();
+        for (auto const& element : vb.elements)
+        {
+            D3D11_INPUT_ELEMENT_DESC desc = {};
+            desc.SemanticName = element.semantic;
+            desc.SemanticIndex = element.semanticIndex;
+            desc.Format = GetFormat(element.format);
+            desc.AlignedByteOffset = element.offset;
+            desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+            decl->push_back(desc);
+        }
+        decls.emplace_back(std::move(decl));
+    }
+
+    for (auto const& meshData : m_layout->meshes)
+    {
+        auto mesh = std::make_shared<ModelMesh>();
+        mesh->name = Widen(meshData.name.c_str(), meshData.name.size());
+        mesh->ccw = meshData.ccw;
+        mesh->pmalpha = false;
+        mesh->boundingSphere = meshData.boundingSphere;
+        mesh->boundingBox = meshData.boundingBox;
+
+        for (auto const& partData : meshData.parts)
+        {
+            const D3D11_PRIMITIVE_TOPOLOGY topology = GetTopology(partData.primitive);
+            if (topology == D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED)
+                continue;
+
+            auto const& vb = m_layout->vertexBuffers[partData.vertexBuffer];
+            const VertexFlags flags = GetVertexFlags(vb);
+
+            const auto key = std::make_pair(partData.material, partData.vertexBuffer);
+            auto& cached = m_effects[key];
+            if (!cached.effect)
+            {
+                IEffectFactory::EffectInfo info;
+                info.perVertexColor = flags.perVertexColor;
+                info.enableSkinning = flags.skinning;
+                info.enableDualTexture = flags.dualTexture;
+                info.enableNormalMaps = flags.normalMaps;
+                info.biasedVertexNormals = flags.biasedNormals;
+                info.alpha = 1.f;
+
+                std::wstring name, diffuse, specular, normal, emissive;
+                if (partData.material == ModelData::None)
+                {
+                    info.ambientColor = XMFLOAT3(0.2f, 0.2f, 0.2f);
+                    info.diffuseColor = XMFLOAT3(0.8f, 0.8f, 0.8f);
+                }
+                else if (header.Version >= SDKMESH_FILE_VERSION_V2)
+                {
+                    SDKMESH_MATERIAL_V2 mh;
+                    memcpy(&mh, m_file.GetData() + header.MaterialDataOffset + partData.material * sizeof(mh), sizeof(mh));
+
+                    name = Widen(mh.Name, MAX_MATERIAL_NAME);
+                    diffuse = Widen(mh.AlbedoTexture, MAX_TEXTURE_NAME);
+                    specular = Widen(mh.RMATexture, MAX_TEXTURE_NAME);
+                    normal = Widen(mh.NormalTexture, MAX_TEXTURE_NAME);
+                    emissive = Widen(mh.EmissiveTexture, MAX_TEXTURE_NAME);
+                    info.alpha = (mh.Alpha == 0.f) ? 1.f : mh.Alpha;
+                }
+                else
+                {
+                    SDKMESH_MATERIAL mh;
+                    memcpy(&mh, m_file.GetData() + header.MaterialDataOffset + partData.material * sizeof(mh), sizeof(mh));
+
+                    name = Widen(mh.Name, MAX_MATERIAL_NAME);
+                    diffuse = Widen(mh.DiffuseTexture, MAX_TEXTURE_NAME);
+                    specular = Widen(mh.SpecularTexture, MAX_TEXTURE_NAME);
+                    normal = Widen(mh.NormalTexture, MAX_TEXTURE_NAME);
+
+                    if (mh.Ambient.x == 0 && mh.Ambient.y == 0 && mh.Ambient.z == 0 && mh.Ambient.w == 0
+                        && mh.Diffuse.x == 0 && mh.Diffuse.y == 0 && mh.Diffuse.z == 0 && mh.Diffuse.w == 0)
+                    {
+                        // An all-zero material is the exporter's default.
+                        info.ambientColor = XMFLOAT3(0.2f, 0.2f, 0.2f);
+                        info.diffuseColor = XMFLOAT3(0.8f, 0.8f, 0.8f);
+                    }
+                    else
+                    {
+                        info.ambientColor = XMFLOAT3(mh.Ambient.x, mh.Ambient.y, mh.Ambient.z);
+                        info.diffuseColor = XMFLOAT3(mh.Diffuse.x, mh.Diffuse.y, mh.Diffuse.z);
+                        info.emissiveColor = XMFLOAT3(mh.Emissive.x, mh.Emissive.y, mh.Emissive.z);
+
+                        if (mh.Diffuse.w != 1.f && mh.Diffuse.w != 0.f)
+                        {
+                            info.alpha = mh.Diffuse.w;
+                        }
+
+                        if (mh.Power > 0)
+                        {
+                            info.specularPower = mh.Power;
+                            info.specularColor = XMFLOAT3(mh.Specular.x, mh.Specular.y, mh.Specular.z);
+                        }
+                    }
+                }
+
+                // Without texture coordinates the textures can't be sampled.
+                if (!flags.texcoords)
+                {
+                    diffuse.clear();
+                    specular.clear();
+                    normal.clear();
+                    emissive.clear();
+                }
+
+                info.name = name.c_str();
+                info.diffuseTexture = diffuse.empty() ? nullptr : diffuse.c_str();
+                info.specularTexture = specular.empty() ? nullptr : specular.c_str();
+                info.normalTexture = normal.empty() ? nullptr : normal.c_str();
+                info.emissiveTexture = emissive.empty() ? nullptr : emissive.c_str();
+
+                cached.effect = fxFactory.CreateEffect(info, nullptr);
+                cached.isAlpha = (info.alpha < 1.f);
+
+                // Bones aren't streamed, so skinned meshes are drawn in their bind pose.
+                auto skinning = dynamic_cast<IEffectSkinning*>(cached.effect.get());
+                if (skinning)
+                {
+                    skinning->ResetBoneTransforms();
+                }
+            }
+
+            auto part = std::make_unique<ModelMeshPart>(static_cast<uint32_t>(mesh->meshParts.size()));
+            part->indexCount = partData.indexCount;
+            part->startIndex = partData.startIndex;
+            part->vertexOffset = partData.vertexOffset;
+            part->vertexStride = vb.stride;
+            part->primitiveType = topology;
+            part->indexFormat = (m_layout->indexBuffers[partData.indexBuffer].indexSize == 4) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+            part->effect = cached.effect;
+            part->vbDecl = decls[partData.vertexBuffer];
+
+            part->isAlpha = cached.isAlpha;
+
+            part->CreateInputLayout(device, cached.effect.get(), part->inputLayout.ReleaseAndGetAddressOf());
+
+            m_resourceParts[partData.vertexBuffer].push_back(part.get());
+            m_resourceParts[ibBase + partData.indexBuffer].push_back(part.get());
+
+            mesh->meshParts.emplace_back(std::move(part));
+        }
+
+        m_model->meshes.emplace_back(std::move(mesh));
+    }
+}
+
+bool StreamingModel::CreateBuffer(ID3D11Device* device, uint32_t resource)
+{
+    const size_t ibBase = m_layout->vertexBuffers.size();
+    const bool isVertexBuffer = resource < ibBase;
+
+    const ModelData::FileRange& range = isVertexBuffer
+        ? m_layout->vertexBuffers[resource].fileRange
+        : m_layout->indexBuffers[resource - ibBase].fileRange;
+
+    if (!range.size || range.size > UINT32_MAX)
+        return false;
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = static_cast<UINT>(range.size);
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = isVertexBuffer ? D3D11_BIND_VERTEX_BUFFER : D3D11_BIND_INDEX_BUFFER;
+
+    // Reading the mapping here is what pages the data in from disk.
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = m_file.GetData() + range.offset;
+
+    ComPtr<ID3D11Buffer> buffer;
+    if (FAILED(device->CreateBuffer(&desc, &initData, buffer.GetAddressOf())))
+        return false;
+
+    for (auto part : m_resourceParts[resource])
+    {
+        if (isVertexBuffer)
+        {
+            part->vertexBuffer = buffer;
+        }
+        else
+        {
+            part->indexBuffer = buffer;
+        }
+    }
+
+    return true;
+}
+
+bool XM_CALLCONV StreamingModel::Update(ID3D11Device* device, FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
+    float viewportHeight, bool rhcoords)
+{
+    auto const& changes = m_residency.Update(world, view, projection, viewportHeight, rhcoords);
+    if (!m_model)
+        return false;
+
+    const size_t ibBase = m_layout->vertexBuffers.size();
+
+    for (auto resource : changes.evict)
+    {
+        for (auto part : m_resourceParts[resource])
+        {
+            if (resource < ibBase)
+            {
+                part->vertexBuffer.Reset();
+            }
+            else
+            {
+                part->indexBuffer.Reset();
+            }
+        }
+    }
+
+    for (auto resource : changes.load)
+    {
+        if (!CreateBuffer(device, resource))
+        {
+            m_residency.SetLoadFailed(resource);
+        }
+    }
+
+    return !changes.evict.empty() || !changes.load.empty();
+}
+
+void XM_CALLCONV StreamingModel::Draw(ID3D11DeviceContext* context, const CommonStates& states,
+    FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection, bool wireframe) const
+{
+    if (!m_model)
+        return;
+
+    // Items are the meshes, in order.
+    for (const bool alpha : { false, true })
+    {
+        for (size_t j = 0; j < m_model->meshes.size(); ++j)
+        {
+            if (!m_residency.IsDrawable(static_cast<uint32_t>(j)))
+                continue;
+
+            auto const& mesh = m_model->meshes[j];
+            mesh->PrepareForRendering(context, states, alpha, wireframe);
+            mesh->Draw(context, world, view, projection, alpha);
+        }
+    }
+}
+
+void StreamingModel::UpdateEffects(const std::function<void(IEffect*)>& setEffect)
+{
+    for (auto& it : m_effects)
+    {
+        setEffect(it.second.effect.get());
+    }
+}
+
+void StreamingModel::CreateInputLayouts(ID3D11Device* device)
+{
+    if (!m_model)
+        return;
+
+    for (auto& mesh : m_model->meshes)
+    {
+        for (auto& part : mesh->meshParts)
+        {
+            part->CreateInputLayout(device, part->effect.get(), part->inputLayout.ReleaseAndGetAddressOf());
+        }
+    }
+}
+
+void StreamingModel::SetCounterClockwise(bool ccw) noexcept
+{
+    if (!m_model)
+        return;
+
+    for (auto& mesh : m_model->meshes)
+    {
+        mesh->ccw = ccw;
+    }
+}
@@ -0,0 +1,92 @@
+//--------------------------------------------------------------------------------------
+// File: StreamingModel.h
+//
+// A .sdkmesh drawn without loading all of it: the file is memory-mapped, only its headers
+// are read up front, and the vertex and index buffers are created and released as the
+// camera moves, under a fixed budget chosen by ResidencyManager. Meshes whose buffers are
+// not yet resident are skipped, so the model fills in over a few frames.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "MappedFile.h"
+#include "ModelData.h"
+#include "ResidencyManager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace DX
+{
+    class StreamingModel
+    {
+    public:
+        // Maps the file and reads its layout. Throws std::system_error if the file can't be
+        // mapped, or std::runtime_error if it isn't a valid SDKMESH.
+        StreamingModel(_In_z_ const wchar_t* fileName, bool lhcoords, const ResidencyManager::Settings& settings);
+
+        StreamingModel(StreamingModel&&) = default;
+        StreamingModel& operator= (StreamingModel&&) = default;
+
+        StreamingModel(StreamingModel const&) = delete;
+        StreamingModel& operator= (StreamingModel const&) = delete;
+
+        // Creates the meshes, effects, and input layouts, but no buffers. Skinned meshes
+        // are drawn rigid.
+        void CreateDeviceResources(_In_ ID3D11Device* device, DirectX::IEffectFactory& fxFactory);
+
+        // Ranks the meshes for this camera, then releases and creates buffers as decided by
+        // the residency manager. Returns true if any buffer was created or released.
+        bool XM_CALLCONV Update(_In_ ID3D11Device* device, DirectX::FXMMATRIX world, DirectX::CXMMATRIX view,
+            DirectX::CXMMATRIX projection, float viewportHeight, bool rhcoords);
+
+        // Draws the meshes that were visible with every buffer resident in the last Update:
+        // opaque parts first, then alpha parts.
+        void XM_CALLCONV Draw(_In_ ID3D11DeviceContext* context, const DirectX::CommonStates& states,
+            DirectX::FXMMATRIX world, DirectX::CXMMATRIX view, DirectX::CXMMATRIX projection, bool wireframe) const;
+
+        // Visits each distinct effect once.
+        void UpdateEffects(const std::function<void(DirectX::IEffect*)>& setEffect);
+
+        // Needed after changing an effect in a way that changes its shader.
+        void CreateInputLayouts(_In_ ID3D11Device* device);
+
+        void SetCounterClockwise(bool ccw) noexcept;
+
+        void GetBounds(DirectX::BoundingSphere& sphere, DirectX::BoundingBox& box) const noexcept { m_layout->GetBounds(sphere, box); }
+
+        // Visible meshes are still waiting for buffers.
+        bool IsLoading() const noexcept { return m_residency.IsLoading(); }
+
+        uint32_t GetVersion() const noexcept { return m_layout->version; }
+        const MappedFile& GetFile() const noexcept { return m_file; }
+        const ModelData& GetLayout() const noexcept { return *m_layout; }
+        const DirectX::Model* GetModel() const noexcept { return m_model.get(); }
+        const ResidencyManager& GetResidency() const noexcept { return m_residency; }
+
+    private:
+        struct CachedEffect
+        {
+            std::shared_ptr<DirectX::IEffect>               effect;
+            bool                                            isAlpha;
+        };
+
+        bool CreateBuffer(_In_ ID3D11Device* device, uint32_t resource);
+
+        MappedFile                                          m_file;
+        std::unique_ptr<ModelData>                          m_layout;
+        ResidencyManager                                    m_residency;
+        std::unique_ptr<DirectX::Model>                     m_model;
+        std::vector<std::vector<DirectX::ModelMeshPart*>>   m_resourceParts;    // Parts using each vertex, then index, buffer
+        std::map<std::pair<uint32_t, uint32_t>, CachedEffect>  m_effects;    // By material and vertex buffer
+    };
+}
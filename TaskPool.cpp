@@ -0,0 +1,231 @@
+//--------------------------------------------------------------------------------------
+// File: TaskPool.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace DX;
+
+namespace
+{
+    constexpr uint64_t Pack(uint32_t begin, uint32_t end) noexcept
+    {
+        return uint64_t(begin) | (uint64_t(end) << 32);
+    }
+
+    constexpr uint32_t Begin(uint64_t range) noexcept { return static_cast<uint32_t>(range); }
+    constexpr uint32_t End(uint64_t range) noexcept { return static_cast<uint32_t>(range >> 32); }
+}
+
+TaskPool::TaskPool(size_t threadCount) :
+    m_generation(0),
+    m_running(0),
+    m_exit(false),
+    m_invoke(nullptr),
+    m_context(nullptr),
+    m_count(0),
+    m_grainSize(1),
+    m_failed(false)
+{
+    if (!threadCount)
+    {
+        threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    m_ranges.reset(new Range[threadCount]);
+    for (size_t j = 0; j < threadCount; ++j)
+    {
+        m_ranges[j].value = 0;
+    }
+
+    m_threads.reserve(threadCount - 1);
+    for (size_t j = 1; j < threadCount; ++j)
+    {
+        m_threads.emplace_back(&TaskPool::WorkerThread, this, j);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void TaskPool::Run(size_t count, size_t grainSize, Invoker invoke, void* context)
+{
+    const size_t units = (count + grainSize - 1) / grainSize;
+    if (units > UINT32_MAX)
+        throw std::out_of_range("TaskPool::ParallelFor");
+
+    const size_t workers = GetThreadCount();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_invoke = invoke;
+        m_context = context;
+        m_count = count;
+        m_grainSize = grainSize;
+        m_exception = nullptr;
+        m_failed = false;
+
+        // Start with an even split; stealing evens out the rest.
+        for (size_t j = 0; j < workers; ++j)
+        {
+            const auto begin = static_cast<uint32_t>(units * j / workers);
+            const auto end = static_cast<uint32_t>(units * (j + 1) / workers);
+            m_ranges[j].value.store(Pack(begin, end), std::memory_order_relaxed);
+        }
+
+        m_running = workers;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    Execute(0);
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this] { return m_running == 0; });
+
+        exception = m_exception;
+        m_exception = nullptr;
+        m_invoke = nullptr;
+        m_context = nullptr;
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void TaskPool::WorkerThread(size_t worker)
+{
+    uint64_t generation = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_exit || m_generation != generation; });
+
+            if (m_exit)
+                return;
+
+            generation = m_generation;
+        }
+
+        Execute(worker);
+    }
+}
+
+void TaskPool::Execute(size_t worker) noexcept
+{
+    for (;;)
+    {
+        uint32_t unit;
+        while (TakeUnit(worker, unit))
+        {
+            if (m_failed.load(std::memory_order_relaxed))
+                continue;
+
+            const size_t begin = size_t(unit) * m_grainSize;
+            const size_t end = std::min(begin + m_grainSize, m_count);
+
+            try
+            {
+                m_invoke(m_context, begin, end, worker);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_exception)
+                {
+                    m_exception = std::current_exception();
+                }
+                m_failed = true;
+            }
+        }
+
+        if (!Steal(worker))
+            break;
+    }
+
+    bool last = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        last = (--m_running == 0);
+    }
+
+    if (last)
+    {
+        m_finished.notify_all();
+    }
+}
+
+// Takes the next unit from the front of this worker's own range.
+bool TaskPool::TakeUnit(size_t worker, uint32_t& unit) noexcept
+{
+    auto& range = m_ranges[worker].value;
+
+    uint64_t current = range.load(std::memory_order_acquire);
+    for (;;)
+    {
+        const uint32_t begin = Begin(current);
+        const uint32_t end = End(current);
+        if (begin >= end)
+            return false;
+
+        if (range.compare_exchange_weak(current, Pack(begin + 1, end), std::memory_order_acq_rel))
+        {
+            unit = begin;
+            return true;
+        }
+    }
+}
+
+// Moves the back half of another worker's remaining range into this worker's range.
+bool TaskPool::Steal(size_t worker) noexcept
+{
+    const size_t workers = GetThreadCount();
+
+    for (size_t j = 1; j < workers; ++j)
+    {
+        auto& victim = m_ranges[(worker + j) % workers].value;
+
+        uint64_t current = victim.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const uint32_t begin = Begin(current);
+            const uint32_t end = End(current);
+            if (begin >= end)
+                break;
+
+            const uint32_t middle = begin + (end - begin) / 2;
+            if (victim.compare_exchange_weak(current, Pack(begin, middle), std::memory_order_acq_rel))
+            {
+                m_ranges[worker].value.store(Pack(middle, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------------------
+// File: TaskPool.h
+//
+// Fixed set of worker threads for data-parallel loops. Each ParallelFor splits its range
+// evenly across the workers, and a worker that runs out of work steals half of the
+// remaining range from another, so uneven per-item cost still balances.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace DX
+{
+    class TaskPool
+    {
+    public:
+        // 'threadCount' includes the calling thread; 0 uses one per hardware thread.
+        explicit TaskPool(size_t threadCount = 0);
+        ~TaskPool();
+
+        TaskPool(TaskPool&&) = delete;
+        TaskPool& operator= (TaskPool&&) = delete;
+
+        TaskPool(TaskPool const&) = delete;
+        TaskPool& operator= (TaskPool const&) = delete;
+
+        size_t GetThreadCount() const noexcept { return m_threads.size() + 1; }
+
+        // Calls fn(begin, end, worker) for consecutive sub-ranges of [0, count) of at most
+        // 'grainSize' items; 'worker' is in [0, GetThreadCount()) and is 0 on the calling
+        // thread. Returns once every item is done. An exception thrown by fn is rethrown
+        // here after the other workers finish. Calls must not be nested.
+        template<typename F>
+        void ParallelFor(size_t count, size_t grainSize, F&& fn)
+        {
+            if (!count)
+                return;
+
+            if (!grainSize)
+                grainSize = 1;
+
+            if (m_threads.empty() || count <= grainSize)
+            {
+                fn(size_t(0), count, size_t(0));
+                return;
+            }
+
+            Run(count, grainSize, [](void* context, size_t begin, size_t end, size_t worker)
+                {
+                    (*static_cast<typename std::remove_reference<F>::type*>(context))(begin, end, worker);
+                }, &fn);
+        }
+
+    private:
+        using Invoker = void(*)(void* context, size_t begin, size_t end, size_t worker);
+
+        // Remaining units of work for one worker, packed as begin (low) and end (high).
+        struct Range
+        {
+            std::atomic<uint64_t>   value;
+            uint8_t                 padding[64 - sizeof(std::atomic<uint64_t>)];
+        };
+
+        void Run(size_t count, size_t grainSize, Invoker invoke, void* context);
+        void WorkerThread(size_t worker);
+        void Execute(size_t worker) noexcept;
+        bool TakeUnit(size_t worker, uint32_t& unit) noexcept;
+        bool Steal(size_t worker) noexcept;
+
+        std::vector<std::thread>    m_threads;
+        std::unique_ptr<Range[]>    m_ranges;
+
+        std::mutex                  m_mutex;
+        std::condition_variable     m_wake;
+        std::condition_variable     m_finished;
+        uint64_t                    m_generation;
+        size_t                      m_running;
+        bool                        m_exit;
+
+        // The current ParallelFor
+        Invoker                     m_invoke;
+        void*                       m_context;
+        size_t                      m_count;
+        size_t                      m_grainSize;
+        std::exception_ptr          m_exception;
+        std::atomic<bool>           m_failed;
+    };
+}
@@ -0,0 +1,343 @@
+//--------------------------------------------------------------------------------------
+// File: AutoExposureTests.cpp
+//
+// Tests for the luminance histogram and the exposure AutoExposure derives from it.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "../AutoExposure.h"
+#include "../TaskPool.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace DX;
+
+namespace
+{
+    // One bin per stop from 2^-10, so a luminance of 1.5 * 2^k lands in bin k + 11.
+    AutoExposure::Settings StopBins()
+    {
+        AutoExposure::Settings settings;
+        settings.minLogLuminance = -10.f;
+        settings.maxLogLuminance = float(LuminanceHistogram::BinCount - 1) - 10.f;
+        return settings;
+    }
+
+    XMHALF4 Half(float r, float g, float b)
+    {
+        XMHALF4 pixel;
+        XMStoreHalf4(&pixel, XMVectorSet(r, g, b, 1.f));
+        return pixel;
+    }
+
+    XMHALF4 HalfBits(HALF bits)
+    {
+        XMHALF4 pixel = { bits, bits, bits, XMConvertFloatToHalf(1.f) };
+        return pixel;
+    }
+
+    uint64_t SumBins(const LuminanceHistogram& histogram)
+    {
+        uint64_t total = 0;
+        for (auto bin : histogram.bins)
+        {
+            total += bin;
+        }
+        return total;
+    }
+
+    bool SameBins(const LuminanceHistogram& a, const LuminanceHistogram& b)
+    {
+        return a.pixelCount == b.pixelCount && memcmp(a.bins, b.bins, sizeof(a.bins)) == 0;
+    }
+
+    // A histogram of one bin per stop from 2^0, with the given pixel count in each bin.
+    LuminanceHistogram MakeHistogram(std::initializer_list<std::pair<size_t, uint32_t>> bins)
+    {
+        LuminanceHistogram histogram = {};
+        histogram.minLogLuminance = 0.f;
+        histogram.maxLogLuminance = float(LuminanceHistogram::BinCount - 1);
+        for (auto const& bin : bins)
+        {
+            histogram.bins[bin.first] = bin.second;
+            histogram.pixelCount += bin.second;
+        }
+        return histogram;
+    }
+
+    // Colors exactly representable in both R16G16B16A16_FLOAT and R11G11B10_FLOAT, over
+    // about 20 stops; 'seed' picks one.
+    XMVECTOR XM_CALLCONV TestColor(uint32_t seed) noexcept
+    {
+        const float channels[] = { 0.f, 0.0009765625f, 0.015625f, 0.25f, 0.375f, 0.5f, 1.f, 1.5f, 3.f, 12.f, 96.f, 1024.f };
+        constexpr uint32_t count = sizeof(channels) / sizeof(channels[0]);
+        return XMVectorSet(channels[seed % count], channels[(seed / count) % count], channels[(seed / 7) % count], 1.f);
+    }
+}
+
+TEST_CASE(AutoExposure_BinPlacement)
+{
+    AutoExposure exposure;
+    exposure.SetSettings(StopBins());
+
+    // Seven pixels a row, so each row ends with a partial group of four.
+    const std::vector<XMHALF4> pixels =
+    {
+        Half(1.5f, 1.5f, 1.5f),                 // 2^0.58: bin 11
+        Half(0.0029296875f, 0.0029296875f, 0.0029296875f),  // 1.5 * 2^-9: bin 2
+        Half(1.f, 0.f, 0.f),                    // Red alone is 0.2126, 2^-2.23: bin 8
+        Half(0.f, 0.f, 1.f),                    // Blue alone is 0.0722, 2^-3.79: bin 7
+        Half(24576.f, 24576.f, 24576.f),        // 1.5 * 2^14: bin 25
+        Half(0.f, 0.f, 0.f),                    // Black: bin 0
+        Half(0.0004882813f, 0.f, 0.f),          // Below 2^-10: bin 0
+
+        Half(-1.f, -1.f, -1.f),                 // Negative: bin 0
+        Half(-4.f, 8.f, 8.f),                   // Negative red, still bright: 5.45, 2^2.45: bin 13
+        HalfBits(0x7E00),                       // NaN: bin 0
+        HalfBits(0x7C00),                       // Infinity: clamped to the top bin
+        HalfBits(0xFC00),                       // Negative infinity: bin 0
+        Half(1.5f, 1.5f, 1.5f),
+        Half(1.5f, 1.5f, 1.5f),
+    };
+
+    LuminanceHistogram histogram;
+    exposure.BuildHistogram(pixels.data(), 7, 7, 2, histogram);
+
+    const uint32_t expected[][2] =
+    {
+        { 0, 5 }, { 2, 1 }, { 7, 1 }, { 8, 1 }, { 11, 3 }, { 13, 1 }, { 25, 1 }, { LuminanceHistogram::BinCount - 1, 1 },
+    };
+
+    CHECK(histogram.pixelCount == 14);
+    CHECK(SumBins(histogram) == 14);
+    CHECK(histogram.minLogLuminance == -10.f);
+
+    uint32_t listed = 0;
+    for (auto const& bin : expected)
+    {
+        listed += bin[1];
+        if (!CHECK(histogram.bins[bin[0]] == bin[1]))
+        {
+            printf("    bin %u: %u pixels, expected %u\n", bin[0], histogram.bins[bin[0]], bin[1]);
+        }
+    }
+    CHECK(listed == 14);
+
+    // Nothing but what is below the range leaves the exposure unchanged.
+    exposure.Reset(1.5f);
+    const std::vector<XMHALF4> dark = { Half(0.f, 0.f, 0.f), Half(-2.f, -2.f, -2.f), HalfBits(0x7E00) };
+    exposure.BuildHistogram(dark.data(), 3, 3, 1, histogram);
+    CHECK(histogram.bins[0] == 3);
+    CHECK(exposure.ComputeTargetExposure(histogram) == 1.5f);
+}
+
+TEST_CASE(AutoExposure_WorkerBinsMatchSingleThread)
+{
+    constexpr size_t width = 97;
+    constexpr size_t height = 301;
+    constexpr size_t pitch = 103;
+
+    // The padding past each row's width is bright, so binning it would show.
+    std::vector<XMHALF4> pixels(pitch * height, Half(1000.f, 1000.f, 1000.f));
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            XMStoreHalf4(&pixels[y * pitch + x], TestColor(uint32_t(y * width + x)));
+        }
+    }
+
+    AutoExposure exposure;
+    LuminanceHistogram reference;
+    exposure.BuildHistogram(pixels.data(), pitch, width, height, reference);
+    CHECK(reference.pixelCount == width * height);
+    CHECK(SumBins(reference) == width * height);
+
+    for (size_t threads : { 1u, 2u, 4u, 7u })
+    {
+        TaskPool pool(threads);
+        LuminanceHistogram histogram;
+        exposure.BuildHistogram(pixels.data(), pitch, width, height, histogram, &pool);
+        if (!CHECK(SameBins(histogram, reference)))
+        {
+            printf("    %zu threads\n", threads);
+        }
+    }
+
+    // A tall image of single pixels splits into many small ranges per worker.
+    TaskPool pool(4);
+    LuminanceHistogram column, columnReference;
+    exposure.BuildHistogram(pixels.data(), pitch, 1, height, columnReference);
+    exposure.BuildHistogram(pixels.data(), pitch, 1, height, column, &pool);
+    CHECK(SameBins(column, columnReference));
+    CHECK(SumBins(column) == height);
+}
+
+TEST_CASE(AutoExposure_PercentileWindow)
+{
+    AutoExposure::Settings settings;
+    settings.keyValue = 1.f;            // So the exposure is minus the average log luminance
+    settings.minExposure = -100.f;
+    settings.maxExposure = 100.f;
+
+    AutoExposure exposure;
+    exposure.SetSettings(settings);
+
+    // Bin j covers stops [j - 1, j), so its center is j - 0.5. Half the pixels are dark,
+    // 45% are in the middle, and the brightest 5% are highlights.
+    const LuminanceHistogram histogram = MakeHistogram({ { 0, 1000 }, { 1, 50 }, { 11, 45 }, { 21, 5 } });
+
+    // The defaults, 0.5 to 0.95, leave out both the dark half and the highlights; bin 0
+    // isn't counted at all.
+    CHECK_NEAR(exposure.ComputeTargetExposure(histogram), -10.5f, 1e-4f);
+
+    // A window across two bins takes the part of each inside it: 25 pixels at 0.5 and
+    // 25 at 10.5.
+    settings.lowPercentile = 0.25f;
+    settings.highPercentile = 0.75f;
+    exposure.SetSettings(settings);
+    CHECK_NEAR(exposure.ComputeTargetExposure(histogram), -5.5f, 1e-4f);
+
+    // The order of the two doesn't matter.
+    settings.lowPercentile = 0.75f;
+    settings.highPercentile = 0.25f;
+    exposure.SetSettings(settings);
+    CHECK_NEAR(exposure.ComputeTargetExposure(histogram), -5.5f, 1e-4f);
+
+    // Everything: (50 * 0.5 + 45 * 10.5 + 5 * 20.5) / 100.
+    settings.lowPercentile = 0.f;
+    settings.highPercentile = 1.f;
+    exposure.SetSettings(settings);
+    CHECK_NEAR(exposure.ComputeTargetExposure(histogram), -6.0f, 1e-4f);
+
+    // Only the highlights.
+    settings.lowPercentile = 0.95f;
+    exposure.SetSettings(settings);
+    CHECK_NEAR(exposure.ComputeTargetExposure(histogram), -20.5f, 1e-4f);
+
+    // The key value shifts the result, and the limits clamp it.
+    settings.keyValue = 4.f;
+    exposure.SetSettings(settings);
+    CHECK_NEAR(exposure.ComputeTargetExposure(histogram), -18.5f, 1e-4f);
+
+    settings.minExposure = -10.f;
+    exposure.SetSettings(settings);
+    CHECK(exposure.ComputeTargetExposure(histogram) == -10.f);
+}
+
+TEST_CASE(AutoExposure_AdaptationSpeed)
+{
+    AutoExposure::Settings settings;
+    settings.keyValue = 1.f;
+    settings.speedUp = 3.f;
+    settings.speedDown = 1.f;
+    settings.minExposure = -100.f;
+    settings.maxExposure = 100.f;
+
+    AutoExposure exposure;
+    exposure.SetSettings(settings);
+
+    // Every pixel in bin 1, centered on 2^-2 in one scene and 2^2 in the other, for
+    // targets of +2 and -2 stops.
+    LuminanceHistogram darkScene = MakeHistogram({ { 1, 100 } });
+    darkScene.minLogLuminance = -2.5f;
+    darkScene.maxLogLuminance = darkScene.minLogLuminance + float(LuminanceHistogram::BinCount - 1);
+    LuminanceHistogram brightScene = darkScene;
+    brightScene.minLogLuminance = 1.5f;
+    brightScene.maxLogLuminance = brightScene.minLogLuminance + float(LuminanceHistogram::BinCount - 1);
+
+    REQUIRE(std::abs(exposure.ComputeTargetExposure(darkScene) - 2.f) < 1e-4f);
+    REQUIRE(std::abs(exposure.ComputeTargetExposure(brightScene) + 2.f) < 1e-4f);
+
+    // Brightening covers 1 - e^(-speedUp * dt) of the way.
+    for (float dt : { 1.f / 120.f, 1.f / 60.f, 1.f / 30.f, 0.25f })
+    {
+        exposure.Reset(0.f);
+        CHECK_NEAR(exposure.Update(darkScene, dt), 2.f * (1.f - std::exp(-3.f * dt)), 1e-4f);
+        CHECK(!exposure.IsConverged());
+
+        exposure.Reset(0.f);
+        CHECK_NEAR(exposure.Update(brightScene, dt), -2.f * (1.f - std::exp(-1.f * dt)), 1e-4f);
+    }
+
+    // The same time in more, shorter frames ends at the same exposure.
+    exposure.Reset(0.f);
+    std::ignore = exposure.Update(darkScene, 0.1f);
+    const float oneFrame = exposure.GetExposure();
+
+    exposure.Reset(0.f);
+    for (int j = 0; j < 10; ++j)
+    {
+        std::ignore = exposure.Update(darkScene, 0.01f);
+    }
+    CHECK_NEAR(exposure.GetExposure(), oneFrame, 1e-4f);
+
+    // No time, or time going backward, doesn't move it.
+    exposure.Reset(0.5f);
+    CHECK(exposure.Update(darkScene, 0.f) == 0.5f);
+    CHECK(exposure.Update(darkScene, -1.f) == 0.5f);
+
+    // Close enough snaps to the target and converges.
+    exposure.Reset(1.995f);
+    CHECK_NEAR(exposure.Update(darkScene, 1.f / 60.f), 2.f, 1e-4f);
+    CHECK(exposure.IsConverged());
+
+    // A long frame gets most of the way.
+    exposure.Reset(0.f);
+    CHECK(exposure.Update(darkScene, 10.f) > 1.99f);
+}
+
+TEST_CASE(AutoExposure_PackedFloatMatchesHalf)
+{
+    constexpr size_t width = 61;
+    constexpr size_t height = 45;
+
+    std::vector<XMHALF4> half(width * height);
+    std::vector<XMFLOAT3PK> packed(width * height);
+    for (size_t j = 0; j < half.size(); ++j)
+    {
+        const XMVECTOR color = TestColor(uint32_t(j * 5));
+        XMStoreHalf4(&half[j], color);
+        XMStoreFloat3PK(&packed[j], color);
+    }
+
+    // Check that the colors survived both formats unchanged, so the histograms can match.
+    size_t differ = 0;
+    for (size_t j = 0; j < half.size(); ++j)
+    {
+        XMFLOAT3 a, b;
+        XMStoreFloat3(&a, XMLoadHalf4(&half[j]));
+        XMStoreFloat3(&b, XMLoadFloat3PK(&packed[j]));
+        if (a.x != b.x || a.y != b.y || a.z != b.z)
+            ++differ;
+    }
+    REQUIRE(differ == 0);
+
+    AutoExposure exposure;
+    exposure.SetSettings(StopBins());
+
+    LuminanceHistogram fromHalf, fromPacked;
+    exposure.BuildHistogram(half.data(), width, width, height, fromHalf);
+    exposure.BuildHistogram(packed.data(), width, width, height, fromPacked);
+    CHECK(SameBins(fromHalf, fromPacked));
+    CHECK(SumBins(fromPacked) == width * height);
+
+    TaskPool pool(3);
+    exposure.BuildHistogram(packed.data(), width, width, height, fromPacked, &pool);
+    CHECK(SameBins(fromHalf, fromPacked));
+    CHECK(exposure.ComputeTargetExposure(fromHalf) == exposure.ComputeTargetExposure(fromPacked));
+}
@@ -0,0 +1,145 @@
+//--------------------------------------------------------------------------------------
+// File: DirtyTrackerTests.cpp
+//
+// Tests for DirtyTracker.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#include "../DirtyTracker.h"
+
+using namespace DX;
+
+namespace
+{
+    struct View
+    {
+        float   position[3];
+        float   fov;
+    };
+}
+
+TEST_CASE(DirtyTracker_FirstTrackAndUnchanged)
+{
+    DirtyTracker tracker;
+
+    // A new tracker reports everything dirty until drawn.
+    CHECK(tracker.GetDirty() == DirtyTracker::All);
+
+    const View view = { { 0.f, 1.f, 2.f }, 0.785f };
+    CHECK(tracker.Track(0, view, 42, true));
+    tracker.Clear();
+    CHECK(!tracker.IsDirty());
+
+    // The same values again change nothing.
+    CHECK(!tracker.Track(0, view, 42, true));
+    CHECK(!tracker.IsDirty());
+
+    // Any one of them changing marks the slot.
+    CHECK(tracker.Track(0, view, 42, false));
+    CHECK(tracker.GetDirty() == 1u);
+    tracker.Clear();
+
+    View moved = view;
+    moved.position[1] = 1.5f;
+    CHECK(tracker.Track(0, moved, 42, false));
+    CHECK(tracker.IsDirty());
+}
+
+TEST_CASE(DirtyTracker_SlotMasks)
+{
+    DirtyTracker tracker;
+    for (size_t slot = 0; slot < DirtyTracker::MaxSlots; ++slot)
+    {
+        tracker.Track(slot, uint32_t(slot));
+    }
+    tracker.Clear();
+
+    CHECK(tracker.Track(0, 100u));
+    CHECK(tracker.Track(3, 100u));
+    CHECK(!tracker.Track(5, 5u));
+    CHECK(tracker.Track(31, 100u));
+
+    CHECK(tracker.GetDirty() == ((1u << 0) | (1u << 3) | (1u << 31)));
+    CHECK(tracker.IsDirty(1u << 0));
+    CHECK(tracker.IsDirty((1u << 1) | (1u << 3)));
+    CHECK(!tracker.IsDirty((1u << 1) | (1u << 5)));
+
+    // Clearing some slots leaves the others dirty.
+    tracker.Clear(1u << 0);
+    CHECK(!tracker.IsDirty(1u << 0));
+    CHECK(tracker.IsDirty(1u << 3));
+    CHECK(tracker.GetDirty() == ((1u << 3) | (1u << 31)));
+
+    tracker.Clear((1u << 3) | (1u << 31));
+    CHECK(tracker.GetDirty() == 0);
+}
+
+TEST_CASE(DirtyTracker_InvalidateKeepsValues)
+{
+    DirtyTracker tracker;
+    tracker.Track(2, 7.f);
+    tracker.Clear();
+
+    tracker.Invalidate(1u << 2);
+    CHECK(tracker.GetDirty() == (1u << 2));
+    tracker.Clear();
+
+    // The recorded value survived, so tracking it again is still clean.
+    CHECK(!tracker.Track(2, 7.f));
+    CHECK(!tracker.IsDirty());
+
+    tracker.Invalidate();
+    CHECK(tracker.GetDirty() == DirtyTracker::All);
+}
+
+TEST_CASE(DirtyTracker_Reset)
+{
+    DirtyTracker tracker;
+    tracker.Track(1, 3);
+    tracker.Track(4, 5);
+    tracker.Clear();
+
+    tracker.Reset();
+    CHECK(tracker.GetDirty() == DirtyTracker::All);
+    tracker.Clear();
+
+    // Recorded values are forgotten, so the same values count as new.
+    CHECK(tracker.Track(1, 3));
+    CHECK(tracker.Track(4, 5));
+    CHECK(tracker.GetDirty() == ((1u << 1) | (1u << 4)));
+}
+
+TEST_CASE(DirtyTracker_SizeAndEmptyData)
+{
+    DirtyTracker tracker;
+
+    // A slot's data changing size is a change, even with the same leading bytes.
+    const uint8_t bytes[4] = { 1, 2, 3, 4 };
+    CHECK(tracker.TrackBytes(6, bytes, 4));
+    tracker.Clear();
+    CHECK(tracker.TrackBytes(6, bytes, 2));
+    tracker.Clear();
+    CHECK(!tracker.TrackBytes(6, bytes, 2));
+
+    // Empty data is recorded once like any other.
+    CHECK(tracker.TrackBytes(7, nullptr, 0));
+    tracker.Clear();
+    CHECK(!tracker.TrackBytes(7, nullptr, 0));
+}
+
+TEST_CASE(DirtyTracker_OutOfRangeSlots)
+{
+    DirtyTracker tracker;
+    tracker.Clear();
+
+    CHECK(!tracker.Track(DirtyTracker::MaxSlots, 1));
+    CHECK(!tracker.Track(1000, 1.f, 2.f));
+
+    const uint8_t bytes[2] = { 1, 2 };
+    CHECK(!tracker.TrackBytes(32, bytes, sizeof(bytes)));
+    CHECK(tracker.GetDirty() == 0);
+}
@@ -0,0 +1,169 @@
+//--------------------------------------------------------------------------------------
+// File: FramePacerTests.cpp
+//
+// Tests for BasicFramePacer scheduling, simulated with a ManualClock.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#include "../FramePacer.h"
+
+using namespace DX;
+
+namespace
+{
+    using ManualFramePacer = BasicFramePacer<ManualClock>;
+
+    constexpr uint64_t c_Frequency = 10000000;
+    constexpr uint64_t c_Period = c_Frequency / 60;
+    constexpr uint64_t c_Margin = c_Frequency / 1000;
+
+    uint64_t Milliseconds(double ms) { return static_cast<uint64_t>(ms * double(c_Frequency) / 1000.0); }
+
+    // Waits as the pacer asks, then runs a frame taking 'work' ticks; returns the wait.
+    uint64_t RunFrame(ManualFramePacer& pacer, uint64_t work, bool rendered = true)
+    {
+        const uint64_t wait = pacer.GetWaitTicks();
+        pacer.GetClock().Advance(wait);
+        pacer.BeginFrame();
+        pacer.GetClock().Advance(work);
+        pacer.EndFrame(rendered);
+        return wait;
+    }
+}
+
+TEST_CASE(FramePacer_CappedDeadlines)
+{
+    ManualFramePacer pacer{ ManualClock(c_Frequency) };
+    pacer.SetMode(FramePacing::Capped);
+    CHECK(pacer.GetSyncInterval() == 0);
+    CHECK_NEAR(pacer.GetTargetFramesPerSecond(), 60.0, 1e-3);
+
+    // No deadline before the first frame.
+    CHECK(pacer.GetWaitTicks() == 0);
+
+    // Each frame starts exactly one period after the last, whatever its work took.
+    const uint64_t start = pacer.GetClock().GetTicks();
+    for (uint64_t frame = 0; frame < 100; ++frame)
+    {
+        const uint64_t work = Milliseconds(2.0 + double(frame % 7));
+        RunFrame(pacer, work);
+        REQUIRE(pacer.GetClock().GetTicks() - work == start + frame * c_Period);
+    }
+
+    // A frame that runs long, but by less than a period, is followed without waiting,
+    // and the one after that is back on the original schedule.
+    RunFrame(pacer, c_Period + c_Period / 2);
+    CHECK(pacer.GetWaitTicks() == 0);
+    RunFrame(pacer, 0);
+    CHECK(pacer.GetClock().GetTicks() + pacer.GetWaitTicks() == start + 102 * c_Period);
+
+    // Switching modes drops the schedule.
+    pacer.SetMode(FramePacing::LowLatency);
+    CHECK(pacer.GetWaitTicks() == 0);
+}
+
+TEST_CASE(FramePacer_ResyncAfterFallingBehind)
+{
+    ManualFramePacer pacer{ ManualClock(c_Frequency) };
+    pacer.SetMode(FramePacing::Capped);
+
+    RunFrame(pacer, Milliseconds(1.0));
+    RunFrame(pacer, Milliseconds(1.0));
+
+    // A stall of several periods: rather than bursting frames to catch up, the schedule
+    // restarts one period after the late frame begins.
+    pacer.GetClock().Advance(c_Period * 4);
+    CHECK(pacer.GetWaitTicks() == 0);
+
+    pacer.BeginFrame();
+    const uint64_t begin = pacer.GetClock().GetTicks();
+    pacer.GetClock().Advance(Milliseconds(1.0));
+    pacer.EndFrame(true);
+
+    CHECK(pacer.GetClock().GetTicks() + pacer.GetWaitTicks() == begin + c_Period);
+}
+
+TEST_CASE(FramePacer_LowLatencyPrediction)
+{
+    ManualFramePacer pacer{ ManualClock(c_Frequency) };
+    pacer.SetMode(FramePacing::LowLatency);
+    CHECK(pacer.GetSyncInterval() == 1);
+
+    // Deadlines are a period apart from the first frame's start. With steady work the
+    // prediction is the work itself, and each frame starts that, plus the margin, before
+    // its deadline.
+    const uint64_t start = pacer.GetClock().GetTicks();
+    const uint64_t work = Milliseconds(4.0);
+    RunFrame(pacer, work);
+    CHECK(pacer.GetPredictedWorkTicks() == work);
+
+    uint64_t frame = 1;
+    for (; frame <= 10; ++frame)
+    {
+        RunFrame(pacer, work);
+        CHECK(pacer.GetClock().GetTicks() - work == start + frame * c_Period - work - c_Margin);
+    }
+
+    // Uneven work keeps a reserve of two deviations above the mean.
+    for (int j = 0; j < 200; ++j, ++frame)
+    {
+        RunFrame(pacer, Milliseconds((j & 1) ? 5.0 : 3.0));
+    }
+    const uint64_t predicted = pacer.GetPredictedWorkTicks();
+    CHECK(predicted > Milliseconds(5.0));
+    CHECK(predicted < Milliseconds(7.0));
+    CHECK(pacer.GetClock().GetTicks() + pacer.GetWaitTicks() == start + frame * c_Period - predicted - c_Margin);
+
+    // Frames that weren't rendered don't change the prediction.
+    const uint64_t before = pacer.GetPredictedWorkTicks();
+    RunFrame(pacer, Milliseconds(12.0), false);
+    CHECK(pacer.GetPredictedWorkTicks() == before);
+
+    // Work longer than a period leaves nothing to wait for.
+    for (int j = 0; j < 50; ++j)
+    {
+        RunFrame(pacer, c_Period * 2);
+    }
+    CHECK(pacer.GetWaitTicks() == 0);
+}
+
+TEST_CASE(FramePacer_OnDemand)
+{
+    ManualFramePacer pacer{ ManualClock(c_Frequency) };
+    pacer.SetMode(FramePacing::OnDemand);
+    CHECK(pacer.GetSyncInterval() == 1);
+
+    // The first frame always renders.
+    CHECK(pacer.ShouldRender(false));
+    RunFrame(pacer, Milliseconds(2.0));
+
+    // After that, only when something changed.
+    CHECK(!pacer.ShouldRender(false));
+    CHECK(pacer.ShouldRender(true));
+    CHECK(pacer.GetWaitTicks() == 0);
+
+    // Skipped frames don't count as renders.
+    pacer.GetClock().Advance(c_Frequency * 10);
+    RunFrame(pacer, 0, false);
+    CHECK(!pacer.ShouldRender(false));
+
+    // With an idle refresh, an unchanged scene is still drawn that often.
+    pacer.SetIdleRefresh(0.5);
+    CHECK(pacer.ShouldRender(false));
+    RunFrame(pacer, 0);
+    CHECK(!pacer.ShouldRender(false));
+
+    pacer.GetClock().Advance(c_Frequency / 2 - 1);
+    CHECK(!pacer.ShouldRender(false));
+    pacer.GetClock().Advance(1);
+    CHECK(pacer.ShouldRender(false));
+
+    // Other modes render every frame.
+    pacer.SetMode(FramePacing::VSync);
+    CHECK(pacer.ShouldRender(false));
+    CHECK(pacer.GetWaitTicks() == 0);
+}
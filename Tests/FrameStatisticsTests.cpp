@@ -0,0 +1,234 @@
+//--------------------------------------------------------------------------------------
+// File: FrameStatisticsTests.cpp
+//
+// Tests for FrameTimeHistory.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#include "../FrameStatistics.h"
+
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_Capacity = FrameTimeHistory::Capacity;
+}
+
+TEST_CASE(FrameStatistics_NearestRankPercentiles)
+{
+    auto history = std::make_unique<FrameTimeHistory>();
+    history->SetHitchFactor(1000.f);
+
+    // 1 to 100 ms in a scrambled order.
+    for (uint32_t j = 0; j < 100; ++j)
+    {
+        history->Push(float((j * 37) % 100 + 1));
+    }
+
+    const FrameTimeStats stats = history->ComputeStats();
+    CHECK(stats.count == 100);
+    CHECK_NEAR(stats.average, 50.5f, 1e-4f);
+    CHECK(stats.max == 100.f);
+
+    // The p-th percentile of 100 frames is the p-th smallest, so p99 is not the maximum.
+    CHECK(stats.p50 == 50.f);
+    CHECK(stats.p95 == 95.f);
+    CHECK(stats.p99 == 99.f);
+
+    // Over a window of the last 10 frames only.
+    const FrameTimeStats recent = history->ComputeStats(10);
+    CHECK(recent.count == 10);
+
+    float frames[10] = {};
+    REQUIRE(history->GetRecent(frames, 10) == 10);
+    float largest = 0.f;
+    for (float frame : frames)
+    {
+        largest = std::max(largest, frame);
+    }
+    CHECK(recent.max == largest);
+    CHECK(recent.p99 == largest);
+}
+
+TEST_CASE(FrameStatistics_NearestRankOtherCounts)
+{
+    // An even count takes the lower of the two middle frames for p50.
+    auto history = std::make_unique<FrameTimeHistory>();
+    const float frames[4] = { 40.f, 10.f, 30.f, 20.f };
+    for (float frame : frames)
+    {
+        history->Push(frame);
+    }
+
+    FrameTimeStats stats = history->ComputeStats();
+    CHECK(stats.p50 == 20.f);
+    CHECK(stats.p95 == 40.f);
+    CHECK(stats.p99 == 40.f);
+
+    // 1 to 200 ms: the 100th, 190th, and 198th smallest.
+    history->Reset();
+    history->SetHitchFactor(1000.f);
+    for (uint32_t j = 0; j < 200; ++j)
+    {
+        history->Push(float((j * 37) % 200 + 1));
+    }
+
+    stats = history->ComputeStats();
+    CHECK(stats.p50 == 100.f);
+    CHECK(stats.p95 == 190.f);
+    CHECK(stats.p99 == 198.f);
+}
+
+TEST_CASE(FrameStatistics_SingleFrameAndEmpty)
+{
+    auto history = std::make_unique<FrameTimeHistory>();
+
+    const FrameTimeStats empty = history->ComputeStats();
+    CHECK(empty.count == 0 && empty.p99 == 0.f);
+
+    history->Push(12.f);
+    const FrameTimeStats one = history->ComputeStats();
+    CHECK(one.count == 1);
+    CHECK(one.p50 == 12.f && one.p95 == 12.f && one.p99 == 12.f && one.max == 12.f);
+}
+
+TEST_CASE(FrameStatistics_HitchAndBudgetCounters)
+{
+    auto history = std::make_unique<FrameTimeHistory>();
+    history->SetBudget(16.f);
+    history->SetHitchFactor(2.f);
+
+    for (int j = 0; j < 10; ++j)
+    {
+        history->Push(10.f);
+    }
+    CHECK(history->GetHitchCount() == 0);
+    CHECK(history->GetOverBudgetCount() == 0);
+
+    // More than twice the recent average, and over budget.
+    history->Push(25.f);
+    CHECK(history->GetHitchCount() == 1);
+    CHECK(history->GetOverBudgetCount() == 1);
+
+    // The spike raised the average to 11.5 ms, so 20 ms is over budget but not a hitch.
+    history->Push(20.f);
+    CHECK(history->GetHitchCount() == 1);
+    CHECK(history->GetOverBudgetCount() == 2);
+
+    // Exactly on budget isn't over it.
+    history->Push(16.f);
+    CHECK(history->GetOverBudgetCount() == 2);
+
+    const FrameTimeStats stats = history->ComputeStats();
+    CHECK(stats.hitches == 1 && stats.overBudget == 2);
+
+    // Resetting the counters keeps the frames.
+    history->ResetCounters();
+    CHECK(history->GetHitchCount() == 0 && history->GetOverBudgetCount() == 0);
+    CHECK(history->GetFrameCount() == 13);
+
+    history->Reset();
+    CHECK(history->GetFrameCount() == 0);
+    CHECK(history->ComputeStats().count == 0);
+}
+
+TEST_CASE(FrameStatistics_RingWrap)
+{
+    auto history = std::make_unique<FrameTimeHistory>();
+
+    const size_t pushed = c_Capacity * 2 + 10;
+    for (size_t j = 0; j < pushed; ++j)
+    {
+        history->Push(float(j));
+    }
+    CHECK(history->GetFrameCount() == pushed);
+
+    std::vector<float> frames(c_Capacity + 5);
+    uint64_t firstFrame = 0;
+    REQUIRE(history->GetRecent(frames.data(), frames.size(), &firstFrame) == c_Capacity);
+    CHECK(firstFrame == pushed - c_Capacity);
+    for (size_t j = 0; j < c_Capacity; ++j)
+    {
+        REQUIRE(frames[j] == float(pushed - c_Capacity + j));
+    }
+
+    // Fewer than asked for, the most recent are returned.
+    REQUIRE(history->GetRecent(frames.data(), 3, &firstFrame) == 3);
+    CHECK(firstFrame == pushed - 3);
+    CHECK(frames[0] == float(pushed - 3) && frames[2] == float(pushed - 1));
+
+    const FrameTimeStats stats = history->ComputeStats();
+    CHECK(stats.count == c_Capacity);
+    CHECK(stats.max == float(pushed - 1));
+}
+
+TEST_CASE(FrameStatistics_WritesCSV)
+{
+    auto history = std::make_unique<FrameTimeHistory>();
+    history->SetBudget(16.f);
+
+    history->Push(10.f);
+    history->Push(20.5f);
+    history->Push(16.f);
+
+    std::ostringstream csv;
+    history->WriteCSV(csv);
+    CHECK(csv.str() == "frame,milliseconds,over_budget\n0,10,0\n1,20.5,1\n2,16,0\n");
+
+    // After wrapping, frame numbers continue from the oldest frame kept.
+    for (size_t j = 0; j < c_Capacity; ++j)
+    {
+        history->Push(1.f);
+    }
+
+    std::ostringstream wrapped;
+    history->WriteCSV(wrapped);
+    const std::string text = wrapped.str();
+    CHECK(text.compare(0, 39, "frame,milliseconds,over_budget\n3,1,0\n4,") == 0);
+}
+
+TEST_CASE(FrameStatistics_ConcurrentReadsAreContiguous)
+{
+    auto history = std::make_unique<FrameTimeHistory>();
+
+    // Each frame's time is its own index, so a torn read shows up as a gap.
+    constexpr uint32_t c_Frames = 2000000;
+    std::atomic<bool> done(false);
+    std::thread writer([&]()
+        {
+            for (uint32_t j = 0; j < c_Frames; ++j)
+            {
+                history->Push(float(j));
+            }
+            done.store(true);
+        });
+
+    std::vector<float> frames(c_Capacity);
+    size_t reads = 0;
+    bool contiguous = true;
+    while (!done.load() || !reads)
+    {
+        uint64_t firstFrame = 0;
+        const size_t count = history->GetRecent(frames.data(), frames.size(), &firstFrame);
+        for (size_t j = 0; j < count && contiguous; ++j)
+        {
+            contiguous = (frames[j] == float(firstFrame + j));
+        }
+        ++reads;
+    }
+
+    writer.join();
+    CHECK(contiguous);
+    CHECK(history->GetFrameCount() == c_Frames);
+}
@@ -0,0 +1,232 @@
+//--------------------------------------------------------------------------------------
+// File: GpuTimerTests.cpp
+//
+// Tests for the GpuTimer ring, using stand-in queries whose readiness the test controls.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#ifdef _WIN32
+#include <sal.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "../GpuTimer.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace DX;
+
+namespace
+{
+    constexpr size_t c_Slots = GpuTimer::FrameLatency;
+
+    // Microsecond timestamps, so 1000 ticks are one millisecond.
+    constexpr uint64_t c_Frequency = 1000000;
+
+    class FakeQueries : public IGpuTimerQueries
+    {
+    public:
+        struct Slot
+        {
+            bool        ready;
+            uint64_t    frequency;
+            uint32_t    issued;
+            uint64_t    timestamps[32];
+        };
+
+        Slot                slots[c_Slots] = {};
+        std::vector<size_t> resolved;       // Slots read back, in order
+        uint64_t            now = 0;
+        size_t              timestampCount = 0;
+
+        void Begin(size_t slot) override
+        {
+            slots[slot] = {};
+            slots[slot].frequency = c_Frequency;
+        }
+
+        void End(size_t) override {}
+
+        void Timestamp(size_t slot, size_t index) override
+        {
+            slots[slot].timestamps[index] = now;
+            slots[slot].issued |= 1u << index;
+            ++timestampCount;
+        }
+
+        bool Resolve(size_t slot, uint32_t mask, _Out_writes_(32) uint64_t* timestamps, uint64_t& frequency) override
+        {
+            const Slot& s = slots[slot];
+            if (!s.ready)
+                return false;
+
+            CHECK(mask == s.issued);
+            memcpy(timestamps, s.timestamps, sizeof(s.timestamps));
+            frequency = s.frequency;
+            resolved.push_back(slot);
+            return true;
+        }
+    };
+
+    // Records a frame of 'frameMs' with pass 0 taking 'passMs' of it.
+    void RecordFrame(GpuTimer& timer, FakeQueries& queries, uint64_t frameMs, uint64_t passMs)
+    {
+        timer.BeginFrame();
+        const uint64_t begin = queries.now;
+        timer.BeginPass(0);
+        queries.now += passMs * 1000;
+        timer.EndPass(0);
+        queries.now = begin + frameMs * 1000;
+        timer.EndFrame();
+    }
+}
+
+TEST_CASE(GpuTimer_SkipsWhenAllSlotsPending)
+{
+    FakeQueries queries;
+    GpuTimer timer;
+    timer.SetQueries(&queries);
+
+    for (size_t j = 0; j < c_Slots; ++j)
+    {
+        RecordFrame(timer, queries, 10, 5);
+    }
+    CHECK(timer.GetSkippedFrames() == 0);
+    CHECK(!timer.HasNewResults());
+
+    // Every slot is in flight: the next frame isn't timed and issues no queries.
+    const size_t issued = queries.timestampCount;
+    RecordFrame(timer, queries, 10, 5);
+    CHECK(timer.GetSkippedFrames() == 1);
+    CHECK(queries.timestampCount == issued);
+    CHECK(queries.resolved.empty());
+
+    // Once the oldest is ready its slot is read back and reused.
+    queries.slots[0].ready = true;
+    RecordFrame(timer, queries, 12, 6);
+    CHECK(timer.GetSkippedFrames() == 1);
+    CHECK(queries.timestampCount > issued);
+    CHECK(queries.resolved.size() == 1 && queries.resolved[0] == 0);
+    CHECK(timer.HasNewResults());
+    CHECK_NEAR(timer.GetLastFrameMilliseconds(), 10.f, 1e-4f);
+    CHECK_NEAR(timer.GetLastPassMilliseconds(0), 5.f, 1e-4f);
+
+    // Nothing more read back in the next frame.
+    RecordFrame(timer, queries, 10, 5);
+    CHECK(!timer.HasNewResults());
+}
+
+TEST_CASE(GpuTimer_DiscardsDisjointFrames)
+{
+    FakeQueries queries;
+    GpuTimer timer;
+    timer.SetQueries(&queries);
+
+    RecordFrame(timer, queries, 10, 5);
+    queries.slots[0].frequency = 0;
+    queries.slots[0].ready = true;
+
+    // The slot is freed, but its times are not reported.
+    RecordFrame(timer, queries, 20, 8);
+    CHECK(timer.GetDisjointFrames() == 1);
+    CHECK(!timer.HasNewResults());
+    CHECK(timer.GetLastFrameMilliseconds() < 0.f);
+    CHECK(timer.GetFrameMilliseconds() < 0.f);
+    CHECK(timer.GetPassMilliseconds(0) < 0.f);
+
+    queries.slots[1].ready = true;
+    RecordFrame(timer, queries, 10, 5);
+    CHECK(timer.GetDisjointFrames() == 1);
+    CHECK(timer.HasNewResults());
+    CHECK_NEAR(timer.GetLastFrameMilliseconds(), 20.f, 1e-4f);
+    CHECK_NEAR(timer.GetFrameMilliseconds(), 20.f, 1e-4f);
+    CHECK_NEAR(timer.GetPassMilliseconds(0), 8.f, 1e-4f);
+}
+
+TEST_CASE(GpuTimer_ResolvesOldestFirst)
+{
+    FakeQueries queries;
+    GpuTimer timer;
+    timer.SetQueries(&queries);
+
+    RecordFrame(timer, queries, 10, 1);
+    RecordFrame(timer, queries, 20, 2);
+    RecordFrame(timer, queries, 30, 3);
+
+    // Newer frames finishing first wait behind the oldest.
+    queries.slots[1].ready = true;
+    queries.slots[2].ready = true;
+    timer.BeginFrame();
+    timer.EndFrame();
+    CHECK(queries.resolved.empty());
+    CHECK(!timer.HasNewResults());
+
+    // Then all three are read back in the order they were drawn, and the last one wins.
+    queries.slots[0].ready = true;
+    timer.BeginFrame();
+    timer.EndFrame();
+    REQUIRE(queries.resolved.size() == 3);
+    CHECK(queries.resolved[0] == 0 && queries.resolved[1] == 1 && queries.resolved[2] == 2);
+    CHECK(timer.HasNewResults());
+    CHECK_NEAR(timer.GetLastFrameMilliseconds(), 30.f, 1e-4f);
+    CHECK_NEAR(timer.GetLastPassMilliseconds(0), 3.f, 1e-4f);
+
+    // Smoothed: 10, then 10 + 0.1 * (20 - 10), then 11 + 0.1 * (30 - 11).
+    CHECK_NEAR(timer.GetFrameMilliseconds(), 12.9f, 1e-3f);
+}
+
+TEST_CASE(GpuTimer_PassesOutsideFrame)
+{
+    FakeQueries queries;
+    GpuTimer timer;
+
+    // Without queries nothing is issued.
+    timer.BeginFrame();
+    timer.BeginPass(0);
+    timer.EndPass(0);
+    timer.EndFrame();
+
+    timer.SetQueries(&queries);
+    CHECK(queries.timestampCount == 0);
+
+    // Passes before or after the frame, or beyond MaxPasses, are ignored.
+    timer.BeginPass(1);
+    timer.EndPass(1);
+    CHECK(queries.timestampCount == 0);
+
+    timer.BeginFrame();
+    const size_t frameBegin = queries.timestampCount;
+    timer.BeginPass(GpuTimer::MaxPasses);
+    timer.EndPass(GpuTimer::MaxPasses);
+    CHECK(queries.timestampCount == frameBegin);
+
+    // Ending a pass that never began issues nothing, and the pass isn't reported.
+    timer.EndPass(2);
+    CHECK(queries.timestampCount == frameBegin);
+
+    timer.BeginPass(0);
+    queries.now += 4000;
+    timer.EndPass(0);
+    queries.now += 1000;
+    timer.EndFrame();
+
+    timer.BeginPass(0);
+    timer.EndPass(0);
+    CHECK((queries.slots[0].issued & ~0xFu) == 0);
+
+    queries.slots[0].ready = true;
+    timer.BeginFrame();
+    timer.EndFrame();
+    CHECK(timer.HasNewResults());
+    CHECK_NEAR(timer.GetLastPassMilliseconds(0), 4.f, 1e-4f);
+    CHECK(timer.GetLastPassMilliseconds(1) < 0.f);
+    CHECK(timer.GetLastPassMilliseconds(2) < 0.f);
+    CHECK(timer.GetLastPassMilliseconds(GpuTimer::MaxPasses) < 0.f);
+    CHECK_NEAR(timer.GetLastFrameMilliseconds(), 5.f, 1e-4f);
+}
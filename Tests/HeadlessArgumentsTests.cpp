@@ -0,0 +1,86 @@
+//--------------------------------------------------------------------------------------
+// File: HeadlessArgumentsTests.cpp
+//
+// Tests for the headless renderer's command-line parsing and the shared switch matching.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "../CommandLine.h"
+#include "../HeadlessRenderer.h"
+
+#include <cwchar>
+
+using namespace DX;
+
+TEST_CASE(CommandLine_MatchSwitch)
+{
+    const wchar_t* value = MatchSwitch(L"-size:640x480", L"size");
+    REQUIRE(value != nullptr);
+    CHECK(wcscmp(value, L"640x480") == 0);
+
+    // Case doesn't matter, and a switch without a value matches with an empty one.
+    value = MatchSwitch(L"-GRID", L"grid");
+    REQUIRE(value != nullptr);
+    CHECK(*value == 0);
+
+    // Only the whole name matches.
+    CHECK(MatchSwitch(L"-gridlines", L"grid") == nullptr);
+    CHECK(MatchSwitch(L"-gri", L"grid") == nullptr);
+    CHECK(MatchSwitch(L"grid", L"grid") == nullptr);
+
+#ifdef _WIN32
+    CHECK(MatchSwitch(L"/grid", L"grid") != nullptr);
+#else
+    CHECK(MatchSwitch(L"/grid", L"grid") == nullptr);
+#endif
+}
+
+TEST_CASE(HeadlessArguments_Switches)
+{
+    HeadlessOptions options;
+    CHECK(ParseHeadlessArgument(L"-inspect", options));
+    CHECK(ParseHeadlessArgument(L"-Size:640x480", options));
+    CHECK(ParseHeadlessArgument(L"-out:/tmp/images", options));
+    CHECK(options.inspect);
+    CHECK(options.width == 640 && options.height == 480);
+    CHECK(options.outputDirectory == L"/tmp/images");
+    CHECK(options.models.empty());
+
+    // Unknown switches and bad values are rejected rather than taken for models.
+    CHECK(!ParseHeadlessArgument(L"-bogus", options));
+    CHECK(!ParseHeadlessArgument(L"-size:0", options));
+    CHECK(!ParseHeadlessArgument(L"", options));
+    CHECK(options.models.empty());
+}
+
+TEST_CASE(HeadlessArguments_Models)
+{
+    HeadlessOptions options;
+    CHECK(ParseHeadlessArgument(L"model.sdkmesh", options));
+    CHECK(ParseHeadlessArgument(L"../models/model.vbo", options));
+    REQUIRE(options.models.size() == 2);
+    CHECK(options.models[1] == L"../models/model.vbo");
+
+#ifdef _WIN32
+    // On Windows '/' starts a switch.
+    CHECK(!ParseHeadlessArgument(L"/abs/model.sdkmesh", options));
+    CHECK(ParseHeadlessArgument(L"/inspect", options) && options.inspect);
+    CHECK(options.models.size() == 2);
+#else
+    // Elsewhere it starts an absolute path, even one named like a switch.
+    CHECK(ParseHeadlessArgument(L"/abs/model.sdkmesh", options));
+    CHECK(ParseHeadlessArgument(L"/inspect", options));
+    CHECK(!options.inspect);
+    REQUIRE(options.models.size() == 4);
+    CHECK(options.models[2] == L"/abs/model.sdkmesh");
+    CHECK(options.models[3] == L"/inspect");
+#endif
+}
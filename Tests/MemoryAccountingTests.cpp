@@ -0,0 +1,177 @@
+//--------------------------------------------------------------------------------------
+// File: MemoryAccountingTests.cpp
+//
+// Tests for the surface and texture size tables and the MemoryLedger.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "../MemoryAccounting.h"
+
+#include <cstdio>
+
+using namespace DX;
+
+namespace
+{
+    struct SurfaceCase
+    {
+        DXGI_FORMAT format;
+        uint32_t    width;
+        uint32_t    height;
+        uint64_t    bytes;
+    };
+
+    struct TextureCase
+    {
+        DXGI_FORMAT format;
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    depth;
+        uint32_t    arraySize;
+        uint32_t    mipLevels;
+        uint32_t    sampleCount;
+        uint64_t    bytes;
+    };
+
+    const SurfaceCase c_Surfaces[] =
+    {
+        // Block compressed sizes round up to whole 4x4 blocks, of 8 bytes for BC1 and 16 for BC7.
+        { DXGI_FORMAT_BC1_UNORM, 4, 4, 8 },
+        { DXGI_FORMAT_BC1_UNORM, 1, 1, 8 },
+        { DXGI_FORMAT_BC1_UNORM, 5, 5, 32 },
+        { DXGI_FORMAT_BC1_UNORM, 6, 3, 16 },
+        { DXGI_FORMAT_BC7_UNORM, 1, 1, 16 },
+        { DXGI_FORMAT_BC7_UNORM, 5, 5, 64 },
+        { DXGI_FORMAT_BC7_UNORM_SRGB, 13, 7, 128 },
+
+        // Planar 4:2:0: a full-size luma plane and a half-height plane of interleaved chroma.
+        { DXGI_FORMAT_NV12, 4, 4, 24 },
+        { DXGI_FORMAT_NV12, 5, 3, 30 },
+        { DXGI_FORMAT_NV12, 1920, 1080, 3110400 },
+        { DXGI_FORMAT_P010, 4, 4, 48 },
+        { DXGI_FORMAT_P010, 5, 3, 60 },
+        { DXGI_FORMAT_P010, 1920, 1080, 6220800 },
+
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 3, 3, 36 },
+        { DXGI_FORMAT_R1_UNORM, 9, 2, 4 },
+        { DXGI_FORMAT_UNKNOWN, 16, 16, 0 },
+    };
+
+    const TextureCase c_Textures[] =
+    {
+        // A mipLevels of 0 is the full chain: 4x4, 2x2, 1x1.
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 1, 0, 1, 84 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 1, 1, 1, 64 },
+
+        // Nine levels from the longer side, the shorter staying at 1.
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 256, 1, 1, 1, 0, 1, 2044 },
+
+        // Mips below 4x4 still take a whole block.
+        { DXGI_FORMAT_BC1_UNORM, 8, 8, 1, 1, 0, 1, 56 },
+
+        // Cube maps and arrays multiply every level by the slice count.
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 6, 1, 1, 384 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 6, 0, 1, 504 },
+        { DXGI_FORMAT_BC7_UNORM, 8, 8, 1, 3, 0, 1, 3 * (64 + 16 + 16 + 16) },
+
+        // Volumes halve in depth too: 4x4x4, 2x2x2, 1x1x1 ...
+        { DXGI_FORMAT_R8_UNORM, 4, 4, 4, 1, 0, 1, 64 + 8 + 1 },
+
+        // ... and the deepest side sets the chain length: 4x4x16, 2x2x8, 1x1x4, 1x1x2, 1x1x1.
+        { DXGI_FORMAT_R8_UNORM, 4, 4, 16, 1, 0, 1, 256 + 32 + 4 + 2 + 1 },
+
+        // Multisampled surfaces scale with the sample count; 0 counts as 1.
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 1920, 1080, 1, 1, 1, 4, 33177600 },
+        { DXGI_FORMAT_D32_FLOAT, 1920, 1080, 1, 1, 1, 8, 66355200 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM, 1920, 1080, 1, 1, 1, 0, 8294400 },
+    };
+}
+
+TEST_CASE(MemoryAccounting_SurfaceBytes)
+{
+    for (auto const& c : c_Surfaces)
+    {
+        const uint64_t bytes = ComputeSurfaceBytes(c.format, c.width, c.height);
+        if (!CHECK(bytes == c.bytes))
+        {
+            printf("    format %u, %ux%u: %llu bytes, expected %llu\n", static_cast<uint32_t>(c.format), c.width, c.height,
+                static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(c.bytes));
+        }
+    }
+
+    CHECK(IsCompressed(DXGI_FORMAT_BC1_UNORM) && IsCompressed(DXGI_FORMAT_BC7_UNORM_SRGB));
+    CHECK(!IsCompressed(DXGI_FORMAT_NV12) && !IsCompressed(DXGI_FORMAT_R8G8B8A8_UNORM));
+    CHECK(BitsPerPixel(DXGI_FORMAT_NV12) == 12 && BitsPerPixel(DXGI_FORMAT_P010) == 24);
+}
+
+TEST_CASE(MemoryAccounting_TextureBytes)
+{
+    for (auto const& c : c_Textures)
+    {
+        const uint64_t bytes = ComputeTextureBytes(c.format, c.width, c.height, c.depth, c.arraySize, c.mipLevels, c.sampleCount);
+        if (!CHECK(bytes == c.bytes))
+        {
+            printf("    format %u, %ux%ux%u, %u slices, %u mips, %u samples: %llu bytes, expected %llu\n",
+                static_cast<uint32_t>(c.format), c.width, c.height, c.depth, c.arraySize, c.mipLevels, c.sampleCount,
+                static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(c.bytes));
+        }
+    }
+}
+
+TEST_CASE(MemoryLedger_Textures)
+{
+    MemoryLedger ledger;
+
+    // The same depthOrArraySize is slices for a cube and depth for a volume.
+    CHECK(ledger.AddTexture(MemoryCategory::Textures, "cube", DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 6, 0));
+    CHECK(ledger.AddTexture(MemoryCategory::Textures, "volume", DXGI_FORMAT_R8_UNORM, 4, 4, 16, 0, 1, true));
+    CHECK(ledger.AddTexture(MemoryCategory::RenderTargets, "msaa", DXGI_FORMAT_R8G8B8A8_UNORM, 1920, 1080, 1, 1, 4));
+
+    auto const& entries = ledger.GetEntries();
+    REQUIRE(entries.size() == 3);
+    CHECK(entries[0].bytes == 504 && entries[0].mipLevels == 3);
+    CHECK(entries[1].bytes == 295 && entries[1].mipLevels == 5);
+    CHECK(entries[2].bytes == 33177600 && entries[2].sampleCount == 4);
+
+    const MemoryLedger::Total textures = ledger.GetTotal(MemoryCategory::Textures);
+    CHECK(textures.bytes == 504 + 295 && textures.count == 2);
+    CHECK(ledger.GetTotalBytes() == 504 + 295 + 33177600);
+}
+
+TEST_CASE(MemoryLedger_RejectsDuplicateKeys)
+{
+    MemoryLedger ledger;
+    const int vertexBuffer = 0;
+    const int texture = 0;
+
+    CHECK(ledger.AddBuffer(MemoryCategory::VertexBuffers, "vb", 1024, &vertexBuffer));
+    CHECK(!ledger.AddBuffer(MemoryCategory::VertexBuffers, "vb again", 1024, &vertexBuffer));
+
+    // Keys are shared across categories and kinds of resource.
+    CHECK(!ledger.AddBuffer(MemoryCategory::IndexBuffers, "ib", 512, &vertexBuffer));
+    CHECK(!ledger.AddTexture(MemoryCategory::Textures, "tex", DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 1, 1, false, &vertexBuffer));
+    CHECK(ledger.AddTexture(MemoryCategory::Textures, "tex", DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 1, 1, false, &texture));
+
+    // Resources without a key are always counted.
+    CHECK(ledger.AddBuffer(MemoryCategory::CpuData, "cpu", 100));
+    CHECK(ledger.AddBuffer(MemoryCategory::CpuData, "cpu", 100));
+
+    CHECK(ledger.GetEntries().size() == 4);
+    CHECK(ledger.GetTotal(MemoryCategory::VertexBuffers).count == 1);
+    CHECK(ledger.GetTotal(MemoryCategory::IndexBuffers).count == 0);
+    CHECK(ledger.GetTotal(MemoryCategory::CpuData).bytes == 200);
+    CHECK(ledger.GetTotalBytes() == 1024 + 64 + 200);
+
+    // Clearing forgets the keys as well.
+    ledger.Clear();
+    CHECK(ledger.GetTotalBytes() == 0);
+    CHECK(ledger.AddBuffer(MemoryCategory::VertexBuffers, "vb", 1024, &vertexBuffer));
+}
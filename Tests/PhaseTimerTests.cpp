@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------------------
+// File: PhaseTimerTests.cpp
+//
+// Tests for PhaseTimer and the Chrome trace writer.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#include "../PhaseTimer.h"
+
+#include <sstream>
+#include <string>
+
+using namespace DX;
+
+namespace
+{
+    std::string ToJSON(const char* str)
+    {
+        std::ostringstream stream;
+        WriteJSONString(stream, str);
+        return stream.str();
+    }
+}
+
+TEST_CASE(PhaseTimer_NestedPhases)
+{
+    PhaseTimer timer;
+
+    const size_t outer = timer.Begin("outer");
+    const size_t inner = timer.Begin("inner");
+    timer.Mark("mark");
+    timer.End(inner);
+    const size_t sibling = timer.Begin("sibling");
+    timer.End(sibling);
+    timer.End(outer);
+
+    auto const& phases = timer.GetPhases();
+    REQUIRE(phases.size() == 4);
+
+    CHECK(phases[outer].depth == 0);
+    CHECK(phases[inner].depth == 1);
+    CHECK(phases[2].depth == 2);
+    CHECK(phases[sibling].depth == 1);
+
+    for (auto const& phase : phases)
+    {
+        CHECK(!phase.open);
+    }
+
+    // Children start no earlier, and end no later, than their parent.
+    CHECK(phases[inner].wallStart >= phases[outer].wallStart);
+    CHECK(phases[inner].wallStart + phases[inner].wallDuration <= phases[outer].wallStart + phases[outer].wallDuration);
+    CHECK(phases[2].wallDuration == 0 && phases[2].cpuDuration == 0);
+
+    // Only marks are instants, however short a phase was.
+    CHECK(phases[2].instant);
+    CHECK(!phases[outer].instant && !phases[inner].instant && !phases[sibling].instant);
+
+    // The next top-level phase is back at depth 0.
+    CHECK(timer.GetPhases()[timer.Begin("next")].depth == 0);
+}
+
+TEST_CASE(PhaseTimer_OutOfOrderEnd)
+{
+    PhaseTimer timer;
+
+    const size_t outer = timer.Begin("outer");
+    const size_t inner = timer.Begin("inner");
+
+    // Ending the parent first closes only the parent.
+    timer.End(outer);
+    CHECK(!timer.GetPhases()[outer].open);
+    CHECK(timer.GetPhases()[inner].open);
+
+    timer.End(inner);
+    CHECK(!timer.GetPhases()[inner].open);
+
+    // Ending twice, or an index that was never returned, changes nothing.
+    timer.End(outer);
+    timer.End(inner);
+    timer.End(100);
+
+    CHECK(timer.GetPhases()[timer.Begin("after")].depth == 0);
+}
+
+TEST_CASE(PhaseTimer_ReportsOpenPhases)
+{
+    PhaseTimer timer;
+    timer.Begin("unfinished");
+
+    std::ostringstream report;
+    timer.WriteReport(report);
+    CHECK(report.str().find("unfinished (not ended)") != std::string::npos);
+}
+
+TEST_CASE(ChromeTrace_EscapesStrings)
+{
+    CHECK(ToJSON("plain") == "\"plain\"");
+    CHECK(ToJSON("say \"hi\"") == "\"say \\\"hi\\\"\"");
+    CHECK(ToJSON("C:\\models\\a.sdkmesh") == "\"C:\\\\models\\\\a.sdkmesh\"");
+    CHECK(ToJSON("a\nb\rc\td") == "\"a\\nb\\rc\\td\"");
+    CHECK(ToJSON("\x01\x1f") == "\"\\u0001\\u001f\"");
+    CHECK(ToJSON(nullptr) == "\"\"");
+
+    // Bytes of UTF-8 pass through unchanged.
+    CHECK(ToJSON("\xC3\xA9") == "\"\xC3\xA9\"");
+}
+
+TEST_CASE(ChromeTrace_WritesEvents)
+{
+    std::ostringstream stream;
+    stream.precision(9);
+    {
+        ChromeTraceWriter trace(stream);
+        trace.ThreadName(1, "Main \"thread\"");
+        trace.Complete("load", "startup", 1.5, 2.25, 1, "cpu_ms", 0.5);
+        trace.Instant("ready", "startup", 4.0, 1);
+        trace.Counter("memory", 5.0, 64.0);
+    }
+
+    const std::string json = stream.str();
+    const std::string header = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n{";
+    CHECK(json.compare(0, header.size(), header) == 0);
+    CHECK(json.find("\"args\":{\"name\":\"Main \\\"thread\\\"\"}") != std::string::npos);
+    CHECK(json.find("{\"name\":\"load\",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":1.500,\"dur\":2.250,\"args\":{\"cpu_ms\":0.500}}") != std::string::npos);
+    CHECK(json.find("\"ph\":\"i\",\"pid\":1,\"tid\":1,\"ts\":4.000,\"s\":\"t\"}") != std::string::npos);
+    CHECK(json.find("\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":5.000,\"args\":{\"value\":64.000}}") != std::string::npos);
+    CHECK(json.size() >= 4 && json.compare(json.size() - 4, 4, "\n]}\n") == 0);
+
+    // The stream's formatting is put back when the writer closes.
+    CHECK(stream.precision() == 9);
+    CHECK((stream.flags() & std::ios::floatfield) == 0);
+}
+
+TEST_CASE(PhaseTimer_WritesChromeTrace)
+{
+    PhaseTimer timer;
+    timer.End(timer.Begin("create \"device\""));
+    timer.Mark("first frame");
+
+    std::ostringstream stream;
+    timer.WriteChromeTrace(stream);
+
+    const std::string json = stream.str();
+    CHECK(json.find("\"name\":\"create \\\"device\\\"\",\"cat\":\"startup\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"first frame\",\"cat\":\"startup\",\"ph\":\"i\"") != std::string::npos);
+}
@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------
+// File: RenderTextureDescTests.cpp
+//
+// Tests for RenderTextureDesc and the sample count helpers.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "../RenderTextureDesc.h"
+
+using namespace DX;
+
+namespace
+{
+    RenderTextureDesc Sized(DXGI_FORMAT format, uint32_t samples, uint32_t width, uint32_t height)
+    {
+        RenderTextureDesc desc(format, samples, DXGI_FORMAT_D32_FLOAT);
+        desc.width = width;
+        desc.height = height;
+        return desc;
+    }
+}
+
+TEST_CASE(RenderTextureDesc_ValidSampleCounts)
+{
+    CHECK(IsValidSampleCount(1));
+    CHECK(IsValidSampleCount(2));
+    CHECK(IsValidSampleCount(4));
+    CHECK(IsValidSampleCount(8));
+
+    CHECK(!IsValidSampleCount(0));
+    CHECK(!IsValidSampleCount(3));
+    CHECK(!IsValidSampleCount(6));
+    CHECK(!IsValidSampleCount(16));
+    CHECK(!IsValidSampleCount(UINT32_MAX));
+}
+
+TEST_CASE(RenderTextureDesc_ChooseSampleCount)
+{
+    // Supported sets are masks of the counts: here single sampling, 2x, and 4x.
+    const uint32_t supported = 1 | 2 | 4;
+
+    CHECK(ChooseSampleCount(8, supported) == 4);
+    CHECK(ChooseSampleCount(4, supported) == 4);
+    CHECK(ChooseSampleCount(3, supported) == 2);
+    CHECK(ChooseSampleCount(1, supported) == 1);
+    CHECK(ChooseSampleCount(0, supported) == 1);
+    CHECK(ChooseSampleCount(8, 1) == 1);
+    CHECK(ChooseSampleCount(8, 1 | 8) == 8);
+
+    CHECK(GetNextSampleCount(1, supported) == 2);
+    CHECK(GetNextSampleCount(2, supported) == 4);
+    CHECK(GetNextSampleCount(4, supported) == 1);
+    CHECK(GetNextSampleCount(1, 1 | 8) == 8);
+    CHECK(GetNextSampleCount(1, 1) == 1);
+}
+
+TEST_CASE(RenderTextureDesc_Multisampled)
+{
+    const RenderTextureDesc empty;
+    CHECK(!empty.IsMultisampled() && !empty.IsSized());
+    CHECK(empty.GetMemoryUsage() == 0);
+
+    const RenderTextureDesc single = Sized(DXGI_FORMAT_R16G16B16A16_FLOAT, 1, 1920, 1080);
+    CHECK(!single.IsMultisampled() && single.IsSized());
+
+    // Without multisampling there is no depth buffer or resolve texture of its own.
+    CHECK(single.GetTargetBytes() == 1920 * 1080 * 8);
+    CHECK(single.GetDepthBytes() == 0 && single.GetResolveBytes() == 0);
+
+    const RenderTextureDesc msaa = Sized(DXGI_FORMAT_R11G11B10_FLOAT, 4, 1920, 1080);
+    CHECK(msaa.IsMultisampled());
+    CHECK(msaa.GetTargetBytes() == 33177600);
+    CHECK(msaa.GetDepthBytes() == 33177600);
+    CHECK(msaa.GetResolveBytes() == 8294400);
+    CHECK(msaa.GetMemoryUsage() == 33177600 + 33177600 + 8294400);
+
+    // Not sized yet, nothing is allocated.
+    const RenderTextureDesc unsized(DXGI_FORMAT_R11G11B10_FLOAT, 4, DXGI_FORMAT_D32_FLOAT);
+    CHECK(unsized.IsMultisampled() && !unsized.IsSized());
+    CHECK(unsized.GetMemoryUsage() == 0);
+}
+
+TEST_CASE(RenderTextureDesc_NeedsRecreate)
+{
+    const RenderTextureDesc desc = Sized(DXGI_FORMAT_R16G16B16A16_FLOAT, 4, 1280, 720);
+    CHECK(!desc.NeedsRecreate(desc));
+
+    // A new size, format, or sample count needs new textures.
+    CHECK(desc.NeedsRecreate(Sized(DXGI_FORMAT_R16G16B16A16_FLOAT, 4, 1920, 720)));
+    CHECK(desc.NeedsRecreate(Sized(DXGI_FORMAT_R16G16B16A16_FLOAT, 4, 1280, 1080)));
+    CHECK(desc.NeedsRecreate(Sized(DXGI_FORMAT_R11G11B10_FLOAT, 4, 1280, 720)));
+    CHECK(desc.NeedsRecreate(Sized(DXGI_FORMAT_R16G16B16A16_FLOAT, 2, 1280, 720)));
+    CHECK(desc.NeedsRecreate(Sized(DXGI_FORMAT_R16G16B16A16_FLOAT, 1, 1280, 720)));
+
+    // Releasing the size on a device loss or resize does too.
+    CHECK(desc.NeedsRecreate(RenderTextureDesc(DXGI_FORMAT_R16G16B16A16_FLOAT, 4, DXGI_FORMAT_D32_FLOAT)));
+
+    // The depth format only matters when multisampled, since only then is there a depth buffer.
+    RenderTextureDesc otherDepth = desc;
+    otherDepth.depthFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    CHECK(desc.NeedsRecreate(otherDepth));
+
+    const RenderTextureDesc single = Sized(DXGI_FORMAT_R16G16B16A16_FLOAT, 1, 1280, 720);
+    RenderTextureDesc singleOtherDepth = single;
+    singleOtherDepth.depthFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+    CHECK(!single.NeedsRecreate(singleOtherDepth));
+}
+
+TEST_CASE(RenderTextureDesc_HdrFormats)
+{
+    CHECK(GetHdrFormat(HdrFormat::R16G16B16A16Float) == DXGI_FORMAT_R16G16B16A16_FLOAT);
+    CHECK(GetHdrFormat(HdrFormat::R11G11B10Float) == DXGI_FORMAT_R11G11B10_FLOAT);
+    CHECK(GetHdrFormat(HdrFormat::Count) == DXGI_FORMAT_UNKNOWN);
+}
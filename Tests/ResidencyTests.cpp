@@ -0,0 +1,149 @@
+//--------------------------------------------------------------------------------------
+// File: ResidencyTests.cpp
+//
+// Tests for the ResidencyManager policy: items spaced far apart along x, each with its
+// own resource, and a camera that looks at one or more of them at a time.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "../ResidencyManager.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    constexpr float c_Spacing = 100.f;
+    constexpr uint64_t c_Bytes = 100;
+
+    // Looks down -z at x from a distance; close up only the item at x is in view.
+    const ResidencyManager::Changes& Look(ResidencyManager& residency, float x, float distance = 10.f)
+    {
+        const XMMATRIX view = XMMatrixLookAtRH(XMVectorSet(x, 0.f, distance, 0.f), XMVectorSet(x, 0.f, 0.f, 0.f), g_XMIdentityR1);
+        const XMMATRIX projection = XMMatrixPerspectiveFovRH(XM_PIDIV4, 1.f, 0.1f, 1000.f);
+        return residency.Update(XMMatrixIdentity(), view, projection, 720.f, true);
+    }
+
+    float ItemX(uint32_t item) { return float(item) * c_Spacing; }
+
+    // 'count' items each with one resource of c_Bytes, under a budget of 'resident' of them.
+    ResidencyManager CreateRow(size_t count, uint64_t resident)
+    {
+        ResidencyManager::Settings settings;
+        settings.budgetBytes = resident * c_Bytes;
+
+        ResidencyManager residency(settings);
+        for (size_t j = 0; j < count; ++j)
+        {
+            const uint32_t resource = residency.AddResource(c_Bytes);
+            residency.AddItem(BoundingSphere(XMFLOAT3(ItemX(uint32_t(j)), 0.f, 0.f), 1.f), { resource });
+        }
+        return residency;
+    }
+
+    bool Equals(const std::vector<uint32_t>& a, std::initializer_list<uint32_t> b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+}
+
+TEST_CASE(Residency_EvictsLeastRecentlyVisible)
+{
+    ResidencyManager residency = CreateRow(4, 2);
+
+    CHECK(Equals(Look(residency, ItemX(0)).load, { 0 }));
+    CHECK(Equals(Look(residency, ItemX(1)).load, { 1 }));
+    CHECK(residency.GetStatistics().residentBytes == 2 * c_Bytes);
+
+    // Over budget: the resource seen longest ago goes first.
+    auto const& changes = Look(residency, ItemX(2));
+    CHECK(Equals(changes.evict, { 0 }));
+    CHECK(Equals(changes.load, { 2 }));
+    CHECK(residency.IsDrawable(2));
+
+    // Seeing a resident resource again makes it the most recent, so 2 goes before 1.
+    CHECK(Look(residency, ItemX(1)).load.empty());
+    CHECK(Equals(Look(residency, ItemX(3)).evict, { 2 }));
+    CHECK(residency.IsResident(1) && residency.IsResident(3));
+    CHECK(!residency.IsResident(0) && !residency.IsResident(2));
+
+    const auto& stats = residency.GetStatistics();
+    CHECK(stats.totalLoads == 4 && stats.totalEvictions == 2);
+    CHECK(stats.peakResidentBytes == 2 * c_Bytes);
+}
+
+TEST_CASE(Residency_ReloadsEvictedResources)
+{
+    ResidencyManager residency = CreateRow(3, 2);
+
+    Look(residency, ItemX(0));
+    Look(residency, ItemX(1));
+    Look(residency, ItemX(2));
+    CHECK(!residency.IsResident(0));
+
+    // Coming back to an evicted item requests its resource again, evicting the next oldest.
+    auto const& changes = Look(residency, ItemX(0));
+    CHECK(Equals(changes.evict, { 1 }));
+    CHECK(Equals(changes.load, { 0 }));
+    CHECK(residency.IsDrawable(0));
+
+    const auto& stats = residency.GetStatistics();
+    CHECK(stats.totalLoads == 4);
+    CHECK(stats.totalLoadedBytes == 4 * c_Bytes);
+    CHECK(stats.residentResources == 2);
+
+    // Once resident, looking again loads nothing.
+    CHECK(Look(residency, ItemX(0)).load.empty());
+    CHECK(residency.GetStatistics().totalLoads == 4);
+}
+
+TEST_CASE(Residency_KeepsVisibleResources)
+{
+    ResidencyManager residency = CreateRow(3, 2);
+
+    Look(residency, ItemX(0));
+    Look(residency, ItemX(1));
+
+    // From far back items 0 and 1 are both in view, and 2 isn't.
+    auto const& wide = Look(residency, ItemX(0) + c_Spacing * 0.5f, 200.f);
+    CHECK(residency.GetStatistics().visibleItems == 2);
+    CHECK(wide.evict.empty() && wide.load.empty());
+
+    // With everything in view, nothing visible is evicted to make room: the third item
+    // waits, and the budget holds.
+    auto const& all = Look(residency, ItemX(1), 400.f);
+    CHECK(residency.GetStatistics().visibleItems == 3);
+    CHECK(all.evict.empty() && all.load.empty());
+    CHECK(!residency.IsDrawable(2));
+    CHECK(residency.IsLoading());
+    CHECK(residency.GetStatistics().residentBytes == 2 * c_Bytes);
+    CHECK(residency.GetStatistics().totalMisses == 1);
+}
+
+TEST_CASE(Residency_LoadsLargestOnScreenFirst)
+{
+    ResidencyManager::Settings settings;
+    settings.budgetBytes = c_Bytes;
+
+    // Two items in view, the nearer one larger on screen.
+    ResidencyManager residency(settings);
+    const uint32_t far = residency.AddResource(c_Bytes);
+    const uint32_t near = residency.AddResource(c_Bytes);
+    residency.AddItem(BoundingSphere(XMFLOAT3(0.f, 0.f, -50.f), 1.f), { far });
+    residency.AddItem(BoundingSphere(XMFLOAT3(0.f, 0.f, 0.f), 1.f), { near });
+
+    CHECK(Equals(Look(residency, 0.f).load, { near }));
+    CHECK(residency.IsDrawable(1) && !residency.IsDrawable(0));
+}
@@ -0,0 +1,172 @@
+//--------------------------------------------------------------------------------------
+// File: SectionPlanesTests.cpp
+//
+// Tests for SectionPlanes, checking the packet Classify against ClassifyScalar.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#ifndef _WIN32
+#include <wsl/winadapter.h>
+#endif
+
+#include "../SectionPlanes.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    using Result = SectionPlanes::Result;
+
+    BoundingBox Box(float x, float y, float z, float extent)
+    {
+        return BoundingBox(XMFLOAT3(x, y, z), XMFLOAT3(extent, extent, extent));
+    }
+
+    // Classifies with both paths, checking they agree, and returns the packet results.
+    std::vector<Result> Classify(const SectionPlanes& planes, const std::vector<BoundingBox>& boxes, FXMMATRIX world, size_t* outside = nullptr)
+    {
+        SectionPlanes::BoxBatch batch;
+        batch.Reserve(boxes.size());
+        for (auto const& box : boxes)
+        {
+            batch.Add(box);
+        }
+
+        std::vector<Result> results(boxes.size());
+        std::vector<Result> scalar(boxes.size());
+        const size_t count = planes.Classify(batch, world, results.data(), results.size());
+        const size_t scalarCount = planes.ClassifyScalar(boxes.data(), world, scalar.data(), scalar.size());
+
+        CHECK(count == scalarCount);
+        CHECK(results == scalar);
+        if (outside)
+        {
+            *outside = count;
+        }
+        return results;
+    }
+}
+
+TEST_CASE(SectionPlanes_SinglePlane)
+{
+    // Keeps x > 1; the normal need not be unit length.
+    const XMFLOAT4 plane(2.f, 0.f, 0.f, -2.f);
+    SectionPlanes planes;
+    planes.SetPlanes(&plane, 1);
+    CHECK(planes.IsEnabled() && planes.GetPlaneCount() == 1);
+
+    // Five boxes, so the second packet has unused lanes.
+    const std::vector<BoundingBox> boxes =
+    {
+        Box(5.f, 0.f, 0.f, 1.f),        // Fully in front
+        Box(-5.f, 3.f, 7.f, 1.f),       // Fully behind
+        Box(1.5f, 0.f, 0.f, 1.f),       // Straddling
+        Box(2.5f, -9.f, 4.f, 1.f),      // In front, just clear of the plane
+        Box(0.f, 0.f, 0.f, 1.f),        // Behind, touching it
+    };
+
+    size_t outside = 0;
+    const auto results = Classify(planes, boxes, XMMatrixIdentity(), &outside);
+    CHECK(results[0] == Result::Inside);
+    CHECK(results[1] == Result::Outside);
+    CHECK(results[2] == Result::Clipped);
+    CHECK(results[3] == Result::Inside);
+    CHECK(results[4] == Result::Clipped);
+    CHECK(outside == 1);
+}
+
+TEST_CASE(SectionPlanes_WorldTransform)
+{
+    const XMFLOAT4 plane(1.f, 0.f, 0.f, -2.f);
+    SectionPlanes planes;
+    planes.SetPlanes(&plane, 1);
+
+    // A long thin box: along x it crosses x = 2, but turned to lie along y it clears it.
+    const std::vector<BoundingBox> boxes = { BoundingBox(XMFLOAT3(0.f, 0.f, 0.f), XMFLOAT3(4.f, 0.5f, 0.5f)) };
+    const XMMATRIX moved = XMMatrixTranslation(3.f, 0.f, 0.f);
+    CHECK(Classify(planes, boxes, moved)[0] == Result::Clipped);
+    CHECK(Classify(planes, boxes, XMMatrixMultiply(XMMatrixRotationZ(XM_PIDIV2), moved))[0] == Result::Inside);
+    CHECK(Classify(planes, boxes, XMMatrixTranslation(-3.f, 0.f, 0.f))[0] == Result::Outside);
+}
+
+TEST_CASE(SectionPlanes_ClipBox)
+{
+    SectionPlanes planes;
+    planes.SetBox(BoundingBox(XMFLOAT3(1.f, 2.f, 3.f), XMFLOAT3(1.f, 1.f, 1.f)));
+    REQUIRE(planes.GetPlaneCount() == SectionPlanes::MaxPlanes);
+
+    // Each face faces inward: x > 0 and x < 2.
+    const XMFLOAT4& minX = planes.GetPlane(0);
+    const XMFLOAT4& maxX = planes.GetPlane(1);
+    CHECK(minX.x == 1.f && minX.y == 0.f && minX.z == 0.f && minX.w == 0.f);
+    CHECK(maxX.x == -1.f && maxX.y == 0.f && maxX.z == 0.f && maxX.w == 2.f);
+
+    const std::vector<BoundingBox> boxes =
+    {
+        Box(1.f, 2.f, 3.f, 0.5f),       // Fully inside
+        Box(1.f, 2.f, 6.f, 0.5f),       // Beyond the far z face
+        Box(-2.f, 2.f, 3.f, 0.5f),      // Beyond the near x face
+        Box(2.f, 2.f, 3.f, 0.5f),       // Across the far x face
+        Box(1.f, 2.f, 3.f, 5.f),        // Enclosing the clip box
+        Box(2.f, 3.f, 4.f, 0.5f),       // On a corner
+    };
+
+    size_t outside = 0;
+    const auto results = Classify(planes, boxes, XMMatrixIdentity(), &outside);
+    CHECK(results[0] == Result::Inside);
+    CHECK(results[1] == Result::Outside);
+    CHECK(results[2] == Result::Outside);
+    CHECK(results[3] == Result::Clipped);
+    CHECK(results[4] == Result::Clipped);
+    CHECK(results[5] == Result::Clipped);
+    CHECK(outside == 2);
+
+    // The planes carry over to clip space unchanged when the matrix is the identity.
+    XMFLOAT4 clip[SectionPlanes::MaxPlanes];
+    CHECK(planes.GetClipPlanes(XMMatrixIdentity(), clip) == SectionPlanes::MaxPlanes);
+    CHECK(clip[1].x == -1.f && clip[1].w == 2.f);
+}
+
+TEST_CASE(SectionPlanes_Disabled)
+{
+    const std::vector<BoundingBox> boxes = { Box(0.f, 0.f, 0.f, 1.f), Box(-100.f, 0.f, 0.f, 1.f) };
+
+    // With no planes everything is drawn as is.
+    SectionPlanes planes;
+    CHECK(!planes.IsEnabled());
+
+    size_t outside = 1;
+    auto results = Classify(planes, boxes, XMMatrixIdentity(), &outside);
+    CHECK(outside == 0);
+    CHECK(results[0] == Result::Inside && results[1] == Result::Inside);
+
+    const XMFLOAT4 plane(1.f, 0.f, 0.f, 0.f);
+    planes.SetPlanes(&plane, 1);
+    CHECK(Classify(planes, boxes, XMMatrixIdentity())[1] == Result::Outside);
+
+    // Clearing, or setting no planes, turns sectioning off again.
+    planes.Clear();
+    CHECK(!planes.IsEnabled());
+    CHECK(Classify(planes, boxes, XMMatrixIdentity())[1] == Result::Inside);
+
+    planes.SetBox(boxes[0]);
+    planes.SetPlanes(nullptr, 0);
+    CHECK(!planes.IsEnabled());
+    CHECK(Classify(planes, boxes, XMMatrixIdentity())[1] == Result::Inside);
+
+    XMFLOAT4 clip[SectionPlanes::MaxPlanes];
+    CHECK(planes.GetClipPlanes(XMMatrixIdentity(), clip) == 0);
+
+    // More planes than fit, or none given for a count, are rejected.
+    const XMFLOAT4 tooMany[SectionPlanes::MaxPlanes + 1] = {};
+    CHECK_THROWS(planes.SetPlanes(tooMany, SectionPlanes::MaxPlanes + 1), std::invalid_argument);
+    CHECK_THROWS(planes.SetPlanes(nullptr, 1), std::invalid_argument);
+}
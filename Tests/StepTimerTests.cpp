@@ -0,0 +1,177 @@
+//--------------------------------------------------------------------------------------
+// File: StepTimerTests.cpp
+//
+// Tests for BasicStepTimer driven by a ManualClock.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#include "../StepTimer.h"
+
+using namespace DX;
+
+namespace
+{
+    using ManualStepTimer = BasicStepTimer<ManualClock>;
+
+    constexpr uint64_t c_TicksPerSecond = ManualStepTimer::TicksPerSecond;
+    constexpr uint64_t c_Target = c_TicksPerSecond / 60;
+    constexpr uint64_t c_Snap = c_TicksPerSecond / 4000;
+
+    // Advances the clock by 'ticks' and ticks the timer, returning the number of updates.
+    uint32_t Step(ManualStepTimer& timer, uint64_t ticks)
+    {
+        uint32_t updates = 0;
+        timer.GetClock().Advance(ticks);
+        timer.Tick([&updates]() { ++updates; });
+        return updates;
+    }
+}
+
+TEST_CASE(StepTimer_VariableStep)
+{
+    ManualStepTimer timer;
+
+    CHECK(Step(timer, 160000) == 1);
+    CHECK(timer.GetElapsedTicks() == 160000);
+    CHECK(timer.GetFrameCount() == 1);
+
+    CHECK(Step(timer, 250000) == 1);
+    CHECK(timer.GetElapsedTicks() == 250000);
+    CHECK(timer.GetTotalTicks() == 410000);
+    CHECK_NEAR(timer.GetTotalSeconds(), 0.041, 1e-12);
+}
+
+TEST_CASE(StepTimer_ConvertsClockUnits)
+{
+    // 1 MHz clock: 10 canonical ticks per clock tick.
+    ManualStepTimer timer(ManualClock(1000000));
+
+    CHECK(Step(timer, 16000) == 1);
+    CHECK(timer.GetElapsedTicks() == 160000);
+}
+
+TEST_CASE(StepTimer_FixedStepCatchUp)
+{
+    ManualStepTimer timer;
+    timer.SetFixedTimeStep(true);
+
+    // Less than one step runs no updates and carries the time over.
+    CHECK(Step(timer, c_Target / 2) == 0);
+    CHECK(timer.GetFrameCount() == 0);
+
+    // Three and a half steps of time since then: the carried half makes four.
+    CHECK(Step(timer, c_Target * 3 + c_Target / 2) == 4);
+    CHECK(timer.GetFrameCount() == 4);
+    CHECK(timer.GetElapsedTicks() == c_Target);
+    CHECK(timer.GetTotalTicks() == c_Target * 4);
+}
+
+TEST_CASE(StepTimer_FixedStepSnap)
+{
+    ManualStepTimer timer;
+    timer.SetFixedTimeStep(true);
+
+    // Within 1/4 ms of the target, either side, each frame counts as exactly one step,
+    // so a 59.94 Hz display running 60 Hz updates never drops or doubles one.
+    for (int j = 0; j < 1000; ++j)
+    {
+        const uint64_t delta = (j & 1) ? c_Target + c_Snap - 1 : c_Target - c_Snap + 1;
+        REQUIRE(Step(timer, delta) == 1);
+    }
+
+    CHECK(timer.GetTotalTicks() == c_Target * 1000);
+
+    // At 1/4 ms or more away the difference is kept.
+    CHECK(Step(timer, c_Target - c_Snap) == 0);
+    CHECK(Step(timer, c_Target + c_Snap) == 2);
+    CHECK(Step(timer, c_Target + c_Snap) == 1);
+    CHECK(Step(timer, c_Target - c_Snap) == 1);
+    CHECK(timer.GetTotalTicks() == c_Target * 1004);
+}
+
+TEST_CASE(StepTimer_ClampsLongFrames)
+{
+    ManualStepTimer timer;
+    Step(timer, c_Target);
+
+    // A five second stall counts as a tenth of a second.
+    CHECK(Step(timer, c_TicksPerSecond * 5) == 1);
+    CHECK(timer.GetElapsedTicks() == c_TicksPerSecond / 10);
+
+    // In fixed-step mode the clamped tenth of a second is six 60 Hz steps.
+    timer.SetFixedTimeStep(true);
+    CHECK(Step(timer, c_TicksPerSecond * 5) == 6);
+    CHECK(timer.GetElapsedTicks() == c_Target);
+}
+
+TEST_CASE(StepTimer_ResetElapsedTime)
+{
+    ManualStepTimer timer;
+    timer.SetFixedTimeStep(true);
+
+    CHECK(Step(timer, c_Target / 2) == 0);
+
+    // Time before the reset, including any carried over, never runs updates.
+    timer.GetClock().Advance(c_TicksPerSecond);
+    timer.ResetElapsedTime();
+    CHECK(Step(timer, c_Target / 2) == 0);
+    CHECK(Step(timer, c_Target / 2) == 1);
+}
+
+TEST_CASE(StepTimer_FrameTimeIsWork)
+{
+    ManualStepTimer timer;
+    auto const& history = timer.GetFrameTimeHistory();
+
+    // Waiting before Tick, as the frame pacer does, isn't part of the frame time.
+    timer.GetClock().Advance(c_Target * 3);
+    timer.Tick([]() {});
+    timer.GetClock().Advance(c_TicksPerSecond / 250);
+    timer.EndFrame();
+
+    float frames[4] = {};
+    REQUIRE(history.GetRecent(frames, 4) == 1);
+    CHECK_NEAR(frames[0], 4.f, 1e-4f);
+
+    // A frame is recorded once, and frames that weren't ended (not drawn) aren't recorded.
+    timer.EndFrame();
+    Step(timer, c_Target);
+    Step(timer, c_Target);
+    timer.GetClock().Advance(c_TicksPerSecond / 500);
+    timer.EndFrame();
+    REQUIRE(history.GetRecent(frames, 4) == 2);
+    CHECK_NEAR(frames[1], 2.f, 1e-4f);
+
+    // A stall inside the frame is kept as it was, even though the timer clamps it.
+    Step(timer, c_Target);
+    timer.GetClock().Advance(c_TicksPerSecond * 5);
+    timer.EndFrame();
+    REQUIRE(history.GetRecent(frames, 4) == 3);
+    CHECK_NEAR(frames[2], 5000.f, 1e-2f);
+    CHECK(history.GetOverBudgetCount() == 1);
+
+    // Resetting the elapsed time drops a frame in progress.
+    Step(timer, c_Target);
+    timer.ResetElapsedTime();
+    timer.EndFrame();
+    CHECK(history.GetFrameCount() == 3);
+}
+
+TEST_CASE(StepTimer_FramesPerSecond)
+{
+    ManualStepTimer timer;
+
+    for (int j = 0; j < 60; ++j)
+    {
+        Step(timer, c_Target);
+    }
+    CHECK(timer.GetFramesPerSecond() == 0);
+
+    // 60 frames of 1/60 s fall a few ticks short of a second.
+    Step(timer, c_Target);
+    CHECK(timer.GetFramesPerSecond() == 61);
+}
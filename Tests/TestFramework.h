@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------------------
+// File: TestFramework.h
+//
+// Minimal self-registering test cases for the portable modules. TEST_CASE defines a
+// function that TestMain.cpp runs; CHECK records a failure and carries on, REQUIRE ends
+// the test case.
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <vector>
+
+
+namespace DX
+{
+    namespace Test
+    {
+        using TestFunction = void(*)();
+
+        struct TestCase
+        {
+            const char*     name;
+            const char*     file;
+            TestFunction    function;
+        };
+
+        std::vector<TestCase>& GetTestCases();
+
+        // Reports a failed check; returns false so REQUIRE can stop the test case.
+        bool Fail(const char* file, int line, const char* expression);
+
+        // Thrown by REQUIRE to end the current test case.
+        struct RequireFailed : std::exception {};
+
+        struct Registrar
+        {
+            Registrar(const char* name, const char* file, TestFunction function)
+            {
+                GetTestCases().push_back(TestCase{ name, file, function });
+            }
+        };
+    }
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static const DX::Test::Registrar name##_registrar(#name, __FILE__, name); \
+    static void name()
+
+#define CHECK(expr) \
+    ((expr) ? true : DX::Test::Fail(__FILE__, __LINE__, #expr))
+
+#define REQUIRE(expr) \
+    do { if (!(expr)) { DX::Test::Fail(__FILE__, __LINE__, #expr); throw DX::Test::RequireFailed(); } } while (false)
+
+#define CHECK_NEAR(a, b, tolerance) \
+    CHECK(std::abs(double(a) - double(b)) <= double(tolerance))
+
+#define CHECK_THROWS(expr, type) \
+    do { \
+        bool thrown_ = false; \
+        try { expr; } catch (const type&) { thrown_ = true; } \
+        if (!thrown_) DX::Test::Fail(__FILE__, __LINE__, "throws " #type ": " #expr); \
+    } while (false)
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------------------
+// File: TestMain.cpp
+//
+// Runs the registered test cases, or only those whose names contain one of the
+// command-line arguments. The exit code is non-zero if any check failed.
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestFramework.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+    size_t g_failures = 0;
+}
+
+std::vector<DX::Test::TestCase>& DX::Test::GetTestCases()
+{
+    static std::vector<TestCase> s_testCases;
+    return s_testCases;
+}
+
+bool DX::Test::Fail(const char* file, int line, const char* expression)
+{
+    std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+    ++g_failures;
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t run = 0;
+    size_t failed = 0;
+
+    for (auto const& test : DX::Test::GetTestCases())
+    {
+        bool selected = (argc < 2);
+        for (int j = 1; j < argc && !selected; ++j)
+        {
+            selected = std::strstr(test.name, argv[j]) != nullptr;
+        }
+
+        if (!selected)
+            continue;
+
+        const size_t failuresBefore = g_failures;
+        try
+        {
+            test.function();
+        }
+        catch (const DX::Test::RequireFailed&)
+        {
+        }
+        catch (const std::exception& e)
+        {
+            std::fprintf(stderr, "%s: unexpected exception: %s\n", test.file, e.what());
+            ++g_failures;
+        }
+
+        ++run;
+        if (g_failures != failuresBefore)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", test.name);
+            ++failed;
+        }
+    }
+
+    std::printf("%zu of %zu tests passed\n", run - failed, run);
+    return (failed || !run) ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------------------
+// File: TransparencySorter.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "TransparencySorter.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace DX;
+
+namespace
+{
+    constexpr uint32_t c_MaxKey = (1u << TransparencySorter::KeyBits) - 1u;
+    constexpr uint32_t c_Buckets = 1u << TransparencySorter::DigitBits;
+    constexpr uint32_t c_DigitMask = c_Buckets - 1u;
+    constexpr uint32_t c_Passes = (TransparencySorter::KeyBits + TransparencySorter::DigitBits - 1) / TransparencySorter::DigitBits;
+
+    const wchar_t* c_TransparencyModeNames[] =
+    {
+        L"mesh order",
+        L"sorted",
+        L"weighted blended",
+    };
+
+    static_assert(std::extent<decltype(c_TransparencyModeNames)>::value == static_cast<size_t>(TransparencyMode::Count), "Transparency mode name table mismatch");
+}
+
+//--------------------------------------------------------------------------------------
+const std::vector<uint32_t>& TransparencySorter::Sort(const float* depths, size_t count)
+{
+    if (count > UINT32_MAX || (count && !depths))
+        throw std::invalid_argument("TransparencySorter::Sort");
+
+    m_keys.resize(count);
+    m_order.resize(count);
+    m_scratchKeys.resize(count);
+    m_scratchOrder.resize(count);
+
+    float nearest = FLT_MAX;
+    float farthest = -FLT_MAX;
+    for (size_t j = 0; j < count; ++j)
+    {
+        if (std::isfinite(depths[j]))
+        {
+            nearest = std::min(nearest, depths[j]);
+            farthest = std::max(farthest, depths[j]);
+        }
+    }
+
+    // Keys grow toward the camera, so ascending order is back to front.
+    const float range = farthest - nearest;
+    const float scale = (range > 0.f) ? float(c_MaxKey) / range : 0.f;
+    m_quantum = (range > 0.f) ? range / float(c_MaxKey) : 0.f;
+
+    // Both digits are counted in one read of the keys.
+    uint32_t counts[c_Passes][c_Buckets] = {};
+    for (size_t j = 0; j < count; ++j)
+    {
+        const float depth = depths[j];
+        const uint32_t key = std::isfinite(depth)
+            ? std::min(static_cast<uint32_t>((farthest - depth) * scale), c_MaxKey) : 0u;
+
+        m_keys[j] = key;
+        m_order[j] = static_cast<uint32_t>(j);
+        for (uint32_t pass = 0; pass < c_Passes; ++pass)
+        {
+            ++counts[pass][(key >> (pass * DigitBits)) & c_DigitMask];
+        }
+    }
+
+    for (uint32_t pass = 0; pass < c_Passes && count > 1; ++pass)
+    {
+        const uint32_t shift = pass * DigitBits;
+
+        // A digit every key shares leaves the order as it is.
+        uint32_t* offsets = counts[pass];
+        if (offsets[(m_keys[0] >> shift) & c_DigitMask] == count)
+            continue;
+
+        uint32_t sum = 0;
+        for (uint32_t bucket = 0; bucket < c_Buckets; ++bucket)
+        {
+            const uint32_t n = offsets[bucket];
+            offsets[bucket] = sum;
+            sum += n;
+        }
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            const uint32_t key = m_keys[j];
+            const uint32_t dest = offsets[(key >> shift) & c_DigitMask]++;
+            m_scratchKeys[dest] = key;
+            m_scratchOrder[dest] = m_order[j];
+        }
+
+        m_keys.swap(m_scratchKeys);
+        m_order.swap(m_scratchOrder);
+    }
+
+    return m_order;
+}
+
+void TransparencySorter::SortReference(const float* depths, size_t count, std::vector<uint32_t>& order)
+{
+    if (count > UINT32_MAX || (count && !depths))
+        throw std::invalid_argument("TransparencySorter::SortReference");
+
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0u);
+
+    std::stable_sort(order.begin(), order.end(), [depths](uint32_t a, uint32_t b)
+        {
+            const bool finiteA = std::isfinite(depths[a]);
+            const bool finiteB = std::isfinite(depths[b]);
+            if (finiteA != finiteB)
+                return !finiteA;
+
+            return finiteA && depths[a] > depths[b];
+        });
+}
+
+size_t TransparencySorter::GetMemoryUsage() const noexcept
+{
+    return (m_keys.capacity() + m_order.capacity() + m_scratchKeys.capacity() + m_scratchOrder.capacity()) * sizeof(uint32_t);
+}
+
+const wchar_t* DX::GetTransparencyModeName(TransparencyMode mode) noexcept
+{
+    const auto index = static_cast<size_t>(mode);
+    return (index < static_cast<size_t>(TransparencyMode::Count)) ? c_TransparencyModeNames[index] : L"unknown";
+}
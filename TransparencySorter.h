@@ -0,0 +1,68 @@
+//--------------------------------------------------------------------------------------
+// File: TransparencySorter.h
+//
+// Back-to-front ordering of alpha parts for blending. Each frame the view depth of every
+// part is quantized to an integer key across the range between the nearest and farthest
+// part, and the keys are sorted with a least-significant-digit radix sort: two passes of
+// counting and scattering, linear in the number of parts. The sort is stable, so parts
+// at the same depth keep their mesh order.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace DX
+{
+    enum class TransparencyMode : uint32_t
+    {
+        MeshOrder,          // As Model::Draw: alpha parts in the order of their meshes
+        Sorted,             // Alpha parts back to front by the depth of their centers
+        WeightedBlended,    // Order independent, for parts that intersect
+        Count
+    };
+
+    class TransparencySorter
+    {
+    public:
+        static constexpr uint32_t KeyBits = 22;
+        static constexpr uint32_t DigitBits = 11;
+
+        TransparencySorter() noexcept : m_quantum(0.f) {}
+
+        TransparencySorter(TransparencySorter&&) = default;
+        TransparencySorter& operator= (TransparencySorter&&) = default;
+
+        TransparencySorter(TransparencySorter const&) = delete;
+        TransparencySorter& operator= (TransparencySorter const&) = delete;
+
+        // Returns the indices of 'count' items in drawing order, farthest first, given
+        // their view depths. Depths that aren't finite are drawn first. The result stays
+        // valid until the next call.
+        const std::vector<uint32_t>& Sort(_In_reads_(count) const float* depths, size_t count);
+
+        // The same order by std::stable_sort on the exact depths, for checking Sort. Items
+        // within GetQuantum() of each other may come out in either order.
+        static void SortReference(_In_reads_(count) const float* depths, size_t count, std::vector<uint32_t>& order);
+
+        // Depth covered by one key in the last Sort.
+        float GetQuantum() const noexcept { return m_quantum; }
+
+        size_t GetMemoryUsage() const noexcept;
+
+    private:
+        std::vector<uint32_t>   m_keys;
+        std::vector<uint32_t>   m_order;
+        std::vector<uint32_t>   m_scratchKeys;
+        std::vector<uint32_t>   m_scratchOrder;
+        float                   m_quantum;
+    };
+
+    const wchar_t* GetTransparencyModeName(TransparencyMode mode) noexcept;
+}
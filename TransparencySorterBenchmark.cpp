@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------------------
+// File: TransparencySorterBenchmark.cpp
+//
+// This file does not use the precompiled header so it can also be built for non-Windows
+// targets.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include "HeadlessBenchmark.h"
+#include "TransparencySorter.h"
+
+#include <iomanip>
+#include <stdexcept>
+#include <tuple>
+
+using namespace DirectX;
+using namespace DX;
+
+namespace
+{
+    // Alpha parts sorted, as many as a large scene might have.
+    constexpr size_t c_TransparencyBenchmarkParts = 100000;
+}
+
+BenchmarkReport::TransparencySort DX::BenchmarkTransparencySort(uint32_t iterations, std::ostream& log)
+{
+    // A fixed linear congruential sequence, so every run sorts the same depths.
+    std::vector<float> depths(c_TransparencyBenchmarkParts);
+    uint32_t seed = 12345u;
+    for (auto& depth : depths)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        depth = 1.f + 99.f * float(seed >> 8) / float(1u << 24);
+    }
+
+    TransparencySorter sorter;
+    std::vector<uint32_t> reference;
+
+    BenchmarkReport::TransparencySort result = {};
+    result.parts = depths.size();
+    result.radix = TimeStage(iterations, [&]() { std::ignore = sorter.Sort(depths.data(), depths.size()); });
+    result.reference = TimeStage(iterations, [&]() { TransparencySorter::SortReference(depths.data(), depths.size(), reference); });
+
+    auto const& order = sorter.Sort(depths.data(), depths.size());
+    std::vector<bool> seen(depths.size());
+    for (size_t j = 0; j < order.size(); ++j)
+    {
+        if (order[j] >= depths.size() || seen[order[j]]
+            || (j > 0 && depths[order[j]] > depths[order[j - 1]] + sorter.GetQuantum()))
+            throw std::runtime_error("Transparency sort out of order");
+        seen[order[j]] = true;
+    }
+
+    log << "Transparency sort: " << result.parts << " parts, "
+        << std::fixed << std::setprecision(3) << result.radix.meanMs << " ms radix, "
+        << result.reference.meanMs << " ms std::stable_sort" << std::endl;
+
+    return result;
+}
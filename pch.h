@@ -52,6 +52,7 @@
 #endif
 
 #include <wrl/client.h>
+#include <wrl/event.h>
 
 #include <DirectXMath.h>
 #include <DirectXColors.h>
@@ -65,9 +66,11 @@
 #include <cstring>
 #include <cwchar>
 #include <exception>
+#include <fstream>
 #include <iterator>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <system_error>